@@ -0,0 +1,104 @@
+ 
+
+#include "C4Atoms.h"
+
+
+using namespace C4;
+
+
+Mutex TextAtom::atomMutex;
+const AtomEntry *volatile TextAtom::atomBucket[kAtomBucketCount] = {nullptr};
+unsigned_int32 TextAtom::atomCount = 0;
+
+
+TextAtom::TextAtom(const char *text)
+{
+	if (text[0] == 0)
+	{
+		atomEntry = nullptr;
+		return;
+	}
+
+	unsigned_int32 hash = Text::Hash(text);
+	const AtomEntry *entry = FindEntry(text, hash);
+	if (!entry)
+	{
+		atomMutex.Acquire();
+
+		// Another thread may have interned the same string after the first search.
+
+		entry = FindEntry(text, hash);
+		if (!entry)
+		{
+			int32 length = Text::GetTextLength(text);
+			AtomEntry *newEntry = reinterpret_cast<AtomEntry *>(new char[sizeof(AtomEntry) + length]);
+
+			newEntry->atomHash = hash;
+			newEntry->atomID = ++atomCount;
+			Text::CopyText(text, newEntry->atomText);
+
+			const AtomEntry *volatile *bucket = &atomBucket[hash & (kAtomBucketCount - 1)];
+			newEntry->nextEntry = *bucket;
+
+			// The entry must be completely written before it becomes visible to
+			// threads that search the bucket without acquiring the mutex.
+
+			Thread::Fence();
+			*bucket = newEntry;
+			entry = newEntry;
+		}
+
+		atomMutex.Release();
+	}
+
+	atomEntry = entry;
+}
+
+const AtomEntry *TextAtom::FindEntry(const char *text, unsigned_int32 hash)
+{
+	const AtomEntry *entry = atomBucket[hash & (kAtomBucketCount - 1)];
+	while (entry)
+	{
+		if ((entry->atomHash == hash) && (Text::CompareText(entry->atomText, text)))
+		{
+			return (entry);
+		}
+
+		entry = entry->nextEntry;
+	}
+
+	return (nullptr);
+}
+
+TextAtom TextAtom::Find(const char *text)
+{
+	if (text[0] == 0)
+	{
+		return (TextAtom());
+	}
+
+	return (TextAtom(FindEntry(text, Text::Hash(text))));
+}
+
+void TextAtom::PurgeAtoms(void)
+{
+	atomMutex.Acquire();
+
+	for (machine a = 0; a < kAtomBucketCount; a++)
+	{
+		const AtomEntry *entry = atomBucket[a];
+		while (entry)
+		{
+			const AtomEntry *next = entry->nextEntry;
+			delete[] reinterpret_cast<const char *>(entry);
+			entry = next;
+		}
+
+		atomBucket[a] = nullptr;
+	}
+
+	atomCount = 0;
+	atomMutex.Release();
+}
+
+// ZYUQURM
@@ -0,0 +1,223 @@
+ 
+
+#ifndef C4Atoms_h
+#define C4Atoms_h
+
+
+//# \component	Utility Library
+//# \prefix		Utilities/
+
+
+#include "C4String.h"
+#include "C4Threads.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kAtomBucketCount		= 4096
+	};
+
+
+	class AtomEntry
+	{
+		friend class TextAtom;
+
+		private:
+
+			const AtomEntry *volatile	nextEntry;
+			unsigned_int32				atomHash;
+			unsigned_int32				atomID;
+			char						atomText[4];
+	};
+
+
+	//# \class	TextAtom		Encapsulates an interned string.
+	//
+	//# The $TextAtom$ class encapsulates an interned string.
+	//
+	//# \def	class TextAtom
+	//
+	//# \ctor	TextAtom();
+	//# \ctor	explicit TextAtom(const char *text);
+	//
+	//# \param	text	The string to intern.
+	//
+	//# \desc
+	//# A $TextAtom$ object refers to a single copy of a string stored in a global table that is shared by all threads.
+	//# Interning the same string more than once always produces the same atom, so two atoms can be compared by
+	//# their integer identifiers instead of by their characters. The text of an atom remains valid until the
+	//# engine is terminated.
+	//#
+	//# The constructor that takes a $text$ parameter interns the string, adding it to the table if it is not
+	//# already there. The default constructor creates a null atom whose identifier is zero and whose text is
+	//# empty. Interning an empty string also produces the null atom.
+	//#
+	//# Atoms are ordered by identifier, which reflects the order in which strings were first interned.
+	//# This order is <i>not</i> alphabetical.
+	//
+	//# \also	$@AtomKey@$
+	//# \also	$@Text::Hash@$
+
+
+	//# \function	TextAtom::Find		Returns the atom for a string if it has already been interned.
+	//
+	//# \proto	static TextAtom Find(const char *text);
+	//
+	//# \param	text	The string to look up.
+	//
+	//# \desc
+	//# The $Find$ function returns the atom for the string specified by the $text$ parameter if that string has
+	//# previously been interned. Otherwise, the null atom is returned, and the string is not added to the table.
+	//#
+	//# The $Find$ function never blocks, and it can be called from any thread while other threads are interning
+	//# new strings.
+
+
+	class TextAtom
+	{
+		private:
+
+			const AtomEntry								*atomEntry;
+
+			static Mutex								atomMutex;
+			static const AtomEntry *volatile			atomBucket[kAtomBucketCount];
+			static unsigned_int32						atomCount;
+
+			TextAtom(const AtomEntry *entry)
+			{
+				atomEntry = entry;
+			}
+
+			static const AtomEntry *FindEntry(const char *text, unsigned_int32 hash);
+
+		public:
+
+			TextAtom()
+			{
+				atomEntry = nullptr;
+			}
+
+			C4API explicit TextAtom(const char *text);
+
+			const char *GetText(void) const
+			{
+				return ((atomEntry) ? atomEntry->atomText : "");
+			}
+
+			unsigned_int32 GetAtomID(void) const
+			{
+				return ((atomEntry) ? atomEntry->atomID : 0);
+			}
+
+			unsigned_int32 GetHash(void) const
+			{
+				return ((atomEntry) ? atomEntry->atomHash : 0);
+			}
+
+			bool operator ==(const TextAtom& atom) const
+			{
+				return (atomEntry == atom.atomEntry);
+			}
+
+			bool operator !=(const TextAtom& atom) const
+			{
+				return (atomEntry != atom.atomEntry);
+			}
+
+			bool operator <(const TextAtom& atom) const
+			{
+				return (GetAtomID() < atom.GetAtomID());
+			}
+
+			static unsigned_int32 GetAtomCount(void)
+			{
+				return (atomCount);
+			}
+
+			C4API static TextAtom Find(const char *text);
+			C4API static void PurgeAtoms(void);
+	};
+
+
+	//# \class	AtomKey		Map key type that compares atoms by identifier.
+	//
+	//# The $AtomKey$ class is a map key type that compares atoms by identifier.
+	//
+	//# \def	class AtomKey
+	//
+	//# \ctor	AtomKey(const TextAtom& atom);
+	//# \ctor	AtomKey(const char *text);
+	//
+	//# \param	atom	The atom used as the key.
+	//# \param	text	A string whose atom is used as the key.
+	//
+	//# \desc
+	//# The $AtomKey$ class can be used as the $KeyType$ of an object stored in a $@Map@$ container so that searching
+	//# the map compares integers instead of strings. When an $AtomKey$ object is constructed from a string, the
+	//# string is looked up with the $@TextAtom::Find@$ function. A nonempty string that has never been interned
+	//# produces a key that does not match any element, and an empty string produces the null key.
+	//#
+	//# Elements of a map keyed by $AtomKey$ are ordered by atom identifier, not alphabetically.
+	//
+	//# \also	$@TextAtom@$
+
+
+	class AtomKey
+	{
+		private:
+
+			enum : unsigned_int32
+			{
+				kAtomNotInterned	= 0xFFFFFFFF
+			};
+
+			unsigned_int32		atomID;
+
+			static unsigned_int32 FindAtomID(const char *text)
+			{
+				unsigned_int32 id = TextAtom::Find(text).GetAtomID();
+				return (((id != 0) || (text[0] == 0)) ? id : kAtomNotInterned);
+			}
+
+		public:
+
+			AtomKey() = default;
+
+			AtomKey(const TextAtom& atom)
+			{
+				atomID = atom.GetAtomID();
+			}
+
+			AtomKey(const char *text)
+			{
+				atomID = FindAtomID(text);
+			}
+
+			template <int32 len> AtomKey(const String<len>& s)
+			{
+				atomID = FindAtomID(s);
+			}
+
+			bool operator ==(const AtomKey& key) const
+			{
+				return (atomID == key.atomID);
+			}
+
+			bool operator !=(const AtomKey& key) const
+			{
+				return (atomID != key.atomID);
+			}
+
+			bool operator <(const AtomKey& key) const
+			{
+				return (atomID < key.atomID);
+			}
+	};
+}
+
+
+#endif
+
+// ZYUQURM
@@ -1,6 +1,7 @@
  
 
 #include "C4AudioCapture.h"
+#include "C4Engine.h"
 #include "C4Time.h"
 
 
@@ -245,7 +246,7 @@ unsigned_int32 AudioMessage::GetAudioData(Sample *data, unsigned_int32 offset) c
 
 ChatStreamer::ChatStreamer()
 {
-	AllocateStreamMemory(kChatRingBufferSize, kCaptureBufferSize);
+	AllocateStreamMemory(kChatRingBufferSize, kCaptureBufferSize, 2);
 }
 
 ChatStreamer::~ChatStreamer()
@@ -648,6 +649,11 @@ void AudioCaptureMgr::Terminate(void)
 
 AudioCaptureResult AudioCaptureMgr::StartAudioCapture(bool paused)
 {
+	if (TheEngine->GetEngineFlags() & kEngineHeadless)
+	{
+		return (kAudioCaptureUnavailable);
+	}
+
 	AudioCaptureResult result = Initialize();
 	if (result != kAudioCaptureOkay)
 	{
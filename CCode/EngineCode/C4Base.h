@@ -489,6 +489,31 @@ namespace C4
 		#endif
 	}
 
+	inline int32 AtomicAdd(volatile int32 *ptr, int32 x)
+	{
+		#if C4WINDOWS
+
+			return (_InterlockedExchangeAdd(reinterpret_cast<volatile long *>(ptr), x));
+
+		#elif C4MACOS
+
+			return (OSAtomicAdd32(x, reinterpret_cast<volatile int32_t *>(ptr)) - x);
+
+		#elif C4PS4 //[ PS4
+
+			// -- PS4 code hidden --
+
+		#elif C4PS3 //[ PS3
+
+			// -- PS3 code hidden --
+
+		#else //]
+
+			return (__sync_fetch_and_add(ptr, x));
+
+		#endif
+	}
+
 
 	inline machine_address GetPointerAddress(const volatile void *ptr)
 	{
@@ -21,10 +21,10 @@ namespace C4
 
 C4::Cell::Cell()
 {
-	subcell[0] = nullptr;
-	subcell[1] = nullptr;
-	subcell[2] = nullptr;
-	subcell[3] = nullptr;
+	for (machine a = 0; a < 8; a++)
+	{
+		subcell[a] = nullptr;
+	}
 }
 
 C4::Cell::Cell(CellGraph *graph, Cell *superCell, int32 index) : Site(index)
@@ -33,10 +33,10 @@ C4::Cell::Cell(CellGraph *graph, Cell *superCell, int32 index) : Site(index)
 	new Bond(superCell, this);
 	graph->AddElement(this);
 
-	subcell[0] = nullptr;
-	subcell[1] = nullptr;
-	subcell[2] = nullptr;
-	subcell[3] = nullptr;
+	for (machine a = 0; a < 8; a++)
+	{
+		subcell[a] = nullptr;
+	}
 }
 
 C4::Cell::~Cell()
@@ -52,29 +52,58 @@ C4::Cell::~Cell()
 CellGraph::CellGraph(Site *site)
 {
 	superSite = site;
+	cellStructure = kCellStructureQuadtree;
+
+	cellCount = 0;
+	insertCount = 0;
+	updateCount = 0;
 }
 
 CellGraph::~CellGraph()
 {
 }
 
-void CellGraph::Activate(const Box3D& box, float size)
+void CellGraph::Activate(const Box3D& box, float size, int32 structure)
 {
+	cellStructure = structure;
 	cellSize = size;
 	inverseCellSize = 1.0F / size;
 
 	int32 width = (int32) Ceil((box.max.x - box.min.x) * inverseCellSize);
 	int32 height = (int32) Ceil((box.max.y - box.min.y) * inverseCellSize);
-	maxCellCoord.Set(MaxZero(width - 1), MaxZero(height - 1));
 
-	int32 logWidth = 32 - Cntlz(width - 1);
-	int32 logHeight = 32 - Cntlz(height - 1);
-	int32 count = Max(Max(logWidth, logHeight), 1);
-	levelCount = count;
+	if (structure == kCellStructureLooseOctree)
+	{
+		// The octree is a cube that covers the whole box. Each cell occupies a loose region twice
+		// as large as its nominal region, so a site whose center lies in a cell's nominal region and
+		// whose largest extent does not exceed the cell size always fits inside the loose region.
+
+		int32 depth = (int32) Ceil((box.max.z - box.min.z) * inverseCellSize);
+		int32 count = Min(Max(33 - Cntlz(Max(Max(width, height), depth) - 1), 1), kMaxCellLevelCount);
+		levelCount = count;
+
+		int32 maxCoord = (1 << (count - 1)) - 1;
+		maxCellCoord.Set(maxCoord, maxCoord, maxCoord);
 
-	rootCellSize = (float) (1 << (count - 1)) * size;
-	rootCell.SetWorldBoundingBox(box.min, Point3D(box.min.x + rootCellSize * 2.0F, box.min.y + rootCellSize * 2.0F, box.max.z));
+		rootCellSize = (float) (1 << (count - 1)) * size;
+		float margin = rootCellSize * 0.5F;
+		rootCell.SetWorldBoundingBox(Point3D(box.min.x - margin, box.min.y - margin, box.min.z - margin), Point3D(box.min.x + rootCellSize + margin, box.min.y + rootCellSize + margin, box.min.z + rootCellSize + margin));
+		octreeOrigin = box.min;
+	}
+	else
+	{
+		maxCellCoord.Set(MaxZero(width - 1), MaxZero(height - 1), 0);
+
+		int32 logWidth = 32 - Cntlz(width - 1);
+		int32 logHeight = 32 - Cntlz(height - 1);
+		int32 count = Max(Max(logWidth, logHeight), 1);
+		levelCount = count;
+
+		rootCellSize = (float) (1 << (count - 1)) * size;
+		rootCell.SetWorldBoundingBox(box.min, Point3D(box.min.x + rootCellSize * 2.0F, box.min.y + rootCellSize * 2.0F, box.max.z));
+	}
 
+	cellCount = 1;
 	new Bond(superSite, &rootCell);
 }
 
@@ -85,6 +114,8 @@ C4::Cell *CellGraph::UpdateCell(Cell *superCell, int32 i, int32 j, float size)
 	if (!cell)
 	{
 		cell = new Cell(this, superCell, index);
+		cellCount++;
+
 		const Point3D& rootBoxMin = rootCell.GetWorldBoundingBox().min;
 		Point3D p(rootBoxMin.x + (float) i * size, rootBoxMin.y + (float) j * size, rootBoxMin.z);
 		cell->SetWorldBoundingBox(p, Point3D(p.x + size, p.y + size, rootCell.GetWorldBoundingBox().max.z));
@@ -93,9 +124,74 @@ C4::Cell *CellGraph::UpdateCell(Cell *superCell, int32 i, int32 j, float size)
 	return (cell);
 }
 
+C4::Cell *CellGraph::UpdateOctreeCell(Cell *superCell, int32 i, int32 j, int32 k, float size)
+{
+	int32 index = (k & 1) * 4 + (j & 1) * 2 + (i & 1);
+	Cell *cell = superCell->subcell[index];
+	if (!cell)
+	{
+		cell = new Cell(this, superCell, index);
+		cellCount++;
+
+		float margin = size * 0.5F;
+		Point3D p(octreeOrigin.x + (float) i * size - margin, octreeOrigin.y + (float) j * size - margin, octreeOrigin.z + (float) k * size - margin);
+		cell->SetWorldBoundingBox(p, Point3D(p.x + size * 2.0F, p.y + size * 2.0F, p.z + size * 2.0F));
+	}
+
+	return (cell);
+}
+
+void CellGraph::InsertOctreeSite(Site *site)
+{
+	const Box3D& siteBox = site->GetWorldBoundingBox();
+	Vector3D size = siteBox.max - siteBox.min;
+
+	float siteSize = Fmax(size.x, size.y, size.z);
+	if (siteSize <= rootCellSize)
+	{
+		Vector3D offset = (siteBox.min + siteBox.max) * 0.5F - octreeOrigin;
+
+		int32 x = (int32) (offset.x * inverseCellSize);
+		int32 y = (int32) (offset.y * inverseCellSize);
+		int32 z = (int32) (offset.z * inverseCellSize);
+
+		if ((offset.x >= 0.0F) && (offset.y >= 0.0F) && (offset.z >= 0.0F) && (x <= maxCellCoord.x) && (y <= maxCellCoord.y) && (z <= maxCellCoord.z))
+		{
+			Cell *cell = &rootCell;
+			float levelCellSize = rootCellSize * 0.5F;
+
+			for (machine level = levelCount - 2; level >= 0; level--)
+			{
+				if (siteSize > levelCellSize)
+				{
+					break;
+				}
+
+				cell = UpdateOctreeCell(cell, x >> level, y >> level, z >> level, levelCellSize);
+				levelCellSize *= 0.5F;
+			}
+
+			new Bond(cell, site);
+			return;
+		}
+	}
+
+	new Bond(superSite, site);
+}
+
 void CellGraph::InsertSite(Site *site)
 {
-	if (rootCell.GetFirstIncomingEdge())
+	insertCount++;
+
+	if (cellStructure == kCellStructureLooseOctree)
+	{
+		if (rootCell.GetFirstIncomingEdge())
+		{
+			InsertOctreeSite(site);
+			return;
+		}
+	}
+	else if (rootCell.GetFirstIncomingEdge())
 	{
 		const Box3D& siteBox = site->GetWorldBoundingBox();
 		Vector2D size = siteBox.max.GetPoint2D() - siteBox.min.GetPoint2D();
@@ -222,9 +318,39 @@ void CellGraph::RemoveSite(Site *site)
 				Site *cell = bond->GetStartElement();
 				delete predecessor;
 				predecessor = cell;
+				cellCount--;
+			}
+		}
+	}
+}
+
+bool CellGraph::UpdateSite(Site *site)
+{
+	// In a loose octree, a site that has moved can keep its bond as long as its bounding box is
+	// still contained in the loose region of the cell it was bonded to. This function returns true
+	// if the existing bond is still valid and false if the site needs to be removed and inserted again.
+
+	if (cellStructure == kCellStructureLooseOctree)
+	{
+		const Bond *bond = site->GetFirstIncomingEdge();
+		if ((bond) && (!bond->GetNextIncomingEdge()))
+		{
+			const Site *cell = bond->GetStartElement();
+			if ((cell != superSite) && (cell->GetCellIndex() >= 0))
+			{
+				const Box3D& cellBox = cell->GetWorldBoundingBox();
+				const Box3D& siteBox = site->GetWorldBoundingBox();
+
+				if ((cellBox.Contains(siteBox.min)) && (cellBox.Contains(siteBox.max)))
+				{
+					updateCount++;
+					return (true);
+				}
 			}
 		}
 	}
+
+	return (false);
 }
 
 
@@ -19,6 +19,21 @@ namespace C4
 	};
 
 
+	//# \enum	CellStructure
+
+	enum
+	{
+		kCellStructureQuadtree,			//## Two-dimensional cell hierarchy in which a site can be bonded to up to four cells on one level.
+		kCellStructureLooseOctree		//## Three-dimensional loose octree in which each site is bonded to exactly one cell.
+	};
+
+
+	enum
+	{
+		kMaxCellLevelCount = 16
+	};
+
+
 	class Site;
 	class CellGraph;
 
@@ -102,7 +117,7 @@ namespace C4
 
 		private: 
 
-			Cell	*subcell[4];
+			Cell	*subcell[8];
  
 			Cell();
  
@@ -119,26 +134,70 @@ namespace C4
 
 			Site			*superSite;
 
+			int32			cellStructure;
+
 			float			cellSize;
 			float			inverseCellSize;
 			float			rootCellSize;
 
-			Integer2D		maxCellCoord;
+			Integer3D		maxCellCoord;
 			int32			levelCount;
 
+			Point3D			octreeOrigin;
+
+			int32			cellCount;
+			int32			insertCount;
+			int32			updateCount;
+
 			Cell			rootCell;
 
 			Cell *UpdateCell(Cell *superCell, int32 i, int32 j, float size);
+			Cell *UpdateOctreeCell(Cell *superCell, int32 i, int32 j, int32 k, float size);
+
+			void InsertOctreeSite(Site *site);
 
 		public:
 
 			CellGraph(Site *site);
 			~CellGraph();
 
-			void Activate(const Box3D& box, float size);
+			int32 GetCellStructure(void) const
+			{
+				return (cellStructure);
+			}
+
+			int32 GetLevelCount(void) const
+			{
+				return (levelCount);
+			}
+
+			int32 GetCellCount(void) const
+			{
+				return (cellCount);
+			}
+
+			int32 GetInsertCount(void) const
+			{
+				return (insertCount);
+			}
+
+			int32 GetUpdateCount(void) const
+			{
+				return (updateCount);
+			}
+
+			void ResetStatistics(void)
+			{
+				insertCount = 0;
+				updateCount = 0;
+			}
+
+			void Activate(const Box3D& box, float size, int32 structure = kCellStructureQuadtree);
 
 			void InsertSite(Site *site);
 			void RemoveSite(Site *site);
+
+			bool UpdateSite(Site *site);
 	};
 
 
@@ -5,6 +5,8 @@
 #include "C4Movies.h"
 #include "C4ToolWindows.h"
 #include "C4Application.h"
+#include "C4Profiler.h"
+#include "C4PhysicsRecorder.h"
 
 
 using namespace C4;
@@ -348,6 +350,1021 @@ void Engine::HandleDisconnectCommand(Command *command, const char *text)
 		StatsWindow::Open();
 	}
 
+	void Engine::HandlePhysbenchCommand(Command *command, const char *text)
+	{
+		// With no parameters, the physbench command toggles the comparison between the batched contact
+		// solver and the scalar solver, and the accumulated results are reported when it is turned off.
+		// Loading a world containing stacks of boxes and running the comparison for a few seconds gives
+		// a stacking benchmark. The "scalar" and "batched" parameters select the solver for the world.
+
+		if (text[0] != 0)
+		{
+			String<kMaxCommandLength>	param;
+
+			Text::ReadString(text, param, kMaxCommandLength);
+
+			World *world = TheWorldMgr->GetWorld();
+			if (world)
+			{
+				PhysicsController *physicsController = world->FindPhysicsController();
+				if (physicsController)
+				{
+					physicsController->SetContactSolverMode((param == "scalar") ? kContactSolverScalar : kContactSolverBatched);
+				}
+			}
+
+			return;
+		}
+
+		if (!ContactSolver::ComparisonEnabled())
+		{
+			ContactSolver::SetComparisonEnabled(true);
+			return;
+		}
+
+		ContactSolver::SetComparisonEnabled(false);
+		const ContactSolverComparison *data = ContactSolver::GetComparisonData();
+
+		String<kMaxCommandLength> report("Islands: ");
+		((((report += data->islandCount) += "  Rows: ") += data->rowCount) += "  Colors: ") += data->colorCount;
+		Report(report);
+
+		report = "Scalar: ";
+		((((report += (int64) data->scalarSolveTime) += " us  Batched: ") += (int64) data->batchedSolveTime) += " us");
+		Report(report);
+
+		report = "Max deviation: v ";
+		((((report += String<15>(data->maxLinearVelocityDeviation)) += "  w ") += String<15>(data->maxAngularVelocityDeviation)) += "  p ") += String<15>(data->maxPositionDeviation);
+		Report(report);
+	}
+
+	void Engine::HandleFtimeCommand(Command *command, const char *text)
+	{
+		// The ftime command measures the time spent in each phase of the main loop over the given
+		// number of frames and reports the averages and maximums. Comparing the render phase with
+		// and without the deferSwap variable shows whether the buffer swap is where the main thread
+		// waits. In a headless engine, it measures the simulation alone, and the results go to the log.
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultFrameTimingCount;
+		if (count > 0)
+		{
+			frameTimingTotal = count;
+			frameTimeTotal = 0;
+			frameTimeMax = 0;
+
+			for (machine a = 0; a < kFramePhaseCount; a++)
+			{
+				framePhaseTotal[a] = 0;
+				framePhaseMax[a] = 0;
+			}
+
+			frameTimingCount = count;
+		}
+	}
+
+	void Engine::HandleNavbenchCommand(Command *command, const char *text)
+	{
+		// The navbench command finds paths between the given number of random pairs of positions on
+		// the navigation mesh of the current world. The queries are run once on the main thread and
+		// once as jobs spread over the worker threads, and the number of queries completed per second
+		// is reported for each. In a headless engine, the results go to the log.
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultNavbenchCount;
+		World *world = TheWorldMgr->GetWorld();
+		if ((count <= 0) || (!world))
+		{
+			return;
+		}
+
+		NavigationMesh *mesh = world->GetNavigationMesh();
+		if (mesh->GetTileCount() == 0)
+		{
+			Report("No navigation tiles");
+			return;
+		}
+
+		Point3D *position = new Point3D[count * 2];
+		for (machine a = 0; a < count * 2; a++)
+		{
+			mesh->GetRandomPosition(&position[a]);
+		}
+
+		Array<Point3D>		path;
+
+		int32 serialCount = 0;
+		unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
+		for (machine a = 0; a < count; a++)
+		{
+			serialCount += (mesh->FindPath(position[a * 2], position[a * 2 + 1], &path) == kNavigationPathComplete);
+		}
+
+		unsigned_int64 serialTime = Max(TheTimeMgr->GetMicrosecondCount() - time, (unsigned_int64) 1);
+
+		NavigationQuery *query = new NavigationQuery[count];
+		int32 parallelCount = 0;
+		time = TheTimeMgr->GetMicrosecondCount();
+
+		for (machine a = 0; a < count; a++)
+		{
+			query[a].Submit(mesh, position[a * 2], position[a * 2 + 1]);
+		}
+
+		for (machine a = 0; a < count; a++)
+		{
+			JobMgr::FinishJob(&query[a]);
+			parallelCount += (query[a].GetQueryResult() == kNavigationPathComplete);
+		}
+
+		unsigned_int64 parallelTime = Max(TheTimeMgr->GetMicrosecondCount() - time, (unsigned_int64) 1);
+
+		delete[] query;
+		delete[] position;
+
+		String<kMaxCommandLength> report("Tiles: ");
+		((((report += mesh->GetTileCount()) += "  Queries: ") += count) += "  Workers: ") += TheJobMgr->GetWorkerThreadCount();
+		Report(report);
+
+		report = "Main thread: ";
+		((((report += (int64) ((unsigned_int64) count * 1000000 / serialTime)) += " queries/s  Found: ") += serialCount) += "/") += count;
+		Report(report);
+
+		report = "Jobs: ";
+		((((report += (int64) ((unsigned_int64) count * 1000000 / parallelTime)) += " queries/s  Found: ") += parallelCount) += "/") += count;
+		Report(report);
+	}
+
+	void Engine::HandlePhysrecCommand(Command *command, const char *text)
+	{
+		// With a name, the physrec command reloads the current world with deterministic physics and
+		// begins recording it. With no parameters, it stops recording and saves the recording with
+		// the name that was given when it started in the save directory.
+
+		if (text[0] != 0)
+		{
+			World *world = TheWorldMgr->GetWorld();
+			if (world)
+			{
+				ResourceName worldName(world->GetWorldName());
+				Text::ReadString(text, physicsRecordingName, kMaxResourceNameLength);
+
+				if (physicsRecorder)
+				{
+					physicsRecorder->EndRecording();
+				}
+				else
+				{
+					physicsRecorder = new PhysicsRecorder;
+				}
+
+				if (!physicsRecorder->BeginRecording(worldName))
+				{
+					delete physicsRecorder;
+					physicsRecorder = nullptr;
+
+					Report("Cannot record physics");
+				}
+			}
+
+			return;
+		}
+
+		PhysicsRecorder *recorder = physicsRecorder;
+		if (recorder)
+		{
+			physicsRecorder = nullptr;
+			recorder->EndRecording();
+
+			String<kMaxFileNameLength> path(TheResourceMgr->GetSaveCatalog()->GetRootPath());
+			(path += physicsRecordingName) += ".phys";
+
+			String<kMaxCommandLength> report("Frames: ");
+			((((report += recorder->GetFrameCount()) += "  Inputs: ") += recorder->GetInputCount()) += "  Steps: ") += recorder->GetStepCount();
+			Report((recorder->Save(path)) ? report : String<kMaxCommandLength>("Cannot save physics recording"));
+
+			delete recorder;
+		}
+	}
+
+	void Engine::HandlePhysplayCommand(Command *command, const char *text)
+	{
+		// The physplay command replays a recording made with the physrec command without rendering,
+		// checks that every step reproduces the recorded state exactly, and reports the time taken
+		// by the physics steps. In a headless engine, the results go to the log.
+
+		if ((text[0] == 0) || (physicsRecorder))
+		{
+			return;
+		}
+
+		ResourceName	name;
+
+		Text::ReadString(text, name, kMaxResourceNameLength);
+		String<kMaxFileNameLength> path(TheResourceMgr->GetSaveCatalog()->GetRootPath());
+		(path += name) += ".phys";
+
+		PhysicsRecorder *recorder = new PhysicsRecorder;
+		if ((!recorder->Load(path)) || (!recorder->Replay()))
+		{
+			delete recorder;
+
+			Report("Cannot replay physics recording");
+			return;
+		}
+
+		int32 stepCount = recorder->GetReplayStepCount();
+		unsigned_int64 totalTime = 0;
+		unsigned_int32 minTime = 0xFFFFFFFF;
+		unsigned_int32 maxTime = 0;
+
+		for (machine a = 0; a < stepCount; a++)
+		{
+			unsigned_int32 time = recorder->GetStepTime(a);
+			totalTime += time;
+			minTime = Min(minTime, time);
+			maxTime = Max(maxTime, time);
+		}
+
+		String<kMaxCommandLength> report("World: ");
+		((((report += recorder->GetWorldName()) += "  Frames: ") += recorder->GetFrameCount()) += "  Steps: ") += stepCount;
+		Report(report);
+
+		int32 mismatchStep = recorder->GetMismatchStep();
+		if ((mismatchStep < 0) && (stepCount == recorder->GetStepCount()))
+		{
+			Report("All steps match the recording");
+		}
+		else
+		{
+			report = "Mismatched steps: ";
+			((report += recorder->GetMismatchCount()) += "  First: ") += mismatchStep;
+			Report(report);
+		}
+
+		if (stepCount != 0)
+		{
+			report = "Step time: ";
+			((((((report += (int64) (totalTime / stepCount)) += " us avg  ") += minTime) += " us min  ") += maxTime) += " us max  ") += (int64) (totalTime / 1000);
+			report += " ms total";
+			Report(report);
+		}
+
+		delete recorder;
+	}
+
+	void Engine::HandleBlockbenchCommand(Command *command, const char *text)
+	{
+		// The blockbench command compresses a synthetic image of the given size to BC1 one block at a time
+		// with the reference encoder and then with the tiled compressor in its normal and high-quality modes.
+		// Each mode of the tiled compressor is run once on the main thread, so it can be compared directly
+		// with the reference encoder, and once on the worker threads. Throughput is reported in megapixels
+		// per second, and the RMS error of each result is reported in units of 8-bit color. In a headless
+		// engine, the results go to the log.
+
+		int32 size = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultBlockbenchSize;
+		if (size < 4)
+		{
+			return;
+		}
+
+		size &= ~3;
+		int32 pixelCount = size * size;
+		int32 blockCount = pixelCount >> 4;
+
+		// The image combines smooth gradients with noise so that the blocks cover both
+		// the nearly flat case and the case where the endpoints are hard to choose.
+
+		Color4C *image = new Color4C[pixelCount];
+		for (machine j = 0; j < size; j++)
+		{
+			for (machine i = 0; i < size; i++)
+			{
+				int32 noise = Math::Random(32) - 16;
+				int32 red = MaxZero(Min(i * 255 / size + noise, 255));
+				int32 green = MaxZero(Min(j * 255 / size + noise / 2, 255));
+				image[j * size + i].Set(red, green, (i ^ j) & 255, 255);
+			}
+		}
+
+		unsigned_int8 *data = new unsigned_int8[blockCount * 8 * 5];
+		unsigned_int64 time[6];
+
+		time[0] = TheTimeMgr->GetMicrosecondCount();
+
+		int32 blockCountX = size >> 2;
+		for (machine j = 0; j < blockCountX; j++)
+		{
+			for (machine i = 0; i < blockCountX; i++)
+			{
+				Image::CompressColorBlock(4, 4, size, false, image + (j * size + i) * 4, data + (j * blockCountX + i) * 8);
+			}
+		}
+
+		time[1] = TheTimeMgr->GetMicrosecondCount();
+		Image::CompressImageBC1(1, size, size, image, data + blockCount * 8, kBlockCompressSingleThread);
+
+		time[2] = TheTimeMgr->GetMicrosecondCount();
+		Image::CompressImageBC1(1, size, size, image, data + blockCount * 16);
+
+		time[3] = TheTimeMgr->GetMicrosecondCount();
+		Image::CompressImageBC1(1, size, size, image, data + blockCount * 24, kBlockCompressHighQuality | kBlockCompressSingleThread);
+
+		time[4] = TheTimeMgr->GetMicrosecondCount();
+		Image::CompressImageBC1(1, size, size, image, data + blockCount * 32, kBlockCompressHighQuality);
+
+		time[5] = TheTimeMgr->GetMicrosecondCount();
+
+		String<kMaxCommandLength> report("Size: ");
+		((((report += size) += "  Blocks: ") += blockCount) += "  Workers: ") += TheJobMgr->GetWorkerThreadCount();
+		Report(report);
+
+		static const char *const methodName[5] =
+		{
+			"Reference, main thread: ", "Compressor, main thread: ", "Compressor, workers: ", "High quality, main thread: ", "High quality, workers: "
+		};
+
+		for (machine a = 0; a < 5; a++)
+		{
+			Color4C		decoded[16];
+
+			float error = 0.0F;
+			const unsigned_int8 *code = data + blockCount * 8 * a;
+			for (machine j = 0; j < blockCountX; j++)
+			{
+				for (machine i = 0; i < blockCountX; i++)
+				{
+					Image::DecompressColorBlock(code + (j * blockCountX + i) * 8, decoded);
+
+					const Color4C *source = image + (j * size + i) * 4;
+					for (machine k = 0; k < 16; k++)
+					{
+						const Color4C& c = source[(k >> 2) * size + (k & 3)];
+						float dr = (float) c.GetRed() - (float) decoded[k].GetRed();
+						float dg = (float) c.GetGreen() - (float) decoded[k].GetGreen();
+						float db = (float) c.GetBlue() - (float) decoded[k].GetBlue();
+						error += dr * dr + dg * dg + db * db;
+					}
+				}
+			}
+
+			unsigned_int64 elapsed = Max(time[a + 1] - time[a], (unsigned_int64) 1);
+			float throughput = (float) pixelCount / (float) elapsed;
+
+			report = methodName[a];
+			(((report += String<15>(throughput)) += " MP/s  RMS error: ") += String<15>(Sqrt(error / (float) (pixelCount * 3))));
+			Report(report);
+		}
+
+		delete[] data;
+		delete[] image;
+	}
+
+	void Engine::HandleMoviebenchCommand(Command *command, const char *text)
+	{
+		// The moviebench command compresses a synthetic 1280 x 720 frame twice, once as a single
+		// stream per channel and once as a sliced stream, and then decompresses each one the given
+		// number of times. The sliced stream is decoded by the worker threads, so the ratio between
+		// the two frame rates shows how well decoding scales. In a headless engine, the results go to the log.
+
+		int32 frameCount = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultMoviebenchCount;
+		if (frameCount < 1)
+		{
+			return;
+		}
+
+		enum
+		{
+			kFrameWidth		= 1280,
+			kFrameHeight	= 720
+		};
+
+		int32 pixelCount = kFrameWidth * kFrameHeight;
+
+		Color4C *image = new Color4C[pixelCount];
+		for (machine j = 0; j < kFrameHeight; j++)
+		{
+			for (machine i = 0; i < kFrameWidth; i++)
+			{
+				int32 noise = Math::Random(16) - 8;
+				int32 red = MaxZero(Min(i * 255 / kFrameWidth + noise, 255));
+				int32 green = MaxZero(Min(j * 255 / kFrameHeight + noise, 255));
+				image[j * kFrameWidth + i].Set(red, green, ((i >> 4) ^ (j >> 4)) & 255, 255);
+			}
+		}
+
+		String<kMaxCommandLength> report("Frames: ");
+		(report += frameCount) += "  Workers: ";
+		report += TheJobMgr->GetWorkerThreadCount();
+		Report(report);
+
+		static const char *const methodName[2] = {"Serial: ", "Sliced: "};
+
+		for (machine a = 0; a < 2; a++)
+		{
+			VideoTrackHeader	trackHeader;
+			VideoFrameHeader	frameHeader;
+
+			trackHeader.videoTrackFlags = (a == 0) ? 0 : kVideoSliced;
+			trackHeader.videoFrameCount = 1;
+			trackHeader.videoFrameSize.Set(kFrameWidth, kFrameHeight);
+			trackHeader.videoFrameTime = 0;
+			trackHeader.posterFrameIndex = 0;
+
+			VideoCompressor *compressor = new VideoCompressor(&trackHeader);
+			unsigned_int32 codeSize = compressor->CompressFrame(image, kImageFormatRGBA, &frameHeader, 1.0F, kVideoCompressBaseFrame);
+
+			unsigned_int32 dataSize = frameHeader.luminanceData.GetDataSize();
+			if (a == 0)
+			{
+				dataSize = Max(dataSize, frameHeader.chrominanceData.GetDataSize());
+			}
+			else
+			{
+				dataSize += frameHeader.chrominanceData.GetDataSize();
+			}
+
+			trackHeader.maxFrameCodeSize = sizeof(VideoFrameHeader) + codeSize;
+			trackHeader.maxFrameDataSize = dataSize;
+
+			VideoDecompressor *decompressor = new VideoDecompressor(&trackHeader);
+			char *frameData = reinterpret_cast<char *>(decompressor->GetVideoFrameHeader());
+			MemoryMgr::CopyMemory(&frameHeader, frameData, sizeof(VideoFrameHeader));
+			MemoryMgr::CopyMemory(compressor->GetCompressedCode(false), frameData + sizeof(VideoFrameHeader), codeSize);
+
+			unsigned_int64 startTime = TheTimeMgr->GetMicrosecondCount();
+
+			for (machine k = 0; k < frameCount; k++)
+			{
+				decompressor->DecompressFrame(false);
+			}
+
+			unsigned_int64 elapsed = Max(TheTimeMgr->GetMicrosecondCount() - startTime, (unsigned_int64) 1);
+
+			report = methodName[a];
+			(((report += String<15>((float) frameCount * 1.0e6F / (float) elapsed)) += " fps  Code: ") += (int32) codeSize) += " bytes";
+			Report(report);
+
+			delete decompressor;
+			delete compressor;
+		}
+
+		delete[] image;
+	}
+
+	void Engine::HandleLoadbenchCommand(Command *command, const char *text)
+	{
+		// The loadbench command unpacks the resource for the current world the given number of times,
+		// alternating between unpacking every object on the main thread and letting the geometry objects
+		// be unpacked by the worker threads. It then reloads the world once to measure the complete load
+		// time. In a headless engine, the results go to the log.
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultLoadbenchCount;
+		World *world = TheWorldMgr->GetWorld();
+		if ((count <= 0) || (!world))
+		{
+			return;
+		}
+
+		ResourceName worldName(world->GetWorldName());
+		WorldResource *resource = WorldResource::Get(worldName);
+		if (!resource)
+		{
+			Report("Cannot load world resource");
+			return;
+		}
+
+		int32 objectCount = static_cast<const int32 *>(resource->GetData())[3];
+		unsigned_int64 unpackTime[2] = {0, 0};
+
+		for (machine k = 0; k < count; k++)
+		{
+			for (machine a = 0; a < 2; a++)
+			{
+				unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+				Node *root = Node::UnpackTree(resource->GetData(), (a == 0) ? 0 : kUnpackConcurrent);
+				unpackTime[a] += TheTimeMgr->GetMicrosecondCount() - time;
+
+				delete root;
+			}
+		}
+
+		resource->Release();
+
+		unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+		WorldResult result = TheWorldMgr->LoadWorld(worldName);
+		unsigned_int64 loadTime = TheTimeMgr->GetMicrosecondCount() - time;
+
+		String<kMaxCommandLength> report("World: ");
+		((((report += worldName) += "  Objects: ") += objectCount) += "  Workers: ") += TheJobMgr->GetWorkerThreadCount();
+		Report(report);
+
+		report = "Serial unpack: ";
+		(((report += (int64) (unpackTime[0] / (count * 1000))) += " ms  Concurrent unpack: ") += (int64) (unpackTime[1] / (count * 1000))) += " ms";
+		Report(report);
+
+		if (result == kWorldOkay)
+		{
+			report = "Load: ";
+			(report += (int64) (loadTime / 1000)) += " ms";
+			Report(report);
+		}
+		else
+		{
+			Report("Cannot reload world");
+		}
+	}
+
+	void Engine::HandleSavebenchCommand(Command *command, const char *text)
+	{
+		// The savebench command saves the current world the given number of times, alternating between
+		// a full save and an incremental save. The stall is the time spent in the SaveDeltaWorld() function
+		// on the main thread, and the write time for an incremental save includes the worker job.
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultSavebenchCount;
+		const World *world = TheWorldMgr->GetWorld();
+		if ((count <= 0) || (!world))
+		{
+			return;
+		}
+
+		unsigned_int64 fullTime = 0;
+		unsigned_int64 maxFullTime = 0;
+		unsigned_int64 stallTime = 0;
+		unsigned_int64 maxStallTime = 0;
+		unsigned_int64 writeTime = 0;
+		int32 packedCount = 0;
+		int32 reusedCount = 0;
+
+		for (machine k = 0; k < count; k++)
+		{
+			unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+			TheWorldMgr->SaveDeltaWorld("savebench");
+			unsigned_int64 t = TheTimeMgr->GetMicrosecondCount() - time;
+			fullTime += t;
+			maxFullTime = Max(maxFullTime, t);
+
+			time = TheTimeMgr->GetMicrosecondCount();
+			TheWorldMgr->SaveDeltaWorld("savebench", kDeltaSaveIncremental);
+			t = TheTimeMgr->GetMicrosecondCount() - time;
+			stallTime += t;
+			maxStallTime = Max(maxStallTime, t);
+
+			TheWorldMgr->FinishDeltaSave();
+			writeTime += TheTimeMgr->GetMicrosecondCount() - time;
+
+			const DeltaPackCache *cache = TheWorldMgr->GetDeltaPackCache();
+			packedCount += cache->GetPackedNodeCount();
+			reusedCount += cache->GetReusedNodeCount();
+		}
+
+		String<kMaxCommandLength> report("World: ");
+		((((report += world->GetWorldName()) += "  Packed nodes: ") += packedCount / count) += "  Reused nodes: ") += reusedCount / count;
+		Report(report);
+
+		report = "Full save stall: ";
+		(((report += (int64) (fullTime / count)) += " us  Max: ") += (int64) maxFullTime) += " us";
+		Report(report);
+
+		report = "Incremental save stall: ";
+		(((((report += (int64) (stallTime / count)) += " us  Max: ") += (int64) maxStallTime) += " us  Write: ") += (int64) (writeTime / count)) += " us";
+		Report(report);
+	}
+
+	void Engine::HandleAtombenchCommand(Command *command, const char *text)
+	{
+		// The atombench command measures the cost of searching a map of script value names, first with
+		// string keys as values were stored before, then with atom keys looked up from the same strings,
+		// and finally with atom keys that were looked up in advance.
+
+		class StringElement : public MapElement<StringElement>
+		{
+			public:
+
+				ValueName		elementName;
+
+				typedef ConstCharKey KeyType;
+
+				KeyType GetKey(void) const
+				{
+					return (elementName);
+				}
+		};
+
+		class AtomElement : public MapElement<AtomElement>
+		{
+			public:
+
+				TextAtom		elementAtom;
+
+				typedef AtomKey KeyType;
+
+				KeyType GetKey(void) const
+				{
+					return (elementAtom);
+				}
+		};
+
+		enum
+		{
+			kAtombenchNameCount = 256
+		};
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultAtombenchCount;
+		if (count <= 0)
+		{
+			return;
+		}
+
+		Map<StringElement>		stringMap;
+		Map<AtomElement>		atomMap;
+
+		ValueName *nameTable = new ValueName[kAtombenchNameCount];
+		AtomKey *keyTable = new AtomKey[kAtombenchNameCount];
+
+		for (machine a = 0; a < kAtombenchNameCount; a++)
+		{
+			// Names share a long prefix so that string comparisons have to look past it,
+			// which is typical of script variables named after the objects they control.
+
+			(nameTable[a] = "atombenchVariable") += (int32) ((a * 97) & (kAtombenchNameCount - 1));
+
+			StringElement *stringElement = new StringElement;
+			stringElement->elementName = nameTable[a];
+			stringMap.Insert(stringElement);
+
+			AtomElement *atomElement = new AtomElement;
+			atomElement->elementAtom = TextAtom(nameTable[a]);
+			atomMap.Insert(atomElement);
+
+			keyTable[a] = atomElement->elementAtom;
+		}
+
+		int32 stringFound = 0;
+		unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+		for (machine k = 0; k < count; k++)
+		{
+			for (machine a = 0; a < kAtombenchNameCount; a++)
+			{
+				stringFound += (stringMap.Find(nameTable[a]) != nullptr);
+			}
+		}
+
+		unsigned_int64 stringTime = TheTimeMgr->GetMicrosecondCount() - time;
+
+		int32 atomFound = 0;
+		time = TheTimeMgr->GetMicrosecondCount();
+		for (machine k = 0; k < count; k++)
+		{
+			for (machine a = 0; a < kAtombenchNameCount; a++)
+			{
+				atomFound += (atomMap.Find(nameTable[a]) != nullptr);
+			}
+		}
+
+		unsigned_int64 atomTime = TheTimeMgr->GetMicrosecondCount() - time;
+
+		int32 keyFound = 0;
+		time = TheTimeMgr->GetMicrosecondCount();
+		for (machine k = 0; k < count; k++)
+		{
+			for (machine a = 0; a < kAtombenchNameCount; a++)
+			{
+				keyFound += (atomMap.Find(keyTable[a]) != nullptr);
+			}
+		}
+
+		unsigned_int64 keyTime = TheTimeMgr->GetMicrosecondCount() - time;
+
+		delete[] keyTable;
+		delete[] nameTable;
+
+		float scale = 1000.0F / (float) (count * kAtombenchNameCount);
+
+		String<kMaxCommandLength> report("Lookups: ");
+		((((report += count * kAtombenchNameCount) += "  Found: ") += Min(Min(stringFound, atomFound), keyFound)) += "  Atoms: ") += (int32) TextAtom::GetAtomCount();
+		Report(report);
+
+		report = "String key: ";
+		((((report += String<15>((float) stringTime * scale)) += " ns  Atom from string: ") += String<15>((float) atomTime * scale)) += " ns  Atom key: ") += String<15>((float) keyTime * scale);
+		Report(report += " ns");
+	}
+
+
+	class HashbenchMapElement : public MapElement<HashbenchMapElement>
+	{
+		public:
+
+			typedef unsigned_int32 KeyType;
+
+			unsigned_int32		elementKey;
+
+			HashbenchMapElement(unsigned_int32 key)
+			{
+				elementKey = key;
+			}
+
+			KeyType GetKey(void) const
+			{
+				return (elementKey);
+			}
+	};
+
+
+	class HashbenchHashElement : public HashTableElement<HashbenchHashElement>
+	{
+		public:
+
+			typedef unsigned_int32 KeyType;
+
+			unsigned_int32		elementKey;
+
+			HashbenchHashElement(unsigned_int32 key)
+			{
+				elementKey = key;
+			}
+
+			KeyType GetKey(void) const
+			{
+				return (elementKey);
+			}
+
+			static unsigned_int32 Hash(KeyType key)
+			{
+				return (key);
+			}
+	};
+
+
+	class HashbenchFlatElement : public FlatHashTableElement<HashbenchFlatElement>
+	{
+		public:
+
+			typedef unsigned_int32 KeyType;
+
+			unsigned_int32		elementKey;
+
+			HashbenchFlatElement(unsigned_int32 key)
+			{
+				elementKey = key;
+			}
+
+			KeyType GetKey(void) const
+			{
+				return (elementKey);
+			}
+
+			static unsigned_int32 Hash(KeyType key)
+			{
+				return (key);
+			}
+	};
+
+
+	template <class containerType, class elementType> static int32 BenchmarkHashContainer(containerType *container, int32 repeat, int32 elementCount, const unsigned_int32 *keyTable, unsigned_int64 *timeTable)
+	{
+		// The key table holds the keys of the elements followed by the same number of keys that are
+		// never inserted. Elements are allocated in a shuffled order so that neighboring keys do not
+		// occupy neighboring memory, as would be the case for resources loaded over time.
+
+		elementType **elementTable = new elementType *[elementCount];
+		for (machine a = 0; a < elementCount; a++)
+		{
+			elementTable[(a * 7919) % elementCount] = new elementType(keyTable[(a * 7919) % elementCount]);
+		}
+
+		unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+		for (machine a = 0; a < elementCount; a++)
+		{
+			container->Insert(elementTable[a]);
+		}
+
+		timeTable[0] = TheTimeMgr->GetMicrosecondCount() - time;
+
+		int32 found = 0;
+		time = TheTimeMgr->GetMicrosecondCount();
+		for (machine k = 0; k < repeat; k++)
+		{
+			for (machine a = 0; a < elementCount; a++)
+			{
+				found += (container->Find(keyTable[a]) != nullptr);
+			}
+		}
+
+		timeTable[1] = TheTimeMgr->GetMicrosecondCount() - time;
+
+		time = TheTimeMgr->GetMicrosecondCount();
+		for (machine k = 0; k < repeat; k++)
+		{
+			for (machine a = 0; a < elementCount; a++)
+			{
+				found -= (container->Find(keyTable[elementCount + a]) != nullptr);
+			}
+		}
+
+		timeTable[2] = TheTimeMgr->GetMicrosecondCount() - time;
+
+		time = TheTimeMgr->GetMicrosecondCount();
+		for (machine a = 0; a < elementCount; a++)
+		{
+			delete elementTable[a];
+		}
+
+		timeTable[3] = TheTimeMgr->GetMicrosecondCount() - time;
+
+		delete[] elementTable;
+		return (found / repeat);
+	}
+
+	void Engine::HandleHashbenchCommand(Command *command, const char *text)
+	{
+		// The hashbench command compares Map, HashTable, and FlatHashTable containers holding 64, 1024,
+		// and 16384 elements with random 32-bit keys. For each size, it reports the average time per
+		// element to insert, to find an existing key, to search for a missing key, and to delete.
+
+		static const char *const containerName[3] = {"Map", "HashTable", "FlatHashTable"};
+		static const int32 elementCount[3] = {64, 1024, 16384};
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultHashbenchCount;
+		if (count <= 0)
+		{
+			return;
+		}
+
+		unsigned_int32 *keyTable = new unsigned_int32[elementCount[2] * 2];
+
+		unsigned_int32 key = 0x12345678;
+		for (machine a = 0; a < elementCount[2] * 2; a++)
+		{
+			key = key * 1664525 + 1013904223;
+			keyTable[a] = key;
+		}
+
+		for (machine size = 0; size < 3; size++)
+		{
+			int32 elements = elementCount[size];
+
+			// Lookups are repeated so that every size performs about the same number of them.
+
+			int32 repeat = count * (elementCount[2] / elements);
+
+			for (machine type = 0; type < 3; type++)
+			{
+				unsigned_int64	timeTable[4];
+				int32			found;
+
+				if (type == 0)
+				{
+					Map<HashbenchMapElement> map;
+					found = BenchmarkHashContainer<Map<HashbenchMapElement>, HashbenchMapElement>(&map, repeat, elements, keyTable, timeTable);
+				}
+				else if (type == 1)
+				{
+					HashTable<HashbenchHashElement> table(16, 4);
+					found = BenchmarkHashContainer<HashTable<HashbenchHashElement>, HashbenchHashElement>(&table, repeat, elements, keyTable, timeTable);
+				}
+				else
+				{
+					FlatHashTable<HashbenchFlatElement> table;
+					found = BenchmarkHashContainer<FlatHashTable<HashbenchFlatElement>, HashbenchFlatElement>(&table, repeat, elements, keyTable, timeTable);
+				}
+
+				float scale = 1000.0F / (float) elements;
+				float lookupScale = scale / (float) repeat;
+
+				String<kMaxCommandLength> report(containerName[type]);
+				((((report += " ") += elements) += "  Found: ") += found) += "  Insert: ";
+				(((report += String<15>((float) timeTable[0] * scale)) += " ns  Hit: ") += String<15>((float) timeTable[1] * lookupScale)) += " ns  Miss: ";
+				(((report += String<15>((float) timeTable[2] * lookupScale)) += " ns  Delete: ") += String<15>((float) timeTable[3] * scale)) += " ns";
+				Report(report);
+			}
+		}
+
+		delete[] keyTable;
+	}
+
+
+	class StreambenchStreamer : public SoundStreamer
+	{
+		private:
+
+			int32		readDelay;
+			int32		fillCount;
+
+		public:
+
+			StreambenchStreamer(int32 delay)
+			{
+				readDelay = delay;
+				fillCount = 0;
+
+				SetStreamChannelCount(2);
+				SetStreamSampleRate(44100);
+				AllocateStreamMemory(0, kOutputBufferFrameCount * 8 * 2 * sizeof(Sample));
+			}
+
+			int32 GetFillCount(void) const
+			{
+				return (fillCount);
+			}
+
+			SoundResult StartStream(void) override
+			{
+				return (kSoundOkay);
+			}
+
+			bool FillBuffer(unsigned_int32 bufferSize, Sample *buffer, int32 *count) override
+			{
+				// The delay stands in for a blocking disk read.
+
+				MemoryMgr::ClearMemory(buffer, bufferSize);
+				Thread::Sleep(readDelay);
+
+				fillCount++;
+				*count = bufferSize / (2 * sizeof(Sample));
+				return (true);
+			}
+	};
+
+
+	void Engine::HandleStreambenchCommand(Command *command, const char *text)
+	{
+		// The streambench command plays kMaxSoundCount synthetic streams for the given number of output
+		// blocks without using the output device, so it also works in a headless engine. Every sixteenth
+		// stream takes 40 ms to fill each buffer, simulating a slow disk, and the others take 1 ms. It
+		// reports the number of buffers filled and the number of times a stream ran out of data.
+
+		int32 count = (text[0] != 0) ? Text::StringToInteger(text) : kDefaultStreambenchCount;
+		if (count <= 0)
+		{
+			return;
+		}
+
+		StreambenchStreamer		*streamerTable[kMaxSoundCount];
+		Sound					*soundTable[kMaxSoundCount];
+
+		for (machine a = 0; a < kMaxSoundCount; a++)
+		{
+			StreambenchStreamer *streamer = new StreambenchStreamer(((a & 15) == 0) ? 40 : 1);
+			streamerTable[a] = streamer;
+
+			Sound *sound = new Sound;
+			sound->Stream(streamer);
+			soundTable[a] = sound;
+		}
+
+		unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+		int32 underrunCount = TheSoundMgr->StressTestStreaming(kMaxSoundCount, soundTable, count);
+		time = TheTimeMgr->GetMicrosecondCount() - time;
+
+		int32 fillCount = 0;
+		for (machine a = 0; a < kMaxSoundCount; a++)
+		{
+			fillCount += streamerTable[a]->GetFillCount();
+			soundTable[a]->Release();
+		}
+
+		String<kMaxCommandLength> report("Streams: ");
+		((((report += (int32) kMaxSoundCount) += "  Workers: ") += TheSoundMgr->GetStreamWorkerCount()) += "  Depth: ") += TheSoundMgr->GetStreamBufferCount();
+		((((report += "  Blocks: ") += count) += "  Fills: ") += fillCount) += "  Underruns: ";
+		((report += underrunCount) += "  Time: ") += String<15>((float) time * 0.001F);
+		Report(report += " ms");
+	}
+
+#endif
+
+#if C4PROFILE
+
+	void Engine::HandleProfCommand(Command *command, const char *text)
+	{
+		// With no parameters, the prof command toggles the profiler. The -spike option sets the
+		// frame time in milliseconds above which the timelines are exported automatically, and
+		// any other parameter is the name of a trace file to export immediately.
+
+		if (text[0] == 0)
+		{
+			Profiler::SetEnabled(!Profiler::Enabled());
+			return;
+		}
+
+		String<kMaxCommandLength>	param;
+
+		text += Text::ReadString(text, param, kMaxCommandLength);
+		text += Data::GetWhitespaceLength(text);
+
+		if (param == "-spike")
+		{
+			Text::ReadString(text, param, kMaxCommandLength);
+			Profiler::SetSpikeThreshold(MaxZero(Text::StringToInteger(param)) * 1000);
+			Profiler::SetEnabled(true);
+		}
+		else
+		{
+			String<kMaxFileNameLength> path(TheResourceMgr->GetSaveCatalog()->GetRootPath());
+			(path += param) += ".json";
+			Profiler::ExportTrace(path);
+		}
+	}
+
 #endif
 
 #if C4DIAGS
@@ -510,16 +1527,28 @@ void Engine::HandleDisconnectCommand(Command *command, const char *text)
 
 	void Engine::HandleRsrcCommand(Command *command, const char *text)
 	{
-		TheConsoleWindow->AddText("\n[#FFF]Resource type[RGHT]Cache size");
+		// A parameter sets the memory budget of the resource cache in megabytes.
+
+		if (text[0] != 0)
+		{
+			TheResourceMgr->SetCacheBudget((unsigned_int64) MaxZero(Text::StringToInteger(text)) << 20);
+		}
+
+		String<kMaxCommandLength> report("\n[#FFF]Resource cache[RGHT]");
+		((report += (int64) TheResourceMgr->GetCacheSize()) += " / ") += (int64) TheResourceMgr->GetCacheBudget();
+		TheConsoleWindow->AddText(report);
 
-		const ResourceCatalog *catalog = TheResourceMgr->GetVirtualCatalog();
-		const Map<ResourceTracker> *trackerMap = catalog->GetTrackerMap();
+		TheConsoleWindow->AddText("[#FFF]Resource type[RGHT]Cached  Hits  Misses  Evicted");
 
-		const ResourceTracker *tracker = trackerMap->First();
-		while (tracker)
+		const ResourceCacheStatistics *statistics = TheResourceMgr->GetFirstCacheStatistics();
+		while (statistics)
 		{
-			TheConsoleWindow->AddText((String<kMaxCommandLength>(Text::TypeToString((tracker->GetResourceType() << 8) | 0x20)) += "[RGHT]") += tracker->GetCurrentCacheSize());
-			tracker = tracker->Next();
+			report = Text::TypeToString((statistics->GetResourceType() << 8) | 0x20);
+			((((report += "[RGHT]") += (int64) statistics->GetCachedBytes()) += "  ") += statistics->GetHitCount()) += "  ";
+			((report += statistics->GetMissCount()) += "  ") += (int64) statistics->GetEvictedBytes();
+			TheConsoleWindow->AddText(report);
+
+			statistics = statistics->Next();
 		}
 	}
 
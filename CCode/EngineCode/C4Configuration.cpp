@@ -61,6 +61,7 @@ Setting::Setting(const Setting& setting)
 	settingType = setting.settingType;
 	settingIdentifier = setting.settingIdentifier;
 	settingValueName = setting.settingValueName;
+	settingValueAtom = setting.settingValueAtom;
 	settingInterface = nullptr;
 }
 
@@ -162,6 +163,7 @@ bool Setting::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsign
 		case 'VALU':
 
 			data >> settingValueName;
+			settingValueAtom = TextAtom(settingValueName);
 			return (true);
 	}
 
@@ -171,6 +173,7 @@ bool Setting::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsign
 void *Setting::BeginSettingsUnpack(void)
 {
 	settingValueName[0] = 0;
+	settingValueAtom = TextAtom();
 	return (nullptr);
 }
 
@@ -14,6 +14,7 @@
 #include "C4FilePicker.h"
 #include "C4ColorPicker.h"
 #include "C4Messages.h"
+#include "C4Atoms.h"
 
 
 namespace C4
@@ -152,6 +153,7 @@ namespace C4
 			SettingType			settingType;
 			Type				settingIdentifier;
 			ValueName			settingValueName;
+			TextAtom			settingValueAtom;
 
 			SettingInterface	*settingInterface;
 
@@ -184,9 +186,15 @@ namespace C4
 				return (settingValueName);
 			}
 
+			const TextAtom& GetSettingValueAtom(void) const
+			{
+				return (settingValueAtom);
+			}
+
 			void SetSettingValueName(const char *name)
 			{
 				settingValueName = name;
+				settingValueAtom = TextAtom(settingValueName);
 			}
 
 			SettingInterface *GetSettingInterface(void) const
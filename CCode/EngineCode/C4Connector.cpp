@@ -49,6 +49,10 @@ Node *Connector::GetConnectorTarget(void) const
 
 void Connector::SetConnectorTarget(Node *node)
 {
+	// The packed data for the connector's node holds the index of the target node.
+
+	GetStartElement()->GetNode()->InvalidateDeltaPack();
+
 	if (node)
 	{
 		Hub *finish = node->GetHub();
@@ -0,0 +1,1043 @@
+ 
+
+#include "C4ContactSolver.h"
+#include "C4Physics.h"
+#include "C4Simulation.h"
+
+
+using namespace C4;
+
+
+bool ContactSolver::comparisonEnabled = false;
+Mutex ContactSolver::comparisonMutex;
+ContactSolverComparison ContactSolver::comparisonData;
+
+
+ContactSolver::ContactSolver()
+{
+	bodyCount = 0;
+	solverBody = nullptr;
+
+	rowCount = 0;
+	blockCount = 0;
+	rowBlock = nullptr;
+	blockStorage = nullptr;
+
+	colorCount = 0;
+	contactCount = 0;
+	contactTable = nullptr;
+
+	solverStorage = nullptr;
+
+	parallelFlag = false;
+	solverJobCount = 0;
+	solverJob = nullptr;
+
+	stateBodyCount = 0;
+	stateContactCount = 0;
+	bodyState = nullptr;
+	contactState = nullptr;
+}
+
+ContactSolver::~ContactSolver()
+{
+	Purge();
+}
+
+void ContactSolver::Purge(void)
+{
+	delete[] solverJob;
+	solverJob = nullptr;
+	solverJobCount = 0;
+	parallelFlag = false;
+
+	delete[] blockStorage;
+	blockStorage = nullptr;
+	rowBlock = nullptr;
+	blockCount = 0;
+	rowCount = 0;
+
+	delete[] solverStorage;
+	solverStorage = nullptr;
+	solverBody = nullptr;
+	contactTable = nullptr;
+	bodyCount = 0;
+	contactCount = 0;
+
+	delete[] contactState;
+	contactState = nullptr;
+	stateContactCount = 0;
+
+	delete[] bodyState;
+	bodyState = nullptr;
+	stateBodyCount = 0;
+}
+
+bool ContactSolver::Eligible(const List<RigidBodyController> *bodyList, int32 *subcontactCount)
+{
+	// An island can be solved in batches only if every enabled contact is a collision contact and
+	// none of the rigid bodies use rolling resistance or spin friction, which depend on the
+	// velocities at the time each individual contact is solved.
+
+	int32 count = 0;
+
+	const RigidBodyController *rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		if ((rigidBody->GetRollingResistance() > 0.0F) || (rigidBody->GetSpinFrictionMultiplier() > 0.0F))
+		{
+			return (false);
+		}
+
+		const Contact *contact = rigidBody->GetFirstOutgoingEdge();
+		while (contact)
+		{
+			if (contact->Enabled())
+			{
+				ContactType type = contact->GetContactType();
+				if ((type != kContactRigidBody) && (type != kContactGeometry))
+				{
+					return (false);
+				}
+
+				count += static_cast<const CollisionContact *>(contact)->GetSubcontactCount();
+			}
+
+			contact = contact->GetNextOutgoingEdge();
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+
+	*subcontactCount = count;
+	return (true);
+}
+
+bool ContactSolver::CalculateRowGeometry(CollisionContact *contact, int32 index, ContactRow *row)
+{
+	Subcontact *subcontact = &contact->subcontact[index];
+
+	const RigidBodyController *rigidBody1 = static_cast<RigidBodyController *>(contact->GetStartElement());
+	const Transform4D& transform1 = rigidBody1->GetFinalTransform();
+	Point3D worldPosition1 = transform1 * subcontact->alphaPosition;
+	Point3D worldPosition2;
+
+	row->collisionContact = contact;
+	row->subcontactIndex = index;
+	row->bodyIndex[0] = rigidBody1->solverBodyIndex;
+	row->contactDirection[0] = worldPosition1 - transform1 * rigidBody1->GetBodyCenterOfMass();
+	row->bounceSpeed = subcontact->bounceSpeed;
+
+	if (contact->GetContactType() == kContactRigidBody)
+	{
+		const RigidBodyController *rigidBody2 = static_cast<RigidBodyController *>(contact->GetFinishElement());
+		const Transform4D& transform2 = rigidBody2->GetFinalTransform();
+		worldPosition2 = transform2 * subcontact->betaPosition;
+
+		row->bodyIndex[1] = rigidBody2->solverBodyIndex;
+		row->contactDirection[1] = worldPosition2 - transform2 * rigidBody2->GetBodyCenterOfMass();
+		row->worldNormal = transform1 * subcontact->alphaNormal;
+		row->worldTangent[0] = transform1 * subcontact->alphaTangent[0];
+		row->worldTangent[1] = transform1 * subcontact->alphaTangent[1];
+		row->geometryVelocity.Set(0.0F, 0.0F, 0.0F);
+		row->frictionCoefficient = Fmin(rigidBody1->GetFrictionCoefficient(), rigidBody2->GetFrictionCoefficient());
+	}
+	else
+	{
+		const Geometry *geometry = static_cast<GeometryContact *>(contact)->GetContactGeometry();
+		const Transform4D& transform2 = geometry->GetWorldTransform();
+		worldPosition2 = transform2 * subcontact->betaPosition;
+
+		row->bodyIndex[1] = 0;
+		row->contactDirection[1].Set(0.0F, 0.0F, 0.0F);
+		row->worldNormal = subcontact->betaNormal * geometry->GetInverseWorldTransform();
+		row->worldTangent[0] = transform2 * subcontact->betaTangent[0];
+		row->worldTangent[1] = transform2 * subcontact->betaTangent[1];
+		row->geometryVelocity = geometry->GetGeometryVelocity();
+		row->frictionCoefficient = rigidBody1->GetFrictionCoefficient();
+	}
+
+	// The subcontact is activated in exactly the same way that the contact's own velocity constraint
+	// function would activate it during the first iteration of the scalar solver.
+
+	float separation = (worldPosition2 - worldPosition1) * row->worldNormal;
+	if (separation < -kContactEpsilon)
+	{
+		subcontact->inactiveStepCount = 0;
+
+		if (separation < 0.0F)
+		{
+			subcontact->activeFlag = true;
+		}
+	}
+
+	return (subcontact->activeFlag);
+}
+
+void ContactSolver::FillRowLanes(RowLanes *lanes, int32 lane, const Vector3D& direction, const ContactRow *row, const SolverBody *body1, const SolverBody *body2)
+{
+	const RigidBodyController *rigidBody1 = body1->rigidBody;
+	Vector3D angular1 = direction % row->contactDirection[0];
+	Vector3D inverseAngular1 = rigidBody1->inverseWorldInertiaTensor * angular1;
+	float k = SquaredMag(direction) * rigidBody1->inverseBodyMass + angular1 * inverseAngular1;
+
+	Vector3D angular2 = row->contactDirection[1] % direction;
+	Vector3D inverseAngular2(0.0F, 0.0F, 0.0F);
+
+	const RigidBodyController *rigidBody2 = body2->rigidBody;
+	if (rigidBody2)
+	{
+		inverseAngular2 = rigidBody2->inverseWorldInertiaTensor * angular2;
+		k += SquaredMag(direction) * rigidBody2->inverseBodyMass + angular2 * inverseAngular2;
+	}
+
+	for (machine i = 0; i < 3; i++)
+	{
+		lanes->direction[i][lane] = direction[i];
+		lanes->angular[0][i][lane] = angular1[i];
+		lanes->angular[1][i][lane] = angular2[i];
+		lanes->inverseAngular[0][i][lane] = inverseAngular1[i];
+		lanes->inverseAngular[1][i][lane] = inverseAngular2[i];
+	}
+
+	lanes->effectiveMass[lane] = (k > K::min_float) ? 1.0F / k : 0.0F;
+	lanes->impulse[lane] = 0.0F;
+}
+
+void ContactSolver::FillBlockLane(RowBlock *block, int32 lane, const ContactRow *row)
+{
+	int32 index1 = row->bodyIndex[0];
+	int32 index2 = row->bodyIndex[1];
+	const SolverBody *body1 = &solverBody[index1];
+	const SolverBody *body2 = &solverBody[index2];
+
+	block->bodyIndex[0][lane] = index1;
+	block->bodyIndex[1][lane] = index2;
+	block->inverseMass[0][lane] = body1->inverseMass;
+	block->inverseMass[1][lane] = body2->inverseMass;
+	block->normalBias[lane] = -row->bounceSpeed;
+	block->frictionCoefficient[lane] = row->frictionCoefficient;
+	block->collisionContact[lane] = row->collisionContact;
+	block->subcontactIndex[lane] = row->subcontactIndex;
+
+	// The friction rows point opposite the tangents so that the same Jacobian
+	// layout can be used for every row in the block. A moving geometry has no
+	// solver body, so its velocity enters the friction rows through their biases,
+	// and friction acts on the velocity relative to the geometry.
+
+	block->tangentBias[0][lane] = row->geometryVelocity * -row->worldTangent[0];
+	block->tangentBias[1][lane] = row->geometryVelocity * -row->worldTangent[1];
+
+	FillRowLanes(&block->normalRow, lane, row->worldNormal, row, body1, body2);
+	FillRowLanes(&block->tangentRow[0], lane, -row->worldTangent[0], row, body1, body2);
+	FillRowLanes(&block->tangentRow[1], lane, -row->worldTangent[1], row, body1, body2);
+}
+
+bool ContactSolver::Build(const List<RigidBodyController> *bodyList)
+{
+	int32 maxContactCount = 0;
+	int32 maxRowCount = 0;
+	int32 count = 1;
+
+	RigidBodyController *rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		if ((rigidBody->GetRollingResistance() > 0.0F) || (rigidBody->GetSpinFrictionMultiplier() > 0.0F))
+		{
+			return (false);
+		}
+
+		rigidBody->solverBodyIndex = count++;
+
+		const Contact *contact = rigidBody->GetFirstOutgoingEdge();
+		while (contact)
+		{
+			if (contact->Enabled())
+			{
+				ContactType type = contact->GetContactType();
+				if ((type != kContactRigidBody) && (type != kContactGeometry))
+				{
+					return (false);
+				}
+
+				maxContactCount++;
+				maxRowCount += static_cast<const CollisionContact *>(contact)->GetSubcontactCount();
+			}
+
+			contact = contact->GetNextOutgoingEdge();
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+
+	if (maxRowCount < kMinContactSolverRowCount)
+	{
+		return (false);
+	}
+
+	bodyCount = count;
+
+	unsigned_int32 bodySize = count * sizeof(SolverBody);
+	unsigned_int32 rowSize = maxRowCount * sizeof(ContactRow);
+	unsigned_int32 contactSize = maxContactCount * (sizeof(CollisionContact *) * 2 + sizeof(int32));
+	solverStorage = new char[bodySize + rowSize + contactSize + count * sizeof(unsigned_int32)];
+
+	solverBody = reinterpret_cast<SolverBody *>(solverStorage);
+	ContactRow *contactRow = reinterpret_cast<ContactRow *>(solverStorage + bodySize);
+	contactTable = reinterpret_cast<CollisionContact **>(solverStorage + bodySize + rowSize);
+	CollisionContact **sortedTable = contactTable + maxContactCount;
+	int32 *contactColor = reinterpret_cast<int32 *>(sortedTable + maxContactCount);
+	unsigned_int32 *colorMask = reinterpret_cast<unsigned_int32 *>(contactColor + maxContactCount);
+
+	// Body zero stands for static geometry and for unused lanes. It never moves because
+	// its inverse mass and inverse inertia are zero.
+
+	SolverBody *body = solverBody;
+	body->linearVelocity.Set(0.0F, 0.0F, 0.0F);
+	body->angularVelocity.Set(0.0F, 0.0F, 0.0F);
+	body->inverseMass = 0.0F;
+	body->rigidBody = nullptr;
+
+	rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		body++;
+		body->linearVelocity = rigidBody->linearVelocity;
+		body->angularVelocity = rigidBody->angularVelocity;
+		body->inverseMass = rigidBody->inverseBodyScalarInertia;
+		body->rigidBody = rigidBody;
+
+		rigidBody = rigidBody->Next();
+	}
+
+	int32 totalRowCount = 0;
+	int32 totalContactCount = 0;
+
+	rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		Contact *contact = rigidBody->GetFirstOutgoingEdge();
+		while (contact)
+		{
+			if (contact->Enabled())
+			{
+				CollisionContact *collisionContact = static_cast<CollisionContact *>(contact);
+				contactTable[totalContactCount++] = collisionContact;
+
+				int32 subcontactCount = collisionContact->subcontactCount;
+				for (machine a = 0; a < subcontactCount; a++)
+				{
+					if (CalculateRowGeometry(collisionContact, a, &contactRow[totalRowCount]))
+					{
+						totalRowCount++;
+					}
+				}
+			}
+
+			contact = contact->GetNextOutgoingEdge();
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+
+	contactCount = totalContactCount;
+	rowCount = totalRowCount;
+	if (totalRowCount < kMinContactSolverRowCount)
+	{
+		return (false);
+	}
+
+	// Greedily assign each row the lowest color not already used by either of its bodies.
+	// Rows that cannot be given one of the regular colors go into an overflow color whose
+	// blocks each hold a single row and are always solved serially.
+
+	int32	colorRowCount[kMaxContactSolverColorCount + 1];
+
+	for (machine c = 0; c <= kMaxContactSolverColorCount; c++)
+	{
+		colorRowCount[c] = 0;
+	}
+
+	MemoryMgr::ClearMemory(colorMask, count * sizeof(unsigned_int32));
+
+	int32 maxColor = 0;
+	for (machine a = 0; a < totalRowCount; a++)
+	{
+		ContactRow *row = &contactRow[a];
+		int32 index1 = row->bodyIndex[0];
+		int32 index2 = row->bodyIndex[1];
+
+		unsigned_int32 mask = colorMask[index1] | colorMask[index2];
+		if (mask != 0xFFFFFFFF)
+		{
+			unsigned_int32 bit = ~mask & (mask + 1);
+			int32 color = 31 - Cntlz(bit);
+			maxColor = Max(maxColor, color + 1);
+
+			row->rowColor = color;
+			colorMask[index1] |= bit;
+			colorMask[index2] |= bit;
+			colorMask[0] = 0;
+		}
+		else
+		{
+			row->rowColor = kMaxContactSolverColorCount;
+		}
+
+		colorRowCount[row->rowColor]++;
+	}
+
+	colorCount = maxColor;
+
+	int32 totalBlockCount = 0;
+	for (machine c = 0; c < kMaxContactSolverColorCount; c++)
+	{
+		colorStart[c] = totalBlockCount;
+		totalBlockCount += (colorRowCount[c] + (kContactSolverLaneCount - 1)) / kContactSolverLaneCount;
+	}
+
+	colorStart[kMaxContactSolverColorCount] = totalBlockCount;
+	totalBlockCount += colorRowCount[kMaxContactSolverColorCount];
+	colorStart[kMaxContactSolverColorCount + 1] = totalBlockCount;
+
+	// Unused lanes are left cleared so that they refer to body zero with zero effective mass,
+	// which always produces a zero impulse.
+
+	blockCount = totalBlockCount;
+	unsigned_int32 blockSize = totalBlockCount * sizeof(RowBlock);
+	blockStorage = new char[blockSize + 15];
+	rowBlock = reinterpret_cast<RowBlock *>((reinterpret_cast<machine_address>(blockStorage) + 15) & ~15);
+	MemoryMgr::ClearMemory(rowBlock, blockSize);
+
+	for (machine c = 0; c <= kMaxContactSolverColorCount; c++)
+	{
+		colorRowCount[c] = 0;
+	}
+
+	for (machine a = 0; a < totalRowCount; a++)
+	{
+		const ContactRow *row = &contactRow[a];
+		int32 color = row->rowColor;
+		int32 index = colorRowCount[color]++;
+
+		if (color < kMaxContactSolverColorCount)
+		{
+			FillBlockLane(&rowBlock[colorStart[color] + index / kContactSolverLaneCount], index & (kContactSolverLaneCount - 1), row);
+		}
+		else
+		{
+			FillBlockLane(&rowBlock[colorStart[color] + index], 0, row);
+		}
+	}
+
+	// Large islands solved on the main thread spread each color over the worker threads.
+
+	parallelFlag = ((totalRowCount >= kMinParallelContactSolverRowCount) && (Thread::MainThread()) && (TheJobMgr->GetWorkerThreadCount() > 1));
+
+	if (!parallelFlag)
+	{
+		contactColorStart[0] = 0;
+		for (machine c = 1; c < kMaxContactSolverColorCount + 2; c++)
+		{
+			contactColorStart[c] = totalContactCount;
+		}
+	}
+	else
+	{
+		int32 workerCount = TheJobMgr->GetWorkerThreadCount();
+		solverJobCount = workerCount;
+		solverJob = new SolverJob[workerCount];
+		for (machine a = 0; a < workerCount; a++)
+		{
+			solverJob[a].contactSolver = this;
+		}
+
+		// The position constraints are still applied contact by contact, so the contacts
+		// themselves are also colored to let the position pass run in parallel.
+
+		int32	colorContactCount[kMaxContactSolverColorCount + 1];
+
+		for (machine c = 0; c <= kMaxContactSolverColorCount; c++)
+		{
+			colorContactCount[c] = 0;
+		}
+
+		MemoryMgr::ClearMemory(colorMask, count * sizeof(unsigned_int32));
+
+		for (machine a = 0; a < totalContactCount; a++)
+		{
+			const CollisionContact *contact = contactTable[a];
+			int32 index1 = static_cast<RigidBodyController *>(contact->GetStartElement())->solverBodyIndex;
+			int32 index2 = (contact->GetContactType() == kContactRigidBody) ? static_cast<RigidBodyController *>(contact->GetFinishElement())->solverBodyIndex : 0;
+
+			int32 color = kMaxContactSolverColorCount;
+			unsigned_int32 mask = colorMask[index1] | colorMask[index2];
+			if (mask != 0xFFFFFFFF)
+			{
+				unsigned_int32 bit = ~mask & (mask + 1);
+				color = 31 - Cntlz(bit);
+				colorMask[index1] |= bit;
+				colorMask[index2] |= bit;
+				colorMask[0] = 0;
+			}
+
+			contactColor[a] = color;
+			colorContactCount[color]++;
+		}
+
+		int32 start = 0;
+		for (machine c = 0; c <= kMaxContactSolverColorCount; c++)
+		{
+			contactColorStart[c] = start;
+			start += colorContactCount[c];
+			colorContactCount[c] = contactColorStart[c];
+		}
+
+		contactColorStart[kMaxContactSolverColorCount + 1] = start;
+
+		for (machine a = 0; a < totalContactCount; a++)
+		{
+			sortedTable[colorContactCount[contactColor[a]]++] = contactTable[a];
+		}
+
+		contactTable = sortedTable;
+	}
+
+	return (true);
+}
+
+void ContactSolver::SolveBlock(RowBlock *block)
+{
+	alignas(16) float	velocity[4][3][kContactSolverLaneCount];
+
+	for (machine k = 0; k < kContactSolverLaneCount; k++)
+	{
+		const SolverBody *body1 = &solverBody[block->bodyIndex[0][k]];
+		const SolverBody *body2 = &solverBody[block->bodyIndex[1][k]];
+
+		for (machine i = 0; i < 3; i++)
+		{
+			velocity[0][i][k] = body1->linearVelocity[i];
+			velocity[1][i][k] = body1->angularVelocity[i];
+			velocity[2][i][k] = body2->linearVelocity[i];
+			velocity[3][i][k] = body2->angularVelocity[i];
+		}
+	}
+
+	#if C4SIMD
+
+		vec_float	v[4][3];
+
+		for (machine j = 0; j < 4; j++)
+		{
+			for (machine i = 0; i < 3; i++)
+			{
+				v[j][i] = VecLoad(velocity[j][i]);
+			}
+		}
+
+		const vec_float zero = VecFloatGetZero();
+		const vec_float infinity = VecLoadVectorConstant<0x7F800000>();
+		const vec_float inverseMass1 = VecLoad(block->inverseMass[0]);
+		const vec_float inverseMass2 = VecLoad(block->inverseMass[1]);
+
+		for (machine r = 0; r < 3; r++)
+		{
+			RowLanes	*lanes;
+			vec_float	bias, minImpulse, maxImpulse;
+
+			// The normal row is solved first, and the friction rows are then limited
+			// by the normal impulse that has been accumulated so far.
+
+			if (r == 0)
+			{
+				lanes = &block->normalRow;
+				bias = VecLoad(block->normalBias);
+				minImpulse = zero;
+				maxImpulse = infinity;
+			}
+			else
+			{
+				lanes = &block->tangentRow[r - 1];
+				bias = VecLoad(block->tangentBias[r - 1]);
+				maxImpulse = VecMul(VecLoad(block->frictionCoefficient), VecLoad(block->normalRow.impulse));
+				minImpulse = VecNegate(maxImpulse);
+			}
+
+			vec_float jv = bias;
+			for (machine i = 0; i < 3; i++)
+			{
+				jv = VecMadd(VecLoad(lanes->direction[i]), VecSub(v[2][i], v[0][i]), jv);
+				jv = VecMadd(VecLoad(lanes->angular[0][i]), v[1][i], jv);
+				jv = VecMadd(VecLoad(lanes->angular[1][i]), v[3][i], jv);
+			}
+
+			vec_float oldImpulse = VecLoad(lanes->impulse);
+			vec_float newImpulse = VecMin(VecMax(VecNmsub(jv, VecLoad(lanes->effectiveMass), oldImpulse), minImpulse), maxImpulse);
+			VecStore(newImpulse, lanes->impulse);
+
+			vec_float impulse = VecSub(newImpulse, oldImpulse);
+			vec_float impulse1 = VecMul(impulse, inverseMass1);
+			vec_float impulse2 = VecMul(impulse, inverseMass2);
+
+			for (machine i = 0; i < 3; i++)
+			{
+				vec_float direction = VecLoad(lanes->direction[i]);
+				v[0][i] = VecNmsub(direction, impulse1, v[0][i]);
+				v[1][i] = VecMadd(VecLoad(lanes->inverseAngular[0][i]), impulse, v[1][i]);
+				v[2][i] = VecMadd(direction, impulse2, v[2][i]);
+				v[3][i] = VecMadd(VecLoad(lanes->inverseAngular[1][i]), impulse, v[3][i]);
+			}
+		}
+
+		for (machine j = 0; j < 4; j++)
+		{
+			for (machine i = 0; i < 3; i++)
+			{
+				VecStore(v[j][i], velocity[j][i]);
+			}
+		}
+
+	#else
+
+		for (machine k = 0; k < kContactSolverLaneCount; k++)
+		{
+			for (machine r = 0; r < 3; r++)
+			{
+				RowLanes	*lanes;
+				float		bias, minImpulse, maxImpulse;
+
+				if (r == 0)
+				{
+					lanes = &block->normalRow;
+					bias = block->normalBias[k];
+					minImpulse = 0.0F;
+					maxImpulse = K::infinity;
+				}
+				else
+				{
+					lanes = &block->tangentRow[r - 1];
+					bias = block->tangentBias[r - 1][k];
+					maxImpulse = block->frictionCoefficient[k] * block->normalRow.impulse[k];
+					minImpulse = -maxImpulse;
+				}
+
+				float jv = bias;
+				for (machine i = 0; i < 3; i++)
+				{
+					jv += lanes->direction[i][k] * (velocity[2][i][k] - velocity[0][i][k]);
+					jv += lanes->angular[0][i][k] * velocity[1][i][k] + lanes->angular[1][i][k] * velocity[3][i][k];
+				}
+
+				float oldImpulse = lanes->impulse[k];
+				float newImpulse = Clamp(oldImpulse - jv * lanes->effectiveMass[k], minImpulse, maxImpulse);
+				lanes->impulse[k] = newImpulse;
+
+				float impulse = newImpulse - oldImpulse;
+				float impulse1 = impulse * block->inverseMass[0][k];
+				float impulse2 = impulse * block->inverseMass[1][k];
+
+				for (machine i = 0; i < 3; i++)
+				{
+					float direction = lanes->direction[i][k];
+					velocity[0][i][k] -= direction * impulse1;
+					velocity[1][i][k] += lanes->inverseAngular[0][i][k] * impulse;
+					velocity[2][i][k] += direction * impulse2;
+					velocity[3][i][k] += lanes->inverseAngular[1][i][k] * impulse;
+				}
+			}
+		}
+
+	#endif
+
+	// Body zero is never written so that parallel jobs don't store to it at the same time.
+
+	for (machine k = 0; k < kContactSolverLaneCount; k++)
+	{
+		int32 index1 = block->bodyIndex[0][k];
+		if (index1 != 0)
+		{
+			SolverBody *body1 = &solverBody[index1];
+			body1->linearVelocity.Set(velocity[0][0][k], velocity[0][1][k], velocity[0][2][k]);
+			body1->angularVelocity.Set(velocity[1][0][k], velocity[1][1][k], velocity[1][2][k]);
+		}
+
+		int32 index2 = block->bodyIndex[1][k];
+		if (index2 != 0)
+		{
+			SolverBody *body2 = &solverBody[index2];
+			body2->linearVelocity.Set(velocity[2][0][k], velocity[2][1][k], velocity[2][2][k]);
+			body2->angularVelocity.Set(velocity[3][0][k], velocity[3][1][k], velocity[3][2][k]);
+		}
+	}
+}
+
+void ContactSolver::SolveBlocks(int32 start, int32 count)
+{
+	RowBlock *block = &rowBlock[start];
+	for (machine a = 0; a < count; a++)
+	{
+		SolveBlock(block);
+		block++;
+	}
+}
+
+void ContactSolver::IntegrateBodies(int32 start, int32 count)
+{
+	// The velocities computed by the batched rows replace the rigid body velocities, and the
+	// change made during the current iteration becomes the correction used for convergence.
+
+	const SolverBody *body = &solverBody[start];
+	for (machine a = 0; a < count; a++)
+	{
+		RigidBodyController *rigidBody = body->rigidBody;
+
+		rigidBody->maxLinearCorrection = SquaredMag(body->linearVelocity - rigidBody->linearVelocity);
+		rigidBody->maxAngularCorrection = SquaredMag(body->angularVelocity - rigidBody->angularVelocity);
+
+		rigidBody->linearVelocity = body->linearVelocity;
+		rigidBody->angularVelocity = body->angularVelocity;
+		rigidBody->linearCorrection = body->linearVelocity - rigidBody->initialLinearVelocity;
+		rigidBody->angularCorrection = body->angularVelocity - rigidBody->initialAngularVelocity;
+
+		rigidBody->Integrate();
+		body++;
+	}
+}
+
+void ContactSolver::ApplyPositionConstraints(int32 start, int32 count)
+{
+	CollisionContact **contact = &contactTable[start];
+	for (machine a = 0; a < count; a++)
+	{
+		(*contact)->ApplyPositionConstraints();
+		contact++;
+	}
+}
+
+void ContactSolver::ExecuteSolverPhase(int32 phase, int32 start, int32 count)
+{
+	if (phase == kContactSolverPhaseVelocity)
+	{
+		SolveBlocks(start, count);
+	}
+	else if (phase == kContactSolverPhaseIntegrate)
+	{
+		IntegrateBodies(start, count);
+	}
+	else
+	{
+		ApplyPositionConstraints(start, count);
+	}
+}
+
+void ContactSolver::RunSolverPhase(int32 phase, int32 start, int32 count)
+{
+	// For large islands solved from the main thread, each phase is split into equal ranges
+	// that are handed to the worker threads. The main thread processes the first range itself
+	// and then waits for the rest, so the workers never have to wait on each other.
+
+	if (parallelFlag)
+	{
+		int32 jobCount = Min(solverJobCount, (count + (kMinContactSolverJobItemCount - 1)) / kMinContactSolverJobItemCount);
+		if (jobCount > 1)
+		{
+			int32 rangeCount = (count + (jobCount - 1)) / jobCount;
+			int32 offset = rangeCount;
+
+			for (machine a = 1; (a < jobCount) && (offset < count); a++)
+			{
+				SolverJob *job = &solverJob[a];
+				job->solverPhase = phase;
+				job->phaseStart = start + offset;
+				job->phaseCount = Min(rangeCount, count - offset);
+				TheJobMgr->SubmitJob(job, &solverBatch);
+
+				offset += rangeCount;
+			}
+
+			ExecuteSolverPhase(phase, start, rangeCount);
+			TheJobMgr->FinishBatch(&solverBatch);
+			return;
+		}
+	}
+
+	ExecuteSolverPhase(phase, start, count);
+}
+
+void ContactSolver::JobExecuteSolverPhase(Job *job, void *cookie)
+{
+	const SolverJob *solverJob = static_cast<SolverJob *>(job);
+	solverJob->contactSolver->ExecuteSolverPhase(solverJob->solverPhase, solverJob->phaseStart, solverJob->phaseCount);
+}
+
+void ContactSolver::Solve(int32 iterationCount)
+{
+	for (machine iteration = 0; iteration < iterationCount; iteration++)
+	{
+		for (machine c = 0; c < kMaxContactSolverColorCount; c++)
+		{
+			int32 start = colorStart[c];
+			int32 count = colorStart[c + 1] - start;
+			if (count != 0)
+			{
+				RunSolverPhase(kContactSolverPhaseVelocity, start, count);
+			}
+		}
+
+		int32 start = colorStart[kMaxContactSolverColorCount];
+		SolveBlocks(start, blockCount - start);
+
+		RunSolverPhase(kContactSolverPhaseIntegrate, 1, bodyCount - 1);
+
+		for (machine c = 0; c < kMaxContactSolverColorCount; c++)
+		{
+			start = contactColorStart[c];
+			int32 count = contactColorStart[c + 1] - start;
+			if (count != 0)
+			{
+				RunSolverPhase(kContactSolverPhasePosition, start, count);
+			}
+		}
+
+		start = contactColorStart[kMaxContactSolverColorCount];
+		ApplyPositionConstraints(start, contactCount - start);
+
+		float maxCorrection = 0.0F;
+		for (machine a = 1; a < bodyCount; a++)
+		{
+			const RigidBodyController *rigidBody = solverBody[a].rigidBody;
+			maxCorrection = Fmax(maxCorrection, rigidBody->maxLinearCorrection, rigidBody->maxAngularCorrection);
+		}
+
+		if (maxCorrection < kConstraintCorrectionThreshold)
+		{
+			break;
+		}
+	}
+
+	WriteImpulses();
+}
+
+void ContactSolver::WriteImpulses(void)
+{
+	// The accumulated impulses are stored back in the contacts in the same slots that the
+	// scalar solver uses so that anything reading the applied impulses sees the same values.
+
+	const RowBlock *block = rowBlock;
+	for (machine a = 0; a < blockCount; a++)
+	{
+		for (machine k = 0; k < kContactSolverLaneCount; k++)
+		{
+			CollisionContact *contact = block->collisionContact[k];
+			if (contact)
+			{
+				int32 index = block->subcontactIndex[k] * 4;
+
+				float impulse = block->normalRow.impulse[k];
+				contact->cumulativeImpulse[index] = impulse;
+				contact->appliedImpulse[index] = impulse;
+
+				impulse = block->tangentRow[0].impulse[k];
+				contact->cumulativeImpulse[index + 1] = impulse;
+				contact->appliedImpulse[index + 1] = impulse;
+
+				impulse = block->tangentRow[1].impulse[k];
+				contact->cumulativeImpulse[index + 2] = impulse;
+				contact->appliedImpulse[index + 2] = impulse;
+			}
+		}
+
+		block++;
+	}
+}
+
+void ContactSolver::SaveState(const List<RigidBodyController> *bodyList)
+{
+	int32 bodyTotal = 0;
+	int32 contactTotal = 0;
+
+	const RigidBodyController *rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		bodyTotal++;
+
+		const Contact *contact = rigidBody->GetFirstOutgoingEdge();
+		while (contact)
+		{
+			ContactType type = contact->GetContactType();
+			if ((contact->Enabled()) && ((type == kContactRigidBody) || (type == kContactGeometry)))
+			{
+				contactTotal++;
+			}
+
+			contact = contact->GetNextOutgoingEdge();
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+
+	stateBodyCount = bodyTotal;
+	stateContactCount = contactTotal;
+	bodyState = new BodyState[bodyTotal];
+	contactState = new ContactState[contactTotal];
+
+	BodyState *body = bodyState;
+	ContactState *state = contactState;
+
+	rigidBody = bodyList->First();
+	while (rigidBody)
+	{
+		body->rigidBody = const_cast<RigidBodyController *>(rigidBody);
+		body->linearVelocity = rigidBody->linearVelocity;
+		body->angularVelocity = rigidBody->angularVelocity;
+		body->linearCorrection = rigidBody->linearCorrection;
+		body->angularCorrection = rigidBody->angularCorrection;
+		body->transientLinearVelocity = rigidBody->transientLinearVelocity;
+		body->transientAngularVelocity = rigidBody->transientAngularVelocity;
+		body->finalTransform = rigidBody->finalTransform;
+		body->motionTransform = rigidBody->motionTransform;
+		body->finalCenterOfMass = rigidBody->finalCenterOfMass;
+		body->motionDisplacement = rigidBody->motionDisplacement;
+		body->motionRotationAxis = rigidBody->motionRotationAxis;
+		body->motionRotationAngle = rigidBody->motionRotationAngle;
+		body++;
+
+		Contact *contact = rigidBody->GetFirstOutgoingEdge();
+		while (contact)
+		{
+			ContactType type = contact->GetContactType();
+			if ((contact->Enabled()) && ((type == kContactRigidBody) || (type == kContactGeometry)))
+			{
+				CollisionContact *collisionContact = static_cast<CollisionContact *>(contact);
+				state->collisionContact = collisionContact;
+
+				for (machine a = 0; a < ConstraintContact::kMaxContactConstraintCount; a++)
+				{
+					state->cumulativeImpulse[a] = collisionContact->cumulativeImpulse[a];
+					state->appliedImpulse[a] = collisionContact->appliedImpulse[a];
+				}
+
+				for (machine a = 0; a < collisionContact->subcontactCount; a++)
+				{
+					state->activeFlag[a] = collisionContact->subcontact[a].activeFlag;
+					state->inactiveStepCount[a] = collisionContact->subcontact[a].inactiveStepCount;
+				}
+
+				state++;
+			}
+
+			contact = contact->GetNextOutgoingEdge();
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+}
+
+void ContactSolver::RecordScalarState(void)
+{
+	BodyState *body = bodyState;
+	for (machine a = 0; a < stateBodyCount; a++)
+	{
+		const RigidBodyController *rigidBody = body->rigidBody;
+		body->scalarLinearVelocity = rigidBody->linearVelocity;
+		body->scalarAngularVelocity = rigidBody->angularVelocity;
+		body->scalarCenterOfMass = rigidBody->finalCenterOfMass;
+		body++;
+	}
+}
+
+void ContactSolver::RestoreState(void)
+{
+	const BodyState *body = bodyState;
+	for (machine a = 0; a < stateBodyCount; a++)
+	{
+		RigidBodyController *rigidBody = body->rigidBody;
+		rigidBody->linearVelocity = body->linearVelocity;
+		rigidBody->angularVelocity = body->angularVelocity;
+		rigidBody->linearCorrection = body->linearCorrection;
+		rigidBody->angularCorrection = body->angularCorrection;
+		rigidBody->transientLinearVelocity = body->transientLinearVelocity;
+		rigidBody->transientAngularVelocity = body->transientAngularVelocity;
+		rigidBody->finalTransform = body->finalTransform;
+		rigidBody->motionTransform = body->motionTransform;
+		rigidBody->finalCenterOfMass = body->finalCenterOfMass;
+		rigidBody->motionDisplacement = body->motionDisplacement;
+		rigidBody->motionRotationAxis = body->motionRotationAxis;
+		rigidBody->motionRotationAngle = body->motionRotationAngle;
+		body++;
+	}
+
+	const ContactState *state = contactState;
+	for (machine a = 0; a < stateContactCount; a++)
+	{
+		CollisionContact *collisionContact = state->collisionContact;
+
+		for (machine b = 0; b < ConstraintContact::kMaxContactConstraintCount; b++)
+		{
+			collisionContact->cumulativeImpulse[b] = state->cumulativeImpulse[b];
+			collisionContact->appliedImpulse[b] = state->appliedImpulse[b];
+		}
+
+		for (machine b = 0; b < collisionContact->subcontactCount; b++)
+		{
+			collisionContact->subcontact[b].activeFlag = state->activeFlag[b];
+			collisionContact->subcontact[b].inactiveStepCount = state->inactiveStepCount[b];
+		}
+
+		state++;
+	}
+}
+
+void ContactSolver::CompareScalarState(unsigned_int32 scalarTime, unsigned_int32 batchedTime)
+{
+	float maxLinear = 0.0F;
+	float maxAngular = 0.0F;
+	float maxPosition = 0.0F;
+
+	const BodyState *body = bodyState;
+	for (machine a = 0; a < stateBodyCount; a++)
+	{
+		const RigidBodyController *rigidBody = body->rigidBody;
+		maxLinear = Fmax(maxLinear, SquaredMag(rigidBody->linearVelocity - body->scalarLinearVelocity));
+		maxAngular = Fmax(maxAngular, SquaredMag(rigidBody->angularVelocity - body->scalarAngularVelocity));
+		maxPosition = Fmax(maxPosition, SquaredMag(rigidBody->finalCenterOfMass - body->scalarCenterOfMass));
+		body++;
+	}
+
+	comparisonMutex.Acquire();
+
+	comparisonData.islandCount++;
+	comparisonData.rowCount += rowCount;
+	comparisonData.colorCount = Max(comparisonData.colorCount, colorCount);
+	comparisonData.scalarSolveTime += scalarTime;
+	comparisonData.batchedSolveTime += batchedTime;
+	comparisonData.maxLinearVelocityDeviation = Fmax(comparisonData.maxLinearVelocityDeviation, Sqrt(maxLinear));
+	comparisonData.maxAngularVelocityDeviation = Fmax(comparisonData.maxAngularVelocityDeviation, Sqrt(maxAngular));
+	comparisonData.maxPositionDeviation = Fmax(comparisonData.maxPositionDeviation, Sqrt(maxPosition));
+
+	comparisonMutex.Release();
+}
+
+void ContactSolver::SetComparisonEnabled(bool enabled)
+{
+	comparisonMutex.Acquire();
+
+	if ((enabled) && (!comparisonEnabled))
+	{
+		comparisonData.islandCount = 0;
+		comparisonData.rowCount = 0;
+		comparisonData.colorCount = 0;
+		comparisonData.scalarSolveTime = 0;
+		comparisonData.batchedSolveTime = 0;
+		comparisonData.maxLinearVelocityDeviation = 0.0F;
+		comparisonData.maxAngularVelocityDeviation = 0.0F;
+		comparisonData.maxPositionDeviation = 0.0F;
+	}
+
+	comparisonEnabled = enabled;
+
+	comparisonMutex.Release();
+}
+
+// ZYUQURM
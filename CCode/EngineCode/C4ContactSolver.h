@@ -0,0 +1,264 @@
+ 
+
+#ifndef C4ContactSolver_h
+#define C4ContactSolver_h
+
+
+#include "C4Contacts.h"
+#include "C4Threads.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kContactSolverLaneCount					= 4,
+		kMaxContactSolverColorCount				= 32,
+		kMinContactSolverRowCount				= 16,
+		kMinParallelContactSolverRowCount		= 1024,
+		kMinContactSolverJobItemCount			= 16
+	};
+
+
+	//# \enum	ContactSolverMode
+
+	enum ContactSolverMode
+	{
+		kContactSolverScalar,					//## Contacts are solved one at a time by calling their virtual constraint functions.
+		kContactSolverBatched					//## Islands containing only collision contacts are solved in batches of rows with SIMD instructions.
+	};
+
+
+	struct ContactSolverComparison
+	{
+		int32				islandCount;
+		int32				rowCount;
+		int32				colorCount;
+
+		unsigned_int64		scalarSolveTime;
+		unsigned_int64		batchedSolveTime;
+
+		float				maxLinearVelocityDeviation;
+		float				maxAngularVelocityDeviation;
+		float				maxPositionDeviation;
+	};
+
+
+	// The ContactSolver class solves the velocity constraints for an island of rigid bodies that are
+	// connected only by collision contacts. When the island is built, each active subcontact becomes
+	// one normal row and two friction rows whose Jacobians are frozen for the rest of the step. The
+	// rows are greedily colored so that no two rows of the same color touch the same rigid body, and
+	// the rows of each color are packed into blocks of kContactSolverLaneCount rows that are solved
+	// together with SIMD instructions. Position constraints are still applied by the contacts.
+	//
+	// If an island is large enough and it is solved on the main thread, then each color is split
+	// into ranges that are handed to the worker threads. The contacts are colored separately for
+	// the position pass so that it can be split in the same way.
+
+	class ContactSolver
+	{
+		private:
+
+			enum
+			{
+				kContactSolverPhaseVelocity,
+				kContactSolverPhaseIntegrate,
+				kContactSolverPhasePosition
+			};
+
+			struct SolverBody
+			{
+				Vector3D				linearVelocity;
+				Vector3D				angularVelocity;
+				float					inverseMass;
+				RigidBodyController		*rigidBody;
+			};
+
+			struct BodyState
+			{
+				RigidBodyController		*rigidBody;
+
+				Vector3D				linearVelocity;
+				Vector3D				angularVelocity;
+				Vector3D				linearCorrection;
+				Vector3D				angularCorrection;
+				Vector3D				transientLinearVelocity;
+				Vector3D				transientAngularVelocity;
+				Transform4D				finalTransform;
+				Transform4D				motionTransform;
+				Point3D					finalCenterOfMass;
+				Vector3D				motionDisplacement;
+				Vector3D				motionRotationAxis;
+				float					motionRotationAngle;
+
+				Vector3D				scalarLinearVelocity;
+				Vector3D				scalarAngularVelocity;
+				Point3D					scalarCenterOfMass;
+			};
+
+			struct ContactState
+			{
+				CollisionContact		*collisionContact;
+
+				float					cumulativeImpulse[ConstraintContact::kMaxContactConstraintCount];
+				float					appliedImpulse[ConstraintContact::kMaxContactConstraintCount];
+				bool					activeFlag[ConstraintContact::kMaxSubcontactCount];
+				int32					inactiveStepCount[ConstraintContact::kMaxSubcontactCount];
+			};
+
+			struct ContactRow
+			{
+				CollisionContact		*collisionContact;
+				int32					subcontactIndex;
+				int32					bodyIndex[2];
+				int32					rowColor;
+
+				Vector3D				worldNormal;
+				Vector3D				contactDirection[2];
+				Vector3D				worldTangent[2];
+				Vector3D				geometryVelocity;
+				float					bounceSpeed;
+				float					frictionCoefficient;
+			};
+
+			// Each RowLanes structure holds one constraint row for every lane of a block. A row
+			// with direction D acts on the first body with the Jacobian (-D, D ⨯ R1) and on the
+			// second body with the Jacobian (D, R2 ⨯ D), where R1 and R2 are the offsets from the
+			// centers of mass to the contact point. The angular parts premultiplied by the inverse
+			// inertia tensors are stored so that impulses can be applied without any matrix math.
+
+			struct RowLanes
+			{
+				alignas(16) float		direction[3][kContactSolverLaneCount];
+				alignas(16) float		angular[2][3][kContactSolverLaneCount];
+				alignas(16) float		inverseAngular[2][3][kContactSolverLaneCount];
+				alignas(16) float		effectiveMass[kContactSolverLaneCount];
+				alignas(16) float		impulse[kContactSolverLaneCount];
+			};
+
+			struct alignas(16) RowBlock
+			{
+				int32					bodyIndex[2][kContactSolverLaneCount];
+
+				alignas(16) float		inverseMass[2][kContactSolverLaneCount];
+				alignas(16) float		normalBias[kContactSolverLaneCount];
+				alignas(16) float		tangentBias[2][kContactSolverLaneCount];
+				alignas(16) float		frictionCoefficient[kContactSolverLaneCount];
+
+				RowLanes				normalRow;
+				RowLanes				tangentRow[2];
+
+				CollisionContact		*collisionContact[kContactSolverLaneCount];
+				int32					subcontactIndex[kContactSolverLaneCount];
+			};
+
+			class SolverJob : public BatchJob
+			{
+				public:
+
+					ContactSolver		*contactSolver;
+					int32				solverPhase;
+					int32				phaseStart;
+					int32				phaseCount;
+
+					SolverJob() : BatchJob(&JobExecuteSolverPhase)
+					{
+					}
+			};
+
+			int32						bodyCount;
+			SolverBody					*solverBody;
+
+			int32						rowCount;
+			int32						blockCount;
+			RowBlock					*rowBlock;
+			char						*blockStorage;
+
+			int32						colorCount;
+			int32						colorStart[kMaxContactSolverColorCount + 2];
+
+			int32						contactCount;
+			CollisionContact			**contactTable;
+
+			int32						contactColorStart[kMaxContactSolverColorCount + 2];
+
+			char						*solverStorage;
+
+			bool						parallelFlag;
+			int32						solverJobCount;
+			SolverJob					*solverJob;
+			Batch						solverBatch;
+
+			int32						stateBodyCount;
+			int32						stateContactCount;
+			BodyState					*bodyState;
+			ContactState				*contactState;
+
+			static bool								comparisonEnabled;
+			static Mutex							comparisonMutex;
+			static ContactSolverComparison			comparisonData;
+
+			static bool CalculateRowGeometry(CollisionContact *contact, int32 index, ContactRow *row);
+			static void FillRowLanes(RowLanes *lanes, int32 lane, const Vector3D& direction, const ContactRow *row, const SolverBody *body1, const SolverBody *body2);
+			void FillBlockLane(RowBlock *block, int32 lane, const ContactRow *row);
+
+			void SolveBlock(RowBlock *block);
+			void SolveBlocks(int32 start, int32 count);
+			void IntegrateBodies(int32 start, int32 count);
+			void ApplyPositionConstraints(int32 start, int32 count);
+
+			void ExecuteSolverPhase(int32 phase, int32 start, int32 count);
+			void RunSolverPhase(int32 phase, int32 start, int32 count);
+			static void JobExecuteSolverPhase(Job *job, void *cookie);
+
+			void WriteImpulses(void);
+
+		public:
+
+			ContactSolver();
+			~ContactSolver();
+
+			int32 GetRowCount(void) const
+			{
+				return (rowCount);
+			}
+
+			int32 GetColorCount(void) const
+			{
+				return (colorCount);
+			}
+
+			bool Parallel(void) const
+			{
+				return (parallelFlag);
+			}
+
+			static bool ComparisonEnabled(void)
+			{
+				return (comparisonEnabled);
+			}
+
+			static const ContactSolverComparison *GetComparisonData(void)
+			{
+				return (&comparisonData);
+			}
+
+			static bool Eligible(const List<RigidBodyController> *bodyList, int32 *subcontactCount);
+
+			bool Build(const List<RigidBodyController> *bodyList);
+			void Solve(int32 iterationCount);
+			void Purge(void);
+
+			void SaveState(const List<RigidBodyController> *bodyList);
+			void RecordScalarState(void);
+			void RestoreState(void);
+			void CompareScalarState(unsigned_int32 scalarTime, unsigned_int32 batchedTime);
+
+			C4API static void SetComparisonEnabled(bool enabled);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
@@ -295,6 +295,7 @@ namespace C4
 	class CollisionContact : public ConstraintContact
 	{
 		friend class Shape;
+		friend class ContactSolver;
 
 		private:
 
@@ -0,0 +1,148 @@
+ 
+
+#include "C4DeadReckoning.h"
+
+
+using namespace C4;
+
+
+void DeadReckoningState::Extrapolate(float time, Point3D *p, Quaternion *q) const
+{
+	*p = position + linearVelocity * time + linearAcceleration * (time * time * 0.5F);
+
+	float w = SquaredMag(angularVelocity);
+	if (w > K::min_float)
+	{
+		float r = InverseSqrt(w);
+		*q = Quaternion().SetRotationAboutAxis(w * r * time, angularVelocity * r) * rotation;
+		q->Normalize();
+	}
+	else
+	{
+		*q = rotation;
+	}
+}
+
+
+DeadReckoningPublisher::DeadReckoningPublisher()
+{
+	positionThreshold = 0.1F;
+	velocityThreshold = 0.5F;
+	maxPublishInterval = kDeadReckoningMaxPublishInterval;
+	SetRotationThreshold(0.1F);
+
+	publishedFlag = false;
+	sampleFlag = false;
+	publishTime = 0;
+}
+
+DeadReckoningPublisher::~DeadReckoningPublisher()
+{
+}
+
+void DeadReckoningPublisher::SetRotationThreshold(float threshold)
+{
+	rotationThreshold = threshold;
+	rotationCosine = Cos(threshold * 0.5F);
+}
+
+bool DeadReckoningPublisher::Update(const Point3D& position, const Quaternion& rotation, const Vector3D& linearVelocity, const Antivector3D& angularVelocity, int32 dt)
+{
+	// The acceleration is measured from the change in velocity since the previous update so that
+	// it accounts for gravity and any other forces that the clients are also going to simulate.
+
+	Vector3D acceleration(0.0F, 0.0F, 0.0F);
+	if ((sampleFlag) && (dt > 0))
+	{
+		acceleration = (linearVelocity - sampleVelocity) * (1000.0F / (float) dt);
+	}
+
+	sampleVelocity = linearVelocity;
+	sampleFlag = true;
+
+	if (publishedFlag)
+	{
+		int32 time = publishTime + dt;
+		if (time < maxPublishInterval)
+		{
+			Point3D		predictedPosition;
+			Quaternion	predictedRotation;
+
+			float t = (float) time * 0.001F;
+			publishedState.Extrapolate(t, &predictedPosition, &predictedRotation);
+			Vector3D predictedVelocity = publishedState.linearVelocity + publishedState.linearAcceleration * t;
+
+			if ((SquaredMag(position - predictedPosition) < positionThreshold * positionThreshold) && (SquaredMag(linearVelocity - predictedVelocity) < velocityThreshold * velocityThreshold) && (Fabs(Dot(rotation, predictedRotation)) > rotationCosine))
+			{
+				publishTime = time;
+				return (false);
+			}
+		}
+	}
+
+	publishedFlag = true;
+	publishTime = 0;
+
+	publishedState.position = position;
+	publishedState.rotation = rotation;
+	publishedState.linearVelocity = linearVelocity;
+	publishedState.linearAcceleration = acceleration;
+	publishedState.angularVelocity = angularVelocity;
+	return (true);
+}
+
+
+DeadReckoningSmoother::DeadReckoningSmoother()
+{
+	Reset();
+
+	positionError.Set(0.0F, 0.0F, 0.0F);
+	velocityError.Set(0.0F, 0.0F, 0.0F);
+	rotationError.Set(0.0F, 0.0F, 0.0F, 1.0F);
+}
+
+DeadReckoningSmoother::~DeadReckoningSmoother()
+{
+}
+
+void DeadReckoningSmoother::BeginBlend(const Vector3D& positionError, const Vector3D& velocityError, const Quaternion& rotationError)
+{
+	// The time since the previous state was received is used as the duration of the new blend.
+	// The blend time saturates at kDeadReckoningMaxBlendTime, so it never needs to be clamped here.
+
+	blendDuration = Fmax(blendTime, (float) kDeadReckoningMinBlendTime);
+	blendTime = 0.0F;
+
+	this->positionError = positionError;
+	this->velocityError = velocityError;
+	this->rotationError = (rotationError.w < 0.0F) ? -rotationError : rotationError;
+}
+
+Vector3D DeadReckoningSmoother::GetPositionOffset(void) const
+{
+	// With s = 1 - t / T, the projective velocity blend starts at the displayed position P0 moving
+	// with velocity V0 and blends toward the received trajectory P1 + V1 t. Its offset from the
+	// received trajectory is s (P0 - P1) + s^2 (V0 - V1) t, which vanishes at t = T.
+
+	if (blendTime < blendDuration)
+	{
+		float s = 1.0F - blendTime / blendDuration;
+		return ((positionError + velocityError * (s * blendTime * 0.001F)) * s);
+	}
+
+	return (Vector3D(0.0F, 0.0F, 0.0F));
+}
+
+Quaternion DeadReckoningSmoother::GetRotationOffset(void) const
+{
+	if (blendTime < blendDuration)
+	{
+		float s = 1.0F - blendTime / blendDuration;
+		Quaternion q(rotationError.x * s, rotationError.y * s, rotationError.z * s, rotationError.w * s + (1.0F - s));
+		return (q.Normalize());
+	}
+
+	return (Quaternion(0.0F, 0.0F, 0.0F, 1.0F));
+}
+
+// ZYUQURM
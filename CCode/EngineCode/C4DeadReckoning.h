@@ -0,0 +1,423 @@
+ 
+
+#ifndef C4DeadReckoning_h
+#define C4DeadReckoning_h
+
+
+//# \component	Physics Manager
+//# \prefix		PhysicsMgr/
+
+
+#include "C4Quaternion.h"
+#include "C4Constants.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kDeadReckoningMaxPublishInterval		= 1000,
+		kDeadReckoningMinBlendTime				= 50,
+		kDeadReckoningMaxBlendTime				= 300
+	};
+
+
+	//# \struct	DeadReckoningState		Contains the kinematic state of an object used for dead reckoning.
+	//
+	//# The $DeadReckoningState$ structure contains the kinematic state of an object used for dead reckoning.
+	//
+	//# \def	struct DeadReckoningState
+	//
+	//# \data	DeadReckoningState
+	//
+	//# \also	$@DeadReckoningPublisher@$
+
+
+	//# \function	DeadReckoningState::Extrapolate		Extrapolates a dead reckoning state forward in time.
+	//
+	//# \proto	void Extrapolate(float time, Point3D *position, Quaternion *rotation) const;
+	//
+	//# \param	time		The time, in seconds, by which to extrapolate the state.
+	//# \param	position	A pointer to a location that receives the extrapolated position.
+	//# \param	rotation	A pointer to a location that receives the extrapolated rotation.
+	//
+	//# \desc
+	//# The $Extrapolate$ function calculates the position and rotation that an object having the kinematic
+	//# state stored in the $DeadReckoningState$ structure would have after the time given by the $time$
+	//# parameter has elapsed. The position is extrapolated with the linear velocity and linear acceleration,
+	//# and the rotation is extrapolated with the angular velocity.
+
+
+	struct DeadReckoningState
+	{
+		Point3D			position;				//## The position of the object.
+		Quaternion		rotation;				//## The rotation of the object.
+		Vector3D		linearVelocity;			//## The linear velocity of the object, in meters per second.
+		Vector3D		linearAcceleration;		//## The linear acceleration of the object, in meters per second squared.
+		Antivector3D	angularVelocity;		//## The angular velocity of the object, in radians per second.
+
+		C4API void Extrapolate(float time, Point3D *position, Quaternion *rotation) const;
+	};
+
+
+	//# \class	DeadReckoningPublisher		Decides when the state of a replicated object needs to be sent to client machines.
+	//
+	//# The $DeadReckoningPublisher$ class decides when the state of a replicated object needs to be sent to client machines.
+	//
+	//# \def	class DeadReckoningPublisher
+	//
+	//# \ctor	DeadReckoningPublisher();
+	//
+	//# \desc
+	//# The $DeadReckoningPublisher$ class is used on the server machine to reduce the number of snapshots that
+	//# are sent for an object whose motion can be predicted by client machines. The publisher remembers the
+	//# last state that was sent and extrapolates it in the same way that a client would. A new state needs to be
+	//# sent only when the actual state of the object deviates from the extrapolated state by more than one of
+	//# the thresholds set for the publisher, or when the maximum publish interval has elapsed.
+	//#
+	//# The $@DeadReckoningPublisher::Update@$ function should be called at each opportunity to send a snapshot.
+	//# The linear acceleration of the object is measured by the publisher from the change in its velocity
+	//# between consecutive updates, so it includes gravity and any other forces acting on the object.
+	//#
+	//# Since the publisher assumes that every published state reaches the clients, states that it publishes
+	//# must be sent as reliable messages. If a published state were lost, then no further state would be sent
+	//# until the object deviated from the lost state, and the clients could be wrong for the whole interval.
+	//
+	//# \also	$@DeadReckoningState@$
+	//# \also	$@DeadReckoningSmoother@$
+	//# \also	$@RigidBodyController::GetDeadReckoningPublisher@$
+
+
+	//# \function	DeadReckoningPublisher::GetPositionThreshold		Returns the position error threshold.
+	//
+	//# \proto	float GetPositionThreshold(void) const;
+	//
+	//# \desc
+	//# The $GetPositionThreshold$ function returns the distance, in meters, by which the position of an object
+	//# can deviate from its extrapolated position before a new state is published. The default threshold is 0.1&nbsp;m.
+	//
+	//# \also	$@DeadReckoningPublisher::SetPositionThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::SetPositionThreshold		Sets the position error threshold.
+	//
+	//# \proto	void SetPositionThreshold(float threshold);
+	//
+	//# \param	threshold	The new position error threshold, in meters.
+	//
+	//# \desc
+	//# The $SetPositionThreshold$ function sets the distance, in meters, by which the position of an object
+	//# can deviate from its extrapolated position before a new state is published. The default threshold is 0.1&nbsp;m.
+	//
+	//# \also	$@DeadReckoningPublisher::GetPositionThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::GetRotationThreshold		Returns the rotation error threshold.
+	//
+	//# \proto	float GetRotationThreshold(void) const;
+	//
+	//# \desc
+	//# The $GetRotationThreshold$ function returns the angle, in radians, by which the rotation of an object
+	//# can deviate from its extrapolated rotation before a new state is published. The default threshold is 0.1 radian.
+	//
+	//# \also	$@DeadReckoningPublisher::SetRotationThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::SetRotationThreshold		Sets the rotation error threshold.
+	//
+	//# \proto	void SetRotationThreshold(float threshold);
+	//
+	//# \param	threshold	The new rotation error threshold, in radians.
+	//
+	//# \desc
+	//# The $SetRotationThreshold$ function sets the angle, in radians, by which the rotation of an object
+	//# can deviate from its extrapolated rotation before a new state is published. The default threshold is 0.1 radian.
+	//
+	//# \also	$@DeadReckoningPublisher::GetRotationThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::GetVelocityThreshold		Returns the velocity error threshold.
+	//
+	//# \proto	float GetVelocityThreshold(void) const;
+	//
+	//# \desc
+	//# The $GetVelocityThreshold$ function returns the speed, in meters per second, by which the linear velocity
+	//# of an object can deviate from its extrapolated velocity before a new state is published. The default
+	//# threshold is 0.5&nbsp;m/s.
+	//
+	//# \also	$@DeadReckoningPublisher::SetVelocityThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::SetVelocityThreshold		Sets the velocity error threshold.
+	//
+	//# \proto	void SetVelocityThreshold(float threshold);
+	//
+	//# \param	threshold	The new velocity error threshold, in meters per second.
+	//
+	//# \desc
+	//# The $SetVelocityThreshold$ function sets the speed, in meters per second, by which the linear velocity
+	//# of an object can deviate from its extrapolated velocity before a new state is published. The default
+	//# threshold is 0.5&nbsp;m/s.
+	//
+	//# \also	$@DeadReckoningPublisher::GetVelocityThreshold@$
+
+
+	//# \function	DeadReckoningPublisher::GetMaxPublishInterval		Returns the maximum publish interval.
+	//
+	//# \proto	int32 GetMaxPublishInterval(void) const;
+	//
+	//# \desc
+	//# The $GetMaxPublishInterval$ function returns the maximum time, in milliseconds, that can pass before a new
+	//# state is published even if the object has not deviated from its extrapolated state. This interval limits the
+	//# drift caused by small differences between the extrapolation on the server and on the clients. The default interval
+	//# is 1000 milliseconds.
+	//
+	//# \also	$@DeadReckoningPublisher::SetMaxPublishInterval@$
+
+
+	//# \function	DeadReckoningPublisher::SetMaxPublishInterval		Sets the maximum publish interval.
+	//
+	//# \proto	void SetMaxPublishInterval(int32 interval);
+	//
+	//# \param	interval	The new maximum publish interval, in milliseconds.
+	//
+	//# \desc
+	//# The $SetMaxPublishInterval$ function sets the maximum time, in milliseconds, that can pass before a new
+	//# state is published even if the object has not deviated from its extrapolated state. The default interval
+	//# is 1000 milliseconds.
+	//
+	//# \also	$@DeadReckoningPublisher::GetMaxPublishInterval@$
+
+
+	//# \function	DeadReckoningPublisher::Reset		Forces the next state to be published.
+	//
+	//# \proto	void Reset(void);
+	//
+	//# \desc
+	//# The $Reset$ function causes the state passed to the next call to the $@DeadReckoningPublisher::Update@$
+	//# function to be published unconditionally. This function should be called when an object wakes up or
+	//# when its state is changed in a way that clients could not have predicted.
+	//
+	//# \also	$@DeadReckoningPublisher::Update@$
+
+
+	//# \function	DeadReckoningPublisher::Update		Determines whether a new state needs to be published.
+	//
+	//# \proto	bool Update(const Point3D& position, const Quaternion& rotation, const Vector3D& linearVelocity, const Antivector3D& angularVelocity, int32 dt);
+	//
+	//# \param	position			The current position of the object.
+	//# \param	rotation			The current rotation of the object.
+	//# \param	linearVelocity		The current linear velocity of the object, in meters per second.
+	//# \param	angularVelocity		The current angular velocity of the object, in radians per second.
+	//# \param	dt					The time, in milliseconds, since the previous call to the $Update$ function.
+	//
+	//# \desc
+	//# The $Update$ function compares the current state of an object with the state extrapolated from the
+	//# last state that was published. If the position, rotation, or linear velocity deviates by more than its
+	//# threshold, or if the maximum publish interval has elapsed, then the current state becomes the published
+	//# state, and the return value is $true$. Otherwise, the return value is $false$, and the caller does not
+	//# need to send a new state to client machines.
+	//
+	//# \also	$@DeadReckoningPublisher::Reset@$
+	//# \also	$@DeadReckoningPublisher::GetPublishedState@$
+
+
+	class DeadReckoningPublisher
+	{
+		private:
+
+			float					positionThreshold;
+			float					rotationThreshold;
+			float					rotationCosine;
+			float					velocityThreshold;
+			int32					maxPublishInterval;
+
+			bool					publishedFlag;
+			bool					sampleFlag;
+			int32					publishTime;
+
+			Vector3D				sampleVelocity;
+			DeadReckoningState		publishedState;
+
+		public:
+
+			C4API DeadReckoningPublisher();
+			C4API ~DeadReckoningPublisher();
+
+			float GetPositionThreshold(void) const
+			{
+				return (positionThreshold);
+			}
+
+			void SetPositionThreshold(float threshold)
+			{
+				positionThreshold = threshold;
+			}
+
+			float GetRotationThreshold(void) const
+			{
+				return (rotationThreshold);
+			}
+
+			float GetVelocityThreshold(void) const
+			{
+				return (velocityThreshold);
+			}
+
+			void SetVelocityThreshold(float threshold)
+			{
+				velocityThreshold = threshold;
+			}
+
+			int32 GetMaxPublishInterval(void) const
+			{
+				return (maxPublishInterval);
+			}
+
+			void SetMaxPublishInterval(int32 interval)
+			{
+				maxPublishInterval = interval;
+			}
+
+			const DeadReckoningState& GetPublishedState(void) const
+			{
+				return (publishedState);
+			}
+
+			void Reset(void)
+			{
+				publishedFlag = false;
+				sampleFlag = false;
+			}
+
+			C4API void SetRotationThreshold(float threshold);
+
+			C4API bool Update(const Point3D& position, const Quaternion& rotation, const Vector3D& linearVelocity, const Antivector3D& angularVelocity, int32 dt);
+	};
+
+
+	//# \class	DeadReckoningSmoother		Smoothly converges the displayed state of a replicated object to a newly received state.
+	//
+	//# The $DeadReckoningSmoother$ class smoothly converges the displayed state of a replicated object to a newly received state.
+	//
+	//# \def	class DeadReckoningSmoother
+	//
+	//# \ctor	DeadReckoningSmoother();
+	//
+	//# \desc
+	//# The $DeadReckoningSmoother$ class is used on client machines to hide the correction that occurs when a new
+	//# state is received for an object. Instead of jumping to the new state, the displayed state follows a
+	//# projective velocity blend that starts on the trajectory the object was displayed on before the state
+	//# was received and converges to the trajectory of the new state over a blend time.
+	//#
+	//# The blend time is the time that passed since the previous state was received, clamped to the range
+	//# 50&ndash;300 milliseconds, so that corrections are spread over the interval at which the server is
+	//# actually publishing states for the object.
+	//
+	//# \also	$@DeadReckoningPublisher@$
+
+
+	//# \function	DeadReckoningSmoother::Reset		Cancels any blend in progress.
+	//
+	//# \proto	void Reset(void);
+	//
+	//# \desc
+	//# The $Reset$ function cancels any blend in progress so that the displayed state of an object matches its
+	//# simulated state immediately.
+
+
+	//# \function	DeadReckoningSmoother::BeginBlend		Begins converging to a newly received state.
+	//
+	//# \proto	void BeginBlend(const Vector3D& positionError, const Vector3D& velocityError, const Quaternion& rotationError);
+	//
+	//# \param	positionError		The displayed position minus the received position.
+	//# \param	velocityError		The displayed linear velocity minus the received linear velocity.
+	//# \param	rotationError		The rotation that transforms the received rotation into the displayed rotation.
+	//
+	//# \desc
+	//# The $BeginBlend$ function begins a new blend from the displayed trajectory of an object to the trajectory
+	//# of a newly received state. The errors passed to this function should be calculated from the displayed state,
+	//# including the offsets returned by the $@DeadReckoningSmoother::GetPositionOffset@$ and
+	//# $@DeadReckoningSmoother::GetRotationOffset@$ functions, so that a blend in progress continues without a jump.
+	//
+	//# \also	$@DeadReckoningSmoother::Update@$
+
+
+	//# \function	DeadReckoningSmoother::Update		Advances the blend.
+	//
+	//# \proto	void Update(float dt);
+	//
+	//# \param	dt		The time, in milliseconds, since the previous update.
+	//
+	//# \desc
+	//# The $Update$ function advances the blend by the time given by the $dt$ parameter. It should be called once
+	//# per frame for an object that is moving.
+	//
+	//# \also	$@DeadReckoningSmoother::BeginBlend@$
+
+
+	//# \function	DeadReckoningSmoother::GetPositionOffset		Returns the current position offset.
+	//
+	//# \proto	Vector3D GetPositionOffset(void) const;
+	//
+	//# \desc
+	//# The $GetPositionOffset$ function returns the offset that should be added to the simulated position of an
+	//# object to obtain its displayed position. The offset is zero when no blend is in progress.
+	//
+	//# \also	$@DeadReckoningSmoother::GetRotationOffset@$
+
+
+	//# \function	DeadReckoningSmoother::GetRotationOffset		Returns the current rotation offset.
+	//
+	//# \proto	Quaternion GetRotationOffset(void) const;
+	//
+	//# \desc
+	//# The $GetRotationOffset$ function returns the rotation that should be applied to the simulated rotation of an
+	//# object to obtain its displayed rotation. The offset is the identity when no blend is in progress.
+	//
+	//# \also	$@DeadReckoningSmoother::GetPositionOffset@$
+
+
+	class DeadReckoningSmoother
+	{
+		private:
+
+			float			blendTime;
+			float			blendDuration;
+
+			Vector3D		positionError;
+			Vector3D		velocityError;
+			Quaternion		rotationError;
+
+		public:
+
+			C4API DeadReckoningSmoother();
+			C4API ~DeadReckoningSmoother();
+
+			bool Active(void) const
+			{
+				return (blendTime < blendDuration);
+			}
+
+			void Reset(void)
+			{
+				blendTime = kDeadReckoningMaxBlendTime;
+				blendDuration = 0.0F;
+			}
+
+			void Update(float dt)
+			{
+				blendTime = Fmin(blendTime + dt, (float) kDeadReckoningMaxBlendTime);
+			}
+
+			C4API void BeginBlend(const Vector3D& positionError, const Vector3D& velocityError, const Quaternion& rotationError);
+
+			C4API Vector3D GetPositionOffset(void) const;
+			C4API Quaternion GetRotationOffset(void) const;
+	};
+}
+
+
+#endif
+
+// ZYUQURM
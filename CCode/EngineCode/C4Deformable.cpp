@@ -6,6 +6,7 @@
 #include "C4Fields.h"
 #include "C4Blockers.h"
 #include "C4Configuration.h"
+#include "C4Cameras.h"
 #include "C4World.h"
 
 
@@ -21,9 +22,14 @@ namespace
 	const float kRopeInverseMotionDeltaTime = 1.0F / (float) kRopeTimeStep;
 
 	const float kClothDeltaTime = (float) kClothTimeStep * 0.001F;
-	const float kClothSquaredDeltaTime = kClothDeltaTime * kClothDeltaTime;
-	const float kClothInverseDeltaTime = 1.0F / kClothDeltaTime;
 	const float kClothInverseMotionDeltaTime = 1.0F / (float) kClothTimeStep;
+
+
+	enum
+	{
+		kClothParallelParticleCount		= 1024,
+		kClothMinSolverJobItemCount		= 128
+	};
 }
 
 
@@ -366,6 +372,13 @@ void DeformableBodyController::RecursiveWake(void)
 	}
 }
 
+void DeformableBodyController::StepParallelSimulation(void)
+{
+	// This function is called on the main thread by the Physics Manager instead of submitting the
+	// step simulation job when the kDeformableBodyParallelStep state is set. A subclass that sets
+	// this state distributes the work for a single body over the worker threads itself.
+}
+
 void DeformableBodyController::AutoSleep(void)
 {
 	deformableBodyState |= kDeformableBodyAutoAsleep;
@@ -3773,6 +3786,14 @@ ClothController::ClothController() :
 	vertexStorage = nullptr;
 	particleCount = 0;
 
+	solverJobCount = 0;
+	solverJob = nullptr;
+
+	clothLevel = kClothLevelFull;
+	clothGrid = kClothGridFull;
+	clothLevelDistance[kClothLevelCoarse - 1] = 0.0F;
+	clothLevelDistance[kClothLevelDistant - 1] = 0.0F;
+
 	stretchSpringConstant = 2000.0F;
 	stretchDamperConstant = 0.0F;
 	shearSpringConstant = 2000.0F;
@@ -3793,6 +3814,14 @@ ClothController::ClothController(const ClothController& clothController) :
 	vertexStorage = nullptr;
 	particleCount = 0;
 
+	solverJobCount = 0;
+	solverJob = nullptr;
+
+	clothLevel = kClothLevelFull;
+	clothGrid = kClothGridFull;
+	clothLevelDistance[kClothLevelCoarse - 1] = clothController.clothLevelDistance[kClothLevelCoarse - 1];
+	clothLevelDistance[kClothLevelDistant - 1] = clothController.clothLevelDistance[kClothLevelDistant - 1];
+
 	stretchSpringConstant = clothController.stretchSpringConstant;
 	stretchDamperConstant = clothController.stretchDamperConstant;
 	shearSpringConstant = clothController.shearSpringConstant;
@@ -3805,6 +3834,7 @@ ClothController::ClothController(const ClothController& clothController) :
 
 ClothController::~ClothController()
 {
+	delete[] solverJob;
 	delete[] vertexStorage;
 	delete[] springStorage;
 	delete[] fieldStorage;
@@ -3852,6 +3882,10 @@ void ClothController::Pack(Packer& data, unsigned_int32 packFlags) const
 	data << ChunkHeader('ATCH', 4);
 	data << attachmentFlags;
 
+	data << ChunkHeader('LODD', 8);
+	data << clothLevelDistance[kClothLevelCoarse - 1];
+	data << clothLevelDistance[kClothLevelDistant - 1];
+
 	if ((fieldStorage) && (!GetTargetNode()->GetManipulator()))
 	{
 		data << ChunkHeader('FELD', 4 + particleCount * (sizeof(Point3D) * kClothPositionCount));
@@ -3904,6 +3938,12 @@ bool ClothController::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data
 			data >> attachmentFlags;
 			return (true);
 
+		case 'LODD':
+
+			data >> clothLevelDistance[kClothLevelCoarse - 1];
+			data >> clothLevelDistance[kClothLevelDistant - 1];
+			return (true);
+
 		case 'FELD':
 
 			data >> particleCount;
@@ -3922,7 +3962,7 @@ bool ClothController::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data
 
 int32 ClothController::GetSettingCount(void) const
 {
-	return (DeformableBodyController::GetSettingCount() + 24);
+	return (DeformableBodyController::GetSettingCount() + 27);
 }
 
 Setting *ClothController::GetSetting(int32 index) const
@@ -4076,6 +4116,24 @@ Setting *ClothController::GetSetting(int32 index) const
 			return (new BooleanSetting('EDG4', ((attachmentFlags & kClothLeftEdge) != 0), title));
 		}
 
+		if (i == 24)
+		{
+			const char *title = table->GetString(StringID('CTRL', kControllerCloth, 'LODD'));
+			return (new HeadingSetting('LODD', title));
+		}
+
+		if (i == 25)
+		{
+			const char *title = table->GetString(StringID('CTRL', kControllerCloth, 'LODD', 'LOD1'));
+			return (new TextSetting('LOD1', clothLevelDistance[kClothLevelCoarse - 1], title));
+		}
+
+		if (i == 26)
+		{
+			const char *title = table->GetString(StringID('CTRL', kControllerCloth, 'LODD', 'LOD2'));
+			return (new TextSetting('LOD2', clothLevelDistance[kClothLevelDistant - 1], title));
+		}
+
 		return (nullptr);
 	}
 
@@ -4225,6 +4283,16 @@ void ClothController::SetSetting(const Setting *setting)
 			attachmentFlags &= ~kClothLeftEdge;
 		}
 	}
+	else if (identifier == 'LOD1')
+	{
+		const char *text = static_cast<const TextSetting *>(setting)->GetText();
+		clothLevelDistance[kClothLevelCoarse - 1] = FmaxZero(Text::StringToFloat(text));
+	}
+	else if (identifier == 'LOD2')
+	{
+		const char *text = static_cast<const TextSetting *>(setting)->GetText();
+		clothLevelDistance[kClothLevelDistant - 1] = FmaxZero(Text::StringToFloat(text));
+	}
 	else
 	{
 		DeformableBodyController::SetSetting(setting);
@@ -4248,15 +4316,47 @@ void ClothController::AllocateFieldStorage(void)
 
 	clothBitangent = position;
 	clothFlexibility = reinterpret_cast<float *>(clothBitangent + particleCount);
+
+	// Velocities are only calculated for the particles being simulated, but the force fields
+	// read them for every particle in a row, so they must start out with valid values.
+
+	for (machine a = 0; a < particleCount; a++)
+	{
+		clothVelocity[a].Set(0.0F, 0.0F, 0.0F);
+	}
 }
 
 void ClothController::AllocateSpringStorage(void)
 {
-	springStorage = new char[(stretchSpringCount + shearSpringCount + bendSpringCount) * sizeof(SpringData)];
+	int32 totalCount = 0;
+	for (machine grid = 0; grid < clothGridCount; grid++)
+	{
+		int32 stride = 1 << grid;
+		int32 width = (fieldWidth - 1) / stride + 1;
+		int32 height = (fieldHeight - 1) / stride + 1;
+
+		int32 stretchCount = (width - 1) * height + width * (height - 1);
+		springSet[grid][kClothSpringStretch].springCount = stretchCount;
+		springSet[grid][kClothSpringShear].springCount = 2 * (width - 1) * (height - 1);
+		springSet[grid][kClothSpringBend].springCount = stretchCount - width - height;
+
+		for (machine type = 0; type < kClothSpringTypeCount; type++)
+		{
+			totalCount += springSet[grid][type].springCount;
+		}
+	}
 
-	stretchSpringData = reinterpret_cast<SpringData *>(springStorage);
-	shearSpringData = stretchSpringData + stretchSpringCount;
-	bendSpringData = shearSpringData + shearSpringCount;
+	springStorage = new char[totalCount * sizeof(SpringData)];
+
+	SpringData *springData = reinterpret_cast<SpringData *>(springStorage);
+	for (machine grid = 0; grid < clothGridCount; grid++)
+	{
+		for (machine type = 0; type < kClothSpringTypeCount; type++)
+		{
+			springSet[grid][type].springData = springData;
+			springData += springSet[grid][type].springCount;
+		}
+	}
 }
 
 void ClothController::InitFlexibility(void)
@@ -4322,6 +4422,164 @@ void ClothController::InitFlexibility(void)
 	}
 }
 
+void ClothController::BuildSpringSet(int32 grid, int32 type, float distance)
+{
+	// The coarse grid uses every other particle in both directions. Its springs connect
+	// the same particles that are stored for the full grid, so no extra field storage
+	// is needed, and the particles in between are interpolated after each pass.
+
+	int32 stride = 1 << grid;
+	int32 width = (fieldWidth - 1) / stride + 1;
+	int32 height = (fieldHeight - 1) / stride + 1;
+	int32 rowStride = fieldWidth * stride;
+
+	SpringSet *set = &springSet[grid][type];
+	SpringData *springData = set->springData;
+
+	if (type == kClothSpringStretch)
+	{
+		set->springDistance = distance * (float) stride;
+
+		for (machine j = 0; j < height; j++)
+		{
+			int32 base = j * rowStride;
+			for (machine i = 1; i < width; i++)
+			{
+				springData->particleIndex1 = (unsigned_int16) (base + (i - 1) * stride);
+				springData->particleIndex2 = (unsigned_int16) (base + i * stride);
+				springData++;
+			}
+		}
+
+		for (machine i = 0; i < width; i++)
+		{
+			int32 base = i * stride;
+			for (machine j = 1; j < height; j++)
+			{
+				springData->particleIndex1 = (unsigned_int16) (base + (j - 1) * rowStride);
+				springData->particleIndex2 = (unsigned_int16) (base + j * rowStride);
+				springData++;
+			}
+		}
+	}
+	else if (type == kClothSpringShear)
+	{
+		set->springDistance = distance * (float) stride * K::sqrt_2;
+
+		for (machine j = 1; j < height; j++)
+		{
+			int32 base = j * rowStride;
+			for (machine i = 1; i < width; i++)
+			{
+				springData->particleIndex1 = (unsigned_int16) (base - rowStride + (i - 1) * stride);
+				springData->particleIndex2 = (unsigned_int16) (base + i * stride);
+				springData++;
+
+				springData->particleIndex1 = (unsigned_int16) (base - rowStride + i * stride);
+				springData->particleIndex2 = (unsigned_int16) (base + (i - 1) * stride);
+				springData++;
+			}
+		}
+	}
+	else
+	{
+		set->springDistance = distance * (float) (stride * 2);
+
+		for (machine j = 0; j < height; j++)
+		{
+			int32 base = j * rowStride;
+			for (machine i = 2; i < width; i++)
+			{
+				springData->particleIndex1 = (unsigned_int16) (base + (i - 2) * stride);
+				springData->particleIndex2 = (unsigned_int16) (base + i * stride);
+				springData++;
+			}
+		}
+
+		for (machine i = 0; i < width; i++)
+		{
+			int32 base = i * stride;
+			for (machine j = 2; j < height; j++)
+			{
+				springData->particleIndex1 = (unsigned_int16) (base + (j - 2) * rowStride);
+				springData->particleIndex2 = (unsigned_int16) (base + j * rowStride);
+				springData++;
+			}
+		}
+	}
+}
+
+void ClothController::ColorSpringSet(SpringSet *set, int32 particleCount)
+{
+	// Springs are assigned greedily to the first color that is not already used by another
+	// spring attached to either of their particles. A particle is attached to at most four
+	// springs of the same type, so no more than seven colors are ever needed.
+
+	int32		colorCount[kMaxClothSpringColorCount];
+
+	int32 springCount = set->springCount;
+	SpringData *springData = set->springData;
+
+	unsigned_int8 *colorStorage = new unsigned_int8[particleCount + springCount];
+	unsigned_int8 *particleMask = colorStorage;
+	unsigned_int8 *springColor = colorStorage + particleCount;
+	MemoryMgr::ClearMemory(particleMask, particleCount);
+
+	for (machine color = 0; color < kMaxClothSpringColorCount; color++)
+	{
+		colorCount[color] = 0;
+	}
+
+	for (machine a = 0; a < springCount; a++)
+	{
+		int32 index1 = springData[a].particleIndex1;
+		int32 index2 = springData[a].particleIndex2;
+
+		unsigned_int32 usedMask = particleMask[index1] | particleMask[index2];
+		int32 color = 0;
+		while (usedMask & (1 << color))
+		{
+			color++;
+		}
+
+		springColor[a] = (unsigned_int8) color;
+		particleMask[index1] |= (unsigned_int8) (1 << color);
+		particleMask[index2] |= (unsigned_int8) (1 << color);
+		colorCount[color]++;
+	}
+
+	int32 start = 0;
+	set->colorCount = 0;
+	for (machine color = 0; color < kMaxClothSpringColorCount; color++)
+	{
+		set->colorStart[color] = start;
+		start += colorCount[color];
+
+		if (colorCount[color] != 0)
+		{
+			set->colorCount = color + 1;
+		}
+	}
+
+	set->colorStart[kMaxClothSpringColorCount] = start;
+
+	SpringData *sortedData = new SpringData[springCount];
+	for (machine color = 0; color < kMaxClothSpringColorCount; color++)
+	{
+		colorCount[color] = set->colorStart[color];
+	}
+
+	for (machine a = 0; a < springCount; a++)
+	{
+		sortedData[colorCount[springColor[a]]++] = springData[a];
+	}
+
+	MemoryMgr::CopyMemory(sortedData, springData, springCount * sizeof(SpringData));
+
+	delete[] sortedData;
+	delete[] colorStorage;
+}
+
 void ClothController::Preprocess(void)
 {
 	DeformableBodyController::Preprocess();
@@ -4346,11 +4604,9 @@ void ClothController::Preprocess(void)
 	particleCount = fieldWidth * fieldHeight;
 
 	const Vector2D& size = object->GetClothSize();
-	stretchSpringDistance = Fmin(size.x / (float) (fieldWidth - 1), size.y / (float) (fieldHeight - 1));
-	shearSpringDistance = stretchSpringDistance * K::sqrt_2;
-	bendSpringDistance = stretchSpringDistance * 2.0F;
+	float springDistance = Fmin(size.x / (float) (fieldWidth - 1), size.y / (float) (fieldHeight - 1));
 
-	SetParticleVolume(stretchSpringDistance * stretchSpringDistance * (GetClothThickness() * GetVolumeMultiplier()));
+	SetParticleVolume(springDistance * springDistance * (GetClothThickness() * GetVolumeMultiplier()));
 
 	vertexStorage = new char[vertexCount * (sizeof(Point3D) + sizeof(Vector3D) * 2 + sizeof(Vector4D))];
 	clothPositionArray = reinterpret_cast<Point3D *>(vertexStorage);
@@ -4416,70 +4672,37 @@ void ClothController::Preprocess(void)
 
 	if (!springStorage)
 	{
-		stretchSpringCount = (fieldWidth - 1) * fieldHeight + fieldWidth * (fieldHeight - 1);
-		shearSpringCount = 2 * (fieldWidth - 1) * (fieldHeight - 1);
-		bendSpringCount = stretchSpringCount - fieldWidth - fieldHeight;
-		AllocateSpringStorage();
+		// The coarse grid is only available when every other particle lands exactly on the
+		// edges of the cloth, which requires an even number of subdivisions in each direction.
 
-		SpringData *springData = stretchSpringData;
-		for (machine j = 0; j < fieldHeight; j++)
-		{
-			int32 base = j * fieldWidth;
-			for (machine i = 1; i < fieldWidth; i++)
-			{
-				springData->particleIndex1 = (unsigned_int16) (base + i - 1);
-				springData->particleIndex2 = (unsigned_int16) (base + i);
-				springData++;
-			}
-		}
+		clothGridCount = ((((fieldWidth - 1) | (fieldHeight - 1)) & 1) == 0) ? kClothGridCount : 1;
+		AllocateSpringStorage();
 
-		for (machine i = 0; i < fieldWidth; i++)
+		for (machine grid = 0; grid < clothGridCount; grid++)
 		{
-			for (machine j = 1; j < fieldHeight; j++)
+			for (machine type = 0; type < kClothSpringTypeCount; type++)
 			{
-				springData->particleIndex1 = (unsigned_int16) (i + (j - 1) * fieldWidth);
-				springData->particleIndex2 = (unsigned_int16) (i + j * fieldWidth);
-				springData++;
+				BuildSpringSet(grid, type, springDistance);
+				ColorSpringSet(&springSet[grid][type], particleCount);
 			}
 		}
+	}
 
-		springData = shearSpringData;
-		for (machine j = 1; j < fieldHeight; j++)
-		{
-			int32 base = j * fieldWidth;
-			for (machine i = 1; i < fieldWidth; i++)
-			{
-				springData->particleIndex1 = (unsigned_int16) (base - fieldWidth + i - 1);
-				springData->particleIndex2 = (unsigned_int16) (base + i);
-				springData++;
-
-				springData->particleIndex1 = (unsigned_int16) (base - fieldWidth + i);
-				springData->particleIndex2 = (unsigned_int16) (base + i - 1);
-				springData++;
-			}
-		}
+	clothLevel = kClothLevelFull;
+	clothGrid = kClothGridFull;
+	clothStepTime = kClothDeltaTime;
 
-		springData = bendSpringData;
-		for (machine j = 0; j < fieldHeight; j++)
+	int32 workerCount = TheJobMgr->GetWorkerThreadCount();
+	if ((particleCount >= kClothParallelParticleCount) && (workerCount > 1) && (!solverJob))
+	{
+		solverJobCount = workerCount;
+		solverJob = new SolverJob[workerCount];
+		for (machine a = 0; a < workerCount; a++)
 		{
-			int32 base = j * fieldWidth;
-			for (machine i = 2; i < fieldWidth; i++)
-			{
-				springData->particleIndex1 = (unsigned_int16) (base + i - 2);
-				springData->particleIndex2 = (unsigned_int16) (base + i);
-				springData++;
-			}
+			solverJob[a].clothController = this;
 		}
 
-		for (machine i = 0; i < fieldWidth; i++)
-		{
-			for (machine j = 2; j < fieldHeight; j++)
-			{
-				springData->particleIndex1 = (unsigned_int16) (i + (j - 2) * fieldWidth);
-				springData->particleIndex2 = (unsigned_int16) (i + j * fieldWidth);
-				springData++;
-			}
-		}
+		SetDeformableBodyState(GetDeformableBodyState() | kDeformableBodyParallelStep);
 	}
 
 	if ((GetPhysicsController()) && (!clothGeometry->GetManipulator()))
@@ -4490,6 +4713,12 @@ void ClothController::Preprocess(void)
 
 void ClothController::Neutralize(void)
 {
+	SetDeformableBodyState(GetDeformableBodyState() & ~kDeformableBodyParallelStep);
+
+	delete[] solverJob;
+	solverJob = nullptr;
+	solverJobCount = 0;
+
 	clothVertexBuffer.Establish(0);
 
 	delete[] vertexStorage;
@@ -4516,7 +4745,7 @@ void ClothController::WarmStart(void)
 			clothFieldForce[a].Set(0.0F, 0.0F, 0.0F);
 		}
 
-		Simulate(passCount, CalculateGravityForce(), Zero3D);
+		Simulate(passCount, kClothDeltaTime, CalculateGravityForce(), Zero3D);
 
 		if (!Asleep())
 		{
@@ -4526,264 +4755,441 @@ void ClothController::WarmStart(void)
 	}
 }
 
-void ClothController::Simulate(int32 passCount, const Vector3D& gravityForce, const Vector3D& windVelocity, int32 threadIndex)
+void ClothController::CalculateParticleForces(int32 start, int32 count, int32 stride)
 {
-	FieldArray		fieldArray;
-
-	QueryForceFields(fieldArray, threadIndex);
-
-	ClothGeometry *clothGeometry = GetTargetNode();
-
-	Point3D *restrict finalPosition = clothPosition[kClothPositionFinal];
-	Point3D *restrict previousPosition = clothPosition[kClothPositionPrevious];
+	const Point3D *finalPosition = clothPosition[kClothPositionFinal];
+	const Point3D *previousPosition = clothPosition[kClothPositionPrevious];
 	SimdVector3D *restrict velocity = clothVelocity;
 	SimdVector3D *restrict force = clothBaseForce;
 
+	int32 finish = start + count;
+
 	#if C4SIMD
 
-		vec_float gravity = VecLoadUnaligned(&gravityForce.x);
-		vec_float wind = VecLoadUnaligned(&windVelocity.x);
+		vec_float gravity = VecLoadUnaligned(&solverState.gravityForce.x);
+		vec_float wind = VecLoadUnaligned(&solverState.windVelocity.x);
 		vec_float kw = VecLoadSmearScalar(&GetWindDragMultiplier());
-		vec_float t2_over_2m = VecSmearX(VecMulScalar(VecLoadScalar(&GetHalfInverseParticleMass()), VecLoadScalar(&kClothSquaredDeltaTime)));
+		vec_float inverseDeltaTime = VecLoadSmearScalar(&solverState.inverseDeltaTime);
 
-		const vec_float one = VecLoadVectorConstant<0x3F800000>();
-		vec_float velocityFactor = VecSmearX(VecMulScalar(VecSubScalar(one, VecLoadScalar(&GetInternalResistance())), VecLoadScalar(&kClothDeltaTime)));
-		vec_float inverseDeltaTime = VecLoadSmearScalar(&kClothInverseDeltaTime);
+		for (machine a = start; a < finish; a += stride)
+		{
+			velocity[a] = VecMul(VecSub(VecLoadUnaligned(&finalPosition[a].x), VecLoadUnaligned(&previousPosition[a].x)), inverseDeltaTime);
+			force[a] = VecMadd(VecSub(wind, velocity[a]), kw, gravity);
+		}
 
 	#else
 
 		float kw = GetWindDragMultiplier();
-		float t2_over_2m = GetHalfInverseParticleMass() * kClothSquaredDeltaTime;
-		float velocityFactor = (1.0F - GetInternalResistance()) * kClothDeltaTime;
+		float inverseDeltaTime = solverState.inverseDeltaTime;
+
+		for (machine a = start; a < finish; a += stride)
+		{
+			velocity[a] = (finalPosition[a] - previousPosition[a]) * inverseDeltaTime;
+			force[a] = (solverState.windVelocity - velocity[a]) * kw + solverState.gravityForce;
+		}
 
 	#endif
+}
 
-	do
-	{
-		#if C4SIMD
+void ClothController::ApplySprings(const SpringData *springData, int32 count, float ks, float kd, float x)
+{
+	const Point3D *finalPosition = clothPosition[kClothPositionFinal];
+	const SimdVector3D *velocity = clothVelocity;
+	SimdVector3D *restrict force = clothBaseForce;
 
-			for (machine a = 0; a < particleCount; a++)
-			{
-				velocity[a] = VecMul(VecSub(VecLoadUnaligned(&finalPosition[a].x), VecLoadUnaligned(&previousPosition[a].x)), inverseDeltaTime);
-				force[a] = VecMadd(VecSub(wind, velocity[a]), kw, gravity);
-			}
+	#if C4SIMD
 
-			vec_float ks = VecLoadSmearScalar(&stretchSpringConstant);
-			vec_float kd = VecLoadSmearScalar(&stretchDamperConstant);
-			vec_float x = VecLoadSmearScalar(&stretchSpringDistance);
+		const vec_float one = VecLoadVectorConstant<0x3F800000>();
+		vec_float vks = VecLoadSmearScalar(&ks);
+		vec_float vkd = VecLoadSmearScalar(&kd);
+		vec_float vx = VecLoadSmearScalar(&x);
 
-			const SpringData *springData = stretchSpringData;
-			for (machine a = 0; a < stretchSpringCount; a++)
-			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+		for (machine a = 0; a < count; a++)
+		{
+			int32 index1 = springData->particleIndex1;
+			int32 index2 = springData->particleIndex2;
 
-				vec_float p1 = VecLoadUnaligned(&finalPosition[index1].x);
-				vec_float p2 = VecLoadUnaligned(&finalPosition[index2].x);
+			vec_float p1 = VecLoadUnaligned(&finalPosition[index1].x);
+			vec_float p2 = VecLoadUnaligned(&finalPosition[index2].x);
 
-				const vec_float& v1 = velocity[index1];
-				const vec_float& v2 = velocity[index2];
+			const vec_float& v1 = velocity[index1];
+			const vec_float& v2 = velocity[index2];
 
-				vec_float dp = VecSub(p2, p1);
-				vec_float f = VecMul(dp, VecMul(ks, (VecSub(one, VecMul(x, VecSmearX(VecInverseSqrtScalar(VecDot3D(dp, dp))))))));
-				f = VecMadd(VecSub(v2, v1), kd, f);
+			vec_float dp = VecSub(p2, p1);
+			vec_float f = VecMul(dp, VecMul(vks, (VecSub(one, VecMul(vx, VecSmearX(VecInverseSqrtScalar(VecDot3D(dp, dp))))))));
+			f = VecMadd(VecSub(v2, v1), vkd, f);
 
-				force[index1] = VecAdd(force[index1], f);
-				force[index2] = VecSub(force[index2], f);
+			force[index1] = VecAdd(force[index1], f);
+			force[index2] = VecSub(force[index2], f);
 
-				springData++;
-			}
+			springData++;
+		}
 
-			ks = VecLoadSmearScalar(&shearSpringConstant);
-			kd = VecLoadSmearScalar(&shearDamperConstant);
-			x = VecLoadSmearScalar(&shearSpringDistance);
+	#else
 
-			springData = shearSpringData;
-			for (machine a = 0; a < shearSpringCount; a++)
-			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+		for (machine a = 0; a < count; a++)
+		{
+			int32 index1 = springData->particleIndex1;
+			int32 index2 = springData->particleIndex2;
 
-				vec_float p1 = VecLoadUnaligned(&finalPosition[index1].x);
-				vec_float p2 = VecLoadUnaligned(&finalPosition[index2].x);
+			const Point3D& p1 = finalPosition[index1];
+			const Point3D& p2 = finalPosition[index2];
 
-				const vec_float& v1 = velocity[index1];
-				const vec_float& v2 = velocity[index2];
+			const Vector3D& v1 = velocity[index1];
+			const Vector3D& v2 = velocity[index2];
 
-				vec_float dp = VecSub(p2, p1);
-				vec_float f = VecMul(dp, VecMul(ks, (VecSub(one, VecMul(x, VecSmearX(VecInverseSqrtScalar(VecDot3D(dp, dp))))))));
-				f = VecMadd(VecSub(v2, v1), kd, f);
+			Vector3D dp = p2 - p1;
+			Vector3D f = dp * (ks * (1.0F - x * InverseMag(dp))) + (v2 - v1) * kd;
 
-				force[index1] = VecAdd(force[index1], f);
-				force[index2] = VecSub(force[index2], f);
+			force[index1] += f;
+			force[index2] -= f;
 
-				springData++;
-			}
+			springData++;
+		}
 
-			ks = VecLoadSmearScalar(&bendSpringConstant);
-			kd = VecLoadSmearScalar(&bendDamperConstant);
-			x = VecLoadSmearScalar(&bendSpringDistance);
+	#endif
+}
 
-			springData = bendSpringData;
-			for (machine a = 0; a < bendSpringCount; a++)
-			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+void ClothController::IntegrateParticles(int32 start, int32 count, int32 stride)
+{
+	// With a stride of 2, only the particles on the coarse grid are integrated. The force
+	// fields are still evaluated for the whole range because they operate on contiguous
+	// arrays, and the results for the skipped particles are simply not used.
 
-				vec_float p1 = VecLoadUnaligned(&finalPosition[index1].x);
-				vec_float p2 = VecLoadUnaligned(&finalPosition[index2].x);
+	Point3D *restrict finalPosition = clothPosition[kClothPositionFinal];
+	Point3D *restrict previousPosition = clothPosition[kClothPositionPrevious];
+	const SimdVector3D *velocity = clothVelocity;
+	const SimdVector3D *force = clothBaseForce;
+	const float *flexibility = clothFlexibility;
 
-				const vec_float& v1 = velocity[index1];
-				const vec_float& v2 = velocity[index2];
+	ApplyForceFields(*solverState.fieldArray, count, finalPosition + start, clothVelocity + start, clothFieldForce + start);
 
-				vec_float dp = VecSub(p2, p1);
-				vec_float f = VecMul(dp, VecMul(ks, (VecSub(one, VecMul(x, VecSmearX(VecInverseSqrtScalar(VecDot3D(dp, dp))))))));
-				f = VecMadd(VecSub(v2, v1), kd, f);
+	int32 finish = start + count;
 
-				force[index1] = VecAdd(force[index1], f);
-				force[index2] = VecSub(force[index2], f);
+	#if C4SIMD
 
-				springData++;
-			}
+		vec_float t2_over_2m = VecLoadSmearScalar(&solverState.squaredTimeFactor);
+		vec_float velocityFactor = VecLoadSmearScalar(&solverState.velocityFactor);
 
-			ApplyForceFields(fieldArray, particleCount, finalPosition, velocity, clothFieldForce);
+		for (machine a = start; a < finish; a += stride)
+		{
+			vec_float f = VecAdd(force[a], clothFieldForce[a]);
+			vec_float p = VecLoadUnaligned(&finalPosition[a].x);
+			vec_float q = VecMadd(VecMadd(velocity[a], velocityFactor, VecMul(f, t2_over_2m)), VecLoadSmearScalar(&flexibility[a]), p);
+			VecStore3D(p, &previousPosition[a].x);
+			VecStore3D(q, &finalPosition[a].x);
+		}
 
-			const float *flexibility = clothFlexibility;
-			for (machine a = 0; a < particleCount; a++)
+	#else
+
+		float t2_over_2m = solverState.squaredTimeFactor;
+		float velocityFactor = solverState.velocityFactor;
+
+		for (machine a = start; a < finish; a += stride)
+		{
+			Vector3D f = force[a] + clothFieldForce[a];
+			Point3D q = finalPosition[a] + (velocity[a] * velocityFactor + f * t2_over_2m) * flexibility[a];
+			previousPosition[a] = finalPosition[a];
+			finalPosition[a] = q;
+		}
+
+	#endif
+}
+
+void ClothController::InterpolateParticles(int32 startRow, int32 rowCount)
+{
+	// When the coarse grid is simulated, the particles that it skips are placed halfway between
+	// their simulated neighbors. Attached particles keep their positions. Only particles on the
+	// coarse grid are read here, so any range of rows can be processed independently.
+
+	int32 width = fieldWidth;
+	const float *flexibility = clothFlexibility;
+
+	for (machine k = 0; k < kClothPositionCount; k++)
+	{
+		Point3D *restrict position = clothPosition[k];
+
+		for (machine j = startRow; j < startRow + rowCount; j++)
+		{
+			int32 base = j * width;
+
+			if ((j & 1) == 0)
 			{
-				vec_float f = VecAdd(force[a], clothFieldForce[a]);
-				vec_float p = VecLoadUnaligned(&finalPosition[a].x);
-				vec_float q = VecMadd(VecMadd(velocity[a], velocityFactor, VecMul(f, t2_over_2m)), VecLoadSmearScalar(&flexibility[a]), p);
-				VecStore3D(p, &previousPosition[a].x);
-				VecStore3D(q, &finalPosition[a].x);
+				for (machine i = 1; i < width; i += 2)
+				{
+					int32 index = base + i;
+					if (flexibility[index] != 0.0F)
+					{
+						const Point3D& p = position[index - 1];
+						position[index] = p + (position[index + 1] - p) * 0.5F;
+					}
+				}
 			}
+			else
+			{
+				for (machine i = 0; i < width; i++)
+				{
+					int32 index = base + i;
+					if (flexibility[index] != 0.0F)
+					{
+						if ((i & 1) == 0)
+						{
+							const Point3D& p = position[index - width];
+							position[index] = p + (position[index + width] - p) * 0.5F;
+						}
+						else
+						{
+							const Point3D& p = position[index - width - 1];
+							position[index] = p + ((position[index - width + 1] - p) + (position[index + width - 1] - p) + (position[index + width + 1] - p)) * 0.25F;
+						}
+					}
+				}
+			}
+		}
+	}
+}
 
-		#else
+void ClothController::ConstrainParticles(int32 start, int32 count)
+{
+	Point3D *restrict finalPosition = clothPosition[kClothPositionFinal];
+	const Point3D *previousPosition = clothPosition[kClothPositionPrevious];
 
-			for (machine a = 0; a < particleCount; a++)
+	solverState.blockerObject->ApplyBlocker(count, GetParticleRadius(), finalPosition + start, previousPosition + start, solverState.blockerTransform, solverState.inverseBlockerTransform);
+}
+
+void ClothController::ExecuteSolverPhase(int32 phase, int32 start, int32 count)
+{
+	// When the coarse grid is simulated, the particle force and integration phases are
+	// given ranges of coarse rows, and only every other particle in those rows is processed.
+
+	switch (phase)
+	{
+		case kClothPhaseParticleForce:
+
+			if (clothGrid == kClothGridFull)
 			{
-				velocity[a] = (finalPosition[a] - previousPosition[a]) * kClothInverseDeltaTime;
-				force[a] = (windVelocity - velocity[a]) * kw + gravityForce;
+				CalculateParticleForces(start, count);
+			}
+			else
+			{
+				for (machine j = start; j < start + count; j++)
+				{
+					CalculateParticleForces(j * fieldWidth * 2, fieldWidth, 2);
+				}
 			}
 
-			float ks = stretchSpringConstant;
-			float kd = stretchDamperConstant;
-			float x = stretchSpringDistance;
+			break;
+
+		case kClothPhaseSpringForce:
+
+			ApplySprings(solverState.springData + start, count, solverState.springConstant, solverState.damperConstant, solverState.springDistance);
+			break;
 
-			const SpringData *springData = stretchSpringData;
-			for (machine a = 0; a < stretchSpringCount; a++)
+		case kClothPhaseIntegrate:
+
+			if (clothGrid == kClothGridFull)
+			{
+				IntegrateParticles(start, count);
+			}
+			else
 			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+				for (machine j = start; j < start + count; j++)
+				{
+					IntegrateParticles(j * fieldWidth * 2, fieldWidth, 2);
+				}
+			}
 
-				const Point3D& p1 = finalPosition[index1];
-				const Point3D& p2 = finalPosition[index2];
+			break;
 
-				const Vector3D& v1 = velocity[index1];
-				const Vector3D& v2 = velocity[index2];
+		case kClothPhaseInterpolate:
 
-				Vector3D dp = p2 - p1;
-				Vector3D f = dp * (ks * (1.0F - x * InverseMag(dp))) + (v2 - v1) * kd;
+			InterpolateParticles(start, count);
+			break;
 
-				force[index1] += f;
-				force[index2] -= f;
+		case kClothPhaseBlocker:
 
-				springData++;
-			}
+			ConstrainParticles(start, count);
+			break;
+	}
+}
+
+void ClothController::RunSolverPhase(int32 phase, int32 count)
+{
+	// For large cloths simulated from the main thread, each phase is split into equal ranges
+	// that are handed to the worker threads. The main thread processes the first range itself
+	// and then waits for the rest, so the phases stay in order without the workers ever
+	// having to wait on each other.
 
-			ks = shearSpringConstant;
-			kd = shearDamperConstant;
-			x = shearSpringDistance;
+	if (solverState.parallelFlag)
+	{
+		int32 jobCount = Min(solverJobCount, (count + (kClothMinSolverJobItemCount - 1)) / kClothMinSolverJobItemCount);
+		if (jobCount > 1)
+		{
+			int32 rangeCount = (count + (jobCount - 1)) / jobCount;
+			int32 start = rangeCount;
 
-			springData = shearSpringData;
-			for (machine a = 0; a < shearSpringCount; a++)
+			for (machine a = 1; a < jobCount; a++)
 			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+				SolverJob *job = &solverJob[a];
+				job->solverPhase = phase;
+				job->phaseStart = start;
+				job->phaseCount = Min(rangeCount, count - start);
+				TheJobMgr->SubmitJob(job, &solverBatch);
 
-				const Point3D& p1 = finalPosition[index1];
-				const Point3D& p2 = finalPosition[index2];
+				start += rangeCount;
+			}
 
-				const Vector3D& v1 = velocity[index1];
-				const Vector3D& v2 = velocity[index2];
+			ExecuteSolverPhase(phase, 0, rangeCount);
+			TheJobMgr->FinishBatch(&solverBatch);
+			return;
+		}
+	}
 
-				Vector3D dp = p2 - p1;
-				Vector3D f = dp * (ks * (1.0F - x * InverseMag(dp))) + (v2 - v1) * kd;
+	ExecuteSolverPhase(phase, 0, count);
+}
 
-				force[index1] += f;
-				force[index2] -= f;
+void ClothController::JobExecuteSolverPhase(Job *job, void *cookie)
+{
+	const SolverJob *solverJob = static_cast<SolverJob *>(job);
+	solverJob->clothController->ExecuteSolverPhase(solverJob->solverPhase, solverJob->phaseStart, solverJob->phaseCount);
+}
 
-				springData++;
+void ClothController::UpdateClothLevel(void)
+{
+	int32 level = kClothLevelFull;
+
+	const ClothGeometry *clothGeometry = GetTargetNode();
+	const Camera *camera = clothGeometry->GetWorld()->GetCamera();
+	if (camera)
+	{
+		float d2 = SquaredMag(camera->GetWorldPosition() - clothGeometry->GetBoundingSphere()->GetCenter());
+		for (machine a = kClothLevelCoarse; a < kClothLevelCount; a++)
+		{
+			float distance = clothLevelDistance[a - 1];
+			if ((distance > 0.0F) && (d2 > distance * distance))
+			{
+				level = a;
 			}
+		}
+	}
 
-			ks = bendSpringConstant;
-			kd = bendDamperConstant;
-			x = bendSpringDistance;
+	clothLevel = level;
+	clothGrid = ((level != kClothLevelFull) && (clothGridCount > kClothGridCoarse)) ? kClothGridCoarse : kClothGridFull;
+}
 
-			springData = bendSpringData;
-			for (machine a = 0; a < bendSpringCount; a++)
-			{
-				int32 index1 = springData->particleIndex1;
-				int32 index2 = springData->particleIndex2;
+void ClothController::Simulate(int32 passCount, float deltaTime, const Vector3D& gravityForce, const Vector3D& windVelocity, int32 threadIndex)
+{
+	FieldArray		fieldArray;
 
-				const Point3D& p1 = finalPosition[index1];
-				const Point3D& p2 = finalPosition[index2];
+	QueryForceFields(fieldArray, threadIndex);
 
-				const Vector3D& v1 = velocity[index1];
-				const Vector3D& v2 = velocity[index2];
+	ClothGeometry *clothGeometry = GetTargetNode();
 
-				Vector3D dp = p2 - p1;
-				Vector3D f = dp * (ks * (1.0F - x * InverseMag(dp))) + (v2 - v1) * kd;
+	solverState.fieldArray = &fieldArray;
+	solverState.gravityForce = gravityForce;
+	solverState.windVelocity = windVelocity;
+	solverState.velocityFactor = (1.0F - GetInternalResistance()) * deltaTime;
+	solverState.squaredTimeFactor = GetHalfInverseParticleMass() * (deltaTime * deltaTime);
+	solverState.parallelFlag = ((solverJob) && (Thread::MainThread()));
+
+	solverState.blockerObject = nullptr;
+	const Node *blocker = GetBlockerNode();
+	if (blocker)
+	{
+		solverState.blockerObject = static_cast<const Blocker *>(blocker)->GetObject();
+		solverState.blockerTransform = clothGeometry->GetInverseWorldTransform() * blocker->GetWorldTransform();
+		solverState.inverseBlockerTransform = blocker->GetInverseWorldTransform() * clothGeometry->GetWorldTransform();
+	}
 
-				force[index1] += f;
-				force[index2] -= f;
+	const float springConstant[kClothSpringTypeCount] = {stretchSpringConstant, shearSpringConstant, bendSpringConstant};
+	const float damperConstant[kClothSpringTypeCount] = {stretchDamperConstant, shearDamperConstant, bendDamperConstant};
 
-				springData++;
-			}
+	const SpringSet *gridSpringSet = springSet[clothGrid];
+	int32 solverCount = (clothGrid == kClothGridFull) ? particleCount : (fieldHeight + 1) >> 1;
 
-			ApplyForceFields(fieldArray, particleCount, finalPosition, velocity, clothFieldForce);
+	do
+	{
+		// Velocities are derived from the previous step, which may have had a different
+		// length than this one when the cloth level has just changed.
 
-			const float *flexibility = clothFlexibility;
-			for (machine a = 0; a < particleCount; a++)
+		solverState.inverseDeltaTime = 1.0F / clothStepTime;
+		clothStepTime = deltaTime;
+
+		RunSolverPhase(kClothPhaseParticleForce, solverCount);
+
+		for (machine type = 0; type < kClothSpringTypeCount; type++)
+		{
+			const SpringSet *set = &gridSpringSet[type];
+			float ks = springConstant[type];
+			float kd = damperConstant[type];
+			float x = set->springDistance;
+
+			if (solverState.parallelFlag)
 			{
-				Vector3D f = force[a] + clothFieldForce[a];
-				Point3D q = finalPosition[a] + (velocity[a] * velocityFactor + f * t2_over_2m) * flexibility[a];
-				previousPosition[a] = finalPosition[a];
-				finalPosition[a] = q;
+				solverState.springConstant = ks;
+				solverState.damperConstant = kd;
+				solverState.springDistance = x;
+
+				int32 colorCount = set->colorCount;
+				for (machine color = 0; color < colorCount; color++)
+				{
+					int32 start = set->colorStart[color];
+					solverState.springData = set->springData + start;
+					RunSolverPhase(kClothPhaseSpringForce, set->colorStart[color + 1] - start);
+				}
 			}
+			else
+			{
+				ApplySprings(set->springData, set->springCount, ks, kd, x);
+			}
+		}
 
-		#endif
+		RunSolverPhase(kClothPhaseIntegrate, solverCount);
 
-		const Node *blocker = GetBlockerNode();
-		if (blocker)
+		if (clothGrid == kClothGridCoarse)
 		{
-			Transform4D transform = clothGeometry->GetInverseWorldTransform() * blocker->GetWorldTransform();
-			Transform4D inverseTransform = blocker->GetInverseWorldTransform() * clothGeometry->GetWorldTransform();
+			RunSolverPhase(kClothPhaseInterpolate, fieldHeight);
+		}
 
-			const BlockerObject *blockerObject = static_cast<const Blocker *>(blocker)->GetObject();
-			blockerObject->ApplyBlocker(particleCount, GetParticleRadius(), finalPosition, previousPosition, transform, inverseTransform);
+		if (solverState.blockerObject)
+		{
+			RunSolverPhase(kClothPhaseBlocker, particleCount);
 		}
 	} while (--passCount > 0);
 
-	clothBoundingBox.Calculate(particleCount, finalPosition);
+	clothBoundingBox.Calculate(particleCount, clothPosition[kClothPositionFinal]);
 	clothGeometry->SetWorldBoundingBox(Transform(clothBoundingBox, clothGeometry->GetWorldTransform()));
 
 	Invalidate();
 }
 
-void ClothController::JobStepSimulation(Job *job, void *cookie)
+void ClothController::StepSimulation(int32 threadIndex)
 {
-	ClothController *clothController = static_cast<ClothController *>(cookie);
-	Vector3D wind = clothController->GetWindVelocity();
+	Vector3D wind = GetWindVelocity();
 
-	const Node *field = clothController->GetWindFieldNode();
+	const Node *field = GetWindFieldNode();
 	if ((field) && (field->Enabled()))
 	{
-		const Transform4D& inverseTransform = clothController->GetTargetNode()->GetInverseWorldTransform();
+		const Transform4D& inverseTransform = GetTargetNode()->GetInverseWorldTransform();
 		wind += inverseTransform * (field->GetWorldTransform() * static_cast<WindForce *>(static_cast<const Field *>(field)->GetForce())->GetWindVelocity());
 	}
 
-	clothController->Simulate(kClothStepRatio, clothController->CalculateGravityForce(), wind, job->GetThreadIndex());
+	// At the distant level, the whole physics step is covered by a single pass.
+
+	UpdateClothLevel();
+	int32 passCount = (clothLevel == kClothLevelDistant) ? 1 : kClothStepRatio;
+
+	Simulate(passCount, kClothDeltaTime * (float) (kClothStepRatio / passCount), CalculateGravityForce(), wind, threadIndex);
+}
+
+void ClothController::JobStepSimulation(Job *job, void *cookie)
+{
+	static_cast<ClothController *>(cookie)->StepSimulation(job->GetThreadIndex());
+}
+
+void ClothController::StepParallelSimulation(void)
+{
+	StepSimulation(JobMgr::kMaxWorkerThreadCount);
 }
 
 void ClothController::Update(void)
@@ -55,7 +55,8 @@ namespace C4
 
 	enum
 	{
-		kDeformableBodyAutoAsleep			= 1 << 0
+		kDeformableBodyAutoAsleep			= 1 << 0,
+		kDeformableBodyParallelStep			= 1 << 1
 	};
 
 
@@ -88,6 +89,17 @@ namespace C4
 	};
 
 
+	//# \enum	ClothLevel
+
+	enum
+	{
+		kClothLevelFull,			//## The full particle grid is simulated with the normal number of passes.
+		kClothLevelCoarse,			//## Every other particle is simulated, and the rest are interpolated.
+		kClothLevelDistant,			//## The coarse particle grid is simulated with a single pass per physics step.
+		kClothLevelCount
+	};
+
+
 	enum
 	{
 		kClothLowerLeftCorner		= 1 << 0,
@@ -108,6 +120,7 @@ namespace C4
 	class PhysicsController; 
 	class ForceFieldThreadData;
 	class Field;
+	class BlockerObject;
  
 
 	//# \class	DeformableBodyController		Manages a dynamically deformable geometry. 
@@ -211,6 +224,7 @@ namespace C4
 
 			void RecursiveWake(void) override;
 			virtual void AutoSleep(void);
+			virtual void StepParallelSimulation(void);
 
 			Vector3D CalculateGravityForce(void) const;
 
@@ -912,37 +926,114 @@ namespace C4
 				Vector4D		tangent;
 			};
 
+			enum
+			{
+				kClothGridFull,
+				kClothGridCoarse,
+				kClothGridCount
+			};
+
+			enum
+			{
+				kClothSpringStretch,
+				kClothSpringShear,
+				kClothSpringBend,
+				kClothSpringTypeCount
+			};
+
+			enum
+			{
+				kMaxClothSpringColorCount = 8
+			};
+
+			enum
+			{
+				kClothPhaseParticleForce,
+				kClothPhaseSpringForce,
+				kClothPhaseIntegrate,
+				kClothPhaseInterpolate,
+				kClothPhaseBlocker
+			};
+
 			struct SpringData
 			{
 				unsigned_int16		particleIndex1;
 				unsigned_int16		particleIndex2;
 			};
 
+			// The springs of each type are sorted by color so that no two springs in the
+			// same color share a particle. The springs in one color can therefore be
+			// processed by several threads at the same time.
+
+			struct SpringSet
+			{
+				int32				springCount;
+				float				springDistance;
+				SpringData			*springData;
+
+				int32				colorCount;
+				int32				colorStart[kMaxClothSpringColorCount + 1];
+			};
+
+			struct SolverState
+			{
+				const FieldArray		*fieldArray;
+				Vector3D				gravityForce;
+				Vector3D				windVelocity;
+
+				float					inverseDeltaTime;
+				float					velocityFactor;
+				float					squaredTimeFactor;
+
+				const BlockerObject		*blockerObject;
+				Transform4D				blockerTransform;
+				Transform4D				inverseBlockerTransform;
+
+				const SpringData		*springData;
+				float					springConstant;
+				float					damperConstant;
+				float					springDistance;
+
+				bool					parallelFlag;
+			};
+
+			class SolverJob : public BatchJob
+			{
+				public:
+
+					ClothController		*clothController;
+					int32				solverPhase;
+					int32				phaseStart;
+					int32				phaseCount;
+
+					SolverJob() : BatchJob(&JobExecuteSolverPhase)
+					{
+					}
+			};
+
 			int32					particleCount;
 			int32					fieldWidth;
 			int32					fieldHeight;
 
-			int32					stretchSpringCount;
-			int32					shearSpringCount;
-			int32					bendSpringCount;
-
 			float					stretchSpringConstant;
 			float					stretchDamperConstant;
-			float					stretchSpringDistance;
-			SpringData				*stretchSpringData;
 
 			float					shearSpringConstant;
 			float					shearDamperConstant;
-			float					shearSpringDistance;
-			SpringData				*shearSpringData;
 
 			float					bendSpringConstant;
 			float					bendDamperConstant;
-			float					bendSpringDistance;
-			SpringData				*bendSpringData;
 
 			unsigned_int32			attachmentFlags;
 
+			int32					clothLevel;
+			int32					clothGrid;
+			int32					clothGridCount;
+			float					clothStepTime;
+			float					clothLevelDistance[kClothLevelCount - 1];
+
+			SpringSet				springSet[kClothGridCount][kClothSpringTypeCount];
+
 			Point3D					*clothPositionArray;
 			Vector3D				*clothVelocityArray;
 			Vector3D				*clothNormalArray;
@@ -961,6 +1052,11 @@ namespace C4
 
 			Box3D					clothBoundingBox;
 
+			SolverState				solverState;
+			int32					solverJobCount;
+			SolverJob				*solverJob;
+			Batch					solverBatch;
+
 			BatchJob				clothUpdateJob;
 			VertexBuffer			clothVertexBuffer;
 
@@ -972,10 +1068,28 @@ namespace C4
 			void AllocateSpringStorage(void);
 			void InitFlexibility(void);
 
+			void BuildSpringSet(int32 grid, int32 type, float distance);
+			static void ColorSpringSet(SpringSet *set, int32 particleCount);
+
+			void CalculateParticleForces(int32 start, int32 count, int32 stride = 1);
+			void ApplySprings(const SpringData *springData, int32 count, float ks, float kd, float x);
+			void IntegrateParticles(int32 start, int32 count, int32 stride = 1);
+			void InterpolateParticles(int32 startRow, int32 rowCount);
+			void ConstrainParticles(int32 start, int32 count);
+
+			void ExecuteSolverPhase(int32 phase, int32 start, int32 count);
+			void RunSolverPhase(int32 phase, int32 count);
+			static void JobExecuteSolverPhase(Job *job, void *cookie);
+
+			void UpdateClothLevel(void);
+
 			void WarmStart(void);
-			void Simulate(int32 passCount, const Vector3D& gravityForce, const Vector3D& windVelocity, int32 threadIndex = JobMgr::kMaxWorkerThreadCount);
+			void Simulate(int32 passCount, float deltaTime, const Vector3D& gravityForce, const Vector3D& windVelocity, int32 threadIndex = JobMgr::kMaxWorkerThreadCount);
+			void StepSimulation(int32 threadIndex);
 			static void JobStepSimulation(Job *job, void *cookie);
 
+			void StepParallelSimulation(void) override;
+
 			static void JobUpdateCloth(Job *job, void *cookie);
 			static void FinalizeClothUpdate(Job *job, void *cookie);
 
@@ -1053,6 +1167,22 @@ namespace C4
 				attachmentFlags = flags;
 			}
 
+			int32 GetClothLevel(void) const
+			{
+				return (clothLevel);
+			}
+
+			float GetClothLevelDistance(int32 level) const
+			{
+				return (clothLevelDistance[level - 1]);
+			}
+
+			void SetClothLevelDistances(float coarse, float distant)
+			{
+				clothLevelDistance[kClothLevelCoarse - 1] = coarse;
+				clothLevelDistance[kClothLevelDistant - 1] = distant;
+			}
+
 			const Box3D *GetClothBoundingBox(void) const
 			{
 				return (&clothBoundingBox);
@@ -279,6 +279,11 @@ DisplayMgr::~DisplayMgr()
 
 EngineResult DisplayMgr::Construct(void)
 {
+	if (TheEngine->GetEngineFlags() & kEngineHeadless)
+	{
+		return (ConstructHeadless());
+	}
+
 	#if C4OCULUS
 
 		 Oculus::Initialize();
@@ -481,10 +486,48 @@ EngineResult DisplayMgr::Construct(void)
 	return (kEngineOkay);
 }
 
+EngineResult DisplayMgr::ConstructHeadless(void)
+{
+	// A headless engine has no physical display. The display dimensions are still taken from the
+	// configuration so that the interface and any loaded worlds can lay themselves out, and the
+	// Graphics Manager is constructed without a rendering context.
+
+	currentDisplay = nullptr;
+
+	#if C4WINDOWS
+
+		displayWindow = nullptr;
+
+	#endif
+
+	displayChanged = false;
+	cursorVisible = false;
+
+	Variable *widthVar = TheEngine->InitVariable("displayWidth", "1024", kVariablePermanent);
+	Variable *heightVar = TheEngine->InitVariable("displayHeight", "768", kVariablePermanent);
+
+	int32 width = MaxZero(widthVar->GetIntegerValue());
+	int32 height = MaxZero(heightVar->GetIntegerValue());
+
+	fullFrameWidth = width;
+	fullFrameHeight = height;
+	displayWidth = width;
+	displayHeight = height;
+	displaySamples = 1;
+	displayFlags = 0;
+
+	return (GraphicsMgr::New());
+}
+
 void DisplayMgr::Destruct(void)
 {
 	GraphicsMgr::Delete();
 
+	if (TheEngine->GetEngineFlags() & kEngineHeadless)
+	{
+		return;
+	}
+
 	ShowCursor();
 
 	#if C4WINDOWS
@@ -527,6 +570,13 @@ void DisplayMgr::Destruct(void)
 
 EngineResult DisplayMgr::SetDisplayMode(int32 width, int32 height, int32 samples, unsigned_int32 flags)
 {
+	if (TheEngine->GetEngineFlags() & kEngineHeadless)
+	{
+		// The display mode of a headless engine is fixed when the Display Manager is constructed.
+
+		return (kEngineOkay);
+	}
+
 	const DisplayMode *mode = currentDisplay->FindDisplayMode(width, height);
 	if ((flags & kDisplayFullscreen) && (!mode))
 	{
@@ -810,7 +860,11 @@ void DisplayMgr::ShowCursor(void)
 
 		#elif C4LINUX
 
-			XUndefineCursor(TheEngine->GetEngineDisplay(), TheEngine->GetEngineWindow());
+			::Display *engineDisplay = TheEngine->GetEngineDisplay();
+			if (engineDisplay)
+			{
+				XUndefineCursor(engineDisplay, TheEngine->GetEngineWindow());
+			}
 
 		#endif
 	}
@@ -832,7 +886,11 @@ void DisplayMgr::HideCursor(void)
 
 		#elif C4LINUX
 
-			XDefineCursor(TheEngine->GetEngineDisplay(), TheEngine->GetEngineWindow(), emptyCursor);
+			::Display *engineDisplay = TheEngine->GetEngineDisplay();
+			if (engineDisplay)
+			{
+				XDefineCursor(engineDisplay, TheEngine->GetEngineWindow(), emptyCursor);
+			}
 
 		#endif
 	}
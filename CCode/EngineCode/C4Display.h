@@ -420,6 +420,8 @@ namespace C4
 
 			#endif //]
 
+			EngineResult ConstructHeadless(void);
+
 		public:
 
 			DisplayMgr(int);
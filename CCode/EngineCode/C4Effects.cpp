@@ -291,15 +291,18 @@ void Effect::Neutralize(void)
 
 void Effect::HandleVisibilityUpdate(void)
 {
-	PurgeVisibility();
-
 	Zone *zone = GetOwningZone();
 	if (!(GetNodeFlags() & kNodeInfiniteVisibility))
 	{
-		zone->InsertZoneTreeSite(kCellGraphEffect, this, GetMaxSubzoneDepth(), GetForcedSubzoneDepth());
+		if (!zone->UpdateZoneTreeSite(kCellGraphEffect, this))
+		{
+			PurgeVisibility();
+			zone->InsertZoneTreeSite(kCellGraphEffect, this, GetMaxSubzoneDepth(), GetForcedSubzoneDepth());
+		}
 	}
 	else
 	{
+		PurgeVisibility();
 		zone->InsertInfiniteSite(kCellGraphEffect, this, Min(GetMaxSubzoneDepth(), GetForcedSubzoneDepth()));
 	}
 
@@ -7,6 +7,8 @@
 #include "C4World.h"
 #include "C4ToolWindows.h"
 #include "C4Logo.h"
+#include "C4Profiler.h"
+#include "C4PhysicsRecorder.h"
 
 
 using namespace C4;
@@ -272,6 +274,24 @@ Engine::Engine(int) :
 		#if C4STATS
 
 			statCommandObserver(this, &Engine::HandleStatCommand),
+			physbenchCommandObserver(this, &Engine::HandlePhysbenchCommand),
+			ftimeCommandObserver(this, &Engine::HandleFtimeCommand),
+			navbenchCommandObserver(this, &Engine::HandleNavbenchCommand),
+			physrecCommandObserver(this, &Engine::HandlePhysrecCommand),
+			physplayCommandObserver(this, &Engine::HandlePhysplayCommand),
+			blockbenchCommandObserver(this, &Engine::HandleBlockbenchCommand),
+			moviebenchCommandObserver(this, &Engine::HandleMoviebenchCommand),
+			loadbenchCommandObserver(this, &Engine::HandleLoadbenchCommand),
+			savebenchCommandObserver(this, &Engine::HandleSavebenchCommand),
+			atombenchCommandObserver(this, &Engine::HandleAtombenchCommand),
+			hashbenchCommandObserver(this, &Engine::HandleHashbenchCommand),
+			streambenchCommandObserver(this, &Engine::HandleStreambenchCommand),
+
+		#endif
+
+		#if C4PROFILE
+
+			profCommandObserver(this, &Engine::HandleProfCommand),
 
 		#endif
 
@@ -326,6 +346,13 @@ EngineResult Engine::Construct(void)
 
 	InitializeProcessorData();
 
+	#if C4STATS
+
+		frameTimingCount = 0;
+		physicsRecorder = nullptr;
+
+	#endif
+
 	#if C4LOG_FILE
 
 		InstallReporter(&logger);
@@ -352,6 +379,24 @@ EngineResult Engine::Construct(void)
 	#if C4STATS
 
 		AddCommand(new Command("stat", &statCommandObserver));
+		AddCommand(new Command("physbench", &physbenchCommandObserver));
+		AddCommand(new Command("ftime", &ftimeCommandObserver));
+		AddCommand(new Command("navbench", &navbenchCommandObserver));
+		AddCommand(new Command("physrec", &physrecCommandObserver));
+		AddCommand(new Command("physplay", &physplayCommandObserver));
+		AddCommand(new Command("blockbench", &blockbenchCommandObserver));
+		AddCommand(new Command("moviebench", &moviebenchCommandObserver));
+		AddCommand(new Command("loadbench", &loadbenchCommandObserver));
+		AddCommand(new Command("savebench", &savebenchCommandObserver));
+		AddCommand(new Command("atombench", &atombenchCommandObserver));
+		AddCommand(new Command("hashbench", &hashbenchCommandObserver));
+		AddCommand(new Command("streambench", &streambenchCommandObserver));
+
+	#endif
+
+	#if C4PROFILE
+
+		AddCommand(new Command("prof", &profCommandObserver));
 
 	#endif
 
@@ -389,6 +434,12 @@ void Engine::Destruct(void)
 
 	variableMap.Purge();
 	commandMap.Purge();
+
+	#if C4STATS
+
+		delete physicsRecorder;
+
+	#endif
 }
 
 #if C4WINDOWS
@@ -436,6 +487,10 @@ void Engine::Destruct(void)
 
 		wideName[len] = 0;
 
+		// The window is created before the command line has been executed, so it also exists in
+		// headless mode. It is never shown in that case because the Display Manager doesn't set
+		// a display mode, but it still receives the messages processed by the main loop.
+
 		engineWindow = CreateWindowExW(0, L"C4", wideName, WS_POPUP | WS_CLIPCHILDREN, 0, 0, 640, 480, nullptr, nullptr, engineInstance, nullptr);
 
 		SetFocus(engineWindow);
@@ -464,16 +519,10 @@ void Engine::Destruct(void)
 
 	#elif C4LINUX
 
-		XSetWindowAttributes	attributes;
+		// The connection to the X server is opened in ConstructManagers() after the
+		// command line has been executed so that it can be skipped in headless mode.
 
-		engineDisplay = XOpenDisplay(nullptr);
-
-		attributes.event_mask = ButtonPressMask | ButtonReleaseMask | PointerMotionMask | KeyPressMask | KeyReleaseMask;
-		engineWindow = XCreateWindow(engineDisplay, DefaultRootWindow(engineDisplay), 0, 0, 640, 480, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask, &attributes);
-		XStoreName(engineDisplay, engineWindow, name);
-
-		deleteWindowAtom = XInternAtom(engineDisplay, "WM_DELETE_WINDOW", false);
-		XSetWMProtocols(engineDisplay, engineWindow, &deleteWindowAtom, 1);
+		engineDisplay = nullptr;
 
 	#elif C4PS3 //[ PS3
 
@@ -517,6 +566,8 @@ void Engine::Terminate(void)
 	UnloadApplicationModule();
 	DestroyManagers();
 
+	TextAtom::PurgeAtoms();
+
 	#if C4WINDOWS
 
 		CoUninitialize();
@@ -531,8 +582,11 @@ void Engine::Terminate(void)
 
 	#elif C4LINUX
 
-		XDestroyWindow(engineDisplay, engineWindow);
-		XCloseDisplay(engineDisplay);
+		if (engineDisplay)
+		{
+			XDestroyWindow(engineDisplay, engineWindow);
+			XCloseDisplay(engineDisplay);
+		}
 
 	#elif C4PS3 //[ PS3
 
@@ -638,6 +692,12 @@ EngineResult Engine::ConstructManagers(const char *commandLine)
 	FileMgr::New();
 	TimeMgr::New();
 
+	#if C4PROFILE
+
+		Profiler::Initialize();
+
+	#endif
+
 	#if C4MACOS
 
 		openglBundle = nullptr;
@@ -682,6 +742,25 @@ EngineResult Engine::ConstructManagers(const char *commandLine)
 	}
 
 	ExecuteText(commandLine);
+	InitializeHeadlessMode();
+
+	#if C4LINUX
+
+		if (!(engineFlags & kEngineHeadless))
+		{
+			XSetWindowAttributes	attributes;
+
+			engineDisplay = XOpenDisplay(nullptr);
+
+			attributes.event_mask = ButtonPressMask | ButtonReleaseMask | PointerMotionMask | KeyPressMask | KeyReleaseMask;
+			engineWindow = XCreateWindow(engineDisplay, DefaultRootWindow(engineDisplay), 0, 0, 640, 480, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask, &attributes);
+			XStoreName(engineDisplay, engineWindow, applicationName);
+
+			deleteWindowAtom = XInternAtom(engineDisplay, "WM_DELETE_WINDOW", false);
+			XSetWMProtocols(engineDisplay, engineWindow, &deleteWindowAtom, 1);
+		}
+
+	#endif
 
 	#if !C4PS3
 
@@ -723,6 +802,127 @@ EngineResult Engine::ConstructManagers(const char *commandLine)
 	return (kEngineOkay);
 }
 
+void Engine::InitializeHeadlessMode(void)
+{
+	headlessTickInterval = 0;
+	headlessTickTime = 0;
+
+	const Variable *headlessVariable = GetVariable("headless");
+	if ((headlessVariable) && (headlessVariable->GetIntegerValue() != 0))
+	{
+		// A headless engine never becomes the foreground process and never renders,
+		// so input is not polled and the main loop is paced by a fixed tick instead.
+
+		engineFlags = (engineFlags & ~(kEngineForeground | kEngineVisible)) | kEngineHeadless;
+
+		int32 tickRate = kDefaultHeadlessTickRate;
+		const Variable *tickVariable = GetVariable("tickRate");
+		if ((tickVariable) && (tickVariable->GetIntegerValue() > 0))
+		{
+			tickRate = Min(tickVariable->GetIntegerValue(), 1000);
+		}
+
+		headlessTickInterval = 1000000 / tickRate;
+	}
+}
+
+void Engine::WaitHeadlessTick(void)
+{
+	// The tick deadline advances by a fixed interval each iteration. If the previous tick
+	// ran long, the deadline is pulled forward to the current time so that the server does
+	// not run a burst of back-to-back ticks trying to catch up.
+
+	unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+	unsigned_int64 tickTime = headlessTickTime;
+	if (tickTime > time)
+	{
+		Thread::Sleep((unsigned_int32) ((tickTime - time) / 1000));
+
+		time = TheTimeMgr->GetMicrosecondCount();
+		while (time < tickTime)
+		{
+			Thread::Yield();
+			time = TheTimeMgr->GetMicrosecondCount();
+		}
+	}
+	else
+	{
+		tickTime = time;
+	}
+
+	headlessTickTime = tickTime + headlessTickInterval;
+}
+
+#if C4STATS
+
+	void Engine::BeginFrameTiming(void)
+	{
+		if (frameTimingCount > 0)
+		{
+			unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+			frameBeginTime = time;
+			framePhaseTime = time;
+		}
+	}
+
+	void Engine::RecordFramePhase(int32 phase)
+	{
+		if (frameTimingCount > 0)
+		{
+			unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+			unsigned_int32 dt = (unsigned_int32) (time - framePhaseTime);
+			framePhaseTime = time;
+
+			framePhaseTotal[phase] += dt;
+			framePhaseMax[phase] = Max(framePhaseMax[phase], dt);
+		}
+	}
+
+	void Engine::EndFrameTiming(void)
+	{
+		if (frameTimingCount > 0)
+		{
+			unsigned_int32 dt = (unsigned_int32) (framePhaseTime - frameBeginTime);
+			frameTimeTotal += dt;
+			frameTimeMax = Max(frameTimeMax, dt);
+
+			if (--frameTimingCount == 0)
+			{
+				ReportFrameTiming();
+			}
+		}
+	}
+
+	void Engine::ReportFrameTiming(void)
+	{
+		static const char *const phaseName[kFramePhaseCount] =
+		{
+			"Events", "Receive", "Interface", "Application", "Move", "Send", "Sound", "Render"
+		};
+
+		// A headless engine has no console window, so the results are written to the log instead.
+
+		unsigned_int32 flags = (engineFlags & kEngineHeadless) ? kReportLog : 0;
+		int32 frameCount = frameTimingTotal;
+
+		String<kMaxCommandLength> report("Frame timing over ");
+		(report += frameCount) += " frames (avg/max us)";
+		Report(report, flags);
+
+		for (machine a = 0; a < kFramePhaseCount; a++)
+		{
+			report = phaseName[a];
+			(((report += ": ") += (int32) (framePhaseTotal[a] / frameCount)) += " / ") += (int32) framePhaseMax[a];
+			Report(report, flags);
+		}
+
+		report = "Total: ";
+		((report += (int32) (frameTimeTotal / frameCount)) += " / ") += (int32) frameTimeMax;
+		Report(report, flags);
+	}
+
+#endif
+
 void Engine::DestroyManagers(void)
 {
 	delete TheConsoleWindow;
@@ -733,6 +933,13 @@ void Engine::DestroyManagers(void)
 	NetworkMgr::Delete();
 	MovieMgr::Delete();
 	InterfaceMgr::Delete();
+
+	#if C4PROFILE
+
+		Profiler::FinishSpikeExport();
+
+	#endif
+
 	JobMgr::Delete();
 	InputMgr::Delete();
 	AudioCaptureMgr::Delete();
@@ -757,6 +964,12 @@ void Engine::DestroyManagers(void)
 
 	#endif
 
+	#if C4PROFILE
+
+		Profiler::Terminate();
+
+	#endif
+
 	TimeMgr::Delete();
 
 	#if !C4MACOS || !C4LEAK_DETECTION
@@ -2704,8 +2917,20 @@ bool Engine::Run(void)
 
 	for (;;)
 	{
+		if (engineFlags & kEngineHeadless)
+		{
+			WaitHeadlessTick();
+		}
+
+		BeginFrameTiming();
 		TheTimeMgr->TimeTask();
 
+		#if C4PROFILE
+
+			Profiler::NewFrame();
+
+		#endif
+
 		if (engineFlags & kEngineQuit)
 		{
 			return (false);
@@ -2723,7 +2948,7 @@ bool Engine::Run(void)
 
 		#elif C4LINUX
 
-			while (XPending(engineDisplay))
+			while ((engineDisplay) && (XPending(engineDisplay)))
 			{
 				XEvent		event;
 
@@ -2771,24 +2996,38 @@ bool Engine::Run(void)
 			TheInputMgr->InputTask();
 		}
 
+		RecordFramePhase(kFramePhaseEvents);
 		TheMessageMgr->ReceiveTask();
-		TheInterfaceMgr->InterfaceTask();
-		TheAudioCaptureMgr->AudioCaptureTask();
+		RecordFramePhase(kFramePhaseReceive);
 
+		if (!(engineFlags & kEngineHeadless))
+		{
+			TheInterfaceMgr->InterfaceTask();
+			TheAudioCaptureMgr->AudioCaptureTask();
+		}
+
+		RecordFramePhase(kFramePhaseInterface);
 		TheApplication->ApplicationTask();
+		RecordFramePhase(kFramePhaseApplication);
 		TheWorldMgr->Move();
+		RecordFramePhase(kFramePhaseMove);
 		TheMessageMgr->SendTask();
+		RecordFramePhase(kFramePhaseSend);
 		TheSoundMgr->SoundTask();
+		RecordFramePhase(kFramePhaseSound);
 
 		if (engineFlags & kEngineVisible)
 		{
 			TheWorldMgr->Render();
 		}
 
+		RecordFramePhase(kFramePhaseRender);
+		EndFrameTiming();
+
 		#if C4DESKTOP
 
 			bool multiplayerServer = (TheMessageMgr->Multiplayer()) & (TheMessageMgr->Server());
-			if ((!multiplayerServer) && (!(engineFlags & kEngineForeground)))
+			if ((!multiplayerServer) && (!(engineFlags & (kEngineForeground | kEngineHeadless))))
 			{
 				int32 dt = TheTimeMgr->GetDeltaTime();
 				int32 sleepTime = Max(backgroundSleepTime + (40 - dt) / 2, 1);
@@ -51,7 +51,37 @@ namespace C4
 	{
 		kEngineForeground		= 1 << 0,		//## The engine is currently the foreground process.
 		kEngineVisible			= 1 << 1,		//## The engine is currently visible (not minimized or otherwise hidden).
-		kEngineQuit				= 1 << 2		//## The engine is in the process of quitting.
+		kEngineQuit				= 1 << 2,		//## The engine is in the process of quitting.
+		kEngineHeadless			= 1 << 3		//## The engine is running as a dedicated server without a display, graphics, or sound output.
+	};
+
+
+	enum
+	{
+		kDefaultHeadlessTickRate	= 60,
+		kDefaultFrameTimingCount	= 600,
+		kDefaultNavbenchCount		= 1000,
+		kDefaultBlockbenchSize		= 1024,
+		kDefaultMoviebenchCount		= 60,
+		kDefaultLoadbenchCount		= 5,
+		kDefaultSavebenchCount		= 8,
+		kDefaultAtombenchCount		= 1000,
+		kDefaultHashbenchCount		= 16,
+		kDefaultStreambenchCount	= 256
+	};
+
+
+	enum
+	{
+		kFramePhaseEvents,
+		kFramePhaseReceive,
+		kFramePhaseInterface,
+		kFramePhaseApplication,
+		kFramePhaseMove,
+		kFramePhaseSend,
+		kFramePhaseSound,
+		kFramePhaseRender,
+		kFramePhaseCount
 	};
 
 
@@ -76,6 +106,7 @@ namespace C4
 	class ApplicationModule;
 	class DomainNameResolver;
 	class DeferredTask;
+	class PhysicsRecorder;
 
 
 	//# \class	Reporter	Handles messages passed to the system report chain.
@@ -312,6 +343,13 @@ namespace C4
 	//
 	//# \table	EngineFlags
 	//
+	//# \special
+	//# The $kEngineHeadless$ flag is set when the $headless$ variable has a nonzero value after the command line has been
+	//# executed, for example by passing <code>$headless = "1"</code> on the command line. In headless mode, no display
+	//# connection or window is created, the Graphics Manager and Sound Manager do not use any hardware, and the main loop
+	//# runs at the fixed rate given by the $tickRate$ variable instead of being driven by rendering. This is intended
+	//# for dedicated multiplayer servers.
+	//
 	//# \also	$@Reporter@$
 	//# \also	$@Engine::Report@$
 
@@ -548,6 +586,25 @@ namespace C4
 
 			#endif
 
+			unsigned_int32					headlessTickInterval;
+			unsigned_int64					headlessTickTime;
+
+			#if C4STATS
+
+				int32						frameTimingCount;
+				int32						frameTimingTotal;
+				unsigned_int64				framePhaseTime;
+				unsigned_int64				frameBeginTime;
+				unsigned_int64				frameTimeTotal;
+				unsigned_int32				frameTimeMax;
+				unsigned_int64				framePhaseTotal[kFramePhaseCount];
+				unsigned_int32				framePhaseMax[kFramePhaseCount];
+
+				PhysicsRecorder				*physicsRecorder;
+				ResourceName				physicsRecordingName;
+
+			#endif
+
 			const char						*applicationName;
 			ApplicationModule				*applicationModule;
 
@@ -656,6 +713,24 @@ namespace C4
 			#if C4STATS
 
 				CommandObserver<Engine>		statCommandObserver;
+				CommandObserver<Engine>		physbenchCommandObserver;
+				CommandObserver<Engine>		ftimeCommandObserver;
+				CommandObserver<Engine>		navbenchCommandObserver;
+				CommandObserver<Engine>		physrecCommandObserver;
+				CommandObserver<Engine>		physplayCommandObserver;
+				CommandObserver<Engine>		blockbenchCommandObserver;
+				CommandObserver<Engine>		moviebenchCommandObserver;
+				CommandObserver<Engine>		loadbenchCommandObserver;
+				CommandObserver<Engine>		savebenchCommandObserver;
+				CommandObserver<Engine>		atombenchCommandObserver;
+				CommandObserver<Engine>		hashbenchCommandObserver;
+				CommandObserver<Engine>		streambenchCommandObserver;
+
+			#endif
+
+			#if C4PROFILE
+
+				CommandObserver<Engine>		profCommandObserver;
 
 			#endif
 
@@ -692,6 +767,32 @@ namespace C4
 			EngineResult ConstructManagers(const char *commandLine);
 			void DestroyManagers(void);
 
+			void InitializeHeadlessMode(void);
+			void WaitHeadlessTick(void);
+
+			#if C4STATS
+
+				void BeginFrameTiming(void);
+				void RecordFramePhase(int32 phase);
+				void EndFrameTiming(void);
+				void ReportFrameTiming(void);
+
+			#else
+
+				void BeginFrameTiming(void)
+				{
+				}
+
+				void RecordFramePhase(int32 phase)
+				{
+				}
+
+				void EndFrameTiming(void)
+				{
+				}
+
+			#endif
+
 			#if C4LOG_FILE
 
 				void BeginLog(void);
@@ -940,6 +1041,24 @@ namespace C4
 			#if C4STATS
 
 				void HandleStatCommand(Command *command, const char *text);
+				void HandlePhysbenchCommand(Command *command, const char *text);
+				void HandleFtimeCommand(Command *command, const char *text);
+				void HandleNavbenchCommand(Command *command, const char *text);
+				void HandlePhysrecCommand(Command *command, const char *text);
+				void HandlePhysplayCommand(Command *command, const char *text);
+				void HandleBlockbenchCommand(Command *command, const char *text);
+				void HandleMoviebenchCommand(Command *command, const char *text);
+				void HandleLoadbenchCommand(Command *command, const char *text);
+				void HandleSavebenchCommand(Command *command, const char *text);
+				void HandleAtombenchCommand(Command *command, const char *text);
+				void HandleHashbenchCommand(Command *command, const char *text);
+				void HandleStreambenchCommand(Command *command, const char *text);
+
+			#endif
+
+			#if C4PROFILE
+
+				void HandleProfCommand(Command *command, const char *text);
 
 			#endif
 
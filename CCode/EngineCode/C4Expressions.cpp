@@ -234,16 +234,19 @@ ValueEvaluator::ValueEvaluator(EvaluatorType type) : Evaluator(type)
 ValueEvaluator::ValueEvaluator(const char *name) : Evaluator(kEvaluatorValue)
 {
 	valueName = name;
+	valueAtom = TextAtom(valueName);
 }
 
 ValueEvaluator::ValueEvaluator(EvaluatorType type, const char *name) : Evaluator(type)
 {
 	valueName = name;
+	valueAtom = TextAtom(valueName);
 }
 
 ValueEvaluator::ValueEvaluator(const ValueEvaluator& valueEvaluator) : Evaluator(valueEvaluator)
 {
 	valueName = valueEvaluator.valueName;
+	valueAtom = valueEvaluator.valueAtom;
 }
 
 ValueEvaluator::~ValueEvaluator()
@@ -267,11 +270,12 @@ void ValueEvaluator::Unpack(Unpacker& data, unsigned_int32 unpackFlags)
 	Evaluator::Unpack(data, unpackFlags);
 
 	data >> valueName;
+	valueAtom = TextAtom(valueName);
 }
 
 const Value *ValueEvaluator::Evaluate(const ScriptState *state)
 {
-	return (state->GetValue(valueName));
+	return (state->GetValue(valueAtom));
 }
 
 
@@ -2981,7 +2985,7 @@ void ExpressionMethod::Execute(const ScriptState *state)
 		{
 			SetMethodResult(value->GetBooleanValue());
 
-			Value *output = state->GetValue(GetOutputValueName());
+			Value *output = state->GetValue(GetOutputValueAtom());
 			if (output)
 			{
 				output->SetValue(value);
@@ -236,6 +236,7 @@ namespace C4
 		private:
 
 			ValueName	valueName;
+			TextAtom	valueAtom;
 
 			ValueEvaluator();
 
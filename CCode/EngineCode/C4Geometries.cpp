@@ -731,6 +731,8 @@ void Geometry::ReleaseSegmentStorage(void)
 
 void Geometry::SetMaterialCount(int32 count)
 {
+	InvalidateDeltaPack();
+
 	if (count <= 1)
 	{
 		ReleaseSegmentStorage();
@@ -781,6 +783,10 @@ void Geometry::SetMaterialObject(unsigned_int32 index, MaterialObject *object)
 	MaterialObject *prevObject = *pointer;
 	if (prevObject != object)
 	{
+		// The packed data for the node holds the index of the material object.
+
+		InvalidateDeltaPack();
+
 		if (prevObject)
 		{
 			prevObject->Release();
@@ -565,6 +565,14 @@ void *GeometryObject::BeginSettingsUnpack(void)
 	return (nullptr);
 }
 
+bool GeometryObject::ConcurrentUnpackable(void) const
+{
+	// The mesh data, collision octree, and convex hull make up most of a world resource,
+	// and unpacking them only copies data into memory owned by the geometry object.
+
+	return (true);
+}
+
 int32 GeometryObject::GetCategoryCount(void) const
 {
 	return (2);
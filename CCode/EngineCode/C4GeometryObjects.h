@@ -608,6 +608,8 @@ namespace C4
 			bool UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigned_int32 unpackFlags);
 			void *BeginSettingsUnpack(void) override;
 
+			bool ConcurrentUnpackable(void) const override;
+
 			int32 GetCategoryCount(void) const override;
 			Type GetCategoryType(int32 index, const char **title) const override;
 			int32 GetCategorySettingCount(Type category) const override;
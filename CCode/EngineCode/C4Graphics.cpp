@@ -1,6 +1,7 @@
  
 
 #include "C4Graphics.h"
+#include "C4ShaderCache.h"
 #include "C4World.h"
 #include "C4Movies.h"
 
@@ -449,6 +450,7 @@ GraphicsMgr::GraphicsMgr(int) :
 		textureDetailLevelObserver(this, &GraphicsMgr::HandleTextureDetailLevelEvent),
 		paletteDetailLevelObserver(this, &GraphicsMgr::HandlePaletteDetailLevelEvent),
 		textureAnisotropyObserver(this, &GraphicsMgr::HandleTextureAnisotropyEvent),
+		textureStreamingBudgetObserver(this, &GraphicsMgr::HandleTextureStreamingBudgetEvent),
 		renderParallaxMappingObserver(this, &GraphicsMgr::HandleRenderParallaxMappingEvent),
 		renderHorizonMappingObserver(this, &GraphicsMgr::HandleRenderHorizonMappingEvent),
 		renderTerrainBumpsObserver(this, &GraphicsMgr::HandleRenderTerrainBumpsEvent),
@@ -458,7 +460,8 @@ GraphicsMgr::GraphicsMgr(int) :
 		postBrightnessObserver(this, &GraphicsMgr::HandlePostBrightnessEvent),
 		postMotionBlurObserver(this, &GraphicsMgr::HandlePostMotionBlurEvent),
 		postDistortionObserver(this, &GraphicsMgr::HandlePostDistortionEvent),
-		postGlowBloomObserver(this, &GraphicsMgr::HandlePostGlowBloomEvent)
+		postGlowBloomObserver(this, &GraphicsMgr::HandlePostGlowBloomEvent),
+		deferSwapObserver(this, &GraphicsMgr::HandleDeferSwapEvent)
 {
 	cameraObject = nullptr;
 	cameraTransformable = nullptr;
@@ -478,6 +481,24 @@ EngineResult GraphicsMgr::Construct(void)
 	new(capabilities) GraphicsCapabilities;
 	new(syncRenderSignal) Signal;
 
+	syncRenderObject = nullptr;
+	syncLoadFlag = false;
+
+	deferSwapFlag = false;
+	presentPendingFlag = false;
+
+	nullDeviceFlag = ((TheEngine->GetEngineFlags() & kEngineHeadless) != 0);
+	if (nullDeviceFlag)
+	{
+		// A headless Graphics Manager never creates a rendering context. Requests to create or
+		// update GPU resources made through SyncRenderTask() are discarded, and nothing is rendered.
+		// The capabilities are all zero, and the shader cache is never initialized, so shader
+		// permutations must not be generated.
+
+		MemoryMgr::ClearMemory(capabilities, sizeof(GraphicsCapabilities));
+		return (kEngineOkay);
+	}
+
 	int32 fullFrameWidth = TheDisplayMgr->GetFullFrameWidth();
 	int32 fullFrameHeight = TheDisplayMgr->GetFullFrameHeight();
 	int32 displayWidth = TheDisplayMgr->GetDisplayWidth();
@@ -512,13 +533,11 @@ EngineResult GraphicsMgr::Construct(void)
 	#endif
 
 	ShaderProgram::Initialize();
+	ShaderCache::Initialize();
 	MicrofacetAttribute::Initialize();
 
 	targetDisableMask = 0;
 
-	syncRenderObject = nullptr;
-	syncLoadFlag = false;
-
 	fogSpaceObject = nullptr;
 	fogSpaceTransformable = nullptr;
 	lightObject = nullptr;
@@ -586,6 +605,14 @@ EngineResult GraphicsMgr::Construct(void)
 
 	InitializeVariables();
 
+	if (ShaderCache::Enabled())
+	{
+		ResourcePath	path;
+
+		ShaderCache::GetDefaultCachePath(&path);
+		ShaderCache::Load(path);
+	}
+
 	infiniteShadowMapSize = Min(kInfiniteShadowMapSize, capabilities->maxTextureSize);
 	pointShadowMapSize = Min(kPointShadowMapSize, capabilities->maxCubeTextureSize);
 	spotShadowMapSize = Min(kSpotShadowMapSize, capabilities->maxTextureSize);
@@ -702,6 +729,13 @@ EngineResult GraphicsMgr::Construct(void)
 
 void GraphicsMgr::Destruct(void)
 {
+	if (nullDeviceFlag)
+	{
+		syncRenderSignal->~Signal();
+		capabilities->~GraphicsCapabilities();
+		return;
+	}
+
 	if (TheMovieMgr)
 	{
 		TheMovieMgr->StopRecording();
@@ -748,8 +782,20 @@ void GraphicsMgr::Destruct(void)
 	}
 
 	MicrofacetAttribute::Terminate();
+
+	if ((ShaderCache::Enabled()) && (ShaderCache::Modified()))
+	{
+		ResourcePath	path;
+
+		ShaderCache::GetDefaultCachePath(&path);
+		ShaderCache::Save(path);
+	}
+
+	ShaderCache::Terminate();
 	ShaderProgram::Terminate();
 
+	Texture::SetTextureStreamingBudget(0);
+
 	segmentArray[1].Purge();
 	segmentArray[0].Purge();
 
@@ -1658,6 +1704,8 @@ void GraphicsMgr::InitializeVariables(void)
 	textureFilterAnisotropy = anisotropy->GetIntegerValue();
 	anisotropy->AddObserver(&textureAnisotropyObserver);
 
+	TheEngine->InitVariable("textureStreamingBudget", "0", kVariablePermanent, &textureStreamingBudgetObserver);
+
 	Variable *structure = TheEngine->InitVariable("renderStructureEffects", (disableFlags & kRenderOptionStructureEffects) ? "0" : "1", kVariablePermanent);
 	structure->AddObserver(&renderStructureEffectsObserver);
 	if (structure->GetIntegerValue() != 0)
@@ -1703,6 +1751,11 @@ void GraphicsMgr::InitializeVariables(void)
 	}
 
 	renderOptionFlags = flags;
+
+	Variable *shaderCache = TheEngine->InitVariable("shaderCache", "1", kVariablePermanent);
+	ShaderCache::SetEnabled(shaderCache->GetIntegerValue() != 0);
+
+	TheEngine->InitVariable("deferSwap", "0", kVariablePermanent, &deferSwapObserver);
 }
 
 void GraphicsMgr::HandleTextureDetailLevelEvent(Variable *variable)
@@ -1741,6 +1794,21 @@ void GraphicsMgr::HandleTextureAnisotropyEvent(Variable *variable)
 	}
 }
 
+void GraphicsMgr::HandleTextureStreamingBudgetEvent(Variable *variable)
+{
+	// The budget is specified in megabytes. Textures are reloaded only when streaming is
+	// turned on or off because a change in the budget is applied gradually by the streamer.
+
+	unsigned_int32 budget = MaxZero(Min(variable->GetIntegerValue(), 4095)) << 20;
+	if ((budget != 0) != (Texture::GetTextureStreamer() != nullptr))
+	{
+		currentGraphicsState |= kGraphicsReactivateTextures;
+		Texture::DeactivateAll();
+	}
+
+	Texture::SetTextureStreamingBudget(budget);
+}
+
 void GraphicsMgr::HandleRenderParallaxMappingEvent(Variable *variable)
 {
 	unsigned_int32 flags = renderOptionFlags;
@@ -2002,8 +2070,52 @@ void GraphicsMgr::ResetShaders(void)
 	ShaderProgram::Purge();
 }
 
+void GraphicsMgr::HandleDeferSwapEvent(Variable *variable)
+{
+	bool defer = (variable->GetIntegerValue() != 0);
+	if ((!defer) && (presentPendingFlag))
+	{
+		presentPendingFlag = false;
+		PresentFrame();
+	}
+
+	deferSwapFlag = defer;
+}
+
+void GraphicsMgr::PresentFrame(void)
+{
+	#if C4WINDOWS
+
+		SwapBuffers(deviceContext);
+
+	#elif C4MACOS
+
+		[openglContext flushBuffer];
+
+	#elif C4LINUX
+
+		glXSwapBuffers(openglDisplay, openglWindow);
+
+	#elif C4IOS //[ MOBILE
+
+		// -- Mobile code hidden --
+
+	#endif //]
+}
+
 void GraphicsMgr::BeginRendering(void)
 {
+	// When swap deferral is enabled, the buffer swap for the previous frame is delayed until this
+	// point instead of happening at the end of rendering. This only moves the point at which the
+	// main thread can block on the swap. Frames are not pipelined, and all rendering still happens
+	// on the main thread after the simulation for the frame has finished.
+
+	if (presentPendingFlag)
+	{
+		presentPendingFlag = false;
+		PresentFrame();
+	}
+
 	Render::BeginRendering();
 
 	#if C4PS4 //[ PS4
@@ -2026,6 +2138,8 @@ void GraphicsMgr::BeginRendering(void)
 		Texture::ReactivateAll();
 	}
 
+	Texture::UpdateStreaming();
+
 	timestampCount[Render::GetFrameCount() & 3] = 0;
 
 	if (graphicsActiveFlags & kGraphicsActiveTimer)
@@ -2053,9 +2167,7 @@ void GraphicsMgr::BeginRendering(void)
 	{
 		if (!syncLoadFlag)
 		{
-			syncRenderObject = nullptr;
-			(object->*syncRenderFunction)(syncRenderData);
-			syncRenderSignal->Trigger();
+			ServiceSyncRenderTask();
 		}
 		else
 		{
@@ -2089,23 +2201,20 @@ void GraphicsMgr::EndRendering(void)
 		Timestamp(kTimestampEndRendering);
 	}
 
-	#if C4WINDOWS
-
-		SwapBuffers(deviceContext);
-
-	#elif C4MACOS
-
-		[openglContext flushBuffer];
-
-	#elif C4LINUX
-
-		glXSwapBuffers(openglDisplay, openglWindow);
+	if (!deferSwapFlag)
+	{
+		PresentFrame();
+	}
+	else
+	{
+		#if C4OPENGL
 
-	#elif C4IOS //[ MOBILE
+			glFlush();
 
-		// -- Mobile code hidden --
+		#endif
 
-	#endif //]
+		presentPendingFlag = true;
+	}
 
 	Render::EndRendering();
 
@@ -2129,15 +2238,34 @@ void GraphicsMgr::SetSyncLoadFlag(bool flag)
 	SyncRenderTask(&GraphicsMgr::SetDisplaySyncMode, this, &displayFlags);
 }
 
+void GraphicsMgr::ServiceSyncRenderTask(void)
+{
+	// This runs a task that another thread is waiting on without rendering a frame. It is
+	// called by code on the main thread that needs to wait for such a thread to finish.
+
+	NullClass *object = syncRenderObject;
+	if (object)
+	{
+		syncRenderObject = nullptr;
+		(object->*syncRenderFunction)(syncRenderData);
+		syncRenderSignal->Trigger();
+	}
+}
+
 void GraphicsMgr::SyncRenderTask(void (NullClass::*proc)(const void *), NullClass *object, const void *data)
 {
+	GraphicsMgr *graphicsMgr = TheGraphicsMgr;
+	if (graphicsMgr->nullDeviceFlag)
+	{
+		return;
+	}
+
 	if (Thread::MainThread())
 	{
 		(object->*proc)(data);
 	}
 	else
 	{
-		GraphicsMgr *graphicsMgr = TheGraphicsMgr;
 		graphicsMgr->syncRenderFunction = proc;
 		graphicsMgr->syncRenderData = data;
 
@@ -4080,6 +4208,16 @@ template <class container> void GraphicsMgr::DrawContainer(const container *rend
 
 		Render::BindTextureArray(&shaderData->textureArray);
 
+		int32 streamedTextureCount = shaderData->streamedTextureCount;
+		if (streamedTextureCount != 0)
+		{
+			float size = renderable->GetTextureDetailSize();
+			for (machine a = 0; a < streamedTextureCount; a++)
+			{
+				shaderData->streamedTexture[a]->RequestStreamingSize(size);
+			}
+		}
+
 		int32 vertexCount = renderable->GetVertexCount();
 
 		#if C4STATS
@@ -586,6 +586,10 @@ namespace C4
 
 			Storage<GraphicsCapabilities>		capabilities;
 
+			bool								nullDeviceFlag;
+			bool								deferSwapFlag;
+			bool								presentPendingFlag;
+
 			unsigned_int32						targetDisableMask;
 
 			Storage<Signal>						syncRenderSignal;
@@ -712,6 +716,7 @@ namespace C4
 			VariableObserver<GraphicsMgr>		textureDetailLevelObserver;
 			VariableObserver<GraphicsMgr>		paletteDetailLevelObserver;
 			VariableObserver<GraphicsMgr>		textureAnisotropyObserver;
+			VariableObserver<GraphicsMgr>		textureStreamingBudgetObserver;
 			VariableObserver<GraphicsMgr>		renderParallaxMappingObserver;
 			VariableObserver<GraphicsMgr>		renderHorizonMappingObserver;
 			VariableObserver<GraphicsMgr>		renderTerrainBumpsObserver;
@@ -722,6 +727,7 @@ namespace C4
 			VariableObserver<GraphicsMgr>		postMotionBlurObserver;
 			VariableObserver<GraphicsMgr>		postDistortionObserver;
 			VariableObserver<GraphicsMgr>		postGlowBloomObserver;
+			VariableObserver<GraphicsMgr>		deferSwapObserver;
 
 			static GraphicsExtensionData		extensionData[kGraphicsExtensionCount];
 
@@ -767,6 +773,7 @@ namespace C4
 			void HandleTextureDetailLevelEvent(Variable *variable);
 			void HandlePaletteDetailLevelEvent(Variable *variable);
 			void HandleTextureAnisotropyEvent(Variable *variable);
+			void HandleTextureStreamingBudgetEvent(Variable *variable);
 			void HandleRenderParallaxMappingEvent(Variable *variable);
 			void HandleRenderHorizonMappingEvent(Variable *variable);
 			void HandleRenderTerrainBumpsEvent(Variable *variable);
@@ -777,6 +784,9 @@ namespace C4
 			void HandlePostMotionBlurEvent(Variable *variable);
 			void HandlePostDistortionEvent(Variable *variable);
 			void HandlePostGlowBloomEvent(Variable *variable);
+			void HandleDeferSwapEvent(Variable *variable);
+
+			void PresentFrame(void);
 
 			void InitializeProcessGrid(void);
 			void InitializeActiveFlags(void);
@@ -832,6 +842,11 @@ namespace C4
 				return (capabilities);
 			}
 
+			bool NullDevice(void) const
+			{
+				return (nullDeviceFlag);
+			}
+
 			static const GraphicsExtensionData *GetExtensionData(void)
 			{
 				return (extensionData);
@@ -1161,6 +1176,7 @@ namespace C4
 			}
 
 			void SetSyncLoadFlag(bool flag);
+			void ServiceSyncRenderTask(void);
 
 			C4API static void SetShaderTime(float time, float delta);
 			C4API static void SetImpostorDepthParams(float scale, float offset, float tangent);
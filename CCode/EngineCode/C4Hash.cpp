@@ -199,4 +199,171 @@ void HashTableBase::ResizeBucketTable(void)
 	resizeLimit *= 2;
 }
 
+
+FlatHashTableElementBase::~FlatHashTableElementBase()
+{
+	if (owningFlatHashTable)
+	{
+		owningFlatHashTable->RemoveSlot(flatHashSlot);
+	}
+}
+
+
+FlatHashTableBase::FlatHashTableBase(int32 initialSlotCount)
+{
+	elementCount = 0;
+	AllocateSlotTable(Power2Ceil(Max(initialSlotCount, (int32) kFlatHashGroupSize)) / kFlatHashGroupSize);
+}
+
+FlatHashTableBase::~FlatHashTableBase()
+{
+	Purge();
+
+	delete[] slotTable;
+	delete[] controlTable;
+}
+
+void FlatHashTableBase::AllocateSlotTable(int32 count)
+{
+	int32 slotCount = count * kFlatHashGroupSize;
+
+	groupCount = count;
+	usedSlotCount = 0;
+
+	controlTable = new int8[slotCount];
+	slotTable = new FlatHashTableElementBase *[slotCount];
+
+	for (machine a = 0; a < slotCount; a++)
+	{
+		controlTable[a] = kFlatHashEmpty;
+		slotTable[a] = nullptr;
+	}
+}
+
+void FlatHashTableBase::ResizeSlotTable(int32 count)
+{
+	int32 slotCount = GetSlotCount();
+	FlatHashTableElementBase **oldSlotTable = slotTable;
+	int8 *oldControlTable = controlTable;
+
+	AllocateSlotTable(count);
+
+	for (machine a = 0; a < slotCount; a++)
+	{
+		FlatHashTableElementBase *element = oldSlotTable[a];
+		if (element)
+		{
+			PlaceElement(element);
+		}
+	}
+
+	delete[] oldSlotTable;
+	delete[] oldControlTable;
+}
+
+void FlatHashTableBase::PlaceElement(FlatHashTableElementBase *element)
+{
+	unsigned_int32 hash = MixHash(element->flatHashValue);
+
+	unsigned_int32 groupMask = groupCount - 1;
+	unsigned_int32 group = (hash >> 7) & groupMask;
+
+	for (unsigned_int32 step = 1;; step++)
+	{
+		machine base = group * kFlatHashGroupSize;
+		unsigned_int32 mask = GetAvailableMask(&controlTable[base]);
+		if (mask != 0)
+		{
+			int32 slot = (int32) base + GetFirstMaskBit(mask);
+			usedSlotCount += (controlTable[slot] == kFlatHashEmpty);
+
+			controlTable[slot] = (int8) (hash & 0x7F);
+			slotTable[slot] = element;
+
+			element->owningFlatHashTable = this;
+			element->flatHashSlot = slot;
+			return;
+		}
+
+		group = (group + step) & groupMask;
+	}
+}
+
+void FlatHashTableBase::RemoveSlot(int32 slot)
+{
+	FlatHashTableElementBase *element = slotTable[slot];
+	element->owningFlatHashTable = nullptr;
+	slotTable[slot] = nullptr;
+	elementCount--;
+
+	// A search stops at the first group containing an empty slot, so if this group already has
+	// one, no search can have passed through it, and the slot can be made empty instead of deleted.
+
+	if (GetEmptyMask(&controlTable[slot & ~(kFlatHashGroupSize - 1)]) != 0)
+	{
+		controlTable[slot] = kFlatHashEmpty;
+		usedSlotCount--;
+	}
+	else
+	{
+		controlTable[slot] = kFlatHashDeleted;
+	}
+}
+
+void FlatHashTableBase::InsertElement(FlatHashTableElementBase *element, unsigned_int32 hash)
+{
+	FlatHashTableBase *table = element->owningFlatHashTable;
+	if (table)
+	{
+		table->RemoveSlot(element->flatHashSlot);
+	}
+
+	int32 slotCount = GetSlotCount();
+	if (usedSlotCount >= slotCount - slotCount / 8)
+	{
+		// Deleted slots are reclaimed by rebuilding the table at the same size unless
+		// more than half of the slots hold elements.
+
+		ResizeSlotTable((elementCount * 2 >= slotCount) ? groupCount * 2 : groupCount);
+	}
+
+	element->flatHashValue = hash;
+	PlaceElement(element);
+	elementCount++;
+}
+
+void FlatHashTableBase::RemoveAll(void)
+{
+	int32 slotCount = GetSlotCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		FlatHashTableElementBase *element = slotTable[a];
+		if (element)
+		{
+			element->owningFlatHashTable = nullptr;
+			slotTable[a] = nullptr;
+		}
+
+		controlTable[a] = kFlatHashEmpty;
+	}
+
+	elementCount = 0;
+	usedSlotCount = 0;
+}
+
+void FlatHashTableBase::Purge(void)
+{
+	int32 slotCount = GetSlotCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		FlatHashTableElementBase *element = slotTable[a];
+		if (element)
+		{
+			delete element;
+		}
+	}
+
+	RemoveAll();
+}
+
 // ZYUQURM
@@ -420,6 +420,325 @@ namespace C4
 
 		return (nullptr);
 	}
+
+
+	enum
+	{
+		kFlatHashGroupSize		= 16
+	};
+
+
+	class FlatHashTableBase;
+
+
+	class FlatHashTableElementBase
+	{
+		friend class FlatHashTableBase;
+		template <class type> friend class FlatHashTable;
+
+		private:
+
+			FlatHashTableBase		*owningFlatHashTable;
+			int32					flatHashSlot;
+			unsigned_int32			flatHashValue;
+
+			FlatHashTableElementBase(const FlatHashTableElementBase&) = delete;
+			FlatHashTableElementBase& operator =(const FlatHashTableElementBase&) = delete;
+
+		protected:
+
+			FlatHashTableElementBase()
+			{
+				owningFlatHashTable = nullptr;
+			}
+
+			C4API virtual ~FlatHashTableElementBase();
+
+		public:
+
+			FlatHashTableBase *GetOwningFlatHashTable(void) const
+			{
+				return (owningFlatHashTable);
+			}
+	};
+
+
+	class FlatHashTableBase
+	{
+		friend class FlatHashTableElementBase;
+		template <class type> friend class FlatHashTable;
+
+		private:
+
+			enum
+			{
+				kFlatHashEmpty		= -128,
+				kFlatHashDeleted	= -2
+			};
+
+			int32						elementCount;
+			int32						usedSlotCount;
+			int32						groupCount;
+
+			int8						*controlTable;
+			FlatHashTableElementBase	**slotTable;
+
+			FlatHashTableBase(const FlatHashTableBase&) = delete;
+			FlatHashTableBase& operator =(const FlatHashTableBase&) = delete;
+
+			static unsigned_int32 MixHash(unsigned_int32 hash)
+			{
+				// The low seven bits of the mixed value are stored in the control byte, and the
+				// remaining bits select a group, so both must depend on every bit of the hash.
+
+				hash *= 0x9E3779B1;
+				return (hash ^ (hash >> 15));
+			}
+
+			static int32 GetFirstMaskBit(unsigned_int32 mask)
+			{
+				return (31 - Cntlz(mask & (0 - mask)));
+			}
+
+			static unsigned_int32 GetMatchMask(const int8 *control, int32 value)
+			{
+				#if C4SSE
+
+					return (VecInt8GetSignMask(VecInt8MaskCmpeq(VecInt8LoadUnaligned(control), VecInt8SmearScalar(value))));
+
+				#else
+
+					unsigned_int32 mask = 0;
+					for (machine a = 0; a < kFlatHashGroupSize; a++)
+					{
+						mask |= (unsigned_int32) (control[a] == value) << a;
+					}
+
+					return (mask);
+
+				#endif
+			}
+
+			static unsigned_int32 GetAvailableMask(const int8 *control)
+			{
+				#if C4SSE
+
+					return (VecInt8GetSignMask(VecInt8LoadUnaligned(control)));
+
+				#else
+
+					unsigned_int32 mask = 0;
+					for (machine a = 0; a < kFlatHashGroupSize; a++)
+					{
+						mask |= (unsigned_int32) (control[a] < 0) << a;
+					}
+
+					return (mask);
+
+				#endif
+			}
+
+			static unsigned_int32 GetEmptyMask(const int8 *control)
+			{
+				return (GetMatchMask(control, kFlatHashEmpty));
+			}
+
+			void AllocateSlotTable(int32 count);
+			void ResizeSlotTable(int32 count);
+			void PlaceElement(FlatHashTableElementBase *element);
+			void RemoveSlot(int32 slot);
+
+		protected:
+
+			C4API FlatHashTableBase(int32 initialSlotCount);
+			C4API virtual ~FlatHashTableBase();
+
+			C4API void InsertElement(FlatHashTableElementBase *element, unsigned_int32 hash);
+
+		public:
+
+			int32 GetElementCount(void) const
+			{
+				return (elementCount);
+			}
+
+			int32 GetSlotCount(void) const
+			{
+				return (groupCount * kFlatHashGroupSize);
+			}
+
+			C4API void RemoveAll(void);
+			C4API void Purge(void);
+	};
+
+
+	//# \class	FlatHashTableElement	The base class for objects that can be stored in a flat hash table.
+	//
+	//# Objects inherit from the $FlatHashTableElement$ class so that they can be stored in a flat hash table.
+	//
+	//# \def	template <class type> class FlatHashTableElement : public FlatHashTableElementBase
+	//
+	//# \tparam		type	The type of the class that can be stored in a flat hash table. This parameter should be the
+	//#						type of the class that inherits directly from the $FlatHashTableElement$ class.
+	//
+	//# \ctor	FlatHashTableElement();
+	//
+	//# The constructor has protected access takes no parameters. The $FlatHashTableElement$ class can only exist
+	//# as a base class for another class.
+	//
+	//# \desc
+	//# The $FlatHashTableElement$ class should be declared as a base class for objects that need to be stored in a
+	//# $@FlatHashTable@$ container declared with the same $type$ template parameter. An element only records the table
+	//# and slot that it occupies, so it does not link to other elements. When an element is destroyed, it is
+	//# automatically removed from the table to which it belongs.
+	//
+	//# \privbase	FlatHashTableElementBase	Used internally to encapsulate common functionality that is independent
+	//#											of the template parameter.
+	//
+	//# \also	$@FlatHashTable@$
+
+
+	template <class type> class FlatHashTableElement : public FlatHashTableElementBase
+	{
+		protected:
+
+			FlatHashTableElement() = default;
+	};
+
+
+	//# \class	FlatHashTable	A container class that organizes objects in an open-addressing hash table.
+	//
+	//# The $FlatHashTable$ class encapsulates a dynamically resizable open-addressing hash table.
+	//
+	//# \def	template <class type> class FlatHashTable : public FlatHashTableBase
+	//
+	//# \tparam		type	The type of the class that can be stored in the hash table. The class specified
+	//#						by this parameter should inherit directly from the $@FlatHashTableElement@$ class
+	//#						using the same template parameter.
+	//
+	//# \ctor	FlatHashTable(int32 initialSlotCount = kFlatHashGroupSize);
+	//
+	//# \param	initialSlotCount	The number of slots initially allocated by the hash table. This is rounded up to a power of two
+	//#								that is at least $kFlatHashGroupSize$.
+	//
+	//# \desc
+	//# The $FlatHashTable$ class template is a container used to organize a homogeneous set of objects, and it has the
+	//# same interface and element requirements as the $@HashTable@$ class template. Instead of keeping a linked list in
+	//# each bucket, it stores pointers to its elements in a single array of slots alongside an array of one-byte control
+	//# values. Each control value holds seven bits of an element's hash, and a search compares 16 control values at once
+	//# before it reads any element, so most lookups touch one cache line of control values and one element.
+	//#
+	//# A particular object can be a member of only one flat hash table at a time. Removing an element leaves its slot
+	//# marked as deleted, so other elements never move until the table is resized. When the slots in use, including deleted
+	//# slots, exceed seven eighths of the table, the table is rebuilt, and it doubles in size if more than half of its slots
+	//# hold elements. Elements are rehashed using a hash value that is stored when they are inserted, so the $Hash$
+	//# function is not called again during a resize.
+	//#
+	//# When a $FlatHashTable$ object is destroyed, all of the members of the hash table are also destroyed. To avoid deleting
+	//# the members of a hash table when a $FlatHashTable$ object is destroyed, first call the $@FlatHashTable::RemoveAll@$ function
+	//# to remove all of the hash table's members.
+	//#
+	//# The class specified by the $type$ template parameter must define a type named $KeyType$, a function named $GetKey$,
+	//# and a static function named $Hash$ as described for the $@HashTable@$ class template.
+	//#
+	//# The elements of a flat hash table can be visited by calling the $@FlatHashTable::GetSlotElement@$ function for each
+	//# slot index from zero up to the number returned by the $@FlatHashTable::GetSlotCount@$ function. Elements may be removed
+	//# or destroyed during such an iteration, but no elements may be inserted.
+	//
+	//# \privbase	FlatHashTableBase	Used internally to encapsulate common functionality that is independent
+	//#									of the template parameter.
+	//
+	//# \also	$@FlatHashTableElement@$
+	//# \also	$@HashTable@$
+
+
+	//# \function	FlatHashTable::GetSlotElement		Returns the element stored in a slot of a flat hash table.
+	//
+	//# \proto	type *GetSlotElement(int32 index) const;
+	//
+	//# \param	index	The index of the slot. This must be less than the value returned by the $@FlatHashTable::GetSlotCount@$ function.
+	//
+	//# \desc
+	//# The $GetSlotElement$ function returns the element stored in the slot specified by the $index$ parameter.
+	//# If the slot is empty, then the return value is $nullptr$.
+	//
+	//# \also	$@FlatHashTable::GetSlotCount@$
+
+
+	template <class type> class FlatHashTable : public FlatHashTableBase
+	{
+		private:
+
+			typedef typename type::KeyType		KeyType;
+
+		public:
+
+			FlatHashTable(int32 initialSlotCount = kFlatHashGroupSize) : FlatHashTableBase(initialSlotCount)
+			{
+			}
+
+			~FlatHashTable()
+			{
+			}
+
+			type *GetSlotElement(int32 index) const
+			{
+				return (static_cast<type *>(static_cast<FlatHashTableElement<type> *>(slotTable[index])));
+			}
+
+			static void Remove(FlatHashTableElement<type> *element)
+			{
+				FlatHashTableBase *table = element->owningFlatHashTable;
+				if (table)
+				{
+					table->RemoveSlot(element->flatHashSlot);
+				}
+			}
+
+			void Insert(type *element)
+			{
+				InsertElement(element, type::Hash(element->GetKey()));
+			}
+
+			type *Find(const KeyType& key) const;
+	};
+
+
+	template <class type> type *FlatHashTable<type>::Find(const KeyType& key) const
+	{
+		unsigned_int32 hash = MixHash(type::Hash(key));
+		int32 value = hash & 0x7F;
+
+		unsigned_int32 groupMask = groupCount - 1;
+		unsigned_int32 group = (hash >> 7) & groupMask;
+
+		for (unsigned_int32 step = 1;; step++)
+		{
+			machine base = group * kFlatHashGroupSize;
+			const int8 *control = &controlTable[base];
+
+			unsigned_int32 mask = GetMatchMask(control, value);
+			while (mask != 0)
+			{
+				type *object = static_cast<type *>(static_cast<FlatHashTableElement<type> *>(slotTable[base + GetFirstMaskBit(mask)]));
+				if (object->GetKey() == key)
+				{
+					return (object);
+				}
+
+				mask &= mask - 1;
+			}
+
+			if (GetEmptyMask(control) != 0)
+			{
+				break;
+			}
+
+			group = (group + step) & groupMask;
+		}
+
+		return (nullptr);
+	}
 }
 
 
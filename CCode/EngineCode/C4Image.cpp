@@ -2,6 +2,7 @@
 
 #include "C4Image.h"
 #include "C4Computation.h"
+#include "C4Threads.h"
 
 
 using namespace C4;
@@ -16,6 +17,44 @@ namespace
 	};
 
 
+	enum
+	{
+		kBlockCompressionTileSize			= 16,
+		kBlockRefinementIterationCount		= 3
+	};
+
+
+	enum
+	{
+		kBlockFormatBC1,
+		kBlockFormatBC3,
+		kBlockFormatNormalBC3
+	};
+
+
+	alignas(16) const float blockIndexValue[8] =
+	{
+		0.0F, 1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F, 7.0F
+	};
+
+
+	const float colorEndpointWeight[2][4] =
+	{
+		{1.0F, 0.0F, 0.6666667F, 0.3333333F},
+		{1.0F, 0.0F, 0.5F, 0.0F}
+	};
+
+
+	inline unsigned_int16 QuantizeColor(const Vector3D& v)
+	{
+		int32 red = MaxZero(Min((int32) (v.x * 31.0F + 0.5F), 31));
+		int32 green = MaxZero(Min((int32) (v.y * 63.0F + 0.5F), 63));
+		int32 blue = MaxZero(Min((int32) (v.z * 31.0F + 0.5F), 31));
+
+		return ((unsigned_int16) ((red << 11) | (green << 5) | blue));
+	}
+
+
 	const unsigned_int8 bleedOffsetData[426] =
 	{
 		0x01, 0x00, 0x00, 0x01, 0x01, 0x01,
@@ -150,6 +189,37 @@ namespace
 }
 
 
+namespace C4
+{
+	class BlockCompressionJob : public BatchJob
+	{
+		public:
+
+			int32				blockFormat;
+			int32				imageWidth;
+			int32				imageHeight;
+			Rect				blockRect;
+			const Color4C		*sourceImage;
+			unsigned_int8		*outputCode;
+			unsigned_int32		compressionFlags;
+
+			BlockCompressionJob(ExecuteProc *execProc, int32 format, int32 width, int32 height, const Rect& rect, const Color4C *source, unsigned_int8 *output, unsigned_int32 flags);
+	};
+}
+
+
+BlockCompressionJob::BlockCompressionJob(ExecuteProc *execProc, int32 format, int32 width, int32 height, const Rect& rect, const Color4C *source, unsigned_int8 *output, unsigned_int32 flags) : BatchJob(execProc, nullptr, kJobNonpersistent)
+{
+	blockFormat = format;
+	imageWidth = width;
+	imageHeight = height;
+	blockRect = rect;
+	sourceImage = source;
+	outputCode = output;
+	compressionFlags = flags;
+}
+
+
 void Image::DecompressImageRLE_RGBA32(const unsigned_int8 *code, unsigned_int32 codeSize, void *restrict output)
 {
 	Color4C *restrict destin = static_cast<Color4C *>(output);
@@ -438,6 +508,32 @@ Vector3D Image::CalculateColorAxis(int32 count, const Point3D *color, const Box3
 	return (axis);
 }
 
+int32 Image::CalculateCandidateColors(const Point3D& color, const Vector3D& axis, unsigned_int16 *restrict cand)
+{
+	int32 count = 0;
+	for (float d = -K::one_over_32; d <= K::one_over_32; d += K::one_over_64)
+	{
+		unsigned_int16 candidate = QuantizeColor(color + axis * d);
+		for (machine a = 0; a < count; a++)
+		{
+			if (cand[a] == candidate)
+			{
+				goto next;
+			}
+		}
+
+		cand[count] = candidate;
+		if (++count == 8)
+		{
+			break;
+		}
+
+		next:;
+	}
+
+	return (count);
+}
+
 void Image::CalculateEndpointCandidates(int32 count, const Point3D *color, int32 *restrict candCount1, int32 *restrict candCount2, unsigned_int16 *restrict cand1, unsigned_int16 *restrict cand2)
 {
 	Box3D		bounds;
@@ -465,66 +561,33 @@ void Image::CalculateEndpointCandidates(int32 count, const Point3D *color, int32
 		}
 	}
 
-	int32 count1 = 0;
-	const Point3D& minColor = color[minIndex];
-
-	for (float d = -K::one_over_32; d <= K::one_over_32; d += K::one_over_64)
-	{
-		Point3D p = minColor + axis * d;
-
-		int32 red = MaxZero(Min((int32) (p.x * 31.0F + 0.5F), 31));
-		int32 green = MaxZero(Min((int32) (p.y * 63.0F + 0.5F), 63));
-		int32 blue = MaxZero(Min((int32) (p.z * 31.0F + 0.5F), 31));
+	*candCount1 = CalculateCandidateColors(color[minIndex], axis, cand1);
+	*candCount2 = CalculateCandidateColors(color[maxIndex], axis, cand2);
+}
 
-		unsigned_int16 candidate = (unsigned_int16) ((red << 11) | (green << 5) | blue);
-		for (machine a = 0; a < count1; a++)
-		{
-			if (cand1[a] == candidate)
-			{
-				goto next1;
-			}
-		}
+void Image::CalculateColorPalette(unsigned_int16 color0, unsigned_int16 color1, bool black, Point3D *restrict palette)
+{
+	palette[0].Set((float) (color0 >> 11) * K::one_over_31, (float) ((color0 >> 5) & 63) * K::one_over_63, (float) (color0 & 31) * K::one_over_31);
+	palette[1].Set((float) (color1 >> 11) * K::one_over_31, (float) ((color1 >> 5) & 63) * K::one_over_63, (float) (color1 & 31) * K::one_over_31);
 
-		cand1[count1] = candidate;
-		if (++count1 == 8)
-		{
-			break;
-		}
+	if (black)
+	{
+		palette[2].x = PositiveFloor((palette[0].x + palette[1].x) * 127.5F) * K::one_over_255;
+		palette[2].y = PositiveFloor((palette[0].y + palette[1].y) * 127.5F) * K::one_over_255;
+		palette[2].z = PositiveFloor((palette[0].z + palette[1].z) * 127.5F) * K::one_over_255;
 
-		next1:;
+		palette[3].Set(0.0F, 0.0F, 0.0F);
 	}
-
-	int32 count2 = 0;
-	const Point3D& maxColor = color[maxIndex];
-
-	for (float d = -K::one_over_32; d <= K::one_over_32; d += K::one_over_64)
+	else
 	{
-		Point3D p = maxColor + axis * d;
-
-		int32 red = MaxZero(Min((int32) (p.x * 31.0F + 0.5F), 31));
-		int32 green = MaxZero(Min((int32) (p.y * 63.0F + 0.5F), 63));
-		int32 blue = MaxZero(Min((int32) (p.z * 31.0F + 0.5F), 31));
+		palette[2].x = PositiveFloor((palette[0].x * 2.0F + palette[1].x) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+		palette[2].y = PositiveFloor((palette[0].y * 2.0F + palette[1].y) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+		palette[2].z = PositiveFloor((palette[0].z * 2.0F + palette[1].z) * (K::one_over_3 * 255.0F)) * K::one_over_255;
 
-		unsigned_int16 candidate = (unsigned_int16) ((red << 11) | (green << 5) | blue);
-		for (machine a = 0; a < count2; a++)
-		{
-			if (cand2[a] == candidate)
-			{
-				goto next2;
-			}
-		}
-
-		cand2[count2] = candidate;
-		if (++count2 == 8)
-		{
-			break;
-		}
-
-		next2:;
+		palette[3].x = PositiveFloor((palette[0].x + palette[1].x * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+		palette[3].y = PositiveFloor((palette[0].y + palette[1].y * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+		palette[3].z = PositiveFloor((palette[0].z + palette[1].z * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
 	}
-
-	*candCount1 = count1;
-	*candCount2 = count2;
 }
 
 float Image::EncodeColorBlock(int32 width, int32 height, unsigned_int16 color0, unsigned_int16 color1, bool black, const Point3D *image, unsigned_int8 *restrict data)
@@ -553,27 +616,7 @@ float Image::EncodeColorBlock(int32 width, int32 height, unsigned_int16 color0,
 	data[3] = (unsigned_int8) (color1 >> 8);
 	data += 4;
 
-	encodeColor[0].Set((float) (color0 >> 11) * K::one_over_31, (float) ((color0 >> 5) & 63) * K::one_over_63, (float) (color0 & 31) * K::one_over_31);
-	encodeColor[1].Set((float) (color1 >> 11) * K::one_over_31, (float) ((color1 >> 5) & 63) * K::one_over_63, (float) (color1 & 31) * K::one_over_31);
-
-	if (black)
-	{
-		encodeColor[2].x = PositiveFloor((encodeColor[0].x + encodeColor[1].x) * 127.5F) * K::one_over_255;
-		encodeColor[2].y = PositiveFloor((encodeColor[0].y + encodeColor[1].y) * 127.5F) * K::one_over_255;
-		encodeColor[2].z = PositiveFloor((encodeColor[0].z + encodeColor[1].z) * 127.5F) * K::one_over_255;
-
-		encodeColor[3].Set(0.0F, 0.0F, 0.0F);
-	}
-	else
-	{
-		encodeColor[2].x = PositiveFloor((encodeColor[0].x * 2.0F + encodeColor[1].x) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-		encodeColor[2].y = PositiveFloor((encodeColor[0].y * 2.0F + encodeColor[1].y) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-		encodeColor[2].z = PositiveFloor((encodeColor[0].z * 2.0F + encodeColor[1].z) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-
-		encodeColor[3].x = PositiveFloor((encodeColor[0].x + encodeColor[1].x * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-		encodeColor[3].y = PositiveFloor((encodeColor[0].y + encodeColor[1].y * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-		encodeColor[3].z = PositiveFloor((encodeColor[0].z + encodeColor[1].z * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
-	}
+	CalculateColorPalette(color0, color1, black, encodeColor);
 
 	for (machine a = 0; a < 4; a++)
 	{
@@ -862,6 +905,31 @@ void Image::CompressGreenBlock(int32 width, int32 height, int32 rowLength, const
 	}
 }
 
+void Image::CalculateGrayPalette(unsigned_int8 gray0, unsigned_int8 gray1, bool black, float *restrict palette)
+{
+	palette[0] = (float) gray0 * K::one_over_255;
+	palette[1] = (float) gray1 * K::one_over_255;
+
+	if (black)
+	{
+		palette[2] = (palette[0] * 4.0F + palette[1]) * 0.2F;
+		palette[3] = (palette[0] * 3.0F + palette[1] * 2.0F) * 0.2F;
+		palette[4] = (palette[0] * 2.0F + palette[1] * 3.0F) * 0.2F;
+		palette[5] = (palette[0] + palette[1] * 4.0F) * 0.2F;
+		palette[6] = 0.0F;
+		palette[7] = 1.0F;
+	}
+	else
+	{
+		palette[2] = (palette[0] * 6.0F + palette[1]) * K::one_over_7;
+		palette[3] = (palette[0] * 5.0F + palette[1] * 2.0F) * K::one_over_7;
+		palette[4] = (palette[0] * 4.0F + palette[1] * 3.0F) * K::one_over_7;
+		palette[5] = (palette[0] * 3.0F + palette[1] * 4.0F) * K::one_over_7;
+		palette[6] = (palette[0] * 2.0F + palette[1] * 5.0F) * K::one_over_7;
+		palette[7] = (palette[0] + palette[1] * 6.0F) * K::one_over_7;
+	}
+}
+
 float Image::EncodeGrayBlock(int32 width, int32 height, unsigned_int8 gray0, unsigned_int8 gray1, bool black, const float *image, unsigned_int8 *restrict data)
 {
 	float			encodeGray[8];
@@ -896,27 +964,7 @@ float Image::EncodeGrayBlock(int32 width, int32 height, unsigned_int8 gray0, uns
 		return (0.0F);
 	}
 
-	encodeGray[0] = (float) gray0 * K::one_over_255;
-	encodeGray[1] = (float) gray1 * K::one_over_255;
-
-	if (black)
-	{
-		encodeGray[2] = (encodeGray[0] * 4.0F + encodeGray[1]) * 0.2F;
-		encodeGray[3] = (encodeGray[0] * 3.0F + encodeGray[1] * 2.0F) * 0.2F;
-		encodeGray[4] = (encodeGray[0] * 2.0F + encodeGray[1] * 3.0F) * 0.2F;
-		encodeGray[5] = (encodeGray[0] + encodeGray[1] * 4.0F) * 0.2F;
-		encodeGray[6] = 0.0F;
-		encodeGray[7] = 1.0F;
-	}
-	else
-	{
-		encodeGray[2] = (encodeGray[0] * 6.0F + encodeGray[1]) * K::one_over_7;
-		encodeGray[3] = (encodeGray[0] * 5.0F + encodeGray[1] * 2.0F) * K::one_over_7;
-		encodeGray[4] = (encodeGray[0] * 4.0F + encodeGray[1] * 3.0F) * K::one_over_7;
-		encodeGray[5] = (encodeGray[0] * 3.0F + encodeGray[1] * 4.0F) * K::one_over_7;
-		encodeGray[6] = (encodeGray[0] * 2.0F + encodeGray[1] * 5.0F) * K::one_over_7;
-		encodeGray[7] = (encodeGray[0] + encodeGray[1] * 6.0F) * K::one_over_7;
-	}
+	CalculateGrayPalette(gray0, gray1, black, encodeGray);
 
 	for (machine a = 0; a < 4; a++)
 	{
@@ -1089,6 +1137,752 @@ void Image::CompressGrayBlock(int32 width, int32 height, int32 rowLength, const
 	}
 }
 
+void Image::DecompressColorBlock(const unsigned_int8 *data, Color4C *restrict image)
+{
+	Point3D		palette[4];
+
+	unsigned_int16 color0 = (unsigned_int16) (data[0] | (data[1] << 8));
+	unsigned_int16 color1 = (unsigned_int16) (data[2] | (data[3] << 8));
+	CalculateColorPalette(color0, color1, (color0 <= color1), palette);
+
+	for (machine k = 0; k < 16; k++)
+	{
+		const Point3D& p = palette[(data[4 + (k >> 2)] >> ((k & 3) * 2)) & 3];
+		image[k].Set((int32) (p.x * 255.0F + 0.5F), (int32) (p.y * 255.0F + 0.5F), (int32) (p.z * 255.0F + 0.5F), 255);
+	}
+}
+
+void Image::PackBlockIndices(int32 bitCount, const unsigned_int8 *index, unsigned_int8 *restrict data)
+{
+	unsigned_int64 code = 0;
+	for (machine k = 0; k < 16; k++)
+	{
+		code |= (unsigned_int64) index[k] << (k * bitCount);
+	}
+
+	for (machine a = 0; a < bitCount * 2; a++)
+	{
+		data[a] = (unsigned_int8) (code >> (a * 8));
+	}
+}
+
+void Image::LoadBlockPixels(int32 width, int32 height, int32 rowLength, const Color4C *image, BlockPixelData *restrict block)
+{
+	// Each pixel is stored in the lane corresponding to its position in the 4x4 block so that
+	// the indices of all sixteen lanes can be packed directly. The lanes outside a partial block
+	// repeat the first pixel and have a weight of zero, so they never contribute to the error.
+
+	for (machine j = 0; j < 4; j++)
+	{
+		for (machine i = 0; i < 4; i++)
+		{
+			bool inside = ((j < height) && (i < width));
+			const Color4C& c = (inside) ? image[j * rowLength + i] : image[0];
+
+			float red = (float) c.GetRed() * K::one_over_255;
+			float green = (float) c.GetGreen() * K::one_over_255;
+			float blue = (float) c.GetBlue() * K::one_over_255;
+
+			machine k = j * 4 + i;
+			block->red[k] = red;
+			block->green[k] = green;
+			block->blue[k] = blue;
+			block->alpha[k] = (float) c.GetAlpha() * K::one_over_255;
+			block->weight[k] = (inside) ? 1.0F : 0.0F;
+			block->alphaValue[k] = (unsigned_int8) c.GetAlpha();
+
+			if (inside)
+			{
+				block->color[j * width + i].Set(red, green, blue);
+			}
+		}
+	}
+
+	block->pixelCount = width * height;
+}
+
+float Image::EvaluateColorBlock(const BlockPixelData *block, unsigned_int16 color0, unsigned_int16 color1, bool black, unsigned_int8 *restrict index)
+{
+	Point3D		palette[4];
+
+	CalculateColorPalette(color0, color1, black, palette);
+
+	#if C4SIMD
+
+		alignas(16) float	result[4];
+		vec_float			paletteRed[4], paletteGreen[4], paletteBlue[4];
+
+		for (machine a = 0; a < 4; a++)
+		{
+			paletteRed[a] = VecLoadSmearScalar(&palette[a].x);
+			paletteGreen[a] = VecLoadSmearScalar(&palette[a].y);
+			paletteBlue[a] = VecLoadSmearScalar(&palette[a].z);
+		}
+
+		vec_float total = VecFloatGetZero();
+		vec_float worst = total;
+
+		// Four pixels are evaluated at once, and the index of the closest palette entry
+		// is tracked as a float in each lane so that it can be selected with a mask.
+
+		for (machine k = 0; k < 16; k += 4)
+		{
+			vec_float red = VecLoad(block->red, k);
+			vec_float green = VecLoad(block->green, k);
+			vec_float blue = VecLoad(block->blue, k);
+
+			vec_float dr = VecSub(red, paletteRed[0]);
+			vec_float dg = VecSub(green, paletteGreen[0]);
+			vec_float db = VecSub(blue, paletteBlue[0]);
+			vec_float best = VecMadd(dr, dr, VecMadd(dg, dg, VecMul(db, db)));
+			vec_float select = VecFloatGetZero();
+
+			for (machine a = 1; a < 4; a++)
+			{
+				dr = VecSub(red, paletteRed[a]);
+				dg = VecSub(green, paletteGreen[a]);
+				db = VecSub(blue, paletteBlue[a]);
+				vec_float error = VecMadd(dr, dr, VecMadd(dg, dg, VecMul(db, db)));
+
+				select = VecSelect(select, VecLoadSmearScalar(blockIndexValue, a), VecMaskCmplt(error, best));
+				best = VecMin(error, best);
+			}
+
+			best = VecMul(best, VecLoad(block->weight, k));
+			total = VecAdd(total, best);
+			worst = VecMax(worst, best);
+
+			if (index)
+			{
+				VecStore(select, result);
+				for (machine m = 0; m < 4; m++)
+				{
+					index[k + m] = (unsigned_int8) result[m];
+				}
+			}
+		}
+
+		VecStore(worst, result);
+		float worstError = Fmax(Fmax(result[0], result[1]), Fmax(result[2], result[3]));
+
+		VecStore(total, result);
+		return (result[0] + result[1] + result[2] + result[3] - worstError);
+
+	#else
+
+		float totalError = 0.0F;
+		float worstError = 0.0F;
+		for (machine k = 0; k < 16; k++)
+		{
+			Point3D p(block->red[k], block->green[k], block->blue[k]);
+			float best = SquaredMag(p - palette[0]);
+			int32 select = 0;
+
+			for (machine a = 1; a < 4; a++)
+			{
+				float error = SquaredMag(p - palette[a]);
+				if (error < best)
+				{
+					best = error;
+					select = a;
+				}
+			}
+
+			best *= block->weight[k];
+			totalError += best;
+			worstError = Fmax(worstError, best);
+
+			if (index)
+			{
+				index[k] = (unsigned_int8) select;
+			}
+		}
+
+		return (totalError - worstError);
+
+	#endif
+}
+
+float Image::EvaluateChannelBlock(const float *value, const float *weight, int32 paletteCount, const float *palette, unsigned_int8 *restrict index)
+{
+	#if C4SIMD
+
+		alignas(16) float	result[4];
+
+		vec_float total = VecFloatGetZero();
+		vec_float worst = total;
+
+		for (machine k = 0; k < 16; k += 4)
+		{
+			vec_float v = VecLoad(value, k);
+
+			vec_float d = VecSub(v, VecLoadSmearScalar(palette));
+			vec_float best = VecMul(d, d);
+			vec_float select = VecFloatGetZero();
+
+			for (machine a = 1; a < paletteCount; a++)
+			{
+				d = VecSub(v, VecLoadSmearScalar(palette, a));
+				vec_float error = VecMul(d, d);
+
+				select = VecSelect(select, VecLoadSmearScalar(blockIndexValue, a), VecMaskCmplt(error, best));
+				best = VecMin(error, best);
+			}
+
+			best = VecMul(best, VecLoad(weight, k));
+			total = VecAdd(total, best);
+			worst = VecMax(worst, best);
+
+			if (index)
+			{
+				VecStore(select, result);
+				for (machine m = 0; m < 4; m++)
+				{
+					index[k + m] = (unsigned_int8) result[m];
+				}
+			}
+		}
+
+		VecStore(worst, result);
+		float worstError = Fmax(Fmax(result[0], result[1]), Fmax(result[2], result[3]));
+
+		VecStore(total, result);
+		return (result[0] + result[1] + result[2] + result[3] - worstError);
+
+	#else
+
+		float totalError = 0.0F;
+		float worstError = 0.0F;
+		for (machine k = 0; k < 16; k++)
+		{
+			float v = value[k];
+			float d = v - palette[0];
+			float best = d * d;
+			int32 select = 0;
+
+			for (machine a = 1; a < paletteCount; a++)
+			{
+				d = v - palette[a];
+				float error = d * d;
+				if (error < best)
+				{
+					best = error;
+					select = a;
+				}
+			}
+
+			best *= weight[k];
+			totalError += best;
+			worstError = Fmax(worstError, best);
+
+			if (index)
+			{
+				index[k] = (unsigned_int8) select;
+			}
+		}
+
+		return (totalError - worstError);
+
+	#endif
+}
+
+bool Image::RefineColorEndpoints(const BlockPixelData *block, const unsigned_int8 *index, bool black, unsigned_int16 *restrict color0, unsigned_int16 *restrict color1)
+{
+	// With the indices held fixed, the endpoints that minimize the squared error are found by
+	// solving a 2x2 least-squares system. Pixels assigned to black in the three-color mode
+	// don't depend on the endpoints, so they are left out of the fit.
+
+	const float *endpointWeight = colorEndpointWeight[black];
+
+	float ss = 0.0F;
+	float tt = 0.0F;
+	float st = 0.0F;
+	Vector3D sx(0.0F, 0.0F, 0.0F);
+	Vector3D tx(0.0F, 0.0F, 0.0F);
+
+	for (machine k = 0; k < 16; k++)
+	{
+		int32 i = index[k];
+		if ((black) && (i == 3))
+		{
+			continue;
+		}
+
+		float w = block->weight[k];
+		float s = endpointWeight[i];
+		float t = 1.0F - s;
+
+		Vector3D x(block->red[k], block->green[k], block->blue[k]);
+
+		ss += w * s * s;
+		tt += w * t * t;
+		st += w * s * t;
+		sx += x * (w * s);
+		tx += x * (w * t);
+	}
+
+	float det = ss * tt - st * st;
+	if (det < K::min_float)
+	{
+		return (false);
+	}
+
+	float f = 1.0F / det;
+	*color0 = QuantizeColor((sx * tt - tx * st) * f);
+	*color1 = QuantizeColor((tx * ss - sx * st) * f);
+	return (true);
+}
+
+bool Image::RefineGreenEndpoints(const BlockPixelData *block, const unsigned_int8 *index, unsigned_int16 *restrict color0, unsigned_int16 *restrict color1)
+{
+	const float *endpointWeight = colorEndpointWeight[0];
+
+	float ss = 0.0F;
+	float tt = 0.0F;
+	float st = 0.0F;
+	float sx = 0.0F;
+	float tx = 0.0F;
+
+	for (machine k = 0; k < 16; k++)
+	{
+		float w = block->weight[k];
+		float s = endpointWeight[index[k]];
+		float t = 1.0F - s;
+		float x = block->green[k];
+
+		ss += w * s * s;
+		tt += w * t * t;
+		st += w * s * t;
+		sx += w * s * x;
+		tx += w * t * x;
+	}
+
+	float det = ss * tt - st * st;
+	if (det < K::min_float)
+	{
+		return (false);
+	}
+
+	float f = 1.0F / det;
+	*color0 = (unsigned_int16) (MaxZero(Min((int32) ((sx * tt - tx * st) * f * 63.0F + 0.5F), 63)) << 5);
+	*color1 = (unsigned_int16) (MaxZero(Min((int32) ((tx * ss - sx * st) * f * 63.0F + 0.5F), 63)) << 5);
+	return (true);
+}
+
+void Image::SearchColorBlock(const BlockPixelData *block, bool alpha, unsigned_int32 flags, unsigned_int8 *restrict data)
+{
+	int32				candCount1;
+	int32				candCount2;
+	unsigned_int16		cand1[8];
+	unsigned_int16		cand2[8];
+	unsigned_int8		index[16];
+
+	CalculateEndpointCandidates(block->pixelCount, block->color, &candCount1, &candCount2, cand1, cand2);
+
+	unsigned_int16 bestColor0 = cand1[0];
+	unsigned_int16 bestColor1 = cand2[0];
+	bool bestBlack = false;
+
+	float best = K::infinity;
+	for (machine a = 0; a < candCount1; a++)
+	{
+		for (machine b = 0; b < candCount2; b++)
+		{
+			unsigned_int16 color0 = Max(cand1[a], cand2[b]);
+			unsigned_int16 color1 = Min(cand1[a], cand2[b]);
+
+			// Without alpha, a block having equal endpoints is decoded in the three-color
+			// mode, so only the three-color palette is evaluated for such a pair.
+
+			if ((alpha) || (color0 != color1))
+			{
+				float error = EvaluateColorBlock(block, color0, color1, false, nullptr);
+				if (error < best)
+				{
+					best = error;
+					bestColor0 = color0;
+					bestColor1 = color1;
+					bestBlack = false;
+				}
+			}
+
+			if (!alpha)
+			{
+				float error = EvaluateColorBlock(block, color1, color0, true, nullptr);
+				if (error < best)
+				{
+					best = error;
+					bestColor0 = color1;
+					bestColor1 = color0;
+					bestBlack = true;
+				}
+			}
+		}
+	}
+
+	EvaluateColorBlock(block, bestColor0, bestColor1, bestBlack, index);
+
+	if (flags & kBlockCompressHighQuality)
+	{
+		for (machine iteration = 0; iteration < kBlockRefinementIterationCount; iteration++)
+		{
+			unsigned_int16		color0;
+			unsigned_int16		color1;
+			unsigned_int8		refinedIndex[16];
+
+			if (!RefineColorEndpoints(block, index, bestBlack, &color0, &color1))
+			{
+				break;
+			}
+
+			bool black = bestBlack;
+			if (black)
+			{
+				if (color0 > color1)
+				{
+					Exchange(color0, color1);
+				}
+			}
+			else
+			{
+				if (color0 < color1)
+				{
+					Exchange(color0, color1);
+				}
+
+				black = ((!alpha) && (color0 == color1));
+			}
+
+			float error = EvaluateColorBlock(block, color0, color1, black, refinedIndex);
+			if (!(error < best))
+			{
+				break;
+			}
+
+			best = error;
+			bestColor0 = color0;
+			bestColor1 = color1;
+			bestBlack = black;
+
+			for (machine k = 0; k < 4; k++)
+			{
+				reinterpret_cast<unsigned_int32 *>(index)[k] = reinterpret_cast<unsigned_int32 *>(refinedIndex)[k];
+			}
+		}
+	}
+
+	data[0] = (unsigned_int8) (bestColor0 & 0x00FF);
+	data[1] = (unsigned_int8) (bestColor0 >> 8);
+	data[2] = (unsigned_int8) (bestColor1 & 0x00FF);
+	data[3] = (unsigned_int8) (bestColor1 >> 8);
+	PackBlockIndices(2, index, data + 4);
+}
+
+void Image::SearchGreenBlock(const BlockPixelData *block, unsigned_int32 flags, unsigned_int8 *restrict data)
+{
+	float				green[16];
+	float				palette[4];
+	int32				candCount1;
+	int32				candCount2;
+	unsigned_int16		cand1[8];
+	unsigned_int16		cand2[8];
+	unsigned_int8		index[16];
+
+	int32 count = block->pixelCount;
+	for (machine a = 0; a < count; a++)
+	{
+		green[a] = block->color[a].y;
+	}
+
+	CalculateEndpointCandidates(count, green, &candCount1, &candCount2, cand1, cand2);
+
+	unsigned_int16 bestColor0 = 0;
+	unsigned_int16 bestColor1 = 0;
+
+	float best = K::infinity;
+	for (machine a = 0; a < candCount1; a++)
+	{
+		for (machine b = 0; b < candCount2; b++)
+		{
+			unsigned_int16 color0 = Max(cand1[a], cand2[b]);
+			unsigned_int16 color1 = Min(cand1[a], cand2[b]);
+
+			palette[0] = (float) (color0 >> 5) * K::one_over_63;
+			palette[1] = (float) (color1 >> 5) * K::one_over_63;
+			palette[2] = PositiveFloor((palette[0] * 2.0F + palette[1]) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+			palette[3] = PositiveFloor((palette[0] + palette[1] * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+
+			float error = EvaluateChannelBlock(block->green, block->weight, 4, palette, nullptr);
+			if (error < best)
+			{
+				best = error;
+				bestColor0 = color0;
+				bestColor1 = color1;
+			}
+		}
+	}
+
+	for (machine iteration = -1; iteration < kBlockRefinementIterationCount; iteration++)
+	{
+		// The first pass calculates the indices for the endpoints found by the search. In the
+		// high-quality mode, the following passes refit the endpoints to those indices.
+
+		unsigned_int16 color0 = bestColor0;
+		unsigned_int16 color1 = bestColor1;
+
+		if (iteration >= 0)
+		{
+			if ((!(flags & kBlockCompressHighQuality)) || (!RefineGreenEndpoints(block, index, &color0, &color1)))
+			{
+				break;
+			}
+
+			if (color0 < color1)
+			{
+				Exchange(color0, color1);
+			}
+		}
+
+		unsigned_int8		refinedIndex[16];
+
+		palette[0] = (float) (color0 >> 5) * K::one_over_63;
+		palette[1] = (float) (color1 >> 5) * K::one_over_63;
+		palette[2] = PositiveFloor((palette[0] * 2.0F + palette[1]) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+		palette[3] = PositiveFloor((palette[0] + palette[1] * 2.0F) * (K::one_over_3 * 255.0F)) * K::one_over_255;
+
+		float error = EvaluateChannelBlock(block->green, block->weight, 4, palette, refinedIndex);
+		if ((iteration >= 0) && (!(error < best)))
+		{
+			break;
+		}
+
+		best = error;
+		bestColor0 = color0;
+		bestColor1 = color1;
+
+		for (machine k = 0; k < 4; k++)
+		{
+			reinterpret_cast<unsigned_int32 *>(index)[k] = reinterpret_cast<unsigned_int32 *>(refinedIndex)[k];
+		}
+	}
+
+	data[0] = (unsigned_int8) (bestColor0 & 0x00FF);
+	data[1] = (unsigned_int8) (bestColor0 >> 8);
+	data[2] = (unsigned_int8) (bestColor1 & 0x00FF);
+	data[3] = (unsigned_int8) (bestColor1 >> 8);
+	PackBlockIndices(2, index, data + 4);
+}
+
+void Image::SearchGrayBlock(const BlockPixelData *block, unsigned_int8 *restrict data)
+{
+	float				palette[8];
+	unsigned_int8		uniqueGray[16];
+	unsigned_int8		index[16];
+
+	int32 uniqueGrayCount = 0;
+	for (machine k = 0; k < 16; k++)
+	{
+		if (block->weight[k] != 0.0F)
+		{
+			unsigned_int8 gray = block->alphaValue[k];
+			for (machine a = 0; a < uniqueGrayCount; a++)
+			{
+				if (uniqueGray[a] == gray)
+				{
+					goto next;
+				}
+			}
+
+			uniqueGray[uniqueGrayCount++] = gray;
+			next:;
+		}
+	}
+
+	if (uniqueGrayCount == 1)
+	{
+		data[0] = uniqueGray[0];
+		for (machine a = 1; a < 8; a++)
+		{
+			data[a] = 0;
+		}
+
+		return;
+	}
+
+	if (uniqueGrayCount == 2)
+	{
+		unsigned_int8 gray0 = Max(uniqueGray[0], uniqueGray[1]);
+		unsigned_int8 gray1 = Min(uniqueGray[0], uniqueGray[1]);
+
+		for (machine k = 0; k < 16; k++)
+		{
+			index[k] = (block->alphaValue[k] == gray1);
+		}
+
+		data[0] = gray0;
+		data[1] = gray1;
+		PackBlockIndices(3, index, data + 2);
+		return;
+	}
+
+	// Every pair of distinct values in the block is tried as the endpoints in both the
+	// eight-value mode and the six-value mode having explicit values for zero and one.
+
+	unsigned_int8 bestGray0 = 0;
+	unsigned_int8 bestGray1 = 0;
+	bool bestBlack = false;
+
+	float best = K::infinity;
+	for (machine a = 0; a < uniqueGrayCount; a++)
+	{
+		unsigned_int8 gray0 = uniqueGray[a];
+		for (machine b = 0; b < uniqueGrayCount; b++)
+		{
+			unsigned_int8 gray1 = uniqueGray[b];
+			if (gray0 > gray1)
+			{
+				CalculateGrayPalette(gray0, gray1, false, palette);
+				float error = EvaluateChannelBlock(block->alpha, block->weight, 8, palette, nullptr);
+				if (error < best)
+				{
+					best = error;
+					bestGray0 = gray0;
+					bestGray1 = gray1;
+					bestBlack = false;
+				}
+
+				CalculateGrayPalette(gray1, gray0, true, palette);
+				error = EvaluateChannelBlock(block->alpha, block->weight, 8, palette, nullptr);
+				if (error < best)
+				{
+					best = error;
+					bestGray0 = gray1;
+					bestGray1 = gray0;
+					bestBlack = true;
+				}
+			}
+		}
+	}
+
+	CalculateGrayPalette(bestGray0, bestGray1, bestBlack, palette);
+	EvaluateChannelBlock(block->alpha, block->weight, 8, palette, index);
+
+	data[0] = bestGray0;
+	data[1] = bestGray1;
+	PackBlockIndices(3, index, data + 2);
+}
+
+void Image::CompressBlockTile(int32 format, int32 width, int32 height, const Rect& rect, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags)
+{
+	int32 blockCountX = (width + 3) >> 2;
+	int32 blockSize = (format == kBlockFormatBC1) ? 8 : 16;
+
+	for (machine j = rect.top; j < rect.bottom; j++)
+	{
+		int32 y = j * 4;
+		int32 blockHeight = Min(height - y, 4);
+
+		for (machine i = rect.left; i < rect.right; i++)
+		{
+			BlockPixelData		block;
+
+			int32 x = i * 4;
+			LoadBlockPixels(Min(width - x, 4), blockHeight, width, image + (y * width + x), &block);
+
+			unsigned_int8 *code = data + (j * blockCountX + i) * blockSize;
+			if (format == kBlockFormatBC1)
+			{
+				SearchColorBlock(&block, false, flags, code);
+			}
+			else
+			{
+				SearchGrayBlock(&block, code);
+				if (format == kBlockFormatBC3)
+				{
+					SearchColorBlock(&block, true, flags, code + 8);
+				}
+				else
+				{
+					SearchGreenBlock(&block, flags, code + 8);
+				}
+			}
+		}
+	}
+}
+
+void Image::JobCompressBlockTile(Job *job, void *cookie)
+{
+	const BlockCompressionJob *compressionJob = static_cast<BlockCompressionJob *>(job);
+	CompressBlockTile(compressionJob->blockFormat, compressionJob->imageWidth, compressionJob->imageHeight, compressionJob->blockRect, compressionJob->sourceImage, compressionJob->outputCode, compressionJob->compressionFlags);
+}
+
+int32 Image::CompressImageBlocks(int32 format, int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags)
+{
+	int32 blockCountX = (width + 3) >> 2;
+	int32 blockCountY = (height + 3) >> 2;
+	int32 imageSize = blockCountX * blockCountY * ((format == kBlockFormatBC1) ? 8 : 16);
+
+	int32 xcount = (blockCountX + (kBlockCompressionTileSize - 1)) / kBlockCompressionTileSize;
+	int32 ycount = (blockCountY + (kBlockCompressionTileSize - 1)) / kBlockCompressionTileSize;
+
+	if ((xcount * ycount * count > 1) && (!(flags & kBlockCompressSingleThread)))
+	{
+		// The image is divided into tiles of blocks that are compressed by separate jobs. The jobs
+		// are independent because every block is read from the source image and written to its
+		// own location in the output, so no synchronization is needed until the batch finishes.
+
+		Batch	batch;
+
+		for (machine a = 0; a < count; a++)
+		{
+			for (machine j = 0; j < ycount; j++)
+			{
+				int32 y = j * kBlockCompressionTileSize;
+				for (machine i = 0; i < xcount; i++)
+				{
+					int32 x = i * kBlockCompressionTileSize;
+					Rect rect(x, y, Min(x + kBlockCompressionTileSize, blockCountX), Min(y + kBlockCompressionTileSize, blockCountY));
+
+					BlockCompressionJob *job = new BlockCompressionJob(&JobCompressBlockTile, format, width, height, rect, image, data, flags);
+					TheJobMgr->SubmitJob(job, &batch);
+				}
+			}
+
+			image += width * height;
+			data += imageSize;
+		}
+
+		TheJobMgr->FinishBatch(&batch);
+	}
+	else
+	{
+		for (machine a = 0; a < count; a++)
+		{
+			CompressBlockTile(format, width, height, Rect(0, 0, blockCountX, blockCountY), image, data, flags);
+
+			image += width * height;
+			data += imageSize;
+		}
+	}
+
+	return (blockCountX * blockCountY * count);
+}
+
+int32 Image::CompressImageBC1(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags)
+{
+	return (CompressImageBlocks(kBlockFormatBC1, count, width, height, image, data, flags));
+}
+
+int32 Image::CompressImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags)
+{
+	return (CompressImageBlocks(kBlockFormatBC3, count, width, height, image, data, flags));
+}
+
+int32 Image::CompressNormalImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags)
+{
+	return (CompressImageBlocks(kBlockFormatNormalBC3, count, width, height, image, data, flags));
+}
+
 void Image::BleedAlphaTestMap(int32 width, int32 height, const Rect& rect, const Color4C *source, Color4C *restrict destin, unsigned_int32 testValue)
 {
 	int32 widthMinus1 = width - 1;
@@ -21,6 +21,16 @@ namespace C4
 	};
 
 
+	enum
+	{
+		kBlockCompressHighQuality	= 1 << 0,
+		kBlockCompressSingleThread	= 1 << 1
+	};
+
+
+	class Job;
+
+
 	//# \class	Color2C		Encapsulates an integer two-component color.
 	//
 	//# The $Color2C$ class encapsulates an integer two-component color.
@@ -627,6 +637,19 @@ namespace C4
 	{
 		private:
 
+			struct BlockPixelData
+			{
+				alignas(16) float		red[16];
+				alignas(16) float		green[16];
+				alignas(16) float		blue[16];
+				alignas(16) float		alpha[16];
+				alignas(16) float		weight[16];
+
+				int32					pixelCount;
+				Point3D					color[16];
+				unsigned_int8			alphaValue[16];
+			};
+
 			static Vector3D CalculateColorAxis(int32 count, const Point3D *color, const Box3D& bounds);
 			static void CalculateEndpointCandidates(int32 count, const Point3D *color, int32 *restrict candCount1, int32 *restrict candCount2, unsigned_int16 *restrict cand1, unsigned_int16 *restrict cand2);
 			static void CalculateEndpointCandidates(int32 count, const float *green, int32 *restrict candCount1, int32 *restrict candCount2, unsigned_int16 *restrict cand1, unsigned_int16 *restrict cand2);
@@ -634,6 +657,25 @@ namespace C4
 			static float EncodeGreenBlock(int32 width, int32 height, unsigned_int16 color0, unsigned_int16 color1, const float *image, unsigned_int8 *restrict data);
 			static float EncodeGrayBlock(int32 width, int32 height, unsigned_int8 gray0, unsigned_int8 gray1, bool black, const float *image, unsigned_int8 *restrict data);
 
+			static int32 CalculateCandidateColors(const Point3D& color, const Vector3D& axis, unsigned_int16 *restrict cand);
+			static void CalculateColorPalette(unsigned_int16 color0, unsigned_int16 color1, bool black, Point3D *restrict palette);
+			static void CalculateGrayPalette(unsigned_int8 gray0, unsigned_int8 gray1, bool black, float *restrict palette);
+			static void PackBlockIndices(int32 bitCount, const unsigned_int8 *index, unsigned_int8 *restrict data);
+
+			static void LoadBlockPixels(int32 width, int32 height, int32 rowLength, const Color4C *image, BlockPixelData *restrict block);
+			static float EvaluateColorBlock(const BlockPixelData *block, unsigned_int16 color0, unsigned_int16 color1, bool black, unsigned_int8 *restrict index);
+			static float EvaluateChannelBlock(const float *value, const float *weight, int32 paletteCount, const float *palette, unsigned_int8 *restrict index);
+			static bool RefineColorEndpoints(const BlockPixelData *block, const unsigned_int8 *index, bool black, unsigned_int16 *restrict color0, unsigned_int16 *restrict color1);
+			static bool RefineGreenEndpoints(const BlockPixelData *block, const unsigned_int8 *index, unsigned_int16 *restrict color0, unsigned_int16 *restrict color1);
+
+			static void SearchColorBlock(const BlockPixelData *block, bool alpha, unsigned_int32 flags, unsigned_int8 *restrict data);
+			static void SearchGreenBlock(const BlockPixelData *block, unsigned_int32 flags, unsigned_int8 *restrict data);
+			static void SearchGrayBlock(const BlockPixelData *block, unsigned_int8 *restrict data);
+
+			static int32 CompressImageBlocks(int32 format, int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags);
+			static void CompressBlockTile(int32 format, int32 width, int32 height, const Rect& rect, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags);
+			static void JobCompressBlockTile(Job *job, void *cookie);
+
 		public:
 
 			C4API static void DecompressImageRLE_RGBA32(const unsigned_int8 *code, unsigned_int32 codeSize, void *restrict output);
@@ -646,6 +688,11 @@ namespace C4
 			C4API static void CompressColorBlock(int32 width, int32 height, int32 rowLength, bool alpha, const Color4C *image, unsigned_int8 *restrict data);
 			C4API static void CompressGreenBlock(int32 width, int32 height, int32 rowLength, const Color4C *image, unsigned_int8 *restrict data);
 			C4API static void CompressGrayBlock(int32 width, int32 height, int32 rowLength, const unsigned_int8 *image, unsigned_int8 *restrict data);
+			C4API static void DecompressColorBlock(const unsigned_int8 *data, Color4C *restrict image);
+
+			C4API static int32 CompressImageBC1(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags = 0);
+			C4API static int32 CompressImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags = 0);
+			C4API static int32 CompressNormalImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *restrict data, unsigned_int32 flags = 0);
 
 			C4API static void BleedAlphaTestMap(int32 width, int32 height, const Rect& rect, const Color4C *source, Color4C *restrict destin, unsigned_int32 testValue);
 			C4API static void BleedNormalMap(int32 width, int32 height, const Rect& rect, const Color4C *source, Color4C *restrict destin);
@@ -611,6 +611,10 @@ void Impostor::SetMaterialObject(MaterialObject *object)
 	MaterialObject *prevObject = materialObject;
 	if (prevObject != object)
 	{
+		// The packed data for the node holds the index of the material object.
+
+		InvalidateDeltaPack();
+
 		if (prevObject)
 		{
 			prevObject->Release();
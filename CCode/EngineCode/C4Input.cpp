@@ -713,7 +713,7 @@ void ButtonControl::HandleNormalEvent(int32 value)
 
 			if (count == 0)
 			{
-				action->Begin();
+				TheInputMgr->BeginAction(action);
 			}
 		}
 		else
@@ -724,7 +724,7 @@ void ButtonControl::HandleNormalEvent(int32 value)
 
 			if (count == 1)
 			{
-				action->End();
+				TheInputMgr->EndAction(action);
 			}
 		}
 	}
@@ -820,15 +820,15 @@ void AxisControl::HandleNormalEvent(int32 value)
 		float v = float(value) - centerValue;
 		if (Fabs(v) <= deadZone)
 		{
-			action->Update(0.0F);
+			TheInputMgr->UpdateAction(action, 0.0F);
 		}
 		else if (v > 0.0F)
 		{
-			action->Update((Fmin(v, maxValue) - deadZone) * normalizer);
+			TheInputMgr->UpdateAction(action, (Fmin(v, maxValue) - deadZone) * normalizer);
 		}
 		else
 		{
-			action->Update((Fmax(v, minValue) + deadZone) * normalizer);
+			TheInputMgr->UpdateAction(action, (Fmax(v, minValue) + deadZone) * normalizer);
 		}
 	}
 }
@@ -912,7 +912,7 @@ void DeltaAxisControl::HandleNormalEvent(int32 value)
 	{
 		if (value != 0)
 		{
-			action->Update(float(value));
+			TheInputMgr->UpdateAction(action, float(value));
 		}
 	}
 }
@@ -963,11 +963,11 @@ void SliderControl::HandleNormalEvent(int32 value)
 		float v = float(value);
 		if (v <= threshold)
 		{
-			action->Update(0.0F);
+			TheInputMgr->UpdateAction(action, 0.0F);
 		}
 		else
 		{
-			action->Update((Fmin(v, maxValue) - threshold) * normalizer);
+			TheInputMgr->UpdateAction(action, (Fmin(v, maxValue) - threshold) * normalizer);
 		}
 	}
 }
@@ -1011,11 +1011,11 @@ void DirectionalControl::HandleNormalEvent(int32 value)
 		value /= divider;
 		if (unsigned_int32(value) < 8U)
 		{
-			action->Move(value);
+			TheInputMgr->MoveAction(action, value);
 		}
 		else
 		{
-			action->Move(-1);
+			TheInputMgr->MoveAction(action, -1);
 		}
 	}
 }
@@ -1418,7 +1418,7 @@ void InputDevice::ResetActions(void) const
 		if ((action) && (action->GetActiveCount() > 0))
 		{
 			action->SetActiveCount(0);
-			action->End();
+			TheInputMgr->EndAction(action);
 		}
 
 		control = GetNextControl(control);
@@ -1465,7 +1465,7 @@ void InputDevice::Deactivate(void)
 
 			if (count == 1)
 			{
-				action->End();
+				TheInputMgr->EndAction(action);
 			}
 		}
 
@@ -3125,11 +3125,21 @@ EngineResult InputMgr::Construct(void)
 
 	#elif C4LINUX
 
-		mouseDevice = new MouseDevice;
-		deviceList.Append(mouseDevice);
+		// In headless mode, there is no connection to the X server, so the mouse and keyboard
+		// devices are not created. X events are never received in that case, so the devices
+		// are never accessed.
 
-		keyboardDevice = new KeyboardDevice;
-		deviceList.Append(keyboardDevice);
+		mouseDevice = nullptr;
+		keyboardDevice = nullptr;
+
+		if (TheEngine->GetEngineDisplay())
+		{
+			mouseDevice = new MouseDevice;
+			deviceList.Append(mouseDevice);
+
+			keyboardDevice = new KeyboardDevice;
+			deviceList.Append(keyboardDevice);
+		}
 
 		for (machine a = 0; a < 10; a++)
 		{
@@ -3181,6 +3191,7 @@ EngineResult InputMgr::Construct(void)
 	consoleProc = nullptr;
 	escapeProc = nullptr;
 	configProc = nullptr;
+	actionRecordProc = nullptr;
 
 	mouseFlags = 0;
 
@@ -3579,7 +3590,7 @@ void InputMgr::ResetAllActions(void)
 		if (action->GetActiveCount() > 0)
 		{
 			action->SetActiveCount(0);
-			action->End();
+			EndAction(action);
 		}
 
 		action = action->Next();
@@ -198,6 +198,15 @@ namespace C4
 	};
 
 
+	enum
+	{
+		kActionEventBegin,
+		kActionEventEnd,
+		kActionEventMove,
+		kActionEventUpdate
+	};
+
+
 	//# \enum	MouseFlags
 
 	enum
@@ -2032,6 +2041,7 @@ namespace C4
 
 			typedef void KeyProc(void *);
 			typedef void ConfigProc(InputControl *, float, void *);
+			typedef void ActionRecordProc(const Action *, int32, float, void *);
 
 		private:
 
@@ -2093,6 +2103,9 @@ namespace C4
 			ConfigProc						*configProc;
 			void							*configCookie;
 
+			ActionRecordProc				*actionRecordProc;
+			void							*actionRecordCookie;
+
 			int32							mouseSensitivity;
 			unsigned_int32					mouseFlags;
 
@@ -2210,6 +2223,54 @@ namespace C4
 				}
 			}
 
+			ActionRecordProc *GetActionRecordProc(void) const
+			{
+				return (actionRecordProc);
+			}
+
+			void *GetActionRecordCookie(void) const
+			{
+				return (actionRecordCookie);
+			}
+
+			void SetActionRecordProc(ActionRecordProc *proc, void *cookie = nullptr)
+			{
+				actionRecordProc = proc;
+				actionRecordCookie = cookie;
+			}
+
+			void RecordAction(const Action *action, int32 event, float value)
+			{
+				if (actionRecordProc)
+				{
+					(*actionRecordProc)(action, event, value, actionRecordCookie);
+				}
+			}
+
+			void BeginAction(Action *action)
+			{
+				RecordAction(action, kActionEventBegin, 0.0F);
+				action->Begin();
+			}
+
+			void EndAction(Action *action)
+			{
+				RecordAction(action, kActionEventEnd, 0.0F);
+				action->End();
+			}
+
+			void MoveAction(Action *action, int32 value)
+			{
+				RecordAction(action, kActionEventMove, (float) value);
+				action->Move(value);
+			}
+
+			void UpdateAction(Action *action, float value)
+			{
+				RecordAction(action, kActionEventUpdate, value);
+				action->Update(value);
+			}
+
 			int32 GetMouseSensitivity(void) const
 			{
 				return (mouseSensitivity);
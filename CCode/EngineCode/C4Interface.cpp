@@ -258,8 +258,11 @@ InterfaceMgr::InterfaceMgr(int) :
 		menuTitleColorObserver(this, &InterfaceMgr::HandleMenuTitleColorEvent),
 		pageTitleColorObserver(this, &InterfaceMgr::HandlePageTitleColorEvent),
 		stripTitleColorObserver(this, &InterfaceMgr::HandleStripTitleColorEvent),
-		stripButtonColorObserver(this, &InterfaceMgr::HandleStripButtonColorEvent)
+		stripButtonColorObserver(this, &InterfaceMgr::HandleStripButtonColorEvent),
+		widgetBatchObserver(this, &InterfaceMgr::HandleWidgetBatchEvent)
 {
+	widgetBatchFlag = true;
+	activeBatcher = nullptr;
 }
 
 InterfaceMgr::~InterfaceMgr()
@@ -315,6 +318,7 @@ EngineResult InterfaceMgr::Construct(void)
 	TheEngine->InitVariable("pageTitleColor", "FFFFFF", kVariablePermanent, &pageTitleColorObserver);
 	TheEngine->InitVariable("stripTitleColor", "000000", kVariablePermanent, &stripTitleColorObserver);
 	TheEngine->InitVariable("stripButtonColor", "40FFD0", kVariablePermanent, &stripButtonColorObserver);
+	TheEngine->InitVariable("widgetBatch", "1", kVariablePermanent, &widgetBatchObserver);
 
 	toolsMenu = new PulldownMenuWidget(nullptr);
 
@@ -346,12 +350,26 @@ EngineResult InterfaceMgr::Construct(void)
 		caretBlinkTime = 350;
 
 		::Display *display = TheEngine->GetEngineDisplay();
-		keycodeList.leftShiftKeycode = XKeysymToKeycode(display, XK_Shift_L);
-		keycodeList.rightShiftKeycode = XKeysymToKeycode(display, XK_Shift_R);
-		keycodeList.leftAltKeycode = XKeysymToKeycode(display, XK_Alt_L);
-		keycodeList.rightAltKeycode = XKeysymToKeycode(display, XK_Alt_R);
-		keycodeList.leftControlKeycode = XKeysymToKeycode(display, XK_Control_L);
-		keycodeList.rightControlKeycode = XKeysymToKeycode(display, XK_Control_R);
+		if (display)
+		{
+			keycodeList.leftShiftKeycode = XKeysymToKeycode(display, XK_Shift_L);
+			keycodeList.rightShiftKeycode = XKeysymToKeycode(display, XK_Shift_R);
+			keycodeList.leftAltKeycode = XKeysymToKeycode(display, XK_Alt_L);
+			keycodeList.rightAltKeycode = XKeysymToKeycode(display, XK_Alt_R);
+			keycodeList.leftControlKeycode = XKeysymToKeycode(display, XK_Control_L);
+			keycodeList.rightControlKeycode = XKeysymToKeycode(display, XK_Control_R);
+		}
+		else
+		{
+			// In headless mode, there is no connection to the X server, and no modifier keys are ever reported.
+
+			keycodeList.leftShiftKeycode = 0;
+			keycodeList.rightShiftKeycode = 0;
+			keycodeList.leftAltKeycode = 0;
+			keycodeList.rightAltKeycode = 0;
+			keycodeList.leftControlKeycode = 0;
+			keycodeList.rightControlKeycode = 0;
+		}
 
 	#elif C4IOS //[ MOBILE
 
@@ -490,6 +508,11 @@ void InterfaceMgr::HandleStripButtonColorEvent(Variable *variable)
 	interfaceColor[kInterfaceColorStripButton] = ColorRGBA().SetHexString(variable->GetValue());
 }
 
+void InterfaceMgr::HandleWidgetBatchEvent(Variable *variable)
+{
+	widgetBatchFlag = (variable->GetIntegerValue() != 0);
+}
+
 bool InterfaceMgr::GetShiftKey(void)
 {
 	#if C4WINDOWS
@@ -504,7 +527,13 @@ bool InterfaceMgr::GetShiftKey(void)
 
 		char	keymap[32];
 
-		XQueryKeymap(TheEngine->GetEngineDisplay(), keymap);
+		::Display *display = TheEngine->GetEngineDisplay();
+		if (!display)
+		{
+			return (false);
+		}
+
+		XQueryKeymap(display, keymap);
 
 		const KeycodeList *list = &keycodeList;
 		int32 left = list->leftShiftKeycode;
@@ -536,7 +565,13 @@ bool InterfaceMgr::GetOptionKey(void)
 
 		char	keymap[32];
 
-		XQueryKeymap(TheEngine->GetEngineDisplay(), keymap);
+		::Display *display = TheEngine->GetEngineDisplay();
+		if (!display)
+		{
+			return (false);
+		}
+
+		XQueryKeymap(display, keymap);
 
 		const KeycodeList *list = &keycodeList;
 		int32 left = list->leftAltKeycode;
@@ -568,7 +603,13 @@ bool InterfaceMgr::GetCommandKey(void)
 
 		char	keymap[32];
 
-		XQueryKeymap(TheEngine->GetEngineDisplay(), keymap);
+		::Display *display = TheEngine->GetEngineDisplay();
+		if (!display)
+		{
+			return (false);
+		}
+
+		XQueryKeymap(display, keymap);
 
 		const KeycodeList *list = &keycodeList;
 		int32 left = list->leftControlKeycode;
@@ -626,7 +667,13 @@ unsigned_int32 InterfaceMgr::GetModifierKeys(void)
 
 		char	keymap[32];
 
-		XQueryKeymap(TheEngine->GetEngineDisplay(), keymap);
+		::Display *display = TheEngine->GetEngineDisplay();
+		if (!display)
+		{
+			return (0);
+		}
+
+		XQueryKeymap(display, keymap);
 
 		const KeycodeList *list = &keycodeList;
 		int32 left = list->leftShiftKeycode;
@@ -1596,6 +1643,15 @@ void InterfaceMgr::Render(void)
 	windowRoot->Update();
 	stripBoard->Update();
 
+	// While the widget trees are rendered, text widgets in the same window or board that share a font
+	// are gathered into common batches. The batches have to be finished before the list is drawn.
+
+	if (widgetBatchFlag)
+	{
+		widgetBatcher.BeginFrame();
+		activeBatcher = &widgetBatcher;
+	}
+
 	rootWidget->RenderTree(&renderList);
 	windowRoot->RenderTree(&renderList);
 
@@ -1608,6 +1664,12 @@ void InterfaceMgr::Render(void)
 
 	stripBoard->RenderTree(&renderList);
 
+	if (activeBatcher)
+	{
+		activeBatcher->Flush();
+		activeBatcher = nullptr;
+	}
+
 	#if !C4MOBILE
 
 		if (cursorVisible)
@@ -614,6 +614,10 @@ namespace C4
 
 			ColorRGBA					interfaceColor[kInterfaceColorCount];
 
+			bool						widgetBatchFlag;
+			WidgetBatcher				widgetBatcher;
+			WidgetBatcher				*activeBatcher;
+
 			VariableObserver<InterfaceMgr>		desktopColorObserver;
 			VariableObserver<InterfaceMgr>		buttonColorObserver;
 			VariableObserver<InterfaceMgr>		hiliteColorObserver;
@@ -629,6 +633,7 @@ namespace C4
 			VariableObserver<InterfaceMgr>		pageTitleColorObserver;
 			VariableObserver<InterfaceMgr>		stripTitleColorObserver;
 			VariableObserver<InterfaceMgr>		stripButtonColorObserver;
+			VariableObserver<InterfaceMgr>		widgetBatchObserver;
 
 			#if C4LINUX
 
@@ -663,6 +668,7 @@ namespace C4
 			void HandlePageTitleColorEvent(Variable *variable);
 			void HandleStripTitleColorEvent(Variable *variable);
 			void HandleStripButtonColorEvent(Variable *variable);
+			void HandleWidgetBatchEvent(Variable *variable);
 
 			void BringToFront(Window *window);
 
@@ -776,6 +782,36 @@ namespace C4
 				return (caretBlinkTime);
 			}
 
+			WidgetBatcher *GetWidgetBatcher(void) const
+			{
+				return (activeBatcher);
+			}
+
+			void FlushWidgetBatches(void)
+			{
+				if (activeBatcher)
+				{
+					activeBatcher->Flush();
+				}
+			}
+
+			WidgetBatcher *SuspendWidgetBatcher(void)
+			{
+				WidgetBatcher *batcher = activeBatcher;
+				if (batcher)
+				{
+					batcher->Flush();
+					activeBatcher = nullptr;
+				}
+
+				return (batcher);
+			}
+
+			void ResumeWidgetBatcher(WidgetBatcher *batcher)
+			{
+				activeBatcher = batcher;
+			}
+
 			bool QuitEnabled(void) const
 			{
 				return ((interfaceFlags & kInterfaceQuitDisabled) == 0);
@@ -110,6 +110,7 @@ Method::Method(const Method& method) : methodReference(this)
 
 	targetKey = method.targetKey; 
 	outputValueName = method.outputValueName;
+	outputValueAtom = method.outputValueAtom;
  
 	const Setting *setting = method.inputValueList.First(); 
 	while (setting)
@@ -281,6 +282,7 @@ bool Method::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigne
 		case 'OVAL':
 
 			data >> outputValueName;
+			outputValueAtom = TextAtom(outputValueName);
 			return (true);
 
 		case 'IVAL':
@@ -309,6 +311,7 @@ void *Method::BeginSettingsUnpack(void)
 {
 	targetKey[0] = 0;
 	outputValueName[0] = 0;
+	outputValueAtom = TextAtom();
 
 	inputValueList.Purge();
 	return (nullptr);
@@ -346,7 +349,7 @@ void Method::ProcessInputValues(const ScriptState *state)
 	Setting *setting = inputValueList.First();
 	while (setting)
 	{
-		const Value *value = state->GetValue(setting->GetSettingValueName());
+		const Value *value = state->GetValue(setting->GetSettingValueAtom());
 		if ((value) && (setting->SetValue(value)))
 		{
 			SetSetting(setting);
@@ -360,7 +363,7 @@ void Method::SetOutputValue(const ScriptState *state, bool v)
 {
 	SetMethodResult(v);
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -371,7 +374,7 @@ void Method::SetOutputValue(const ScriptState *state, int32 v)
 {
 	SetMethodResult(v != 0);
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -382,7 +385,7 @@ void Method::SetOutputValue(const ScriptState *state, float v)
 {
 	SetMethodResult(v != 0.0F);
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -393,7 +396,7 @@ void Method::SetOutputValue(const ScriptState *state, const char *v)
 {
 	SetMethodResult(v[0] != 0);
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -404,7 +407,7 @@ void Method::SetOutputValue(const ScriptState *state, const ColorRGBA& v)
 {
 	SetMethodResult((v.red != 0.0F) || (v.green != 0.0F) || (v.blue != 0.0F) || (v.alpha != 0.0F));
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -415,7 +418,7 @@ void Method::SetOutputValue(const ScriptState *state, const Vector3D& v)
 {
 	SetMethodResult((v.x != 0.0F) || (v.y != 0.0F) || (v.z != 0.0F));
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -426,7 +429,7 @@ void Method::SetOutputValue(const ScriptState *state, const Value *v)
 {
 	SetMethodResult(v->GetBooleanValue());
 
-	Value *output = state->GetValue(GetOutputValueName());
+	Value *output = state->GetValue(outputValueAtom);
 	if (output)
 	{
 		output->SetValue(v);
@@ -734,7 +737,7 @@ void FunctionMethod::ProcessInputValues(const ScriptState *state)
 		Setting *setting = GetFirstInputValue();
 		while (setting)
 		{
-			const Value *value = state->GetValue(setting->GetSettingValueName());
+			const Value *value = state->GetValue(setting->GetSettingValueAtom());
 			if ((value) && (setting->SetValue(value)))
 			{
 				methodFunction->SetSetting(setting);
@@ -938,7 +941,7 @@ void SettingMethod::Execute(const ScriptState *state)
 				Setting *input = GetFirstInputValue();
 				while (input)
 				{
-					const Value *value = state->GetValue(input->GetSettingValueName());
+					const Value *value = state->GetValue(input->GetSettingValueAtom());
 					if ((value) && (input->SetValue(value)))
 					{
 						TheMessageMgr->SendMessageJournal(new SettingMessage(controllerIndex, category, input));
@@ -1061,11 +1064,13 @@ GetVariableMethod::GetVariableMethod() : Method(kMethodGetVariable)
 GetVariableMethod::GetVariableMethod(const char *name) : Method(kMethodGetVariable)
 {
 	valueName = name;
+	valueAtom = TextAtom(valueName);
 }
 
 GetVariableMethod::GetVariableMethod(const GetVariableMethod& getVariableMethod) : Method(getVariableMethod)
 {
 	valueName = getVariableMethod.valueName;
+	valueAtom = getVariableMethod.valueAtom;
 }
 
 GetVariableMethod::~GetVariableMethod()
@@ -1089,6 +1094,7 @@ void GetVariableMethod::Unpack(Unpacker& data, unsigned_int32 unpackFlags)
 	Method::Unpack(data, unpackFlags);
 
 	data >> valueName;
+	valueAtom = TextAtom(valueName);
 }
 
 int32 GetVariableMethod::GetSettingCount(void) const
@@ -1108,6 +1114,7 @@ void GetVariableMethod::SetSetting(const Setting *setting)
 	if (setting->GetSettingIdentifier() == 'NAME')
 	{
 		valueName = static_cast<const TextSetting *>(setting)->GetText();
+		valueAtom = TextAtom(valueName);
 	}
 }
 
@@ -1124,14 +1131,14 @@ void GetVariableMethod::Execute(const ScriptState *state)
 			const ScriptObject *object = scriptController->GetScriptObject();
 			if (object)
 			{
-				const Value *value = object->GetValue(valueName);
+				const Value *value = object->GetValue(valueAtom);
 				if (value)
 				{
 					SetOutputValue(state, value);
 				}
 				else
 				{
-					value = scriptController->GetValue(valueName);
+					value = scriptController->GetValue(valueAtom);
 					if (value)
 					{
 						SetOutputValue(state, value);
@@ -1154,13 +1161,17 @@ SetVariableMethod::SetVariableMethod() : Method(kMethodSetVariable)
 SetVariableMethod::SetVariableMethod(const char *name, const char *source) : Method(kMethodSetVariable)
 {
 	valueName = name;
+	valueAtom = TextAtom(valueName);
 	sourceName = source;
+	sourceAtom = TextAtom(sourceName);
 }
 
 SetVariableMethod::SetVariableMethod(const SetVariableMethod& setVariableMethod) : Method(setVariableMethod)
 {
 	valueName = setVariableMethod.valueName;
+	valueAtom = setVariableMethod.valueAtom;
 	sourceName = setVariableMethod.sourceName;
+	sourceAtom = setVariableMethod.sourceAtom;
 }
 
 SetVariableMethod::~SetVariableMethod()
@@ -1185,7 +1196,9 @@ void SetVariableMethod::Unpack(Unpacker& data, unsigned_int32 unpackFlags)
 	Method::Unpack(data, unpackFlags);
 
 	data >> valueName;
+	valueAtom = TextAtom(valueName);
 	data >> sourceName;
+	sourceAtom = TextAtom(sourceName);
 }
 
 int32 SetVariableMethod::GetSettingCount(void) const
@@ -1218,16 +1231,18 @@ void SetVariableMethod::SetSetting(const Setting *setting)
 	if (identifier == 'NAME')
 	{
 		valueName = static_cast<const TextSetting *>(setting)->GetText();
+		valueAtom = TextAtom(valueName);
 	}
 	else if (identifier == 'SORC')
 	{
 		sourceName = static_cast<const TextSetting *>(setting)->GetText();
+		sourceAtom = TextAtom(sourceName);
 	}
 }
 
 void SetVariableMethod::Execute(const ScriptState *state)
 {
-	const Value *source = state->GetValue(sourceName);
+	const Value *source = state->GetValue(sourceAtom);
 	if (source)
 	{
 		const Node *node = GetTargetNode(state);
@@ -1241,14 +1256,14 @@ void SetVariableMethod::Execute(const ScriptState *state)
 				const ScriptObject *object = scriptController->GetScriptObject();
 				if (object)
 				{
-					Value *value = object->GetValue(valueName);
+					Value *value = object->GetValue(valueAtom);
 					if (value)
 					{
 						value->SetValue(source);
 					}
 					else
 					{
-						value = scriptController->GetValue(valueName);
+						value = scriptController->GetValue(valueAtom);
 						if (value)
 						{
 							value->SetValue(source);
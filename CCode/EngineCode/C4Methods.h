@@ -484,6 +484,7 @@ namespace C4
 			ConnectorKey			targetKey;
 
 			ValueName				outputValueName;
+			TextAtom				outputValueAtom;
 			List<Setting>			inputValueList;
 
 			union
@@ -558,9 +559,15 @@ namespace C4
 				return (outputValueName);
 			}
 
+			const TextAtom& GetOutputValueAtom(void) const
+			{
+				return (outputValueAtom);
+			}
+
 			void SetOutputValueName(const char *name)
 			{
 				outputValueName = name;
+				outputValueAtom = TextAtom(outputValueName);
 			}
 
 			Setting *GetFirstInputValue(void) const
@@ -879,6 +886,7 @@ namespace C4
 		private:
 
 			ValueName		valueName;
+			TextAtom		valueAtom;
 
 			GetVariableMethod();
 			GetVariableMethod(const GetVariableMethod& getVariableMethod);
@@ -909,6 +917,8 @@ namespace C4
 
 			ValueName		valueName;
 			ValueName		sourceName;
+			TextAtom		valueAtom;
+			TextAtom		sourceAtom;
 
 			SetVariableMethod();
 			SetVariableMethod(const SetVariableMethod& setVariableMethod);
@@ -31,6 +31,18 @@ namespace
 	};
 
 
+	enum
+	{
+		kVideoSliceBlockRowCount		= 8
+	};
+
+
+	inline int32 GetMaxSliceCount(int32 blockRowCount)
+	{
+		return ((blockRowCount + (kVideoSliceBlockRowCount - 1)) / kVideoSliceBlockRowCount);
+	}
+
+
 	alignas(128) const float blockTransformMatrix[8][8] =
 	{
 		{0.353553F,   0.490393F,   0.461940F,   0.415735F,   0.353553F,   0.277785F,   0.191342F,   0.0975452F},
@@ -118,6 +130,32 @@ namespace C4
 	}; 
 
 	template class Manager<MovieMgr>;
+
+
+	class VideoSliceJob : public BatchJob
+	{
+		public:
+
+			const VideoChannelData		*sliceData;
+			const void					*baseImage;
+			void						*outputImage;
+			int32						rowLength;
+			unsigned_int8				*sliceBuffer;
+			int16						*blockData;
+
+			VideoSliceJob(ExecuteProc *execProc, const VideoChannelData *slice, const void *base, void *image, int32 row, unsigned_int8 *buffer, int16 *block);
+	};
+}
+
+
+VideoSliceJob::VideoSliceJob(ExecuteProc *execProc, const VideoChannelData *slice, const void *base, void *image, int32 row, unsigned_int8 *buffer, int16 *block) : BatchJob(execProc, nullptr, kJobNonpersistent)
+{
+	sliceData = slice;
+	baseImage = base;
+	outputImage = image;
+	rowLength = row;
+	sliceBuffer = buffer;
+	blockData = block;
 }
 
 
@@ -204,7 +242,18 @@ VideoCompressor::VideoCompressor(const VideoTrackHeader *videoTrackHeader)
 		totalCodeSize += luminCodeSize;
 	}
 
-	compressorStorage = new char[totalImageSize * 3 + totalCodeSize * 3 + blockDataSize];
+	if (videoTrackFlags & kVideoSliced)
+	{
+		// Room is needed in the compressed code for the slice table of each channel.
+
+		int32 sliceCount = GetMaxSliceCount(videoFrameSize.y >> 3);
+		totalCodeSize += (sliceCount * 3 * sizeof(VideoChannelData) + 15) & ~15;
+	}
+
+	// The alpha channel is encoded into the same temporary code buffers as the luminance
+	// channel, so only the compressed code needs space for the alpha channel.
+
+	compressorStorage = new char[totalImageSize * 3 + colorCodeSize + totalCodeSize * 2 + blockDataSize];
 
 	luminanceImage[0] = reinterpret_cast<int8 *>(compressorStorage);
 	chrominanceImage[0] = reinterpret_cast<int8 *>(compressorStorage + pixelCount);
@@ -226,14 +275,10 @@ VideoCompressor::VideoCompressor(const VideoTrackHeader *videoTrackHeader)
 	wlenChromCode = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + luminCodeSize + flatChromCodeSize));
 	wavyChromCode = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + luminCodeSize + flatChromCodeSize + wlenChromCodeSize));
 
-	flatAlphaCode = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + colorCodeSize));
-	wlenAlphaCode = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + colorCodeSize + flatLuminCodeSize));
-	wavyAlphaCode = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + colorCodeSize + flatLuminCodeSize + wlenLuminCodeSize));
+	compressedCode[0] = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + colorCodeSize));
+	compressedCode[1] = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + colorCodeSize + totalCodeSize));
 
-	compressedCode[0] = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + totalCodeSize));
-	compressedCode[1] = reinterpret_cast<unsigned_int8 *>(compressorStorage + (totalImageSize + totalCodeSize * 2));
-
-	blockData = reinterpret_cast<int16 *>(compressorStorage + (totalImageSize + totalCodeSize * 3));
+	blockData = reinterpret_cast<int16 *>(compressorStorage + (totalImageSize + colorCodeSize + totalCodeSize * 2));
 }
 
 VideoCompressor::~VideoCompressor()
@@ -1398,438 +1443,348 @@ unsigned_int32 VideoCompressor::EncodeWavyRow(unsigned_int32 count, const int16
 	return ((unsigned_int32) (code - start));
 }
 
-unsigned_int32 VideoCompressor::CompressLuminance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index)
+unsigned_int32 VideoCompressor::CompressChannelCode(const unsigned_int8 *flatCode, unsigned_int32 flatDataSize, const unsigned_int8 *wlenCode, unsigned_int32 wlenDataSize, const unsigned_int8 *wavyCode, unsigned_int32 wavyDataSize, VideoChannelData *channelData, unsigned_int8 *code, unsigned_int32 codeBase)
 {
-	alignas(32) float	quantizeMatrix[8][8];
-	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	lumBlock[8][8];
-
-	Rect *bounds = &videoFrameHeader->luminanceData.channelBoundingRect;
-	bool delta = ((flags & kVideoCompressDeltaFrame) != 0);
-	if (delta)
-	{
-		FindDeltaLuminanceBounds(luminanceImage[2], luminanceImage[baseImageIndex], videoFrameSize, bounds);
-	}
-	else
-	{
-		FindLuminanceBounds(luminanceImage[index], videoFrameSize, bounds);
-	}
-
-	videoFrameHeader->luminanceData.quantizationScale = quantScale;
-
-	float f = 1.0F / quantScale;
-	for (machine j = 0; j < 8; j++)
-	{
-		for (machine i = 0; i < 8; i++)
-		{
-			float m = luminanceQuantizeMatrix[j][i];
-			quantizeMatrix[j][i] = f / m;
-			dequantizeMatrix[j][i] = m * quantScale;
-		}
-	}
-
-	int8 *image = luminanceImage[index];
-	int32 width = videoFrameSize.x;
-	int32 offset = bounds->top * width + bounds->left;
-	image += offset;
-
-	int32 blockCountX = bounds->Width() >> 3;
-	int32 blockCountY = bounds->Height() >> 3;
-
-	int16 *flatData = blockData + blockCountX * 64;
-
-	unsigned_int8 *restrict flatCode = flatLuminCode;
-	unsigned_int8 *restrict wlenCode = wlenLuminCode;
-	unsigned_int8 *restrict wavyCode = wavyLuminCode;
-
-	if (delta)
-	{
-		const int8 *base = luminanceImage[baseImageIndex] + offset;
-
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				LoadDeltaLuminanceBlock(image + i * 8, base + i * 8, lumBlock, width);
-				TransformQuantizeLuminanceBlock(lumBlock, blockData + i * 64, quantizeMatrix);
-				flatData[i] = blockData[i * 64];
-			}
-
-			flatCode += EncodeFlatRow(blockCountX, flatData, flatCode);
-			wavyCode += EncodeWavyRow(blockCountX, blockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
-
-			image += width * 8;
-			base += width * 8;
-		}
-	}
-	else
-	{
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				LoadLuminanceBlock(image + i * 8, lumBlock, width);
-				TransformQuantizeLuminanceBlock(lumBlock, blockData + i * 64, quantizeMatrix);
-				flatData[i] = blockData[i * 64];
-
-				VideoDecompressor::DequantizeInverseTransformLuminanceBlock(blockData + i * 64, lumBlock, dequantizeMatrix);
-				StoreLuminanceBlock(lumBlock, image + i * 8, width);
-			}
-
-			flatCode += EncodeFlatRow(blockCountX, flatData, flatCode);
-			wavyCode += EncodeWavyRow(blockCountX, blockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
-
-			image += width * 8;
-		}
-	}
-
-	unsigned_int32 flatDataSize = (unsigned_int32) (flatCode - flatLuminCode);
-	unsigned_int32 wlenDataSize = blockCountX * blockCountY;
-	unsigned_int32 wavyDataSize = (unsigned_int32) (wavyCode - wavyLuminCode);
-
 	unsigned_int8 flatCompression = kVideoCompressionGeneral;
 	unsigned_int8 wlenCompression = kVideoCompressionGeneral;
 	unsigned_int8 wavyCompression = kVideoCompressionGeneral;
 
-	unsigned_int8 *code = compressedCode[delta];
-
-	unsigned_int32 flatCodeSize = Comp::CompressData(flatLuminCode, flatDataSize, code);
+	unsigned_int32 flatCodeSize = Comp::CompressData(flatCode, flatDataSize, code);
 	if (flatCodeSize == 0)
 	{
-		MemoryMgr::CopyMemory(flatLuminCode, code, flatDataSize);
+		MemoryMgr::CopyMemory(flatCode, code, flatDataSize);
 		flatCompression = kVideoCompressionNone;
 		flatCodeSize = flatDataSize;
 	}
 
-	unsigned_int32 wlenCodeSize = Comp::CompressData(wlenLuminCode, wlenDataSize, code + flatCodeSize);
+	unsigned_int32 wlenCodeSize = Comp::CompressData(wlenCode, wlenDataSize, code + flatCodeSize);
 	if (wlenCodeSize == 0)
 	{
-		MemoryMgr::CopyMemory(wlenLuminCode, code + flatCodeSize, wlenDataSize);
+		MemoryMgr::CopyMemory(wlenCode, code + flatCodeSize, wlenDataSize);
 		wlenCompression = kVideoCompressionNone;
 		wlenCodeSize = wlenDataSize;
 	}
 
-	unsigned_int32 wavyCodeSize = Comp::CompressData(wavyLuminCode, wavyDataSize, code + (flatCodeSize + wlenCodeSize));
+	unsigned_int32 wavyCodeSize = Comp::CompressData(wavyCode, wavyDataSize, code + (flatCodeSize + wlenCodeSize));
 	if (wavyCodeSize == 0)
 	{
-		MemoryMgr::CopyMemory(wavyLuminCode, code + (flatCodeSize + wlenCodeSize), wavyDataSize);
+		MemoryMgr::CopyMemory(wavyCode, code + (flatCodeSize + wlenCodeSize), wavyDataSize);
 		wavyCompression = kVideoCompressionNone;
 		wavyCodeSize = wavyDataSize;
 	}
 
-	videoFrameHeader->luminanceData.videoChannelFlags = flatCompression | (wlenCompression << 4) | (wavyCompression << 8);
+	channelData->videoChannelFlags = flatCompression | (wlenCompression << 4) | (wavyCompression << 8);
 
-	videoFrameHeader->luminanceData.flatCodeOffset = sizeof(VideoFrameHeader);
-	videoFrameHeader->luminanceData.flatCodeSize = flatCodeSize;
-	videoFrameHeader->luminanceData.flatDataSize = flatDataSize;
+	channelData->flatCodeOffset = codeBase;
+	channelData->flatCodeSize = flatCodeSize;
+	channelData->flatDataSize = flatDataSize;
 
-	videoFrameHeader->luminanceData.wlenCodeOffset = sizeof(VideoFrameHeader) + flatCodeSize;
-	videoFrameHeader->luminanceData.wlenCodeSize = wlenCodeSize;
-	videoFrameHeader->luminanceData.wlenDataSize = wlenDataSize;
+	channelData->wlenCodeOffset = codeBase + flatCodeSize;
+	channelData->wlenCodeSize = wlenCodeSize;
+	channelData->wlenDataSize = wlenDataSize;
 
-	videoFrameHeader->luminanceData.wavyCodeOffset = sizeof(VideoFrameHeader) + flatCodeSize + wlenCodeSize;
-	videoFrameHeader->luminanceData.wavyCodeSize = wavyCodeSize;
-	videoFrameHeader->luminanceData.wavyDataSize = wavyDataSize;
+	channelData->wavyCodeOffset = codeBase + flatCodeSize + wlenCodeSize;
+	channelData->wavyCodeSize = wavyCodeSize;
+	channelData->wavyDataSize = wavyDataSize;
 
 	return (flatCodeSize + wlenCodeSize + wavyCodeSize);
 }
 
-unsigned_int32 VideoCompressor::CompressChrominance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset)
+void VideoCompressor::SetSliceTable(VideoChannelData *channelData, const VideoChannelData *sliceData, int32 sliceCount, unsigned_int32 codeBase)
+{
+	unsigned_int32 flatDataSize = 0;
+	unsigned_int32 wlenDataSize = 0;
+	unsigned_int32 wavyDataSize = 0;
+
+	for (machine a = 0; a < sliceCount; a++)
+	{
+		flatDataSize += sliceData[a].flatDataSize;
+		wlenDataSize += sliceData[a].wlenDataSize;
+		wavyDataSize += sliceData[a].wavyDataSize;
+	}
+
+	channelData->videoChannelFlags = 0;
+
+	channelData->flatCodeOffset = codeBase;
+	channelData->flatCodeSize = sliceCount * sizeof(VideoChannelData);
+	channelData->flatDataSize = flatDataSize;
+
+	channelData->wlenCodeOffset = codeBase;
+	channelData->wlenCodeSize = 0;
+	channelData->wlenDataSize = wlenDataSize;
+
+	channelData->wavyCodeOffset = codeBase;
+	channelData->wavyCodeSize = 0;
+	channelData->wavyDataSize = wavyDataSize;
+}
+
+unsigned_int32 VideoCompressor::CompressLuminanceChannel(int8 *const *channelImage, VideoChannelData *channelData, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset, unsigned_int32 codeBase)
 {
 	alignas(32) float	quantizeMatrix[8][8];
 	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	blueBlock[8][8];
-	alignas(32) float	redBlock[8][8];
+	alignas(32) float	lumBlock[8][8];
 
-	Rect *bounds = &videoFrameHeader->chrominanceData.channelBoundingRect;
+	Rect *bounds = &channelData->channelBoundingRect;
 	bool delta = ((flags & kVideoCompressDeltaFrame) != 0);
 	if (delta)
 	{
-		FindDeltaChrominanceBounds(chrominanceImage[2], chrominanceImage[baseImageIndex], videoFrameSize, bounds);
+		FindDeltaLuminanceBounds(channelImage[2], channelImage[baseImageIndex], videoFrameSize, bounds);
 	}
 	else
 	{
-		FindChrominanceBounds(chrominanceImage[index], videoFrameSize, bounds);
+		FindLuminanceBounds(channelImage[index], videoFrameSize, bounds);
 	}
 
-	videoFrameHeader->chrominanceData.quantizationScale = quantScale;
+	channelData->quantizationScale = quantScale;
 
 	float f = 1.0F / quantScale;
 	for (machine j = 0; j < 8; j++)
 	{
 		for (machine i = 0; i < 8; i++)
 		{
-			float m = chrominanceQuantizeMatrix[j][i];
+			float m = luminanceQuantizeMatrix[j][i];
 			quantizeMatrix[j][i] = f / m;
 			dequantizeMatrix[j][i] = m * quantScale;
 		}
 	}
 
-	int8 *image = chrominanceImage[index];
-	int32 width = videoFrameSize.x >> 1;
-	int32 offset = (bounds->top * width + bounds->left) * 2;
+	int8 *image = channelImage[index];
+	int32 width = videoFrameSize.x;
+	int32 offset = bounds->top * width + bounds->left;
 	image += offset;
 
+	const int8 *base = (delta) ? channelImage[baseImageIndex] + offset : nullptr;
+
 	int32 blockCountX = bounds->Width() >> 3;
 	int32 blockCountY = bounds->Height() >> 3;
 
-	int16 *blueBlockData = blockData;
-	int16 *redBlockData = blueBlockData + blockCountX * 64;
-	int16 *blueFlatData = redBlockData + blockCountX * 64;
-	int16 *redFlatData = blueFlatData + blockCountX;
+	int16 *flatData = blockData + blockCountX * 64;
 
-	unsigned_int8 *restrict flatCode = flatChromCode;
-	unsigned_int8 *restrict wlenCode = wlenChromCode;
-	unsigned_int8 *restrict wavyCode = wavyChromCode;
+	unsigned_int8 *code = compressedCode[delta] + codeOffset;
+	unsigned_int32 codeSize = 0;
 
-	if (delta)
-	{
-		const int8 *base = chrominanceImage[baseImageIndex] + offset;
+	// An unsliced channel is encoded as a single slice whose data is stored in the channel itself.
+	// A sliced channel begins with the slice table, and the code for each slice follows the table.
 
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				LoadDeltaChrominanceBlock(image + i * 16, base + i * 16, blueBlock, redBlock, width);
-				TransformQuantizeChrominanceBlock(blueBlock, redBlock, blueBlockData + i * 64, redBlockData + i * 64, quantizeMatrix);
-				blueFlatData[i] = blueBlockData[i * 64];
-				redFlatData[i] = redBlockData[i * 64];
-			}
+	VideoChannelData *sliceData = channelData;
+	int32 sliceRowCount = blockCountY;
+	int32 sliceCount = 1;
 
-			flatCode += EncodeFlatRow(blockCountX, blueFlatData, flatCode);
-			flatCode += EncodeFlatRow(blockCountX, redFlatData, flatCode);
+	bool sliced = ((videoTrackFlags & kVideoSliced) != 0);
+	if (sliced)
+	{
+		sliceData = reinterpret_cast<VideoChannelData *>(code);
+		sliceRowCount = kVideoSliceBlockRowCount;
+		sliceCount = GetMaxSliceCount(blockCountY);
+		codeSize = sliceCount * sizeof(VideoChannelData);
+	}
 
-			wavyCode += EncodeWavyRow(blockCountX, blueBlockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
+	for (machine k = 0; k < sliceCount; k++)
+	{
+		int32 rowCount = Min(blockCountY - k * sliceRowCount, sliceRowCount);
 
-			wavyCode += EncodeWavyRow(blockCountX, redBlockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
+		unsigned_int8 *restrict flatCode = flatLuminCode;
+		unsigned_int8 *restrict wlenCode = wlenLuminCode;
+		unsigned_int8 *restrict wavyCode = wavyLuminCode;
 
-			image += width * 16;
-			base += width * 16;
-		}
-	}
-	else
-	{
-		for (machine j = 0; j < blockCountY; j++)
+		for (machine j = 0; j < rowCount; j++)
 		{
-			for (machine i = 0; i < blockCountX; i++)
+			if (delta)
 			{
-				LoadChrominanceBlock(image + i * 16, blueBlock, redBlock, width);
-				TransformQuantizeChrominanceBlock(blueBlock, redBlock, blueBlockData + i * 64, redBlockData + i * 64, quantizeMatrix);
-				blueFlatData[i] = blueBlockData[i * 64];
-				redFlatData[i] = redBlockData[i * 64];
+				for (machine i = 0; i < blockCountX; i++)
+				{
+					LoadDeltaLuminanceBlock(image + i * 8, base + i * 8, lumBlock, width);
+					TransformQuantizeLuminanceBlock(lumBlock, blockData + i * 64, quantizeMatrix);
+					flatData[i] = blockData[i * 64];
+				}
 
-				VideoDecompressor::DequantizeInverseTransformChrominanceBlock(blueBlockData + i * 64, redBlockData + i * 64, blueBlock, redBlock, dequantizeMatrix);
-				StoreChrominanceBlock(blueBlock, redBlock, image + i * 16, width);
+				base += width * 8;
 			}
+			else
+			{
+				for (machine i = 0; i < blockCountX; i++)
+				{
+					LoadLuminanceBlock(image + i * 8, lumBlock, width);
+					TransformQuantizeLuminanceBlock(lumBlock, blockData + i * 64, quantizeMatrix);
+					flatData[i] = blockData[i * 64];
 
-			flatCode += EncodeFlatRow(blockCountX, blueFlatData, flatCode);
-			flatCode += EncodeFlatRow(blockCountX, redFlatData, flatCode);
-
-			wavyCode += EncodeWavyRow(blockCountX, blueBlockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
+					VideoDecompressor::DequantizeInverseTransformLuminanceBlock(blockData + i * 64, lumBlock, dequantizeMatrix);
+					StoreLuminanceBlock(lumBlock, image + i * 8, width);
+				}
+			}
 
-			wavyCode += EncodeWavyRow(blockCountX, redBlockData, wlenCode, wavyCode);
+			flatCode += EncodeFlatRow(blockCountX, flatData, flatCode);
+			wavyCode += EncodeWavyRow(blockCountX, blockData, wlenCode, wavyCode);
 			wlenCode += blockCountX;
 
-			image += width * 16;
+			image += width * 8;
 		}
-	}
 
-	unsigned_int32 flatDataSize = (unsigned_int32) (flatCode - flatChromCode);
-	unsigned_int32 wlenDataSize = blockCountX * blockCountY * 2;
-	unsigned_int32 wavyDataSize = (unsigned_int32) (wavyCode - wavyChromCode);
+		VideoChannelData *data = &sliceData[k];
+		unsigned_int32 sliceBase = codeBase + codeSize;
 
-	unsigned_int8 flatCompression = kVideoCompressionGeneral;
-	unsigned_int8 wlenCompression = kVideoCompressionGeneral;
-	unsigned_int8 wavyCompression = kVideoCompressionGeneral;
-
-	unsigned_int8 *code = compressedCode[delta] + codeOffset;
-
-	unsigned_int32 flatCodeSize = Comp::CompressData(flatChromCode, flatDataSize, code);
-	if (flatCodeSize == 0)
-	{
-		MemoryMgr::CopyMemory(flatChromCode, code, flatDataSize);
-		flatCompression = kVideoCompressionNone;
-		flatCodeSize = flatDataSize;
-	}
+		if (sliced)
+		{
+			int32 top = bounds->top + k * (sliceRowCount * 8);
+			data->channelBoundingRect.Set(bounds->left, top, bounds->right, top + rowCount * 8);
+			data->quantizationScale = quantScale;
+			sliceBase = codeSize - k * sizeof(VideoChannelData);
+		}
 
-	unsigned_int32 wlenCodeSize = Comp::CompressData(wlenChromCode, wlenDataSize, code + flatCodeSize);
-	if (wlenCodeSize == 0)
-	{
-		MemoryMgr::CopyMemory(wlenChromCode, code + flatCodeSize, wlenDataSize);
-		wlenCompression = kVideoCompressionNone;
-		wlenCodeSize = wlenDataSize;
+		codeSize += CompressChannelCode(flatLuminCode, (unsigned_int32) (flatCode - flatLuminCode), wlenLuminCode, blockCountX * rowCount, wavyLuminCode, (unsigned_int32) (wavyCode - wavyLuminCode), data, code + codeSize, sliceBase);
 	}
 
-	unsigned_int32 wavyCodeSize = Comp::CompressData(wavyChromCode, wavyDataSize, code + (flatCodeSize + wlenCodeSize));
-	if (wavyCodeSize == 0)
+	if (sliced)
 	{
-		MemoryMgr::CopyMemory(wavyChromCode, code + (flatCodeSize + wlenCodeSize), wavyDataSize);
-		wavyCompression = kVideoCompressionNone;
-		wavyCodeSize = wavyDataSize;
+		SetSliceTable(channelData, sliceData, sliceCount, codeBase);
 	}
 
-	videoFrameHeader->chrominanceData.videoChannelFlags = flatCompression | (wlenCompression << 4) | (wavyCompression << 8);
-
-	unsigned_int32 codeBase = sizeof(VideoFrameHeader) - sizeof(VideoChannelData) + codeOffset;
-
-	videoFrameHeader->chrominanceData.flatCodeOffset = codeBase;
-	videoFrameHeader->chrominanceData.flatCodeSize = flatCodeSize;
-	videoFrameHeader->chrominanceData.flatDataSize = flatDataSize;
-
-	videoFrameHeader->chrominanceData.wlenCodeOffset = codeBase + flatCodeSize;
-	videoFrameHeader->chrominanceData.wlenCodeSize = wlenCodeSize;
-	videoFrameHeader->chrominanceData.wlenDataSize = wlenDataSize;
-
-	videoFrameHeader->chrominanceData.wavyCodeOffset = codeBase + flatCodeSize + wlenCodeSize;
-	videoFrameHeader->chrominanceData.wavyCodeSize = wavyCodeSize;
-	videoFrameHeader->chrominanceData.wavyDataSize = wavyDataSize;
+	return (codeSize);
+}
 
-	return (flatCodeSize + wlenCodeSize + wavyCodeSize);
+unsigned_int32 VideoCompressor::CompressLuminance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index)
+{
+	return (CompressLuminanceChannel(luminanceImage, &videoFrameHeader->luminanceData, quantScale, flags, index, 0, sizeof(VideoFrameHeader)));
 }
 
-unsigned_int32 VideoCompressor::CompressAlpha(VideoAlphaFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset)
+unsigned_int32 VideoCompressor::CompressChrominance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset)
 {
 	alignas(32) float	quantizeMatrix[8][8];
 	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	alphaBlock[8][8];
+	alignas(32) float	blueBlock[8][8];
+	alignas(32) float	redBlock[8][8];
 
-	Rect *bounds = &videoFrameHeader->alphaData.channelBoundingRect;
+	VideoChannelData *chrominanceData = &videoFrameHeader->chrominanceData;
+
+	Rect *bounds = &chrominanceData->channelBoundingRect;
 	bool delta = ((flags & kVideoCompressDeltaFrame) != 0);
 	if (delta)
 	{
-		FindDeltaLuminanceBounds(alphaImage[2], alphaImage[baseImageIndex], videoFrameSize, bounds);
+		FindDeltaChrominanceBounds(chrominanceImage[2], chrominanceImage[baseImageIndex], videoFrameSize, bounds);
 	}
 	else
 	{
-		FindLuminanceBounds(alphaImage[index], videoFrameSize, bounds);
+		FindChrominanceBounds(chrominanceImage[index], videoFrameSize, bounds);
 	}
 
-	videoFrameHeader->alphaData.quantizationScale = quantScale;
+	chrominanceData->quantizationScale = quantScale;
 
 	float f = 1.0F / quantScale;
 	for (machine j = 0; j < 8; j++)
 	{
 		for (machine i = 0; i < 8; i++)
 		{
-			float m = luminanceQuantizeMatrix[j][i];
+			float m = chrominanceQuantizeMatrix[j][i];
 			quantizeMatrix[j][i] = f / m;
 			dequantizeMatrix[j][i] = m * quantScale;
 		}
 	}
 
-	int8 *image = alphaImage[index];
-	int32 width = videoFrameSize.x;
-	int32 offset = bounds->top * width + bounds->left;
+	int8 *image = chrominanceImage[index];
+	int32 width = videoFrameSize.x >> 1;
+	int32 offset = (bounds->top * width + bounds->left) * 2;
 	image += offset;
 
+	const int8 *base = (delta) ? chrominanceImage[baseImageIndex] + offset : nullptr;
+
 	int32 blockCountX = bounds->Width() >> 3;
 	int32 blockCountY = bounds->Height() >> 3;
 
-	int16 *flatData = blockData + blockCountX * 64;
+	int16 *blueBlockData = blockData;
+	int16 *redBlockData = blueBlockData + blockCountX * 64;
+	int16 *blueFlatData = redBlockData + blockCountX * 64;
+	int16 *redFlatData = blueFlatData + blockCountX;
 
-	unsigned_int8 *restrict flatCode = flatAlphaCode;
-	unsigned_int8 *restrict wlenCode = wlenAlphaCode;
-	unsigned_int8 *restrict wavyCode = wavyAlphaCode;
+	unsigned_int8 *code = compressedCode[delta] + codeOffset;
+	unsigned_int32 codeBase = sizeof(VideoFrameHeader) - sizeof(VideoChannelData) + codeOffset;
+	unsigned_int32 codeSize = 0;
 
-	if (delta)
+	VideoChannelData *sliceData = chrominanceData;
+	int32 sliceRowCount = blockCountY;
+	int32 sliceCount = 1;
+
+	bool sliced = ((videoTrackFlags & kVideoSliced) != 0);
+	if (sliced)
 	{
-		const int8 *base = alphaImage[baseImageIndex] + offset;
+		sliceData = reinterpret_cast<VideoChannelData *>(code);
+		sliceRowCount = kVideoSliceBlockRowCount;
+		sliceCount = GetMaxSliceCount(blockCountY);
+		codeSize = sliceCount * sizeof(VideoChannelData);
+	}
 
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				LoadDeltaLuminanceBlock(image + i * 8, base + i * 8, alphaBlock, width);
-				TransformQuantizeLuminanceBlock(alphaBlock, blockData + i * 64, quantizeMatrix);
-				flatData[i] = blockData[i * 64];
-			}
+	for (machine k = 0; k < sliceCount; k++)
+	{
+		int32 rowCount = Min(blockCountY - k * sliceRowCount, sliceRowCount);
 
-			flatCode += EncodeFlatRow(blockCountX, flatData, flatCode);
-			wavyCode += EncodeWavyRow(blockCountX, blockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
+		unsigned_int8 *restrict flatCode = flatChromCode;
+		unsigned_int8 *restrict wlenCode = wlenChromCode;
+		unsigned_int8 *restrict wavyCode = wavyChromCode;
 
-			image += width * 8;
-			base += width * 8;
-		}
-	}
-	else
-	{
-		for (machine j = 0; j < blockCountY; j++)
+		for (machine j = 0; j < rowCount; j++)
 		{
-			for (machine i = 0; i < blockCountX; i++)
+			if (delta)
 			{
-				LoadLuminanceBlock(image + i * 8, alphaBlock, width);
-				TransformQuantizeLuminanceBlock(alphaBlock, blockData + i * 64, quantizeMatrix);
-				flatData[i] = blockData[i * 64];
+				for (machine i = 0; i < blockCountX; i++)
+				{
+					LoadDeltaChrominanceBlock(image + i * 16, base + i * 16, blueBlock, redBlock, width);
+					TransformQuantizeChrominanceBlock(blueBlock, redBlock, blueBlockData + i * 64, redBlockData + i * 64, quantizeMatrix);
+					blueFlatData[i] = blueBlockData[i * 64];
+					redFlatData[i] = redBlockData[i * 64];
+				}
 
-				VideoDecompressor::DequantizeInverseTransformLuminanceBlock(blockData + i * 64, alphaBlock, dequantizeMatrix);
-				StoreLuminanceBlock(alphaBlock, image + i * 8, width);
+				base += width * 16;
 			}
+			else
+			{
+				for (machine i = 0; i < blockCountX; i++)
+				{
+					LoadChrominanceBlock(image + i * 16, blueBlock, redBlock, width);
+					TransformQuantizeChrominanceBlock(blueBlock, redBlock, blueBlockData + i * 64, redBlockData + i * 64, quantizeMatrix);
+					blueFlatData[i] = blueBlockData[i * 64];
+					redFlatData[i] = redBlockData[i * 64];
 
-			flatCode += EncodeFlatRow(blockCountX, flatData, flatCode);
-			wavyCode += EncodeWavyRow(blockCountX, blockData, wlenCode, wavyCode);
-			wlenCode += blockCountX;
+					VideoDecompressor::DequantizeInverseTransformChrominanceBlock(blueBlockData + i * 64, redBlockData + i * 64, blueBlock, redBlock, dequantizeMatrix);
+					StoreChrominanceBlock(blueBlock, redBlock, image + i * 16, width);
+				}
+			}
 
-			image += width * 8;
-		}
-	}
+			flatCode += EncodeFlatRow(blockCountX, blueFlatData, flatCode);
+			flatCode += EncodeFlatRow(blockCountX, redFlatData, flatCode);
 
-	unsigned_int32 flatDataSize = (unsigned_int32) (flatCode - flatAlphaCode);
-	unsigned_int32 wlenDataSize = blockCountX * blockCountY;
-	unsigned_int32 wavyDataSize = (unsigned_int32) (wavyCode - wavyAlphaCode);
+			wavyCode += EncodeWavyRow(blockCountX, blueBlockData, wlenCode, wavyCode);
+			wlenCode += blockCountX;
 
-	unsigned_int8 flatCompression = kVideoCompressionGeneral;
-	unsigned_int8 wlenCompression = kVideoCompressionGeneral;
-	unsigned_int8 wavyCompression = kVideoCompressionGeneral;
+			wavyCode += EncodeWavyRow(blockCountX, redBlockData, wlenCode, wavyCode);
+			wlenCode += blockCountX;
 
-	unsigned_int8 *code = compressedCode[delta] + codeOffset;
+			image += width * 16;
+		}
 
-	unsigned_int32 flatCodeSize = Comp::CompressData(flatAlphaCode, flatDataSize, code);
-	if (flatCodeSize == 0)
-	{
-		MemoryMgr::CopyMemory(flatAlphaCode, code, flatDataSize);
-		flatCompression = kVideoCompressionNone;
-		flatCodeSize = flatDataSize;
-	}
+		VideoChannelData *data = &sliceData[k];
+		unsigned_int32 sliceBase = codeBase + codeSize;
 
-	unsigned_int32 wlenCodeSize = Comp::CompressData(wlenAlphaCode, wlenDataSize, code + flatCodeSize);
-	if (wlenCodeSize == 0)
-	{
-		MemoryMgr::CopyMemory(wlenAlphaCode, code + flatCodeSize, wlenDataSize);
-		wlenCompression = kVideoCompressionNone;
-		wlenCodeSize = wlenDataSize;
+		if (sliced)
+		{
+			int32 top = bounds->top + k * (sliceRowCount * 8);
+			data->channelBoundingRect.Set(bounds->left, top, bounds->right, top + rowCount * 8);
+			data->quantizationScale = quantScale;
+			sliceBase = codeSize - k * sizeof(VideoChannelData);
+		}
+
+		codeSize += CompressChannelCode(flatChromCode, (unsigned_int32) (flatCode - flatChromCode), wlenChromCode, blockCountX * rowCount * 2, wavyChromCode, (unsigned_int32) (wavyCode - wavyChromCode), data, code + codeSize, sliceBase);
 	}
 
-	unsigned_int32 wavyCodeSize = Comp::CompressData(wavyAlphaCode, wavyDataSize, code + (flatCodeSize + wlenCodeSize));
-	if (wavyCodeSize == 0)
+	if (sliced)
 	{
-		MemoryMgr::CopyMemory(wavyAlphaCode, code + (flatCodeSize + wlenCodeSize), wavyDataSize);
-		wavyCompression = kVideoCompressionNone;
-		wavyCodeSize = wavyDataSize;
+		SetSliceTable(chrominanceData, sliceData, sliceCount, codeBase);
 	}
 
-	videoFrameHeader->alphaData.videoChannelFlags = flatCompression | (wlenCompression << 4) | (wavyCompression << 8);
-
-	unsigned_int32 codeBase = sizeof(VideoAlphaFrameHeader) - sizeof(VideoChannelData) * 2 + codeOffset;
-
-	videoFrameHeader->alphaData.flatCodeOffset = codeBase;
-	videoFrameHeader->alphaData.flatCodeSize = flatCodeSize;
-	videoFrameHeader->alphaData.flatDataSize = flatDataSize;
-
-	videoFrameHeader->alphaData.wlenCodeOffset = codeBase + flatCodeSize;
-	videoFrameHeader->alphaData.wlenCodeSize = wlenCodeSize;
-	videoFrameHeader->alphaData.wlenDataSize = wlenDataSize;
-
-	videoFrameHeader->alphaData.wavyCodeOffset = codeBase + flatCodeSize + wlenCodeSize;
-	videoFrameHeader->alphaData.wavyCodeSize = wavyCodeSize;
-	videoFrameHeader->alphaData.wavyDataSize = wavyDataSize;
+	return (codeSize);
+}
 
-	return (flatCodeSize + wlenCodeSize + wavyCodeSize);
+unsigned_int32 VideoCompressor::CompressAlpha(VideoAlphaFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset)
+{
+	return (CompressLuminanceChannel(alphaImage, &videoFrameHeader->alphaData, quantScale, flags, index, codeOffset, sizeof(VideoAlphaFrameHeader) - sizeof(VideoChannelData) * 2 + codeOffset));
 }
 
 unsigned_int32 VideoCompressor::CompressFrame(const void *image, ImageFormat format, VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags)
@@ -1898,6 +1853,7 @@ unsigned_int32 VideoCompressor::CompressFrame(const void *image, ImageFormat for
 
 VideoDecompressor::VideoDecompressor(const VideoTrackHeader *videoTrackHeader)
 {
+	videoTrackFlags = videoTrackHeader->videoTrackFlags;
 	videoFrameSize = videoTrackHeader->videoFrameSize;
 
 	int32 width = videoFrameSize.x;
@@ -1911,6 +1867,29 @@ VideoDecompressor::VideoDecompressor(const VideoTrackHeader *videoTrackHeader)
 	}
 
 	unsigned_int32 blockDataSize = (width >> 3) * 130;
+	sliceBlockDataSize = 0;
+
+	maxSliceCount[0] = 0;
+	maxSliceCount[1] = 0;
+	maxSliceCount[2] = 0;
+
+	if (videoTrackFlags & kVideoSliced)
+	{
+		// Every slice that can appear in a frame gets its own block data so that
+		// all of the slices can be decoded on different threads at the same time.
+
+		sliceBlockDataSize = (blockDataSize + 15) & ~15;
+
+		maxSliceCount[0] = GetMaxSliceCount(height >> 3);
+		maxSliceCount[1] = GetMaxSliceCount(height >> 4);
+		if (videoTrackFlags & kVideoAlphaChannel)
+		{
+			maxSliceCount[2] = maxSliceCount[0];
+		}
+
+		blockDataSize = sliceBlockDataSize * (maxSliceCount[0] + maxSliceCount[1] + maxSliceCount[2]);
+	}
+
 	decompressorStorage = new char[imageSize + videoTrackHeader->maxFrameCodeSize + videoTrackHeader->maxFrameDataSize + blockDataSize];
 
 	luminanceImage[0] = reinterpret_cast<Color1C *>(decompressorStorage);
@@ -1924,6 +1903,10 @@ VideoDecompressor::VideoDecompressor(const VideoTrackHeader *videoTrackHeader)
 	videoFrameData = reinterpret_cast<unsigned_int8 *>(decompressorStorage + (imageSize + videoTrackHeader->maxFrameCodeSize));
 
 	blockData = reinterpret_cast<int16 *>(videoFrameData + videoTrackHeader->maxFrameDataSize);
+
+	sliceBlockData[0] = blockData;
+	sliceBlockData[1] = reinterpret_cast<int16 *>(reinterpret_cast<char *>(blockData) + sliceBlockDataSize * maxSliceCount[0]);
+	sliceBlockData[2] = reinterpret_cast<int16 *>(reinterpret_cast<char *>(sliceBlockData[1]) + sliceBlockDataSize * maxSliceCount[1]);
 }
 
 VideoDecompressor::~VideoDecompressor()
@@ -3002,74 +2985,60 @@ void VideoDecompressor::CopyChrominance(const Color2C *base, Color2C *restrict i
 	}
 }
 
-void VideoDecompressor::DecompressLuminance(bool delta)
+void VideoDecompressor::DecompressChannelCode(const VideoChannelData *channelData, unsigned_int8 *buffer, const unsigned_int8 **flatCode, const unsigned_int8 **wlenCode, const unsigned_int8 **wavyCode)
 {
-	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	lumBlock[8][8];
-	const Color1C		*base;
-
-	const VideoChannelData *luminanceData = &videoFrameHeader->luminanceData;
-
-	const unsigned_int8 *flatCode = videoFrameData;
-	const unsigned_int8 *wlenCode = flatCode + luminanceData->flatDataSize;
-	const unsigned_int8 *wavyCode = wlenCode + luminanceData->wlenDataSize;
-
-	unsigned_int32 flags = luminanceData->videoChannelFlags;
+	unsigned_int32 flags = channelData->videoChannelFlags;
 
 	if ((flags & 0x000F) == kVideoCompressionGeneral)
 	{
-		Comp::DecompressData(luminanceData->GetFlatCode(), luminanceData->flatCodeSize, const_cast<unsigned_int8 *>(flatCode));
+		Comp::DecompressData(channelData->GetFlatCode(), channelData->flatCodeSize, buffer);
+		*flatCode = buffer;
 	}
 	else
 	{
-		flatCode = luminanceData->GetFlatCode();
+		*flatCode = channelData->GetFlatCode();
 	}
 
+	buffer += channelData->flatDataSize;
+
 	if (((flags >> 4) & 0x000F) == kVideoCompressionGeneral)
 	{
-		Comp::DecompressData(luminanceData->GetWlenCode(), luminanceData->wlenCodeSize, const_cast<unsigned_int8 *>(wlenCode));
+		Comp::DecompressData(channelData->GetWlenCode(), channelData->wlenCodeSize, buffer);
+		*wlenCode = buffer;
 	}
 	else
 	{
-		wlenCode = luminanceData->GetWlenCode();
+		*wlenCode = channelData->GetWlenCode();
 	}
 
+	buffer += channelData->wlenDataSize;
+
 	if (((flags >> 8) & 0x000F) == kVideoCompressionGeneral)
 	{
-		Comp::DecompressData(luminanceData->GetWavyCode(), luminanceData->wavyCodeSize, const_cast<unsigned_int8 *>(wavyCode));
+		Comp::DecompressData(channelData->GetWavyCode(), channelData->wavyCodeSize, buffer);
+		*wavyCode = buffer;
 	}
 	else
 	{
-		wavyCode = luminanceData->GetWavyCode();
+		*wavyCode = channelData->GetWavyCode();
 	}
+}
 
-	int32 width = videoFrameSize.x;
-	int32 height = videoFrameSize.y;
-
-	Color1C *restrict image = luminanceImage[delta];
-	const Rect& bounds = luminanceData->channelBoundingRect;
-	int32 offset = bounds.top * width + bounds.left;
+void VideoDecompressor::DecodeLuminanceSlice(const VideoChannelData *sliceData, const Color1C *base, Color1C *restrict image, int32 rowLength, unsigned_int8 *buffer, int16 *blockData)
+{
+	alignas(32) float		dequantizeMatrix[8][8];
+	alignas(32) float		lumBlock[8][8];
+	const unsigned_int8		*flatCode;
+	const unsigned_int8		*wlenCode;
+	const unsigned_int8		*wavyCode;
 
-	if (delta)
-	{
-		base = luminanceImage[0];
-		CopyLuminance(base, image, width, Rect(0, 0, width, bounds.top));
-		CopyLuminance(base, image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
-		CopyLuminance(base, image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		CopyLuminance(base, image, width, Rect(0, bounds.top, width, height));
-		base += offset;
-	}
-	else
-	{
-		ClearLuminance(image, width, Rect(0, 0, width, bounds.top));
-		ClearLuminance(image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
-		ClearLuminance(image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		ClearLuminance(image, width, Rect(0, bounds.top, width, height));
-	}
+	DecompressChannelCode(sliceData, buffer, &flatCode, &wlenCode, &wavyCode);
 
+	const Rect& bounds = sliceData->channelBoundingRect;
+	int32 offset = bounds.top * rowLength + bounds.left;
 	image += offset;
 
-	float scale = luminanceData->quantizationScale;
+	float scale = sliceData->quantizationScale;
 	for (machine j = 0; j < 8; j++)
 	{
 		for (machine i = 0; i < 8; i++)
@@ -3083,8 +3052,10 @@ void VideoDecompressor::DecompressLuminance(bool delta)
 
 	int16 *flatData = blockData + blockCountX * 64;
 
-	if (delta)
+	if (base)
 	{
+		base += offset;
+
 		for (machine j = 0; j < blockCountY; j++)
 		{
 			flatCode += DecodeFlatRow(blockCountX, flatCode, flatData);
@@ -3095,11 +3066,11 @@ void VideoDecompressor::DecompressLuminance(bool delta)
 			{
 				blockData[i * 64] = flatData[i];
 				DequantizeInverseTransformLuminanceBlock(blockData + i * 64, lumBlock, dequantizeMatrix);
-				StoreDeltaLuminanceBlock(lumBlock, base + i * 8, image + i * 8, width);
+				StoreDeltaLuminanceBlock(lumBlock, base + i * 8, image + i * 8, rowLength);
 			}
 
-			base += width * 8;
-			image += width * 8;
+			base += rowLength * 8;
+			image += rowLength * 8;
 		}
 	}
 	else
@@ -3114,83 +3085,30 @@ void VideoDecompressor::DecompressLuminance(bool delta)
 			{
 				blockData[i * 64] = flatData[i];
 				DequantizeInverseTransformLuminanceBlock(blockData + i * 64, lumBlock, dequantizeMatrix);
-				StoreLuminanceBlock(lumBlock, image + i * 8, width);
+				StoreLuminanceBlock(lumBlock, image + i * 8, rowLength);
 			}
 
-			image += width * 8;
+			image += rowLength * 8;
 		}
 	}
 }
 
-void VideoDecompressor::DecompressChrominance(bool delta)
+void VideoDecompressor::DecodeChrominanceSlice(const VideoChannelData *sliceData, const Color2C *base, Color2C *restrict image, int32 rowLength, unsigned_int8 *buffer, int16 *blockData)
 {
-	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	blueBlock[8][8];
-	alignas(32) float	redBlock[8][8];
-	const Color2C		*base;
-
-	const VideoChannelData *chrominanceData = &videoFrameHeader->chrominanceData;
+	alignas(32) float		dequantizeMatrix[8][8];
+	alignas(32) float		blueBlock[8][8];
+	alignas(32) float		redBlock[8][8];
+	const unsigned_int8		*flatCode;
+	const unsigned_int8		*wlenCode;
+	const unsigned_int8		*wavyCode;
 
-	const unsigned_int8 *flatCode = videoFrameData;
-	const unsigned_int8 *wlenCode = flatCode + chrominanceData->flatDataSize;
-	const unsigned_int8 *wavyCode = wlenCode + chrominanceData->wlenDataSize;
-
-	unsigned_int32 flags = chrominanceData->videoChannelFlags;
-
-	if ((flags & 0x000F) == kVideoCompressionGeneral)
-	{
-		Comp::DecompressData(chrominanceData->GetFlatCode(), chrominanceData->flatCodeSize, const_cast<unsigned_int8 *>(flatCode));
-	}
-	else
-	{
-		flatCode = chrominanceData->GetFlatCode();
-	}
-
-	if (((flags >> 4) & 0x000F) == kVideoCompressionGeneral)
-	{
-		Comp::DecompressData(chrominanceData->GetWlenCode(), chrominanceData->wlenCodeSize, const_cast<unsigned_int8 *>(wlenCode));
-	}
-	else
-	{
-		wlenCode = chrominanceData->GetWlenCode();
-	}
-
-	if (((flags >> 8) & 0x000F) == kVideoCompressionGeneral)
-	{
-		Comp::DecompressData(chrominanceData->GetWavyCode(), chrominanceData->wavyCodeSize, const_cast<unsigned_int8 *>(wavyCode));
-	}
-	else
-	{
-		wavyCode = chrominanceData->GetWavyCode();
-	}
-
-	int32 width = videoFrameSize.x >> 1;
-	int32 height = videoFrameSize.y >> 1;
-
-	Color2C *restrict image = chrominanceImage[delta];
-	const Rect& bounds = chrominanceData->channelBoundingRect;
-	int32 offset = bounds.top * width + bounds.left;
-
-	if (delta)
-	{
-		base = chrominanceImage[0];
-		CopyChrominance(base, image, width, Rect(0, 0, width, bounds.top));
-		CopyChrominance(base, image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
-		CopyChrominance(base, image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		CopyChrominance(base, image, width, Rect(0, bounds.top, width, height));
-		base += offset;
-	}
-	else
-	{
-		ClearChrominance(image, width, Rect(0, 0, width, bounds.top));
-		ClearChrominance(image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
-		ClearChrominance(image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		ClearChrominance(image, width, Rect(0, bounds.top, width, height));
-	}
+	DecompressChannelCode(sliceData, buffer, &flatCode, &wlenCode, &wavyCode);
 
+	const Rect& bounds = sliceData->channelBoundingRect;
+	int32 offset = bounds.top * rowLength + bounds.left;
 	image += offset;
 
-	float scale = chrominanceData->quantizationScale;
+	float scale = sliceData->quantizationScale;
 	for (machine j = 0; j < 8; j++)
 	{
 		for (machine i = 0; i < 8; i++)
@@ -3207,8 +3125,10 @@ void VideoDecompressor::DecompressChrominance(bool delta)
 	int16 *blueFlatData = redBlockData + blockCountX * 64;
 	int16 *redFlatData = blueFlatData + blockCountX;
 
-	if (delta)
+	if (base)
 	{
+		base += offset;
+
 		for (machine j = 0; j < blockCountY; j++)
 		{
 			flatCode += DecodeFlatRow(blockCountX, flatCode, blueFlatData);
@@ -3225,11 +3145,11 @@ void VideoDecompressor::DecompressChrominance(bool delta)
 				blueBlockData[i * 64] = blueFlatData[i];
 				redBlockData[i * 64] = redFlatData[i];
 				DequantizeInverseTransformChrominanceBlock(blueBlockData + i * 64, redBlockData + i * 64, blueBlock, redBlock, dequantizeMatrix);
-				StoreDeltaChrominanceBlock(blueBlock, redBlock, base + i * 8, image + i * 8, width);
+				StoreDeltaChrominanceBlock(blueBlock, redBlock, base + i * 8, image + i * 8, rowLength);
 			}
 
-			base += width * 8;
-			image += width * 8;
+			base += rowLength * 8;
+			image += rowLength * 8;
 		}
 	}
 	else
@@ -3250,61 +3170,135 @@ void VideoDecompressor::DecompressChrominance(bool delta)
 				blueBlockData[i * 64] = blueFlatData[i];
 				redBlockData[i * 64] = redFlatData[i];
 				DequantizeInverseTransformChrominanceBlock(blueBlockData + i * 64, redBlockData + i * 64, blueBlock, redBlock, dequantizeMatrix);
-				StoreChrominanceBlock(blueBlock, redBlock, image + i * 8, width);
+				StoreChrominanceBlock(blueBlock, redBlock, image + i * 8, rowLength);
 			}
 
-			image += width * 8;
+			image += rowLength * 8;
 		}
 	}
 }
 
-void VideoDecompressor::DecompressAlpha(bool delta)
+void VideoDecompressor::JobDecodeLuminanceSlice(Job *job, void *cookie)
+{
+	const VideoSliceJob *sliceJob = static_cast<VideoSliceJob *>(job);
+	DecodeLuminanceSlice(sliceJob->sliceData, static_cast<const Color1C *>(sliceJob->baseImage), static_cast<Color1C *>(sliceJob->outputImage), sliceJob->rowLength, sliceJob->sliceBuffer, sliceJob->blockData);
+}
+
+void VideoDecompressor::JobDecodeChrominanceSlice(Job *job, void *cookie)
+{
+	const VideoSliceJob *sliceJob = static_cast<VideoSliceJob *>(job);
+	DecodeChrominanceSlice(sliceJob->sliceData, static_cast<const Color2C *>(sliceJob->baseImage), static_cast<Color2C *>(sliceJob->outputImage), sliceJob->rowLength, sliceJob->sliceBuffer, sliceJob->blockData);
+}
+
+void VideoDecompressor::SubmitSliceJobs(Job::ExecuteProc *proc, int32 channel, const VideoChannelData *channelData, const void *base, void *image, int32 rowLength, unsigned_int8 *buffer, Batch *batch)
+{
+	// Each slice decompresses its code into its own part of the buffer and decodes its
+	// blocks with its own block data, so no two jobs write to the same memory.
+
+	int16 *block = sliceBlockData[channel];
+	const VideoChannelData *sliceData = channelData->GetSliceData();
+
+	int32 sliceCount = Min(channelData->GetSliceCount(), maxSliceCount[channel]);
+	for (machine a = 0; a < sliceCount; a++)
+	{
+		VideoSliceJob *job = new VideoSliceJob(proc, sliceData, base, image, rowLength, buffer, block);
+		TheJobMgr->SubmitJob(job, batch);
+
+		buffer += sliceData->GetDataSize();
+		block = reinterpret_cast<int16 *>(reinterpret_cast<char *>(block) + sliceBlockDataSize);
+		sliceData++;
+	}
+}
+
+void VideoDecompressor::DecompressLuminance(bool delta, unsigned_int8 *buffer, Batch *batch)
 {
-	alignas(32) float	dequantizeMatrix[8][8];
-	alignas(32) float	alphaBlock[8][8];
 	const Color1C		*base;
 
-	const VideoChannelData *alphaData = &static_cast<VideoAlphaFrameHeader *>(videoFrameHeader)->alphaData;
+	const VideoChannelData *luminanceData = &videoFrameHeader->luminanceData;
 
-	const unsigned_int8 *flatCode = videoFrameData;
-	const unsigned_int8 *wlenCode = flatCode + alphaData->flatDataSize;
-	const unsigned_int8 *wavyCode = wlenCode + alphaData->wlenDataSize;
+	int32 width = videoFrameSize.x;
+	int32 height = videoFrameSize.y;
 
-	unsigned_int32 flags = alphaData->videoChannelFlags;
+	Color1C *restrict image = luminanceImage[delta];
+	const Rect& bounds = luminanceData->channelBoundingRect;
 
-	if ((flags & 0x000F) == kVideoCompressionGeneral)
+	if (delta)
 	{
-		Comp::DecompressData(alphaData->GetFlatCode(), alphaData->flatCodeSize, const_cast<unsigned_int8 *>(flatCode));
+		base = luminanceImage[0];
+		CopyLuminance(base, image, width, Rect(0, 0, width, bounds.top));
+		CopyLuminance(base, image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
+		CopyLuminance(base, image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
+		CopyLuminance(base, image, width, Rect(0, bounds.bottom, width, height));
 	}
 	else
 	{
-		flatCode = alphaData->GetFlatCode();
+		base = nullptr;
+		ClearLuminance(image, width, Rect(0, 0, width, bounds.top));
+		ClearLuminance(image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
+		ClearLuminance(image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
+		ClearLuminance(image, width, Rect(0, bounds.bottom, width, height));
 	}
 
-	if (((flags >> 4) & 0x000F) == kVideoCompressionGeneral)
+	if (batch)
 	{
-		Comp::DecompressData(alphaData->GetWlenCode(), alphaData->wlenCodeSize, const_cast<unsigned_int8 *>(wlenCode));
+		SubmitSliceJobs(&JobDecodeLuminanceSlice, 0, luminanceData, base, image, width, buffer, batch);
 	}
 	else
 	{
-		wlenCode = alphaData->GetWlenCode();
+		DecodeLuminanceSlice(luminanceData, base, image, width, buffer, blockData);
 	}
+}
 
-	if (((flags >> 8) & 0x000F) == kVideoCompressionGeneral)
+void VideoDecompressor::DecompressChrominance(bool delta, unsigned_int8 *buffer, Batch *batch)
+{
+	const Color2C		*base;
+
+	const VideoChannelData *chrominanceData = &videoFrameHeader->chrominanceData;
+
+	int32 width = videoFrameSize.x >> 1;
+	int32 height = videoFrameSize.y >> 1;
+
+	Color2C *restrict image = chrominanceImage[delta];
+	const Rect& bounds = chrominanceData->channelBoundingRect;
+
+	if (delta)
 	{
-		Comp::DecompressData(alphaData->GetWavyCode(), alphaData->wavyCodeSize, const_cast<unsigned_int8 *>(wavyCode));
+		base = chrominanceImage[0];
+		CopyChrominance(base, image, width, Rect(0, 0, width, bounds.top));
+		CopyChrominance(base, image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
+		CopyChrominance(base, image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
+		CopyChrominance(base, image, width, Rect(0, bounds.bottom, width, height));
 	}
 	else
 	{
-		wavyCode = alphaData->GetWavyCode();
+		base = nullptr;
+		ClearChrominance(image, width, Rect(0, 0, width, bounds.top));
+		ClearChrominance(image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
+		ClearChrominance(image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
+		ClearChrominance(image, width, Rect(0, bounds.bottom, width, height));
 	}
 
+	if (batch)
+	{
+		SubmitSliceJobs(&JobDecodeChrominanceSlice, 1, chrominanceData, base, image, width, buffer, batch);
+	}
+	else
+	{
+		DecodeChrominanceSlice(chrominanceData, base, image, width, buffer, blockData);
+	}
+}
+
+void VideoDecompressor::DecompressAlpha(bool delta, unsigned_int8 *buffer, Batch *batch)
+{
+	const Color1C		*base;
+
+	const VideoChannelData *alphaData = &static_cast<VideoAlphaFrameHeader *>(videoFrameHeader)->alphaData;
+
 	int32 width = videoFrameSize.x;
 	int32 height = videoFrameSize.y;
 
 	Color1C *restrict image = alphaImage[delta];
 	const Rect& bounds = alphaData->channelBoundingRect;
-	int32 offset = bounds.top * width + bounds.left;
 
 	if (delta)
 	{
@@ -3312,69 +3306,59 @@ void VideoDecompressor::DecompressAlpha(bool delta)
 		CopyLuminance(base, image, width, Rect(0, 0, width, bounds.top));
 		CopyLuminance(base, image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
 		CopyLuminance(base, image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		CopyLuminance(base, image, width, Rect(0, bounds.top, width, height));
-		base += offset;
+		CopyLuminance(base, image, width, Rect(0, bounds.bottom, width, height));
 	}
 	else
 	{
+		base = nullptr;
 		ClearLuminance(image, width, Rect(0, 0, width, bounds.top));
 		ClearLuminance(image, width, Rect(0, bounds.top, bounds.left, bounds.bottom));
 		ClearLuminance(image, width, Rect(bounds.right, bounds.top, width, bounds.bottom));
-		ClearLuminance(image, width, Rect(0, bounds.top, width, height));
+		ClearLuminance(image, width, Rect(0, bounds.bottom, width, height));
 	}
 
-	image += offset;
-
-	float scale = alphaData->quantizationScale;
-	for (machine j = 0; j < 8; j++)
+	if (batch)
 	{
-		for (machine i = 0; i < 8; i++)
-		{
-			dequantizeMatrix[j][i] = luminanceQuantizeMatrix[j][i] * scale;
-		}
+		SubmitSliceJobs(&JobDecodeLuminanceSlice, 2, alphaData, base, image, width, buffer, batch);
 	}
-
-	int32 blockCountX = bounds.Width() >> 3;
-	int32 blockCountY = bounds.Height() >> 3;
-
-	int16 *flatData = blockData + blockCountX * 64;
-
-	if (delta)
+	else
 	{
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			flatCode += DecodeFlatRow(blockCountX, flatCode, flatData);
-			wavyCode += DecodeWavyRow(blockCountX, wlenCode, wavyCode, blockData);
-			wlenCode += blockCountX;
+		DecodeLuminanceSlice(alphaData, base, image, width, buffer, blockData);
+	}
+}
 
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				blockData[i * 64] = flatData[i];
-				DequantizeInverseTransformLuminanceBlock(blockData + i * 64, alphaBlock, dequantizeMatrix);
-				StoreDeltaLuminanceBlock(alphaBlock, base + i * 8, image + i * 8, width);
-			}
+void VideoDecompressor::DecompressFrame(bool delta)
+{
+	if (!(videoTrackFlags & kVideoSliced))
+	{
+		DecompressLuminance(delta, videoFrameData, nullptr);
+		DecompressChrominance(delta, videoFrameData, nullptr);
 
-			base += width * 8;
-			image += width * 8;
+		if (videoTrackFlags & kVideoAlphaChannel)
+		{
+			DecompressAlpha(delta, videoFrameData, nullptr);
 		}
 	}
 	else
 	{
-		for (machine j = 0; j < blockCountY; j++)
-		{
-			flatCode += DecodeFlatRow(blockCountX, flatCode, flatData);
-			wavyCode += DecodeWavyRow(blockCountX, wlenCode, wavyCode, blockData);
-			wlenCode += blockCountX;
+		Batch		batch;
 
-			for (machine i = 0; i < blockCountX; i++)
-			{
-				blockData[i * 64] = flatData[i];
-				DequantizeInverseTransformLuminanceBlock(blockData + i * 64, alphaBlock, dequantizeMatrix);
-				StoreLuminanceBlock(alphaBlock, image + i * 8, width);
-			}
+		// The slices of all channels are decoded at the same time, so the code for each
+		// channel is decompressed into a separate part of the frame data buffer.
 
-			image += width * 8;
+		unsigned_int8 *buffer = videoFrameData;
+		DecompressLuminance(delta, buffer, &batch);
+
+		buffer += videoFrameHeader->luminanceData.GetDataSize();
+		DecompressChrominance(delta, buffer, &batch);
+
+		if (videoTrackFlags & kVideoAlphaChannel)
+		{
+			buffer += videoFrameHeader->chrominanceData.GetDataSize();
+			DecompressAlpha(delta, buffer, &batch);
 		}
+
+		TheJobMgr->FinishBatch(&batch);
 	}
 }
 
@@ -3527,7 +3511,7 @@ MovieResult C4::Movie::Load(const char *name)
 			new(audioDecompressor) AudioDecompressor(audioTrackHeader);
 
 			unsigned_int32 streamSize = audioTrackHeader->blockFrameCount * audioTrackHeader->audioChannelCount * sizeof(Sample);
-			AllocateStreamMemory(streamSize, streamSize);
+			AllocateStreamMemory(streamSize, streamSize, 2);
 
 			int64 audioDuration = int64(audioTrackHeader->audioFrameCount) * kMovieTicksPerSecond / audioTrackHeader->audioSampleFrequency;
 			movieDuration = Max(movieDuration, (int32) audioDuration);
@@ -3668,14 +3652,7 @@ MovieResult C4::Movie::RenderVideoFrame(void)
 			return (kMovieLoadFailed);
 		}
 
-		videoDecompressor->DecompressLuminance(false);
-		videoDecompressor->DecompressChrominance(false);
-
-		if (videoTrackHeader->videoTrackFlags & kVideoAlphaChannel)
-		{
-			videoDecompressor->DecompressAlpha(false);
-		}
-
+		videoDecompressor->DecompressFrame(false);
 		baseFrameIndex = baseIndex;
 	}
 
@@ -3700,8 +3677,7 @@ MovieResult C4::Movie::RenderVideoFrame(void)
 			return (kMovieLoadFailed);
 		}
 
-		videoDecompressor->DecompressLuminance(true);
-		videoDecompressor->DecompressChrominance(true);
+		videoDecompressor->DecompressFrame(true);
 
 		int32 pixelCount = width * height;
 		luminanceTexture->SetImagePointerOffset(pixelCount);
@@ -3709,7 +3685,6 @@ MovieResult C4::Movie::RenderVideoFrame(void)
 
 		if (videoTrackHeader->videoTrackFlags & kVideoAlphaChannel)
 		{
-			videoDecompressor->DecompressAlpha(true);
 			alphaTexture->SetImagePointerOffset(pixelCount);
 		}
 	}
@@ -54,7 +54,8 @@ namespace C4
 
 	enum
 	{
-		kVideoAlphaChannel			= 1 << 0
+		kVideoAlphaChannel			= 1 << 0,
+		kVideoSliced				= 1 << 1
 	};
 
 
@@ -136,6 +137,26 @@ namespace C4
 		{
 			return (reinterpret_cast<const unsigned_int8 *>(this) + wavyCodeOffset);
 		}
+
+		unsigned_int32 GetDataSize(void) const
+		{
+			return (flatDataSize + wlenDataSize + wavyDataSize);
+		}
+
+		// In a track having the kVideoSliced flag, the flat code of each channel is a table of
+		// VideoChannelData structures, one for each horizontal slice of the channel. Each slice
+		// has its own bounding rectangle and code, so the slices can be decoded independently.
+		// The data sizes of the channel are the totals for all of its slices.
+
+		int32 GetSliceCount(void) const
+		{
+			return ((int32) (flatCodeSize / sizeof(VideoChannelData)));
+		}
+
+		const VideoChannelData *GetSliceData(void) const
+		{
+			return (reinterpret_cast<const VideoChannelData *>(GetFlatCode()));
+		}
 	};
 
 
@@ -250,10 +271,6 @@ namespace C4
 			unsigned_int8		*wlenChromCode;
 			unsigned_int8		*wavyChromCode;
 
-			unsigned_int8		*flatAlphaCode;
-			unsigned_int8		*wlenAlphaCode;
-			unsigned_int8		*wavyAlphaCode;
-
 			unsigned_int8		*compressedCode[2];
 
 			int16				*blockData;
@@ -277,6 +294,11 @@ namespace C4
 			static unsigned_int32 EncodeWavyBlock(const int16 *data, unsigned_int8 *restrict length, unsigned_int8 *restrict code);
 			static unsigned_int32 EncodeWavyRow(unsigned_int32 count, const int16 *data, unsigned_int8 *restrict length, unsigned_int8 *restrict code);
 
+			static unsigned_int32 CompressChannelCode(const unsigned_int8 *flatCode, unsigned_int32 flatDataSize, const unsigned_int8 *wlenCode, unsigned_int32 wlenDataSize, const unsigned_int8 *wavyCode, unsigned_int32 wavyDataSize, VideoChannelData *channelData, unsigned_int8 *code, unsigned_int32 codeBase);
+			static void SetSliceTable(VideoChannelData *channelData, const VideoChannelData *sliceData, int32 sliceCount, unsigned_int32 codeBase);
+
+			unsigned_int32 CompressLuminanceChannel(int8 *const *channelImage, VideoChannelData *channelData, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset, unsigned_int32 codeBase);
+
 			unsigned_int32 CompressLuminance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index);
 			unsigned_int32 CompressChrominance(VideoFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset);
 			unsigned_int32 CompressAlpha(VideoAlphaFrameHeader *videoFrameHeader, float quantScale, unsigned_int32 flags, int32 index, unsigned_int32 codeOffset);
@@ -306,6 +328,7 @@ namespace C4
 
 		private:
 
+			unsigned_int32			videoTrackFlags;
 			Integer2D				videoFrameSize;
 
 			char					*decompressorStorage;
@@ -318,6 +341,9 @@ namespace C4
 			unsigned_int8			*videoFrameData;
 
 			int16					*blockData;
+			int16					*sliceBlockData[3];
+			unsigned_int32			sliceBlockDataSize;
+			int32					maxSliceCount[3];
 
 			static void DequantizeInverseTransformLuminanceBlock(const int16 *input, float (*restrict output)[8], const float (& dequantizeMatrix)[8][8]);
 			static void StoreLuminanceBlock(const float (& input)[8][8], Color1C *restrict output, int32 rowLength);
@@ -336,6 +362,19 @@ namespace C4
 			static void CopyLuminance(const Color1C *base, Color1C *restrict image, int32 rowLength, const Rect& bounds);
 			static void CopyChrominance(const Color2C *base, Color2C *restrict image, int32 rowLength, const Rect& bounds);
 
+			static void DecompressChannelCode(const VideoChannelData *channelData, unsigned_int8 *buffer, const unsigned_int8 **flatCode, const unsigned_int8 **wlenCode, const unsigned_int8 **wavyCode);
+			static void DecodeLuminanceSlice(const VideoChannelData *sliceData, const Color1C *base, Color1C *restrict image, int32 rowLength, unsigned_int8 *buffer, int16 *blockData);
+			static void DecodeChrominanceSlice(const VideoChannelData *sliceData, const Color2C *base, Color2C *restrict image, int32 rowLength, unsigned_int8 *buffer, int16 *blockData);
+
+			static void JobDecodeLuminanceSlice(Job *job, void *cookie);
+			static void JobDecodeChrominanceSlice(Job *job, void *cookie);
+
+			void SubmitSliceJobs(Job::ExecuteProc *proc, int32 channel, const VideoChannelData *channelData, const void *base, void *image, int32 rowLength, unsigned_int8 *buffer, Batch *batch);
+
+			void DecompressLuminance(bool delta, unsigned_int8 *buffer, Batch *batch);
+			void DecompressChrominance(bool delta, unsigned_int8 *buffer, Batch *batch);
+			void DecompressAlpha(bool delta, unsigned_int8 *buffer, Batch *batch);
+
 		public:
 
 			VideoDecompressor(const VideoTrackHeader *videoTrackHeader);
@@ -361,9 +400,7 @@ namespace C4
 				return (alphaImage[0]);
 			}
 
-			void DecompressLuminance(bool delta);
-			void DecompressChrominance(bool delta);
-			void DecompressAlpha(bool delta);
+			void DecompressFrame(bool delta);
 	};
 
 
@@ -0,0 +1,1984 @@
+ 
+
+#include "C4Navigation.h"
+#include "C4Zones.h"
+#include "C4Geometries.h"
+
+
+using namespace C4;
+
+
+namespace C4
+{
+	const float kNavigationVerticalRange = 2.0F;
+	const float kNavigationNearestRange = 2.0F;
+
+	const int32 kNavigationSideDelta[kNavigationSideCount][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+
+	// The NavigationBuilder class converts the collision geometry in a zone into a navigation tile.
+	// Triangles are first clipped to the columns of a grid of cells, and the height range covered in
+	// each column is accumulated as a sorted list of solid spans, each of which is walkable if the
+	// triangle that determines its top surface is flat enough. A floor cell is created at the top of
+	// each walkable span with enough clearance below the next span, and each floor cell is connected
+	// to the floor cell within climbing distance in each of the four neighboring columns.
+	//
+	// Floor cells having a missing neighbor are removed in as many passes as it takes to cover the
+	// agent radius. Columns outside the grid are treated as present so that the walkable area is not
+	// pulled away from the boundary between neighboring zones. The remaining cells are then greedily
+	// merged into rectangles, and an edge is created wherever two rectangles touch.
+
+	class NavigationBuilder
+	{
+		private:
+
+			enum
+			{
+				kOutsideGrid		= -2
+			};
+
+			struct HeightSpan
+			{
+				float		minHeight;
+				float		maxHeight;
+				int32		nextSpan;
+				bool		walkable;
+			};
+
+			struct FloorCell
+			{
+				float		floorHeight;
+				int32		cellCoord[2];
+				int32		nextCell;
+				int32		neighborCell[kNavigationSideCount];
+				int32		polygonIndex;
+				bool		removed;
+			};
+
+			struct EdgeCell
+			{
+				int32		polygonIndex;
+				int32		edgeSide;
+				int32		targetIndex;
+				int32		alongCell;
+			};
+
+			const NavigationBuildParams		*buildParams;
+
+			int32							gridOrigin[2];
+			int32							gridSize[2];
+
+			int32							*spanHead;
+			Array<HeightSpan>				spanArray;
+			int32							freeSpan;
+
+			int32							*cellHead;
+			Array<FloorCell>				cellArray;
+
+			Array<NavigationPolygon>		polygonArray;
+			Array<NavigationEdge>			edgeArray;
+
+			static bool GeometryEligible(const Geometry *geometry);
+			static int32 ClipPolygon(int32 vertexCount, const Point3D *vertex, Point3D *result, int32 axis, float value, bool positive);
+
+			void AddSpan(int32 column, float minHeight, float maxHeight, bool walkable);
+			void RasterizeTriangle(const Point3D& v1, const Point3D& v2, const Point3D& v3);
+
+			void BuildFloorCells(void);
+			void ConnectFloorCells(void);
+			void ErodeFloorCells(void);
+			void BuildPolygons(void);
+			void BuildEdges(void);
+
+		public:
+
+			NavigationBuilder(const NavigationBuildParams *params);
+			~NavigationBuilder();
+
+			NavigationTile *Build(const Zone *zone);
+	};
+}
+
+
+NavigationBuildParams::NavigationBuildParams()
+{
+	agentHeight = 1.75F;
+	agentRadius = 0.375F;
+	maxClimbHeight = 0.375F;
+	maxSlopeCosine = 0.70710678F;
+}
+
+
+NavigationBuilder::NavigationBuilder(const NavigationBuildParams *params)
+{
+	buildParams = params;
+
+	spanHead = nullptr;
+	freeSpan = -1;
+	cellHead = nullptr;
+}
+
+NavigationBuilder::~NavigationBuilder()
+{
+	delete[] cellHead;
+	delete[] spanHead;
+}
+
+bool NavigationBuilder::GeometryEligible(const Geometry *geometry)
+{
+	if (geometry->GetNodeFlags() & kNodeDisabled)
+	{
+		return (false);
+	}
+
+	const GeometryObject *object = geometry->GetObject();
+	if ((object->GetGeometryFlags() & kGeometryDynamic) || (object->GetCollisionExclusionMask() & kCollisionCharacter))
+	{
+		return (false);
+	}
+
+	return (true);
+}
+
+int32 NavigationBuilder::ClipPolygon(int32 vertexCount, const Point3D *vertex, Point3D *result, int32 axis, float value, bool positive)
+{
+	int32 resultCount = 0;
+
+	const Point3D *p1 = &vertex[vertexCount - 1];
+	float d1 = (positive) ? (*p1)[axis] - value : value - (*p1)[axis];
+
+	for (machine a = 0; a < vertexCount; a++)
+	{
+		const Point3D *p2 = &vertex[a];
+		float d2 = (positive) ? (*p2)[axis] - value : value - (*p2)[axis];
+
+		if (d1 >= 0.0F)
+		{
+			if (d2 >= 0.0F)
+			{
+				result[resultCount++] = *p2;
+			}
+			else
+			{
+				result[resultCount++] = *p1 + (*p2 - *p1) * (d1 / (d1 - d2));
+			}
+		}
+		else if (d2 >= 0.0F)
+		{
+			result[resultCount++] = *p1 + (*p2 - *p1) * (d1 / (d1 - d2));
+			result[resultCount++] = *p2;
+		}
+
+		p1 = p2;
+		d1 = d2;
+	}
+
+	return (resultCount);
+}
+
+void NavigationBuilder::AddSpan(int32 column, float minHeight, float maxHeight, bool walkable)
+{
+	// Any spans overlapping the new span are merged into it. If the top surfaces are within
+	// climbing distance of each other, then the merged span is walkable if either span is.
+	// Otherwise, the span with the higher top surface determines whether it's walkable.
+
+	int32 previous = -1;
+	int32 index = spanHead[column];
+	while (index >= 0)
+	{
+		HeightSpan *span = &spanArray[index];
+		if (span->minHeight > maxHeight)
+		{
+			break;
+		}
+
+		int32 next = span->nextSpan;
+		if (span->maxHeight < minHeight)
+		{
+			previous = index;
+			index = next;
+			continue;
+		}
+
+		minHeight = Fmin(minHeight, span->minHeight);
+		if (Fabs(span->maxHeight - maxHeight) <= buildParams->maxClimbHeight)
+		{
+			walkable |= span->walkable;
+		}
+		else if (span->maxHeight > maxHeight)
+		{
+			walkable = span->walkable;
+		}
+
+		maxHeight = Fmax(maxHeight, span->maxHeight);
+
+		if (previous < 0)
+		{
+			spanHead[column] = next;
+		}
+		else
+		{
+			spanArray[previous].nextSpan = next;
+		}
+
+		span->nextSpan = freeSpan;
+		freeSpan = index;
+		index = next;
+	}
+
+	int32 newIndex = freeSpan;
+	if (newIndex >= 0)
+	{
+		freeSpan = spanArray[newIndex].nextSpan;
+	}
+	else
+	{
+		newIndex = spanArray.GetElementCount();
+		spanArray.AddElement();
+	}
+
+	HeightSpan *span = &spanArray[newIndex];
+	span->minHeight = minHeight;
+	span->maxHeight = maxHeight;
+	span->walkable = walkable;
+
+	if (previous < 0)
+	{
+		span->nextSpan = spanHead[column];
+		spanHead[column] = newIndex;
+	}
+	else
+	{
+		span->nextSpan = spanArray[previous].nextSpan;
+		spanArray[previous].nextSpan = newIndex;
+	}
+}
+
+void NavigationBuilder::RasterizeTriangle(const Point3D& v1, const Point3D& v2, const Point3D& v3)
+{
+	Point3D		rowVertex[8];
+	Point3D		cellVertex[12];
+	Point3D		clipVertex[12];
+
+	Vector3D normal = (v2 - v1) % (v3 - v1);
+	float m = SquaredMag(normal);
+	if (m < K::min_float)
+	{
+		return;
+	}
+
+	bool walkable = (normal.z * InverseSqrt(m) >= buildParams->maxSlopeCosine);
+
+	int32 minX = MaxZero((int32) Floor(Fmin(v1.x, v2.x, v3.x) * kInverseNavigationCellSize) - gridOrigin[0]);
+	int32 maxX = Min((int32) Floor(Fmax(v1.x, v2.x, v3.x) * kInverseNavigationCellSize) - gridOrigin[0], gridSize[0] - 1);
+	int32 minY = MaxZero((int32) Floor(Fmin(v1.y, v2.y, v3.y) * kInverseNavigationCellSize) - gridOrigin[1]);
+	int32 maxY = Min((int32) Floor(Fmax(v1.y, v2.y, v3.y) * kInverseNavigationCellSize) - gridOrigin[1], gridSize[1] - 1);
+
+	Point3D triangle[3] = {v1, v2, v3};
+
+	for (machine j = minY; j <= maxY; j++)
+	{
+		float y1 = (float) (gridOrigin[1] + j) * kNavigationCellSize;
+		int32 count = ClipPolygon(3, triangle, clipVertex, 1, y1, true);
+		if (count < 3)
+		{
+			continue;
+		}
+
+		count = ClipPolygon(count, clipVertex, rowVertex, 1, y1 + kNavigationCellSize, false);
+		if (count < 3)
+		{
+			continue;
+		}
+
+		for (machine i = minX; i <= maxX; i++)
+		{
+			float x1 = (float) (gridOrigin[0] + i) * kNavigationCellSize;
+			int32 cellCount = ClipPolygon(count, rowVertex, clipVertex, 0, x1, true);
+			if (cellCount < 3)
+			{
+				continue;
+			}
+
+			cellCount = ClipPolygon(cellCount, clipVertex, cellVertex, 0, x1 + kNavigationCellSize, false);
+			if (cellCount < 3)
+			{
+				continue;
+			}
+
+			float minHeight = cellVertex[0].z;
+			float maxHeight = minHeight;
+			for (machine k = 1; k < cellCount; k++)
+			{
+				float z = cellVertex[k].z;
+				minHeight = Fmin(minHeight, z);
+				maxHeight = Fmax(maxHeight, z);
+			}
+
+			AddSpan(j * gridSize[0] + i, minHeight, maxHeight, walkable);
+		}
+	}
+}
+
+void NavigationBuilder::BuildFloorCells(void)
+{
+	int32 columnCount = gridSize[0] * gridSize[1];
+	cellHead = new int32[columnCount];
+
+	for (machine j = 0; j < gridSize[1]; j++)
+	{
+		for (machine i = 0; i < gridSize[0]; i++)
+		{
+			int32 column = j * gridSize[0] + i;
+			cellHead[column] = -1;
+
+			int32 previous = -1;
+			int32 index = spanHead[column];
+			while (index >= 0)
+			{
+				const HeightSpan *span = &spanArray[index];
+				int32 next = span->nextSpan;
+
+				if (span->walkable)
+				{
+					float ceiling = (next >= 0) ? spanArray[next].minHeight : K::infinity;
+					if (ceiling - span->maxHeight >= buildParams->agentHeight)
+					{
+						int32 cellIndex = cellArray.GetElementCount();
+						FloorCell *cell = cellArray.AddElement();
+
+						cell->floorHeight = span->maxHeight;
+						cell->cellCoord[0] = i;
+						cell->cellCoord[1] = j;
+						cell->nextCell = -1;
+						cell->polygonIndex = -1;
+						cell->removed = false;
+
+						if (previous < 0)
+						{
+							cellHead[column] = cellIndex;
+						}
+						else
+						{
+							cellArray[previous].nextCell = cellIndex;
+						}
+
+						previous = cellIndex;
+					}
+				}
+
+				index = next;
+			}
+		}
+	}
+}
+
+void NavigationBuilder::ConnectFloorCells(void)
+{
+	float maxClimb = buildParams->maxClimbHeight;
+
+	int32 cellCount = cellArray.GetElementCount();
+	for (machine a = 0; a < cellCount; a++)
+	{
+		FloorCell *cell = &cellArray[a];
+		for (machine side = 0; side < kNavigationSideCount; side++)
+		{
+			int32 i = cell->cellCoord[0] + kNavigationSideDelta[side][0];
+			int32 j = cell->cellCoord[1] + kNavigationSideDelta[side][1];
+			if ((i < 0) || (i >= gridSize[0]) || (j < 0) || (j >= gridSize[1]))
+			{
+				cell->neighborCell[side] = kOutsideGrid;
+				continue;
+			}
+
+			int32 neighbor = -1;
+			float bestDelta = maxClimb;
+
+			int32 index = cellHead[j * gridSize[0] + i];
+			while (index >= 0)
+			{
+				const FloorCell *other = &cellArray[index];
+				float delta = Fabs(other->floorHeight - cell->floorHeight);
+				if (delta <= bestDelta)
+				{
+					bestDelta = delta;
+					neighbor = index;
+				}
+
+				index = other->nextCell;
+			}
+
+			cell->neighborCell[side] = neighbor;
+		}
+	}
+}
+
+void NavigationBuilder::ErodeFloorCells(void)
+{
+	Array<int32>	erodeArray;
+
+	int32 passCount = (int32) Ceil(buildParams->agentRadius * kInverseNavigationCellSize);
+	int32 cellCount = cellArray.GetElementCount();
+
+	for (machine pass = 0; pass < passCount; pass++)
+	{
+		erodeArray.Clear();
+
+		for (machine a = 0; a < cellCount; a++)
+		{
+			const FloorCell *cell = &cellArray[a];
+			if (!cell->removed)
+			{
+				for (machine side = 0; side < kNavigationSideCount; side++)
+				{
+					int32 neighbor = cell->neighborCell[side];
+					if ((neighbor == -1) || ((neighbor >= 0) && (cellArray[neighbor].removed)))
+					{
+						erodeArray.AddElement(a);
+						break;
+					}
+				}
+			}
+		}
+
+		int32 erodeCount = erodeArray.GetElementCount();
+		if (erodeCount == 0)
+		{
+			break;
+		}
+
+		for (machine a = 0; a < erodeCount; a++)
+		{
+			cellArray[erodeArray[a]].removed = true;
+		}
+	}
+}
+
+void NavigationBuilder::BuildPolygons(void)
+{
+	int32		rowCell[kMaxNavigationRectangleSize];
+	int32		nextRowCell[kMaxNavigationRectangleSize];
+	int32		memberCell[kMaxNavigationRectangleSize * kMaxNavigationRectangleSize];
+
+	// Rectangles are grown first along the x axis and then row by row along the y axis. A cell can
+	// be added to a rectangle only if it's connected to the cells already in the rectangle that are
+	// adjacent to it, and the range of floor heights inside each rectangle is limited so that a
+	// single floor height is a good approximation for every point inside.
+
+	float heightLimit = buildParams->agentHeight * 0.5F;
+	int32 cellCount = cellArray.GetElementCount();
+
+	for (machine a = 0; a < cellCount; a++)
+	{
+		const FloorCell *cell = &cellArray[a];
+		if ((cell->removed) || (cell->polygonIndex >= 0))
+		{
+			continue;
+		}
+
+		if (polygonArray.GetElementCount() >= (1 << kNavigationPolygonShift))
+		{
+			break;
+		}
+
+		float minHeight = cell->floorHeight;
+		float maxHeight = minHeight;
+
+		rowCell[0] = a;
+		int32 width = 1;
+		while (width < kMaxNavigationRectangleSize)
+		{
+			int32 neighbor = cellArray[rowCell[width - 1]].neighborCell[kNavigationSideMaxX];
+			if (neighbor < 0)
+			{
+				break;
+			}
+
+			const FloorCell *next = &cellArray[neighbor];
+			if ((next->removed) || (next->polygonIndex >= 0) || (Fmax(maxHeight, next->floorHeight) - Fmin(minHeight, next->floorHeight) > heightLimit))
+			{
+				break;
+			}
+
+			minHeight = Fmin(minHeight, next->floorHeight);
+			maxHeight = Fmax(maxHeight, next->floorHeight);
+			rowCell[width++] = neighbor;
+		}
+
+		for (machine i = 0; i < width; i++)
+		{
+			memberCell[i] = rowCell[i];
+		}
+
+		int32 height = 1;
+		while (height < kMaxNavigationRectangleSize)
+		{
+			float rowMin = minHeight;
+			float rowMax = maxHeight;
+
+			machine i = 0;
+			for (; i < width; i++)
+			{
+				int32 neighbor = cellArray[rowCell[i]].neighborCell[kNavigationSideMaxY];
+				if (neighbor < 0)
+				{
+					break;
+				}
+
+				const FloorCell *next = &cellArray[neighbor];
+				if ((next->removed) || (next->polygonIndex >= 0))
+				{
+					break;
+				}
+
+				if ((i > 0) && (cellArray[nextRowCell[i - 1]].neighborCell[kNavigationSideMaxX] != neighbor))
+				{
+					break;
+				}
+
+				rowMin = Fmin(rowMin, next->floorHeight);
+				rowMax = Fmax(rowMax, next->floorHeight);
+				if (rowMax - rowMin > heightLimit)
+				{
+					break;
+				}
+
+				nextRowCell[i] = neighbor;
+			}
+
+			if (i < width)
+			{
+				break;
+			}
+
+			minHeight = rowMin;
+			maxHeight = rowMax;
+
+			for (i = 0; i < width; i++)
+			{
+				rowCell[i] = nextRowCell[i];
+				memberCell[height * width + i] = nextRowCell[i];
+			}
+
+			height++;
+		}
+
+		int32 polygonIndex = polygonArray.GetElementCount();
+		NavigationPolygon *polygon = polygonArray.AddElement();
+
+		float floorHeight = 0.0F;
+		int32 memberCount = width * height;
+		for (machine k = 0; k < memberCount; k++)
+		{
+			FloorCell *member = &cellArray[memberCell[k]];
+			member->polygonIndex = polygonIndex;
+			floorHeight += member->floorHeight;
+		}
+
+		polygon->minCell[0] = gridOrigin[0] + cell->cellCoord[0];
+		polygon->minCell[1] = gridOrigin[1] + cell->cellCoord[1];
+		polygon->maxCell[0] = polygon->minCell[0] + width;
+		polygon->maxCell[1] = polygon->minCell[1] + height;
+		polygon->minHeight = minHeight;
+		polygon->maxHeight = maxHeight;
+		polygon->floorHeight = floorHeight / (float) memberCount;
+		polygon->firstEdge = 0;
+		polygon->edgeCount = 0;
+	}
+}
+
+void NavigationBuilder::BuildEdges(void)
+{
+	Array<EdgeCell>		edgeCellArray;
+
+	// Each pair of connected cells belonging to different polygons contributes one cell to an edge.
+	// The edge cells are grouped by polygon, sorted by side, target, and position along the side,
+	// and consecutive runs are then merged into edges.
+
+	int32 polygonCount = polygonArray.GetElementCount();
+	int32 *edgeCellStart = new int32[polygonCount + 1];
+	for (machine a = 0; a <= polygonCount; a++)
+	{
+		edgeCellStart[a] = 0;
+	}
+
+	int32 cellCount = cellArray.GetElementCount();
+	for (machine pass = 0; pass < 2; pass++)
+	{
+		for (machine a = 0; a < cellCount; a++)
+		{
+			const FloorCell *cell = &cellArray[a];
+			int32 polygonIndex = cell->polygonIndex;
+			if (polygonIndex < 0)
+			{
+				continue;
+			}
+
+			for (machine side = 0; side < kNavigationSideCount; side++)
+			{
+				int32 neighbor = cell->neighborCell[side];
+				if (neighbor >= 0)
+				{
+					int32 targetIndex = cellArray[neighbor].polygonIndex;
+					if ((targetIndex >= 0) && (targetIndex != polygonIndex))
+					{
+						if (pass == 0)
+						{
+							edgeCellStart[polygonIndex + 1]++;
+						}
+						else
+						{
+							EdgeCell *edgeCell = &edgeCellArray[edgeCellStart[polygonIndex]++];
+							edgeCell->polygonIndex = polygonIndex;
+							edgeCell->edgeSide = side;
+							edgeCell->targetIndex = targetIndex;
+							int32 along = (side >> 1) ^ 1;
+							edgeCell->alongCell = gridOrigin[along] + cell->cellCoord[along];
+						}
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (machine a = 0; a < polygonCount; a++)
+			{
+				edgeCellStart[a + 1] += edgeCellStart[a];
+			}
+
+			edgeCellArray.SetElementCount(edgeCellStart[polygonCount]);
+		}
+		else
+		{
+			for (machine a = polygonCount; a > 0; a--)
+			{
+				edgeCellStart[a] = edgeCellStart[a - 1];
+			}
+
+			edgeCellStart[0] = 0;
+		}
+	}
+
+	for (machine a = 0; a < polygonCount; a++)
+	{
+		int32 start = edgeCellStart[a];
+		int32 finish = edgeCellStart[a + 1];
+
+		for (machine k = start + 1; k < finish; k++)
+		{
+			EdgeCell edgeCell = edgeCellArray[k];
+
+			machine m = k - 1;
+			for (; m >= start; m--)
+			{
+				const EdgeCell *other = &edgeCellArray[m];
+				if ((other->edgeSide < edgeCell.edgeSide) || ((other->edgeSide == edgeCell.edgeSide) && ((other->targetIndex < edgeCell.targetIndex) || ((other->targetIndex == edgeCell.targetIndex) && (other->alongCell <= edgeCell.alongCell)))))
+				{
+					break;
+				}
+
+				edgeCellArray[m + 1] = *other;
+			}
+
+			edgeCellArray[m + 1] = edgeCell;
+		}
+
+		NavigationPolygon *polygon = &polygonArray[a];
+		polygon->firstEdge = edgeArray.GetElementCount();
+
+		for (machine k = start; k < finish;)
+		{
+			const EdgeCell *edgeCell = &edgeCellArray[k];
+			int32 maxCell = edgeCell->alongCell + 1;
+
+			machine m = k + 1;
+			for (; m < finish; m++)
+			{
+				const EdgeCell *other = &edgeCellArray[m];
+				if ((other->edgeSide != edgeCell->edgeSide) || (other->targetIndex != edgeCell->targetIndex) || (other->alongCell != maxCell))
+				{
+					break;
+				}
+
+				maxCell++;
+			}
+
+			NavigationEdge *edge = edgeArray.AddElement();
+			edge->polygonIndex = edgeCell->targetIndex;
+			edge->edgeSide = edgeCell->edgeSide;
+			edge->minCell = edgeCell->alongCell;
+			edge->maxCell = maxCell;
+
+			k = m;
+		}
+
+		polygon->edgeCount = edgeArray.GetElementCount() - polygon->firstEdge;
+	}
+
+	delete[] edgeCellStart;
+}
+
+NavigationTile *NavigationBuilder::Build(const Zone *zone)
+{
+	Array<Point3D>		triangleArray;
+
+	const Node *node = zone->GetFirstSubnode();
+	while (node)
+	{
+		NodeType type = node->GetNodeType();
+		if ((type == kNodeZone) || (node->GetController()))
+		{
+			node = zone->GetNextLevelNode(node);
+			continue;
+		}
+
+		if (type == kNodeGeometry)
+		{
+			const Geometry *geometry = static_cast<const Geometry *>(node);
+			if (GeometryEligible(geometry))
+			{
+				const GeometryObject *object = geometry->GetObject();
+				const Mesh *mesh = object->GetGeometryLevel(object->GetCollisionLevel());
+				const Point3D *position = mesh->GetArray<Point3D>(kArrayPosition);
+				const Triangle *triangle = mesh->GetArray<Triangle>(kArrayPrimitive);
+
+				const Transform4D& transform = geometry->GetWorldTransform();
+				int32 triangleCount = mesh->GetPrimitiveCount();
+				for (machine a = 0; a < triangleCount; a++)
+				{
+					triangleArray.AddElement(transform * position[triangle[a].index[0]]);
+					triangleArray.AddElement(transform * position[triangle[a].index[1]]);
+					triangleArray.AddElement(transform * position[triangle[a].index[2]]);
+				}
+			}
+		}
+
+		node = zone->GetNextNode(node);
+	}
+
+	int32 vertexCount = triangleArray.GetElementCount();
+	if (vertexCount == 0)
+	{
+		return (nullptr);
+	}
+
+	float minX = triangleArray[0].x;
+	float maxX = minX;
+	float minY = triangleArray[0].y;
+	float maxY = minY;
+	for (machine a = 1; a < vertexCount; a++)
+	{
+		const Point3D& p = triangleArray[a];
+		minX = Fmin(minX, p.x);
+		maxX = Fmax(maxX, p.x);
+		minY = Fmin(minY, p.y);
+		maxY = Fmax(maxY, p.y);
+	}
+
+	gridOrigin[0] = (int32) Floor(minX * kInverseNavigationCellSize);
+	gridOrigin[1] = (int32) Floor(minY * kInverseNavigationCellSize);
+	gridSize[0] = Min((int32) Floor(maxX * kInverseNavigationCellSize) - gridOrigin[0] + 1, kMaxNavigationGridSize);
+	gridSize[1] = Min((int32) Floor(maxY * kInverseNavigationCellSize) - gridOrigin[1] + 1, kMaxNavigationGridSize);
+
+	int32 columnCount = gridSize[0] * gridSize[1];
+	spanHead = new int32[columnCount];
+	for (machine a = 0; a < columnCount; a++)
+	{
+		spanHead[a] = -1;
+	}
+
+	for (machine a = 0; a < vertexCount; a += 3)
+	{
+		RasterizeTriangle(triangleArray[a], triangleArray[a + 1], triangleArray[a + 2]);
+	}
+
+	BuildFloorCells();
+	ConnectFloorCells();
+	ErodeFloorCells();
+	BuildPolygons();
+
+	int32 polygonCount = polygonArray.GetElementCount();
+	if (polygonCount == 0)
+	{
+		return (nullptr);
+	}
+
+	BuildEdges();
+
+	int32 edgeCount = edgeArray.GetElementCount();
+
+	NavigationTile *tile = new NavigationTile;
+	tile->Allocate(polygonCount, edgeCount);
+
+	MemoryMgr::CopyMemory(static_cast<NavigationPolygon *>(polygonArray), tile->polygonArray, polygonCount * sizeof(NavigationPolygon));
+	MemoryMgr::CopyMemory(static_cast<NavigationEdge *>(edgeArray), tile->edgeArray, edgeCount * sizeof(NavigationEdge));
+
+	tile->minCell[0] = gridOrigin[0];
+	tile->minCell[1] = gridOrigin[1];
+	tile->maxCell[0] = gridOrigin[0] + gridSize[0];
+	tile->maxCell[1] = gridOrigin[1] + gridSize[1];
+	tile->maxClimbHeight = buildParams->maxClimbHeight;
+
+	float minHeight = polygonArray[0].minHeight;
+	float maxHeight = polygonArray[0].maxHeight;
+	for (machine a = 1; a < polygonCount; a++)
+	{
+		minHeight = Fmin(minHeight, polygonArray[a].minHeight);
+		maxHeight = Fmax(maxHeight, polygonArray[a].maxHeight);
+	}
+
+	tile->minHeight = minHeight;
+	tile->maxHeight = maxHeight;
+	return (tile);
+}
+
+
+NavigationTile::NavigationTile()
+{
+	polygonCount = 0;
+	edgeCount = 0;
+	polygonArray = nullptr;
+	edgeArray = nullptr;
+
+	minCell[0] = 0;
+	minCell[1] = 0;
+	maxCell[0] = 0;
+	maxCell[1] = 0;
+	minHeight = 0.0F;
+	maxHeight = 0.0F;
+	maxClimbHeight = 0.0F;
+
+	owningMesh = nullptr;
+	tileSlot = -1;
+
+	bucketStart = nullptr;
+	bucketPolygon = nullptr;
+	linkStart = nullptr;
+}
+
+NavigationTile::~NavigationTile()
+{
+	if (owningMesh)
+	{
+		owningMesh->RemoveTile(this);
+	}
+
+	delete[] edgeArray;
+	delete[] polygonArray;
+}
+
+NavigationTile *NavigationTile::Build(const Zone *zone, const NavigationBuildParams *params)
+{
+	NavigationBuilder	builder(params);
+
+	return (builder.Build(zone));
+}
+
+void NavigationTile::Allocate(int32 polyCount, int32 edgeTotal)
+{
+	delete[] edgeArray;
+	delete[] polygonArray;
+
+	polygonCount = polyCount;
+	edgeCount = edgeTotal;
+	polygonArray = new NavigationPolygon[polyCount];
+	edgeArray = (edgeTotal != 0) ? new NavigationEdge[edgeTotal] : nullptr;
+}
+
+void NavigationTile::Pack(Packer& data) const
+{
+	data << polygonCount;
+	data << edgeCount;
+
+	data << minCell[0];
+	data << minCell[1];
+	data << maxCell[0];
+	data << maxCell[1];
+	data << minHeight;
+	data << maxHeight;
+	data << maxClimbHeight;
+
+	data.WriteArray(polygonCount, polygonArray);
+	data.WriteArray(edgeCount, edgeArray);
+}
+
+void NavigationTile::Unpack(Unpacker& data)
+{
+	int32	polyCount;
+	int32	edgeTotal;
+
+	data >> polyCount;
+	data >> edgeTotal;
+	Allocate(polyCount, edgeTotal);
+
+	data >> minCell[0];
+	data >> minCell[1];
+	data >> maxCell[0];
+	data >> maxCell[1];
+	data >> minHeight;
+	data >> maxHeight;
+	data >> maxClimbHeight;
+
+	data.ReadArray(polygonCount, polygonArray);
+	data.ReadArray(edgeCount, edgeArray);
+}
+
+void NavigationTile::BuildBuckets(void)
+{
+	// Each polygon is listed in every bucket that it overlaps so that the polygons containing a
+	// particular cell can be found by looking in a single bucket.
+
+	bucketCount[0] = (maxCell[0] - minCell[0] + (kNavigationBucketSize - 1)) / kNavigationBucketSize;
+	bucketCount[1] = (maxCell[1] - minCell[1] + (kNavigationBucketSize - 1)) / kNavigationBucketSize;
+
+	int32 totalCount = bucketCount[0] * bucketCount[1];
+	bucketStart = new int32[totalCount + 1];
+	for (machine a = 0; a <= totalCount; a++)
+	{
+		bucketStart[a] = 0;
+	}
+
+	for (machine pass = 0; pass < 2; pass++)
+	{
+		for (machine a = 0; a < polygonCount; a++)
+		{
+			const NavigationPolygon *polygon = &polygonArray[a];
+			int32 i1 = (polygon->minCell[0] - minCell[0]) / kNavigationBucketSize;
+			int32 i2 = (polygon->maxCell[0] - 1 - minCell[0]) / kNavigationBucketSize;
+			int32 j1 = (polygon->minCell[1] - minCell[1]) / kNavigationBucketSize;
+			int32 j2 = (polygon->maxCell[1] - 1 - minCell[1]) / kNavigationBucketSize;
+
+			for (machine j = j1; j <= j2; j++)
+			{
+				for (machine i = i1; i <= i2; i++)
+				{
+					int32 bucket = j * bucketCount[0] + i;
+					if (pass == 0)
+					{
+						bucketStart[bucket + 1]++;
+					}
+					else
+					{
+						bucketPolygon[bucketStart[bucket]++] = a;
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (machine a = 0; a < totalCount; a++)
+			{
+				bucketStart[a + 1] += bucketStart[a];
+			}
+
+			bucketPolygon = new int32[bucketStart[totalCount]];
+		}
+		else
+		{
+			for (machine a = totalCount; a > 0; a--)
+			{
+				bucketStart[a] = bucketStart[a - 1];
+			}
+
+			bucketStart[0] = 0;
+		}
+	}
+}
+
+void NavigationTile::PurgeBuckets(void)
+{
+	delete[] bucketPolygon;
+	delete[] bucketStart;
+	bucketPolygon = nullptr;
+	bucketStart = nullptr;
+}
+
+int32 NavigationTile::QueryPolygons(const int32 *rectMin, const int32 *rectMax, int32 *result, int32 maxCount) const
+{
+	int32 x1 = Max(rectMin[0], minCell[0]);
+	int32 y1 = Max(rectMin[1], minCell[1]);
+	int32 x2 = Min(rectMax[0], maxCell[0]);
+	int32 y2 = Min(rectMax[1], maxCell[1]);
+	if ((x1 >= x2) || (y1 >= y2))
+	{
+		return (0);
+	}
+
+	// A polygon overlapping the rectangle is reported only from the bucket containing the
+	// corner of the overlap so that polygons spanning multiple buckets are reported once.
+
+	int32 resultCount = 0;
+
+	int32 i1 = (x1 - minCell[0]) / kNavigationBucketSize;
+	int32 i2 = (x2 - 1 - minCell[0]) / kNavigationBucketSize;
+	int32 j1 = (y1 - minCell[1]) / kNavigationBucketSize;
+	int32 j2 = (y2 - 1 - minCell[1]) / kNavigationBucketSize;
+
+	for (machine j = j1; j <= j2; j++)
+	{
+		for (machine i = i1; i <= i2; i++)
+		{
+			int32 bucket = j * bucketCount[0] + i;
+			int32 start = bucketStart[bucket];
+			int32 finish = bucketStart[bucket + 1];
+
+			for (machine k = start; k < finish; k++)
+			{
+				int32 index = bucketPolygon[k];
+				const NavigationPolygon *polygon = &polygonArray[index];
+
+				int32 cx = Max(polygon->minCell[0], x1);
+				int32 cy = Max(polygon->minCell[1], y1);
+				if ((cx < Min(polygon->maxCell[0], x2)) && (cy < Min(polygon->maxCell[1], y2)))
+				{
+					if (((cx - minCell[0]) / kNavigationBucketSize == i) && ((cy - minCell[1]) / kNavigationBucketSize == j))
+					{
+						result[resultCount] = index;
+						if (++resultCount == maxCount)
+						{
+							return (resultCount);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return (resultCount);
+}
+
+int32 NavigationTile::FindPolygon(const Point3D& position, float verticalRange) const
+{
+	int32 x = (int32) Floor(position.x * kInverseNavigationCellSize);
+	int32 y = (int32) Floor(position.y * kInverseNavigationCellSize);
+	if ((x < minCell[0]) || (x >= maxCell[0]) || (y < minCell[1]) || (y >= maxCell[1]))
+	{
+		return (-1);
+	}
+
+	int32 result = -1;
+	float bestDelta = verticalRange;
+
+	int32 bucket = (y - minCell[1]) / kNavigationBucketSize * bucketCount[0] + (x - minCell[0]) / kNavigationBucketSize;
+	int32 finish = bucketStart[bucket + 1];
+	for (machine k = bucketStart[bucket]; k < finish; k++)
+	{
+		int32 index = bucketPolygon[k];
+		const NavigationPolygon *polygon = &polygonArray[index];
+		if ((x >= polygon->minCell[0]) && (x < polygon->maxCell[0]) && (y >= polygon->minCell[1]) && (y < polygon->maxCell[1]))
+		{
+			float delta = Fabs(position.z - polygon->floorHeight);
+			if (delta < bestDelta)
+			{
+				bestDelta = delta;
+				result = index;
+			}
+		}
+	}
+
+	return (result);
+}
+
+void NavigationTile::BuildLinks(const NavigationMesh *mesh)
+{
+	int32				nearTile[kMaxNavigationNearTileCount];
+	int32				queryResult[kMaxNavigationQueryCount];
+
+	PurgeLinks();
+
+	// Only tiles whose bounds touch the bounds of this tile can contain polygons that are linked
+	// to polygons in this tile, so the other tiles are ignored when the links are built.
+
+	int32 nearCount = 0;
+	int32 slotCount = mesh->tileArray.GetElementCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		const NavigationTile *tile = mesh->tileArray[a];
+		if ((tile) && (tile != this) && (Adjacent(tile)) && (nearCount < kMaxNavigationNearTileCount))
+		{
+			nearTile[nearCount++] = a;
+		}
+	}
+
+	linkStart = new int32[polygonCount + 1];
+	for (machine a = 0; a < polygonCount; a++)
+	{
+		linkStart[a] = linkArray.GetElementCount();
+
+		const NavigationPolygon *polygon = &polygonArray[a];
+		const NavigationEdge *edge = &edgeArray[polygon->firstEdge];
+		for (machine k = 0; k < polygon->edgeCount; k++)
+		{
+			NavigationLink *link = linkArray.AddElement();
+			link->tileSlot = tileSlot;
+			link->polygonIndex = edge->polygonIndex;
+			link->linkSide = edge->edgeSide;
+			link->minCell = edge->minCell;
+			link->maxCell = edge->maxCell;
+			edge++;
+		}
+
+		for (machine side = 0; side < kNavigationSideCount; side++)
+		{
+			int32	stripMin[2];
+			int32	stripMax[2];
+
+			// The strip is the row of cells just outside one side of the polygon.
+
+			int32 axis = side >> 1;
+			int32 along = axis ^ 1;
+			stripMin[along] = polygon->minCell[along];
+			stripMax[along] = polygon->maxCell[along];
+			stripMin[axis] = (side & 1) ? polygon->maxCell[axis] : polygon->minCell[axis] - 1;
+			stripMax[axis] = stripMin[axis] + 1;
+
+			for (machine t = 0; t < nearCount; t++)
+			{
+				int32 slot = nearTile[t];
+				const NavigationTile *tile = mesh->tileArray[slot];
+
+				int32 count = tile->QueryPolygons(stripMin, stripMax, queryResult, kMaxNavigationQueryCount);
+				for (machine m = 0; m < count; m++)
+				{
+					int32 index = queryResult[m];
+					const NavigationPolygon *target = &tile->polygonArray[index];
+					if (Compatible(polygon, target))
+					{
+						NavigationLink *link = linkArray.AddElement();
+						link->tileSlot = slot;
+						link->polygonIndex = index;
+						link->linkSide = side;
+						link->minCell = Max(target->minCell[along], stripMin[along]);
+						link->maxCell = Min(target->maxCell[along], stripMax[along]);
+
+						if (neighborArray.FindElement(slot) < 0)
+						{
+							neighborArray.AddElement(slot);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	linkStart[polygonCount] = linkArray.GetElementCount();
+}
+
+void NavigationTile::PurgeLinks(void)
+{
+	delete[] linkStart;
+	linkStart = nullptr;
+
+	linkArray.Purge();
+	neighborArray.Purge();
+}
+
+
+NavigationSearch::NavigationSearch()
+{
+	nodeCount = 0;
+	heapCount = 0;
+	corridorStamp = 0;
+}
+
+NavigationSearch::~NavigationSearch()
+{
+}
+
+void NavigationSearch::Reset(void)
+{
+	nodeCount = 0;
+	heapCount = 0;
+	MemoryMgr::FillMemory(nodeHash, sizeof(nodeHash), 0xFF);
+}
+
+int32 NavigationSearch::FindNode(unsigned_int32 key) const
+{
+	unsigned_int32 hash = (key * 0x9E3779B1) >> 18;
+	for (;;)
+	{
+		int32 index = nodeHash[hash];
+		if ((index < 0) || (searchNode[index].nodeKey == key))
+		{
+			return (index);
+		}
+
+		hash = (hash + 1) & (kSearchHashSize - 1);
+	}
+}
+
+int32 NavigationSearch::NewNode(unsigned_int32 key)
+{
+	int32 index = nodeCount;
+	if (index == kMaxNavigationSearchNodeCount)
+	{
+		return (-1);
+	}
+
+	unsigned_int32 hash = (key * 0x9E3779B1) >> 18;
+	while (nodeHash[hash] >= 0)
+	{
+		hash = (hash + 1) & (kSearchHashSize - 1);
+	}
+
+	nodeHash[hash] = index;
+	nodeCount = index + 1;
+
+	SearchNode *node = &searchNode[index];
+	node->nodeKey = key;
+	node->heapIndex = -1;
+	node->closedFlag = false;
+	return (index);
+}
+
+void NavigationSearch::PushHeap(int32 index)
+{
+	int32 position = heapCount++;
+	nodeHeap[position] = index;
+	searchNode[index].heapIndex = position;
+	UpdateHeap(index);
+}
+
+int32 NavigationSearch::PopHeap(void)
+{
+	int32 result = nodeHeap[0];
+	searchNode[result].heapIndex = -1;
+
+	int32 count = --heapCount;
+	if (count > 0)
+	{
+		int32 index = nodeHeap[count];
+		float cost = searchNode[index].totalCost;
+
+		int32 position = 0;
+		for (;;)
+		{
+			int32 child = position * 2 + 1;
+			if (child >= count)
+			{
+				break;
+			}
+
+			if ((child + 1 < count) && (searchNode[nodeHeap[child + 1]].totalCost < searchNode[nodeHeap[child]].totalCost))
+			{
+				child++;
+			}
+
+			int32 childIndex = nodeHeap[child];
+			if (searchNode[childIndex].totalCost >= cost)
+			{
+				break;
+			}
+
+			nodeHeap[position] = childIndex;
+			searchNode[childIndex].heapIndex = position;
+			position = child;
+		}
+
+		nodeHeap[position] = index;
+		searchNode[index].heapIndex = position;
+	}
+
+	return (result);
+}
+
+void NavigationSearch::UpdateHeap(int32 index)
+{
+	float cost = searchNode[index].totalCost;
+	int32 position = searchNode[index].heapIndex;
+	while (position > 0)
+	{
+		int32 parent = (position - 1) >> 1;
+		int32 parentIndex = nodeHeap[parent];
+		if (searchNode[parentIndex].totalCost <= cost)
+		{
+			break;
+		}
+
+		nodeHeap[position] = parentIndex;
+		searchNode[parentIndex].heapIndex = position;
+		position = parent;
+	}
+
+	nodeHeap[position] = index;
+	searchNode[index].heapIndex = position;
+}
+
+
+NavigationMesh::NavigationMesh()
+{
+	tileCount = 0;
+
+	for (machine a = 0; a < kNavigationSearchTableSize; a++)
+	{
+		searchTable[a] = nullptr;
+	}
+}
+
+NavigationMesh::~NavigationMesh()
+{
+	int32 slotCount = tileArray.GetElementCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		NavigationTile *tile = tileArray[a];
+		if (tile)
+		{
+			tile->PurgeLinks();
+			tile->PurgeBuckets();
+			tile->owningMesh = nullptr;
+			tile->tileSlot = -1;
+		}
+	}
+
+	for (machine a = 0; a < kNavigationSearchTableSize; a++)
+	{
+		delete searchTable[a];
+	}
+}
+
+NavigationSearch *NavigationMesh::GetSearch(int32 index)
+{
+	// Each slot in the search table is only ever accessed by one thread, so the search
+	// objects can be created on demand without any synchronization.
+
+	if ((unsigned_int32) index >= (unsigned_int32) (kNavigationSearchTableSize - 1))
+	{
+		index = kNavigationSearchTableSize - 1;
+	}
+
+	NavigationSearch *search = searchTable[index];
+	if (!search)
+	{
+		search = new NavigationSearch;
+		searchTable[index] = search;
+	}
+
+	return (search);
+}
+
+void NavigationMesh::AddTile(NavigationTile *tile)
+{
+	tileLock.AcquireExclusive();
+
+	int32 slot = tileArray.FindElement(nullptr);
+	if (slot < 0)
+	{
+		slot = tileArray.GetElementCount();
+		tileArray.AddElement(tile);
+	}
+	else
+	{
+		tileArray[slot] = tile;
+	}
+
+	tile->owningMesh = this;
+	tile->tileSlot = slot;
+	tileCount++;
+
+	tile->BuildBuckets();
+	tile->BuildLinks(this);
+
+	int32 slotCount = tileArray.GetElementCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		NavigationTile *neighbor = tileArray[a];
+		if ((neighbor) && (neighbor != tile) && (neighbor->Adjacent(tile)))
+		{
+			neighbor->BuildLinks(this);
+		}
+	}
+
+	tileLock.ReleaseExclusive();
+}
+
+void NavigationMesh::RemoveTile(NavigationTile *tile)
+{
+	tileLock.AcquireExclusive();
+
+	int32 slot = tile->tileSlot;
+	tileArray[slot] = nullptr;
+	tileCount--;
+
+	int32 slotCount = tileArray.GetElementCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		NavigationTile *neighbor = tileArray[a];
+		if ((neighbor) && (neighbor->neighborArray.FindElement(slot) >= 0))
+		{
+			neighbor->BuildLinks(this);
+		}
+	}
+
+	tile->PurgeLinks();
+	tile->PurgeBuckets();
+	tile->owningMesh = nullptr;
+	tile->tileSlot = -1;
+
+	tileLock.ReleaseExclusive();
+}
+
+void NavigationMesh::GetPortalPoints(const NavigationPolygon *polygon, const NavigationLink *link, Point2D *left, Point2D *right)
+{
+	// The left and right endpoints of a portal are determined with respect to the direction in
+	// which a path crosses the side of the polygon.
+
+	float minAlong = (float) link->minCell * kNavigationCellSize;
+	float maxAlong = (float) link->maxCell * kNavigationCellSize;
+
+	switch (link->linkSide)
+	{
+		case kNavigationSideMinX:
+		{
+			float x = (float) polygon->minCell[0] * kNavigationCellSize;
+			left->Set(x, minAlong);
+			right->Set(x, maxAlong);
+			break;
+		}
+
+		case kNavigationSideMaxX:
+		{
+			float x = (float) polygon->maxCell[0] * kNavigationCellSize;
+			left->Set(x, maxAlong);
+			right->Set(x, minAlong);
+			break;
+		}
+
+		case kNavigationSideMinY:
+		{
+			float y = (float) polygon->minCell[1] * kNavigationCellSize;
+			left->Set(maxAlong, y);
+			right->Set(minAlong, y);
+			break;
+		}
+
+		default:
+		{
+			float y = (float) polygon->maxCell[1] * kNavigationCellSize;
+			left->Set(minAlong, y);
+			right->Set(maxAlong, y);
+			break;
+		}
+	}
+}
+
+bool NavigationMesh::LocatePosition(const Point3D& position, int32 *slot, int32 *polygon) const
+{
+	int32 bestSlot = -1;
+	int32 bestPolygon = -1;
+	float bestDistance = K::infinity;
+
+	int32 slotCount = tileArray.GetElementCount();
+	for (machine a = 0; a < slotCount; a++)
+	{
+		const NavigationTile *tile = tileArray[a];
+		if (tile)
+		{
+			int32 index = tile->FindPolygon(position, kNavigationVerticalRange);
+			if (index >= 0)
+			{
+				float distance = Fabs(position.z - tile->polygonArray[index].floorHeight);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestSlot = a;
+					bestPolygon = index;
+				}
+			}
+		}
+	}
+
+	if (bestSlot < 0)
+	{
+		// The position isn't directly above any polygon, so the nearest polygon within a short
+		// horizontal distance is used instead. This handles positions that lie in the margin
+		// removed by the agent radius.
+
+		int32 range = (int32) (kNavigationNearestRange * kInverseNavigationCellSize);
+		int32 x = (int32) Floor(position.x * kInverseNavigationCellSize);
+		int32 y = (int32) Floor(position.y * kInverseNavigationCellSize);
+
+		int32 rectMin[2] = {x - range, y - range};
+		int32 rectMax[2] = {x + range + 1, y + range + 1};
+		int32 queryResult[kMaxNavigationQueryCount];
+
+		bestDistance = kNavigationNearestRange * kNavigationNearestRange;
+		for (machine a = 0; a < slotCount; a++)
+		{
+			const NavigationTile *tile = tileArray[a];
+			if (tile)
+			{
+				int32 count = tile->QueryPolygons(rectMin, rectMax, queryResult, kMaxNavigationQueryCount);
+				for (machine k = 0; k < count; k++)
+				{
+					int32 index = queryResult[k];
+					const NavigationPolygon *target = &tile->polygonArray[index];
+					if (Fabs(position.z - target->floorHeight) < kNavigationVerticalRange)
+					{
+						float dx = Fmax((float) target->minCell[0] * kNavigationCellSize - position.x, position.x - (float) target->maxCell[0] * kNavigationCellSize, 0.0F);
+						float dy = Fmax((float) target->minCell[1] * kNavigationCellSize - position.y, position.y - (float) target->maxCell[1] * kNavigationCellSize, 0.0F);
+						float distance = dx * dx + dy * dy;
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							bestSlot = a;
+							bestPolygon = index;
+						}
+					}
+				}
+			}
+		}
+
+		if (bestSlot < 0)
+		{
+			return (false);
+		}
+	}
+
+	*slot = bestSlot;
+	*polygon = bestPolygon;
+	return (true);
+}
+
+bool NavigationMesh::FindTileCorridor(NavigationSearch *search, int32 startSlot, int32 goalSlot) const
+{
+	// A* is run over the graph of tiles connected by links. The tiles along the resulting route
+	// and the tiles adjacent to them are marked as the corridor for the polygon search.
+
+	int32 slotCount = tileArray.GetElementCount();
+	search->tileParent.SetElementCount(slotCount);
+	search->tileCost.SetElementCount(slotCount);
+	search->corridorArray.SetElementCount(slotCount, &search->corridorStamp);
+
+	unsigned_int32 stamp = search->corridorStamp + 1;
+	if (stamp == 0)
+	{
+		search->corridorArray.Clear();
+		search->corridorArray.SetElementCount(slotCount, &stamp);
+		stamp = 1;
+	}
+
+	search->corridorStamp = stamp;
+	unsigned_int32 openStamp = stamp ^ 0x80000000;
+	unsigned_int32 closedStamp = stamp ^ 0x40000000;
+
+	const NavigationTile *goalTile = tileArray[goalSlot];
+	float goalX = (float) (goalTile->minCell[0] + goalTile->maxCell[0]) * (kNavigationCellSize * 0.5F);
+	float goalY = (float) (goalTile->minCell[1] + goalTile->maxCell[1]) * (kNavigationCellSize * 0.5F);
+
+	search->tileParent[startSlot] = -1;
+	search->tileCost[startSlot] = 0.0F;
+	search->corridorArray[startSlot] = openStamp;
+
+	bool found = false;
+	for (;;)
+	{
+		int32 current = -1;
+		float bestCost = K::infinity;
+
+		for (machine a = 0; a < slotCount; a++)
+		{
+			if (search->corridorArray[a] == openStamp)
+			{
+				const NavigationTile *tile = tileArray[a];
+				float dx = (float) (tile->minCell[0] + tile->maxCell[0]) * (kNavigationCellSize * 0.5F) - goalX;
+				float dy = (float) (tile->minCell[1] + tile->maxCell[1]) * (kNavigationCellSize * 0.5F) - goalY;
+				float cost = search->tileCost[a] + Sqrt(dx * dx + dy * dy);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					current = a;
+				}
+			}
+		}
+
+		if (current < 0)
+		{
+			break;
+		}
+
+		search->corridorArray[current] = closedStamp;
+		if (current == goalSlot)
+		{
+			found = true;
+			break;
+		}
+
+		const NavigationTile *tile = tileArray[current];
+		float cx = (float) (tile->minCell[0] + tile->maxCell[0]) * (kNavigationCellSize * 0.5F);
+		float cy = (float) (tile->minCell[1] + tile->maxCell[1]) * (kNavigationCellSize * 0.5F);
+
+		int32 neighborCount = tile->neighborArray.GetElementCount();
+		for (machine k = 0; k < neighborCount; k++)
+		{
+			int32 slot = tile->neighborArray[k];
+			if (search->corridorArray[slot] == closedStamp)
+			{
+				continue;
+			}
+
+			const NavigationTile *neighbor = tileArray[slot];
+			float dx = (float) (neighbor->minCell[0] + neighbor->maxCell[0]) * (kNavigationCellSize * 0.5F) - cx;
+			float dy = (float) (neighbor->minCell[1] + neighbor->maxCell[1]) * (kNavigationCellSize * 0.5F) - cy;
+			float cost = search->tileCost[current] + Sqrt(dx * dx + dy * dy);
+
+			if ((search->corridorArray[slot] != openStamp) || (cost < search->tileCost[slot]))
+			{
+				search->tileParent[slot] = current;
+				search->tileCost[slot] = cost;
+				search->corridorArray[slot] = openStamp;
+			}
+		}
+	}
+
+	if (!found)
+	{
+		return (false);
+	}
+
+	int32 slot = goalSlot;
+	while (slot >= 0)
+	{
+		search->corridorArray[slot] = stamp;
+		slot = search->tileParent[slot];
+	}
+
+	slot = goalSlot;
+	while (slot >= 0)
+	{
+		const NavigationTile *tile = tileArray[slot];
+		int32 neighborCount = tile->neighborArray.GetElementCount();
+		for (machine k = 0; k < neighborCount; k++)
+		{
+			search->corridorArray[tile->neighborArray[k]] = stamp;
+		}
+
+		slot = search->tileParent[slot];
+	}
+
+	return (true);
+}
+
+int32 NavigationMesh::SearchPolygons(NavigationSearch *search, int32 startSlot, int32 startPolygon, int32 goalSlot, int32 goalPolygon, const Point3D& start, const Point3D& goal, bool corridor, bool *complete) const
+{
+	search->Reset();
+
+	unsigned_int32 goalKey = ((unsigned_int32) goalSlot << kNavigationPolygonShift) | goalPolygon;
+	unsigned_int32 stamp = search->corridorStamp;
+
+	int32 startIndex = search->NewNode(((unsigned_int32) startSlot << kNavigationPolygonShift) | startPolygon);
+	NavigationSearch::SearchNode *startNode = &search->searchNode[startIndex];
+	startNode->parentIndex = -1;
+	startNode->costSoFar = 0.0F;
+	startNode->totalCost = Heuristic(start, goal);
+	startNode->nodePosition = start;
+	search->PushHeap(startIndex);
+
+	int32 bestIndex = startIndex;
+	float bestHeuristic = startNode->totalCost;
+
+	while (search->heapCount > 0)
+	{
+		int32 index = search->PopHeap();
+		NavigationSearch::SearchNode *node = &search->searchNode[index];
+		node->closedFlag = true;
+
+		unsigned_int32 key = node->nodeKey;
+		if (key == goalKey)
+		{
+			*complete = true;
+			return (index);
+		}
+
+		float heuristic = node->totalCost - node->costSoFar;
+		if (heuristic < bestHeuristic)
+		{
+			bestHeuristic = heuristic;
+			bestIndex = index;
+		}
+
+		const NavigationTile *tile = tileArray[key >> kNavigationPolygonShift];
+		int32 polygonIndex = key & ((1 << kNavigationPolygonShift) - 1);
+		const NavigationPolygon *polygon = &tile->polygonArray[polygonIndex];
+
+		int32 finish = tile->linkStart[polygonIndex + 1];
+		for (machine k = tile->linkStart[polygonIndex]; k < finish; k++)
+		{
+			const NavigationLink *link = &tile->linkArray[k];
+			if ((corridor) && (search->corridorArray[link->tileSlot] != stamp))
+			{
+				continue;
+			}
+
+			unsigned_int32 targetKey = ((unsigned_int32) link->tileSlot << kNavigationPolygonShift) | link->polygonIndex;
+			int32 targetIndex = search->FindNode(targetKey);
+			if ((targetIndex >= 0) && (search->searchNode[targetIndex].closedFlag))
+			{
+				continue;
+			}
+
+			Point2D		left;
+			Point2D		right;
+
+			GetPortalPoints(polygon, link, &left, &right);
+			const NavigationPolygon *target = &tileArray[link->tileSlot]->polygonArray[link->polygonIndex];
+			Point3D position((left.x + right.x) * 0.5F, (left.y + right.y) * 0.5F, (polygon->floorHeight + target->floorHeight) * 0.5F);
+
+			float cost = node->costSoFar + Heuristic(node->nodePosition, position);
+			if (targetKey == goalKey)
+			{
+				cost += Heuristic(position, goal);
+			}
+
+			if (targetIndex < 0)
+			{
+				targetIndex = search->NewNode(targetKey);
+				if (targetIndex < 0)
+				{
+					continue;
+				}
+			}
+			else if (cost >= search->searchNode[targetIndex].costSoFar)
+			{
+				continue;
+			}
+
+			NavigationSearch::SearchNode *targetNode = &search->searchNode[targetIndex];
+			targetNode->parentIndex = index;
+			targetNode->costSoFar = cost;
+			targetNode->totalCost = cost + ((targetKey == goalKey) ? 0.0F : Heuristic(position, goal));
+			targetNode->nodePosition = position;
+			targetNode->portalLeft = left;
+			targetNode->portalRight = right;
+
+			if (targetNode->heapIndex < 0)
+			{
+				search->PushHeap(targetIndex);
+			}
+			else
+			{
+				search->UpdateHeap(targetIndex);
+			}
+		}
+	}
+
+	*complete = false;
+	return (bestIndex);
+}
+
+void NavigationMesh::BuildPath(NavigationSearch *search, int32 nodeIndex, const Point3D& start, const Point3D& goal, bool complete, Array<Point3D> *path) const
+{
+	Array<int32, 64>		chain;
+
+	for (int32 index = nodeIndex; index >= 0; index = search->searchNode[index].parentIndex)
+	{
+		chain.AddElement(index);
+	}
+
+	int32 chainLength = chain.GetElementCount();
+
+	const NavigationSearch::SearchNode *lastNode = &search->searchNode[nodeIndex];
+	unsigned_int32 lastKey = lastNode->nodeKey;
+	const NavigationPolygon *lastPolygon = &tileArray[lastKey >> kNavigationPolygonShift]->polygonArray[lastKey & ((1 << kNavigationPolygonShift) - 1)];
+
+	Point3D finish = goal;
+	if (!complete)
+	{
+		// The path ends at the point inside the last polygon that is closest to the goal.
+
+		float minX = (float) lastPolygon->minCell[0] * kNavigationCellSize;
+		float maxX = (float) lastPolygon->maxCell[0] * kNavigationCellSize;
+		float minY = (float) lastPolygon->minCell[1] * kNavigationCellSize;
+		float maxY = (float) lastPolygon->maxCell[1] * kNavigationCellSize;
+		finish.Set(Fmin(Fmax(goal.x, minX), maxX), Fmin(Fmax(goal.y, minY), maxY), lastPolygon->floorHeight);
+	}
+
+	path->AddElement(start);
+
+	// The chain of polygons is straightened with the funnel algorithm. The portal at position k
+	// is crossed when entering the polygon for node chain[chainLength - 1 - k], and the final
+	// portal is degenerate at the end of the path.
+
+	Point2D apex(start.x, start.y);
+	Point2D portalLeft = apex;
+	Point2D portalRight = apex;
+	int32 apexPortal = 0;
+	int32 leftPortal = 0;
+	int32 rightPortal = 0;
+
+	for (machine k = 1; k <= chainLength; k++)
+	{
+		Point2D		left;
+		Point2D		right;
+
+		if (k < chainLength)
+		{
+			const NavigationSearch::SearchNode *node = &search->searchNode[chain[chainLength - 1 - k]];
+			left = node->portalLeft;
+			right = node->portalRight;
+		}
+		else
+		{
+			left.Set(finish.x, finish.y);
+			right = left;
+		}
+
+		if (((right - apex) ^ (portalRight - apex)) <= 0.0F)
+		{
+			if ((apex == portalRight) || (((right - apex) ^ (portalLeft - apex)) > 0.0F))
+			{
+				portalRight = right;
+				rightPortal = k;
+			}
+			else
+			{
+				const NavigationSearch::SearchNode *node = &search->searchNode[chain[chainLength - 1 - leftPortal]];
+				path->AddElement(Point3D(portalLeft.x, portalLeft.y, (leftPortal != 0) ? node->nodePosition.z : start.z));
+
+				apex = portalLeft;
+				apexPortal = leftPortal;
+				portalRight = apex;
+				rightPortal = apexPortal;
+				k = apexPortal;
+				continue;
+			}
+		}
+
+		if (((left - apex) ^ (portalLeft - apex)) >= 0.0F)
+		{
+			if ((apex == portalLeft) || (((left - apex) ^ (portalRight - apex)) < 0.0F))
+			{
+				portalLeft = left;
+				leftPortal = k;
+			}
+			else
+			{
+				const NavigationSearch::SearchNode *node = &search->searchNode[chain[chainLength - 1 - rightPortal]];
+				path->AddElement(Point3D(portalRight.x, portalRight.y, (rightPortal != 0) ? node->nodePosition.z : start.z));
+
+				apex = portalRight;
+				apexPortal = rightPortal;
+				portalLeft = apex;
+				leftPortal = apexPortal;
+				k = apexPortal;
+				continue;
+			}
+		}
+	}
+
+	path->AddElement(finish);
+}
+
+NavigationResult NavigationMesh::FindPath(const Point3D& start, const Point3D& goal, Array<Point3D> *path, int32 searchIndex)
+{
+	int32	startSlot;
+	int32	startPolygon;
+	int32	goalSlot;
+	int32	goalPolygon;
+
+	path->Clear();
+	NavigationSearch *search = GetSearch(searchIndex);
+
+	tileLock.AcquireShared();
+
+	if (!LocatePosition(start, &startSlot, &startPolygon))
+	{
+		tileLock.ReleaseShared();
+		return (kNavigationPathNone);
+	}
+
+	bool complete = false;
+	int32 nodeIndex = -1;
+
+	if (LocatePosition(goal, &goalSlot, &goalPolygon))
+	{
+		if ((startSlot != goalSlot) && (FindTileCorridor(search, startSlot, goalSlot)))
+		{
+			nodeIndex = SearchPolygons(search, startSlot, startPolygon, goalSlot, goalPolygon, start, goal, true, &complete);
+		}
+
+		if (!complete)
+		{
+			nodeIndex = SearchPolygons(search, startSlot, startPolygon, goalSlot, goalPolygon, start, goal, false, &complete);
+		}
+	}
+	else
+	{
+		// If the goal isn't on the mesh, then the search can't finish, and the path leads to
+		// the reachable polygon that's closest to the goal.
+
+		nodeIndex = SearchPolygons(search, startSlot, startPolygon, -1, 0, start, goal, false, &complete);
+	}
+
+	BuildPath(search, nodeIndex, start, goal, complete, path);
+
+	tileLock.ReleaseShared();
+	return ((complete) ? kNavigationPathComplete : kNavigationPathPartial);
+}
+
+bool NavigationMesh::GetRandomPosition(Point3D *position) const
+{
+	bool result = false;
+
+	tileLock.AcquireShared();
+
+	int32 slotCount = tileArray.GetElementCount();
+	if (tileCount != 0)
+	{
+		const NavigationTile *tile = nullptr;
+		while (!tile)
+		{
+			tile = tileArray[Math::Random(slotCount)];
+		}
+
+		const NavigationPolygon *polygon = &tile->polygonArray[Math::Random(tile->polygonCount)];
+		float x = (float) polygon->minCell[0] + Math::RandomFloat((float) (polygon->maxCell[0] - polygon->minCell[0]));
+		float y = (float) polygon->minCell[1] + Math::RandomFloat((float) (polygon->maxCell[1] - polygon->minCell[1]));
+		position->Set(x * kNavigationCellSize, y * kNavigationCellSize, polygon->floorHeight);
+		result = true;
+	}
+
+	tileLock.ReleaseShared();
+	return (result);
+}
+
+
+NavigationQuery::NavigationQuery() : Job(&JobExecuteQuery, this)
+{
+	queryMesh = nullptr;
+	queryResult = kNavigationPathNone;
+	submitFlag = false;
+}
+
+NavigationQuery::~NavigationQuery()
+{
+	// If the query is executing, then it must finish before the path array is destroyed. The base
+	// class destructor would wait too, but only after the members of this class are already gone.
+	// A query that is cancelled before it starts is marked complete, so FinishJob() returns for it.
+
+	if (submitFlag)
+	{
+		TheJobMgr->CancelJob(this);
+		JobMgr::FinishJob(this);
+	}
+}
+
+void NavigationQuery::JobExecuteQuery(Job *job, void *cookie)
+{
+	NavigationQuery *query = static_cast<NavigationQuery *>(cookie);
+	query->queryResult = query->queryMesh->FindPath(query->startPosition, query->goalPosition, &query->pathArray, job->GetThreadIndex());
+}
+
+void NavigationQuery::Submit(NavigationMesh *mesh, const Point3D& start, const Point3D& goal)
+{
+	queryMesh = mesh;
+	startPosition = start;
+	goalPosition = goal;
+	queryResult = kNavigationPathNone;
+
+	submitFlag = true;
+	TheJobMgr->SubmitJob(this);
+}
+
+// ZYUQURM
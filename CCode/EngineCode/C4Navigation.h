@@ -0,0 +1,476 @@
+ 
+
+#ifndef C4Navigation_h
+#define C4Navigation_h
+
+
+//# \component	World Manager
+//# \prefix		WorldMgr/
+
+
+#include "C4Threads.h"
+#include "C4Packing.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kNavigationBucketSize				= 8,
+		kMaxNavigationRectangleSize			= 32,
+		kMaxNavigationGridSize				= 2048,
+		kMaxNavigationSearchNodeCount		= 4096,
+		kNavigationSearchTableSize			= 33,
+		kMaxNavigationNearTileCount			= 64,
+		kMaxNavigationQueryCount			= 128,
+		kNavigationPolygonShift				= 18
+	};
+
+
+	enum
+	{
+		kNavigationSideMinX,
+		kNavigationSideMaxX,
+		kNavigationSideMinY,
+		kNavigationSideMaxY,
+		kNavigationSideCount
+	};
+
+
+	//# \enum	NavigationResult
+
+	enum NavigationResult
+	{
+		kNavigationPathNone,				//## No path was found because the start or goal position is not on the navigation mesh.
+		kNavigationPathPartial,				//## The goal could not be reached, and the path ends at the reachable position closest to the goal.
+		kNavigationPathComplete				//## The path reaches the goal.
+	};
+
+
+	const float kNavigationCellSize = 0.25F;
+	const float kInverseNavigationCellSize = 4.0F;
+
+
+	class Zone;
+	class Mesh;
+	class NavigationMesh;
+
+
+	//# \struct	NavigationBuildParams	Contains the agent dimensions used to build a navigation tile.
+	//
+	//# The $NavigationBuildParams$ structure contains the agent dimensions used to build a navigation tile.
+	//
+	//# \def	struct NavigationBuildParams
+	//
+	//# \data	NavigationBuildParams
+	//
+	//# \also	$@NavigationTile::Build@$
+
+
+	//# \member		NavigationBuildParams
+
+	struct NavigationBuildParams
+	{
+		float		agentHeight;			//## The vertical clearance that a walkable cell must have.
+		float		agentRadius;			//## The distance by which the walkable area is pulled away from obstacles and ledges.
+		float		maxClimbHeight;			//## The largest height difference between neighboring cells that an agent can step over.
+		float		maxSlopeCosine;			//## The cosine of the steepest slope that an agent can walk on.
+
+		C4API NavigationBuildParams();
+	};
+
+
+	// A NavigationPolygon is an axis-aligned rectangle of walkable cells. The cell coordinates are
+	// global so that the polygons belonging to different tiles line up exactly, and the maximum
+	// coordinates are exclusive. The floor heights of all cells covered by a polygon lie between
+	// the minimum and maximum heights, and the average floor height is used for path points.
+
+	struct NavigationPolygon
+	{
+		int32		minCell[2];
+		int32		maxCell[2];
+		float		minHeight;
+		float		maxHeight;
+		float		floorHeight;
+		int32		firstEdge;
+		int32		edgeCount;
+	};
+
+
+	// A NavigationEdge connects a polygon to another polygon in the same tile across one of its
+	// sides. The cell range along the side is the portal through which a path can pass.
+
+	struct NavigationEdge
+	{
+		int32		polygonIndex;
+		int32		edgeSide;
+		int32		minCell;
+		int32		maxCell;
+	};
+
+
+	// A NavigationLink is the runtime form of an edge. Links to polygons in other tiles are
+	// created when a tile is added to a navigation mesh, so the target of a link is identified
+	// by the tile's slot in the mesh as well as the polygon index.
+
+	struct NavigationLink
+	{
+		int32		tileSlot;
+		int32		polygonIndex;
+		int32		linkSide;
+		int32		minCell;
+		int32		maxCell;
+	};
+
+
+	//# \class	NavigationTile		Contains the navigation polygons for one zone.
+	//
+	//# The $NavigationTile$ class contains the navigation polygons for one zone.
+	//
+	//# \def	class NavigationTile
+	//
+	//# \ctor	NavigationTile();
+	//
+	//# \desc
+	//# A navigation tile holds the walkable area inside a single zone as a set of axis-aligned rectangles
+	//# on a global grid of cells $kNavigationCellSize$ meters wide. Tiles are normally built in the World Editor
+	//# by calling the $@NavigationTile::Build@$ function and stored with the zone in the world resource. When the
+	//# zone is preprocessed, its tile is added to the world's $@NavigationMesh@$, and it is linked to the tiles
+	//# belonging to any neighboring zones. When the zone is neutralized or deleted, the tile is removed again,
+	//# so navigation data is streamed in and out of the mesh along with the zones.
+	//
+	//# \also	$@NavigationMesh@$
+	//# \also	$@Zone::GetNavigationTile@$
+
+
+	//# \function	NavigationTile::Build		Builds a navigation tile from the geometry in a zone.
+	//
+	//# \proto	static NavigationTile *Build(const Zone *zone, const NavigationBuildParams *params);
+	//
+	//# \param	zone		The zone for which to build the tile.
+	//# \param	params		The agent dimensions.
+	//
+	//# \desc
+	//# The $Build$ function rasterizes the collision geometry belonging to the zone specified by the $zone$ parameter,
+	//# excluding geometry inside subzones, geometry under nodes that have controllers, and geometry that does not
+	//# collide with characters. The cells having enough clearance above a sufficiently flat floor are pulled away
+	//# from obstacles by the agent radius and then merged into rectangles. The return value is a pointer to a new
+	//# navigation tile, or $nullptr$ if the zone does not contain any walkable area.
+	//#
+	//# The world transforms of the geometry nodes must be up to date when the $Build$ function is called.
+
+
+	class NavigationTile
+	{
+		friend class NavigationMesh;
+		friend class NavigationBuilder;
+
+		private:
+
+			int32					polygonCount;
+			int32					edgeCount;
+			NavigationPolygon		*polygonArray;
+			NavigationEdge			*edgeArray;
+
+			int32					minCell[2];
+			int32					maxCell[2];
+			float					minHeight;
+			float					maxHeight;
+			float					maxClimbHeight;
+
+			NavigationMesh			*owningMesh;
+			int32					tileSlot;
+
+			int32					bucketCount[2];
+			int32					*bucketStart;
+			int32					*bucketPolygon;
+
+			int32					*linkStart;
+			Array<NavigationLink>	linkArray;
+			Array<int32>			neighborArray;
+
+			void Allocate(int32 polyCount, int32 edgeTotal);
+
+			void BuildBuckets(void);
+			void PurgeBuckets(void);
+
+			int32 QueryPolygons(const int32 *rectMin, const int32 *rectMax, int32 *result, int32 maxCount) const;
+
+			void BuildLinks(const NavigationMesh *mesh);
+			void PurgeLinks(void);
+
+			bool Adjacent(const NavigationTile *tile) const
+			{
+				return ((tile->minCell[0] <= maxCell[0]) && (tile->maxCell[0] >= minCell[0]) && (tile->minCell[1] <= maxCell[1]) && (tile->maxCell[1] >= minCell[1]) && (tile->minHeight - maxHeight <= maxClimbHeight) && (minHeight - tile->maxHeight <= maxClimbHeight));
+			}
+
+			bool Compatible(const NavigationPolygon *polygon1, const NavigationPolygon *polygon2) const
+			{
+				return ((polygon2->minHeight - polygon1->maxHeight <= maxClimbHeight) && (polygon1->minHeight - polygon2->maxHeight <= maxClimbHeight));
+			}
+
+		public:
+
+			C4API NavigationTile();
+			C4API ~NavigationTile();
+
+			int32 GetPolygonCount(void) const
+			{
+				return (polygonCount);
+			}
+
+			const NavigationPolygon *GetPolygon(int32 index) const
+			{
+				return (&polygonArray[index]);
+			}
+
+			int32 GetEdgeCount(void) const
+			{
+				return (edgeCount);
+			}
+
+			const NavigationEdge *GetEdge(int32 index) const
+			{
+				return (&edgeArray[index]);
+			}
+
+			NavigationMesh *GetOwningMesh(void) const
+			{
+				return (owningMesh);
+			}
+
+			void Pack(Packer& data) const;
+			void Unpack(Unpacker& data);
+
+			int32 FindPolygon(const Point3D& position, float verticalRange) const;
+
+			C4API static NavigationTile *Build(const Zone *zone, const NavigationBuildParams *params);
+	};
+
+
+	// The NavigationSearch class holds the scratch storage for one path search. The navigation mesh
+	// keeps one search object for the main thread and one for each worker thread, each created the
+	// first time its thread runs a query, so that concurrent queries never contend for storage.
+
+	class NavigationSearch
+	{
+		friend class NavigationMesh;
+
+		private:
+
+			enum
+			{
+				kSearchHashSize		= kMaxNavigationSearchNodeCount * 2
+			};
+
+			struct SearchNode
+			{
+				unsigned_int32		nodeKey;
+				int32				parentIndex;
+				float				costSoFar;
+				float				totalCost;
+				int32				heapIndex;
+				Point3D				nodePosition;
+				Point2D				portalLeft;
+				Point2D				portalRight;
+				bool				closedFlag;
+			};
+
+			int32					nodeCount;
+			SearchNode				searchNode[kMaxNavigationSearchNodeCount];
+			int32					nodeHash[kSearchHashSize];
+
+			int32					heapCount;
+			int32					nodeHeap[kMaxNavigationSearchNodeCount];
+
+			unsigned_int32			corridorStamp;
+			Array<unsigned_int32>	corridorArray;
+
+			Array<int32>			tileParent;
+			Array<float>			tileCost;
+
+			void Reset(void);
+
+			int32 FindNode(unsigned_int32 key) const;
+			int32 NewNode(unsigned_int32 key);
+
+			void PushHeap(int32 index);
+			int32 PopHeap(void);
+			void UpdateHeap(int32 index);
+
+		public:
+
+			NavigationSearch();
+			~NavigationSearch();
+	};
+
+
+	//# \class	NavigationMesh		Manages the navigation tiles that are loaded into a world.
+	//
+	//# The $NavigationMesh$ class manages the navigation tiles that are loaded into a world.
+	//
+	//# \def	class NavigationMesh
+	//
+	//# \desc
+	//# Every world has a single navigation mesh, returned by the $@World::GetNavigationMesh@$ function. The tiles
+	//# belonging to zones are added and removed automatically as the zones are preprocessed and neutralized.
+	//#
+	//# Paths are found with a hierarchical search. A corridor of tiles leading toward the goal is first found
+	//# with an A* search over the tile connections, and the polygon search is then limited to that corridor.
+	//# If the polygon search fails inside the corridor, it is repeated over the whole mesh. The resulting chain
+	//# of polygons is straightened with a funnel algorithm to produce the final path points.
+	//#
+	//# Path queries can be made on any thread. The $@NavigationQuery@$ class runs a query as a job on one of the
+	//# Job Manager's worker threads.
+	//
+	//# \also	$@NavigationTile@$
+	//# \also	$@NavigationQuery@$
+
+
+	//# \function	NavigationMesh::FindPath		Finds a path between two positions.
+	//
+	//# \proto	NavigationResult FindPath(const Point3D& start, const Point3D& goal, Array<Point3D> *path);
+	//
+	//# \param	start		The starting position, in world space.
+	//# \param	goal		The goal position, in world space.
+	//# \param	path		An array that receives the path points. The first point is the starting position.
+	//
+	//# \desc
+	//# The $FindPath$ function finds a path from the position specified by the $start$ parameter to the position
+	//# specified by the $goal$ parameter and returns one of the following constants.
+	//
+	//# \table	NavigationResult
+	//
+	//# If the goal cannot be reached, then the path ends at the reachable position that is closest to the goal.
+	//# This function must be called on the main thread. Other threads should use the $@NavigationQuery@$ class.
+	//
+	//# \also	$@NavigationQuery@$
+
+
+	class NavigationMesh
+	{
+		friend class NavigationTile;
+
+		private:
+
+			mutable Lock				tileLock;
+			Array<NavigationTile *>		tileArray;
+			int32						tileCount;
+
+			NavigationSearch			*searchTable[kNavigationSearchTableSize];
+
+			static float Heuristic(const Point3D& p1, const Point3D& p2)
+			{
+				return (Sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y)));
+			}
+
+			NavigationSearch *GetSearch(int32 index);
+
+			static void GetPortalPoints(const NavigationPolygon *polygon, const NavigationLink *link, Point2D *left, Point2D *right);
+
+			bool LocatePosition(const Point3D& position, int32 *slot, int32 *polygon) const;
+
+			bool FindTileCorridor(NavigationSearch *search, int32 startSlot, int32 goalSlot) const;
+			int32 SearchPolygons(NavigationSearch *search, int32 startSlot, int32 startPolygon, int32 goalSlot, int32 goalPolygon, const Point3D& start, const Point3D& goal, bool corridor, bool *complete) const;
+			void BuildPath(NavigationSearch *search, int32 nodeIndex, const Point3D& start, const Point3D& goal, bool complete, Array<Point3D> *path) const;
+
+		public:
+
+			NavigationMesh();
+			~NavigationMesh();
+
+			int32 GetTileCount(void) const
+			{
+				return (tileCount);
+			}
+
+			void AddTile(NavigationTile *tile);
+			void RemoveTile(NavigationTile *tile);
+
+			C4API NavigationResult FindPath(const Point3D& start, const Point3D& goal, Array<Point3D> *path, int32 searchIndex = -1);
+			C4API bool GetRandomPosition(Point3D *position) const;
+	};
+
+
+	//# \class	NavigationQuery		Runs a path query on a worker thread.
+	//
+	//# The $NavigationQuery$ class runs a path query on a worker thread.
+	//
+	//# \def	class NavigationQuery : public Job
+	//
+	//# \ctor	NavigationQuery();
+	//
+	//# \desc
+	//# A $NavigationQuery$ object is submitted with the $@NavigationQuery::Submit@$ function, and the query is complete
+	//# when the $@Job::Complete@$ function returns $true$. The result can then be retrieved with the
+	//# $@NavigationQuery::GetQueryResult@$ and $@NavigationQuery::GetPathArray@$ functions. A query object can be
+	//# submitted again after it completes. If a query object is destroyed while it is pending, then the query is
+	//# cancelled.
+	//
+	//# \base	Job		A navigation query is a special type of job.
+	//
+	//# \also	$@NavigationMesh@$
+
+
+	//# \function	NavigationQuery::Submit		Submits a path query to the Job Manager.
+	//
+	//# \proto	void Submit(NavigationMesh *mesh, const Point3D& start, const Point3D& goal);
+	//
+	//# \param	mesh		The navigation mesh to search.
+	//# \param	start		The starting position, in world space.
+	//# \param	goal		The goal position, in world space.
+	//
+	//# \desc
+	//# The $Submit$ function submits a path query to the Job Manager. The query must not already be pending.
+	//
+	//# \also	$@NavigationMesh::FindPath@$
+
+
+	class NavigationQuery : public Job
+	{
+		private:
+
+			NavigationMesh			*queryMesh;
+			Point3D					startPosition;
+			Point3D					goalPosition;
+
+			NavigationResult		queryResult;
+			Array<Point3D>			pathArray;
+
+			bool					submitFlag;
+
+			static void JobExecuteQuery(Job *job, void *cookie);
+
+		public:
+
+			C4API NavigationQuery();
+			C4API ~NavigationQuery();
+
+			const Point3D& GetStartPosition(void) const
+			{
+				return (startPosition);
+			}
+
+			const Point3D& GetGoalPosition(void) const
+			{
+				return (goalPosition);
+			}
+
+			NavigationResult GetQueryResult(void) const
+			{
+				return (queryResult);
+			}
+
+			const ImmutableArray<Point3D>& GetPathArray(void) const
+			{
+				return (pathArray);
+			}
+
+			C4API void Submit(NavigationMesh *mesh, const Point3D& start, const Point3D& goal);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
@@ -18,8 +18,56 @@
 using namespace C4;
 
 
+namespace
+{
+	enum
+	{
+		kMaxObjectUnpackJobObjectCount		= 64,
+		kObjectUnpackJobDataSize			= 256 * 1024
+	};
+}
+
+
 namespace C4
 {
+	class ObjectUnpackJob : public BatchJob
+	{
+		private:
+
+			Unpacker			*targetUnpacker;
+			unsigned_int32		unpackFlags;
+
+			int32				objectCount;
+			unsigned_int32		dataSize;
+
+			Object				*unpackObject[kMaxObjectUnpackJobObjectCount];
+			const void			*unpackData[kMaxObjectUnpackJobObjectCount];
+
+			List<ObjectLink>	objectLinkList;
+			List<NodeLink>		nodeLinkList;
+
+			static void JobUnpackObjects(Job *job, void *cookie);
+			static void FinalizeUnpackObjects(Job *job, void *cookie);
+
+		public:
+
+			ObjectUnpackJob(Unpacker *unpacker, unsigned_int32 flags);
+
+			bool Full(void) const
+			{
+				return ((objectCount == kMaxObjectUnpackJobObjectCount) || (dataSize >= kObjectUnpackJobDataSize));
+			}
+
+			void AddObject(Object *object, const void *data, unsigned_int32 size)
+			{
+				unpackObject[objectCount] = object;
+				unpackData[objectCount] = data;
+				objectCount++;
+				dataSize += size;
+			}
+	};
+
+
 	struct ConnectorData
 	{
 		ConnectorKey	connectorKey;
@@ -40,6 +88,82 @@ namespace C4
 const char C4::kConnectorKeyMember[] = "%Member";
 
 
+ObjectUnpackJob::ObjectUnpackJob(Unpacker *unpacker, unsigned_int32 flags) : BatchJob(&JobUnpackObjects, &FinalizeUnpackObjects, nullptr, kJobNonpersistent)
+{
+	targetUnpacker = unpacker;
+	unpackFlags = flags;
+
+	objectCount = 0;
+	dataSize = 0;
+}
+
+void ObjectUnpackJob::JobUnpackObjects(Job *job, void *cookie)
+{
+	ObjectUnpackJob *unpackJob = static_cast<ObjectUnpackJob *>(job);
+	int32 version = unpackJob->targetUnpacker->GetVersion();
+
+	int32 count = unpackJob->objectCount;
+	for (machine a = 0; a < count; a++)
+	{
+		Unpacker unpacker(unpackJob->unpackData[a], version);
+		unpackJob->unpackObject[a]->Unpack(unpacker, unpackJob->unpackFlags);
+
+		// Links are collected by the job and handed to the unpacker for the whole
+		// tree when the job is finalized, which happens on the main thread.
+
+		for (;;)
+		{
+			ObjectLink *link = unpacker.objectList.First();
+			if (!link)
+			{
+				break;
+			}
+
+			unpackJob->objectLinkList.Append(link);
+		}
+
+		for (;;)
+		{
+			NodeLink *link = unpacker.nodeList.First();
+			if (!link)
+			{
+				break;
+			}
+
+			unpackJob->nodeLinkList.Append(link);
+		}
+	}
+}
+
+void ObjectUnpackJob::FinalizeUnpackObjects(Job *job, void *cookie)
+{
+	ObjectUnpackJob *unpackJob = static_cast<ObjectUnpackJob *>(job);
+	Unpacker *unpacker = unpackJob->targetUnpacker;
+
+	for (;;)
+	{
+		ObjectLink *link = unpackJob->objectLinkList.First();
+		if (!link)
+		{
+			break;
+		}
+
+		unpacker->objectList.Append(link);
+	}
+
+	for (;;)
+	{
+		NodeLink *link = unpackJob->nodeLinkList.First();
+		if (!link)
+		{
+			break;
+		}
+
+		unpacker->nodeList.Append(link);
+	}
+}
+
+
 NodeTree::NodeTree()
 {
 	prevBranch = nullptr;
@@ -327,6 +451,9 @@ void NodeTree::Update(void)
 }
 
 
+unsigned_int32 Node::deltaPackCounter = 0;
+
+
 Node::Node(NodeType type) : Site(kCellNode)
 {
 	nodeType = type;
@@ -350,6 +477,8 @@ Node::Node(NodeType type) : Site(kCellNode)
 
 	maxSubzoneDepth = kSubzoneDepthUnlimited;
 	forcedSubzoneDepth = -1;
+
+	deltaPackStamp = ++deltaPackCounter;
 }
 
 Node::Node(const Node& node) : Site(kCellNode)
@@ -433,6 +562,8 @@ Node::Node(const Node& node) : Site(kCellNode)
 
 	maxSubzoneDepth = node.maxSubzoneDepth;
 	forcedSubzoneDepth = node.forcedSubzoneDepth;
+
+	deltaPackStamp = ++deltaPackCounter;
 }
 
 Node::~Node()
@@ -1836,6 +1967,11 @@ bool Node::ValidConnectedNode(const ConnectorKey& key, const Node *node) const
 	return (true);
 }
 
+bool Node::VolatileDeltaPack(void) const
+{
+	return (false);
+}
+
 bool Node::AddProperty(Property *property)
 {
 	bool result = propertyMap.Insert(property);
@@ -2077,6 +2213,7 @@ void Node::ProcessObjectSettings(void)
 void Node::Invalidate(void)
 {
 	NodeTree::Invalidate();
+	InvalidateDeltaPack();
 
 	if (nodeManipulator)
 	{
@@ -2256,6 +2393,12 @@ void Node::HandlePostprocessUpdate(void)
 
 void Node::HandleVisibilityUpdate(void)
 {
+	Zone *zone = GetOwningZone();
+	if ((zone) && (zone->UpdateZoneTreeSite(kCellGraphGeometry, this)))
+	{
+		return;
+	}
+
 	PurgeVisibility();
 
 	if (!(nodeFlags & kNodeIndependentVisibility))
@@ -2810,36 +2953,84 @@ Object **Node::LoadOriginalObjects(const ResourceName& name, World *previousWorl
 		if (resource->LoadAllObjects(&loader, &worldHeader, offsetTable, &objectData) == kResourceOkay)
 		{
 			Unpacker unpacker(objectData, worldHeader.version);
+			UnpackObjectTable(unpacker, kUnpackConcurrent, objectCount, objectTable);
 
-			for (machine a = 0; a < objectCount; a++)
+			delete[] objectData;
+		}
+	}
+
+	delete[] offsetTable;
+	resource->Release();
+
+	return (objectTable);
+}
+
+void Node::UnpackObjectTable(Unpacker& unpacker, unsigned_int32 unpackFlags, int32 objectCount, Object **objectTable)
+{
+	Batch		batch;
+
+	// When unpacking on the main thread, objects that can be unpacked concurrently are gathered into
+	// jobs that run while the remaining objects are unpacked here. Each object is still created on the
+	// main thread, and its size prefix is used to skip its data. All jobs finish before this function
+	// returns, so the node table never sees an object that is still being unpacked.
+
+	bool concurrent = (((unpackFlags & kUnpackConcurrent) != 0) && (Thread::MainThread()) && (TheJobMgr->GetWorkerThreadCount() != 0));
+	ObjectUnpackJob *unpackJob = nullptr;
+
+	for (machine a = 0; a < objectCount; a++)
+	{
+		unsigned_int32	size;
+
+		unpacker >> size;
+		const void *mark = unpacker.GetPointer();
+
+		Object *object = Object::Create(unpacker, unpackFlags);
+		if (object)
+		{
+			if ((unpackFlags & (kUnpackNonpersistent | kUnpackExternal)) == 0)
 			{
-				unsigned_int32	size;
+				object->SetObjectIndex(a);
+			}
 
-				unpacker >> size;
-				const void *mark = unpacker.GetPointer();
+			objectTable[a] = object;
 
-				Object *object = Object::Create(unpacker);
-				if (object)
+			if ((concurrent) && (object->ConcurrentUnpackable()))
+			{
+				if (!unpackJob)
 				{
-					object->Unpack(++unpacker, 0);
-					object->SetObjectIndex(a);
-					objectTable[a] = object;
+					unpackJob = new ObjectUnpackJob(&unpacker, unpackFlags);
 				}
-				else
+
+				unpackJob->AddObject(object, (++unpacker).GetPointer(), size);
+				unpacker.Skip(mark, size);
+
+				if (unpackJob->Full())
 				{
-					unpacker.Skip(mark, size);
-					objectTable[a] = nullptr;
+					TheJobMgr->SubmitJob(unpackJob, &batch);
+					unpackJob = nullptr;
 				}
 			}
-
-			delete[] objectData;
+			else
+			{
+				object->Unpack(++unpacker, unpackFlags);
+			}
+		}
+		else
+		{
+			unpacker.Skip(mark, size);
+			objectTable[a] = nullptr;
 		}
 	}
 
-	delete[] offsetTable;
-	resource->Release();
+	if (unpackJob)
+	{
+		TheJobMgr->SubmitJob(unpackJob, &batch);
+	}
 
-	return (objectTable);
+	if (concurrent)
+	{
+		TheJobMgr->FinishBatch(&batch);
+	}
 }
 
 Node *Node::LoadNodeTable(Unpacker& unpacker, unsigned_int32 unpackFlags, int32 nodeCount, int32 objectCount, Object **objectTable)
@@ -2957,51 +3148,48 @@ Node *Node::UnpackTree(const void *data, unsigned_int32 unpackFlags)
 	unpacker += offsetCount * 4;
 
 	Object **objectTable = new Object *[objectCount];
-	for (machine a = 0; a < objectCount; a++)
-	{
-		unsigned_int32	size;
-
-		unpacker >> size;
-		const void *mark = unpacker.GetPointer();
-
-		Object *object = Object::Create(unpacker, unpackFlags);
-		if (object)
-		{
-			object->Unpack(++unpacker, unpackFlags);
-
-			if ((unpackFlags & (kUnpackNonpersistent | kUnpackExternal)) == 0)
-			{
-				object->SetObjectIndex(a);
-			}
-
-			objectTable[a] = object;
-		}
-		else
-		{
-			unpacker.Skip(mark, size);
-			objectTable[a] = nullptr;
-		}
-	}
+	UnpackObjectTable(unpacker, unpackFlags, objectCount, objectTable);
 
 	return (LoadNodeTable(unpacker, unpackFlags, nodeCount, objectCount, objectTable));
 }
 
 FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) const
 {
-	int32			fileHeader[7];
+	DeltaPackCache		cache;
+	DeltaPackSnapshot	snapshot;
+
+	PackDeltaSnapshot(originalName, &cache, &snapshot);
+	return (snapshot.Write(file));
+}
+
+void Node::PackDeltaSnapshot(const ResourceName& originalName, DeltaPackCache *cache, DeltaPackSnapshot *snapshot) const
+{
 	List<Object>	objectList;
 
 	int32 controllerCount = 0;
 	int32 nodeCount = 0;
 
+	// The packed data for a node refers to other nodes and to objects by index. The data held by
+	// the cache can therefore be reused only if the persistent nodes and the objects that they
+	// reference appear in exactly the same order as they did when the cache was last filled.
+
+	int32 cacheCount = cache->nodeArray.GetElementCount();
+	bool reuseFlag = true;
+
 	const Node *node = this;
 	do
 	{
 		if (!(node->GetNodeFlags() & kNodeNonpersistent))
 		{
-			node->nodeIndex = nodeCount++;
+			int32 index = nodeCount++;
+			node->nodeIndex = index;
 			node->PrepackNodeObjects(&objectList);
 
+			if ((index >= cacheCount) || (cache->nodeArray[index].node != node))
+			{
+				reuseFlag = false;
+			}
+
 			Controller *controller = node->GetController();
 			if (controller)
 			{
@@ -3027,6 +3215,7 @@ FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) con
 
 	int32 objectCount = 0;
 	int32 modifiedCount = 0;
+	int32 listCount = 0;
 
 	Object *object = objectList.First();
 	while (object)
@@ -3042,6 +3231,7 @@ FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) con
 			}
 		}
 
+		listCount++;
 		object = object->Next();
 	}
 
@@ -3061,71 +3251,107 @@ FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) con
 		object = object->Next();
 	}
 
-	ResourceName name(originalName);
-	unsigned_int32 nameLength = name.Length();
-	unsigned_int32 nameSize = (nameLength + 4) & ~3;
-	for (unsigned_machine a = nameLength + 1; a < nameSize; a++)
+	reuseFlag &= ((cacheCount == nodeCount) && (cache->objectArray.GetElementCount() == listCount));
+	if (reuseFlag)
 	{
-		name[a] = 0;
-	}
+		const Object *const *cacheObject = cache->objectArray;
 
-	fileHeader[0] = 1;
-	fileHeader[1] = kEngineInternalVersion;
-	fileHeader[2] = controllerCount;
-	fileHeader[3] = objectCount;
-	fileHeader[4] = modifiedCount;
-	fileHeader[5] = nodeCount;
-	fileHeader[6] = nameSize;
+		object = objectList.First();
+		while (object)
+		{
+			if (object != *cacheObject)
+			{
+				reuseFlag = false;
+				break;
+			}
 
-	FileResult result = file->Write(fileHeader, 28);
-	if (result == kFileOkay)
+			cacheObject++;
+			object = object->Next();
+		}
+	}
+
+	if (!reuseFlag)
 	{
-		result = file->Write(&name, nameSize);
+		cache->Purge();
+		cache->nodeArray.SetElementCount(nodeCount);
+
+		object = objectList.First();
+		while (object)
+		{
+			cache->objectArray.AddElement(object);
+			object = object->Next();
+		}
 	}
 
+	snapshot->fileHeader[0] = 1;
+	snapshot->fileHeader[1] = kEngineInternalVersion;
+	snapshot->fileHeader[2] = controllerCount;
+	snapshot->fileHeader[3] = objectCount;
+	snapshot->fileHeader[4] = modifiedCount;
+	snapshot->fileHeader[5] = nodeCount;
+	snapshot->originalName = originalName;
+
 	Buffer buffer(kPackageDefaultSize);
 
-	if (result == kFileOkay)
+	object = objectList.First();
+	while (object)
 	{
-		object = objectList.First();
-		while (object)
+		if (object->GetModifiedFlag())
 		{
-			if (object->GetModifiedFlag())
-			{
-				int32 index = object->GetObjectIndex();
-				file->Write(&index, 4);
+			Package package(buffer, kPackageDefaultSize);
+			Packer packer(&package);
 
-				Package package(buffer, kPackageDefaultSize);
-				Packer packer(&package);
+			PackHandle handle = packer.BeginSection();
+			object->PackType(packer);
+			object->Pack(packer, 0);
+			packer.EndSection(handle);
 
-				PackHandle handle = packer.BeginSection();
-				object->PackType(packer);
-				object->Pack(packer, 0);
-				packer.EndSection(handle);
+			DeltaPackSnapshot::ObjectData	objectData;
 
-				result = file->Write(package.GetStorage(), package.GetSize());
-				if (result != kFileOkay)
-				{
-					break;
-				}
-			}
+			objectData.objectIndex = object->GetObjectIndex();
+			objectData.packSize = package.GetSize();
+			objectData.packData = new char[objectData.packSize];
+			MemoryMgr::CopyMemory(package.GetStorage(), objectData.packData, objectData.packSize);
 
-			object = object->Next();
+			snapshot->objectArray.AddElement(objectData);
 		}
+
+		object = object->Next();
 	}
 
-	if (result == kFileOkay)
+	Node *super = GetSuperNode();
+	if (super)
 	{
-		Node *super = GetSuperNode();
-		if (super)
-		{
-			super->nodeIndex = -1;
-		}
+		super->nodeIndex = -1;
+	}
 
-		node = this;
-		do
+	int32 packedCount = 0;
+	int32 nodeIndex = 0;
+
+	node = this;
+	do
+	{
+		if (!(node->GetNodeFlags() & kNodeNonpersistent))
 		{
-			if (!(node->GetNodeFlags() & kNodeNonpersistent))
+			DeltaPackCache::NodeData *nodeData = &cache->nodeArray[nodeIndex];
+			if (!reuseFlag)
+			{
+				nodeData->node = nullptr;
+				nodeData->packData = nullptr;
+				nodeData->packSize = 0;
+				nodeData->volatileFlag = false;
+			}
+
+			// Nodes with controllers or properties are always packed again because controllers and
+			// properties change their own state without any notification, and so are nodes whose
+			// own packed state changes at run time, as reported by VolatileDeltaPack(). A node that
+			// was volatile when it was last packed is also packed again so that the change is noticed.
+			// Other nodes are packed again only if they have been invalidated or their position in the
+			// tree, transform, or flags have changed.
+
+			const Node *nodeSuper = node->GetSuperNode();
+			bool volatileFlag = ((node->GetController()) || (node->GetFirstProperty()) || (node->VolatileDeltaPack()));
+			if ((nodeData->node != node) || (nodeData->packStamp != node->deltaPackStamp) || (volatileFlag) || (nodeData->volatileFlag) || (nodeData->superNode != nodeSuper) || (nodeData->nodeFlags != node->nodeFlags) || (nodeData->nodeTransform != node->nodeTransform))
 			{
 				Package package(buffer, kPackageDefaultSize);
 				Packer packer(&package);
@@ -3135,20 +3361,44 @@ FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) con
 				node->Pack(packer, 0);
 				packer.EndSection(handle);
 
-				result = file->Write(package.GetStorage(), package.GetSize());
-				if (result != kFileOkay)
+				unsigned_int32 size = package.GetSize();
+				if (size != nodeData->packSize)
 				{
-					break;
+					delete[] nodeData->packData;
+					nodeData->packData = new char[size];
+					nodeData->packSize = size;
 				}
 
-				node = GetNextNode(node);
-			}
-			else
-			{
-				node = GetNextLevelNode(node);
+				MemoryMgr::CopyMemory(package.GetStorage(), nodeData->packData, size);
+
+				nodeData->node = node;
+				nodeData->superNode = nodeSuper;
+				nodeData->packStamp = node->deltaPackStamp;
+				nodeData->nodeFlags = node->nodeFlags;
+				nodeData->nodeTransform = node->nodeTransform;
+				nodeData->volatileFlag = volatileFlag;
+
+				packedCount++;
 			}
-		} while (node);
-	}
+
+			DeltaPackSnapshot::NodeData		snapshotData;
+
+			snapshotData.packData = nodeData->packData;
+			snapshotData.packSize = nodeData->packSize;
+			snapshot->nodeArray.AddElement(snapshotData);
+
+			nodeIndex++;
+
+			node = GetNextNode(node);
+		}
+		else
+		{
+			node = GetNextLevelNode(node);
+		}
+	} while (node);
+
+	cache->packedNodeCount = packedCount;
+	cache->reusedNodeCount = nodeCount - packedCount;
 
 	for (;;)
 	{
@@ -3165,8 +3415,6 @@ FileResult Node::PackDeltaTree(File *file, const ResourceName& originalName) con
 
 		objectList.Remove(object);
 	}
-
-	return (result);
 }
 
 Node *Node::UnpackDeltaTree(const void *data, ResourceName& originalName, World *previousWorld)
@@ -3230,6 +3478,98 @@ Node *Node::UnpackDeltaTree(const void *data, ResourceName& originalName, World
 }
 
 
+DeltaPackCache::DeltaPackCache()
+{
+	packedNodeCount = 0;
+	reusedNodeCount = 0;
+}
+
+DeltaPackCache::~DeltaPackCache()
+{
+	Purge();
+}
+
+void DeltaPackCache::Purge(void)
+{
+	for (const NodeData& nodeData : nodeArray)
+	{
+		delete[] nodeData.packData;
+	}
+
+	nodeArray.Purge();
+	objectArray.Purge();
+}
+
+
+DeltaPackSnapshot::DeltaPackSnapshot()
+{
+}
+
+DeltaPackSnapshot::~DeltaPackSnapshot()
+{
+	for (const ObjectData& objectData : objectArray)
+	{
+		delete[] objectData.packData;
+	}
+}
+
+FileResult DeltaPackSnapshot::Write(File *file) const
+{
+	// This touches only data owned by the snapshot or by the cache that it was made
+	// with, so it can run on a worker thread while the world continues to change.
+
+	int32	header[7];
+
+	ResourceName name(originalName);
+	unsigned_int32 nameLength = name.Length();
+	unsigned_int32 nameSize = (nameLength + 4) & ~3;
+	for (unsigned_machine a = nameLength + 1; a < nameSize; a++)
+	{
+		name[a] = 0;
+	}
+
+	for (machine a = 0; a < 6; a++)
+	{
+		header[a] = fileHeader[a];
+	}
+
+	header[6] = nameSize;
+
+	FileResult result = file->Write(header, 28);
+	if (result == kFileOkay)
+	{
+		result = file->Write(&name, nameSize);
+	}
+
+	if (result == kFileOkay)
+	{
+		for (const ObjectData& objectData : objectArray)
+		{
+			file->Write(&objectData.objectIndex, 4);
+
+			result = file->Write(objectData.packData, objectData.packSize);
+			if (result != kFileOkay)
+			{
+				break;
+			}
+		}
+	}
+
+	if (result == kFileOkay)
+	{
+		for (const NodeData& nodeData : nodeArray)
+		{
+			result = file->Write(nodeData.packData, nodeData.packSize);
+			if (result != kFileOkay)
+			{
+				break;
+			}
+		}
+	}
+
+	return (result);
+}
+
 RenderableNode::RenderableNode(NodeType type, RenderType renderType, unsigned_int32 renderState) :
 		Node(type),
 		Renderable(renderType, renderState)
@@ -353,6 +353,8 @@ namespace C4
 
 	class Node;
 	class World;
+	class DeltaPackCache;
+	class DeltaPackSnapshot;
 	class Controller;
 	class Manipulator;
 	class Geometry;
@@ -924,6 +926,35 @@ namespace C4
 	//# \also	$@Node::SetNodeTransform@$
 
 
+	//# \function	Node::InvalidateDeltaPack		Indicates that a node must be packed again by the next incremental save.
+	//
+	//# \proto	void InvalidateDeltaPack(void);
+	//
+	//# \desc
+	//# The $InvalidateDeltaPack$ function should be called when state that a node packs is changed by something other than its
+	//# transform, its node flags, or its connectors, and the node does not have a controller or any properties. An incremental
+	//# save made with the $@WorldMgr::SaveDeltaWorld@$ function reuses the data that was packed for a node by the previous save
+	//# unless one of these things has changed, the node has a controller or properties, the node is volatile as reported by the
+	//# $@Node::VolatileDeltaPack@$ function, or the node has been invalidated with this function or with the $@Node::Invalidate@$ function.
+	//
+	//# \also	$@Node::VolatileDeltaPack@$
+	//# \also	$@WorldMgr::SaveDeltaWorld@$
+
+
+	//# \function	Node::VolatileDeltaPack		Returns a boolean value indicating whether a node must be packed by every incremental save.
+	//
+	//# \proto	virtual bool VolatileDeltaPack(void) const;
+	//
+	//# \desc
+	//# The $VolatileDeltaPack$ function is called by $@WorldMgr::SaveDeltaWorld@$ for each node in an incremental save. If it returns
+	//# $true$, then the node is packed again instead of reusing the data that was packed for it by the previous save. A node subclass
+	//# should override this function and return $true$ if state that it packs changes so often at run time, or from so many places,
+	//# that calling $@Node::InvalidateDeltaPack@$ at every change is not practical. The default implementation returns $false$.
+	//
+	//# \also	$@Node::InvalidateDeltaPack@$
+	//# \also	$@WorldMgr::SaveDeltaWorld@$
+
+
 	//# \function	Node::Update		Updates the world transform and dependent information.
 	//
 	//# \proto	void Update(void);
@@ -1438,6 +1469,9 @@ namespace C4
 			};
 
 			int32					nodeObjectIndex;
+			unsigned_int32			deltaPackStamp;
+
+			C4API static unsigned_int32	deltaPackCounter;
 
 			Node *CloneNode(CloneFilterProc *filterProc = &DefaultCloneFilter, void *filterCookie = nullptr) const;
 			Node *CloneNode(const Node *root, Node **nodeTable, Array<ConnectorCloneData, 16> *connectorArray, CloneFilterProc *filterProc = &DefaultCloneFilter, void *filterCookie = nullptr) const;
@@ -1446,6 +1480,7 @@ namespace C4
 			static void PropertyObjectLinkProc(Object *object, void *cookie);
 
 			static Object **LoadOriginalObjects(const ResourceName& name, World *previousWorld, int32 newObjectCount, int32 *originalObjectCount, int32 *totalObjectCount);
+			static void UnpackObjectTable(Unpacker& unpacker, unsigned_int32 unpackFlags, int32 objectCount, Object **objectTable);
 			static Node *LoadNodeTable(Unpacker& unpacker, unsigned_int32 unpackFlags, int32 nodeCount, int32 objectCount, Object **objectTable);
 
 		protected:
@@ -1713,6 +1748,11 @@ namespace C4
 				return (nodeIndex);
 			}
 
+			void InvalidateDeltaPack(void)
+			{
+				deltaPackStamp = ++deltaPackCounter;
+			}
+
 			void InvalidateNodeIndex(void)
 			{
 				nodeIndex = -1;
@@ -1775,6 +1815,8 @@ namespace C4
 			C4API virtual void ProcessInternalConnectors(void);
 			C4API virtual bool ValidConnectedNode(const ConnectorKey& key, const Node *node) const;
 
+			C4API virtual bool VolatileDeltaPack(void) const;
+
 			C4API Zone *GetOwningZone(void) const;
 
 			C4API void EstablishVisibility(void);
@@ -1804,10 +1846,129 @@ namespace C4
 			C4API static Node *UnpackTree(const void *data, unsigned_int32 unpackFlags = 0);
 
 			C4API FileResult PackDeltaTree(File *file, const ResourceName& originalName) const;
+			C4API void PackDeltaSnapshot(const ResourceName& originalName, DeltaPackCache *cache, DeltaPackSnapshot *snapshot) const;
 			C4API static Node *UnpackDeltaTree(const void *data, ResourceName& originalName, World *previousWorld = nullptr);
 	};
 
 
+	//# \class	DeltaPackCache		Holds the data packed for each node by the previous incremental save.
+	//
+	//# The $DeltaPackCache$ class holds the data packed for each node by the previous incremental save.
+	//
+	//# \def	class DeltaPackCache
+	//
+	//# \ctor	DeltaPackCache();
+	//
+	//# \desc
+	//# The $DeltaPackCache$ class stores the packed data for every persistent node in a tree along with the state that
+	//# determines whether that data is still current. When the $@Node::PackDeltaSnapshot@$ function is called with a cache,
+	//# only nodes that have changed since the previous call are packed again, and the data for all other nodes is shared
+	//# with the new snapshot. If the persistent nodes in the tree or the objects that they reference have changed order,
+	//# then every node is packed again because the indices stored in the packed data would no longer be valid.
+	//#
+	//# The data held by a cache must not be changed while a $@DeltaPackSnapshot@$ that refers to it is being written.
+	//
+	//# \also	$@DeltaPackSnapshot@$
+	//# \also	$@Node::PackDeltaSnapshot@$
+	//# \also	$@Node::InvalidateDeltaPack@$
+
+
+	class DeltaPackCache
+	{
+		friend class Node;
+
+		private:
+
+			struct NodeData
+			{
+				const Node			*node;
+				const Node			*superNode;
+				unsigned_int32		packStamp;
+				unsigned_int32		nodeFlags;
+				Transform4D			nodeTransform;
+				bool				volatileFlag;
+
+				char				*packData;
+				unsigned_int32		packSize;
+			};
+
+			Array<NodeData>			nodeArray;
+			Array<const Object *>	objectArray;
+
+			int32					packedNodeCount;
+			int32					reusedNodeCount;
+
+		public:
+
+			C4API DeltaPackCache();
+			C4API ~DeltaPackCache();
+
+			int32 GetPackedNodeCount(void) const
+			{
+				return (packedNodeCount);
+			}
+
+			int32 GetReusedNodeCount(void) const
+			{
+				return (reusedNodeCount);
+			}
+
+			C4API void Purge(void);
+	};
+
+
+	//# \class	DeltaPackSnapshot		Holds everything needed to write a delta world file.
+	//
+	//# The $DeltaPackSnapshot$ class holds everything needed to write a delta world file.
+	//
+	//# \def	class DeltaPackSnapshot
+	//
+	//# \ctor	DeltaPackSnapshot();
+	//
+	//# \desc
+	//# A $DeltaPackSnapshot$ object is filled in by the $@Node::PackDeltaSnapshot@$ function on the main thread. It holds
+	//# copies of the packed data for modified objects, and it refers to the packed node data held by a $@DeltaPackCache@$
+	//# object. Because the snapshot does not refer to any nodes or objects, the $@DeltaPackSnapshot::Write@$ function can
+	//# be called on any thread while the world continues to run.
+	//
+	//# \also	$@DeltaPackCache@$
+	//# \also	$@Node::PackDeltaSnapshot@$
+
+
+	class DeltaPackSnapshot
+	{
+		friend class Node;
+
+		private:
+
+			struct ObjectData
+			{
+				int32				objectIndex;
+				char				*packData;
+				unsigned_int32		packSize;
+			};
+
+			struct NodeData
+			{
+				const char			*packData;
+				unsigned_int32		packSize;
+			};
+
+			int32					fileHeader[7];
+			ResourceName			originalName;
+
+			Array<ObjectData>		objectArray;
+			Array<NodeData>			nodeArray;
+
+		public:
+
+			C4API DeltaPackSnapshot();
+			C4API ~DeltaPackSnapshot();
+
+			C4API FileResult Write(File *file) const;
+	};
+
+
 	//# \class	RenderableNode		The base class for renderable scene graph nodes.
 	//
 	//# Every directly-renderable node in a scene graph is a subclass of the $RenderableNode$ class.
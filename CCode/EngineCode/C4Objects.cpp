@@ -56,6 +56,11 @@ Object *Object::Replicate(void) const
 	return (nullptr);
 }
 
+bool Object::ConcurrentUnpackable(void) const
+{
+	return (false);
+}
+
 int32 Object::GetObjectSize(float *size) const
 {
 	return (0);
@@ -274,6 +274,21 @@ namespace C4
 	//# \also	$@Object::SetModifiedFlag@$
 
 
+	//# \function	Object::ConcurrentUnpackable		Returns a boolean value indicating whether an object can be unpacked on a worker thread.
+	//
+	//# \proto	virtual bool ConcurrentUnpackable(void) const;
+	//
+	//# \desc
+	//# The $ConcurrentUnpackable$ function is called after an object has been created, but before it is unpacked, when a
+	//# world is loaded on the main thread. If it returns $true$, then the $@ResourceMgr/Packable::Unpack@$ function for the
+	//# object may be called on a worker thread at the same time that other objects are being unpacked. An object can only
+	//# return $true$ if its $Unpack$ function reads nothing except the data in the unpacker and stores it in the object itself.
+	//#
+	//# The default implementation returns $false$. Geometry objects return $true$.
+	//
+	//# \also	$@ResourceMgr/Packable::Unpack@$
+
+
 	class Object : public Shared, public Packable, public Configurable, public Creatable<Object>, public ListElement<Object>
 	{
 		friend class Node;
@@ -327,6 +342,8 @@ namespace C4
 
 			C4API void PackType(Packer& data) const override;
 
+			C4API virtual bool ConcurrentUnpackable(void) const;
+
 			C4API virtual int32 GetObjectSize(float *size) const;
 			C4API virtual void SetObjectSize(const float *size);
 	};
@@ -20,6 +20,12 @@
 
 #define C4STATS						1
 
+// C4PROFILE controls whether the frame profiler is compiled into the engine. If enabled, CPU
+// timing scopes are recorded per thread when the profiler is turned on with the "prof" console
+// command, and the recorded timelines can be exported in the Chrome trace format.
+
+#define C4PROFILE					1
+
 // C4DIAGS controls whether various debug diagnostic rendering capabilities are compiled
 // into the engine.
 
@@ -39,7 +39,8 @@ namespace C4
 	{
 		kUnpackEditor				= 1 << 0,		//## Unpacking is occurring in the World Editor.
 		kUnpackNonpersistent		= 1 << 1,		//## All unpacked nodes will be set to nonpersistent.
-		kUnpackExternal				= 1 << 2		//## Object indexes are not set because nodes are being unpacked into a different world.
+		kUnpackExternal				= 1 << 2,		//## Object indexes are not set because nodes are being unpacked into a different world.
+		kUnpackConcurrent			= 1 << 3		//## Objects that support it may be unpacked on the worker threads. This has no effect unless unpacking occurs on the main thread.
 	};
 
 
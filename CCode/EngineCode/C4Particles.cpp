@@ -359,6 +359,14 @@ bool ParticleSystem::CalculateBoundingSphere(BoundingSphere *sphere) const
 	return (true);
 }
 
+bool ParticleSystem::VolatileDeltaPack(void) const
+{
+	// A particle system packs its live particles and flags that change while it runs,
+	// so it is packed again by every incremental save.
+
+	return (true);
+}
+
 int32 ParticleSystem::GetInternalConnectorCount(void) const
 {
 	return (1);
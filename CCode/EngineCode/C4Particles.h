@@ -909,6 +909,8 @@ namespace C4
 			C4API bool CalculateBoundingBox(Box3D *box) const override;
 			C4API bool CalculateBoundingSphere(BoundingSphere *sphere) const override;
 
+			C4API bool VolatileDeltaPack(void) const override;
+
 			int32 RenderFireParticles(const FrustumCamera *camera);
 			int32 RenderPolyboardParticles(const FrustumCamera *camera);
 
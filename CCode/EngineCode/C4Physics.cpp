@@ -1,6 +1,7 @@
  
 
 #include "C4Physics.h"
+#include "C4PhysicsRecorder.h"
 #include "C4Simulation.h"
 #include "C4Forces.h"
 #include "C4Fields.h"
@@ -10,6 +11,7 @@
 #include "C4Terrain.h"
 #include "C4Primitives.h"
 #include "C4Configuration.h"
+#include "C4Profiler.h"
 
 
 using namespace C4;
@@ -60,6 +62,10 @@ namespace C4
 			int32							solverMultiplier;
 			bool							repeatCollisionFlag;
 
+			bool							batchedFlag;
+			bool							parallelFlag;
+			ContactSolver					contactSolver;
+
 			ConstraintSolverJob(ExecuteProc *execProc);
 
 			using ListElement<ConstraintSolverJob>::Previous;
@@ -815,11 +821,8 @@ void RigidBodyController::Preprocess(void)
 		initialCenterOfMass = initialTransform * bodyCenterOfMass;
 		finalCenterOfMass = finalTransform * bodyCenterOfMass;
 
-		networkDelta[0].Set(0.0F, 0.0F, 0.0F);
-		networkDelta[1].Set(0.0F, 0.0F, 0.0F);
-		networkDecay[0] = 0.0F;
-		networkDecay[1] = 0.0F;
-		networkParity = 0;
+		deadReckoningPublisher.Reset();
+		deadReckoningSmoother.Reset();
 	}
 	else
 	{
@@ -873,18 +876,20 @@ void RigidBodyController::ReceiveMessage(const ControllerMessage *message)
 		{
 			const RigidBodySnapshotMessage *m = static_cast<const RigidBodySnapshotMessage *>(message);
 
-			Transform4D serverTransform(m->GetRigidBodyRotation().GetRotationMatrix(), m->GetRigidBodyPosition());
+			const Quaternion& serverRotation = m->GetRigidBodyRotation();
+			Transform4D serverTransform(serverRotation.GetRotationMatrix(), m->GetRigidBodyPosition());
+
+			// The simulation jumps to the server state right away, but the displayed state starts where the
+			// rigid body is currently being displayed and converges to the new trajectory over time.
 
-			unsigned_int32 parity = networkParity;
-			networkDelta[parity] = serverTransform.GetTranslation() - finalTransform.GetTranslation();
-			networkDecay[parity] = 1.0F;
+			Vector3D delta = serverTransform.GetTranslation() - finalTransform.GetTranslation();
+			Quaternion displayRotation = deadReckoningSmoother.GetRotationOffset() * Quaternion().SetRotationMatrix(finalTransform);
+			deadReckoningSmoother.BeginBlend(deadReckoningSmoother.GetPositionOffset() - delta, linearVelocity - m->GetRigidBodyLinearVelocity(), displayRotation * Conjugate(serverRotation));
 
 			initialTransform.SetMatrix3D(serverTransform);
-			initialTransform[3] += networkDelta[parity];
+			initialTransform[3] += delta;
 			finalTransform = serverTransform;
 
-			networkParity = parity ^ 1;
-
 			linearVelocity = m->GetRigidBodyLinearVelocity();
 			angularVelocity = m->GetRigidBodyAngularVelocity();
 
@@ -948,9 +953,20 @@ void RigidBodyController::SendInitialStateMessages(Player *player) const
 
 void RigidBodyController::SendSnapshot(void)
 {
-	RigidBodySnapshotMessage message(GetControllerIndex(), finalTransform.GetTranslation(), Quaternion().SetRotationMatrix(finalTransform), linearVelocity, angularVelocity);
-	message.SetMessageFlags(kMessageUnreliable);
-	TheMessageMgr->SendMessageClients(message);
+	Quaternion	rotation;
+
+	const Point3D& position = finalTransform.GetTranslation();
+	rotation.SetRotationMatrix(finalTransform);
+
+	// A snapshot is only sent when the clients would no longer be able to predict the motion
+	// of the rigid body closely enough from the previous snapshot. Nothing is sent again until
+	// the motion deviates from that snapshot, so it has to be sent reliably. Otherwise, a lost
+	// snapshot would leave the clients extrapolating an older state until the next deviation.
+
+	if (deadReckoningPublisher.Update(position, rotation, linearVelocity, angularVelocity, TheMessageMgr->GetSnapshotInterval() * GetSnapshotPeriod()))
+	{
+		TheMessageMgr->SendMessageClients(RigidBodySnapshotMessage(GetControllerIndex(), position, rotation, linearVelocity, angularVelocity));
+	}
 }
 
 void RigidBodyController::Wake(void)
@@ -967,6 +983,7 @@ void RigidBodyController::Wake(void)
 
 		if ((!(rigidBodyFlags & kRigidBodyLocalSimulation)) && (TheMessageMgr->Server()))
 		{
+			deadReckoningPublisher.Reset();
 			TheMessageMgr->AddSnapshotSender(this);
 			TheMessageMgr->SendMessageClients(ControllerMessage(kRigidBodyMessageWake, GetControllerIndex()));
 		}
@@ -993,6 +1010,7 @@ void RigidBodyController::Wake(void)
 void RigidBodyController::Sleep(void)
 {
 	SetRigidBodyTransform(finalTransform);
+	deadReckoningSmoother.Reset();
 
 	bodyCollisionBox = Transform(boundingBox, finalTransform);
 	linearVelocity.Set(0.0F, 0.0F, 0.0F);
@@ -1046,6 +1064,7 @@ void RigidBodyController::RecursiveWake(void)
 	if (TheMessageMgr->Server())
 	{
 		ExpediteSnapshot();
+		deadReckoningPublisher.Reset();
 
 		if (RigidBodyAsleep())
 		{
@@ -2405,6 +2424,9 @@ ConstraintSolverJob::ConstraintSolverJob(ExecuteProc *execProc) : BatchJob(execP
 {
 	solverMultiplier = 1;
 	repeatCollisionFlag = false;
+
+	batchedFlag = false;
+	parallelFlag = false;
 }
 
 
@@ -2416,11 +2438,16 @@ PhysicsController::PhysicsController() : Controller(kControllerPhysics)
 	simulationTime = kPhysicsTimeStep;
 	interpolationParam = 1.0F;
 
+	physicsFlags = 0;
+	physicsRecorder = nullptr;
+
 	maxLinearSpeed = kDefaultMaxLinearSpeed;
 	maxAngularSpeed = kDefaultMaxAngularSpeed;
 
 	gravityAcceleration.Set(0.0F, 0.0F, -9.8F);
 
+	contactSolverMode = kContactSolverScalar;
+
 	rigidBodyParity = 0;
 	sleepingParity = 0;
 
@@ -2428,6 +2455,7 @@ PhysicsController::PhysicsController() : Controller(kControllerPhysics)
 	fieldApplicationStamp = 0xFFFFFFFF;
 
 	simulationList = nullptr;
+	sleepingPartitionValid = false;
 
 	for (machine a = 0; a < kPhysicsCounterCount; a++)
 	{
@@ -2577,6 +2605,7 @@ void PhysicsController::AddRigidBody(RigidBodyController *rigidBody)
 	if ((rigidBody->RigidBodyAsleep()) && (rigidBody->GetTargetNode()->Enabled()))
 	{
 		sleepingList[sleepingParity].Append(rigidBody);
+		sleepingPartitionValid = false;
 	}
 }
 
@@ -2584,6 +2613,7 @@ void PhysicsController::RemoveRigidBody(RigidBodyController *rigidBody)
 {
 	rigidBody->ListElement<RigidBodyController>::Detach();
 	physicsGraph.RemoveElement(rigidBody);
+	sleepingPartitionValid = false;
 }
 
 void PhysicsController::WakeRigidBody(RigidBodyController *rigidBody)
@@ -2599,6 +2629,8 @@ void PhysicsController::WakeRigidBody(RigidBodyController *rigidBody)
 		{
 			rigidBodyList[rigidBodyParity].Append(rigidBody);
 		}
+
+		sleepingPartitionValid = false;
 	}
 
 	rigidBody->rigidBodyState &= ~kRigidBodyAsleep;
@@ -2616,6 +2648,7 @@ void PhysicsController::SleepRigidBody(RigidBodyController *rigidBody)
 	}
 
 	rigidBody->rigidBodyState |= kRigidBodyAsleep;
+	sleepingPartitionValid = false;
 }
 
 void PhysicsController::WakeFieldRigidBodies(const Field *field)
@@ -2915,6 +2948,150 @@ void PhysicsController::CollideRigidBodiesZ(List<RigidBodyController> *inputList
 	}
 }
 
+void PhysicsController::SiftSleepingBody(SleepingBodyData *data, machine root, machine count)
+{
+	for (;;)
+	{
+		machine child = root * 2 + 1;
+		if (child >= count)
+		{
+			break;
+		}
+
+		if ((child + 1 < count) && (data[child + 1].xmin > data[child].xmin))
+		{
+			child++;
+		}
+
+		if (data[child].xmin <= data[root].xmin)
+		{
+			break;
+		}
+
+		SleepingBodyData temp = data[root];
+		data[root] = data[child];
+		data[child] = temp;
+		root = child;
+	}
+}
+
+void PhysicsController::BuildSleepingPartition(void)
+{
+	// Sleeping bodies don't move, so they are kept in an array sorted by the minimum x coordinate
+	// of their collision boxes. The array is only rebuilt when a body falls asleep or wakes up.
+
+	sleepingPartitionValid = true;
+	sleepingPartition.Clear();
+
+	RigidBodyController *rigidBody = sleepingList[sleepingParity].First();
+	while (rigidBody)
+	{
+		SleepingBodyData *data = sleepingPartition.AddElement();
+		data->xmin = rigidBody->bodyCollisionBox.min.x;
+		data->xmax = rigidBody->bodyCollisionBox.max.x;
+		data->rigidBody = rigidBody;
+
+		rigidBody = rigidBody->Next();
+	}
+
+	int32 count = sleepingPartition.GetElementCount();
+	if (count > 1)
+	{
+		SleepingBodyData *data = &sleepingPartition[0];
+
+		// Heap sort the array by the minimum x coordinate.
+
+		for (machine a = count / 2 - 1; a >= 0; a--)
+		{
+			SiftSleepingBody(data, a, count);
+		}
+
+		for (machine a = count - 1; a > 0; a--)
+		{
+			SleepingBodyData temp = data[0];
+			data[0] = data[a];
+			data[a] = temp;
+
+			SiftSleepingBody(data, 0, a);
+		}
+
+		// Replace each maximum x coordinate with the largest one up to that point in the array
+		// so that a search can stop as soon as no earlier box can reach a given coordinate.
+
+		for (machine a = 1; a < count; a++)
+		{
+			data[a].xmax = Fmax(data[a].xmax, data[a - 1].xmax);
+		}
+	}
+}
+
+void PhysicsController::CollideSleepingRigidBodies(const List<RigidBodyController> *awakeList)
+{
+	if (!sleepingPartitionValid)
+	{
+		BuildSleepingPartition();
+	}
+
+	int32 sleepingCount = sleepingPartition.GetElementCount();
+	physicsCounter[kPhysicsCounterSleepingBody] = sleepingCount;
+	if (sleepingCount == 0)
+	{
+		return;
+	}
+
+	const SleepingBodyData *data = &sleepingPartition[0];
+	int32 awakeCount = 0;
+	int32 testCount = 0;
+
+	RigidBodyController *rigidBody = awakeList->First();
+	while (rigidBody)
+	{
+		const Box3D& box = rigidBody->bodyCollisionBox;
+
+		// Find the first sleeping body whose box begins beyond the awake body's box in the x direction.
+
+		int32 lower = 0;
+		int32 upper = sleepingCount;
+		while (lower < upper)
+		{
+			int32 middle = (lower + upper) >> 1;
+			if (data[middle].xmin <= box.max.x)
+			{
+				lower = middle + 1;
+			}
+			else
+			{
+				upper = middle;
+			}
+		}
+
+		for (machine a = lower - 1; a >= 0; a--)
+		{
+			if (data[a].xmax < box.min.x)
+			{
+				break;
+			}
+
+			testCount++;
+
+			RigidBodyController *sleepingBody = data[a].rigidBody;
+			if (box.Intersection(sleepingBody->bodyCollisionBox))
+			{
+				if ((rigidBody->ValidRigidBodyCollision(sleepingBody)) && (sleepingBody->ValidRigidBodyCollision(rigidBody)))
+				{
+					DetectBodyCollision(rigidBody, sleepingBody);
+				}
+			}
+		}
+
+		awakeCount++;
+		rigidBody = rigidBody->Next();
+	}
+
+	physicsCounter[kPhysicsCounterSleepingPairTest] = testCount;
+	physicsCounter[kPhysicsCounterSleepingPairAvoided] = awakeCount * sleepingCount - testCount;
+}
+
 void PhysicsController::DetectBodyCollision(RigidBodyController *alphaBody, RigidBodyController *betaBody)
 {
 	unsigned_int32 alphaIndex = 0;
@@ -3085,14 +3262,31 @@ void PhysicsController::BuildConstraintIsland(RigidBodyController *rigidBody, Co
 	}
 }
 
-void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
+void PhysicsController::PrepareConstraintIsland(ConstraintSolverJob *solverJob)
 {
-	ConstraintSolverJob *solverJob = static_cast<ConstraintSolverJob *>(job);
+	int32	subcontactCount;
+
+	if ((contactSolverMode == kContactSolverBatched) && (ContactSolver::Eligible(&solverJob->rigidBodyList, &subcontactCount)) && (subcontactCount >= kMinContactSolverRowCount))
+	{
+		solverJob->batchedFlag = true;
+		physicsCounter[kPhysicsCounterBatchedSolverIsland]++;
+
+		// Islands with enough rows to keep several threads busy are not submitted as a single job.
+		// They are solved from the main thread instead so that each color can be split into jobs.
 
-	machine iterationCount = solverJob->solverMultiplier * kMaxConstraintIterationCount;
+		if ((subcontactCount >= kMinParallelContactSolverRowCount) && (TheJobMgr->GetWorkerThreadCount() > 1))
+		{
+			solverJob->parallelFlag = true;
+			physicsCounter[kPhysicsCounterParallelSolverIsland]++;
+		}
+	}
+}
+
+void PhysicsController::SolveIslandConstraints(const List<RigidBodyController> *bodyList, int32 iterationCount)
+{
 	for (machine iteration = 0; iteration < iterationCount; iteration++)
 	{
-		RigidBodyController *rigidBody = solverJob->rigidBodyList.First();
+		RigidBodyController *rigidBody = bodyList->First();
 		while (rigidBody)
 		{
 			rigidBody->maxLinearCorrection = 0.0F;
@@ -3100,7 +3294,7 @@ void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
 			rigidBody = rigidBody->Next();
 		} while (rigidBody);
 
-		rigidBody = solverJob->rigidBodyList.First();
+		rigidBody = bodyList->First();
 		while (rigidBody)
 		{
 			Contact *contact = rigidBody->GetFirstOutgoingEdge();
@@ -3117,7 +3311,7 @@ void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
 			rigidBody = rigidBody->Next();
 		}
 
-		rigidBody = solverJob->rigidBodyList.First();
+		rigidBody = bodyList->First();
 		while (rigidBody)
 		{
 			Contact *contact = rigidBody->GetFirstOutgoingEdge();
@@ -3134,7 +3328,7 @@ void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
 			rigidBody = rigidBody->Next();
 		}
 
-		rigidBody = solverJob->rigidBodyList.First();
+		rigidBody = bodyList->First();
 		while (rigidBody)
 		{
 			Contact *contact = rigidBody->GetFirstOutgoingEdge();
@@ -3153,7 +3347,7 @@ void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
 
 		float maxCorrection = 0.0F;
 
-		rigidBody = solverJob->rigidBodyList.First();
+		rigidBody = bodyList->First();
 		while (rigidBody)
 		{
 			maxCorrection = Fmax(maxCorrection, rigidBody->maxLinearCorrection, rigidBody->maxAngularCorrection);
@@ -3167,9 +3361,124 @@ void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
 	}
 }
 
+void PhysicsController::JobSolveIslandConstraints(Job *job, void *cookie)
+{
+	ConstraintSolverJob *solverJob = static_cast<ConstraintSolverJob *>(job);
+	const List<RigidBodyController> *bodyList = &solverJob->rigidBodyList;
+	int32 iterationCount = solverJob->solverMultiplier * kMaxConstraintIterationCount;
+
+	if (solverJob->batchedFlag)
+	{
+		ContactSolver *contactSolver = &solverJob->contactSolver;
+
+		if (!ContactSolver::ComparisonEnabled())
+		{
+			bool built = contactSolver->Build(bodyList);
+			if (built)
+			{
+				contactSolver->Solve(iterationCount);
+			}
+
+			contactSolver->Purge();
+			if (built)
+			{
+				return;
+			}
+		}
+		else
+		{
+			// When the solvers are being compared, the island is first solved with the scalar solver
+			// from a saved copy of its state. The state is then restored, and the batched solver is
+			// run on the same input so that the results and timings can be measured against each other.
+
+			contactSolver->SaveState(bodyList);
+
+			unsigned_int64 scalarTime = TheTimeMgr->GetMicrosecondCount();
+			SolveIslandConstraints(bodyList, iterationCount);
+			unsigned_int64 batchedTime = TheTimeMgr->GetMicrosecondCount();
+
+			contactSolver->RecordScalarState();
+			contactSolver->RestoreState();
+
+			if (contactSolver->Build(bodyList))
+			{
+				contactSolver->Solve(iterationCount);
+				unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
+				contactSolver->CompareScalarState((unsigned_int32) (batchedTime - scalarTime), (unsigned_int32) (time - batchedTime));
+				contactSolver->Purge();
+				return;
+			}
+
+			contactSolver->Purge();
+		}
+	}
+
+	SolveIslandConstraints(bodyList, iterationCount);
+}
+
+void PhysicsController::SolveParallelConstraintIslands(List<ConstraintSolverJob> *solverList)
+{
+	ConstraintSolverJob *solverJob = solverList->First();
+	while (solverJob)
+	{
+		if (solverJob->parallelFlag)
+		{
+			JobSolveIslandConstraints(solverJob, nullptr);
+		}
+
+		solverJob = solverJob->Next();
+	}
+}
+
+void PhysicsController::SetPhysicsFlags(unsigned_int32 flags)
+{
+	physicsFlags = flags;
+
+	unsigned_int32 batchFlags = (flags & kPhysicsDeterministic) ? kBatchOrderedFinalize : 0;
+	collisionBatch.SetBatchFlags(batchFlags);
+	constraintSolverBatch.SetBatchFlags(batchFlags);
+	deformableBatch.SetBatchFlags(batchFlags);
+}
+
+unsigned_int32 PhysicsController::CalculateStateChecksum(void) const
+{
+	// The checksum is an FNV-1a hash of the exact bits of the transform and velocities
+	// of every awake rigid body, visited in the order in which they are simulated.
+
+	unsigned_int32 checksum = 2166136261U;
+
+	const RigidBodyController *rigidBody = rigidBodyList[rigidBodyParity].First();
+	while (rigidBody)
+	{
+		const float *data[3] = {&rigidBody->finalTransform(0,0), &rigidBody->linearVelocity.x, &rigidBody->angularVelocity.x};
+		const int32 size[3] = {16, 3, 3};
+
+		for (machine a = 0; a < 3; a++)
+		{
+			const unsigned_int32 *word = reinterpret_cast<const unsigned_int32 *>(data[a]);
+			for (machine k = 0; k < size[a]; k++)
+			{
+				checksum = (checksum ^ word[k]) * 16777619U;
+			}
+		}
+
+		rigidBody = rigidBody->Next();
+	}
+
+	return (checksum);
+}
+
 void PhysicsController::Move(void)
 {
-	int32 time = simulationTime + TheTimeMgr->GetDeltaTime();
+	#if C4PROFILE
+
+		ProfileScope profileScope("PhysicsController::Move");
+
+	#endif
+
+	int32 deltaTime = TheTimeMgr->GetDeltaTime();
+	int32 time = simulationTime + deltaTime;
 	int32 stepCount = time / kPhysicsTimeStep;
 	time -= stepCount * kPhysicsTimeStep;
 
@@ -3177,10 +3486,19 @@ void PhysicsController::Move(void)
 	interpolationParam = (float) time * kInversePhysicsTimeStep;
 
 	stepCount = Min(stepCount, kMaxPhysicsStepCount);
+
+	PhysicsRecorder *recorder = physicsRecorder;
+	if (recorder)
+	{
+		recorder->BeginFrame(deltaTime, stepCount);
+	}
+
 	for (machine a = 0; a < stepCount; a++)
 	{
 		List<RigidBodyController>	bodyList[2];
 
+		unsigned_int64 stepTime = (recorder) ? TheTimeMgr->GetMicrosecondCount() : 0;
+
 		int32 parity = rigidBodyParity;
 		rigidBodyParity = parity ^ 1;
 
@@ -3218,27 +3536,17 @@ void PhysicsController::Move(void)
 		if (bodyCount != 0)
 		{
 			List<ConstraintSolverJob>	solverList;
+			bool						parallelSolve = false;
 
-			List<RigidBodyController> *sleepList = &sleepingList[sleepingParity];
-			for (;;)
-			{
-				RigidBodyController *rigidBody = sleepList->First();
-				if (!rigidBody)
-				{
-					break;
-				}
-
-				float x = rigidBody->bodyCollisionBox.min.x;
-				xmin = Fmin(xmin, x);
-				xmax = Fmax(xmax, x);
-
-				bodyCount++;
-				bodyList[0].Append(rigidBody);
-			}
+			// Sleeping bodies stay in the sleeping list and never enter the sweep. Only awake bodies
+			// are sorted and collided with each other, and then each awake body is tested against the
+			// cached sleeping partition. Bodies woken by new contacts are added to the simulation list.
 
+			List<RigidBodyController> *sleepList = &sleepingList[sleepingParity];
 			simulationList = &bodyList[1];
 
 			CollideRigidBodiesX(&bodyList[0], Max(33 - Cntlz(bodyCount), 8), xmin, xmax, &bodyList[1]);
+			CollideSleepingRigidBodies(&bodyList[1]);
 			TheJobMgr->FinishBatch(&collisionBatch);
 
 			RigidBodyController *rigidBody = bodyList[1].First();
@@ -3253,6 +3561,7 @@ void PhysicsController::Move(void)
 				else
 				{
 					sleepList->Append(rigidBody);
+					sleepingPartitionValid = false;
 				}
 
 				rigidBody = next;
@@ -3276,12 +3585,26 @@ void PhysicsController::Move(void)
 					solverList.Append(solverJob);
 
 					BuildConstraintIsland(rigidBody, solverJob);
-					TheJobMgr->SubmitJob(solverJob, &constraintSolverBatch);
+					PrepareConstraintIsland(solverJob);
+
+					if (!solverJob->parallelFlag)
+					{
+						TheJobMgr->SubmitJob(solverJob, &constraintSolverBatch);
+					}
+					else
+					{
+						parallelSolve = true;
+					}
 
 					physicsCounter[kPhysicsCounterConstraintSolverIsland]++;
 				}
 			}
 
+			if (parallelSolve)
+			{
+				SolveParallelConstraintIslands(&solverList);
+			}
+
 			TheJobMgr->FinishBatch(&constraintSolverBatch);
 
 			for (;;)
@@ -3339,10 +3662,19 @@ void PhysicsController::Move(void)
 						rigidBody = rigidBody->Next();
 					} while (rigidBody);
 
-					TheJobMgr->SubmitJob(solverJob, &constraintSolverBatch);
+					if (!solverJob->parallelFlag)
+					{
+						TheJobMgr->SubmitJob(solverJob, &constraintSolverBatch);
+					}
+
 					solverJob = solverJob->Next();
 				}
 
+				if (parallelSolve)
+				{
+					SolveParallelConstraintIslands(&solverList);
+				}
+
 				TheJobMgr->FinishBatch(&constraintSolverBatch);
 			}
 		}
@@ -3382,6 +3714,7 @@ void PhysicsController::Move(void)
 			else
 			{
 				sleepingList[sleepingParity].Append(rigidBody);
+				sleepingPartitionValid = false;
 			}
 		}
 
@@ -3411,18 +3744,51 @@ void PhysicsController::Move(void)
 			}
 		}
 
+		bool parallelStep = false;
+
 		DeformableBodyController *deformableBody = deformableBodyList.First();
 		while (deformableBody)
 		{
 			physicsCounter[kPhysicsCounterDeformableBodyMove]++;
-			TheJobMgr->SubmitJob(&deformableBody->stepSimulationJob, &deformableBatch);
+
+			if (!(deformableBody->GetDeformableBodyState() & kDeformableBodyParallelStep))
+			{
+				TheJobMgr->SubmitJob(&deformableBody->stepSimulationJob, &deformableBatch);
+			}
+			else
+			{
+				parallelStep = true;
+			}
 
 			deformableBody = deformableBody->Next();
 		}
 
+		if (parallelStep)
+		{
+			// Large deformable bodies are stepped one at a time from the main thread, and each one
+			// spreads its own work over the worker threads while the smaller bodies run as jobs.
+
+			deformableBody = deformableBodyList.First();
+			while (deformableBody)
+			{
+				if (deformableBody->GetDeformableBodyState() & kDeformableBodyParallelStep)
+				{
+					deformableBody->StepParallelSimulation();
+				}
+
+				deformableBody = deformableBody->Next();
+			}
+		}
+
 		TheJobMgr->FinishBatch(&deformableBatch);
 
 		simulationStep++;
+
+		if (recorder)
+		{
+			stepTime = TheTimeMgr->GetMicrosecondCount() - stepTime;
+			recorder->EndStep(CalculateStateChecksum(), (unsigned_int32) stepTime);
+		}
 	}
 
 	deformableBodyList.RemoveAll();
@@ -3430,7 +3796,7 @@ void PhysicsController::Move(void)
 	List<RigidBodyController> *moveList = &rigidBodyList[rigidBodyParity];
 
 	float param = interpolationParam;
-	float decay = TheTimeMgr->GetFloatDeltaTime() * 0.01F;
+	float dt = TheTimeMgr->GetFloatDeltaTime();
 
 	int32 bodyCount = 0;
 	RigidBodyController *rigidBody = moveList->First();
@@ -3447,13 +3813,24 @@ void PhysicsController::Move(void)
 		rotation.SetRotationAboutAxis(rigidBody->motionRotationAngle * param, rigidBody->motionRotationAxis);
 		Transform4D transform(rotation, cm - rotation * cm + rigidBody->motionDisplacement * param);
 
-		Vector3D delta = rigidBody->networkDelta[0] * rigidBody->networkDecay[0] + rigidBody->networkDelta[1] * rigidBody->networkDecay[1];
-		rigidBody->networkDecay[0] = FmaxZero(rigidBody->networkDecay[0] - decay);
-		rigidBody->networkDecay[1] = FmaxZero(rigidBody->networkDecay[1] - decay);
-
 		Node *node = rigidBody->GetTargetNode();
-		node->SetNodeTransform(transform * rigidBody->initialTransform);
-		node->SetNodePosition(node->GetNodePosition() - delta);
+		DeadReckoningSmoother *smoother = &rigidBody->deadReckoningSmoother;
+		if (smoother->Active())
+		{
+			// The rotation offset is applied about the center of mass so that it doesn't
+			// move the rigid body away from the position given by the position offset.
+
+			Transform4D nodeTransform = transform * rigidBody->initialTransform;
+			Point3D center = nodeTransform * rigidBody->bodyCenterOfMass;
+			rotation = smoother->GetRotationOffset().GetRotationMatrix();
+			node->SetNodeTransform(Transform4D(rotation, center - rotation * center + smoother->GetPositionOffset()) * nodeTransform);
+		}
+		else
+		{
+			node->SetNodeTransform(transform * rigidBody->initialTransform);
+		}
+
+		smoother->Update(dt);
 		node->Invalidate();
 
 		bodyCount++;
@@ -12,7 +12,9 @@
 
 #include "C4Shapes.h"
 #include "C4Contacts.h"
+#include "C4ContactSolver.h"
 #include "C4Deformable.h"
+#include "C4DeadReckoning.h"
 
 #if C4DIAGS
 
@@ -83,16 +85,30 @@ namespace C4
 		kPhysicsCounterGeometryIntersection,
 		kPhysicsCounterShapeIntersection,
 		kPhysicsCounterConstraintSolverIsland,
+		kPhysicsCounterBatchedSolverIsland,
+		kPhysicsCounterParallelSolverIsland,
 		kPhysicsCounterDeformableBodyMove,
 		kPhysicsCounterDeformableBodyUpdate,
+		kPhysicsCounterSleepingBody,
+		kPhysicsCounterSleepingPairTest,
+		kPhysicsCounterSleepingPairAvoided,
 		kPhysicsCounterCount
 	};
 
 
+	//# \enum	PhysicsFlags
+
+	enum
+	{
+		kPhysicsDeterministic			= 1 << 0		//## The simulation produces bit-exact results for the same input. Contacts are created and islands are built in an order that does not depend on how jobs are scheduled.
+	};
+
+
 	C4API extern const char kConnectorKeyPhysics[];
 
 
 	class ConstraintSolverJob;
+	class PhysicsRecorder;
 	class WaterBlock;
 	class Model;
 
@@ -701,6 +717,21 @@ namespace C4
 	//# \also	$@RigidBodyController::SetExternalTorque@$
 
 
+	//# \function	RigidBodyController::GetDeadReckoningPublisher		Returns the dead reckoning publisher for a rigid body.
+	//
+	//# \proto	DeadReckoningPublisher *GetDeadReckoningPublisher(void);
+	//
+	//# \desc
+	//# The $GetDeadReckoningPublisher$ function returns a pointer to the $@DeadReckoningPublisher@$ object that decides
+	//# when the server sends a snapshot for a rigid body. Snapshots are only sent when the rigid body deviates from the
+	//# motion that client machines extrapolate from the previous snapshot, and the thresholds controlling this can be
+	//# changed through the returned object. On client machines, the correction made when a snapshot is received is spread
+	//# over time so that remote rigid bodies move smoothly even when snapshots arrive infrequently.
+	//
+	//# \also	$@DeadReckoningPublisher@$
+	//# \also	$@DeadReckoningSmoother@$
+
+
 	//# \function	RigidBodyController::SetRigidBodyTransform		Sets the node transform for a rigid body.
 	//
 	//# \proto	void SetRigidBodyTransform(const Transform4D& transform);
@@ -952,6 +983,7 @@ namespace C4
 	class RigidBodyController : public BodyController, public ListElement<RigidBodyController>, public SnapshotSender
 	{
 		friend class PhysicsController;
+		friend class ContactSolver;
 
 		private:
 
@@ -1000,6 +1032,8 @@ namespace C4
 			bool					repeatCollisionFlag;
 			Box3D					bodyCollisionBox;
 
+			int32					solverBodyIndex;
+
 			Vector3D				linearVelocity;
 			Antivector3D			angularVelocity;
 			Vector3D				movementVelocity;
@@ -1038,9 +1072,8 @@ namespace C4
 			Vector3D				impulseForce;
 			Antivector3D			impulseTorque;
 
-			Vector3D				networkDelta[2];
-			float					networkDecay[2];
-			unsigned_int32			networkParity;
+			DeadReckoningPublisher	deadReckoningPublisher;
+			DeadReckoningSmoother	deadReckoningSmoother;
 
 			SleepState				sleepState[2];
 
@@ -1266,6 +1299,11 @@ namespace C4
 				return (angularVelocity);
 			}
 
+			DeadReckoningPublisher *GetDeadReckoningPublisher(void)
+			{
+				return (&deadReckoningPublisher);
+			}
+
 			void SetAngularVelocity(const Antivector3D& velocity)
 			{
 				angularVelocity = velocity;
@@ -1695,6 +1733,72 @@ namespace C4
 	//# \also	$@BodyController::SetGravityMultiplier@$
 
 
+	//# \function	PhysicsController::GetContactSolverMode		Returns the solver used for islands of colliding rigid bodies.
+	//
+	//# \proto	ContactSolverMode GetContactSolverMode(void) const;
+	//
+	//# \desc
+	//# The $GetContactSolverMode$ function returns the solver used for islands of rigid bodies that are connected
+	//# only by collision contacts, which can be one of the following constants.
+	//
+	//# \table	ContactSolverMode
+	//
+	//# \also	$@PhysicsController::SetContactSolverMode@$
+
+
+	//# \function	PhysicsController::SetContactSolverMode		Sets the solver used for islands of colliding rigid bodies.
+	//
+	//# \proto	void SetContactSolverMode(ContactSolverMode mode);
+	//
+	//# \param	mode	The new contact solver mode.
+	//
+	//# \desc
+	//# The $SetContactSolverMode$ function sets the solver used for islands of rigid bodies that are connected
+	//# only by collision contacts. The $mode$ parameter can be one of the following constants.
+	//
+	//# \table	ContactSolverMode
+	//
+	//# Islands that contain joints or rigid bodies having rolling resistance or spin friction are always solved
+	//# with the scalar solver. The initial value of the contact solver mode is $kContactSolverScalar$, so the
+	//# batched solver is only used when it is explicitly enabled.
+	//
+	//# \also	$@PhysicsController::GetContactSolverMode@$
+
+
+	//# \function	PhysicsController::GetPhysicsFlags		Returns the physics flags.
+	//
+	//# \proto	unsigned_int32 GetPhysicsFlags(void) const;
+	//
+	//# \desc
+	//# The $GetPhysicsFlags$ function returns the physics flags, which can be a combination (through logical OR) of the
+	//# following constants.
+	//
+	//# \table	PhysicsFlags
+	//
+	//# \also	$@PhysicsController::SetPhysicsFlags@$
+
+
+	//# \function	PhysicsController::SetPhysicsFlags		Sets the physics flags.
+	//
+	//# \proto	void SetPhysicsFlags(unsigned_int32 flags);
+	//
+	//# \param	flags	The new physics flags.
+	//
+	//# \desc
+	//# The $SetPhysicsFlags$ function sets the physics flags to the value specified by the $flags$ parameter, which can be
+	//# a combination (through logical OR) of the following constants.
+	//
+	//# \table	PhysicsFlags
+	//
+	//# In deterministic mode, the collision and constraint solver jobs are still run in parallel, but their results
+	//# are applied in the order in which the jobs were submitted. The number of steps run in each frame depends only
+	//# on the world delta time, so the same sequence of delta times always produces the same simulation. The initial
+	//# value of the physics flags is 0.
+	//
+	//# \also	$@PhysicsController::GetPhysicsFlags@$
+	//# \also	$@PhysicsRecorder@$
+
+
 	//# \function	PhysicsController::WakeFieldRigidBodies		Wakes all rigid bodies affected by a force field.
 	//
 	//# \proto	void WakeFieldRigidBodies(const Field *field);
@@ -1732,6 +1836,13 @@ namespace C4
 
 		private:
 
+			struct SleepingBodyData
+			{
+				float					xmin;
+				float					xmax;
+				RigidBodyController		*rigidBody;
+			};
+
 			Graph<Body, Contact>				physicsGraph;
 			Body								nullBody;
 
@@ -1739,11 +1850,16 @@ namespace C4
 			int32								simulationTime;
 			float								interpolationParam;
 
+			unsigned_int32						physicsFlags;
+			PhysicsRecorder						*physicsRecorder;
+
 			float								maxLinearSpeed;
 			float								maxAngularSpeed;
 
 			Vector3D							gravityAcceleration;
 
+			ContactSolverMode					contactSolverMode;
+
 			unsigned_int32						rigidBodyParity;
 			unsigned_int32						sleepingParity;
 
@@ -1754,6 +1870,9 @@ namespace C4
 			List<RigidBodyController>			sleepingList[2];
 			List<RigidBodyController>			*simulationList;
 
+			bool								sleepingPartitionValid;
+			Array<SleepingBodyData>				sleepingPartition;
+
 			List<DeformableBodyController>		deformableBodyList;
 			Batch								deformableBatch;
 
@@ -1773,6 +1892,10 @@ namespace C4
 			void CollideRigidBodiesY(List<RigidBodyController> *inputList, int32 depth, float ymin, float ymax, List<RigidBodyController> *outputList);
 			void CollideRigidBodiesZ(List<RigidBodyController> *inputList, int32 depth, float zmin, float zmax, List<RigidBodyController> *outputList);
 
+			static void SiftSleepingBody(SleepingBodyData *data, machine root, machine count);
+			void BuildSleepingPartition(void);
+			void CollideSleepingRigidBodies(const List<RigidBodyController> *awakeList);
+
 			void DetectBodyCollision(RigidBodyController *alphaBody, RigidBodyController *betaBody);
 
 			static void JobDetectShapeCollision(Job *job, void *cookie);
@@ -1780,7 +1903,10 @@ namespace C4
 			static void FinalizeNewShapeContact(Job *job, void *cookie);
 
 			static void BuildConstraintIsland(RigidBodyController *rigidBody, ConstraintSolverJob *solverJob);
+			void PrepareConstraintIsland(ConstraintSolverJob *solverJob);
+			static void SolveIslandConstraints(const List<RigidBodyController> *bodyList, int32 iterationCount);
 			static void JobSolveIslandConstraints(Job *job, void *cookie);
+			static void SolveParallelConstraintIslands(List<ConstraintSolverJob> *solverList);
 
 		public:
 
@@ -1807,6 +1933,21 @@ namespace C4
 				return (interpolationParam);
 			}
 
+			unsigned_int32 GetPhysicsFlags(void) const
+			{
+				return (physicsFlags);
+			}
+
+			PhysicsRecorder *GetPhysicsRecorder(void) const
+			{
+				return (physicsRecorder);
+			}
+
+			void SetPhysicsRecorder(PhysicsRecorder *recorder)
+			{
+				physicsRecorder = recorder;
+			}
+
 			float GetMaxLinearSpeed(void) const
 			{
 				return (maxLinearSpeed);
@@ -1837,6 +1978,16 @@ namespace C4
 				gravityAcceleration = acceleration;
 			}
 
+			ContactSolverMode GetContactSolverMode(void) const
+			{
+				return (contactSolverMode);
+			}
+
+			void SetContactSolverMode(ContactSolverMode mode)
+			{
+				contactSolverMode = mode;
+			}
+
 			unsigned_int32 IncrementFieldStamp(void)
 			{
 				return (++fieldApplicationStamp);
@@ -1881,6 +2032,9 @@ namespace C4
 
 			void AddBrokenJoint(Joint *joint);
 
+			C4API void SetPhysicsFlags(unsigned_int32 flags);
+			C4API unsigned_int32 CalculateStateChecksum(void) const;
+
 			void Move(void) override;
 	};
 
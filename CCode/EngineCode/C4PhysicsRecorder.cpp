@@ -0,0 +1,326 @@
+ 
+
+#include "C4PhysicsRecorder.h"
+#include "C4Input.h"
+#include "C4World.h"
+#include "C4Files.h"
+
+
+using namespace C4;
+
+
+namespace
+{
+	enum
+	{
+		kPhysicsRecordingType		= 'PREC'
+	};
+}
+
+
+PhysicsRecorder::PhysicsRecorder()
+{
+	worldName[0] = 0;
+	Math::GetRandomSeed(randomSeed);
+
+	replayFlag = false;
+	stepIndex = 0;
+
+	mismatchStep = -1;
+	mismatchCount = 0;
+}
+
+PhysicsRecorder::~PhysicsRecorder()
+{
+	if ((TheInputMgr) && (TheInputMgr->GetActionRecordCookie() == this))
+	{
+		TheInputMgr->SetActionRecordProc(nullptr);
+	}
+}
+
+bool PhysicsRecorder::LoadWorld(void)
+{
+	// The random seed is set before the world is loaded because controllers
+	// can use random numbers while they are being preprocessed.
+
+	Math::SetRandomSeed(randomSeed);
+	if (TheWorldMgr->LoadWorld(worldName) != kWorldOkay)
+	{
+		return (false);
+	}
+
+	PhysicsController *physicsController = TheWorldMgr->GetWorld()->FindPhysicsController();
+	if (!physicsController)
+	{
+		TheWorldMgr->UnloadWorld();
+		return (false);
+	}
+
+	physicsController->SetPhysicsFlags(physicsController->GetPhysicsFlags() | kPhysicsDeterministic);
+	physicsController->SetPhysicsRecorder(this);
+	return (true);
+}
+
+bool PhysicsRecorder::BeginRecording(const char *name)
+{
+	worldName = name;
+	Math::GetRandomSeed(randomSeed);
+
+	replayFlag = false;
+	frameArray.Clear();
+	inputArray.Clear();
+	checksumArray.Clear();
+	stepTimeArray.Clear();
+
+	if (!LoadWorld())
+	{
+		return (false);
+	}
+
+	TheInputMgr->SetActionRecordProc(&RecordAction, this);
+	return (true);
+}
+
+void PhysicsRecorder::EndRecording(void)
+{
+	if (TheInputMgr->GetActionRecordCookie() == this)
+	{
+		TheInputMgr->SetActionRecordProc(nullptr);
+	}
+
+	World *world = TheWorldMgr->GetWorld();
+	if (world)
+	{
+		PhysicsController *physicsController = world->FindPhysicsController();
+		if ((physicsController) && (physicsController->GetPhysicsRecorder() == this))
+		{
+			physicsController->SetPhysicsRecorder(nullptr);
+		}
+	}
+}
+
+bool PhysicsRecorder::Save(const char *path) const
+{
+	File					file;
+	PhysicsRecordingHeader	header;
+
+	if (file.Open(path, kFileCreate) != kFileOkay)
+	{
+		return (false);
+	}
+
+	MemoryMgr::ClearMemory(&header, sizeof(PhysicsRecordingHeader));
+
+	header.recordingType = kPhysicsRecordingType;
+	header.recordingVersion = kPhysicsRecordingVersion;
+
+	for (machine a = 0; a < 4; a++)
+	{
+		header.randomSeed[a] = randomSeed[a];
+	}
+
+	header.frameCount = frameArray.GetElementCount();
+	header.stepCount = checksumArray.GetElementCount();
+	header.inputCount = inputArray.GetElementCount();
+	Text::CopyText(worldName, header.worldName, kMaxResourceNameLength);
+
+	if (file.Write(&header, sizeof(PhysicsRecordingHeader)) != kFileOkay)
+	{
+		return (false);
+	}
+
+	if ((header.frameCount != 0) && (file.Write(&frameArray[0], header.frameCount * sizeof(FrameData)) != kFileOkay))
+	{
+		return (false);
+	}
+
+	if ((header.inputCount != 0) && (file.Write(&inputArray[0], header.inputCount * sizeof(InputData)) != kFileOkay))
+	{
+		return (false);
+	}
+
+	if ((header.stepCount != 0) && (file.Write(&checksumArray[0], header.stepCount * 4) != kFileOkay))
+	{
+		return (false);
+	}
+
+	return (true);
+}
+
+bool PhysicsRecorder::Load(const char *path)
+{
+	File					file;
+	PhysicsRecordingHeader	header;
+
+	if (file.Open(path) != kFileOkay)
+	{
+		return (false);
+	}
+
+	if ((file.Read(&header, sizeof(PhysicsRecordingHeader)) != kFileOkay) || (header.recordingType != kPhysicsRecordingType) || (header.recordingVersion != kPhysicsRecordingVersion))
+	{
+		return (false);
+	}
+
+	int32 frameCount = header.frameCount;
+	int32 stepCount = header.stepCount;
+	int32 inputCount = header.inputCount;
+	if ((frameCount < 0) || (stepCount < 0) || (inputCount < 0) || (file.GetSize() != sizeof(PhysicsRecordingHeader) + frameCount * sizeof(FrameData) + inputCount * sizeof(InputData) + stepCount * 4))
+	{
+		return (false);
+	}
+
+	header.worldName[kMaxResourceNameLength] = 0;
+	worldName = header.worldName;
+
+	for (machine a = 0; a < 4; a++)
+	{
+		randomSeed[a] = header.randomSeed[a];
+	}
+
+	frameArray.SetElementCount(frameCount);
+	inputArray.SetElementCount(inputCount);
+	checksumArray.SetElementCount(stepCount);
+	stepTimeArray.Clear();
+
+	if ((frameCount != 0) && (file.Read(&frameArray[0], frameCount * sizeof(FrameData)) != kFileOkay))
+	{
+		return (false);
+	}
+
+	if ((inputCount != 0) && (file.Read(&inputArray[0], inputCount * sizeof(InputData)) != kFileOkay))
+	{
+		return (false);
+	}
+
+	if ((stepCount != 0) && (file.Read(&checksumArray[0], stepCount * 4) != kFileOkay))
+	{
+		return (false);
+	}
+
+	return (true);
+}
+
+bool PhysicsRecorder::Replay(void)
+{
+	replayFlag = true;
+	stepIndex = 0;
+	stepTimeArray.Clear();
+	stepTimeArray.Reserve(checksumArray.GetElementCount());
+
+	mismatchStep = -1;
+	mismatchCount = 0;
+
+	bool result = LoadWorld();
+	if (result)
+	{
+		// Each recorded frame is run exactly as the World Manager runs it in the main loop,
+		// but the delta time comes from the recording instead of the system clock, and the
+		// recorded action events take the place of the Input Manager's input task.
+
+		int32 inputIndex = 0;
+		int32 frameCount = frameArray.GetElementCount();
+		for (machine a = 0; a < frameCount; a++)
+		{
+			ReplayInput(a, &inputIndex);
+
+			TheTimeMgr->SetWorldDeltaTime(frameArray[a].deltaTime);
+			TheWorldMgr->Move();
+		}
+
+		EndRecording();
+	}
+
+	replayFlag = false;
+	return (result);
+}
+
+void PhysicsRecorder::ReplayInput(int32 frameIndex, int32 *inputIndex) const
+{
+	int32 index = *inputIndex;
+	int32 count = inputArray.GetElementCount();
+
+	while ((index < count) && (inputArray[index].frameIndex <= frameIndex))
+	{
+		const InputData *input = &inputArray[index];
+
+		Action *action = TheInputMgr->FindAction(input->actionType);
+		if (action)
+		{
+			switch (input->actionEvent)
+			{
+				case kActionEventBegin:
+
+					TheInputMgr->BeginAction(action);
+					break;
+
+				case kActionEventEnd:
+
+					TheInputMgr->EndAction(action);
+					break;
+
+				case kActionEventMove:
+
+					TheInputMgr->MoveAction(action, (int32) input->actionValue);
+					break;
+
+				case kActionEventUpdate:
+
+					TheInputMgr->UpdateAction(action, input->actionValue);
+					break;
+			}
+		}
+
+		index++;
+	}
+
+	*inputIndex = index;
+}
+
+void PhysicsRecorder::RecordAction(const Action *action, int32 event, float value, void *cookie)
+{
+	// Action events are dispatched by the input task before the world is moved, so each
+	// one belongs to the frame that has not yet been recorded.
+
+	PhysicsRecorder *recorder = static_cast<PhysicsRecorder *>(cookie);
+
+	InputData *input = recorder->inputArray.AddElement();
+	input->frameIndex = recorder->frameArray.GetElementCount();
+	input->actionType = action->GetActionType();
+	input->actionEvent = event;
+	input->actionValue = value;
+}
+
+void PhysicsRecorder::BeginFrame(int32 deltaTime, int32 stepCount)
+{
+	if (!replayFlag)
+	{
+		FrameData *frame = frameArray.AddElement();
+		frame->deltaTime = deltaTime;
+		frame->stepCount = stepCount;
+	}
+}
+
+void PhysicsRecorder::EndStep(unsigned_int32 checksum, unsigned_int32 time)
+{
+	if (!replayFlag)
+	{
+		checksumArray.AddElement(checksum);
+		return;
+	}
+
+	int32 index = stepIndex++;
+	stepTimeArray.AddElement(time);
+
+	if ((index >= checksumArray.GetElementCount()) || (checksumArray[index] != checksum))
+	{
+		if (mismatchStep < 0)
+		{
+			mismatchStep = index;
+		}
+
+		mismatchCount++;
+	}
+}
+
+// ZYUQURM
@@ -0,0 +1,213 @@
+ 
+
+#ifndef C4PhysicsRecorder_h
+#define C4PhysicsRecorder_h
+
+
+//# \component	Physics Manager
+//# \prefix		PhysicsMgr/
+
+
+#include "C4Resources.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kPhysicsRecordingVersion		= 2
+	};
+
+
+	class Action;
+
+
+	struct PhysicsRecordingHeader
+	{
+		int32				recordingType;
+		int32				recordingVersion;
+		unsigned_int32		randomSeed[4];
+		int32				frameCount;
+		int32				stepCount;
+		int32				inputCount;
+		char				worldName[kMaxResourceNameLength + 1];
+	};
+
+
+	//# \class	PhysicsRecorder		Records a physics session so that it can be replayed deterministically.
+	//
+	//# The $PhysicsRecorder$ class records a physics session so that it can be replayed deterministically.
+	//
+	//# \def	class PhysicsRecorder
+	//
+	//# \ctor	PhysicsRecorder();
+	//
+	//# \desc
+	//# The $PhysicsRecorder$ class captures the inputs that determine the outcome of a physics simulation so that the
+	//# same session can later be reproduced bit-exactly. A recording begins by loading a world from scratch with the
+	//# $@PhysicsRecorder::BeginRecording@$ function, which puts the world's $@PhysicsController@$ in deterministic mode.
+	//# Recording then stores the random seed, the world delta time for each frame, every action event dispatched by the
+	//# Input Manager, and a checksum of the state of all rigid bodies after each simulation step.
+	//#
+	//# The $@PhysicsRecorder::Replay@$ function loads the world again, restores the random seed, and runs the recorded
+	//# frames back to back without rendering. Before each frame is moved, the action events that were recorded for it
+	//# are sent to the actions registered with the Input Manager, and the frame is then given the recorded delta time,
+	//# so the physics simulation runs exactly the same steps. The checksum after each step is compared with the recorded
+	//# one. The first step that differs identifies where a desynchronization begins. The time taken by each step is also
+	//# measured.
+	//#
+	//# Input is captured at the level of actions, so a replay reproduces a session only if the application registers the
+	//# same actions while the world loads. Messages received from other machines are not part of a recording.
+	//
+	//# \also	$@PhysicsController::SetPhysicsFlags@$
+
+
+	//# \function	PhysicsRecorder::BeginRecording		Loads a world and begins recording its physics simulation.
+	//
+	//# \proto	bool BeginRecording(const char *name);
+	//
+	//# \param	name	The name of the world to record.
+	//
+	//# \desc
+	//# The $BeginRecording$ function loads the world specified by the $name$ parameter, replacing the current world,
+	//# and begins recording its physics simulation. If the world cannot be loaded or it does not contain a physics
+	//# controller, then the return value is $false$. Otherwise, the return value is $true$.
+	//
+	//# \also	$@PhysicsRecorder::EndRecording@$
+	//# \also	$@PhysicsRecorder::Save@$
+
+
+	//# \function	PhysicsRecorder::EndRecording		Stops recording.
+	//
+	//# \proto	void EndRecording(void);
+	//
+	//# \desc
+	//# The $EndRecording$ function stops recording the physics simulation of the current world. This function must
+	//# be called before the recorder is destroyed if the recorded world is still loaded.
+	//
+	//# \also	$@PhysicsRecorder::BeginRecording@$
+
+
+	//# \function	PhysicsRecorder::Replay		Replays a recorded physics session.
+	//
+	//# \proto	bool Replay(void);
+	//
+	//# \desc
+	//# The $Replay$ function loads the recorded world, replacing the current world, and runs all of the recorded
+	//# frames. When it returns, the checksum comparisons and step times are available. If the world cannot be loaded
+	//# or it does not contain a physics controller, then the return value is $false$. Otherwise, the return value is $true$.
+	//
+	//# \also	$@PhysicsRecorder::Load@$
+	//# \also	$@PhysicsRecorder::GetMismatchStep@$
+
+
+	//# \function	PhysicsRecorder::GetMismatchStep		Returns the first step whose state did not match the recording.
+	//
+	//# \proto	int32 GetMismatchStep(void) const;
+	//
+	//# \desc
+	//# The $GetMismatchStep$ function returns the index of the first step for which the state checksum differed from the
+	//# recording during the most recent replay. If every step matched, then the return value is &minus;1.
+	//
+	//# \also	$@PhysicsRecorder::Replay@$
+
+
+	class PhysicsRecorder
+	{
+		private:
+
+			struct FrameData
+			{
+				int32		deltaTime;
+				int32		stepCount;
+			};
+
+			struct InputData
+			{
+				int32		frameIndex;
+				Type		actionType;
+				int32		actionEvent;
+				float		actionValue;
+			};
+
+			ResourceName				worldName;
+			unsigned_int32				randomSeed[4];
+
+			bool						replayFlag;
+			int32						stepIndex;
+
+			Array<FrameData>			frameArray;
+			Array<InputData>			inputArray;
+			Array<unsigned_int32>		checksumArray;
+			Array<unsigned_int32>		stepTimeArray;
+
+			int32						mismatchStep;
+			int32						mismatchCount;
+
+			bool LoadWorld(void);
+			void ReplayInput(int32 frameIndex, int32 *inputIndex) const;
+
+			static void RecordAction(const Action *action, int32 event, float value, void *cookie);
+
+		public:
+
+			C4API PhysicsRecorder();
+			C4API ~PhysicsRecorder();
+
+			const ResourceName& GetWorldName(void) const
+			{
+				return (worldName);
+			}
+
+			int32 GetFrameCount(void) const
+			{
+				return (frameArray.GetElementCount());
+			}
+
+			int32 GetInputCount(void) const
+			{
+				return (inputArray.GetElementCount());
+			}
+
+			int32 GetStepCount(void) const
+			{
+				return (checksumArray.GetElementCount());
+			}
+
+			int32 GetReplayStepCount(void) const
+			{
+				return (stepTimeArray.GetElementCount());
+			}
+
+			unsigned_int32 GetStepTime(int32 index) const
+			{
+				return (stepTimeArray[index]);
+			}
+
+			int32 GetMismatchStep(void) const
+			{
+				return (mismatchStep);
+			}
+
+			int32 GetMismatchCount(void) const
+			{
+				return (mismatchCount);
+			}
+
+			C4API bool BeginRecording(const char *name);
+			C4API void EndRecording(void);
+
+			C4API bool Save(const char *path) const;
+			C4API bool Load(const char *path);
+
+			C4API bool Replay(void);
+
+			void BeginFrame(int32 deltaTime, int32 stepCount);
+			void EndStep(unsigned_int32 checksum, unsigned_int32 time);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
@@ -0,0 +1,321 @@
+ 
+
+#include "C4Profiler.h"
+#include "C4Engine.h"
+
+
+#if C4PROFILE
+
+using namespace C4;
+
+
+ProfileTimeline *Profiler::timelineTable[kMaxProfileThreadCount];
+volatile int32 Profiler::timelineCount = 0;
+Mutex Profiler::timelineMutex;
+
+thread_local ProfileTimeline *Profiler::threadTimeline = nullptr;
+
+bool Profiler::profilerEnabled = false;
+
+unsigned_int64 Profiler::frameBeginTime = 0;
+unsigned_int32 Profiler::maxFrameTime = 0;
+
+unsigned_int32 Profiler::spikeThreshold = 0;
+int32 Profiler::spikeCount = 0;
+
+Job *Profiler::spikeJob = nullptr;
+int32 Profiler::spikeIndex = 0;
+
+
+ProfileTimeline::ProfileTimeline(const char *name, int32 index)
+{
+	threadName = name;
+	threadIndex = index;
+
+	eventCount = 0;
+	scopeDepth = 0;
+}
+
+ProfileTimeline::~ProfileTimeline()
+{
+}
+
+void ProfileTimeline::BeginScope(const char *name, unsigned_int64 time)
+{
+	int32 depth = scopeDepth;
+	if (depth < kMaxProfileScopeDepth)
+	{
+		ScopeData *data = &scopeStack[depth];
+		data->scopeName = name;
+		data->beginTime = time;
+	}
+
+	scopeDepth = depth + 1;
+}
+
+void ProfileTimeline::EndScope(unsigned_int64 time)
+{
+	int32 depth = scopeDepth - 1;
+	if (depth >= 0)
+	{
+		scopeDepth = depth;
+		if (depth < kMaxProfileScopeDepth)
+		{
+			const ScopeData *data = &scopeStack[depth];
+
+			int32 count = eventCount;
+			ProfileEvent *event = &eventRing[count & (kProfileRingSize - 1)];
+			event->eventName = data->scopeName;
+			event->beginTime = data->beginTime;
+			event->eventDuration = (unsigned_int32) (time - data->beginTime);
+			event->eventDepth = depth;
+
+			Thread::Fence();
+			eventCount = count + 1;
+		}
+	}
+}
+
+
+void Profiler::Initialize(void)
+{
+	RegisterThread("Main");
+	frameBeginTime = GetTime();
+}
+
+void Profiler::Terminate(void)
+{
+	timelineMutex.Acquire();
+
+	int32 count = timelineCount;
+	timelineCount = 0;
+
+	for (machine a = 0; a < count; a++)
+	{
+		delete timelineTable[a];
+	}
+
+	timelineMutex.Release();
+}
+
+unsigned_int64 Profiler::GetTime(void)
+{
+	return (TheTimeMgr->GetMicrosecondCount());
+}
+
+ProfileTimeline *Profiler::NewTimeline(const char *name)
+{
+	ProfileTimeline *timeline = nullptr;
+
+	timelineMutex.Acquire();
+
+	int32 count = timelineCount;
+	if (count < kMaxProfileThreadCount)
+	{
+		timeline = new ProfileTimeline(name, count);
+		timelineTable[count] = timeline;
+
+		Thread::Fence();
+		timelineCount = count + 1;
+	}
+
+	timelineMutex.Release();
+	return (timeline);
+}
+
+void Profiler::RegisterThread(const char *name)
+{
+	ProfileTimeline *timeline = threadTimeline;
+	if (!timeline)
+	{
+		threadTimeline = NewTimeline(name);
+	}
+	else
+	{
+		timeline->threadName = name;
+	}
+}
+
+bool Profiler::BeginScope(const char *name)
+{
+	// The return value indicates whether the scope was pushed onto the thread's scope stack.
+	// The caller must call EndScope() exactly when it is true, even if the profiler has been
+	// disabled in the meantime, so that the stack stays balanced.
+
+	if (profilerEnabled)
+	{
+		ProfileTimeline *timeline = threadTimeline;
+		if (!timeline)
+		{
+			timeline = NewTimeline("Thread");
+			if (!timeline)
+			{
+				return (false);
+			}
+
+			threadTimeline = timeline;
+		}
+
+		timeline->BeginScope(name, GetTime());
+		return (true);
+	}
+
+	return (false);
+}
+
+void Profiler::EndScope(void)
+{
+	threadTimeline->EndScope(GetTime());
+}
+
+void Profiler::NewFrame(void)
+{
+	unsigned_int64 time = GetTime();
+	unsigned_int64 beginTime = frameBeginTime;
+	frameBeginTime = time;
+
+	if (profilerEnabled)
+	{
+		ProfileTimeline *timeline = threadTimeline;
+		if (timeline)
+		{
+			unsigned_int32 frameTime = (unsigned_int32) (time - beginTime);
+			maxFrameTime = Max(maxFrameTime, frameTime);
+
+			int32 count = timeline->eventCount;
+			ProfileEvent *event = &timeline->eventRing[count & (kProfileRingSize - 1)];
+			event->eventName = "Frame";
+			event->beginTime = beginTime;
+			event->eventDuration = frameTime;
+			event->eventDepth = -1;
+
+			Thread::Fence();
+			timeline->eventCount = count + 1;
+
+			// Spike traces are written by a job so that the file output doesn't stall the main thread.
+			// If the previous spike is still being exported, then the new spike is not recorded.
+
+			unsigned_int32 threshold = spikeThreshold;
+			if ((threshold != 0) && (frameTime > threshold) && (spikeCount < kMaxProfileSpikeCount))
+			{
+				Job *job = spikeJob;
+				if ((!job) || (job->Complete()))
+				{
+					if (!job)
+					{
+						job = new Job(&JobExportSpike);
+						spikeJob = job;
+					}
+
+					spikeIndex = ++spikeCount;
+					TheJobMgr->SubmitJob(job);
+				}
+			}
+		}
+	}
+}
+
+void Profiler::JobExportSpike(Job *job, void *cookie)
+{
+	String<kMaxFileNameLength> path(TheResourceMgr->GetSaveCatalog()->GetRootPath());
+	((path += "C4Spike") += spikeIndex) += ".json";
+	ExportTrace(path);
+}
+
+void Profiler::FinishSpikeExport(void)
+{
+	// This is called before the Job Manager is destroyed. Deleting the job waits for it to finish
+	// if it is currently executing and removes it from the ready list if it hasn't started yet.
+
+	delete spikeJob;
+	spikeJob = nullptr;
+}
+
+void Profiler::WriteEvent(File *file, const ProfileEvent *event, int32 threadIndex, unsigned_int64 baseTime)
+{
+	*file << ",\n{\"name\":\"" << event->eventName;
+	*file << "\",\"cat\":\"" << ((event->eventDepth < 0) ? "frame" : "cpu");
+	*file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIndex;
+	*file << ",\"ts\":" << (unsigned_int32) (event->beginTime - baseTime);
+	*file << ",\"dur\":" << event->eventDuration << "}";
+}
+
+bool Profiler::ExportTrace(const char *path)
+{
+	File	file;
+
+	if (file.Open(path, kFileCreate) != kFileOkay)
+	{
+		return (false);
+	}
+
+	int32 timelineTotal = timelineCount;
+	Thread::Fence();
+
+	ProfileEvent *eventStorage = new ProfileEvent[kProfileRingSize];
+
+	// The earliest surviving event across all timelines becomes time zero
+	// so that timestamps fit in 32 bits.
+
+	unsigned_int64 baseTime = GetTime();
+	for (machine a = 0; a < timelineTotal; a++)
+	{
+		const ProfileTimeline *timeline = timelineTable[a];
+		int32 count = timeline->eventCount;
+		if (count > 0)
+		{
+			int32 first = MaxZero(count + 1 - kProfileRingSize);
+			for (machine k = first; k < count; k++)
+			{
+				baseTime = Min(baseTime, timeline->eventRing[k & (kProfileRingSize - 1)].beginTime);
+			}
+		}
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool firstEvent = true;
+	for (machine a = 0; a < timelineTotal; a++)
+	{
+		const ProfileTimeline *timeline = timelineTable[a];
+		int32 threadIndex = timeline->threadIndex;
+
+		file << ((firstEvent) ? "\n" : ",\n");
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadIndex << ",\"args\":{\"name\":\"" << timeline->threadName << "\"}}";
+		firstEvent = false;
+
+		int32 count = timeline->eventCount;
+		Thread::Fence();
+
+		int32 first = MaxZero(count + 1 - kProfileRingSize);
+		for (machine k = first; k < count; k++)
+		{
+			eventStorage[k - first] = timeline->eventRing[k & (kProfileRingSize - 1)];
+		}
+
+		// Any events that the owning thread wrote over while they were being
+		// copied are discarded by checking the event count a second time. The
+		// slot for the next event may be in the middle of being written, so the
+		// oldest event in the ring is never considered valid.
+
+		Thread::Fence();
+		int32 valid = MaxZero(timeline->eventCount + 1 - kProfileRingSize);
+		for (machine k = Max(first, valid); k < count; k++)
+		{
+			const ProfileEvent *event = &eventStorage[k - first];
+			if (event->beginTime >= baseTime)
+			{
+				WriteEvent(&file, event, threadIndex, baseTime);
+			}
+		}
+	}
+
+	file << "\n]}\n";
+
+	delete[] eventStorage;
+	return (true);
+}
+
+#endif
+
+// ZYUQURM
@@ -0,0 +1,215 @@
+ 
+
+#ifndef C4Profiler_h
+#define C4Profiler_h
+
+
+#include "C4Threads.h"
+#include "C4String.h"
+
+
+#if C4PROFILE
+
+	namespace C4
+	{
+		enum
+		{
+			kMaxProfileThreadCount		= 32,
+			kMaxProfileScopeDepth		= 32,
+			kProfileRingSize			= 16384,
+			kMaxProfileSpikeCount		= 32
+		};
+
+
+		class File;
+
+
+		struct ProfileEvent
+		{
+			const char			*eventName;
+			unsigned_int64		beginTime;
+			unsigned_int32		eventDuration;
+			int32				eventDepth;
+		};
+
+
+		// A ProfileTimeline holds the most recent scopes completed by a single thread in a ring buffer.
+		// Only the owning thread ever writes to the ring, and it publishes each event by incrementing
+		// the event count after a memory fence. The exporter reads the ring without taking a lock and
+		// discards any events that could have been overwritten while it was copying them.
+
+		class ProfileTimeline
+		{
+			friend class Profiler;
+
+			private:
+
+				struct ScopeData
+				{
+					const char			*scopeName;
+					unsigned_int64		beginTime;
+				};
+
+				String<31>				threadName;
+				int32					threadIndex;
+
+				volatile int32			eventCount;
+
+				int32					scopeDepth;
+				ScopeData				scopeStack[kMaxProfileScopeDepth];
+
+				ProfileEvent			eventRing[kProfileRingSize];
+
+				ProfileTimeline(const char *name, int32 index);
+
+				void BeginScope(const char *name, unsigned_int64 time);
+				void EndScope(unsigned_int64 time);
+
+			public:
+
+				~ProfileTimeline();
+
+				const char *GetThreadName(void) const
+				{
+					return (threadName);
+				}
+
+				int32 GetThreadIndex(void) const
+				{
+					return (threadIndex);
+				}
+
+				int32 GetEventCount(void) const
+				{
+					return (eventCount);
+				}
+		};
+
+
+		// The Profiler class records hierarchical CPU timing scopes on every thread that uses them and
+		// exports the recorded timelines in the Chrome trace event format, which can be viewed with the
+		// chrome://tracing page or any compatible trace viewer. Each thread gets its own timeline the first
+		// time it opens a scope, so recording a scope never acquires a lock. If a spike threshold is set,
+		// then the timelines are exported automatically whenever a frame takes longer than the threshold
+		// until kMaxProfileSpikeCount files have been written.
+
+		class Profiler
+		{
+			private:
+
+				static ProfileTimeline		*timelineTable[kMaxProfileThreadCount];
+				static volatile int32		timelineCount;
+				static Mutex				timelineMutex;
+
+				static thread_local ProfileTimeline		*threadTimeline;
+
+				static bool					profilerEnabled;
+
+				static unsigned_int64		frameBeginTime;
+				static unsigned_int32		maxFrameTime;
+
+				static unsigned_int32		spikeThreshold;
+				static int32				spikeCount;
+
+				static Job					*spikeJob;
+				static int32				spikeIndex;
+
+				static unsigned_int64 GetTime(void);
+
+				static ProfileTimeline *NewTimeline(const char *name);
+
+				static void JobExportSpike(Job *job, void *cookie);
+
+				static void WriteEvent(File *file, const ProfileEvent *event, int32 threadIndex, unsigned_int64 baseTime);
+
+			public:
+
+				C4API static void Initialize(void);
+				C4API static void Terminate(void);
+
+				static bool Enabled(void)
+				{
+					return (profilerEnabled);
+				}
+
+				static void SetEnabled(bool enabled)
+				{
+					profilerEnabled = enabled;
+				}
+
+				static unsigned_int32 GetMaxFrameTime(void)
+				{
+					return (maxFrameTime);
+				}
+
+				static unsigned_int32 GetSpikeThreshold(void)
+				{
+					return (spikeThreshold);
+				}
+
+				static void SetSpikeThreshold(unsigned_int32 threshold)
+				{
+					spikeThreshold = threshold;
+				}
+
+				static int32 GetSpikeCount(void)
+				{
+					return (spikeCount);
+				}
+
+				static int32 GetTimelineCount(void)
+				{
+					return (timelineCount);
+				}
+
+				static const ProfileTimeline *GetTimeline(int32 index)
+				{
+					return (timelineTable[index]);
+				}
+
+				C4API static void RegisterThread(const char *name);
+
+				C4API static bool BeginScope(const char *name);
+				C4API static void EndScope(void);
+
+				C4API static void NewFrame(void);
+				C4API static void FinishSpikeExport(void);
+
+				C4API static bool ExportTrace(const char *path);
+		};
+
+
+		// A ProfileScope object records a scope that begins when the object is constructed
+		// and ends when the object is destroyed. The name must be a string literal or otherwise
+		// remain valid until the timelines have been exported. The scope is only ended if it was
+		// actually begun, so enabling or disabling the profiler while it is open has no effect.
+
+		class ProfileScope
+		{
+			private:
+
+				bool		scopeFlag;
+
+			public:
+
+				ProfileScope(const char *name)
+				{
+					scopeFlag = Profiler::BeginScope(name);
+				}
+
+				~ProfileScope()
+				{
+					if (scopeFlag)
+					{
+						Profiler::EndScope();
+					}
+				}
+		};
+	}
+
+#endif
+
+
+#endif
+
+// ZYUQURM
@@ -1,6 +1,7 @@
  
 
 #include "C4Programs.h"
+#include "C4ShaderCache.h"
 #include "C4Graphics.h"
 
 #if C4DEBUG
@@ -13,9 +14,9 @@
 using namespace C4;
 
 
-Storage<HashTable<ProgramBinary>> ProgramBinary::hashTable;
+Storage<FlatHashTable<ProgramBinary>> ProgramBinary::hashTable;
 
-Storage<HashTable<ShaderProgram>> ShaderProgram::hashTable;
+Storage<FlatHashTable<ShaderProgram>> ShaderProgram::hashTable;
 
 #if C4CONSOLE //[ CONSOLE
 
@@ -80,17 +81,17 @@ bool ProgramSignature::operator ==(const ProgramSignature& x) const
 }
 
 
-ProgramBinary::ProgramBinary(const ProgramStageTable& table, unsigned_int32 format, const void *data, unsigned_int32 size)
+ProgramBinary::ProgramBinary(const ProgramSignature& signature, unsigned_int32 format, const void *data, unsigned_int32 size)
 {
 	binaryFormat = format;
 	binarySize = size;
 
-	ShaderSignature vertexSignature = table.vertexShader->GetKey();
+	const ShaderSignature& vertexSignature = signature.GetVertexSignature();
 	unsigned_int32 vertexSignatureSize = vertexSignature[0] + 1;
 	unsigned_int32 *vertexSignatureData = reinterpret_cast<unsigned_int32 *>(this + 1);
 	MemoryMgr::CopyMemory(&vertexSignature[0], vertexSignatureData, vertexSignatureSize * 4);
 
-	ShaderSignature fragmentSignature = table.fragmentShader->GetKey();
+	const ShaderSignature& fragmentSignature = signature.GetFragmentSignature();
 	unsigned_int32 fragmentSignatureSize = fragmentSignature[0] + 1;
 	unsigned_int32 *fragmentSignatureData = vertexSignatureData + vertexSignatureSize;
 	MemoryMgr::CopyMemory(&fragmentSignature[0], fragmentSignatureData, fragmentSignatureSize * 4);
@@ -98,20 +99,19 @@ ProgramBinary::ProgramBinary(const ProgramStageTable& table, unsigned_int32 form
 	unsigned_int32 geometrySignatureSize = 0;
 	unsigned_int32 *geometrySignatureData = nullptr;
 
-	const GeometryShader *geometryShader = table.geometryShader;
-	if (geometryShader)
-	{ 
-		ShaderSignature geometrySignature = geometryShader->GetKey();
+	const ShaderSignature& geometrySignature = signature.GetGeometrySignature();
+	if (geometrySignature)
+	{
 		geometrySignatureSize = geometrySignature[0] + 1;
-		geometrySignatureData = fragmentSignatureData + fragmentSignatureSize; 
+		geometrySignatureData = fragmentSignatureData + fragmentSignatureSize;
 		MemoryMgr::CopyMemory(&geometrySignature[0], geometrySignatureData, geometrySignatureSize * 4);
-	} 
+	}
 
 	signatureSize = (vertexSignatureSize + fragmentSignatureSize + geometrySignatureSize) * 4;
-	new(programSignature) ProgramSignature(vertexSignatureData, fragmentSignatureData, geometrySignatureData); 
+	new(programSignature) ProgramSignature(vertexSignatureData, fragmentSignatureData, geometrySignatureData);
 
-	MemoryMgr::CopyMemory(data, reinterpret_cast<char *>(this + 1) + signatureSize, size); 
-} 
+	MemoryMgr::CopyMemory(data, reinterpret_cast<char *>(this + 1) + signatureSize, size);
+}
 
 ProgramBinary::~ProgramBinary()
 {
@@ -119,12 +119,12 @@ ProgramBinary::~ProgramBinary()
 
 void ProgramBinary::Initialize(void)
 {
-	new(hashTable) HashTable<ProgramBinary>(16, 16);
+	new(hashTable) FlatHashTable<ProgramBinary>(256);
 }
 
 void ProgramBinary::Terminate(void)
 {
-	hashTable->~HashTable();
+	hashTable->~FlatHashTable();
 }
 
 unsigned_int32 ProgramBinary::Hash(const KeyType& key)
@@ -168,18 +168,18 @@ unsigned_int32 ProgramBinary::Hash(const KeyType& key)
 	return (hash);
 }
 
-ProgramBinary *ProgramBinary::New(const ProgramStageTable& table, unsigned_int32 binaryFormat, const void *binaryData, unsigned_int32 binarySize)
+ProgramBinary *ProgramBinary::New(const ProgramSignature& signature, unsigned_int32 binaryFormat, const void *binaryData, unsigned_int32 binarySize)
 {
-	unsigned_int32 signatureSize = table.vertexShader->GetKey()[0] + table.fragmentShader->GetKey()[0] + 2;
+	unsigned_int32 signatureSize = signature.GetVertexSignature()[0] + signature.GetFragmentSignature()[0] + 2;
 
-	const GeometryShader *geometryShader = table.geometryShader;
-	if (geometryShader)
+	const ShaderSignature& geometrySignature = signature.GetGeometrySignature();
+	if (geometrySignature)
 	{
-		signatureSize += geometryShader->GetKey()[0] + 1;
+		signatureSize += geometrySignature[0] + 1;
 	}
 
 	ProgramBinary *binary = MemoryMgr::GetMainHeap()->New<ProgramBinary>(sizeof(ProgramBinary) + signatureSize * 4 + binarySize);
-	new(binary) ProgramBinary(table, binaryFormat, binaryData, binarySize);
+	new(binary) ProgramBinary(signature, binaryFormat, binaryData, binarySize);
 	hashTable->Insert(binary);
 	return (binary);
 }
@@ -225,6 +225,7 @@ ShaderProgram::ShaderProgram(const ProgramStageTable& table)
 				// The binary was rejected by the driver, so delete it from the cache.
 
 				delete programBinary;
+				ShaderCache::SetModified();
 			}
 
 			glProgramParameteri(GetProgramIdentifier(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, true);
@@ -270,6 +271,7 @@ ShaderProgram::ShaderProgram(const ProgramStageTable& table)
 			glGetProgramBinary(identifier, binarySize, nullptr, &format, binaryData);
 
 			ProgramBinary::New(table, format, binaryData, binarySize);
+			ShaderCache::SetModified();
 
 			delete[] binaryData;
 		}
@@ -296,12 +298,12 @@ void ShaderProgram::Initialize(void)
 	GeometryShader::Initialize();
 	ProgramBinary::Initialize();
 
-	new(hashTable) HashTable<ShaderProgram>(16, 16);
+	new(hashTable) FlatHashTable<ShaderProgram>(256);
 }
 
 void ShaderProgram::Terminate(void)
 {
-	hashTable->~HashTable();
+	hashTable->~FlatHashTable();
 
 	ProgramBinary::Terminate();
 	GeometryShader::Terminate();
@@ -311,10 +313,13 @@ void ShaderProgram::Terminate(void)
 
 unsigned_int32 ShaderProgram::Hash(const KeyType& key)
 {
-	machine_address address = GetPointerAddress(key.vertexShader);
-	address |= GetPointerAddress(key.fragmentShader);
-	address |= GetPointerAddress(key.geometryShader);
-	return ((unsigned_int32) (address >> 4));
+	// The stage pointers are combined so that programs sharing a vertex or fragment shader
+	// still have distinct hash values, which the flat hash table needs to keep probes short.
+
+	unsigned_int32 hash = (unsigned_int32) (GetPointerAddress(key.vertexShader) >> 4);
+	hash = hash * 0x6B84DF47 + (unsigned_int32) (GetPointerAddress(key.fragmentShader) >> 4);
+	hash = hash * 0x6B84DF47 + (unsigned_int32) (GetPointerAddress(key.geometryShader) >> 4);
+	return (hash);
 }
 
 ShaderProgram *ShaderProgram::Get(const ProgramStageTable& table)
@@ -332,20 +337,13 @@ ShaderProgram *ShaderProgram::Get(const ProgramStageTable& table)
 
 void ShaderProgram::ReleaseCache(void)
 {
-	int32 bucketCount = hashTable->GetBucketCount();
-	for (machine a = 0; a < bucketCount; a++)
+	int32 slotCount = hashTable->GetSlotCount();
+	for (machine a = 0; a < slotCount; a++)
 	{
-		ShaderProgram *program = hashTable->GetFirstBucketElement(a);
-		while (program)
+		ShaderProgram *program = hashTable->GetSlotElement(a);
+		if ((program) && (program->GetReferenceCount() == 1))
 		{
-			ShaderProgram *next = program->Next();
-
-			if (program->GetReferenceCount() == 1)
-			{
-				program->Release();
-			}
-
-			program = next;
+			program->Release();
 		}
 	}
 
@@ -189,15 +189,17 @@ namespace C4
 	};
 
 
-	class ProgramBinary : public HashTableElement<ProgramBinary>
+	class ProgramBinary : public FlatHashTableElement<ProgramBinary>
 	{
+		friend class ShaderCache;
+
 		public:
 
 			typedef ProgramSignature KeyType;
 
 		private:
 
-			static Storage<HashTable<ProgramBinary>>	hashTable;
+			static Storage<FlatHashTable<ProgramBinary>>	hashTable;
 
 			unsigned_int32				binaryFormat;
 			unsigned_int32				binarySize;
@@ -205,7 +207,7 @@ namespace C4
 			unsigned_int32				signatureSize;
 			Storage<ProgramSignature>	programSignature;
 
-			ProgramBinary(const ProgramStageTable& table, unsigned_int32 format, const void *data, unsigned_int32 size);
+			ProgramBinary(const ProgramSignature& signature, unsigned_int32 format, const void *data, unsigned_int32 size);
 
 		public:
 
@@ -241,11 +243,16 @@ namespace C4
 
 			static unsigned_int32 Hash(const KeyType& key);
 
-			static ProgramBinary *New(const ProgramStageTable& table, unsigned_int32 binaryFormat, const void *binaryData, unsigned_int32 binarySize);
+			static ProgramBinary *New(const ProgramSignature& signature, unsigned_int32 binaryFormat, const void *binaryData, unsigned_int32 binarySize);
+
+			static ProgramBinary *New(const ProgramStageTable& table, unsigned_int32 binaryFormat, const void *binaryData, unsigned_int32 binarySize)
+			{
+				return (New(ProgramSignature(table), binaryFormat, binaryData, binarySize));
+			}
 	};
 
 
-	class ShaderProgram : public Render::ShaderProgramObject, public Shared, public HashTableElement<ShaderProgram>, public LinkTarget<ShaderProgram>
+	class ShaderProgram : public Render::ShaderProgramObject, public Shared, public FlatHashTableElement<ShaderProgram>, public LinkTarget<ShaderProgram>
 	{
 		public:
 
@@ -253,7 +260,7 @@ namespace C4
 
 		private:
 
-			static Storage<HashTable<ShaderProgram>>	hashTable;
+			static Storage<FlatHashTable<ShaderProgram>>	hashTable;
 
 			#if C4CONSOLE //[ CONSOLE
 
@@ -55,7 +55,7 @@ VertexBuffer::~VertexBuffer()
 
 void VertexBuffer::Activate(const void *data)
 {
-	if (!activeFlag)
+	if ((!activeFlag) && (!TheGraphicsMgr->NullDevice()))
 	{
 		activeFlag = true;
 		GraphicsMgr::SyncRenderTask(&VertexBufferObject::AllocateStorage, static_cast<VertexBufferObject *>(this), data);
@@ -151,6 +151,15 @@ volatile void *VertexBuffer::BeginUpdateSync(void)
 {
 	volatile void	*ptr;
 
+	if (TheGraphicsMgr->NullDevice())
+	{
+		// Without a rendering context, the caller writes into system memory that is never uploaded.
+
+		delete[] bufferStorage;
+		bufferStorage = new char[GetVertexBufferSize()];
+		return (bufferStorage);
+	}
+
 	volatile void **storage = &ptr;
 	GraphicsMgr::SyncRenderTask(&VertexBufferObject::BeginUpdateSync, static_cast<VertexBufferObject *>(this), &storage);
 	return (ptr);
@@ -377,6 +386,7 @@ ShaderData::ShaderData(const ShaderKey& key, ShaderData **pointer, unsigned_int3
 	materialState = material;
 
 	shaderProgram = nullptr;
+	streamedTextureCount = 0;
 	shaderStateDataCount = 0;
 }
 
@@ -415,12 +425,64 @@ void ShaderData::AddStateProc(ShaderStateProc *proc, const void *cookie)
 	shaderStateDataCount = count + 1;
 }
 
+void ShaderData::AddStreamedTexture(Texture *texture)
+{
+	int32 count = streamedTextureCount;
+	for (machine a = 0; a < count; a++)
+	{
+		if (streamedTexture[a] == texture)
+		{
+			return;
+		}
+	}
+
+	if (count < kMaxShaderTextureCount)
+	{
+		streamedTexture[count] = texture;
+		streamedTextureCount = count + 1;
+	}
+}
+
 void ShaderData::Preprocess(void)
 {
 	textureArray.Preprocess();
 }
 
 
+PreparedShader::PreparedShader(const Renderable *renderable, const RenderSegment *segment, ShaderType type, const ShaderKey& key) : shaderKey(key)
+{
+	shaderType = type;
+	shaderDataRoot = nullptr;
+
+	shaderStateFlags = 0;
+	signatureStorage = nullptr;
+
+	new ShaderData(key, &shaderDataRoot, segment->GetShaderDataBlendState(renderable, type), segment->GetShaderDataMaterialState(type));
+}
+
+PreparedShader::~PreparedShader()
+{
+	delete shaderDataRoot;
+	delete[] signatureStorage;
+}
+
+void PreparedShader::SetLinkData(const unsigned_int32 *vertexSignature, const unsigned_int32 *fragmentSignature, unsigned_int32 flags)
+{
+	shaderStateFlags = flags;
+
+	// The vertex signature is stored first, and the fragment signature immediately follows it.
+
+	unsigned_int32 vertexSize = vertexSignature[0] + 1;
+	unsigned_int32 fragmentSize = fragmentSignature[0] + 1;
+
+	delete[] signatureStorage;
+	signatureStorage = new unsigned_int32[vertexSize + fragmentSize];
+
+	MemoryMgr::CopyMemory(vertexSignature, signatureStorage, vertexSize * 4);
+	MemoryMgr::CopyMemory(fragmentSignature, signatureStorage + vertexSize, fragmentSize * 4);
+}
+
+
 RenderSegment::RenderSegment(Renderable *renderable, unsigned_int32 state)
 {
 	nextSegment = nullptr;
@@ -450,7 +512,7 @@ RenderSegment::~RenderSegment()
 	}
 }
 
-unsigned_int32 RenderSegment::GetShaderDataMaterialState(ShaderType type)
+unsigned_int32 RenderSegment::GetShaderDataMaterialState(ShaderType type) const
 {
 	unsigned_int32 state = materialState;
 	if (materialObject)
@@ -486,9 +548,94 @@ unsigned_int32 RenderSegment::GetShaderDataMaterialState(ShaderType type)
 	return (state);
 }
 
+unsigned_int32 RenderSegment::GetShaderDataBlendState(const Renderable *renderable, ShaderType type) const
+{
+	// This matches the shader data initialization function that InitShaderData() selects for the type.
+
+	if (type <= kShaderLastUnified)
+	{
+		if ((type <= kShaderLastAmbient) && (renderable->GetShaderFlags() & kShaderAmbientEffect))
+		{
+			return ((renderable->GetAmbientBlendState() & kBlendColorMask) | kBlendAlphaPreserve);
+		}
+
+		return (renderable->GetAmbientBlendState());
+	}
+	else if (type <= kShaderLastLight)
+	{
+		return ((renderable->GetLightBlendState() & kBlendColorMask) | kBlendAlphaPreserve);
+	}
+
+	return (kBlendReplace);
+}
+
+ShaderData *RenderSegment::LinkPreparedShader(Renderable *renderable, ShaderType type, const ShaderKey& key)
+{
+	PreparedShader *preparedShader = preparedShaderList.First();
+	while (preparedShader)
+	{
+		if ((preparedShader->shaderType == type) && (preparedShader->shaderKey == key))
+		{
+			ShaderData *shaderData = preparedShader->shaderDataRoot;
+			const unsigned_int32 *signature = preparedShader->signatureStorage;
+			if ((shaderData) && (signature))
+			{
+				ShaderAttribute::LinkData	linkData;
+
+				unsigned_int32 vertexSize = signature[0] + 1;
+				unsigned_int32 fragmentSize = signature[vertexSize] + 1;
+
+				linkData.shaderStateFlags = preparedShader->shaderStateFlags;
+				linkData.fragmentShader = nullptr;
+				linkData.vertexShader = nullptr;
+				MemoryMgr::CopyMemory(signature, linkData.vertexSignature, vertexSize * 4);
+				MemoryMgr::CopyMemory(signature + vertexSize, linkData.fragmentSignature, fragmentSize * 4);
+
+				// If the source code for either stage has been removed from the shader cache
+				// since the shader was prepared, then it is compiled from its graph as usual.
+
+				if (ShaderAttribute::LinkShader(type, key, renderable, this, shaderData, &linkData))
+				{
+					preparedShader->shaderDataRoot = nullptr;
+
+					ShaderData *next = segmentShaderData[type];
+					segmentShaderData[type] = shaderData;
+					shaderData->shaderDataPointer = &segmentShaderData[type];
+
+					shaderData->nextShaderData = next;
+					if (next)
+					{
+						next->shaderDataPointer = &shaderData->nextShaderData;
+					}
+
+					delete preparedShader;
+					return (shaderData);
+				}
+			}
+
+			delete preparedShader;
+			break;
+		}
+
+		preparedShader = preparedShader->Next();
+	}
+
+	return (nullptr);
+}
+
+void RenderSegment::ActivateEffectQuery(Renderable *renderable, ShaderData *shaderData)
+{
+	OcclusionQuery *occlusionQuery = renderable->GetOcclusionQuery();
+	if (occlusionQuery)
+	{
+		occlusionQuery->Activate();
+		shaderData->AddStateProc(&Renderable::StateProc_SetOcclusionQuery);
+	}
+}
+
 ShaderData *RenderSegment::InitAmbientShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key)
 {
-	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], renderable->GetAmbientBlendState(), GetShaderDataMaterialState(type));
+	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], GetShaderDataBlendState(renderable, type), GetShaderDataMaterialState(type));
 
 	const Attribute *primaryAttribute = (materialAttributeList) ? materialAttributeList->First() : nullptr;
 	const MaterialObject *object = (materialObject) ? *materialObject : nullptr;
@@ -519,8 +666,7 @@ ShaderData *RenderSegment::InitAmbientShaderData(Renderable *renderable, ShaderT
 
 ShaderData *RenderSegment::InitLightShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key)
 {
-	unsigned_int32 blendState = (renderable->GetLightBlendState() & kBlendColorMask) | kBlendAlphaPreserve;
-	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], blendState, GetShaderDataMaterialState(type));
+	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], GetShaderDataBlendState(renderable, type), GetShaderDataMaterialState(type));
 
 	const Attribute *primaryAttribute = (materialAttributeList) ? materialAttributeList->First() : nullptr;
 	const MaterialObject *object = (materialObject) ? *materialObject : nullptr;
@@ -551,8 +697,7 @@ ShaderData *RenderSegment::InitLightShaderData(Renderable *renderable, ShaderTyp
 
 ShaderData *RenderSegment::InitEffectShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key)
 {
-	unsigned_int32 blendState = (renderable->GetAmbientBlendState() & kBlendColorMask) | kBlendAlphaPreserve;
-	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], blendState, GetShaderDataMaterialState(type));
+	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], GetShaderDataBlendState(renderable, type), GetShaderDataMaterialState(type));
 
 	const Attribute *primaryAttribute = (materialAttributeList) ? materialAttributeList->First() : nullptr;
 	const MaterialObject *object = (materialObject) ? *materialObject : nullptr;
@@ -577,19 +722,13 @@ ShaderData *RenderSegment::InitEffectShaderData(Renderable *renderable, ShaderTy
 		static_cast<const ShaderAttribute *>(primaryAttribute)->CompileShader(type, key, renderable, this, shaderData);
 	}
 
-	OcclusionQuery *occlusionQuery = renderable->GetOcclusionQuery();
-	if (occlusionQuery)
-	{
-		occlusionQuery->Activate();
-		shaderData->AddStateProc(&Renderable::StateProc_SetOcclusionQuery);
-	}
-
+	ActivateEffectQuery(renderable, shaderData);
 	return (shaderData);
 }
 
 ShaderData *RenderSegment::InitPlainShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key)
 {
-	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], kBlendReplace, GetShaderDataMaterialState(type));
+	ShaderData *shaderData = new ShaderData(key, &segmentShaderData[type], GetShaderDataBlendState(renderable, type), GetShaderDataMaterialState(type));
 
 	const Attribute *primaryAttribute = (materialAttributeList) ? materialAttributeList->First() : nullptr;
 	const MaterialObject *object = (materialObject) ? *materialObject : nullptr;
@@ -619,6 +758,23 @@ ShaderData *RenderSegment::InitPlainShaderData(Renderable *renderable, ShaderTyp
 
 ShaderData *RenderSegment::InitShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key)
 {
+	// If the permutation was prepared ahead of time, then only the program needs to be linked,
+	// and the shader graph is never built.
+
+	if (!preparedShaderList.Empty())
+	{
+		ShaderData *shaderData = LinkPreparedShader(renderable, type, key);
+		if (shaderData)
+		{
+			if ((type <= kShaderLastAmbient) && (renderable->GetShaderFlags() & kShaderAmbientEffect))
+			{
+				ActivateEffectQuery(renderable, shaderData);
+			}
+
+			return (shaderData);
+		}
+	}
+
 	if (type <= kShaderLastUnified)
 	{
 		if ((type <= kShaderLastAmbient) && (renderable->GetShaderFlags() & kShaderAmbientEffect))
@@ -636,6 +792,74 @@ ShaderData *RenderSegment::InitShaderData(Renderable *renderable, ShaderType typ
 	return (InitPlainShaderData(renderable, type, key));
 }
 
+void RenderSegment::BuildShaderGraph(const Renderable *renderable, ShaderType type, ShaderGraph *graph) const
+{
+	const Attribute *primaryAttribute = (materialAttributeList) ? materialAttributeList->First() : nullptr;
+	const MaterialObject *object = (materialObject) ? *materialObject : nullptr;
+	if (object)
+	{
+		const Attribute *attribute = object->GetFirstAttribute();
+		if (attribute)
+		{
+			primaryAttribute = attribute;
+		}
+	}
+
+	if ((primaryAttribute) && (primaryAttribute->GetAttributeType() == kAttributeShader))
+	{
+		ShaderAttribute::CloneShader(static_cast<const ShaderAttribute *>(primaryAttribute)->GetShaderGraph(), graph, true);
+	}
+	else if (type <= kShaderLastLight)
+	{
+		if ((type <= kShaderLastAmbient) && (renderable->GetShaderFlags() & kShaderAmbientEffect))
+		{
+			ShaderAttribute::BuildEffectShaderGraph(renderable, this, object, materialAttributeList, graph);
+		}
+		else
+		{
+			Process		*process[kShaderGraphProcessCount];
+
+			ShaderAttribute::BuildRegularShaderGraph(renderable, this, object, materialAttributeList, graph, process);
+		}
+	}
+	else
+	{
+		ShaderAttribute::BuildPlainShaderGraph(type, renderable, this, object, materialAttributeList, graph);
+	}
+}
+
+EngineResult RenderSegment::GenerateShaderSource(const Renderable *renderable, ShaderType type, const ShaderKey& key)
+{
+	ShaderGraph						shaderGraph;
+	ShaderAttribute::LinkData		linkData;
+
+	// If the segment already has shader data for the key, then the shader was compiled
+	// at run time, and its source code is already in the shader cache. Otherwise, the
+	// prepared shader data is kept so that the program can later be linked without
+	// processing the shader graph again.
+
+	if (ShaderDataExists(type, key))
+	{
+		return (kShaderOkay);
+	}
+
+	PreparedShader *preparedShader = new PreparedShader(renderable, this, type, key);
+
+	BuildShaderGraph(renderable, type, &shaderGraph);
+	ShaderResult result = ShaderAttribute::PrepareShader(&shaderGraph, type, key, renderable, this, preparedShader->GetShaderData(), &linkData, false);
+	if (result == kShaderOkay)
+	{
+		preparedShader->SetLinkData(linkData.vertexSignature, linkData.fragmentSignature, linkData.shaderStateFlags);
+		preparedShaderList.Append(preparedShader);
+	}
+	else
+	{
+		delete preparedShader;
+	}
+
+	return (result);
+}
+
 ShaderData *RenderSegment::GetShaderData(ShaderType type, const ShaderKey& key)
 {
 	ShaderData *firstShaderData = segmentShaderData[type];
@@ -677,6 +901,22 @@ ShaderData *RenderSegment::GetShaderData(ShaderType type, const ShaderKey& key)
 	return (nullptr);
 }
 
+bool RenderSegment::ShaderDataExists(ShaderType type, const ShaderKey& key) const
+{
+	const ShaderData *shaderData = segmentShaderData[type];
+	while (shaderData)
+	{
+		if (shaderData->shaderKey == key)
+		{
+			return (true);
+		}
+
+		shaderData = shaderData->nextShaderData;
+	}
+
+	return (false);
+}
+
 void RenderSegment::InvalidateVertexData(void)
 {
 	for (machine type = 0; type < kShaderTypeCount; type++)
@@ -688,6 +928,18 @@ void RenderSegment::InvalidateVertexData(void)
 			shaderData = shaderData->nextShaderData;
 		}
 	}
+
+	const PreparedShader *preparedShader = preparedShaderList.First();
+	while (preparedShader)
+	{
+		ShaderData *shaderData = preparedShader->shaderDataRoot;
+		if (shaderData)
+		{
+			shaderData->vertexData.Invalidate();
+		}
+
+		preparedShader = preparedShader->Next();
+	}
 }
 
 void RenderSegment::InvalidateShaderData(void)
@@ -702,6 +954,8 @@ void RenderSegment::InvalidateShaderData(void)
 			shaderData = next;
 		}
 	}
+
+	preparedShaderList.Purge();
 }
 
 void RenderSegment::InvalidateAmbientShaderData(void)
@@ -716,6 +970,19 @@ void RenderSegment::InvalidateAmbientShaderData(void)
 			shaderData = next;
 		}
 	}
+
+	PreparedShader *preparedShader = preparedShaderList.First();
+	while (preparedShader)
+	{
+		PreparedShader *next = preparedShader->Next();
+
+		if (preparedShader->shaderType <= kShaderLastUnified)
+		{
+			delete preparedShader;
+		}
+
+		preparedShader = next;
+	}
 }
 
 
@@ -761,6 +1028,7 @@ Renderable::Renderable(RenderType type, unsigned_int32 state) : renderSegment(th
 
 	shaderDetailLevel = 0;
 	shaderDetailParameter = 1.0F;
+	textureDetailSize = K::infinity;
 }
 
 Renderable::~Renderable()
@@ -261,7 +261,10 @@ namespace C4
 
 	class Box3D;
 	class Renderable;
+	class RenderSegment;
 	class RadiositySpaceObject;
+	class Process;
+	class Route;
 
 
 	inline unsigned_int32 BlendState(BlendFactor sc, BlendFactor dc, BlendFactor sa = kBlendZero, BlendFactor da = kBlendZero)
@@ -873,6 +876,9 @@ namespace C4
 
 			TextureArray				textureArray;
 
+			int32						streamedTextureCount;
+			Texture						*streamedTexture[kMaxShaderTextureCount];
+
 			int32						shaderStateDataCount;
 			ShaderStateData				shaderStateData[kMaxShaderStateDataCount];
 
@@ -891,11 +897,55 @@ namespace C4
 			}
 
 			void AddStateProc(ShaderStateProc *proc, const void *cookie = nullptr);
+			void AddStreamedTexture(Texture *texture);
 
 			void Preprocess(void);
 	};
 
 
+	// A PreparedShader holds the shader data for one permutation of a render segment whose shader graph
+	// has already been processed, together with the signatures needed to link its program. When the
+	// segment first needs shader data for the permutation, the program is linked from the shader cache
+	// without building the shader graph again.
+
+	class PreparedShader : public ListElement<PreparedShader>, public Memory<PreparedShader>
+	{
+		friend class RenderSegment;
+
+		private:
+
+			ShaderType				shaderType;
+			ShaderKey				shaderKey;
+
+			ShaderData				*shaderDataRoot;
+
+			unsigned_int32			shaderStateFlags;
+			unsigned_int32			*signatureStorage;
+
+		public:
+
+			PreparedShader(const Renderable *renderable, const RenderSegment *segment, ShaderType type, const ShaderKey& key);
+			~PreparedShader();
+
+			ShaderType GetShaderType(void) const
+			{
+				return (shaderType);
+			}
+
+			const ShaderKey& GetShaderKey(void) const
+			{
+				return (shaderKey);
+			}
+
+			ShaderData *GetShaderData(void) const
+			{
+				return (shaderDataRoot);
+			}
+
+			void SetLinkData(const unsigned_int32 *vertexSignature, const unsigned_int32 *fragmentSignature, unsigned_int32 flags);
+	};
+
+
 	//# \class	RenderSegment		Stores rendering information for one segment of a renderable object.
 	//
 	//# The $RenderSegment$ class stores rendering information for one segment of a renderable object.
@@ -1106,8 +1156,10 @@ namespace C4
 			};
 
 			ShaderData				*segmentShaderData[kShaderTypeCount];
+			List<PreparedShader>	preparedShaderList;
 
-			unsigned_int32 GetShaderDataMaterialState(ShaderType type);
+			ShaderData *LinkPreparedShader(Renderable *renderable, ShaderType type, const ShaderKey& key);
+			static void ActivateEffectQuery(Renderable *renderable, ShaderData *shaderData);
 
 			ShaderData *InitAmbientShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key);
 			ShaderData *InitLightShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key);
@@ -1223,6 +1275,18 @@ namespace C4
 
 			ShaderData *InitShaderData(Renderable *renderable, ShaderType type, const ShaderKey& key);
 			ShaderData *GetShaderData(ShaderType type, const ShaderKey& key);
+			bool ShaderDataExists(ShaderType type, const ShaderKey& key) const;
+
+			unsigned_int32 GetShaderDataMaterialState(ShaderType type) const;
+			unsigned_int32 GetShaderDataBlendState(const Renderable *renderable, ShaderType type) const;
+
+			void BuildShaderGraph(const Renderable *renderable, ShaderType type, Graph<Process, Route> *graph) const;
+			C4API EngineResult GenerateShaderSource(const Renderable *renderable, ShaderType type, const ShaderKey& key);
+
+			void AddPreparedShader(PreparedShader *preparedShader)
+			{
+				preparedShaderList.Append(preparedShader);
+			}
 
 			C4API void InvalidateVertexData(void);
 			C4API void InvalidateShaderData(void);
@@ -1814,6 +1878,7 @@ namespace C4
 
 			int32						shaderDetailLevel;
 			float						shaderDetailParameter;
+			float						textureDetailSize;
 
 			RenderSegment				renderSegment;
 
@@ -2225,6 +2290,16 @@ namespace C4
 				shaderDetailParameter = parameter;
 			}
 
+			float GetTextureDetailSize(void) const
+			{
+				return (textureDetailSize);
+			}
+
+			void SetTextureDetailSize(float size)
+			{
+				textureDetailSize = size;
+			}
+
 			int32 GetPrimitiveCount(void) const
 			{
 				return (renderSegment.GetPrimitiveCount());
@@ -275,6 +275,12 @@ ResourceBase::ResourceBase(const char *name, ResourceCatalog *catalog)
 
 	resourceCatalog = catalog;
 	resourceTracker = nullptr;
+
+	loadTime = 0;
+	useCount = 0;
+	cachePriority = 0.0F;
+	cacheStamp = 0;
+	cacheHeapIndex = -1;
 }
 
 ResourceBase::~ResourceBase()
@@ -368,16 +374,40 @@ void ResourceBase::Preprocess(void)
 }
 
 
-ResourceTracker::ResourceTracker(const ResourceDescriptor *descriptor) : resourceHashTable(16, 4)
+ResourceCacheStatistics::ResourceCacheStatistics(ResourceType type)
+{
+	resourceType = type;
+
+	hitCount = 0;
+	missCount = 0;
+	evictionCount = 0;
+	cachedCount = 0;
+
+	cachedBytes = 0;
+	evictedBytes = 0;
+}
+
+
+ResourceTracker::ResourceTracker(const ResourceDescriptor *descriptor) : resourceHashTable(64)
 {
 	resourceType = descriptor->GetType();
 
-	maxCacheSize = descriptor->GetCacheSize();
-	currentCacheSize = 0;
+	maxCachedSize = descriptor->GetCacheSize() / 4;
+	cacheStatistics = TheResourceMgr->GetResourceCache()->GetStatistics(resourceType);
 }
 
 ResourceTracker::~ResourceTracker()
 {
+	// Cached resources still point to this tracker, so they are released before
+	// the hash table is destroyed. Otherwise, the cache would later evict them
+	// through a dangling tracker pointer.
+
+	Mutex *mutex = TheResourceMgr->GetTrackerMutex();
+	mutex->Acquire();
+
+	TheResourceMgr->GetResourceCache()->ReleaseResources(this);
+
+	mutex->Release();
 }
 
 void ResourceTracker::AddResource(ResourceBase *resource)
@@ -392,8 +422,7 @@ int32 ResourceTracker::RetainResource(ResourceBase *resource)
 	int32 count = resource->Retain();
 	if (count == 2)
 	{
-		currentCacheSize = MaxZero(currentCacheSize - resource->GetSize());
-		cacheList.Remove(resource);
+		TheResourceMgr->GetResourceCache()->RemoveResource(resource);
 	}
 
 	return (count);
@@ -404,32 +433,252 @@ int32 ResourceTracker::ReleaseResource(ResourceBase *resource)
 	int32 count = resource->Shared::Release();
 	if (count == 1)
 	{
-		unsigned_int32 size = resource->GetSize();
-		if ((size > maxCacheSize / 4) || (!resource->GetData()))
+		// The cache owns the last reference to a resource that it holds. If the resource itself
+		// has the lowest priority in the cache, then it is rejected and the last reference is released here.
+
+		if ((resource->GetSize() > maxCachedSize) || (!resource->GetData()) || (!TheResourceMgr->GetResourceCache()->AddResource(resource)))
 		{
 			resource->Shared::Release();
 			return (0);
 		}
+	}
+
+	return (count);
+}
+
+
+ResourceCache::ResourceCache()
+{
+	cacheBudget = kResourceCacheDefaultBudget;
+	cacheSize = 0;
+	cacheClock = 0.0F;
+	cacheStamp = 0;
+}
+
+ResourceCache::~ResourceCache()
+{
+}
+
+ResourceCacheStatistics *ResourceCache::GetStatistics(ResourceType type)
+{
+	ResourceCacheStatistics *statistics = statisticsMap.Find(type);
+	if (!statistics)
+	{
+		statistics = new ResourceCacheStatistics(type);
+		statisticsMap.Insert(statistics);
+	}
+
+	return (statistics);
+}
+
+void ResourceCache::SetCacheBudget(unsigned_int64 budget)
+{
+	cacheBudget = budget;
+	while (cacheSize > cacheBudget)
+	{
+		EvictResource()->Shared::Release();
+	}
+}
 
-		unsigned_int32 cacheSize = currentCacheSize + size;
-		while (cacheSize > maxCacheSize)
+inline bool ResourceCache::HeapPrecedes(const ResourceBase *first, const ResourceBase *second)
+{
+	// Among resources having the same priority, the one released earliest is evicted first.
+
+	float priority1 = first->cachePriority;
+	float priority2 = second->cachePriority;
+	return ((priority1 < priority2) || ((priority1 == priority2) && (int32 (first->cacheStamp - second->cacheStamp) < 0)));
+}
+
+void ResourceCache::SiftUp(int32 index)
+{
+	ResourceBase *resource = cacheHeap[index];
+	while (index > 0)
+	{
+		int32 parentIndex = (index - 1) >> 1;
+		ResourceBase *parent = cacheHeap[parentIndex];
+		if (!HeapPrecedes(resource, parent))
+		{
+			break;
+		}
+
+		cacheHeap[index] = parent;
+		parent->cacheHeapIndex = index;
+		index = parentIndex;
+	}
+
+	cacheHeap[index] = resource;
+	resource->cacheHeapIndex = index;
+}
+
+void ResourceCache::SiftDown(int32 index)
+{
+	int32 count = cacheHeap.GetElementCount();
+	ResourceBase *resource = cacheHeap[index];
+	for (;;)
+	{
+		int32 childIndex = index * 2 + 1;
+		if (childIndex >= count)
 		{
-			ResourceBase *cachedResource = cacheList.First();
-			if (!cachedResource)
+			break;
+		}
+
+		ResourceBase *child = cacheHeap[childIndex];
+		if (childIndex + 1 < count)
+		{
+			ResourceBase *sibling = cacheHeap[childIndex + 1];
+			if (HeapPrecedes(sibling, child))
 			{
-				cacheSize = 0;
-				break;
+				child = sibling;
+				childIndex++;
 			}
+		}
 
-			cacheSize -= cachedResource->GetSize();
-			cachedResource->Shared::Release();
+		if (!HeapPrecedes(child, resource))
+		{
+			break;
 		}
 
-		currentCacheSize = cacheSize;
-		cacheList.Append(resource);
+		cacheHeap[index] = child;
+		child->cacheHeapIndex = index;
+		index = childIndex;
 	}
 
-	return (count);
+	cacheHeap[index] = resource;
+	resource->cacheHeapIndex = index;
+}
+
+bool ResourceCache::AddResource(ResourceBase *resource)
+{
+	unsigned_int32 size = resource->GetSize();
+	if (size > cacheBudget / 4)
+	{
+		return (false);
+	}
+
+	// The priority follows the greedy dual size frequency policy. Resources that have been requested
+	// often and took a long time to load per kilobyte are kept longest, and the clock is raised to the
+	// priority of each evicted resource so that resources which stop being used eventually age out.
+
+	resource->cachePriority = cacheClock + (float) resource->useCount * (float) Max(resource->loadTime, 1U) / (float) ((size >> 10) + 1);
+
+	ResourceCacheStatistics *statistics = resource->resourceTracker->GetCacheStatistics();
+	statistics->cachedCount++;
+	statistics->cachedBytes += size;
+
+	cacheSize += size;
+
+	resource->cacheStamp = ++cacheStamp;
+	int32 index = cacheHeap.GetElementCount();
+	cacheHeap.AddElement(resource);
+	SiftUp(index);
+
+	bool result = true;
+	while (cacheSize > cacheBudget)
+	{
+		ResourceBase *victim = EvictResource();
+		if (victim != resource)
+		{
+			victim->Shared::Release();
+		}
+		else
+		{
+			// The caller still owns the reference to the resource being added, so it is not released here.
+
+			result = false;
+		}
+	}
+
+	return (result);
+}
+
+void ResourceCache::RemoveResource(ResourceBase *resource)
+{
+	unsigned_int32 size = resource->GetSize();
+
+	ResourceCacheStatistics *statistics = resource->resourceTracker->GetCacheStatistics();
+	statistics->cachedCount--;
+	statistics->cachedBytes -= size;
+
+	cacheSize -= size;
+
+	// The last element in the heap is moved into the vacated slot and then sifted
+	// in whichever direction restores the heap order.
+
+	int32 index = resource->cacheHeapIndex;
+	int32 last = cacheHeap.GetElementCount() - 1;
+	resource->cacheHeapIndex = -1;
+
+	ResourceBase *moved = cacheHeap[last];
+	cacheHeap.SetElementCount(last);
+
+	if (index < last)
+	{
+		cacheHeap[index] = moved;
+		if ((index > 0) && (HeapPrecedes(moved, cacheHeap[(index - 1) >> 1])))
+		{
+			SiftUp(index);
+		}
+		else
+		{
+			SiftDown(index);
+		}
+	}
+}
+
+ResourceBase *ResourceCache::EvictResource(void)
+{
+	// The root of the heap is the resource having the lowest priority. It is removed from the
+	// cache, but the caller is responsible for releasing the cache's reference to it.
+
+	ResourceBase *victim = cacheHeap[0];
+
+	cacheClock = victim->cachePriority;
+	RemoveResource(victim);
+
+	ResourceCacheStatistics *statistics = victim->resourceTracker->GetCacheStatistics();
+	statistics->evictionCount++;
+	statistics->evictedBytes += victim->GetSize();
+
+	return (victim);
+}
+
+void ResourceCache::ReleaseResources(const ResourceTracker *tracker)
+{
+	// The resources that are kept are compacted to the front of the heap array,
+	// and the heap order is then rebuilt from the bottom up.
+
+	int32 count = cacheHeap.GetElementCount();
+	int32 keepCount = 0;
+
+	for (machine a = 0; a < count; a++)
+	{
+		ResourceBase *resource = cacheHeap[a];
+		if ((!tracker) || (resource->resourceTracker == tracker))
+		{
+			unsigned_int32 size = resource->GetSize();
+
+			ResourceCacheStatistics *statistics = resource->resourceTracker->GetCacheStatistics();
+			statistics->cachedCount--;
+			statistics->cachedBytes -= size;
+
+			cacheSize -= size;
+			resource->cacheHeapIndex = -1;
+			resource->Shared::Release();
+		}
+		else
+		{
+			cacheHeap[keepCount] = resource;
+			resource->cacheHeapIndex = keepCount;
+			keepCount++;
+		}
+	}
+
+	cacheHeap.SetElementCount(keepCount);
+
+	for (machine a = (keepCount >> 1) - 1; a >= 0; a--)
+	{
+		SiftDown(a);
+	}
 }
 
 
@@ -932,6 +1181,8 @@ void ResourceMgr::Destruct(void)
 
 	#endif
 
+	resourceCache.ReleaseResources();
+
 	configCatalog->~GenericResourceCatalog();
 	systemCatalog->~GenericResourceCatalog();
 	defaultSaveCatalog->~GenericResourceCatalog();
@@ -943,11 +1194,17 @@ ResourceResult ResourceMgr::LoadResource(ResourceBase *resource, const ResourceD
 {
 	ResourceLoader		loader;
 
+	unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
 	ResourceResult result = resource->OpenLoader(&loader, descriptor, flags, location);
 	if (result == kResourceOkay)
 	{
 		result = resource->Load(&loader);
 		resource->CloseLoader(&loader);
+
+		// The time taken to load the resource is its reload cost when it competes for space in the cache.
+
+		resource->loadTime = (unsigned_int32) Min(TheTimeMgr->GetMicrosecondCount() - time, (unsigned_int64) 0xFFFFFFFF);
 	}
 
 	return (result);
@@ -1029,11 +1286,18 @@ ResourceBase *ResourceMgr::GetResource(const ResourceDescriptor *descriptor, Res
 	trackerMutex.Acquire();
 
 	ResourceTracker *tracker = catalog->GetTracker(descriptor);
+	ResourceCacheStatistics *statistics = tracker->GetCacheStatistics();
+
 	ResourceBase *resource = tracker->FindResource(finalName);
 	if (resource)
 	{
-		if ((!resource->GetData()) && (!(flags & kResourceDeferLoad)))
+		if (resource->GetData())
+		{
+			statistics->hitCount++;
+		}
+		else if (!(flags & kResourceDeferLoad))
 		{
+			statistics->missCount++;
 			if (LoadResource(resource, descriptor, flags, location) != kResourceOkay)
 			{
 				resource = nullptr;
@@ -1041,6 +1305,7 @@ ResourceBase *ResourceMgr::GetResource(const ResourceDescriptor *descriptor, Res
 			}
 		}
 
+		resource->useCount++;
 		tracker->RetainResource(resource);
 	}
 	else
@@ -1080,9 +1345,11 @@ ResourceBase *ResourceMgr::GetResource(const ResourceDescriptor *descriptor, Res
 		#endif
 
 		resource = (*newProc)(finalName, catalog);
+		resource->useCount = 1;
 
 		if (!(flags & kResourceDeferLoad))
 		{
+			statistics->missCount++;
 			if (LoadResource(resource, descriptor, flags, location) != kResourceOkay)
 			{
 				resource->Shared::Release();
@@ -1111,12 +1378,19 @@ void ResourceMgr::ReleaseCache(const ResourceDescriptor *descriptor, ResourceCat
 	ResourceTracker *tracker = catalog->GetTrackerMap()->Find(descriptor->GetType());
 	if (tracker)
 	{
-		tracker->ReleaseCache();
+		resourceCache.ReleaseResources(tracker);
 	}
 
 	trackerMutex.Release();
 }
 
+void ResourceMgr::SetCacheBudget(unsigned_int64 budget)
+{
+	trackerMutex.Acquire();
+	resourceCache.SetCacheBudget(budget);
+	trackerMutex.Release();
+}
+
 FileResult ResourceMgr::CreateDirectoryPath(const char *path)
 {
 	FileResult result = FileMgr::CreateDirectoryPath(path);
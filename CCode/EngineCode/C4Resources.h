@@ -56,6 +56,12 @@ namespace C4
 	};
 
 
+	enum
+	{
+		kResourceCacheDefaultBudget	= 0x04000000
+	};
+
+
 	enum : Type
 	{
 		kPackFileDefault			= 'C4C4'
@@ -64,6 +70,7 @@ namespace C4
 
 	struct PackDirectoryEntry;
 	class ResourceTracker;
+	class ResourceCache;
 	class ResourceLoader;
 	class ResourceCatalog;
 	class Variable;
@@ -273,8 +280,9 @@ namespace C4
 	//
 	//# \table	ResourceFlags
 	//
-	//# If nonzero, the $cacheSize$ parameter specifies the size of the memory cache allocated by the Resource Manager to hold
-	//# recently released resources of the descriptor's type.
+	//# If nonzero, the $cacheSize$ parameter allows recently released resources of the descriptor's type to be held in the
+	//# Resource Manager's global cache, and resources larger than one quarter of this size are never cached. All cached resources
+	//# share the single memory budget set by the $@ResourceMgr::SetCacheBudget@$ function.
 	//#
 	//# If the $defaultName$ parameter is not the empty string, then it specifies a resource to load by default when an attempt
 	//# to load a resource of the descriptor's type fails. (The $defaultName$ parameter cannot be $nullptr$.)
@@ -328,9 +336,11 @@ namespace C4
 	};
 
 
-	class ResourceBase : public HashTableElement<ResourceBase>, public ListElement<ResourceBase>, public Shared
+	class ResourceBase : public FlatHashTableElement<ResourceBase>, public ListElement<ResourceBase>, public Shared
 	{
 		friend class ResourceTracker;
+		friend class ResourceCache;
+		friend class ResourceMgr;
 
 		private:
 
@@ -341,6 +351,12 @@ namespace C4
 			ResourceCatalog		*resourceCatalog;
 			ResourceTracker		*resourceTracker;
 
+			unsigned_int32		loadTime;
+			unsigned_int32		useCount;
+			float				cachePriority;
+			unsigned_int32		cacheStamp;
+			int32				cacheHeapIndex;
+
 			C4API virtual void Preprocess(void);
 
 		protected:
@@ -625,16 +641,98 @@ namespace C4
 	};
 
 
+	//# \class	ResourceCacheStatistics		Contains the resource cache counters for one resource type.
+	//
+	//# \def	class ResourceCacheStatistics : public MapElement<ResourceCacheStatistics>
+	//
+	//# \desc
+	//# The $ResourceCacheStatistics$ class contains counters that describe how the Resource Manager's global cache has been used
+	//# for one type of resource since the engine started. A hit is counted when a requested resource is already in memory, either
+	//# because it is still in use or because it was found in the cache, and a miss is counted when the resource has to be loaded.
+	//# Resources that are removed from the cache to stay within the memory budget are counted as evicted. Resources released by
+	//# the $@ResourceMgr::ReleaseCache@$ function are not counted as evicted.
+	//#
+	//# The statistics for a resource type are returned by the $@ResourceMgr::GetCacheStatistics@$ function.
+	//
+	//# \base	Utilities/MapElement<ResourceCacheStatistics>		Used internally by the Resource Manager.
+	//
+	//# \also	$@ResourceMgr::GetCacheStatistics@$
+
+
+	class ResourceCacheStatistics : public MapElement<ResourceCacheStatistics>
+	{
+		friend class ResourceCache;
+		friend class ResourceMgr;
+
+		private:
+
+			ResourceType		resourceType;
+
+			unsigned_int32		hitCount;
+			unsigned_int32		missCount;
+			unsigned_int32		evictionCount;
+			int32				cachedCount;
+
+			unsigned_int64		cachedBytes;
+			unsigned_int64		evictedBytes;
+
+		public:
+
+			typedef ResourceType KeyType;
+
+			ResourceCacheStatistics(ResourceType type);
+
+			KeyType GetKey(void) const
+			{
+				return (resourceType);
+			}
+
+			ResourceType GetResourceType(void) const
+			{
+				return (resourceType);
+			}
+
+			unsigned_int32 GetHitCount(void) const
+			{
+				return (hitCount);
+			}
+
+			unsigned_int32 GetMissCount(void) const
+			{
+				return (missCount);
+			}
+
+			unsigned_int32 GetEvictionCount(void) const
+			{
+				return (evictionCount);
+			}
+
+			int32 GetCachedCount(void) const
+			{
+				return (cachedCount);
+			}
+
+			unsigned_int64 GetCachedBytes(void) const
+			{
+				return (cachedBytes);
+			}
+
+			unsigned_int64 GetEvictedBytes(void) const
+			{
+				return (evictedBytes);
+			}
+	};
+
+
 	class ResourceTracker : public MapElement<ResourceTracker>
 	{
 		private:
 
 			ResourceType				resourceType;
-			HashTable<ResourceBase>		resourceHashTable;
+			FlatHashTable<ResourceBase>	resourceHashTable;
 
-			unsigned_int32				maxCacheSize;
-			unsigned_int32				currentCacheSize;
-			List<ResourceBase>			cacheList;
+			unsigned_int32				maxCachedSize;
+			ResourceCacheStatistics		*cacheStatistics;
 
 		public:
 
@@ -653,7 +751,7 @@ namespace C4
 				return (resourceType);
 			}
 
-			const HashTable<ResourceBase> *GetHashTable(void) const
+			const FlatHashTable<ResourceBase> *GetHashTable(void) const
 			{
 				return (&resourceHashTable);
 			}
@@ -663,15 +761,9 @@ namespace C4
 				return (resourceHashTable.Find(name));
 			}
 
-			unsigned_int32 GetCurrentCacheSize(void) const
+			ResourceCacheStatistics *GetCacheStatistics(void) const
 			{
-				return (currentCacheSize);
-			}
-
-			void ReleaseCache(void)
-			{
-				currentCacheSize = 0;
-				cacheList.Purge();
+				return (cacheStatistics);
 			}
 
 			void AddResource(ResourceBase *resource);
@@ -680,6 +772,59 @@ namespace C4
 	};
 
 
+	class ResourceCache
+	{
+		private:
+
+			unsigned_int64						cacheBudget;
+			unsigned_int64						cacheSize;
+			float								cacheClock;
+			unsigned_int32						cacheStamp;
+
+			Array<ResourceBase *>				cacheHeap;
+			Map<ResourceCacheStatistics>		statisticsMap;
+
+			static bool HeapPrecedes(const ResourceBase *first, const ResourceBase *second);
+			void SiftUp(int32 index);
+			void SiftDown(int32 index);
+
+			ResourceBase *EvictResource(void);
+
+		public:
+
+			ResourceCache();
+			~ResourceCache();
+
+			unsigned_int64 GetCacheBudget(void) const
+			{
+				return (cacheBudget);
+			}
+
+			unsigned_int64 GetCacheSize(void) const
+			{
+				return (cacheSize);
+			}
+
+			const ResourceCacheStatistics *GetFirstStatistics(void) const
+			{
+				return (statisticsMap.First());
+			}
+
+			const ResourceCacheStatistics *FindStatistics(ResourceType type) const
+			{
+				return (statisticsMap.Find(type));
+			}
+
+			ResourceCacheStatistics *GetStatistics(ResourceType type);
+
+			void SetCacheBudget(unsigned_int64 budget);
+
+			bool AddResource(ResourceBase *resource);
+			void RemoveResource(ResourceBase *resource);
+			void ReleaseResources(const ResourceTracker *tracker = nullptr);
+	};
+
+
 	//# \class	ResourceLoader		Encapsulates functionality for loading resource data.
 	//
 	//# \def	class ResourceLoader
@@ -916,6 +1061,55 @@ namespace C4
 	//# \also	$@ResourceCatalog@$
 
 
+	//# \function	ResourceMgr::SetCacheBudget		Sets the memory budget for cached resources.
+	//
+	//# \proto	void SetCacheBudget(unsigned_int64 budget);
+	//
+	//# \param	budget		The maximum number of bytes used by resources that are held in the cache.
+	//
+	//# \desc
+	//# The $SetCacheBudget$ function sets the total amount of memory that can be used by resources of all types that have been
+	//# released but are kept in memory in case they are requested again. Only resource types whose descriptors specify a nonzero
+	//# cache size are cached. The default budget is given by the $kResourceCacheDefaultBudget$ constant.
+	//#
+	//# When adding a resource to the cache would exceed the budget, resources are evicted in order of priority. The priority of a
+	//# cached resource is the number of times it has been requested multiplied by the time it took to load, divided by its size,
+	//# plus an aging value that increases each time a resource is evicted. Resources that are cheap to reload, large, rarely used,
+	//# or have not been requested for a long time are therefore evicted first. If the new budget is smaller than the memory
+	//# currently used by the cache, then resources are evicted immediately. A single resource larger than one quarter of the
+	//# budget is never cached.
+	//
+	//# \also	$@ResourceMgr::GetCacheBudget@$
+	//# \also	$@ResourceMgr::GetCacheStatistics@$
+	//# \also	$@ResourceMgr::ReleaseCache@$
+
+
+	//# \function	ResourceMgr::GetCacheBudget		Returns the memory budget for cached resources.
+	//
+	//# \proto	unsigned_int64 GetCacheBudget(void) const;
+	//
+	//# \desc
+	//# The $GetCacheBudget$ function returns the total amount of memory that can be used by cached resources.
+	//
+	//# \also	$@ResourceMgr::SetCacheBudget@$
+
+
+	//# \function	ResourceMgr::GetCacheStatistics		Returns the resource cache counters for a resource type.
+	//
+	//# \proto	const ResourceCacheStatistics *GetCacheStatistics(ResourceType type) const;
+	//
+	//# \param	type	The resource type.
+	//
+	//# \desc
+	//# The $GetCacheStatistics$ function returns the cache counters for the resource type specified by the $type$ parameter.
+	//# If no resource of that type has been requested yet, then the return value is $nullptr$. The statistics for all
+	//# resource types can be visited by starting with the object returned by the $GetFirstCacheStatistics$ function and
+	//# calling its $Next$ function.
+	//
+	//# \also	$@ResourceCacheStatistics@$
+	//# \also	$@ResourceMgr::SetCacheBudget@$
+
+
 	class ResourceMgr : public Manager<ResourceMgr>
 	{
 		template <class type> friend class Resource;
@@ -938,6 +1132,8 @@ namespace C4
 			String<kMaxFilePathLength>					systemCatalogPath;
 			String<kMaxFilePathLength>					configCatalogPath;
 
+			ResourceCache								resourceCache;
+
 			#if C4LOG_RESOURCES
 
 				File									resourceLog;
@@ -998,6 +1194,31 @@ namespace C4
 				return (configCatalog);
 			}
 
+			ResourceCache *GetResourceCache(void)
+			{
+				return (&resourceCache);
+			}
+
+			unsigned_int64 GetCacheBudget(void) const
+			{
+				return (resourceCache.GetCacheBudget());
+			}
+
+			unsigned_int64 GetCacheSize(void) const
+			{
+				return (resourceCache.GetCacheSize());
+			}
+
+			const ResourceCacheStatistics *GetFirstCacheStatistics(void) const
+			{
+				return (resourceCache.GetFirstStatistics());
+			}
+
+			const ResourceCacheStatistics *GetCacheStatistics(ResourceType type) const
+			{
+				return (resourceCache.FindStatistics(type));
+			}
+
 			#if C4LOG_RESOURCES
 
 				void IncrementResourceLogLevel(void)
@@ -1013,6 +1234,7 @@ namespace C4
 			#endif
 
 			C4API void ReleaseCache(const ResourceDescriptor *descriptor, ResourceCatalog *catalog = nullptr);
+			C4API void SetCacheBudget(unsigned_int64 budget);
 
 			C4API FileResult CreateDirectoryPath(const char *path);
 	};
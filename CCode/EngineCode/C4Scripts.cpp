@@ -634,23 +634,40 @@ void ScriptState::TriggerLinkProc(Node *node, void *cookie)
 	state->triggerNodeLink = node;
 }
 
+Value *ScriptState::FindValue(const AtomKey& key) const
+{
+	Value *value = valueMap.Find(key);
+	if (value)
+	{
+		return (value);
+	}
+
+	value = scriptController->GetValue(key);
+	if (value)
+	{
+		return (value);
+	}
+
+	return (scriptObject->GetValue(key));
+}
+
 Value *ScriptState::GetValue(const char *name) const
 {
 	if (name[0] != 0)
 	{
-		Value *value = valueMap.Find(name);
-		if (value)
-		{
-			return (value);
-		}
+		// Look up the atom once so that all three maps are searched by identifier.
 
-		value = scriptController->GetValue(name);
-		if (value)
-		{
-			return (value);
-		}
+		return (FindValue(AtomKey(name)));
+	}
 
-		return (scriptObject->GetValue(name));
+	return (nullptr);
+}
+
+Value *ScriptState::GetValue(const TextAtom& atom) const
+{
+	if (atom.GetAtomID() != 0)
+	{
+		return (FindValue(AtomKey(atom)));
 	}
 
 	return (nullptr);
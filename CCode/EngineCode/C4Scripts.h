@@ -147,9 +147,9 @@ namespace C4
 				return (valueMap.Insert(value));
 			}
 
-			Value *GetValue(const char *name) const
+			Value *GetValue(const AtomKey& key) const
 			{
-				return (valueMap.Find(name));
+				return (valueMap.Find(key));
 			}
 
 			void PurgeValues(void)
@@ -231,12 +231,15 @@ namespace C4
 	//# \function	ScriptState::GetValue		Returns a script variable.
 	//
 	//# \proto	Value *GetValue(const char *name) const;
+	//# \proto	Value *GetValue(const TextAtom& atom) const;
 	//
 	//# \param	name	The name of the value to retrieve.
+	//# \param	atom	The interned name of the value to retrieve.
 	//
 	//# \desc
-	//# The $GetValue$ function returns the script variable specified by the $name$ parameter. If no variable by that name exists,
-	//# then the return value is $nullptr$.
+	//# The $GetValue$ function returns the script variable specified by the $name$ or $atom$ parameter. If no variable by that
+	//# name exists, then the return value is $nullptr$. Methods that look up the same variable every time they run should keep
+	//# an atom for its name so that the string does not have to be found in the atom table on every lookup.
 	//
 	//# \also	$@Value@$
 
@@ -271,6 +274,8 @@ namespace C4
 
 			void StartScript(void);
 
+			Value *FindValue(const AtomKey& key) const;
+
 		public:
 
 			ScriptState(ScriptController *controller);
@@ -311,6 +316,7 @@ namespace C4
 			Node *GetScriptControllerTarget(void) const;
 
 			C4API Value *GetValue(const char *name) const;
+			C4API Value *GetValue(const TextAtom& atom) const;
 
 			void Preprocess(void);
 
@@ -401,9 +407,9 @@ namespace C4
 				return (valueMap.Insert(value));
 			}
 
-			Value *GetValue(const char *name) const
+			Value *GetValue(const AtomKey& key) const
 			{
-				return (valueMap.Find(name));
+				return (valueMap.Find(key));
 			}
 
 			void PurgeValues(void)
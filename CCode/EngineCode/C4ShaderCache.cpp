@@ -0,0 +1,674 @@
+ 
+
+#include "C4ShaderCache.h"
+#include "C4FragmentShaders.h"
+#include "C4VertexShaders.h"
+#include "C4Graphics.h"
+#include "C4Geometries.h"
+#include "C4Engine.h"
+#include "C4Files.h"
+
+
+using namespace C4;
+
+
+namespace
+{
+	enum
+	{
+		kShaderCacheType				= 'SHDC',
+		kMaxShaderCacheSignatureSize	= 1024,
+		kMaxShaderCacheSourceSize		= 16384
+	};
+}
+
+
+namespace C4
+{
+	template <> Heap Memory<ShaderPermutationJob>::heap("ShaderPermutationJob", MemoryMgr::CalculatePoolSize(64, sizeof(ShaderPermutationJob)), kHeapMutexless);
+	template class Memory<ShaderPermutationJob>;
+}
+
+
+Storage<HashTable<ShaderSource>> ShaderCache::sourceTable[kShaderStageCount];
+
+bool ShaderCache::cacheEnabled = true;
+bool ShaderCache::cacheModified = false;
+
+int32 ShaderCache::sourceHitCount = 0;
+int32 ShaderCache::sourceMissCount = 0;
+
+Mutex ShaderCache::cacheMutex;
+
+int32 ShaderCache::permutationCount = 0;
+int32 ShaderCache::permutationFailCount = 0;
+unsigned_int64 ShaderCache::permutationTime = 0;
+unsigned_int32 ShaderCache::maxPermutationTime = 0;
+
+
+ShaderSource::ShaderSource(const unsigned_int32 *signature, const char *source, unsigned_int32 size)
+{
+	sourceSize = size;
+
+	unsigned_int32 signatureSize = signature[0] + 1;
+	MemoryMgr::CopyMemory(signature, shaderSignature, signatureSize * 4);
+
+	char *text = reinterpret_cast<char *>(&shaderSignature[signatureSize]);
+	MemoryMgr::CopyMemory(source, text, size);
+	text[size] = 0;
+}
+
+ShaderSource::~ShaderSource()
+{
+}
+
+unsigned_int32 ShaderSource::Hash(const KeyType& key)
+{
+	unsigned_int32 hash = 0;
+
+	int32 count = key[0];
+	for (machine a = 1; a <= count; a++)
+	{
+		hash += key[a];
+		hash = (hash << 5) | (hash >> 27);
+	}
+
+	return (hash);
+}
+
+
+ShaderPermutationRecord::ShaderPermutationRecord(const Object *object, const Renderable *renderable, const RenderSegment *segment, int32 index)
+{
+	MaterialObject *const *pointer = segment->GetMaterialObjectPointer();
+
+	renderObject = object;
+	materialObject = (pointer) ? *pointer : nullptr;
+	segmentIndex = index;
+	detailLevel = renderable->GetShaderDetailLevel();
+	shaderFlags = renderable->GetShaderFlags();
+	ambientBlendState = renderable->GetAmbientBlendState();
+	lightBlendState = renderable->GetLightBlendState();
+}
+
+ShaderPermutationRecord::~ShaderPermutationRecord()
+{
+}
+
+bool ShaderPermutationRecord::operator ==(const ShaderPermutationRecord& record) const
+{
+	return ((renderObject == record.renderObject) && (materialObject == record.materialObject) && (segmentIndex == record.segmentIndex) && (detailLevel == record.detailLevel) && (shaderFlags == record.shaderFlags) && (ambientBlendState == record.ambientBlendState) && (lightBlendState == record.lightBlendState));
+}
+
+unsigned_int32 ShaderPermutationRecord::Hash(const KeyType& key)
+{
+	unsigned_int32 hash = (unsigned_int32) (GetPointerAddress(key.renderObject) >> 4);
+	hash = ((hash << 5) | (hash >> 27)) + (unsigned_int32) (GetPointerAddress(key.materialObject) >> 4);
+	hash = ((hash << 5) | (hash >> 27)) + key.segmentIndex;
+	hash = ((hash << 5) | (hash >> 27)) + key.shaderFlags;
+	return (hash);
+}
+
+
+ShaderPermutationJob::ShaderPermutationJob(ExecuteProc *execProc, FinalizeProc *finalProc, const Renderable *object, RenderSegment *segment, ShaderType type, const ShaderKey& key, bool keep) :
+		BatchJob(execProc, finalProc, nullptr, kJobNonpersistent),
+		shaderKey(key)
+{
+	renderable = object;
+	renderSegment = segment;
+	shaderType = type;
+	keepShaderData = keep;
+
+	shaderResult = kShaderOkay;
+	generationTime = 0;
+
+	// Building the graph clones processes and retains textures, and constructing the shader
+	// data adds it to the global list, so both have to happen here on the main thread before
+	// the job is submitted.
+
+	preparedShader = new PreparedShader(object, segment, type, key);
+	segment->BuildShaderGraph(object, type, &shaderGraph);
+}
+
+ShaderPermutationJob::~ShaderPermutationJob()
+{
+	delete preparedShader;
+}
+
+void ShaderPermutationJob::Generate(void)
+{
+	ShaderAttribute::LinkData	linkData;
+
+	unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
+	shaderResult = ShaderAttribute::PrepareShader(&shaderGraph, shaderType, shaderKey, renderable, renderSegment, preparedShader->GetShaderData(), &linkData, false, &deadGraph);
+	if (shaderResult == kShaderOkay)
+	{
+		preparedShader->SetLinkData(linkData.vertexSignature, linkData.fragmentSignature, linkData.shaderStateFlags);
+	}
+
+	generationTime = (unsigned_int32) (TheTimeMgr->GetMicrosecondCount() - time);
+}
+
+void ShaderPermutationJob::Finish(void)
+{
+	// This is called on the main thread after the batch has finished. The shader data built by
+	// the job becomes the prepared shader for the render segment, and the segment links it the
+	// first time the permutation is rendered.
+
+	if ((keepShaderData) && (shaderResult == kShaderOkay))
+	{
+		renderSegment->AddPreparedShader(preparedShader);
+		preparedShader = nullptr;
+	}
+}
+
+
+void ShaderCache::Initialize(void)
+{
+	for (machine a = 0; a < kShaderStageCount; a++)
+	{
+		new(sourceTable[a]) HashTable<ShaderSource>(16, 16);
+	}
+
+	cacheModified = false;
+	sourceHitCount = 0;
+	sourceMissCount = 0;
+
+	permutationCount = 0;
+	permutationFailCount = 0;
+	permutationTime = 0;
+	maxPermutationTime = 0;
+}
+
+void ShaderCache::Terminate(void)
+{
+	for (machine a = kShaderStageCount - 1; a >= 0; a--)
+	{
+		sourceTable[a]->~HashTable();
+	}
+}
+
+unsigned_int32 ShaderCache::CalculateGeneratorStamp(void)
+{
+	// The generator stamp changes whenever the engine version or the fixed text that
+	// surrounds every generated shader changes, invalidating all cached source code.
+
+	unsigned_int32 stamp = (kEngineInternalVersion << 16) | kShaderCacheVersion;
+
+	#if C4OPENGL
+
+		stamp ^= Text::Hash(VertexShader::prologText);
+		stamp = (stamp << 5) | (stamp >> 27);
+		stamp ^= Text::Hash(VertexShader::epilogText);
+		stamp = (stamp << 5) | (stamp >> 27);
+		stamp ^= Text::Hash(FragmentShader::prolog1Text);
+		stamp = (stamp << 5) | (stamp >> 27);
+		stamp ^= Text::Hash(FragmentShader::prolog2Text);
+		stamp = (stamp << 5) | (stamp >> 27);
+		stamp ^= Text::Hash(FragmentShader::epilogText);
+
+	#endif
+
+	return (stamp);
+}
+
+unsigned_int32 ShaderCache::CalculateDriverStamp(void)
+{
+	// Program binaries are only valid for the exact driver that produced them. A stamp
+	// of zero means that no graphics context is available and binaries are ignored.
+
+	unsigned_int32 stamp = 0;
+
+	#if C4OPENGL
+
+		if ((TheGraphicsMgr) && (TheGraphicsMgr->GetCapabilities()->extensionFlag[kExtensionGetProgramBinary]))
+		{
+			stamp = Text::Hash(GraphicsMgr::GetOpenGLVendor());
+			stamp = (stamp << 5) | (stamp >> 27);
+			stamp ^= Text::Hash(GraphicsMgr::GetOpenGLRenderer());
+			stamp = (stamp << 5) | (stamp >> 27);
+			stamp ^= Text::Hash(GraphicsMgr::GetOpenGLVersion());
+			stamp |= 1;
+		}
+
+	#endif
+
+	return (stamp);
+}
+
+bool ShaderCache::ReadSignature(const char *& data, const char *end, const unsigned_int32 **signature)
+{
+	if (data + 4 > end)
+	{
+		return (false);
+	}
+
+	const unsigned_int32 *sig = reinterpret_cast<const unsigned_int32 *>(data);
+	unsigned_int32 count = sig[0];
+	if ((count >= kMaxShaderCacheSignatureSize) || (data + (count + 1) * 4 > end))
+	{
+		return (false);
+	}
+
+	*signature = sig;
+	data += (count + 1) * 4;
+	return (true);
+}
+
+void ShaderCache::WriteSignature(File *file, const ShaderSignature& signature)
+{
+	file->Write(&signature[0], (signature[0] + 1) * 4);
+}
+
+const ShaderSource *ShaderCache::FindSource(ShaderStage stage, const unsigned_int32 *signature)
+{
+	// The source tables can be accessed by permutation jobs running on worker threads,
+	// so lookups and insertions are serialized by the cache mutex. Entries are never
+	// removed while jobs are running, so returned pointers remain valid after release.
+
+	if (cacheEnabled)
+	{
+		cacheMutex.Acquire();
+
+		const ShaderSource *source = sourceTable[stage]->Find(ShaderSignature(signature));
+		if (source)
+		{
+			sourceHitCount++;
+		}
+		else
+		{
+			sourceMissCount++;
+		}
+
+		cacheMutex.Release();
+		return (source);
+	}
+
+	return (nullptr);
+}
+
+const ShaderSource *ShaderCache::AddSource(ShaderStage stage, const unsigned_int32 *signature, const char *source, unsigned_int32 size)
+{
+	if (!cacheEnabled)
+	{
+		return (nullptr);
+	}
+
+	cacheMutex.Acquire();
+
+	ShaderSource *shaderSource = sourceTable[stage]->Find(ShaderSignature(signature));
+	if (!shaderSource)
+	{
+		shaderSource = MemoryMgr::GetMainHeap()->New<ShaderSource>(sizeof(ShaderSource) + signature[0] * 4 + size + 1);
+		new(shaderSource) ShaderSource(signature, source, size);
+		sourceTable[stage]->Insert(shaderSource);
+
+		cacheModified = true;
+	}
+
+	cacheMutex.Release();
+	return (shaderSource);
+}
+
+void ShaderCache::GeneratePermutation(Job *job, void *cookie)
+{
+	static_cast<ShaderPermutationJob *>(job)->Generate();
+}
+
+void ShaderCache::FinalizePermutation(Job *job, void *cookie)
+{
+	ShaderPermutationJob *permutationJob = static_cast<ShaderPermutationJob *>(job);
+	permutationJob->Finish();
+
+	unsigned_int32 time = permutationJob->GetGenerationTime();
+	permutationTime += time;
+	maxPermutationTime = Max(maxPermutationTime, time);
+
+	if (permutationJob->GetShaderResult() == kShaderOkay)
+	{
+		permutationCount++;
+	}
+	else
+	{
+		permutationFailCount++;
+	}
+
+	#if C4LOG_FILE
+
+		const ShaderKey& key = permutationJob->GetShaderKey();
+
+		String<>	text("Shader permutation: type ");
+		text += permutationJob->GetShaderType();
+		text += ", variant ";
+		text += key.GetShaderVariant();
+		text += ", shadow ";
+		text += (int32) key.GetShadowFlag();
+		text += ", ";
+		text += (int32) time;
+		text += " us<br/>\r\n";
+		Engine::Report(text, kReportLog);
+
+	#endif
+}
+
+void ShaderCache::GeneratePermutations(Node *root, unsigned_int32 typeMask, unsigned_int32 variantMask, bool keepShaderData)
+{
+	// Every permutation is generated by its own job. The jobs are constructed on the main
+	// thread, where their shader graphs are built, and they are destroyed on the main thread
+	// when the batch is finished. Only the expensive transformation, scheduling, allocation,
+	// and source generation stages run on the worker threads. If keepShaderData is true, then
+	// the shader data prepared by each job is handed to its render segment so that only the
+	// program has to be linked when the permutation is first rendered. Segments having the
+	// same permutation record as a segment seen earlier are skipped, so they still compile
+	// their shaders from the graph, but they find the source code in the cache. Permutations
+	// for which the segment already has shader data because they were compiled at run time
+	// are also skipped.
+
+	Batch								batch;
+	HashTable<ShaderPermutationRecord>	recordTable(16, 4);
+
+	if ((!cacheEnabled) || (TheGraphicsMgr->NullDevice()))
+	{
+		return;
+	}
+
+	int32 count = permutationCount;
+	int32 failCount = permutationFailCount;
+	unsigned_int64 totalTime = permutationTime;
+	unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
+	Node *node = root;
+	do
+	{
+		if (node->GetNodeType() == kNodeGeometry)
+		{
+			Geometry *geometry = static_cast<Geometry *>(node);
+			int32 level = geometry->GetShaderDetailLevel();
+
+			int32 segmentIndex = 0;
+			RenderSegment *segment = geometry->GetFirstRenderSegment();
+			do
+			{
+				ShaderPermutationRecord *record = new ShaderPermutationRecord(geometry->GetObject(), geometry, segment, segmentIndex);
+				if (recordTable.Find(*record))
+				{
+					delete record;
+					segmentIndex++;
+
+					segment = segment->GetNextRenderSegment();
+					continue;
+				}
+
+				recordTable.Insert(record);
+
+				for (machine type = 0; type < kShaderTypeCount; type++)
+				{
+					if (typeMask & (1 << type))
+					{
+						int32 variantCount = (type <= kShaderLastLight) ? kShaderVariantCount : 1;
+						int32 shadowCount = ((type >= kShaderFirstLight) && (type <= kShaderLastLight)) ? 2 : 1;
+
+						for (machine variant = 0; variant < variantCount; variant++)
+						{
+							if (variantMask & (1 << variant))
+							{
+								for (machine shadow = 0; shadow < shadowCount; shadow++)
+								{
+									ShaderKey key(static_cast<ShaderVariant>(variant), level, (shadow != 0));
+									if (segment->ShaderDataExists(static_cast<ShaderType>(type), key))
+									{
+										continue;
+									}
+
+									ShaderPermutationJob *job = new ShaderPermutationJob(&GeneratePermutation, &FinalizePermutation, geometry, segment, static_cast<ShaderType>(type), key, keepShaderData);
+									TheJobMgr->SubmitJob(job, &batch);
+								}
+							}
+						}
+					}
+				}
+
+				segmentIndex++;
+				segment = segment->GetNextRenderSegment();
+			} while (segment);
+		}
+
+		node = root->GetNextNode(node);
+	} while (node);
+
+	TheJobMgr->FinishBatch(&batch);
+
+	#if C4LOG_FILE
+
+		String<>	text("Shader permutations: ");
+		text += permutationCount - count;
+		text += " (";
+		text += permutationFailCount - failCount;
+		text += " failed), generation ";
+		text += (int32) ((permutationTime - totalTime) / 1000);
+		text += " ms, longest ";
+		text += (int32) maxPermutationTime;
+		text += " us, elapsed ";
+		text += (int32) ((TheTimeMgr->GetMicrosecondCount() - time) / 1000);
+		text += " ms<br/>\r\n";
+		Engine::Report(text, kReportLog);
+
+	#endif
+}
+
+void ShaderCache::GetDefaultCachePath(ResourcePath *path)
+{
+	*path = TheResourceMgr->GetSaveCatalog()->GetRootPath();
+	*path += "ShaderCache.bin";
+}
+
+bool ShaderCache::Load(const char *path)
+{
+	File	file;
+
+	if (file.Open(path) != kFileOkay)
+	{
+		return (false);
+	}
+
+	unsigned_int32 size = (unsigned_int32) file.GetSize();
+	if (size < sizeof(ShaderCacheHeader))
+	{
+		return (false);
+	}
+
+	char *storage = new char[size];
+	if (file.Read(storage, size) != kFileOkay)
+	{
+		delete[] storage;
+		return (false);
+	}
+
+	const ShaderCacheHeader *header = reinterpret_cast<const ShaderCacheHeader *>(storage);
+	if ((header->cacheType != kShaderCacheType) || (header->cacheVersion != kShaderCacheVersion) || (header->generatorStamp != CalculateGeneratorStamp()))
+	{
+		delete[] storage;
+		return (false);
+	}
+
+	const char *data = storage + sizeof(ShaderCacheHeader);
+	const char *end = storage + size;
+
+	bool modified = cacheModified;
+	bool valid = true;
+
+	for (machine stage = 0; (stage < kShaderStageCount) && (valid); stage++)
+	{
+		int32 count = header->sourceCount[stage];
+		for (machine a = 0; a < count; a++)
+		{
+			const unsigned_int32	*signature;
+
+			valid = false;
+			if ((!ReadSignature(data, end, &signature)) || (data + 4 > end))
+			{
+				break;
+			}
+
+			unsigned_int32 sourceSize = *reinterpret_cast<const unsigned_int32 *>(data);
+			data += 4;
+
+			if ((sourceSize >= kMaxShaderCacheSourceSize) || (sourceSize > (unsigned_int32) (end - data)))
+			{
+				break;
+			}
+
+			AddSource(static_cast<ShaderStage>(stage), signature, data, sourceSize);
+			data += (sourceSize + 3) & ~3;
+			valid = true;
+		}
+	}
+
+	if ((valid) && (header->driverStamp != 0) && (header->driverStamp == CalculateDriverStamp()))
+	{
+		int32 count = header->binaryCount;
+		for (machine a = 0; a < count; a++)
+		{
+			const unsigned_int32	*vertexSignature;
+			const unsigned_int32	*fragmentSignature;
+
+			const unsigned_int32 *geometrySignature = nullptr;
+
+			if ((!ReadSignature(data, end, &vertexSignature)) || (!ReadSignature(data, end, &fragmentSignature)) || (data + 4 > end))
+			{
+				break;
+			}
+
+			unsigned_int32 geometryFlag = *reinterpret_cast<const unsigned_int32 *>(data);
+			data += 4;
+
+			if ((geometryFlag != 0) && (!ReadSignature(data, end, &geometrySignature)))
+			{
+				break;
+			}
+
+			if (data + 8 > end)
+			{
+				break;
+			}
+
+			const unsigned_int32 *binaryInfo = reinterpret_cast<const unsigned_int32 *>(data);
+			unsigned_int32 binaryFormat = binaryInfo[0];
+			unsigned_int32 binarySize = binaryInfo[1];
+			data += 8;
+
+			if (binarySize > (unsigned_int32) (end - data))
+			{
+				break;
+			}
+
+			ProgramSignature signature(vertexSignature, fragmentSignature, geometrySignature);
+			if (!ProgramBinary::hashTable->Find(signature))
+			{
+				ProgramBinary::New(signature, binaryFormat, data, binarySize);
+			}
+
+			data += (binarySize + 3) & ~3;
+		}
+	}
+
+	// Entries that were read from the file do not make the cache dirty.
+
+	cacheModified = modified;
+
+	delete[] storage;
+	return (true);
+}
+
+bool ShaderCache::Save(const char *path)
+{
+	File				file;
+	ShaderCacheHeader	header;
+
+	if (file.Open(path, kFileCreate) != kFileOkay)
+	{
+		return (false);
+	}
+
+	header.cacheType = kShaderCacheType;
+	header.cacheVersion = kShaderCacheVersion;
+	header.generatorStamp = CalculateGeneratorStamp();
+	header.driverStamp = CalculateDriverStamp();
+
+	for (machine stage = 0; stage < kShaderStageCount; stage++)
+	{
+		header.sourceCount[stage] = sourceTable[stage]->GetElementCount();
+	}
+
+	header.binaryCount = (header.driverStamp != 0) ? ProgramBinary::hashTable->GetElementCount() : 0;
+
+	if (file.Write(&header, sizeof(ShaderCacheHeader)) != kFileOkay)
+	{
+		return (false);
+	}
+
+	for (machine stage = 0; stage < kShaderStageCount; stage++)
+	{
+		const HashTable<ShaderSource> *table = sourceTable[stage];
+		int32 bucketCount = table->GetBucketCount();
+		for (machine a = 0; a < bucketCount; a++)
+		{
+			const ShaderSource *source = table->GetFirstBucketElement(a);
+			while (source)
+			{
+				unsigned_int32 sourceSize = source->GetSourceSize();
+
+				WriteSignature(&file, source->GetKey());
+				file.Write(&sourceSize, 4);
+				file.Write(source->GetSourceText(), sourceSize);
+				file.WritePad(4);
+
+				source = source->Next();
+			}
+		}
+	}
+
+	if (header.binaryCount != 0)
+	{
+		const FlatHashTable<ProgramBinary> *table = ProgramBinary::hashTable;
+		int32 slotCount = table->GetSlotCount();
+		for (machine a = 0; a < slotCount; a++)
+		{
+			const ProgramBinary *binary = table->GetSlotElement(a);
+			if (binary)
+			{
+				const ProgramSignature& signature = binary->GetKey();
+				WriteSignature(&file, signature.GetVertexSignature());
+				WriteSignature(&file, signature.GetFragmentSignature());
+
+				const ShaderSignature& geometrySignature = signature.GetGeometrySignature();
+				unsigned_int32 geometryFlag = (geometrySignature) ? 1 : 0;
+				file.Write(&geometryFlag, 4);
+				if (geometryFlag)
+				{
+					WriteSignature(&file, geometrySignature);
+				}
+
+				unsigned_int32 binaryInfo[2] = {binary->GetBinaryFormat(), binary->GetBinarySize()};
+				file.Write(binaryInfo, 8);
+				file.Write(binary->GetBinaryData(), binaryInfo[1]);
+				file.WritePad(4);
+			}
+		}
+	}
+
+	cacheModified = false;
+	return (true);
+}
+
+void ShaderCache::Purge(void)
+{
+	for (machine a = 0; a < kShaderStageCount; a++)
+	{
+		sourceTable[a]->Purge();
+	}
+
+	cacheModified = true;
+}
+
+// ZYUQURM
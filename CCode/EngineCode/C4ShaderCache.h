@@ -0,0 +1,295 @@
+ 
+
+#ifndef C4ShaderCache_h
+#define C4ShaderCache_h
+
+
+#include "C4Shaders.h"
+#include "C4Threads.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kShaderCacheVersion			= 1
+	};
+
+
+	enum ShaderStage
+	{
+		kShaderStageVertex,
+		kShaderStageFragment,
+		kShaderStageCount
+	};
+
+
+	struct ShaderCacheHeader
+	{
+		Type				cacheType;
+		int32				cacheVersion;
+		unsigned_int32		generatorStamp;
+		unsigned_int32		driverStamp;
+
+		int32				sourceCount[kShaderStageCount];
+		int32				binaryCount;
+	};
+
+
+	// A ShaderSource object holds the generated source code for a single shader stage
+	// together with the signature that identifies it. The signature and the source text
+	// are stored in the same allocation immediately after the object.
+
+	class ShaderSource : public HashTableElement<ShaderSource>
+	{
+		friend class ShaderCache;
+
+		public:
+
+			typedef ShaderSignature KeyType;
+
+		private:
+
+			unsigned_int32		sourceSize;
+			unsigned_int32		shaderSignature[1];
+
+			ShaderSource(const unsigned_int32 *signature, const char *source, unsigned_int32 size);
+
+		public:
+
+			~ShaderSource();
+
+			KeyType GetKey(void) const
+			{
+				return (ShaderSignature(shaderSignature));
+			}
+
+			const unsigned_int32 *GetSignature(void) const
+			{
+				return (shaderSignature);
+			}
+
+			unsigned_int32 GetSourceSize(void) const
+			{
+				return (sourceSize);
+			}
+
+			const char *GetSourceText(void) const
+			{
+				return (reinterpret_cast<const char *>(&shaderSignature[shaderSignature[0] + 1]));
+			}
+
+			static unsigned_int32 Hash(const KeyType& key);
+	};
+
+
+	// A ShaderPermutationRecord holds the state that determines the shader source generated for
+	// one render segment. Geometry nodes that share an object and materials produce identical
+	// permutations, so only the first segment having a particular record is given jobs.
+
+	class ShaderPermutationRecord : public HashTableElement<ShaderPermutationRecord>
+	{
+		public:
+
+			typedef ShaderPermutationRecord KeyType;
+
+		private:
+
+			const Object			*renderObject;
+			const MaterialObject	*materialObject;
+			int32					segmentIndex;
+			int32					detailLevel;
+			unsigned_int32			shaderFlags;
+			unsigned_int32			ambientBlendState;
+			unsigned_int32			lightBlendState;
+
+		public:
+
+			ShaderPermutationRecord(const Object *object, const Renderable *renderable, const RenderSegment *segment, int32 index);
+			~ShaderPermutationRecord();
+
+			const KeyType& GetKey(void) const
+			{
+				return (*this);
+			}
+
+			bool operator ==(const ShaderPermutationRecord& record) const;
+
+			static unsigned_int32 Hash(const KeyType& key);
+	};
+
+
+	// A ShaderPermutationJob prepares one shader permutation of one render segment on a worker
+	// thread and stores the source code for it in the shader cache. The shader graph and the
+	// prepared shader are set up on the main thread when the job is constructed. When the batch
+	// has finished, the prepared shader is handed to the render segment on the main thread so
+	// that the program can be linked without processing the shader graph again, and the graph
+	// is destroyed with the job. Processes eliminated as dead code are parked in a second graph
+	// so that they are also destroyed on the main thread.
+
+	class ShaderPermutationJob : public BatchJob, public Memory<ShaderPermutationJob>
+	{
+		private:
+
+			const Renderable		*renderable;
+			RenderSegment			*renderSegment;
+			ShaderType				shaderType;
+			ShaderKey				shaderKey;
+
+			ShaderGraph				shaderGraph;
+			ShaderGraph				deadGraph;
+
+			PreparedShader			*preparedShader;
+			bool					keepShaderData;
+
+			ShaderResult			shaderResult;
+			unsigned_int32			generationTime;
+
+		public:
+
+			ShaderPermutationJob(ExecuteProc *execProc, FinalizeProc *finalProc, const Renderable *object, RenderSegment *segment, ShaderType type, const ShaderKey& key, bool keep);
+			~ShaderPermutationJob();
+
+			ShaderType GetShaderType(void) const
+			{
+				return (shaderType);
+			}
+
+			const ShaderKey& GetShaderKey(void) const
+			{
+				return (shaderKey);
+			}
+
+			ShaderResult GetShaderResult(void) const
+			{
+				return (shaderResult);
+			}
+
+			unsigned_int32 GetGenerationTime(void) const
+			{
+				return (generationTime);
+			}
+
+			void Generate(void);
+			void Finish(void);
+	};
+
+
+	// The ShaderCache class keeps the generated source code for every shader stage keyed by
+	// its ShaderSignature and the driver binaries for linked programs keyed by ProgramSignature.
+	// The contents are written to disk when the graphics manager shuts down and read back when
+	// it starts up again so that GLSL generation and driver compilation can be skipped for any
+	// permutation that has been seen before. The source tables do not touch the GPU, so they can
+	// be populated by offline tools and inspected without a graphics context.
+
+	class ShaderCache
+	{
+		private:
+
+			static Storage<HashTable<ShaderSource>>		sourceTable[kShaderStageCount];
+
+			static bool					cacheEnabled;
+			static bool					cacheModified;
+
+			static int32				sourceHitCount;
+			static int32				sourceMissCount;
+
+			static Mutex				cacheMutex;
+
+			static int32				permutationCount;
+			static int32				permutationFailCount;
+			static unsigned_int64		permutationTime;
+			static unsigned_int32		maxPermutationTime;
+
+			static unsigned_int32 CalculateGeneratorStamp(void);
+			static unsigned_int32 CalculateDriverStamp(void);
+
+			static bool ReadSignature(const char *& data, const char *end, const unsigned_int32 **signature);
+			static void WriteSignature(File *file, const ShaderSignature& signature);
+
+			static void GeneratePermutation(Job *job, void *cookie);
+			static void FinalizePermutation(Job *job, void *cookie);
+
+		public:
+
+			static void Initialize(void);
+			static void Terminate(void);
+
+			static bool Enabled(void)
+			{
+				return (cacheEnabled);
+			}
+
+			static void SetEnabled(bool enabled)
+			{
+				cacheEnabled = enabled;
+			}
+
+			static bool Modified(void)
+			{
+				return (cacheModified);
+			}
+
+			static void SetModified(void)
+			{
+				cacheModified = true;
+			}
+
+			static int32 GetSourceHitCount(void)
+			{
+				return (sourceHitCount);
+			}
+
+			static int32 GetSourceMissCount(void)
+			{
+				return (sourceMissCount);
+			}
+
+			static int32 GetPermutationCount(void)
+			{
+				return (permutationCount);
+			}
+
+			static int32 GetPermutationFailCount(void)
+			{
+				return (permutationFailCount);
+			}
+
+			static unsigned_int64 GetPermutationTime(void)
+			{
+				return (permutationTime);
+			}
+
+			static unsigned_int32 GetMaxPermutationTime(void)
+			{
+				return (maxPermutationTime);
+			}
+
+			static int32 GetSourceCount(ShaderStage stage)
+			{
+				return (sourceTable[stage]->GetElementCount());
+			}
+
+			static int32 GetBinaryCount(void)
+			{
+				return (ProgramBinary::hashTable->GetElementCount());
+			}
+
+			C4API static const ShaderSource *FindSource(ShaderStage stage, const unsigned_int32 *signature);
+			C4API static const ShaderSource *AddSource(ShaderStage stage, const unsigned_int32 *signature, const char *source, unsigned_int32 size);
+
+			C4API static void GetDefaultCachePath(ResourcePath *path);
+
+			C4API static void GeneratePermutations(Node *root, unsigned_int32 typeMask, unsigned_int32 variantMask, bool keepShaderData = true);
+
+			C4API static bool Load(const char *path);
+			C4API static bool Save(const char *path);
+
+			C4API static void Purge(void);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
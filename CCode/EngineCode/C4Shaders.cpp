@@ -1,6 +1,7 @@
  
 
 #include "C4Shaders.h"
+#include "C4ShaderCache.h"
 #include "C4Graphics.h"
 
 
@@ -1365,7 +1366,7 @@ void ShaderAttribute::OptimizeTextureMaps(const ShaderGraph *graph)
 	textureMapList.RemoveAll();
 }
 
-void ShaderAttribute::EliminateDeadCode(const ShaderGraph *graph, List<Process> *terminalList)
+void ShaderAttribute::EliminateDeadCode(const ShaderGraph *graph, List<Process> *terminalList, ShaderGraph *deadGraph)
 {
 	List<Process>	deadList;
 
@@ -1411,7 +1412,14 @@ void ShaderAttribute::EliminateDeadCode(const ShaderGraph *graph, List<Process>
 			route = next;
 		}
 
-		delete process;
+		if (!deadGraph)
+		{
+			delete process;
+		}
+		else
+		{
+			deadGraph->AddElement(process);
+		}
 	}
 }
 
@@ -1908,7 +1916,10 @@ ShaderResult ShaderAttribute::AllocateShaderResources(const ShaderCompileData *c
 
 			if ((a == 0) && (process->GetBaseProcessType() == kProcessTextureMap))
 			{
-				*static_cast<const TextureMapProcess *>(process)->signatureUnit = unit;
+				const TextureMapProcess *textureMapProcess = static_cast<const TextureMapProcess *>(process);
+				*textureMapProcess->signatureUnit = unit;
+
+				compileData->shaderData->AddStreamedTexture(textureMapProcess->GetTexture());
 			}
 
 			#if C4PS3 //[ PS3
@@ -2277,6 +2288,22 @@ int32 ShaderAttribute::GenerateShaderProlog(const ShaderCompileData *compileData
 	return (len);
 }
 
+unsigned_int32 ShaderAttribute::GenerateFragmentSource(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, const ProcessData *processData, const List<Process> *scheduleList, char *shaderCode)
+{
+	int32 length = GenerateShaderProlog(compileData, allocData, shaderCode);
+	char *string = shaderCode + length;
+
+	GenerateShaderCode(compileData, allocData, processData, scheduleList, string, &length);
+
+	string += length;
+	string += Text::CopyText(FragmentShader::epilogText, string);
+
+	unsigned_int32 size = (unsigned_int32) (string - shaderCode);
+	Assert(size < kMaxShaderSourceSize, "ShaderAttribute::GenerateFragmentSource(), shader string overflow\n");
+
+	return (size);
+}
+
 int32 ShaderAttribute::GenerateVertexOutputName(Type type, const ShaderAllocationData *allocData, int32 mask, char *name)
 {
 	static const char *const texcoordName[kMaxShaderTexcoordCount] =
@@ -2332,7 +2359,7 @@ int32 ShaderAttribute::GenerateVertexOutputName(Type type, const ShaderAllocatio
 	return (0);
 }
 
-VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, unsigned_int32 *shaderStateFlags)
+unsigned_int32 ShaderAttribute::BuildVertexAssembly(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, VertexAssembly *assembly)
 {
 	union
 	{
@@ -2340,8 +2367,6 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 		unsigned_int32	flagStorage[(kVertexSnippetCount + 3) / 4];
 	};
 
-	VertexAssembly assembly(signatureStorage);
-
 	for (machine a = 0; a < (kVertexSnippetCount + 3) / 4; a++)
 	{
 		flagStorage[a] = 0;
@@ -2363,13 +2388,13 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 
 				#if C4OPENGL
 
-					stateFlags = renderable->BuildTexcoord0Transform(compileData->renderSegment, compileData->shaderData, &assembly, stateFlags);
+					stateFlags = renderable->BuildTexcoord0Transform(compileData->renderSegment, compileData->shaderData, assembly, stateFlags);
 
 				#else
 
 					if (renderable->GetRenderType() != kRenderPointSprites)
 					{
-						stateFlags = renderable->BuildTexcoord0Transform(compileData->renderSegment, compileData->shaderData, &assembly, stateFlags);
+						stateFlags = renderable->BuildTexcoord0Transform(compileData->renderSegment, compileData->shaderData, assembly, stateFlags);
 					}
 
 				#endif
@@ -2378,7 +2403,7 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 
 			case 'TEX1':
 
-				stateFlags = renderable->BuildTexcoord1Transform(compileData->renderSegment, compileData->shaderData, &assembly, stateFlags);
+				stateFlags = renderable->BuildTexcoord1Transform(compileData->renderSegment, compileData->shaderData, assembly, stateFlags);
 				break;
 
 			case 'POSI':
@@ -2764,7 +2789,7 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 	{
 		if (shaderFlags & kShaderVertexPostboard)
 		{
-			assembly.AddSnippet(&VertexShader::generateImpostorFrame);
+			assembly->AddSnippet(&VertexShader::generateImpostorFrame);
 			stateFlags |= kShaderStateCameraPosition;
 		}
 		else
@@ -2777,11 +2802,11 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 				{
 					if (shaderFlags & kShaderNormalizeBasisVectors)
 					{
-						assembly.AddSnippet(&VertexShader::normalizeNormal);
+						assembly->AddSnippet(&VertexShader::normalizeNormal);
 					}
 
-					assembly.AddSnippet(&VertexShader::generateTangent);
-					assembly.AddSnippet(&VertexShader::calculateBitangent);
+					assembly->AddSnippet(&VertexShader::generateTangent);
+					assembly->AddSnippet(&VertexShader::calculateBitangent);
 				}
 				else
 				{
@@ -2791,22 +2816,22 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 					{
 						if (shaderFlags & kShaderNormalizeBasisVectors)
 						{
-							assembly.AddSnippet(&VertexShader::normalizeNormal);
-							assembly.AddSnippet(&VertexShader::normalizeTangent);
+							assembly->AddSnippet(&VertexShader::normalizeNormal);
+							assembly->AddSnippet(&VertexShader::normalizeTangent);
 						}
 
-						assembly.AddSnippet(&VertexShader::calculateBitangent);
+						assembly->AddSnippet(&VertexShader::calculateBitangent);
 					}
 					else
 					{
 						if (shaderFlags & kShaderNormalizeBasisVectors)
 						{
-							assembly.AddSnippet(&VertexShader::normalizeNormal);
-							assembly.AddSnippet(&VertexShader::orthonormalizeTangent);
+							assembly->AddSnippet(&VertexShader::normalizeNormal);
+							assembly->AddSnippet(&VertexShader::orthonormalizeTangent);
 						}
 
-						assembly.AddSnippet(&VertexShader::calculateBitangent);
-						assembly.AddSnippet(&VertexShader::adjustBitangent);
+						assembly->AddSnippet(&VertexShader::calculateBitangent);
+						assembly->AddSnippet(&VertexShader::adjustBitangent);
 					}
 				}
 			}
@@ -2814,31 +2839,31 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 			{
 				if (shaderFlags & kShaderNormalizeBasisVectors)
 				{
-					assembly.AddSnippet(&VertexShader::normalizeNormal);
+					assembly->AddSnippet(&VertexShader::normalizeNormal);
 				}
 			}
 		}
 	}
 
-	stateFlags |= renderable->BuildVertexTransform(compileData->shaderData, &assembly);
+	stateFlags |= renderable->BuildVertexTransform(compileData->shaderData, assembly);
 
 	for (machine a = 0; a < kVertexSnippetCount; a++)
 	{
 		if (snippetFlag[a])
 		{
-			assembly.AddSnippet(&VertexShader::vertexSnippet[a]);
+			assembly->AddSnippet(&VertexShader::vertexSnippet[a]);
 		}
 	}
 
 	if (compileData->shaderSourceFlags & kShaderSourcePrimaryColor)
 	{
 		renderable->SetShaderArray(compileData->shaderData, kVertexAttribColor0, kArrayColor0);
-		assembly.AddSnippet(&VertexShader::outputPrimaryColor);
+		assembly->AddSnippet(&VertexShader::outputPrimaryColor);
 
 		if (compileData->shaderSourceFlags & kShaderSourceSecondaryColor)
 		{
 			renderable->SetShaderArray(compileData->shaderData, kVertexAttribColor1, kArrayColor1);
-			assembly.AddSnippet(&VertexShader::outputSecondaryColor);
+			assembly->AddSnippet(&VertexShader::outputSecondaryColor);
 		}
 	}
 
@@ -2848,19 +2873,20 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 
 		if (!(shaderFlags & kShaderVertexInfinite))
 		{
-			assembly.AddSnippet(&VertexShader::outputPointSize);
+			assembly->AddSnippet(&VertexShader::outputPointSize);
 		}
 		else
 		{
-			assembly.AddSnippet(&VertexShader::outputInfinitePointSize);
+			assembly->AddSnippet(&VertexShader::outputInfinitePointSize);
 		}
 	}
 
-	int32 snippetCount = signatureStorage[0];
-	unsigned_int32 *signature = &signatureStorage[snippetCount + 1];
+	unsigned_int32 *storage = assembly->signatureStorage;
+	int32 snippetCount = storage[0];
+	unsigned_int32 *signature = &storage[snippetCount + 1];
 
 	int32 interpolantCount = allocData->interpolantCount;
-	signatureStorage[0] = snippetCount + interpolantCount * 2;
+	storage[0] = snippetCount + interpolantCount * 2;
 
 	for (machine a = 0; a < interpolantCount; a++)
 	{
@@ -2870,144 +2896,144 @@ VertexShader *ShaderAttribute::GenerateVertexShader(const ShaderCompileData *com
 		signature += 2;
 	}
 
-	VertexShader *vertexShader = VertexShader::Find(signatureStorage);
-	if (!vertexShader)
-	{
-		const char *positionText = nullptr;
-		const char *normalText = nullptr;
-		const char *tangentText = nullptr;
+	return (stateFlags);
+}
 
-		int32 len = Text::CopyText(VertexShader::prologText, sourceStorage);
-		char *string = sourceStorage + len;
+unsigned_int32 ShaderAttribute::GenerateVertexSource(const ShaderAllocationData *allocData, const VertexAssembly *assembly, char *shaderCode)
+{
+	int32 snippetCount = assembly->signatureStorage[0] - allocData->interpolantCount * 2;
 
-		for (machine a = 0; a < snippetCount; a++)
+	const char *positionText = nullptr;
+	const char *normalText = nullptr;
+	const char *tangentText = nullptr;
+
+	int32 len = Text::CopyText(VertexShader::prologText, shaderCode);
+	char *string = shaderCode + len;
+
+	for (machine a = 0; a < snippetCount; a++)
+	{
+		const char *code = assembly->vertexSnippet[a]->shaderCode;
+		for (;;)
 		{
-			const char *code = assembly.vertexSnippet[a]->shaderCode;
-			for (;;)
+			int32 c = *code++;
+			if (c == 0)
 			{
-				int32 c = *code++;
-				if (c == 0)
-				{
-					break;
-				}
+				break;
+			}
 
-				if (c == '%')
+			if (c == '%')
+			{
+				if ((code[0] == 'O') && (code[1] == 'P') && (code[2] == 'O') && (code[3] == 'S'))
 				{
-					if ((code[0] == 'O') && (code[1] == 'P') && (code[2] == 'O') && (code[3] == 'S'))
+					if (positionText)
 					{
-						if (positionText)
-						{
-							string += Text::CopyText(positionText, string);
-						}
-						else
-						{
-							string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_POSITION0), string);
-							if (code[4] != '.')
-							{
-								string += Text::CopyText(".xyz", string);
-							}
-						}
-
-						code += 4;
+						string += Text::CopyText(positionText, string);
 					}
-					else if ((code[0] == 'N') && (code[1] == 'R') && (code[2] == 'M') && (code[3] == 'L'))
+					else
 					{
-						if (normalText)
+						string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_POSITION0), string);
+						if (code[4] != '.')
 						{
-							string += Text::CopyText(normalText, string);
-						}
-						else
-						{
-							string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_NORMAL), string);
-							if (code[4] != '.')
-							{
-								string += Text::CopyText(".xyz", string);
-							}
+							string += Text::CopyText(".xyz", string);
 						}
+					}
 
-						code += 4;
+					code += 4;
+				}
+				else if ((code[0] == 'N') && (code[1] == 'R') && (code[2] == 'M') && (code[3] == 'L'))
+				{
+					if (normalText)
+					{
+						string += Text::CopyText(normalText, string);
 					}
-					else if ((code[0] == 'T') && (code[1] == 'A') && (code[2] == 'N') && (code[3] == 'G'))
+					else
 					{
-						if (tangentText)
+						string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_NORMAL), string);
+						if (code[4] != '.')
 						{
-							string += Text::CopyText(tangentText, string);
-						}
-						else
-						{
-							string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_TANGENT), string);
-							if (code[4] != '.')
-							{
-								string += Text::CopyText(".xyz", string);
-							}
+							string += Text::CopyText(".xyz", string);
 						}
+					}
 
-						code += 4;
+					code += 4;
+				}
+				else if ((code[0] == 'T') && (code[1] == 'A') && (code[2] == 'N') && (code[3] == 'G'))
+				{
+					if (tangentText)
+					{
+						string += Text::CopyText(tangentText, string);
 					}
-					else if ((code[0] == 'H') && (code[1] == 'A') && (code[2] == 'N') && (code[3] == 'D'))
+					else
 					{
-						if (tangentText)
-						{
-							string += Text::CopyText("1.0", string);
-						}
-						else
+						string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_TANGENT), string);
+						if (code[4] != '.')
 						{
-							string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_TANGENT), string);
-							string += Text::CopyText(".w", string);
+							string += Text::CopyText(".xyz", string);
 						}
-
-						code += 4;
 					}
+
+					code += 4;
 				}
-				else if (c == '$')
+				else if ((code[0] == 'H') && (code[1] == 'A') && (code[2] == 'N') && (code[3] == 'D'))
 				{
-					Type type = (code[0] << 24) | (code[1] << 16) | (code[2] << 8) | code[3];
-					code += 4;
-
-					c = code[0];
-					if (c != ':')
+					if (tangentText)
 					{
-						string += GenerateVertexOutputName(type, allocData, -(c == '.'), string);
+						string += Text::CopyText("1.0", string);
 					}
 					else
 					{
-						string += GenerateVertexOutputName(type, allocData, code[1], string);
-						code += 2;
+						string += Text::CopyText(ATTRIB(VERTEX_ATTRIB_TANGENT), string);
+						string += Text::CopyText(".w", string);
 					}
+
+					code += 4;
+				}
+			}
+			else if (c == '$')
+			{
+				Type type = (code[0] << 24) | (code[1] << 16) | (code[2] << 8) | code[3];
+				code += 4;
+
+				c = code[0];
+				if (c != ':')
+				{
+					string += GenerateVertexOutputName(type, allocData, -(c == '.'), string);
 				}
 				else
 				{
-					*string++ = (char) c;
+					string += GenerateVertexOutputName(type, allocData, code[1], string);
+					code += 2;
 				}
 			}
-
-			unsigned_int32 snippetFlags = assembly.vertexSnippet[a]->flags;
-			if (snippetFlags & kVertexSnippetPositionFlag)
+			else
 			{
-				positionText = "opos";
+				*string++ = (char) c;
 			}
+		}
 
-			if (snippetFlags & kVertexSnippetNormalFlag)
-			{
-				normalText = "nrml";
-			}
+		unsigned_int32 snippetFlags = assembly->vertexSnippet[a]->flags;
+		if (snippetFlags & kVertexSnippetPositionFlag)
+		{
+			positionText = "opos";
+		}
 
-			if (snippetFlags & kVertexSnippetTangentFlag)
-			{
-				tangentText = "tang";
-			}
+		if (snippetFlags & kVertexSnippetNormalFlag)
+		{
+			normalText = "nrml";
 		}
 
-		string += Text::CopyText(VertexShader::epilogText, string);
+		if (snippetFlags & kVertexSnippetTangentFlag)
+		{
+			tangentText = "tang";
+		}
+	}
 
-		unsigned_int32 size = (unsigned_int32) (string - sourceStorage);
-		Assert(size < kMaxShaderSourceSize, "ShaderAttribute::GenerateVertexShader(), shader string overflow\n");
+	string += Text::CopyText(VertexShader::epilogText, string);
 
-		vertexShader = VertexShader::New(sourceStorage, size, signatureStorage);
-	}
+	unsigned_int32 size = (unsigned_int32) (string - shaderCode);
+	Assert(size < kMaxShaderSourceSize, "ShaderAttribute::GenerateVertexSource(), shader string overflow\n");
 
-	*shaderStateFlags = stateFlags;
-	return (vertexShader);
+	return (size);
 }
 
 void ShaderAttribute::BuildStateProcList(const ShaderCompileData *compileData, unsigned_int32 shaderStateFlags)
@@ -3384,6 +3410,19 @@ ShaderResult ShaderAttribute::CompileShader(ShaderType type, const ShaderKey& ke
 }
 
 ShaderResult ShaderAttribute::CompileShader(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData)
+{
+	LinkData	linkData;
+
+	ShaderResult result = PrepareShader(graph, type, key, renderable, renderSegment, shaderData, &linkData, true);
+	if (result == kShaderOkay)
+	{
+		LinkShader(type, key, renderable, renderSegment, shaderData, &linkData);
+	}
+
+	return (result);
+}
+
+ShaderResult ShaderAttribute::PrepareShader(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, LinkData *linkData, bool immediate, ShaderGraph *deadGraph)
 {
 	List<Process>			processList;
 	List<Process>			readyList;
@@ -3391,6 +3430,15 @@ ShaderResult ShaderAttribute::CompileShader(ShaderGraph *graph, ShaderType type,
 	ShaderAllocationData	allocData;
 	ShaderResult			result;
 
+	// This function runs every stage that processes the shader graph, records the bindings for the
+	// renderable in the shader data, and stores the signatures needed to link the program in the
+	// link data. If immediate is true, then the shader objects are also created, so it has to run
+	// on the main thread. Otherwise, missing source code is only added to the shader cache, and
+	// the static signature and source buffers are not used, so it can run on a worker thread as
+	// long as the graph and the shader data belong to the caller. If deadGraph is not null, then
+	// eliminated processes are moved into it instead of being deleted so that texture references
+	// are only released on the thread that destroys the graphs.
+
 	compileData.renderable = renderable;
 	compileData.renderSegment = renderSegment;
 	compileData.shaderData = shaderData;
@@ -3403,6 +3451,11 @@ ShaderResult ShaderAttribute::CompileShader(ShaderGraph *graph, ShaderType type,
 	compileData.shaderSourceFlags = 0;
 	compileData.terrainViewDirection = nullptr;
 
+	linkData->shaderStateFlags = 0;
+	linkData->fragmentShader = nullptr;
+	linkData->vertexShader = nullptr;
+	linkData->vertexSignature[0] = 0;
+
 	if (type <= kShaderLastAmbient)
 	{
 		result = PrepareAmbientShader(&compileData, graph, &processList);
@@ -3422,122 +3475,235 @@ ShaderResult ShaderAttribute::CompileShader(ShaderGraph *graph, ShaderType type,
 
 	if (result == kShaderOkay)
 	{
+		unsigned_int32 *signature = linkData->fragmentSignature;
+
 		OptimizeTextureMaps(graph);
-		EliminateDeadCode(graph, &processList);
+		EliminateDeadCode(graph, &processList, deadGraph);
 		OrganizeDerivedInterpolants(&compileData, graph);
 
 		CalculatePathLengths(graph, &processList, &readyList);
-		int32 processCount = ScheduleShader(&compileData, &readyList, &processList, signatureStorage);
+		int32 processCount = ScheduleShader(&compileData, &readyList, &processList, signature);
 
 		if (renderable->GetRenderType() == kRenderPointSprites)
 		{
-			unsigned_int32 size = signatureStorage[0];
-			signatureStorage[0] = size + 1;
-			signatureStorage[size] = 1;
+			unsigned_int32 size = signature[0];
+			signature[0] = size + 1;
+			signature[size] = 1;
 		}
 
-		Assert(signatureStorage[0] < kMaxShaderSignatureSize, "ShaderAttribute::CompileShader(), signature overflow\n");
+		Assert(signature[0] < kMaxShaderSignatureSize, "ShaderAttribute::PrepareShader(), signature overflow\n");
 
 		ProcessData *processData = new ProcessData[processCount];
 
 		result = AllocateShaderResources(&compileData, &allocData, processCount, processData, &processList);
 		if (result == kShaderOkay)
 		{
-			ProgramStageTable	stageTable;
-			unsigned_int32		shaderStateFlags;
-			int32				geometryShaderIndex;
+			VertexAssembly assembly(linkData->vertexSignature);
 
-			FragmentShader *fragmentShader = FragmentShader::Find(signatureStorage);
-			if (!fragmentShader)
+			bool vertexFlag = (renderable->GetGeometryShaderIndex() < 0);
+			if (vertexFlag)
 			{
-				int32 length = GenerateShaderProlog(&compileData, &allocData, sourceStorage);
-				char *string = sourceStorage + length;
-
-				GenerateShaderCode(&compileData, &allocData, processData, &processList, string, &length);
+				linkData->shaderStateFlags = BuildVertexAssembly(&compileData, &allocData, &assembly);
+			}
 
-				string += length;
-				string += Text::CopyText(FragmentShader::epilogText, string);
+			if (immediate)
+			{
+				FragmentShader *fragmentShader = FragmentShader::Find(signature);
+				if (!fragmentShader)
+				{
+					const ShaderSource *shaderSource = ShaderCache::FindSource(kShaderStageFragment, signature);
+					if (shaderSource)
+					{
+						fragmentShader = FragmentShader::New(shaderSource->GetSourceText(), shaderSource->GetSourceSize(), signature);
+					}
+					else
+					{
+						unsigned_int32 size = GenerateFragmentSource(&compileData, &allocData, processData, &processList, sourceStorage);
+						ShaderCache::AddSource(kShaderStageFragment, signature, sourceStorage, size);
+						fragmentShader = FragmentShader::New(sourceStorage, size, signature);
+					}
 
-				unsigned_int32 size = (unsigned_int32) (string - sourceStorage);
-				Assert(size < kMaxShaderSourceSize, "ShaderAttribute::CompileShader(), shader string overflow\n");
+					#if C4PS3 //[ PS3
 
-				fragmentShader = FragmentShader::New(sourceStorage, size, signatureStorage);
+						// -- PS3 code hidden --
 
-				#if C4PS3 //[ PS3
+					#endif //]
+				}
 
-					// -- PS3 code hidden --
+				linkData->fragmentShader = fragmentShader;
 
-				#endif //]
-			}
+				if (vertexFlag)
+				{
+					const unsigned_int32 *vertexSignature = linkData->vertexSignature;
 
-			stageTable.fragmentShader = fragmentShader;
+					VertexShader *vertexShader = VertexShader::Find(vertexSignature);
+					if (!vertexShader)
+					{
+						const ShaderSource *shaderSource = ShaderCache::FindSource(kShaderStageVertex, vertexSignature);
+						if (shaderSource)
+						{
+							vertexShader = VertexShader::New(shaderSource->GetSourceText(), shaderSource->GetSourceSize(), vertexSignature);
+						}
+						else
+						{
+							unsigned_int32 size = GenerateVertexSource(&allocData, &assembly, sourceStorage);
+							ShaderCache::AddSource(kShaderStageVertex, vertexSignature, sourceStorage, size);
+							vertexShader = VertexShader::New(sourceStorage, size, vertexSignature);
+						}
+					}
 
-			if ((!renderable) || ((geometryShaderIndex = renderable->GetGeometryShaderIndex()) < 0))
-			{
-				stageTable.vertexShader = GenerateVertexShader(&compileData, &allocData, &shaderStateFlags);
+					linkData->vertexShader = vertexShader;
+				}
 			}
 			else
 			{
-				renderable->SetShaderArray(shaderData, kVertexAttribPosition0, kArrayPosition0);
+				char *source = nullptr;
 
-				const GeometryAssembly *geometryAssembly = &GeometryShader::geometryAssembly[geometryShaderIndex];
+				if (!ShaderCache::FindSource(kShaderStageFragment, signature))
+				{
+					source = new char[kMaxShaderSourceSize];
+					unsigned_int32 size = GenerateFragmentSource(&compileData, &allocData, processData, &processList, source);
+					ShaderCache::AddSource(kShaderStageFragment, signature, source, size);
+				}
 
-				GeometryShader *geometryShader = GeometryShader::Find(geometryAssembly->signature);
-				if (!geometryShader)
+				if ((vertexFlag) && (!ShaderCache::FindSource(kShaderStageVertex, linkData->vertexSignature)))
 				{
-					const char *source = geometryAssembly->shaderSource;
-					geometryShader = GeometryShader::New(source, Text::GetTextLength(source), geometryAssembly->signature);
+					if (!source)
+					{
+						source = new char[kMaxShaderSourceSize];
+					}
+
+					unsigned_int32 size = GenerateVertexSource(&allocData, &assembly, source);
+					ShaderCache::AddSource(kShaderStageVertex, linkData->vertexSignature, source, size);
 				}
 
-				stageTable.geometryShader = geometryShader;
+				delete[] source;
+			}
+		}
+
+		delete[] processData;
+	}
 
-				int32 snippetCount = geometryAssembly->vertexSnippetCount;
-				const VertexSnippet *const *snippet = geometryAssembly->vertexSnippet;
+	return (result);
+}
 
-				VertexAssembly vertexAssembly(ShaderAttribute::signatureStorage);
-				for (machine a = 0; a < snippetCount; a++)
-				{
-					vertexAssembly.AddSnippet(snippet[a]);
-				}
+bool ShaderAttribute::LinkShader(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, const LinkData *linkData)
+{
+	ProgramStageTable	stageTable;
+	int32				geometryShaderIndex;
 
-				stageTable.vertexShader = VertexShader::Get(&vertexAssembly);
+	// Shader objects that were not created when the shader was prepared are created from the source
+	// code in the shader cache. If the source code is no longer there, then false is returned, and
+	// the shader has to be compiled from its graph again.
 
-				ShaderStateProc *stateProc = geometryAssembly->stateProc;
-				if (stateProc)
+	FragmentShader *fragmentShader = linkData->fragmentShader;
+	if (!fragmentShader)
+	{
+		fragmentShader = FragmentShader::Find(linkData->fragmentSignature);
+		if (!fragmentShader)
+		{
+			const ShaderSource *shaderSource = ShaderCache::FindSource(kShaderStageFragment, linkData->fragmentSignature);
+			if (!shaderSource)
+			{
+				return (false);
+			}
+
+			fragmentShader = FragmentShader::New(shaderSource->GetSourceText(), shaderSource->GetSourceSize(), linkData->fragmentSignature);
+		}
+	}
+
+	if ((!renderable) || ((geometryShaderIndex = renderable->GetGeometryShaderIndex()) < 0))
+	{
+		VertexShader *vertexShader = linkData->vertexShader;
+		if (!vertexShader)
+		{
+			vertexShader = VertexShader::Find(linkData->vertexSignature);
+			if (!vertexShader)
+			{
+				const ShaderSource *shaderSource = ShaderCache::FindSource(kShaderStageVertex, linkData->vertexSignature);
+				if (!shaderSource)
 				{
-					shaderData->AddStateProc(stateProc);
+					fragmentShader->Release();
+					return (false);
 				}
+
+				vertexShader = VertexShader::New(shaderSource->GetSourceText(), shaderSource->GetSourceSize(), linkData->vertexSignature);
 			}
+		}
 
-			ShaderProgram *shaderProgram = ShaderProgram::Get(stageTable);
-			shaderData->shaderProgram = shaderProgram;
+		stageTable.vertexShader = vertexShader;
+	}
+	else
+	{
+		renderable->SetShaderArray(shaderData, kVertexAttribPosition0, kArrayPosition0);
 
-			stageTable.fragmentShader->Release();
-			stageTable.vertexShader->Release();
+		const GeometryAssembly *geometryAssembly = &GeometryShader::geometryAssembly[geometryShaderIndex];
 
-			#if C4OPENGL
+		GeometryShader *geometryShader = GeometryShader::Find(geometryAssembly->signature);
+		if (!geometryShader)
+		{
+			const char *source = geometryAssembly->shaderSource;
+			geometryShader = GeometryShader::New(source, Text::GetTextLength(source), geometryAssembly->signature);
+		}
 
-				BindShaderUniforms(type, shaderProgram);
+		stageTable.geometryShader = geometryShader;
 
-			#endif
+		int32 snippetCount = geometryAssembly->vertexSnippetCount;
+		const VertexSnippet *const *snippet = geometryAssembly->vertexSnippet;
 
-			GeometryShader *geometryShader = stageTable.geometryShader;
-			if (!geometryShader)
-			{
-				BuildStateProcList(&compileData, shaderStateFlags);
-			}
-			else
-			{
-				geometryShader->Release();
-			}
+		VertexAssembly vertexAssembly(ShaderAttribute::signatureStorage);
+		for (machine a = 0; a < snippetCount; a++)
+		{
+			vertexAssembly.AddSnippet(snippet[a]);
+		}
+
+		stageTable.vertexShader = VertexShader::Get(&vertexAssembly);
 
-			compileData.shaderData->Preprocess();
+		ShaderStateProc *stateProc = geometryAssembly->stateProc;
+		if (stateProc)
+		{
+			shaderData->AddStateProc(stateProc);
 		}
+	}
 
-		delete[] processData;
+	stageTable.fragmentShader = fragmentShader;
+
+	ShaderProgram *shaderProgram = ShaderProgram::Get(stageTable);
+	shaderData->shaderProgram = shaderProgram;
+
+	stageTable.fragmentShader->Release();
+	stageTable.vertexShader->Release();
+
+	#if C4OPENGL
+
+		BindShaderUniforms(type, shaderProgram);
+
+	#endif
+
+	GeometryShader *geometryShader = stageTable.geometryShader;
+	if (!geometryShader)
+	{
+		ShaderCompileData	compileData;
+
+		compileData.renderable = renderable;
+		compileData.renderSegment = renderSegment;
+		compileData.shaderData = shaderData;
+		compileData.shaderType = type;
+		compileData.shaderVariant = key.GetShaderVariant();
+		compileData.detailLevel = key.GetDetailLevel();
+		compileData.shadowFlag = key.GetShadowFlag();
+		compileData.shaderSourceFlags = 0;
+		compileData.terrainViewDirection = nullptr;
+
+		BuildStateProcList(&compileData, linkData->shaderStateFlags);
+	}
+	else
+	{
+		geometryShader->Release();
 	}
 
-	return (result);
+	shaderData->Preprocess();
+	return (true);
 }
 
 ShaderResult ShaderAttribute::TestShader(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment) const
@@ -3550,7 +3716,7 @@ ShaderResult ShaderAttribute::TestShader(ShaderType type, const ShaderKey& key,
 	ShaderResult			result;
 
 	ShaderData *shaderDataPtr = nullptr;
-	ShaderData shaderData(key, &shaderDataPtr, kBlendReplace, 0);
+	ShaderData shaderData(key, &shaderDataPtr, renderSegment->GetShaderDataBlendState(renderable, type), renderSegment->GetShaderDataMaterialState(type));
 
 	compileData.renderable = renderable;
 	compileData.renderSegment = renderSegment;
@@ -3600,6 +3766,27 @@ ShaderResult ShaderAttribute::TestShader(ShaderType type, const ShaderKey& key,
 	return (result);
 }
 
+ShaderResult ShaderAttribute::GenerateShaderSource(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment) const
+{
+	ShaderGraph		tempGraph;
+
+	ShaderData *shaderDataPtr = nullptr;
+	ShaderData shaderData(key, &shaderDataPtr, renderSegment->GetShaderDataBlendState(renderable, type), renderSegment->GetShaderDataMaterialState(type));
+
+	CloneShader(&shaderGraph, &tempGraph, true);
+	return (GenerateShaderSource(&tempGraph, type, key, renderable, renderSegment, &shaderData));
+}
+
+ShaderResult ShaderAttribute::GenerateShaderSource(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, ShaderGraph *deadGraph)
+{
+	LinkData	linkData;
+
+	// The shader is prepared without creating any shader or program objects, so this only
+	// stores the source code for both stages in the shader cache.
+
+	return (PrepareShader(graph, type, key, renderable, renderSegment, shaderData, &linkData, false, deadGraph));
+}
+
 ShaderProgram *ShaderAttribute::CompilePostShader(const ShaderGraph *graph, VertexShader *vertexShader)
 {
 	List<Process>			processList;
@@ -3640,17 +3827,17 @@ ShaderProgram *ShaderAttribute::CompilePostShader(const ShaderGraph *graph, Vert
 		FragmentShader *fragmentShader = FragmentShader::Find(signatureStorage);
 		if (!fragmentShader)
 		{
-			int32 length = GenerateShaderProlog(&compileData, &allocData, sourceStorage);
-			char *string = sourceStorage + length;
-
-			GenerateShaderCode(&compileData, &allocData, processData, &processList, string, &length);
-
-			string += length;
-			length = Text::CopyText(FragmentShader::epilogText, string);
-			string[length] = 0;
-
-			unsigned_int32 size = (unsigned_int32) (string + length - sourceStorage);
-			fragmentShader = FragmentShader::New(sourceStorage, size, signatureStorage);
+			const ShaderSource *shaderSource = ShaderCache::FindSource(kShaderStageFragment, signatureStorage);
+			if (shaderSource)
+			{
+				fragmentShader = FragmentShader::New(shaderSource->GetSourceText(), shaderSource->GetSourceSize(), signatureStorage);
+			}
+			else
+			{
+				unsigned_int32 size = GenerateFragmentSource(&compileData, &allocData, processData, &processList, sourceStorage);
+				ShaderCache::AddSource(kShaderStageFragment, signatureStorage, sourceStorage, size);
+				fragmentShader = FragmentShader::New(sourceStorage, size, signatureStorage);
+			}
 		}
 
 		stageTable.vertexShader = vertexShader;
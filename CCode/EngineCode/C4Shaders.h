@@ -198,7 +198,7 @@ namespace C4
 			static void OrganizeDerivedInterpolants(const ShaderCompileData *compileData, ShaderGraph *graph);
 
 			static void OptimizeTextureMaps(const ShaderGraph *graph);
-			static void EliminateDeadCode(const ShaderGraph *graph, List<Process> *terminalList);
+			static void EliminateDeadCode(const ShaderGraph *graph, List<Process> *terminalList, ShaderGraph *deadGraph = nullptr);
 			static void CalculatePathLengths(const ShaderGraph *graph, List<Process> *processList, List<Process> *readyList);
 			static int32 ScheduleShader(const ShaderCompileData *compileData, List<Process> *readyList, List<Process> *scheduleList, unsigned_int32 *shaderSignature);
 
@@ -212,8 +212,11 @@ namespace C4
 			static void GenerateShaderCode(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, const ProcessData *processData, const List<Process> *scheduleList, char *shaderCode, int32 *shaderLength);
 			static int32 GenerateShaderProlog(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, char *shaderCode);
 
+			static unsigned_int32 GenerateFragmentSource(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, const ProcessData *processData, const List<Process> *scheduleList, char *shaderCode);
+
 			static int32 GenerateVertexOutputName(Type type, const ShaderAllocationData *allocData, int32 mask, char *name);
-			static VertexShader *GenerateVertexShader(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, unsigned_int32 *shaderStateFlags);
+			static unsigned_int32 BuildVertexAssembly(const ShaderCompileData *compileData, const ShaderAllocationData *allocData, VertexAssembly *assembly);
+			static unsigned_int32 GenerateVertexSource(const ShaderAllocationData *allocData, const VertexAssembly *assembly, char *shaderCode);
 			static void BuildStateProcList(const ShaderCompileData *compileData, unsigned_int32 shaderStateFlags);
 
 			#if C4OPENGL
@@ -226,6 +229,21 @@ namespace C4
 
 		public:
 
+			// A LinkData structure receives everything that PrepareShader() determines about a shader
+			// that LinkShader() needs later to build the program without processing the shader graph.
+			// The shader object pointers are only set when the shader is prepared on the main thread.
+
+			struct LinkData
+			{
+				unsigned_int32		shaderStateFlags;
+
+				FragmentShader		*fragmentShader;
+				VertexShader		*vertexShader;
+
+				unsigned_int32		vertexSignature[kMaxVertexSnippetCount + 1];
+				unsigned_int32		fragmentSignature[kMaxShaderSignatureSize];
+			};
+
 			static char				sourceStorage[kMaxShaderSourceSize];
 			static unsigned_int32	signatureStorage[kMaxShaderSignatureSize];
 
@@ -254,7 +272,11 @@ namespace C4
 
 			ShaderResult CompileShader(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData) const;
 			static ShaderResult CompileShader(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData);
+			static ShaderResult PrepareShader(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, LinkData *linkData, bool immediate, ShaderGraph *deadGraph = nullptr);
+			static bool LinkShader(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, const LinkData *linkData);
 			C4API ShaderResult TestShader(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment) const;
+			C4API ShaderResult GenerateShaderSource(ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment) const;
+			C4API static ShaderResult GenerateShaderSource(ShaderGraph *graph, ShaderType type, const ShaderKey& key, const Renderable *renderable, const RenderSegment *renderSegment, ShaderData *shaderData, ShaderGraph *deadGraph = nullptr);
 			static ShaderProgram *CompilePostShader(const ShaderGraph *graph, VertexShader *vertexShader);
 
 			C4API static void BuildRegularShaderGraph(const Renderable *renderable, const RenderSegment *renderSegment, const MaterialObject *materialObject, const List<Attribute> *attributeList, ShaderGraph *graph, Process **process);
@@ -107,6 +107,9 @@
 		extern __m128i _mm_unpacklo_epi16(__m128i, __m128i);
 		extern __m128i _mm_unpackhi_epi16(__m128i, __m128i); 
 		extern __m128i _mm_cmplt_epi8(__m128i, __m128i);
+		extern __m128i _mm_cmpeq_epi8(__m128i, __m128i);
+		extern __m128i _mm_set1_epi8(char);
+		extern int _mm_movemask_epi8(__m128i);
 		extern __m128i _mm_cmplt_epi16(__m128i, __m128i);
 		extern __m128 _mm_cvtepi32_ps(__m128i); 
 		extern __m128i _mm_cvtps_epi32(__m128);
@@ -1852,6 +1855,25 @@ namespace C4
 		#endif //]
 	}
 
+	#if C4SSE
+
+		inline vec_int8 VecInt8SmearScalar(int32 value)
+		{
+			return (_mm_set1_epi8((char) value));
+		}
+
+		inline vec_int8 VecInt8MaskCmpeq(const vec_int8& v1, const vec_int8& v2)
+		{
+			return (_mm_cmpeq_epi8(v1, v2));
+		}
+
+		inline unsigned_int32 VecInt8GetSignMask(const vec_int8& v)
+		{
+			return ((unsigned_int32) _mm_movemask_epi8(v));
+		}
+
+	#endif
+
 	inline vec_unsigned_int8 VecUnsignedInt8Load(const unsigned_int8 *ptr, machine offset = 0)
 	{
 		#if C4SSE
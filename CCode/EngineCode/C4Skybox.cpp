@@ -325,6 +325,10 @@ void Skybox::SetMaterialObject(MaterialObject *object)
 {
 	if (materialObject != object)
 	{
+		// The packed data for the node holds the index of the material object.
+
+		InvalidateDeltaPack();
+
 		if (materialObject)
 		{
 			materialObject->Release();
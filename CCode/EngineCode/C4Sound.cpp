@@ -3,6 +3,7 @@
 #include "C4Sound.h"
 #include "C4Engine.h"
 #include "C4Compression.h"
+#include "C4Profiler.h"
 
 
 using namespace C4;
@@ -1213,6 +1214,7 @@ SoundResult SoundLoader::Open(const char *name)
 SoundStreamer::SoundStreamer()
 {
 	streamerState = 0;
+	streamBufferCount = 0;
 	workBuffer = nullptr;
 }
 
@@ -1221,19 +1223,32 @@ SoundStreamer::~SoundStreamer()
 	delete[] workBuffer;
 }
 
-void SoundStreamer::AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize)
+void SoundStreamer::AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize, int32 bufferCount)
 {
 	delete[] workBuffer;
 
+	if (bufferCount == 0)
+	{
+		bufferCount = TheSoundMgr->GetStreamBufferCount();
+	}
+
+	bufferCount = Min(Max(bufferCount, 2), (int32) kMaxStreamBufferCount);
+
 	workBufferSize = workSize;
 	streamBufferSize = streamSize;
+	streamBufferCount = bufferCount;
 
 	workSize = (workSize + 15) & ~15;
 	streamSize = sizeof(StreamBufferHeader) + ((streamSize + 3) & ~3);
 
-	workBuffer = new char[workSize + streamSize * 2];
-	streamBuffer[0] = reinterpret_cast<StreamBufferHeader *>(workBuffer + workSize);
-	streamBuffer[1] = reinterpret_cast<StreamBufferHeader *>(workBuffer + workSize + streamSize);
+	workBuffer = new char[workSize + streamSize * bufferCount];
+	for (machine a = 0; a < bufferCount; a++)
+	{
+		StreamBufferHeader *buffer = reinterpret_cast<StreamBufferHeader *>(workBuffer + workSize + streamSize * a);
+		buffer->readyFlag = false;
+		buffer->finalFlag = false;
+		streamBuffer[a] = buffer;
+	}
 }
 
 void SoundStreamer::ReleaseStreamMemory(void)
@@ -1591,6 +1606,7 @@ Sound::Sound()
 	tableIndex = -1;
 	soundState = kSoundUnloaded;
 	mainReleaseFlag = false;
+	streamQueueFlags = 0;
 
 	startTime = 0;
 	loopCount = 0;
@@ -1636,15 +1652,18 @@ Sound::~Sound()
 
 void Sound::Release(void)
 {
-	if (tableIndex < 0)
+	if ((tableIndex < 0) && (streamQueueFlags == 0))
 	{
 		delete this;
 	}
 	else
 	{
+		// A sound that is not in the active sound table can still be waiting for a stream worker to
+		// finish with it. In that case, the mixer has nothing to release, and only the stream is waited on.
+
 		soundState = kSoundReleased;
 		streamReleaseFlag = (soundStreamer == nullptr);
-		mixerReleaseFlag = false;
+		mixerReleaseFlag = (tableIndex < 0);
 
 		Thread::Fence();
 		mainReleaseFlag = true;
@@ -1782,6 +1801,81 @@ void Sound::FillStreamBuffer(SoundStreamer *streamer, StreamBufferHeader *buffer
 	buffer->readyFlag = true;
 }
 
+void Sound::FillStreamBuffers(void)
+{
+	// Buffers are filled in ring order starting with the one after the last buffer filled. Filling stops
+	// at the first buffer that the mixer hasn't finished with yet or after the final buffer of the stream.
+
+	SoundStreamer *streamer = soundStreamer;
+	int32 bufferCount = streamer->GetStreamBufferCount();
+	int32 bufferIndex = fillBuffer;
+
+	while ((!streamFinalFlag) && (soundState == kSoundPlaying))
+	{
+		StreamBufferHeader *buffer = streamer->GetStreamBuffer(bufferIndex);
+		if (buffer->readyFlag)
+		{
+			break;
+		}
+
+		FillStreamBuffer(streamer, buffer);
+		streamFinalFlag = buffer->finalFlag;
+
+		if (++bufferIndex == bufferCount)
+		{
+			bufferIndex = 0;
+		}
+	}
+
+	fillBuffer = bufferIndex;
+}
+
+SoundResult Sound::StartStream(void)
+{
+	SoundResult result = soundStreamer->StartStream();
+	if (result != kSoundOkay)
+	{
+		return (result);
+	}
+
+	channelCount = soundStreamer->GetStreamChannelCount();
+	sampleRate = soundStreamer->GetStreamSampleRate();
+	sampleFrequency = sampleRate / (float) kSoundOutputSampleRate;
+
+	ResetStreamBuffers();
+
+	if (channelCount == 1)
+	{
+		soundMixData.sampleTableIndex = 0;
+		float sample = (float) ReadLittleEndianS16(soundStreamer->GetStreamBuffer(0)->GetSampleData());
+		soundMixData.sampleTableSum = sample * (float) kSampleHistoryCount;
+
+		for (machine a = 0; a < kSampleHistoryCount; a++)
+		{
+			soundMixData.sampleTable[a] = sample;
+		}
+	}
+
+	return (kSoundOkay);
+}
+
+void Sound::ResetStreamBuffers(void)
+{
+	playBuffer = 0;
+	fillBuffer = 0;
+
+	streamFinalFlag = false;
+	streamStarvedFlag = true;
+
+	int32 bufferCount = soundStreamer->GetStreamBufferCount();
+	for (machine a = 0; a < bufferCount; a++)
+	{
+		StreamBufferHeader *bufferHeader = soundStreamer->GetStreamBuffer(a);
+		bufferHeader->readyFlag = false;
+		bufferHeader->finalFlag = false;
+	}
+}
+
 SoundResult Sound::Play(void)
 {
 	SoundResult result = kSoundOkay;
@@ -1800,33 +1894,15 @@ SoundResult Sound::Play(void)
 
 		if (soundStreamer)
 		{
-			result = soundStreamer->StartStream();
-			if (result != kSoundOkay)
-			{
-				return (result);
-			}
-
-			channelCount = soundStreamer->GetStreamChannelCount();
-			sampleRate = soundStreamer->GetStreamSampleRate();
-			sampleFrequency = sampleRate / (float) kSoundOutputSampleRate;
+			// A stream worker may still be filling a buffer for the stream after it was stopped. In that
+			// case, the worker restarts the stream when it's done, and the mixer skips the stream until then.
 
-			playBuffer = 0;
-			StreamBufferHeader *bufferHeader1 = soundStreamer->GetStreamBuffer(0);
-			StreamBufferHeader *bufferHeader2 = soundStreamer->GetStreamBuffer(1);
-			bufferHeader1->readyFlag = false;
-			bufferHeader1->finalFlag = false;
-			bufferHeader2->readyFlag = false;
-			bufferHeader2->finalFlag = false;
-
-			if (channelCount == 1)
+			if (TheSoundMgr->ClaimStream(this))
 			{
-				soundMixData.sampleTableIndex = 0;
-				float sample = (float) ReadLittleEndianS16(soundStreamer->GetStreamBuffer(0)->GetSampleData());
-				soundMixData.sampleTableSum = sample * (float) kSampleHistoryCount;
-
-				for (machine a = 0; a < kSampleHistoryCount; a++)
+				result = StartStream();
+				if (result != kSoundOkay)
 				{
-					soundMixData.sampleTable[a] = sample;
+					return (result);
 				}
 			}
 		}
@@ -1888,6 +1964,11 @@ SoundResult Sound::Play(void)
 		{
 			soundState = kSoundPlaying;
 		}
+
+		if ((soundStreamer) && (soundState == kSoundPlaying))
+		{
+			TheSoundMgr->QueueStream(this);
+		}
 	}
 
 	return (result);
@@ -1948,6 +2029,14 @@ void Sound::Resume(void)
 		if (--pauseCount == 0)
 		{
 			soundState = kSoundPlaying;
+
+			// Buffers are not filled while a stream is paused, so any that were
+			// played before the pause still need to be filled.
+
+			if (soundStreamer)
+			{
+				TheSoundMgr->QueueStream(this);
+			}
 		}
 	}
 	else if (soundState == kSoundDelayPaused)
@@ -2243,7 +2332,9 @@ int32 Sound::GetDuration(void) const
 }
 
 
-SoundMgr::SoundMgr(int) : soundReverbObserver(this, &SoundMgr::HandleSoundReverbEvent)
+SoundMgr::SoundMgr(int) :
+		soundReverbObserver(this, &SoundMgr::HandleSoundReverbEvent),
+		soundStreamDepthObserver(this, &SoundMgr::HandleSoundStreamDepthEvent)
 {
 }
 
@@ -2281,7 +2372,15 @@ EngineResult SoundMgr::Construct(void)
 		activeSoundTable[a] = nullptr;
 	}
 
+	streamExitFlag = false;
+	streamQueueStart = 0;
+	streamQueueCount = 0;
+	streamBufferCount = kDefaultStreamBufferCount;
+	streamUnderrunCount = 0;
+	streamWorkerCount = 0;
+
 	TheEngine->InitVariable("soundReverb", "1", kVariablePermanent, &soundReverbObserver);
+	TheEngine->InitVariable("soundStreamDepth", "3", kVariablePermanent, &soundStreamDepthObserver);
 
 	#if C4RECORDABLE
 
@@ -2289,6 +2388,17 @@ EngineResult SoundMgr::Construct(void)
 
 	#endif
 
+	nullDeviceFlag = ((TheEngine->GetEngineFlags() & kEngineHeadless) != 0);
+	if (nullDeviceFlag)
+	{
+		// A headless Sound Manager does not open an output device or start the mixer thread. Sounds are
+		// never added to the active sound table, so they complete immediately. The stream workers are still
+		// started so that streamers can be exercised without an output device.
+
+		StartStreamWorkers();
+		return (kSoundOkay);
+	}
+
 	#if C4XAUDIO
 
 		WAVEFORMATEX	format;
@@ -2494,9 +2604,7 @@ EngineResult SoundMgr::Construct(void)
 
 	#endif //]
 
-	new(streamSignal) Signal(2);
-	new(streamThread) Thread(&StreamThread, this, 0, streamSignal);
-
+	StartStreamWorkers();
 	return (kSoundOkay);
 }
 
@@ -2504,8 +2612,20 @@ void SoundMgr::Destruct(void)
 {
 	StopRecording();
 
-	streamThread->~Thread();
-	streamSignal->~Signal();
+	if (nullDeviceFlag)
+	{
+		StopStreamWorkers();
+
+		delete[] reinterpret_cast<char *>(stereoRingBuffer);
+
+		releasedRoomList.Purge();
+		loadedSoundList.Purge();
+
+		TheResourceMgr->ReleaseCache(SoundResource::GetDescriptor());
+		return;
+	}
+
+	StopStreamWorkers();
 
 	#if C4XAUDIO
 
@@ -2611,6 +2731,11 @@ void SoundMgr::HandleSoundReverbEvent(Variable *variable)
 	soundOptionFlags = flags;
 }
 
+void SoundMgr::HandleSoundStreamDepthEvent(Variable *variable)
+{
+	SetStreamBufferCount(variable->GetIntegerValue());
+}
+
 int32 SoundMgr::MixStereoSamples_Mono_Constant(SoundMixData *mixData, const Sample *input, int32 inputFrameCount, int32& inputOffset, int32 outputFrameCount, int32 outputOffset)
 {
 	float directVolumeLeft = mixData->directVolumeCurrent[0];
@@ -3431,11 +3556,20 @@ void SoundMgr::MixSoundStereo(Sound *sound, int32 outputOffset)
 
 void SoundMgr::MixSoundStreamMono(Sound *sound, int32 outputOffset)
 {
+	// The buffers are stale until a stream worker has finished restarting the stream.
+
+	if (sound->streamQueueFlags & (kSoundStreamRestart | kSoundStreamRestarting))
+	{
+		return;
+	}
+
 	int32 bufferIndex = sound->playBuffer;
 	StreamBufferHeader *header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
 
 	if (header->readyFlag)
 	{
+		sound->streamStarvedFlag = false;
+
 		const Sample *input = header->GetSampleData();
 		int32 inputFrameCount = header->frameCount;
 		int32 inputOffset = sound->playFrame;
@@ -3473,12 +3607,9 @@ void SoundMgr::MixSoundStreamMono(Sound *sound, int32 outputOffset)
 						break;
 					}
 
-					header->readyFlag = false;
-					bufferIndex = 1 - bufferIndex;
 					inputOffset = 0;
-
-					header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
-					if (!header->readyFlag)
+					header = AdvanceStreamBuffer(sound, bufferIndex);
+					if (!header)
 					{
 						break;
 					}
@@ -3520,12 +3651,9 @@ void SoundMgr::MixSoundStreamMono(Sound *sound, int32 outputOffset)
 						break;
 					}
 
-					header->readyFlag = false;
-					bufferIndex = 1 - bufferIndex;
 					inputOffset = 0;
-
-					header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
-					if (!header->readyFlag)
+					header = AdvanceStreamBuffer(sound, bufferIndex);
+					if (!header)
 					{
 						break;
 					}
@@ -3539,15 +3667,26 @@ void SoundMgr::MixSoundStreamMono(Sound *sound, int32 outputOffset)
 		sound->playFrame = inputOffset;
 		sound->playBuffer = bufferIndex;
 	}
+	else
+	{
+		CountStreamUnderrun(sound);
+	}
 }
 
 void SoundMgr::MixSoundStreamStereo(Sound *sound, int32 outputOffset)
 {
+	if (sound->streamQueueFlags & (kSoundStreamRestart | kSoundStreamRestarting))
+	{
+		return;
+	}
+
 	int32 bufferIndex = sound->playBuffer;
 	StreamBufferHeader *header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
 
 	if (header->readyFlag)
 	{
+		sound->streamStarvedFlag = false;
+
 		const Sample *input = header->GetSampleData();
 		int32 inputFrameCount = header->frameCount;
 		int32 inputOffset = sound->playFrame;
@@ -3579,12 +3718,9 @@ void SoundMgr::MixSoundStreamStereo(Sound *sound, int32 outputOffset)
 						break;
 					}
 
-					header->readyFlag = false;
-					bufferIndex = 1 - bufferIndex;
 					inputOffset = 0;
-
-					header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
-					if (!header->readyFlag)
+					header = AdvanceStreamBuffer(sound, bufferIndex);
+					if (!header)
 					{
 						break;
 					}
@@ -3620,12 +3756,9 @@ void SoundMgr::MixSoundStreamStereo(Sound *sound, int32 outputOffset)
 						break;
 					}
 
-					header->readyFlag = false;
-					bufferIndex = 1 - bufferIndex;
 					inputOffset = 0;
-
-					header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
-					if (!header->readyFlag)
+					header = AdvanceStreamBuffer(sound, bufferIndex);
+					if (!header)
 					{
 						break;
 					}
@@ -3639,6 +3772,10 @@ void SoundMgr::MixSoundStreamStereo(Sound *sound, int32 outputOffset)
 		sound->playFrame = inputOffset;
 		sound->playBuffer = bufferIndex;
 	}
+	else
+	{
+		CountStreamUnderrun(sound);
+	}
 }
 
 void SoundMgr::MixRoomEffects(const SoundRoom *soundRoom, RoomMixBuffer *mixBuffer, int32 outputOffset)
@@ -3745,6 +3882,12 @@ int32 SoundMgr::AllocateSoundRoomMixBuffer(SoundRoom *soundRoom)
 
 void SoundMgr::MixSounds(OutputSample *outputSample)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("SoundMgr::MixSounds");
+
+	#endif
+
 	bool reverbFlag = ((soundOptionFlags & kSoundOptionReverb) != 0);
 	if (reverbFlag)
 	{
@@ -4057,6 +4200,12 @@ void SoundMgr::OutputSoundData(float *inputSample, OutputSample *outputSample)
 	{
 		Thread::SetThreadName("C4-SD Mixer");
 
+		#if C4PROFILE
+
+			Profiler::RegisterThread("Sound Mixer");
+
+		#endif
+
 		SoundMgr *soundMgr = static_cast<SoundMgr *>(cookie);
 
 		for (;;)
@@ -4121,6 +4270,12 @@ void SoundMgr::OutputSoundData(float *inputSample, OutputSample *outputSample)
 	{
 		Thread::SetThreadName("C4-SD Mixer");
 
+		#if C4PROFILE
+
+			Profiler::RegisterThread("Sound Mixer");
+
+		#endif
+
 		SoundMgr *soundMgr = static_cast<SoundMgr *>(cookie);
 
 		for (;;)
@@ -4228,49 +4383,231 @@ void SoundMgr::SetListenerRoom(SoundRoom *room)
 	}
 }
 
+void SoundMgr::SetStreamBufferCount(int32 count)
+{
+	streamBufferCount = Min(Max(count, 2), (int32) kMaxStreamBufferCount);
+}
+
+SoundMgr::StreamWorker::StreamWorker(SoundMgr *mgr) : soundMgr(mgr), thread(&StreamThread, this, 0, &signal)
+{
+}
+
+SoundMgr::StreamWorker::~StreamWorker()
+{
+}
+
+void SoundMgr::StartStreamWorkers(void)
+{
+	int32 count = Min(Max(TheEngine->GetProcessorCount() / 2, 1), (int32) kMaxStreamWorkerCount);
+	streamWorkerCount = count;
+
+	for (machine a = 0; a < count; a++)
+	{
+		new(streamWorker[a]) StreamWorker(this);
+		streamWaitList.Append(streamWorker[a]);
+	}
+}
+
+void SoundMgr::StopStreamWorkers(void)
+{
+	streamExitFlag = true;
+
+	for (machine a = streamWorkerCount - 1; a >= 0; a--)
+	{
+		streamWorker[a]->~StreamWorker();
+	}
+
+	streamWorkerCount = 0;
+}
+
 void SoundMgr::StreamThread(const Thread *thread, void *cookie)
 {
 	Thread::SetThreadName("C4-SD Stream");
 
-	SoundMgr *soundMgr = static_cast<SoundMgr *>(cookie);
+	StreamWorker *worker = static_cast<StreamWorker *>(cookie);
+	SoundMgr *soundMgr = worker->soundMgr;
 
 	for (;;)
 	{
-		for (machine a = 0; a < kMaxSoundCount; a++)
+		thread->GetThreadSignal()->Wait();
+		if (soundMgr->streamExitFlag)
+		{
+			break;
+		}
+
+		soundMgr->streamMutex.Acquire();
+
+		while (soundMgr->streamQueueCount != 0)
 		{
-			Sound *sound = soundMgr->activeSoundTable[a];
-			if (sound)
+			int32 start = soundMgr->streamQueueStart;
+			Sound *sound = soundMgr->streamQueue[start];
+			soundMgr->streamQueueStart = (start + 1) % kStreamQueueSize;
+			soundMgr->streamQueueCount--;
+
+			sound->streamQueueFlags = kSoundStreamFilling;
+			soundMgr->streamMutex.Release();
+
+			sound->FillStreamBuffers();
+
+			soundMgr->streamMutex.Acquire();
+
+			// If the sound was played again while its buffers were being filled, then the stream is
+			// restarted here because no other thread can be calling the streamer at this point.
+
+			while (sound->streamQueueFlags & kSoundStreamRestart)
 			{
-				if (sound->soundState == kSoundPlaying)
-				{
-					if (sound->Streaming())
-					{
-						SoundStreamer *streamer = sound->GetSoundStreamer();
-						StreamBufferHeader *buffer1 = streamer->GetStreamBuffer(0);
-						StreamBufferHeader *buffer2 = streamer->GetStreamBuffer(1);
+				sound->streamQueueFlags = kSoundStreamFilling | kSoundStreamRestarting;
+				soundMgr->streamMutex.Release();
 
-						if ((!buffer1->readyFlag) && (!buffer2->finalFlag))
-						{
-							sound->FillStreamBuffer(streamer, buffer1);
-						}
+				bool started = (sound->StartStream() == kSoundOkay);
 
-						if ((!buffer2->readyFlag) && (!buffer1->finalFlag))
-						{
-							sound->FillStreamBuffer(streamer, buffer2);
-						}
-					}
+				soundMgr->streamMutex.Acquire();
+
+				if (started)
+				{
+					sound->streamQueueFlags |= kSoundStreamRefill;
 				}
-				else if (sound->mainReleaseFlag)
+				else
 				{
-					sound->streamReleaseFlag = true;
+					sound->ResetStreamBuffers();
+					sound->soundState = kSoundCompleted;
+					sound->waitMixStamp = soundMgr->soundMixStamp;
 				}
 			}
+
+
+			// If the mixer played another buffer while this one was being filled, then the sound goes
+			// to the back of the queue so that a slow stream can't hold up the streams waiting behind it.
+
+			if ((sound->streamQueueFlags & kSoundStreamRefill) && (sound->soundState == kSoundPlaying))
+			{
+				sound->streamQueueFlags = kSoundStreamQueued;
+				soundMgr->streamQueue[(soundMgr->streamQueueStart + soundMgr->streamQueueCount) % kStreamQueueSize] = sound;
+				soundMgr->streamQueueCount++;
+			}
+			else
+			{
+				sound->streamQueueFlags = 0;
+			}
 		}
 
-		if (soundMgr->streamSignal->Wait() == 0)
+		soundMgr->streamWaitList.Append(worker);
+		soundMgr->streamMutex.Release();
+	}
+}
+
+bool SoundMgr::ClaimStream(Sound *sound)
+{
+	// If a worker is filling the sound's buffers, then a restart is requested and false is returned.
+	// Otherwise, any entry for the sound that is still in the queue is removed so that no worker
+	// can call its streamer, and true is returned to indicate that the caller can restart the stream.
+
+	bool result = true;
+	streamMutex.Acquire();
+
+	unsigned_int32 flags = sound->streamQueueFlags;
+	if (flags & kSoundStreamFilling)
+	{
+		sound->streamQueueFlags = flags | kSoundStreamRestart;
+		result = false;
+	}
+	else if (flags & kSoundStreamQueued)
+	{
+		int32 start = streamQueueStart;
+		int32 count = streamQueueCount;
+		for (machine a = 0; a < count; a++)
 		{
-			break;
+			if (streamQueue[(start + a) % kStreamQueueSize] == sound)
+			{
+				for (machine b = a + 1; b < count; b++)
+				{
+					streamQueue[(start + b - 1) % kStreamQueueSize] = streamQueue[(start + b) % kStreamQueueSize];
+				}
+
+				streamQueueCount = count - 1;
+				break;
+			}
 		}
+
+		sound->streamQueueFlags = 0;
+	}
+
+	streamMutex.Release();
+	return (result);
+}
+
+void SoundMgr::QueueStream(Sound *sound)
+{
+	// A sound is never in the queue more than once, and it is never in the queue while a worker is
+	// filling its buffers, so at most one worker calls its streamer at a time. Only sounds in the
+	// active sound table are queued, so the queue can't overflow.
+
+	streamMutex.Acquire();
+
+	unsigned_int32 flags = sound->streamQueueFlags;
+	if (flags & kSoundStreamFilling)
+	{
+		sound->streamQueueFlags = flags | kSoundStreamRefill;
+	}
+	else if (!(flags & kSoundStreamQueued))
+	{
+		sound->streamQueueFlags = kSoundStreamQueued;
+		streamQueue[(streamQueueStart + streamQueueCount) % kStreamQueueSize] = sound;
+		streamQueueCount++;
+
+		StreamWorker *worker = streamWaitList.First();
+		if (worker)
+		{
+			streamWaitList.Remove(worker);
+			worker->signal.Trigger();
+		}
+	}
+
+	streamMutex.Release();
+}
+
+void SoundMgr::ReleaseStream(Sound *sound)
+{
+	// This is called only after the mixer has let go of the sound, so it can't be queued again.
+
+	streamMutex.Acquire();
+
+	if (sound->streamQueueFlags == 0)
+	{
+		sound->streamReleaseFlag = true;
+	}
+
+	streamMutex.Release();
+}
+
+StreamBufferHeader *SoundMgr::AdvanceStreamBuffer(Sound *sound, int32& bufferIndex)
+{
+	const SoundStreamer *streamer = sound->GetSoundStreamer();
+	streamer->GetStreamBuffer(bufferIndex)->readyFlag = false;
+
+	if (++bufferIndex == streamer->GetStreamBufferCount())
+	{
+		bufferIndex = 0;
+	}
+
+	QueueStream(sound);
+
+	StreamBufferHeader *header = streamer->GetStreamBuffer(bufferIndex);
+	if (!header->readyFlag)
+	{
+		CountStreamUnderrun(sound);
+		return (nullptr);
+	}
+
+	return (header);
+}
+
+void SoundMgr::CountStreamUnderrun(Sound *sound)
+{
+	if (!sound->streamStarvedFlag)
+	{
+		sound->streamStarvedFlag = true;
+		AtomicAdd(&streamUnderrunCount, 1);
 	}
 }
 
@@ -4278,7 +4615,7 @@ EngineResult SoundMgr::StartRecording(const char *name)
 {
 	#if C4RECORDABLE
 
-		if (!recordFlag)
+		if ((!recordFlag) && (!nullDeviceFlag))
 		{
 			FileMgr::CreateDirectoryPath(name);
 
@@ -4401,6 +4738,11 @@ int32 SoundMgr::AddSound(Sound *sound)
 	int32 lowerReplaceIndex = -1;
 	int32 equalReplaceIndex = -1;
 
+	if (nullDeviceFlag)
+	{
+		return (-1);
+	}
+
 	const SoundResource *soundResource = sound->GetSoundResource();
 
 	for (machine a = 0; a < kMaxSoundCount; a++)
@@ -4508,18 +4850,6 @@ void SoundMgr::SoundTask(void)
 
 				case kSoundPlaying:
 				{
-					if (sound->Streaming())
-					{
-						const SoundStreamer *streamer = sound->GetSoundStreamer();
-						StreamBufferHeader *buffer1 = streamer->GetStreamBuffer(0);
-						StreamBufferHeader *buffer2 = streamer->GetStreamBuffer(1);
-
-						if ((!buffer1->readyFlag) || (!buffer2->readyFlag))
-						{
-							streamSignal->Trigger(1);
-						}
-					}
-
 					if (sound->loopFlag)
 					{
 						sound->loopFlag = false;
@@ -4632,7 +4962,7 @@ void SoundMgr::SoundTask(void)
 
 				case kSoundCompleted:
 
-					if (soundMixStamp - sound->waitMixStamp >= 0)
+					if ((soundMixStamp - sound->waitMixStamp >= 0) && (sound->streamQueueFlags == 0))
 					{
 						sound->soundState = kSoundStopped;
 
@@ -4668,9 +4998,9 @@ void SoundMgr::SoundTask(void)
 				delete sound;
 			}
 		}
-		else
+		else if (sound->mixerReleaseFlag)
 		{
-			streamSignal->Trigger(1);
+			ReleaseStream(sound);
 		}
 
 		sound = next;
@@ -4690,4 +5020,106 @@ void SoundMgr::SoundTask(void)
 	}
 }
 
+
+#if C4STATS
+
+	int32 SoundMgr::StressTestStreaming(int32 streamCount, Sound *const *soundTable, int32 blockCount)
+	{
+		// The sounds are played without being added to the active sound table, and this function takes
+		// the place of the mixer by consuming one output block from each stream at the real output rate.
+		// Stream buffers are advanced by the same code that the mixer uses, so underruns are counted
+		// exactly as they would be during normal playback.
+
+		int32 underrunCount = streamUnderrunCount;
+
+		for (machine a = 0; a < streamCount; a++)
+		{
+			Sound *sound = soundTable[a];
+			if (sound->GetSoundStreamer()->StartStream() == kSoundOkay)
+			{
+				sound->playFrame = 0;
+				sound->ResetStreamBuffers();
+				sound->soundState = kSoundPlaying;
+				QueueStream(sound);
+			}
+		}
+
+		unsigned_int64 blockTime = (unsigned_int64) kOutputBufferFrameCount * 1000000 / kSoundOutputSampleRate;
+		unsigned_int64 startTime = TheTimeMgr->GetMicrosecondCount();
+
+		for (machine block = 0; block < blockCount; block++)
+		{
+			for (machine a = 0; a < streamCount; a++)
+			{
+				Sound *sound = soundTable[a];
+				if (sound->soundState != kSoundPlaying)
+				{
+					continue;
+				}
+
+				int32 bufferIndex = sound->playBuffer;
+				StreamBufferHeader *header = sound->GetSoundStreamer()->GetStreamBuffer(bufferIndex);
+
+				if (header->readyFlag)
+				{
+					sound->streamStarvedFlag = false;
+
+					int32 inputOffset = sound->playFrame;
+					int32 outputFrameCount = kOutputBufferFrameCount;
+
+					do
+					{
+						int32 frameCount = Min((int32) header->frameCount - inputOffset, outputFrameCount);
+						inputOffset += frameCount;
+						outputFrameCount -= frameCount;
+
+						if (inputOffset >= (int32) header->frameCount)
+						{
+							if (header->finalFlag)
+							{
+								sound->soundState = kSoundCompleted;
+								break;
+							}
+
+							inputOffset = 0;
+							header = AdvanceStreamBuffer(sound, bufferIndex);
+							if (!header)
+							{
+								break;
+							}
+						}
+					} while (outputFrameCount > 0);
+
+					sound->playFrame = inputOffset;
+					sound->playBuffer = bufferIndex;
+				}
+				else
+				{
+					CountStreamUnderrun(sound);
+				}
+			}
+
+			int64 wait = (int64) (startTime + blockTime * (block + 1) - TheTimeMgr->GetMicrosecondCount());
+			if (wait >= 1000)
+			{
+				Thread::Sleep((unsigned_int32) (wait / 1000));
+			}
+		}
+
+		for (machine a = 0; a < streamCount; a++)
+		{
+			Sound *sound = soundTable[a];
+			sound->soundState = kSoundStopped;
+
+			while (sound->streamQueueFlags != 0)
+			{
+				Thread::Yield();
+			}
+		}
+
+		return (streamUnderrunCount - underrunCount);
+	}
+
+#endif
+
 // ZYUQURM
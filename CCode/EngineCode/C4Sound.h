@@ -77,7 +77,9 @@ namespace C4
 	{
 		kMaxSoundCount				= 64,
 		kMaxRoomCount				= 4,
-		kMaxSoundPathCount			= 4
+		kMaxSoundPathCount			= 4,
+		kMaxStreamBufferCount		= 8,
+		kMaxStreamWorkerCount		= 4
 	};
 
 
@@ -107,7 +109,9 @@ namespace C4
 		kSoundReflectionCount		= 6,
 		kRoomFeedbackBufferCount	= 4, 
 		kSampleHistoryCount			= 64,
-		kStreamBufferSize			= 262144
+		kStreamBufferSize			= 262144,
+		kDefaultStreamBufferCount	= 3,
+		kStreamQueueSize			= kMaxSoundCount * 2
 	}; 
 
  
@@ -201,6 +205,16 @@ namespace C4
 	};
 
 
+	enum
+	{
+		kSoundStreamQueued		= 1 << 0,
+		kSoundStreamFilling		= 1 << 1,
+		kSoundStreamRefill		= 1 << 2,
+		kSoundStreamRestart		= 1 << 3,
+		kSoundStreamRestarting	= 1 << 4
+	};
+
+
 	struct SoundResourceHeader
 	{
 		int32					endian;
@@ -600,10 +614,11 @@ namespace C4
 
 	//# \function	SoundStreamer::AllocateStreamMemory		Allocates memory for use by the streamer object.
 	//
-	//# \proto	void AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize);
+	//# \proto	void AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize, int32 bufferCount = 0);
 	//
-	//# \param	workSize	The size of the streamer's work buffer.
-	//# \param	streamSize	The size of each decompressed output buffer.
+	//# \param	workSize		The size of the streamer's work buffer.
+	//# \param	streamSize		The size of each decompressed output buffer.
+	//# \param	bufferCount		The number of output buffers. If this is zero, then the read-ahead depth returned by the $@SoundMgr::GetStreamBufferCount@$ function is used.
 	//
 	//# \desc
 	//# A streamer object should call the $AllocateStreamMemory$ to allocate the memory that it needs
@@ -611,6 +626,11 @@ namespace C4
 	//# and it's size is specified by the $workSize$ parameter. A streamer object has at least two stream
 	//# buffers, and the size of each is specified by the $streamSize$ parameter. The stream buffers are where
 	//# the decompressed audio data is written when the Sound Manager calls the $@SoundStreamer::FillBuffer@$ function.
+	//#
+	//# The stream buffers are played in a ring, and the Sound Manager refills each one as soon as it has been played.
+	//# Additional buffers let a stream tolerate longer delays in the $@SoundStreamer::FillBuffer@$ function at the
+	//# cost of memory and latency. Streamers that produce audio in real time, such as voice chat, should pass 2 for
+	//# the $bufferCount$ parameter. The number of buffers is clamped to the range [2, $kMaxStreamBufferCount$].
 	//
 	//# \also	$@SoundStreamer::FillBuffer@$
 	//# \also	$@SoundStreamer::GetWorkBufferSize@$
@@ -685,9 +705,11 @@ namespace C4
 	//# and it should be $false$ if the end of the stream has been reached.
 	//
 	//# \special
-	//# The $FillBuffer$ function can be called in the main thread or in a special streaming thread maintained by the
+	//# The $FillBuffer$ function can be called in the main thread or in any of the streaming threads maintained by the
 	//# Sound Manager. The implementation of this function should not make any assumptions about which thread it's
-	//# running in, and it should take care to use proper multithreaded synchronization where necessary.
+	//# running in, and it should take care to use proper multithreaded synchronization where necessary. The Sound Manager
+	//# never calls the $FillBuffer$ function for the same streamer in two threads at once, but different streamers are
+	//# filled in parallel.
 	//
 	//# \also	$@SoundStreamer::StartStream@$
 	//# \also	$@SoundStreamer::StartStreamComponent@$
@@ -705,9 +727,10 @@ namespace C4
 
 			unsigned_int32			workBufferSize;
 			unsigned_int32			streamBufferSize;
+			int32					streamBufferCount;
 
 			char					*workBuffer;
-			StreamBufferHeader		*streamBuffer[2];
+			StreamBufferHeader		*streamBuffer[kMaxStreamBufferCount];
 
 		protected:
 
@@ -743,7 +766,7 @@ namespace C4
 				return (workBuffer);
 			}
 
-			C4API void AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize);
+			C4API void AllocateStreamMemory(unsigned_int32 workSize, unsigned_int32 streamSize, int32 bufferCount = 0);
 			C4API void ReleaseStreamMemory(void);
 
 		public:
@@ -770,6 +793,11 @@ namespace C4
 				return (streamBufferSize);
 			}
 
+			int32 GetStreamBufferCount(void) const
+			{
+				return (streamBufferCount);
+			}
+
 			StreamBufferHeader *GetStreamBuffer(int32 index) const
 			{
 				return (streamBuffer[index]);
@@ -1769,6 +1797,10 @@ namespace C4
 			volatile bool				mixerReleaseFlag;
 			volatile bool				streamReleaseFlag;
 
+			volatile unsigned_int32		streamQueueFlags;
+			bool						streamFinalFlag;
+			bool						streamStarvedFlag;
+
 			volatile bool				mixFlag;
 			volatile bool				loopFlag;
 			volatile int32				waitMixStamp;
@@ -1781,6 +1813,7 @@ namespace C4
 
 			int32						playFrame;
 			int32						playBuffer;
+			int32						fillBuffer;
 
 			int32						channelCount;
 			int32						sampleRate;
@@ -1814,7 +1847,10 @@ namespace C4
 
 			~Sound();
 
+			SoundResult StartStream(void);
+			void ResetStreamBuffers(void);
 			void FillStreamBuffer(SoundStreamer *streamer, StreamBufferHeader *buffer);
+			void FillStreamBuffers(void);
 
 			float CalculateVolume(float distance) const;
 
@@ -2346,6 +2382,49 @@ namespace C4
 	//# \also	$@MovieMgr/MovieMgr::StopRecording@$
 
 
+	//# \function	SoundMgr::GetStreamBufferCount		Returns the default read-ahead depth for streaming sounds.
+	//
+	//# \proto	int32 GetStreamBufferCount(void) const;
+	//
+	//# \desc
+	//# The $GetStreamBufferCount$ function returns the number of stream buffers allocated by sound streamers that do
+	//# not specify their own buffer count. The default value is $kDefaultStreamBufferCount$, and it can also be
+	//# changed with the $soundStreamDepth$ system variable.
+	//
+	//# \also	$@SoundMgr::SetStreamBufferCount@$
+	//# \also	$@SoundStreamer::AllocateStreamMemory@$
+
+
+	//# \function	SoundMgr::SetStreamBufferCount		Sets the default read-ahead depth for streaming sounds.
+	//
+	//# \proto	void SetStreamBufferCount(int32 count);
+	//
+	//# \param	count	The number of stream buffers. This is clamped to the range [2, $kMaxStreamBufferCount$].
+	//
+	//# \desc
+	//# The $SetStreamBufferCount$ function sets the number of stream buffers allocated by sound streamers that do
+	//# not specify their own buffer count. A larger count lets a stream survive a longer disk stall before it runs
+	//# out of audio data. The new count takes effect the next time a streamer allocates its memory, so it does not
+	//# change the depth of streams that are already playing.
+	//
+	//# \also	$@SoundMgr::GetStreamBufferCount@$
+	//# \also	$@SoundMgr::GetStreamUnderrunCount@$
+	//# \also	$@SoundStreamer::AllocateStreamMemory@$
+
+
+	//# \function	SoundMgr::GetStreamUnderrunCount	Returns the number of times a streaming sound ran out of audio data.
+	//
+	//# \proto	int32 GetStreamUnderrunCount(void) const;
+	//
+	//# \desc
+	//# The $GetStreamUnderrunCount$ function returns the total number of underruns that have occurred since the
+	//# Sound Manager was initialized. An underrun is counted once each time the mixer reaches a stream buffer that
+	//# has not been filled yet, and the stream stays silent until the buffer is ready. The wait for the first buffer
+	//# of a stream that has just started playing is not counted.
+	//
+	//# \also	$@SoundMgr::SetStreamBufferCount@$
+
+
 	class SoundMgr : public Manager<SoundMgr>
 	{
 		friend class Sound;
@@ -2356,6 +2435,17 @@ namespace C4
 
 			typedef int32 (SoundMgr::*MixProc)(SoundMixData *, const Sample *, int32, int32&, int32, int32);
 
+			struct StreamWorker : ListElement<StreamWorker>
+			{
+				SoundMgr	*soundMgr;
+
+				Signal		signal;
+				Thread		thread;
+
+				StreamWorker(SoundMgr *mgr);
+				~StreamWorker();
+			};
+
 			#if C4XAUDIO
 
 				struct VoiceCallback : IXAudio2VoiceCallback
@@ -2422,9 +2512,21 @@ namespace C4
 
 			#endif //]
 
-			Storage<Signal>					streamSignal;
-			Storage<Thread>					streamThread;
+			volatile bool					streamExitFlag;
+			Mutex							streamMutex;
+			List<StreamWorker>				streamWaitList;
+
+			int32							streamQueueStart;
+			int32							streamQueueCount;
+			Sound							*streamQueue[kStreamQueueSize];
+
+			int32							streamBufferCount;
+			volatile int32					streamUnderrunCount;
+
+			int32							streamWorkerCount;
+			Storage<StreamWorker>			streamWorker[kMaxStreamWorkerCount];
 
+			bool							nullDeviceFlag;
 			unsigned_int32					soundOptionFlags;
 
 			float							masterVolume;
@@ -2451,6 +2553,7 @@ namespace C4
 			SoundRoom						*activeRoomTable[kMaxRoomCount];
 
 			VariableObserver<SoundMgr>		soundReverbObserver;
+			VariableObserver<SoundMgr>		soundStreamDepthObserver;
 
 			#if C4RECORDABLE
 
@@ -2470,6 +2573,7 @@ namespace C4
 			#endif
 
 			void HandleSoundReverbEvent(Variable *variable);
+			void HandleSoundStreamDepthEvent(Variable *variable);
 
 			int32 MixStereoSamples_Mono_Constant(SoundMixData *mixData, const Sample *input, int32 inputFrameCount, int32& inputOffset, int32 outputFrameCount, int32 outputOffset);
 			int32 MixStereoSamples_Mono_Variable(SoundMixData *mixData, const Sample *input, int32 inputFrameCount, int32& inputOffset, int32 outputFrameCount, int32 outputOffset);
@@ -2495,6 +2599,15 @@ namespace C4
 
 			static void StreamThread(const Thread *thread, void *cookie);
 
+			void StartStreamWorkers(void);
+			void StopStreamWorkers(void);
+
+			bool ClaimStream(Sound *sound);
+			void QueueStream(Sound *sound);
+			void ReleaseStream(Sound *sound);
+			StreamBufferHeader *AdvanceStreamBuffer(Sound *sound, int32& bufferIndex);
+			void CountStreamUnderrun(Sound *sound);
+
 			int32 AddSound(Sound *sound);
 
 		public:
@@ -2550,6 +2663,21 @@ namespace C4
 				return (listenerRoom);
 			}
 
+			int32 GetStreamBufferCount(void) const
+			{
+				return (streamBufferCount);
+			}
+
+			int32 GetStreamWorkerCount(void) const
+			{
+				return (streamWorkerCount);
+			}
+
+			int32 GetStreamUnderrunCount(void) const
+			{
+				return (streamUnderrunCount);
+			}
+
 			void RegisterSoundGroup(SoundGroup *group)
 			{
 				soundGroupMap.Insert(group);
@@ -2597,6 +2725,14 @@ namespace C4
 			C4API void SetGlobalSoundSpeed(float speed);
 			C4API void SetListenerRoom(SoundRoom *room);
 
+			C4API void SetStreamBufferCount(int32 count);
+
+			#if C4STATS
+
+				C4API int32 StressTestStreaming(int32 streamCount, Sound *const *soundTable, int32 blockCount);
+
+			#endif
+
 			C4API EngineResult StartRecording(const char *name);
 			C4API void StopRecording(void);
 
@@ -1157,6 +1157,14 @@ inline void Source::StopSound(void)
 	soundConduit->StopSound(soundObject);
 }
 
+bool Source::VolatileDeltaPack(void) const
+{
+	// The packed state, volume, and frequency are changed by playback, including
+	// completion callbacks, so a source is packed again by every incremental save.
+
+	return (true);
+}
+
 void Source::Preprocess(void)
 {
 	Node::Preprocess();
@@ -782,6 +782,8 @@ namespace C4
 			void Unpack(Unpacker& data, unsigned_int32 unpackFlags) override;
 			bool UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigned_int32 unpackFlags);
 
+			bool VolatileDeltaPack(void) const override;
+
 			void Preprocess(void) override;
 			void Neutralize(void) override;
 
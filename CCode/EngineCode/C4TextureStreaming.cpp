@@ -0,0 +1,312 @@
+ 
+
+#include "C4TextureStreaming.h"
+
+
+using namespace C4;
+
+
+TextureStreamingBackend::~TextureStreamingBackend()
+{
+}
+
+
+NullTextureStreamingBackend::NullTextureStreamingBackend()
+{
+	loadCount = 0;
+}
+
+NullTextureStreamingBackend::~NullTextureStreamingBackend()
+{
+}
+
+bool NullTextureStreamingBackend::BeginLoad(StreamedTexture *texture, int32 level)
+{
+	loadCount++;
+	return (true);
+}
+
+bool NullTextureStreamingBackend::LoadComplete(StreamedTexture *texture)
+{
+	return (true);
+}
+
+bool NullTextureStreamingBackend::FinishLoad(StreamedTexture *texture, int32 level)
+{
+	return (true);
+}
+
+void NullTextureStreamingBackend::CancelLoad(StreamedTexture *texture)
+{
+}
+
+
+StreamedTexture::StreamedTexture(void *cookie)
+{
+	streamingCookie = cookie;
+
+	minStreamingLevel = 0;
+	maxStreamingLevel = 0;
+
+	residentLevel = 0;
+	pendingLevel = -1;
+
+	requestedLevel = 0;
+	requestFrame = 0;
+
+	chainMemorySize[0] = 0;
+}
+
+StreamedTexture::~StreamedTexture()
+{
+}
+
+void StreamedTexture::SetStreamingLevels(int32 levelCount, int32 minLevel, int32 maxLevel, const unsigned_int32 *levelMemorySize)
+{
+	levelCount = Min(levelCount, kMaxStreamedMipmapCount);
+	minStreamingLevel = Min(minLevel, levelCount - 1);
+	maxStreamingLevel = Min(Max(maxLevel, minStreamingLevel), levelCount - 1);
+
+	// The memory occupied by a texture whose finest resident level is n is the
+	// sum of the sizes of levels n and coarser, so the table is accumulated backward.
+
+	unsigned_int32 size = 0;
+	for (machine level = levelCount - 1; level >= 0; level--)
+	{
+		size += levelMemorySize[level];
+		chainMemorySize[level] = size;
+	}
+}
+
+
+TextureStreamer::TextureStreamer(TextureStreamingBackend *backend, unsigned_int32 budget)
+{
+	streamingBackend = backend;
+
+	memoryBudget = budget;
+	residentMemory = 0;
+	committedMemory = 0;
+	releasingMemory = 0;
+
+	streamingFrame = 1;
+
+	promotionCount = 0;
+	demotionCount = 0;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (StreamedTexture *texture : pendingArray)
+	{
+		streamingBackend->CancelLoad(texture);
+		texture->pendingLevel = -1;
+	}
+
+	textureList.RemoveAll();
+}
+
+void TextureStreamer::AddTexture(StreamedTexture *texture, int32 level)
+{
+	texture->residentLevel = level;
+	texture->pendingLevel = -1;
+	texture->requestedLevel = texture->maxStreamingLevel;
+
+	unsigned_int32 size = texture->chainMemorySize[level];
+
+	streamerMutex.Acquire();
+
+	texture->requestFrame = streamingFrame - 1;
+	residentMemory += size;
+	committedMemory += size;
+	textureList.Prepend(texture);
+
+	streamerMutex.Release();
+}
+
+void TextureStreamer::RemoveTexture(StreamedTexture *texture)
+{
+	streamerMutex.Acquire();
+
+	if (texture->GetOwningList() == &textureList)
+	{
+		int32 pendingLevel = texture->pendingLevel;
+		if (pendingLevel >= 0)
+		{
+			streamingBackend->CancelLoad(texture);
+			pendingArray.RemoveElement(pendingArray.FindElement(texture));
+
+			if (pendingLevel > texture->residentLevel)
+			{
+				releasingMemory -= texture->chainMemorySize[texture->residentLevel] - texture->chainMemorySize[pendingLevel];
+			}
+		}
+
+		residentMemory -= texture->chainMemorySize[texture->residentLevel];
+		committedMemory -= texture->chainMemorySize[texture->GetCommittedLevel()];
+
+		texture->pendingLevel = -1;
+		textureList.Remove(texture);
+	}
+
+	streamerMutex.Release();
+}
+
+bool TextureStreamer::BeginLoad(StreamedTexture *texture, int32 level)
+{
+	if (!streamingBackend->BeginLoad(texture, level))
+	{
+		return (false);
+	}
+
+	int32 residentLevel = texture->residentLevel;
+	if (level < residentLevel)
+	{
+		// A promotion needs the memory for the finer chain as soon as the load
+		// begins, but a demotion keeps its current memory until it finishes.
+
+		committedMemory += texture->chainMemorySize[level] - texture->chainMemorySize[residentLevel];
+		promotionCount++;
+	}
+	else
+	{
+		releasingMemory += texture->chainMemorySize[residentLevel] - texture->chainMemorySize[level];
+		demotionCount++;
+	}
+
+	texture->pendingLevel = level;
+	pendingArray.AddElement(texture);
+	return (true);
+}
+
+void TextureStreamer::FinishLoads(void)
+{
+	int32 count = pendingArray.GetElementCount();
+	for (machine a = count - 1; a >= 0; a--)
+	{
+		StreamedTexture *texture = pendingArray[a];
+		if (streamingBackend->LoadComplete(texture))
+		{
+			int32 level = texture->pendingLevel;
+			int32 residentLevel = texture->residentLevel;
+			unsigned_int32 committedSize = texture->chainMemorySize[texture->GetCommittedLevel()];
+
+			if (level > residentLevel)
+			{
+				releasingMemory -= texture->chainMemorySize[residentLevel] - texture->chainMemorySize[level];
+			}
+
+			if (streamingBackend->FinishLoad(texture, level))
+			{
+				residentMemory += texture->chainMemorySize[level] - texture->chainMemorySize[residentLevel];
+				texture->residentLevel = level;
+			}
+
+			texture->pendingLevel = -1;
+			committedMemory += texture->chainMemorySize[texture->residentLevel] - committedSize;
+
+			pendingArray.RemoveElement(a);
+		}
+	}
+}
+
+bool TextureStreamer::ReclaimMemory(unsigned_int32 size, unsigned_int32 frame)
+{
+	// Textures are demoted beginning at the least recently used end of the list. A texture that
+	// was not requested during the most recent frame is demoted to its coarsest level, and a texture
+	// that was requested is demoted only as far as the level that was requested for it.
+
+	StreamedTexture *texture = textureList.First();
+	while ((texture) && (committedMemory - releasingMemory + size > memoryBudget))
+	{
+		if (pendingArray.GetElementCount() >= kTextureStreamingMaxLoadCount)
+		{
+			break;
+		}
+
+		if (texture->pendingLevel < 0)
+		{
+			int32 level = texture->maxStreamingLevel;
+			if (texture->requestFrame == frame)
+			{
+				level = Min(Max(texture->requestedLevel, texture->minStreamingLevel), level);
+			}
+
+			if (texture->residentLevel < level)
+			{
+				BeginLoad(texture, level);
+			}
+		}
+
+		texture = texture->Next();
+	}
+
+	return (committedMemory + size <= memoryBudget);
+}
+
+void TextureStreamer::Update(void)
+{
+	streamerMutex.Acquire();
+
+	FinishLoads();
+
+	unsigned_int32 frame = streamingFrame;
+
+	// Textures that were requested during the frame are moved to the end of the list
+	// in their current order, so the list stays sorted from least to most recently used.
+
+	StreamedTexture *texture = textureList.First();
+	StreamedTexture *last = textureList.Last();
+	while (texture)
+	{
+		StreamedTexture *next = texture->Next();
+
+		if (texture->requestFrame == frame)
+		{
+			textureList.Append(texture);
+		}
+
+		if (texture == last)
+		{
+			break;
+		}
+
+		texture = next;
+	}
+
+	texture = textureList.Last();
+	while ((texture) && (texture->requestFrame == frame))
+	{
+		if (pendingArray.GetElementCount() >= kTextureStreamingMaxLoadCount)
+		{
+			break;
+		}
+
+		StreamedTexture *previous = texture->Previous();
+
+		if (texture->pendingLevel < 0)
+		{
+			int32 residentLevel = texture->residentLevel;
+			int32 level = Min(Max(texture->requestedLevel, texture->minStreamingLevel), texture->maxStreamingLevel);
+			if (level < residentLevel)
+			{
+				level = residentLevel - 1;
+
+				unsigned_int32 size = texture->chainMemorySize[level] - texture->chainMemorySize[residentLevel];
+				if ((committedMemory + size > memoryBudget) && (!ReclaimMemory(size, frame)))
+				{
+					break;
+				}
+
+				BeginLoad(texture, level);
+			}
+		}
+
+		texture = previous;
+	}
+
+	streamingFrame = frame + 1;
+
+	streamerMutex.Release();
+}
+
+// ZYUQURM
@@ -0,0 +1,312 @@
+ 
+
+#ifndef C4TextureStreaming_h
+#define C4TextureStreaming_h
+
+
+//# \component	Graphics Manager
+//# \prefix		GraphicsMgr/
+
+
+#include "C4Threads.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kMaxStreamedMipmapCount				= 16,
+		kTextureStreamingInitialSize		= 64,
+		kTextureStreamingMaxLoadCount		= 4
+	};
+
+
+	class StreamedTexture;
+
+
+	//# \class	TextureStreamingBackend		The interface through which the texture streamer loads and uploads mipmap chains.
+	//
+	//# The $TextureStreamingBackend$ class is the interface through which the texture streamer loads and uploads mipmap chains.
+	//
+	//# \def	class TextureStreamingBackend
+	//
+	//# \desc
+	//# The $TextureStreamingBackend$ class is the interface that the $@TextureStreamer@$ class uses to carry out the
+	//# residency decisions that it makes. A load is started with the $BeginLoad$ function, polled with the $LoadComplete$
+	//# function, and then finished with the $FinishLoad$ function, which replaces the resident mipmap chain of the texture
+	//# with the chain that begins at the requested level. All functions are called on the main thread.
+	//#
+	//# The texture streamer itself never touches the graphics hardware or the file system, so its policy can be exercised
+	//# with the $@NullTextureStreamingBackend@$ class, which completes every load immediately without doing any work.
+	//
+	//# \also	$@TextureStreamer@$
+
+
+	class TextureStreamingBackend
+	{
+		public:
+
+			C4API virtual ~TextureStreamingBackend();
+
+			virtual bool BeginLoad(StreamedTexture *texture, int32 level) = 0;
+			virtual bool LoadComplete(StreamedTexture *texture) = 0;
+			virtual bool FinishLoad(StreamedTexture *texture, int32 level) = 0;
+			virtual void CancelLoad(StreamedTexture *texture) = 0;
+	};
+
+
+	class NullTextureStreamingBackend : public TextureStreamingBackend
+	{
+		private:
+
+			int32		loadCount;
+
+		public:
+
+			C4API NullTextureStreamingBackend();
+			C4API ~NullTextureStreamingBackend();
+
+			int32 GetLoadCount(void) const
+			{
+				return (loadCount);
+			}
+
+			bool BeginLoad(StreamedTexture *texture, int32 level) override;
+			bool LoadComplete(StreamedTexture *texture) override;
+			bool FinishLoad(StreamedTexture *texture, int32 level) override;
+			void CancelLoad(StreamedTexture *texture) override;
+	};
+
+
+	//# \class	StreamedTexture		Stores the residency state of a texture managed by the texture streamer.
+	//
+	//# The $StreamedTexture$ class stores the residency state of a texture managed by the texture streamer.
+	//
+	//# \def	class StreamedTexture : public ListElement<StreamedTexture>
+	//
+	//# \ctor	StreamedTexture(void *cookie = nullptr);
+	//
+	//# \param	cookie		A pointer to the object that owns the streaming state.
+	//
+	//# \desc
+	//# The $StreamedTexture$ class holds the mipmap levels that are resident, being loaded, and requested for a texture
+	//# whose finer mipmap levels are loaded on demand. Mipmap levels are numbered from the finest level, so a smaller
+	//# number means a larger image. The memory required by the chain of mipmap levels beginning at each level is
+	//# supplied when the texture is added to a $@TextureStreamer@$ object.
+	//
+	//# \base	Utilities/ListElement<StreamedTexture>		Used internally by the texture streamer to keep textures in least-recently-used order.
+	//
+	//# \also	$@TextureStreamer@$
+
+
+	//# \function	StreamedTexture::RequestLevel		Requests that a mipmap level be made resident.
+	//
+	//# \proto	void RequestLevel(int32 level, unsigned_int32 frame);
+	//
+	//# \param	level	The finest mipmap level that is needed to render the texture.
+	//# \param	frame	The current streaming frame, as returned by the $@TextureStreamer::GetStreamingFrame@$ function.
+	//
+	//# \desc
+	//# The $RequestLevel$ function records that the mipmap level specified by the $level$ parameter is needed to render
+	//# the texture during the current frame. If several levels are requested during the same frame, then the finest
+	//# one is kept. The request is acted upon the next time the $@TextureStreamer::Update@$ function is called.
+
+
+	class StreamedTexture : public ListElement<StreamedTexture>
+	{
+		friend class TextureStreamer;
+
+		private:
+
+			void				*streamingCookie;
+
+			int32				minStreamingLevel;
+			int32				maxStreamingLevel;
+
+			int32				residentLevel;
+			int32				pendingLevel;
+
+			int32				requestedLevel;
+			unsigned_int32		requestFrame;
+
+			unsigned_int32		chainMemorySize[kMaxStreamedMipmapCount];
+
+			int32 GetCommittedLevel(void) const
+			{
+				return ((pendingLevel < 0) ? residentLevel : Min(pendingLevel, residentLevel));
+			}
+
+		public:
+
+			C4API StreamedTexture(void *cookie = nullptr);
+			C4API ~StreamedTexture();
+
+			void *GetStreamingCookie(void) const
+			{
+				return (streamingCookie);
+			}
+
+			int32 GetMinStreamingLevel(void) const
+			{
+				return (minStreamingLevel);
+			}
+
+			int32 GetMaxStreamingLevel(void) const
+			{
+				return (maxStreamingLevel);
+			}
+
+			int32 GetResidentLevel(void) const
+			{
+				return (residentLevel);
+			}
+
+			int32 GetPendingLevel(void) const
+			{
+				return (pendingLevel);
+			}
+
+			int32 GetRequestedLevel(void) const
+			{
+				return (requestedLevel);
+			}
+
+			unsigned_int32 GetChainMemorySize(int32 level) const
+			{
+				return (chainMemorySize[level]);
+			}
+
+			void RequestLevel(int32 level, unsigned_int32 frame)
+			{
+				if (requestFrame != frame)
+				{
+					requestFrame = frame;
+					requestedLevel = level;
+				}
+				else
+				{
+					requestedLevel = Min(requestedLevel, level);
+				}
+			}
+
+			C4API void SetStreamingLevels(int32 levelCount, int32 minLevel, int32 maxLevel, const unsigned_int32 *levelMemorySize);
+	};
+
+
+	//# \class	TextureStreamer		Keeps the finer mipmap levels of textures resident under a memory budget.
+	//
+	//# The $TextureStreamer$ class keeps the finer mipmap levels of textures resident under a memory budget.
+	//
+	//# \def	class TextureStreamer
+	//
+	//# \ctor	TextureStreamer(TextureStreamingBackend *backend, unsigned_int32 budget);
+	//
+	//# \param	backend		The backend that loads and uploads mipmap chains.
+	//# \param	budget		The maximum amount of texture memory, in bytes, that streamed textures may occupy.
+	//
+	//# \desc
+	//# The $TextureStreamer$ class decides which mipmap levels of each streamed texture should be resident. A texture is
+	//# added to the streamer after its coarsest levels have been loaded, and the level that each texture needs is then
+	//# requested while rendering. Once per frame, the $@TextureStreamer::Update@$ function finishes any loads that have
+	//# completed and starts new ones. A texture is promoted one mipmap level at a time so that the textures that are
+	//# needed most recently all improve at a similar rate.
+	//#
+	//# Textures are kept in least-recently-used order. When a promotion would exceed the memory budget, textures that
+	//# were not requested during the most recent frame are demoted to their coarsest levels, beginning with the one that
+	//# was used least recently. No more than $kTextureStreamingMaxLoadCount$ loads are in flight at once.
+	//
+	//# \also	$@TextureStreamingBackend@$
+	//# \also	$@StreamedTexture@$
+
+
+	//# \function	TextureStreamer::Update		Finishes completed loads and schedules new ones.
+	//
+	//# \proto	void Update(void);
+	//
+	//# \desc
+	//# The $Update$ function should be called once per frame on the main thread. It finishes any loads that have completed,
+	//# applies the mipmap levels requested since the previous call, and then advances the streaming frame.
+	//
+	//# \also	$@StreamedTexture::RequestLevel@$
+
+
+	class TextureStreamer
+	{
+		private:
+
+			TextureStreamingBackend				*streamingBackend;
+
+			unsigned_int32						memoryBudget;
+			unsigned_int32						residentMemory;
+			unsigned_int32						committedMemory;
+			unsigned_int32						releasingMemory;
+
+			unsigned_int32						streamingFrame;
+
+			int32								promotionCount;
+			int32								demotionCount;
+
+			Mutex								streamerMutex;
+			List<StreamedTexture>				textureList;
+			Array<StreamedTexture *, 16>		pendingArray;
+
+			bool BeginLoad(StreamedTexture *texture, int32 level);
+			void FinishLoads(void);
+			bool ReclaimMemory(unsigned_int32 size, unsigned_int32 frame);
+
+		public:
+
+			C4API TextureStreamer(TextureStreamingBackend *backend, unsigned_int32 budget);
+			C4API ~TextureStreamer();
+
+			unsigned_int32 GetMemoryBudget(void) const
+			{
+				return (memoryBudget);
+			}
+
+			void SetMemoryBudget(unsigned_int32 budget)
+			{
+				memoryBudget = budget;
+			}
+
+			unsigned_int32 GetResidentMemory(void) const
+			{
+				return (residentMemory);
+			}
+
+			unsigned_int32 GetCommittedMemory(void) const
+			{
+				return (committedMemory);
+			}
+
+			unsigned_int32 GetStreamingFrame(void) const
+			{
+				return (streamingFrame);
+			}
+
+			int32 GetPendingLoadCount(void) const
+			{
+				return (pendingArray.GetElementCount());
+			}
+
+			int32 GetPromotionCount(void) const
+			{
+				return (promotionCount);
+			}
+
+			int32 GetDemotionCount(void) const
+			{
+				return (demotionCount);
+			}
+
+			C4API void AddTexture(StreamedTexture *texture, int32 level);
+			C4API void RemoveTexture(StreamedTexture *texture);
+
+			C4API void Update(void);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
@@ -17,6 +17,9 @@ Mutex Texture::textureMutex;
 List<Texture> Texture::textureList;
 Map<Texture> Texture::textureHeaderMap;
 
+Texture::StreamingBackend Texture::textureStreamingBackend;
+TextureStreamer *Texture::textureStreamer = nullptr;
+
 
 namespace C4
 {
@@ -113,7 +116,7 @@ void TextureResource::ReleaseImageData(void *imageData)
 } 
  
 
-Texture::Texture(TextureResource *resource, int32 index)
+Texture::Texture(TextureResource *resource, int32 index) : streamingData(this)
 {
 	textureResource = resource; 
 	textureIndex = index;
@@ -126,9 +129,13 @@ Texture::Texture(TextureResource *resource, int32 index)
 
 	activeFlag = false;
 	impostorClipFlag = false;
+
+	streamingJob = nullptr;
+	streamingHeader = nullptr;
+	streamingImage = nullptr;
 }
 
-Texture::Texture(const TextureHeader *header, const void *image)
+Texture::Texture(const TextureHeader *header, const void *image) : streamingData(this)
 {
 	textureResource = nullptr;
 	textureIndex = 0;
@@ -139,6 +146,10 @@ Texture::Texture(const TextureHeader *header, const void *image)
 
 	activeFlag = false;
 	impostorClipFlag = false;
+
+	streamingJob = nullptr;
+	streamingHeader = nullptr;
+	streamingImage = nullptr;
 }
 
 Texture::~Texture()
@@ -645,6 +656,16 @@ ResourceResult Texture::Activate(void)
 	const void *pointerTextureData = ProcessAuxiliaryData(textureHeader);
 	GraphicsMgr::SyncRenderTask(&Texture::InitializeTextureObject, this, textureHeader);
 
+	TextureStreamer *streamer = textureStreamer;
+	bool streamingFlag = ((streamer) && (textureType == kTexture2D) && (mipmapLevelCount > 1) && (!(textureFlags & (kTextureForceHighQuality | kTextureReferenceList))));
+	if (streamingFlag)
+	{
+		// Only the coarsest mipmap levels are loaded here. The finer levels are loaded by
+		// the texture streamer after the texture has been rendered at a size that needs them.
+
+		baseMipmapLevel = (unsigned_int16) InitializeStreaming(textureHeader);
+	}
+
 	const TextureStorageData *storageData = GetTextureStorageData(textureHeader->imageFormat);
 	uploadData.format = (textureHeader->alphaSemantic != kTextureSemanticNone) ? storageData->renderFormatAlpha : storageData->renderFormat;
 	uploadData.encoding = Render::kTextureEncodingLinear;
@@ -848,6 +869,12 @@ ResourceResult Texture::Activate(void)
 	}
 
 	textureMutex.Release();
+
+	if (streamingFlag)
+	{
+		streamer->AddTexture(&streamingData, baseMipmapLevel);
+	}
+
 	return (kResourceOkay);
 }
 
@@ -857,6 +884,11 @@ void Texture::Deactivate(void)
 	{
 		activeFlag = false;
 
+		if (streamingData.GetOwningList())
+		{
+			textureStreamer->RemoveTexture(&streamingData);
+		}
+
 		textureMutex.Acquire();
 		totalTextureCount--;
 		totalTextureMemory -= textureMemorySize;
@@ -927,6 +959,189 @@ ResourceResult Texture::LoadReferencedArrayImage(const char *name, unsigned_int8
 	return (result);
 }
 
+int32 Texture::InitializeStreaming(const TextureHeader *header)
+{
+	unsigned_int32		levelMemorySize[kMaxStreamedMipmapCount];
+
+	int32 levelCount = Min(mipmapLevelCount, kMaxStreamedMipmapCount);
+	int32 minLevel = baseMipmapLevel;
+
+	int32 maxLevel = minLevel;
+	int32 biggestDimension = Max(textureWidth, textureHeight);
+	while ((maxLevel < levelCount - 1) && ((biggestDimension >> maxLevel) > kTextureStreamingInitialSize))
+	{
+		maxLevel++;
+	}
+
+	// The memory sizes are calculated the same way that the render backend calculates
+	// them when the image is uploaded so that the budget can be enforced before any upload.
+
+	unsigned_int32 pixelSize = GetTextureStorageData(header->imageFormat)->pixelSize;
+	unsigned_int32 blockSize = (alphaSemantic == kTextureSemanticNone) ? 8 : 16;
+
+	int32 width = textureWidth;
+	int32 height = textureHeight;
+	for (machine level = 0; level < levelCount; level++)
+	{
+		if (pixelSize == 0)
+		{
+			levelMemorySize[level] = ((width + 3) >> 2) * ((height + 3) >> 2) * blockSize;
+		}
+		else
+		{
+			levelMemorySize[level] = width * height * pixelSize;
+		}
+
+		width = Max(width >> 1, 1);
+		height = Max(height >> 1, 1);
+	}
+
+	streamingData.SetStreamingLevels(levelCount, minLevel, maxLevel, levelMemorySize);
+	return (streamingData.GetMaxStreamingLevel());
+}
+
+void Texture::BeginStreamingLoad(int32 level)
+{
+	streamingLevel = level;
+	streamingHeader = nullptr;
+	streamingImage = nullptr;
+
+	streamingJob = new Job(&JobLoadMipmapChain, this);
+	TheJobMgr->SubmitJob(streamingJob);
+}
+
+void Texture::JobLoadMipmapChain(Job *job, void *cookie)
+{
+	ResourceLoader				loader;
+	TextureHeader				*textureHeader;
+	TextureResourceHeader		resourceHeader;
+
+	Texture *texture = static_cast<Texture *>(cookie);
+	TextureResource *resource = texture->textureResource;
+
+	if (resource->OpenLoader(&loader) == kResourceOkay)
+	{
+		if (resource->LoadHeaderData(&loader, &resourceHeader, &textureHeader) == kResourceOkay)
+		{
+			int32 textureLoadIndex = Min(texture->textureIndex, resourceHeader.textureCount - 1);
+			if (resource->LoadImageData(&loader, &resourceHeader, textureHeader + textureLoadIndex, textureLoadIndex, texture->streamingLevel, &texture->streamingImage) == kResourceOkay)
+			{
+				texture->streamingIndex = textureLoadIndex;
+				texture->streamingHeader = textureHeader;
+			}
+			else
+			{
+				TextureResource::ReleaseHeaderData(textureHeader);
+			}
+		}
+	}
+}
+
+bool Texture::FinishStreamingLoad(int32 level)
+{
+	Render::TextureUploadData	uploadData;
+
+	delete streamingJob;
+	streamingJob = nullptr;
+
+	TextureHeader *header = streamingHeader;
+	if (!header)
+	{
+		return (false);
+	}
+
+	const TextureHeader *textureHeader = header + streamingIndex;
+	const TextureStorageData *storageData = GetTextureStorageData(textureHeader->imageFormat);
+	uploadData.format = (textureHeader->alphaSemantic != kTextureSemanticNone) ? storageData->renderFormatAlpha : storageData->renderFormat;
+	uploadData.encoding = Render::kTextureEncodingLinear;
+
+	if ((textureFlags & kTextureSrgbColor) && ((storageData->pixelSize & 3) == 0))
+	{
+		uploadData.encoding = Render::kTextureEncodingSrgb;
+	}
+
+	unsigned_int32 memorySize = 0;
+	uploadData.memorySize = &memorySize;
+
+	const char *image = static_cast<char *>(streamingImage);
+	int32 mipmapCount = mipmapLevelCount - level;
+	const TextureMipmapData *mipmapData = textureHeader->GetMipmapData() + level;
+
+	for (machine a = 0; a < mipmapCount; a++)
+	{
+		unsigned_int32 size = mipmapData->imageSize;
+		uploadData.imageData[a].image = image;
+		uploadData.imageData[a].size = size;
+		uploadData.imageData[a].decompressor = GetDecompressor(textureHeader, mipmapData);
+		image += size;
+		mipmapData++;
+	}
+
+	uploadData.width = textureWidth >> level;
+	uploadData.height = textureHeight >> level;
+	uploadData.mipmapCount = mipmapCount;
+
+	// The image is specified again for the same texture object, so the texture handles
+	// already stored in shader data remain valid after the resident levels change.
+
+	GraphicsMgr::SyncRenderTask((storageData->engineFormat == kTextureBC13) ? &TextureObject::SetCompressedImage2D : &TextureObject::SetImage2D, static_cast<TextureObject *>(this), &uploadData);
+
+	TextureResource::ReleaseImageData(streamingImage);
+	TextureResource::ReleaseHeaderData(header);
+	streamingHeader = nullptr;
+	streamingImage = nullptr;
+
+	baseMipmapLevel = (unsigned_int16) level;
+
+	textureMutex.Acquire();
+	totalTextureMemory += memorySize - textureMemorySize;
+	textureMutex.Release();
+
+	textureMemorySize = memorySize;
+	return (true);
+}
+
+void Texture::CancelStreamingLoad(void)
+{
+	Job *job = streamingJob;
+	if (job)
+	{
+		streamingJob = nullptr;
+
+		TheJobMgr->CancelJob(job);
+		delete job;
+	}
+
+	if (streamingHeader)
+	{
+		TextureResource::ReleaseImageData(streamingImage);
+		TextureResource::ReleaseHeaderData(streamingHeader);
+		streamingHeader = nullptr;
+		streamingImage = nullptr;
+	}
+}
+
+bool Texture::StreamingBackend::BeginLoad(StreamedTexture *texture, int32 level)
+{
+	static_cast<Texture *>(texture->GetStreamingCookie())->BeginStreamingLoad(level);
+	return (true);
+}
+
+bool Texture::StreamingBackend::LoadComplete(StreamedTexture *texture)
+{
+	return (static_cast<Texture *>(texture->GetStreamingCookie())->streamingJob->Complete());
+}
+
+bool Texture::StreamingBackend::FinishLoad(StreamedTexture *texture, int32 level)
+{
+	return (static_cast<Texture *>(texture->GetStreamingCookie())->FinishStreamingLoad(level));
+}
+
+void Texture::StreamingBackend::CancelLoad(StreamedTexture *texture)
+{
+	static_cast<Texture *>(texture->GetStreamingCookie())->CancelStreamingLoad();
+}
+
 Texture *Texture::Get(const char *name, int32 index)
 {
 	TextureResource *resource = TextureResource::Get(name, kResourceDeferLoad);
@@ -1069,6 +1284,57 @@ void Texture::UpdateRect(const Rect& rect, int32 pitch, const void *image)
 	}
 }
 
+void Texture::RequestStreamingSize(float size)
+{
+	if (streamingData.GetOwningList())
+	{
+		// The finest level whose largest dimension is still at least the rendered size is requested.
+		// Since the size is that of the whole object, this errs toward finer levels for tiled textures.
+
+		int32 maxLevel = streamingData.GetMaxStreamingLevel();
+		float dimension = (float) Max(textureWidth, textureHeight) * 0.5F;
+
+		int32 level = 0;
+		while ((level < maxLevel) && (dimension >= size))
+		{
+			dimension *= 0.5F;
+			level++;
+		}
+
+		streamingData.RequestLevel(level, textureStreamer->GetStreamingFrame());
+	}
+}
+
+void Texture::SetTextureStreamingBudget(unsigned_int32 budget)
+{
+	TextureStreamer *streamer = textureStreamer;
+	if (budget != 0)
+	{
+		if (streamer)
+		{
+			streamer->SetMemoryBudget(budget);
+		}
+		else
+		{
+			textureStreamer = new TextureStreamer(&textureStreamingBackend, budget);
+		}
+	}
+	else if (streamer)
+	{
+		delete streamer;
+		textureStreamer = nullptr;
+	}
+}
+
+void Texture::UpdateStreaming(void)
+{
+	TextureStreamer *streamer = textureStreamer;
+	if (streamer)
+	{
+		streamer->Update();
+	}
+}
+
 void Texture::DeactivateAll(void)
 {
 	Texture *texture = textureList.First();
@@ -13,6 +13,7 @@
 #include "C4Compression.h"
 #include "C4Image.h"
 #include "C4Render.h"
+#include "C4TextureStreaming.h"
 
 
 namespace C4
@@ -391,6 +392,44 @@ namespace C4
 	//# \also	$@Texture::GetImagePointer@$
 
 
+	//# \function	Texture::RequestStreamingSize		Requests the mipmap level needed to render a texture at a given size.
+	//
+	//# \proto	void RequestStreamingSize(float size);
+	//
+	//# \param	size	The approximate size, in pixels, at which the texture is rendered.
+	//
+	//# \desc
+	//# The $RequestStreamingSize$ function tells the texture streamer that the texture is being rendered at the size
+	//# specified by the $size$ parameter during the current frame. The streamer uses the finest mipmap level whose
+	//# largest dimension is at least $size$ pixels. If texture streaming is disabled or the texture is not streamed,
+	//# then this function has no effect.
+	//#
+	//# The Graphics Manager calls this function automatically for texture maps used by the geometries in a world.
+	//
+	//# \also	$@Texture::SetTextureStreamingBudget@$
+
+
+	//# \function	Texture::SetTextureStreamingBudget		Enables or disables texture streaming.
+	//
+	//# \proto	static void SetTextureStreamingBudget(unsigned_int32 budget);
+	//
+	//# \param	budget	The maximum amount of texture memory, in bytes, that streamed textures may occupy. If this is zero, then texture streaming is disabled.
+	//
+	//# \desc
+	//# The $SetTextureStreamingBudget$ function enables or disables texture streaming. When streaming is enabled, a 2D texture
+	//# loaded from a resource is initially loaded with only its mipmap levels no larger than $kTextureStreamingInitialSize$
+	//# pixels, and finer levels are loaded in the background as they are needed. Textures having the $kTextureForceHighQuality$
+	//# flag are never streamed. Changing only the budget takes effect the next time the texture streamer is updated.
+	//#
+	//# Textures that are currently active keep the mipmap levels they were loaded with when streaming is enabled or disabled.
+	//# The Graphics Manager calls this function when the $textureStreamingBudget$ system variable changes, and it reloads all
+	//# textures if necessary, so applications should normally set that variable, which is specified in megabytes, instead of
+	//# calling this function directly.
+	//
+	//# \also	$@Texture::RequestStreamingSize@$
+	//# \also	$@TextureStreamer@$
+
+
 	//# \function	Texture::GetImagePointer		Returns a pointer to the image data for a texture object.
 	//
 	//# \proto	void *GetImagePointer(void) const;
@@ -432,6 +471,16 @@ namespace C4
 
 		private:
 
+			class StreamingBackend : public TextureStreamingBackend
+			{
+				public:
+
+					bool BeginLoad(StreamedTexture *texture, int32 level) override;
+					bool LoadComplete(StreamedTexture *texture) override;
+					bool FinishLoad(StreamedTexture *texture, int32 level) override;
+					void CancelLoad(StreamedTexture *texture) override;
+			};
+
 			TextureType				textureType;
 			unsigned_int32			textureFlags;
 			int32					textureWidth;
@@ -458,6 +507,13 @@ namespace C4
 
 			unsigned_int32			textureMemorySize;
 
+			StreamedTexture			streamingData;
+			Job						*streamingJob;
+			int32					streamingLevel;
+			int32					streamingIndex;
+			TextureHeader			*streamingHeader;
+			void					*streamingImage;
+
 			static int32			totalTextureCount;
 			static unsigned_int32	totalTextureMemory;
 
@@ -465,6 +521,9 @@ namespace C4
 			static List<Texture>	textureList;
 			static Map<Texture>		textureHeaderMap;
 
+			static StreamingBackend	textureStreamingBackend;
+			static TextureStreamer	*textureStreamer;
+
 			Texture(TextureResource *resource, int32 index);
 			Texture(const TextureHeader *header, const void *image);
 			~Texture();
@@ -484,6 +543,13 @@ namespace C4
 
 			ResourceResult LoadReferencedArrayImage(const char *name, unsigned_int8 *finalImage, int32 entryIndex, int32 entryCount) const;
 
+			int32 InitializeStreaming(const TextureHeader *header);
+			void BeginStreamingLoad(int32 level);
+			bool FinishStreamingLoad(int32 level);
+			void CancelStreamingLoad(void);
+
+			static void JobLoadMipmapChain(Job *job, void *cookie);
+
 		public:
 
 			const KeyType& GetKey(void) const
@@ -596,6 +662,16 @@ namespace C4
 			C4API void UpdateRect(const Rect& rect);
 			C4API void UpdateRect(const Rect& rect, int32 pitch, const void *image);
 
+			C4API void RequestStreamingSize(float size);
+
+			static TextureStreamer *GetTextureStreamer(void)
+			{
+				return (textureStreamer);
+			}
+
+			C4API static void SetTextureStreamingBudget(unsigned_int32 budget);
+			static void UpdateStreaming(void);
+
 			static void DeactivateAll(void);
 			static void ReactivateAll(void);
 			C4API static void Reload(const char *name);
@@ -2,6 +2,7 @@
 
 #include "C4Threads.h"
 #include "C4Engine.h"
+#include "C4Profiler.h"
 
 
 using namespace C4;
@@ -584,15 +585,20 @@ Job::~Job()
 
 BatchJob::BatchJob(ExecuteProc *execProc, void *cookie, unsigned_int32 flags) : Job(execProc, cookie, flags)
 {
+	batchSequence = 0;
 }
 
 BatchJob::BatchJob(ExecuteProc *execProc, FinalizeProc *finalProc, void *cookie, unsigned_int32 flags) : Job(execProc, finalProc, cookie, flags)
 {
+	batchSequence = 0;
 }
 
 
 Batch::Batch()
 {
+	batchFlags = 0;
+	batchSequence = 0;
+
 	batchActive = false;
 	signalFlag = false;
 }
@@ -670,6 +676,14 @@ void JobMgr::WorkerThread(const Thread *thread, void *cookie)
 	Worker *worker = static_cast<Worker *>(cookie);
 	JobMgr *jobMgr = TheJobMgr;
 
+	#if C4PROFILE
+
+		String<31> name("Job Worker ");
+		name += worker->threadIndex;
+		Profiler::RegisterThread(name);
+
+	#endif
+
 	for (;;)
 	{
 		thread->GetThreadSignal()->Wait();
@@ -693,7 +707,23 @@ void JobMgr::WorkerThread(const Thread *thread, void *cookie)
 			jobMgr->jobExecuteList.Append(job);
 
 			jobMgr->jobMutex.Release();
-			job->Execute();
+
+			#if C4PROFILE
+
+				bool scopeFlag = Profiler::BeginScope("JobMgr::Execute");
+				job->Execute();
+
+				if (scopeFlag)
+				{
+					Profiler::EndScope();
+				}
+
+			#else
+
+				job->Execute();
+
+			#endif
+
 			jobMgr->jobMutex.Acquire();
 
 			jobMgr->jobExecuteList.Remove(job);
@@ -717,7 +747,30 @@ void JobMgr::ProcessJobBatch(Job *job)
 		BatchJob *batchJob = static_cast<BatchJob *>(job);
 		if (batchJob->ListElement<BatchJob>::GetOwningList() == &batch->jobPendingList)
 		{
-			batch->jobFinishedList.Append(batchJob);
+			if (!(batch->batchFlags & kBatchOrderedFinalize))
+			{
+				batch->jobFinishedList.Append(batchJob);
+			}
+			else
+			{
+				// Jobs usually complete in nearly the order in which they were submitted,
+				// so the insertion point is found by searching backward from the end.
+
+				BatchJob *finishedJob = batch->jobFinishedList.Last();
+				while ((finishedJob) && (finishedJob->batchSequence > batchJob->batchSequence))
+				{
+					finishedJob = finishedJob->Previous();
+				}
+
+				if (finishedJob)
+				{
+					batch->jobFinishedList.InsertAfter(batchJob, finishedJob);
+				}
+				else
+				{
+					batch->jobFinishedList.Prepend(batchJob);
+				}
+			}
 
 			if ((batch->signalFlag) && (batch->jobPendingList.Empty()))
 			{
@@ -764,6 +817,7 @@ void JobMgr::SubmitJob(BatchJob *job, Batch *batch)
 
 	job->jobBatch = batch;
 	job->jobState = 0;
+	job->batchSequence = batch->batchSequence++;
 
 	jobReadyList.Append(job);
 	batch->jobPendingList.Append(job);
@@ -790,6 +844,10 @@ void JobMgr::CancelJob(Job *job)
 	{
 		jobReadyList.Remove(job);
 		ProcessJobBatch(job);
+
+		// The job will never execute, so it is marked complete to let FinishJob() return.
+
+		job->jobState |= kJobComplete;
 	}
 
 	jobMutex.Release();
@@ -807,6 +865,7 @@ void JobMgr::CancelJobArray(int32 count, Job **jobArray)
 		{
 			jobReadyList.Remove(job);
 			ProcessJobBatch(job);
+			job->jobState |= kJobComplete;
 		}
 	}
 
@@ -863,6 +922,8 @@ void JobMgr::FinishBatch(Batch *batch)
 			}
 		}
 	}
+
+	batch->batchSequence = 0;
 }
 
 // ZYUQURM
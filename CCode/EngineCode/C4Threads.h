@@ -40,6 +40,14 @@ namespace C4
 	};
 
 
+	//# \enum	BatchFlags
+
+	enum
+	{
+		kBatchOrderedFinalize	= 1 << 0	//## The finalization functions for the jobs in the batch are called in the order in which the jobs were submitted instead of the order in which they completed.
+	};
+
+
 	enum
 	{
 		kJobExecuting			= 1 << 0,
@@ -772,6 +780,12 @@ namespace C4
 
 	class BatchJob : public Job, public ListElement<BatchJob>
 	{
+		friend class JobMgr;
+
+		private:
+
+			int32		batchSequence;
+
 		public:
 
 			C4API BatchJob(ExecuteProc *execProc, void *cookie = nullptr, unsigned_int32 flags = 0);
@@ -800,12 +814,46 @@ namespace C4
 	//# \also	$@JobMgr@$
 
 
+	//# \function	Batch::GetBatchFlags		Returns the batch flags.
+	//
+	//# \proto	unsigned_int32 GetBatchFlags(void) const;
+	//
+	//# \desc
+	//# The $GetBatchFlags$ function returns the batch flags, which can be a combination (through logical OR) of the
+	//# following constants.
+	//
+	//# \table	BatchFlags
+	//
+	//# \also	$@Batch::SetBatchFlags@$
+
+
+	//# \function	Batch::SetBatchFlags		Sets the batch flags.
+	//
+	//# \proto	void SetBatchFlags(unsigned_int32 flags);
+	//
+	//# \param	flags	The new batch flags.
+	//
+	//# \desc
+	//# The $SetBatchFlags$ function sets the batch flags to the value specified by the $flags$ parameter, which can be
+	//# a combination (through logical OR) of the following constants.
+	//
+	//# \table	BatchFlags
+	//
+	//# The batch flags should only be changed while no jobs belonging to the batch are pending. The initial value of
+	//# the batch flags is 0.
+	//
+	//# \also	$@Batch::GetBatchFlags@$
+
+
 	class Batch
 	{
 		friend class JobMgr;
 
 		private:
 
+			unsigned_int32		batchFlags;
+			int32				batchSequence;
+
 			List<BatchJob>		jobPendingList;
 			List<BatchJob>		jobFinishedList;
 
@@ -818,6 +866,16 @@ namespace C4
 
 			C4API Batch();
 			C4API ~Batch();
+
+			unsigned_int32 GetBatchFlags(void) const
+			{
+				return (batchFlags);
+			}
+
+			void SetBatchFlags(unsigned_int32 flags)
+			{
+				batchFlags = flags;
+			}
 	};
 
 
@@ -890,7 +948,8 @@ namespace C4
 	//# the $@Job::Cancelled@$ function to be aware of the cancellation, and it should exit early when it has been cancelled.
 	//# (Jobs are not forced to exit by the Job Manager.)
 	//#
-	//# If the job has not yet begun executing when this function is called, then it is simply removed from the execution queue.
+	//# If the job has not yet begun executing when this function is called, then it is simply removed from the execution queue,
+	//# and it is considered complete so that the $@JobMgr::FinishJob@$ function returns immediately for it.
 	//
 	//# \also	$@JobMgr::CancelJobArray@$
 	//# \also	$@JobMgr::SubmitJob@$
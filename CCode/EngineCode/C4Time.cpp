@@ -418,6 +418,14 @@ void TimeMgr::ResetTime(void)
 	systemFloatDeltaTime = 0.0F;
 }
 
+void TimeMgr::SetWorldDeltaTime(int32 dt)
+{
+	worldDeltaTime = dt;
+	worldFloatDeltaTime = (float) dt;
+	worldDeltaSeconds = (float) dt * 0.001F;
+	worldAbsoluteTime += dt;
+}
+
 void TimeMgr::TimeTask(void)
 {
 	previousTimeValue = currentTimeValue;
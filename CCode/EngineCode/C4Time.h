@@ -704,6 +704,22 @@ namespace C4
 	//# \also	$@TimeMgr::GetAbsoluteTime@$
 
 
+	//# \function	TimeMgr::SetWorldDeltaTime		Overrides the world time difference for the current frame.
+	//
+	//# \proto	void SetWorldDeltaTime(int32 dt);
+	//
+	//# \param	dt		The new world time difference, in milliseconds.
+	//
+	//# \desc
+	//# The $SetWorldDeltaTime$ function replaces the world time difference for the current frame with the value specified
+	//# by the $dt$ parameter and advances the absolute world time by the same amount. This is used to run frames with a
+	//# predetermined sequence of time differences, such as when a recorded physics session is replayed. The new value is
+	//# replaced again the next time the Time Manager updates the time at the beginning of a frame.
+	//
+	//# \also	$@TimeMgr::GetDeltaTime@$
+	//# \also	$@TimeMgr::GetFloatDeltaTime@$
+
+
 	//# \function	TimeMgr::GetAbsoluteTime		Returns the current absolute millisecond count.
 	//
 	//# \proto	unsigned_int32 GetAbsoluteTime(void) const;
@@ -875,7 +891,7 @@ namespace C4
 
 				#elif C4LINUX
 
-					return ((int32) (time / 1000U));
+					return (time / 1000U);
 
 				#elif C4PS4 //[ PS4
 
@@ -970,6 +986,7 @@ namespace C4
 			C4API static void GetDateTimeStrings(String<127> *date, String<127> *time);
 
 			C4API void ResetTime(void);
+			C4API void SetWorldDeltaTime(int32 dt);
 
 			C4API void TimeTask(void);
 	};
@@ -753,7 +753,7 @@ bool TimeWindow::HandleKeyboardEvent(const KeyboardEventData *eventData)
 		static const char *const worldKey[kWorldStatCount] =
 		{
 			"Geometry", "Terrain", "Water", "Impostor", "InfiniteLight", "InfiniteShadow", "PointLight", "PointShadow", "SpotLight", "SpotShadow",
-			"DirectPortal", "RemotePortal", "Occlusion"
+			"DirectPortal", "RemotePortal", "Occlusion", "CellCount", "CellInsert", "CellUpdate", "CellVisit", "CellVisible"
 		};
 
 		static const char *const physicsKey[kPhysicsStatCount] =
@@ -879,6 +879,11 @@ bool TimeWindow::HandleKeyboardEvent(const KeyboardEventData *eventData)
 				worldStatText[kWorldStatDirectPortals]->SetText(String<7>(world->GetWorldCounter(kWorldCounterDirectPortal)));
 				worldStatText[kWorldStatRemotePortals]->SetText(String<7>(world->GetWorldCounter(kWorldCounterRemotePortal)));
 				worldStatText[kWorldStatOcclusionRegions]->SetText(String<7>(world->GetWorldCounter(kWorldCounterOcclusionRegion)));
+				worldStatText[kWorldStatCellCount]->SetText(String<7>(world->GetWorldCounter(kWorldCounterCellCount)));
+				worldStatText[kWorldStatCellInsert]->SetText(String<7>(world->GetWorldCounter(kWorldCounterCellInsert)));
+				worldStatText[kWorldStatCellUpdate]->SetText(String<7>(world->GetWorldCounter(kWorldCounterCellUpdate)));
+				worldStatText[kWorldStatCellVisit]->SetText(String<7>(world->GetWorldCounter(kWorldCounterCellVisit)));
+				worldStatText[kWorldStatCellVisible]->SetText(String<7>(world->GetWorldCounter(kWorldCounterCellVisible)));
 			}
 			else
 			{
@@ -895,6 +900,11 @@ bool TimeWindow::HandleKeyboardEvent(const KeyboardEventData *eventData)
 				worldStatText[kWorldStatDirectPortals]->SetText("0");
 				worldStatText[kWorldStatRemotePortals]->SetText("0");
 				worldStatText[kWorldStatOcclusionRegions]->SetText("0");
+				worldStatText[kWorldStatCellCount]->SetText("0");
+				worldStatText[kWorldStatCellInsert]->SetText("0");
+				worldStatText[kWorldStatCellUpdate]->SetText("0");
+				worldStatText[kWorldStatCellVisit]->SetText("0");
+				worldStatText[kWorldStatCellVisible]->SetText("0");
 			}
 		}
 		else if (pane == 2)
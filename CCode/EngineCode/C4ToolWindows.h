@@ -186,6 +186,11 @@ namespace C4
 					kWorldStatDirectPortals,
 					kWorldStatRemotePortals,
 					kWorldStatOcclusionRegions,
+					kWorldStatCellCount,
+					kWorldStatCellInsert,
+					kWorldStatCellUpdate,
+					kWorldStatCellVisit,
+					kWorldStatCellVisible,
 					kWorldStatCount
 				};
 
@@ -18,6 +18,7 @@ Value::Value(const Value& value)
 	valueType = value.valueType;
 	valueScope = value.valueScope;
 	valueName = value.valueName;
+	valueAtom = value.valueAtom;
 }
 
 Value::~Value()
@@ -105,6 +106,7 @@ bool Value::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigned
 		case 'NAME':
  
 			data >> valueName;
+			valueAtom = TextAtom(valueName);
 			return (true); 
 	}
 
@@ -200,6 +202,7 @@ void Value::SetSetting(const Setting *setting)
 	if (identifier == 'NAME')
 	{
 		valueName = static_cast<const TextSetting *>(setting)->GetText();
+		valueAtom = TextAtom(valueName);
 	}
 	else if (identifier == 'TYPE')
 	{
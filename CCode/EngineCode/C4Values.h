@@ -9,6 +9,7 @@
 
 
 #include "C4Configuration.h"
+#include "C4Atoms.h"
 
 
 namespace C4
@@ -74,6 +75,7 @@ namespace C4
 			ValueType		valueType;
 			ValueScope		valueScope;
 			ValueName		valueName;
+			TextAtom		valueAtom;
 
 			virtual Value *Replicate(void) const = 0;
 
@@ -84,13 +86,13 @@ namespace C4
 
 		public:
 
-			typedef ConstCharKey KeyType;
+			typedef AtomKey KeyType;
 
 			~Value();
 
 			KeyType GetKey(void) const
 			{
-				return (valueName);
+				return (valueAtom);
 			}
 
 			ValueType GetValueType(void) const
@@ -116,6 +118,7 @@ namespace C4
 			void SetValueName(const char *name)
 			{
 				valueName = name; 
+				valueAtom = TextAtom(valueName);
 			}
 
 			Value *Clone(void) const
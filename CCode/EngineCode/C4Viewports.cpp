@@ -167,6 +167,7 @@ void ViewportWidget::Render(List<Renderable> *renderList)
 {
 	const CameraObject		*graphicsCameraObject;
 	const Transformable		*graphicsCameraTransformable;
+	WidgetBatcher			*widgetBatcher;
 
 	bool cameraFlag = false;
 
@@ -176,6 +177,7 @@ void ViewportWidget::Render(List<Renderable> *renderList)
 		{
 			cameraFlag = true;
 
+			widgetBatcher = TheInterfaceMgr->SuspendWidgetBatcher();
 			TheGraphicsMgr->Draw(renderList);
 			renderList->RemoveAll();
 
@@ -215,6 +217,7 @@ void ViewportWidget::Render(List<Renderable> *renderList)
 		{
 			cameraFlag = true;
 
+			widgetBatcher = TheInterfaceMgr->SuspendWidgetBatcher();
 			TheGraphicsMgr->Draw(renderList);
 			renderList->RemoveAll();
 
@@ -232,6 +235,7 @@ void ViewportWidget::Render(List<Renderable> *renderList)
 	if (cameraFlag)
 	{
 		TheGraphicsMgr->SetCamera(graphicsCameraObject, graphicsCameraTransformable);
+		TheInterfaceMgr->ResumeWidgetBatcher(widgetBatcher);
 	}
 }
 
@@ -1307,7 +1307,17 @@ void Widget::RenderTree(List<Renderable> *renderList)
 			buildFlag = false;
 		}
 
-		Render(renderList);
+		WidgetBatcher *batcher = TheInterfaceMgr->GetWidgetBatcher();
+		if (batcher)
+		{
+			batcher->BeginWidget(renderList);
+			Render(renderList);
+			batcher->EndWidget(this, renderList);
+		}
+		else
+		{
+			Render(renderList);
+		}
 
 		Widget *widget = GetFirstSubnode();
 		while (widget)
@@ -1527,6 +1537,7 @@ RenderableWidget::RenderableWidget(WidgetType type, RenderType renderType) :
 		Renderable(renderType),
 		widgetObserver(this, &RenderableWidget::HandleWidgetEvent)
 {
+	batchUpdateFlag = true;
 }
 
 RenderableWidget::RenderableWidget(WidgetType type, RenderType renderType, const Vector2D& size) :
@@ -1534,6 +1545,7 @@ RenderableWidget::RenderableWidget(WidgetType type, RenderType renderType, const
 		Renderable(renderType),
 		widgetObserver(this, &RenderableWidget::HandleWidgetEvent)
 {
+	batchUpdateFlag = true;
 }
 
 RenderableWidget::RenderableWidget(const RenderableWidget& renderableWidget) :
@@ -1541,6 +1553,7 @@ RenderableWidget::RenderableWidget(const RenderableWidget& renderableWidget) :
 		Renderable(renderableWidget.GetRenderType()),
 		widgetObserver(this, &RenderableWidget::HandleWidgetEvent)
 {
+	batchUpdateFlag = true;
 }
 
 RenderableWidget::~RenderableWidget()
@@ -1561,6 +1574,8 @@ void RenderableWidget::HandleTransformUpdate(void)
 	{
 		renderTransformable.SetWorldTransform(GetWorldTransform());
 	}
+
+	batchUpdateFlag = true;
 }
 
 void RenderableWidget::HandleWidgetEvent(Widget *widget, const WidgetEventData *eventData)
@@ -1710,8 +1725,261 @@ void RenderableWidget::Render(List<Renderable> *renderList)
 {
 	if (GetVertexCount() != 0)
 	{
-		renderList->Append(this);
+		WidgetBatcher *batcher = TheInterfaceMgr->GetWidgetBatcher();
+		if ((!batcher) || (!batcher->AddWidget(this, renderList)))
+		{
+			renderList->Append(this);
+		}
+	}
+}
+
+const Attribute *RenderableWidget::GetBatchAttribute(void) const
+{
+	return (nullptr);
+}
+
+Box2D RenderableWidget::GetBatchBoundingBox(void) const
+{
+	const Vector2D& size = GetWidgetSize();
+	return (Transform(Box2D(Zero2D, Point2D(size.x, size.y)), GetWorldTransform()));
+}
+
+void RenderableWidget::BuildBatch(volatile WidgetBatchVertex *restrict vertex, const Transform4D& transform) const
+{
+}
+
+
+WidgetBatch::WidgetBatch(RootWidget *root) :
+		Renderable(kRenderQuads),
+		vertexBuffer(kVertexBufferAttribute | kVertexBufferDynamic)
+{
+	rootWidget = root;
+
+	memberCount = 0;
+	batchVertexCount = 0;
+	updateFlag = true;
+
+	SetVertexCount(0);
+	SetVertexBuffer(kVertexBufferAttributeArray, &vertexBuffer, sizeof(WidgetBatchVertex));
+	SetVertexAttributeArray(kArrayPosition, 0, 2);
+	SetVertexAttributeArray(kArrayColor, sizeof(Point2D), 1);
+	SetVertexAttributeArray(kArrayTexcoord, sizeof(Point2D) + sizeof(Color4C), 2);
+
+	attributeList.Append(&textureAttribute);
+	SetMaterialAttributeList(&attributeList);
+	SetTransformable(&batchTransformable);
+}
+
+WidgetBatch::~WidgetBatch()
+{
+}
+
+bool WidgetBatch::Match(const RenderableWidget *widget, const Attribute *attribute) const
+{
+	return ((textureAttribute.GetReference() == attribute) && (GetRenderState() == widget->GetRenderState()) && (GetShaderFlags() == widget->GetShaderFlags())
+		&& (GetRenderableFlags() == widget->GetRenderableFlags()) && (GetAmbientBlendState() == widget->GetAmbientBlendState()));
+}
+
+void WidgetBatch::Open(const RenderableWidget *widget, const Attribute *attribute)
+{
+	if (!Match(widget, attribute))
+	{
+		textureAttribute.SetReference(attribute);
+		SetRenderState(widget->GetRenderState());
+		SetShaderFlags(widget->GetShaderFlags());
+		SetRenderableFlags(widget->GetRenderableFlags());
+		SetAmbientBlendState(widget->GetAmbientBlendState());
+
+		InvalidateShaderData();
+		updateFlag = true;
+	}
+
+	memberCount = 0;
+	batchVertexCount = 0;
+	occlusionFlag = false;
+}
+
+void WidgetBatch::AddMember(RenderableWidget *widget)
+{
+	// The members are compared with the members from the previous frame in order,
+	// so a batch whose contents didn't change doesn't need to be rewritten.
+
+	int32 index = memberCount++;
+	if (index < memberArray.GetElementCount())
+	{
+		if (memberArray[index] != widget)
+		{
+			memberArray[index] = widget;
+			updateFlag = true;
+		}
+	}
+	else
+	{
+		memberArray.AddElement(widget);
+		updateFlag = true;
+	}
+
+	batchVertexCount += widget->GetVertexCount();
+}
+
+void WidgetBatch::Occlude(const Box2D& box)
+{
+	if (occlusionFlag)
+	{
+		occlusionBox.Union(box);
+	}
+	else
+	{
+		occlusionBox = box;
+		occlusionFlag = true;
+	}
+}
+
+void WidgetBatch::Finish(void)
+{
+	if (memberArray.GetElementCount() != memberCount)
+	{
+		memberArray.SetElementCount(memberCount);
+		updateFlag = true;
+	}
+
+	for (machine a = 0; a < memberCount; a++)
+	{
+		RenderableWidget *widget = memberArray[a];
+		if (widget->batchUpdateFlag)
+		{
+			widget->batchUpdateFlag = false;
+			updateFlag = true;
+		}
+	}
+
+	batchTransformable.SetWorldTransform(rootWidget->GetWorldTransform());
+
+	if (updateFlag)
+	{
+		updateFlag = false;
+
+		unsigned_int32 size = batchVertexCount * sizeof(WidgetBatchVertex);
+		if (size > vertexBuffer.GetVertexBufferSize())
+		{
+			vertexBuffer.Establish((size + 4095) & ~4095);
+			InvalidateVertexData();
+		}
+
+		if ((size != 0) && (vertexBuffer.Active()))
+		{
+			const Transform4D& inverseTransform = rootWidget->GetInverseWorldTransform();
+			volatile WidgetBatchVertex *restrict vertex = vertexBuffer.BeginUpdate<WidgetBatchVertex>();
+
+			for (machine a = 0; a < memberCount; a++)
+			{
+				const RenderableWidget *widget = memberArray[a];
+				widget->BuildBatch(vertex, inverseTransform * widget->GetWorldTransform());
+				vertex += widget->GetVertexCount();
+			}
+
+			vertexBuffer.EndUpdate();
+		}
+		else
+		{
+			batchVertexCount = 0;
+		}
+
+		SetVertexCount(batchVertexCount);
+	}
+}
+
+
+WidgetBatcher::WidgetBatcher()
+{
+	batchFrame = 0;
+	lastRenderable = nullptr;
+}
+
+WidgetBatcher::~WidgetBatcher()
+{
+}
+
+void WidgetBatcher::Occlude(const Box2D& box, int32 count)
+{
+	for (machine a = 0; a < count; a++)
+	{
+		batchArray[a]->Occlude(box);
+	}
+}
+
+void WidgetBatcher::EndWidget(const Widget *widget, const List<Renderable> *renderList)
+{
+	// If the widget appended anything to the render list outside of a batch, then no widget
+	// rendered later may be moved into a batch in front of it where they could overlap.
+
+	if ((renderList->Last() != lastRenderable) && (batchArray.GetElementCount() != 0))
+	{
+		const Vector2D& size = widget->GetWidgetSize();
+		float margin = (float) kWidgetBatchOcclusionMargin;
+		Box2D box(Point2D(-margin, -margin), Point2D(size.x + margin, size.y + margin));
+
+		Occlude(Transform(box, widget->GetWorldTransform()), batchArray.GetElementCount());
+	}
+}
+
+bool WidgetBatcher::AddWidget(RenderableWidget *widget, List<Renderable> *renderList)
+{
+	const Attribute *attribute = widget->GetBatchAttribute();
+	if (!attribute)
+	{
+		return (false);
+	}
+
+	RootWidget *root = widget->GetRootWidget();
+	if ((!root) || (!root->GetWidgetBatchFlag()))
+	{
+		return (false);
+	}
+
+	Box2D box = widget->GetBatchBoundingBox();
+
+	// Only the most recent matching batch needs to be checked because each batch is
+	// occluded by everything that the batches opened after it are occluded by.
+
+	int32 count = batchArray.GetElementCount();
+	for (machine a = count - 1; a >= 0; a--)
+	{
+		WidgetBatch *batch = batchArray[a];
+		if ((batch->rootWidget == root) && (batch->Match(widget, attribute)))
+		{
+			if ((!batch->occlusionFlag) || (!batch->occlusionBox.Intersection(box)))
+			{
+				batch->AddMember(widget);
+				Occlude(box, (int32) a);
+				return (true);
+			}
+
+			break;
+		}
+	}
+
+	WidgetBatch *batch = root->GetNextWidgetBatch(batchFrame);
+	batch->Open(widget, attribute);
+	batch->AddMember(widget);
+
+	Occlude(box, count);
+	batchArray.AddElement(batch);
+
+	renderList->Append(batch);
+	lastRenderable = batch;
+	return (true);
+}
+
+void WidgetBatcher::Flush(void)
+{
+	int32 count = batchArray.GetElementCount();
+	for (machine a = 0; a < count; a++)
+	{
+		batchArray[a]->Finish();
 	}
+
+	batchArray.Clear();
 }
 
 
@@ -2472,6 +2740,7 @@ void TextWidget::AllocateTextStorage(const char *text, int32 max)
 		Text::CopyText(text, textStorage, textLength);
 	}
 
+	textVertexArray.SetElementCount(vertexCount);
 	vertexBuffer.Establish(vertexCount * sizeof(TextVertex));
 	InvalidateVertexData();
 }
@@ -3167,8 +3436,11 @@ void TextWidget::Build(void)
 	{
 		TextFormatState		savedFormat;
 
-		volatile TextVertex *restrict textVertex = vertexBuffer.BeginUpdate<TextVertex>();
-		volatile TextVertex *textStart = textVertex;
+		// The text is built in system memory so that the vertices are still available
+		// when the widget is rendered as part of a batch.
+
+		TextVertex *textStart = textVertexArray;
+		volatile TextVertex *restrict textVertex = textStart;
 
 		const char *text = textStorage;
 		TextFormatState format = initialFormat;
@@ -3210,15 +3482,63 @@ void TextWidget::Build(void)
 			BuildLine(text, textLength, textRenderOffset, textVertex, &format, &savedFormat);
 		}
 
-		vertexBuffer.EndUpdate();
-		SetVertexCount((int32) (textVertex - textStart));
+		int32 vertexCount = (int32) (textVertex - textStart);
+		if (vertexCount != 0)
+		{
+			vertexBuffer.UpdateBuffer(0, vertexCount * sizeof(TextVertex), textStart);
+
+			textVertexBox.min = textStart[0].position;
+			textVertexBox.max = textStart[0].position;
+			for (machine a = 1; a < vertexCount; a++)
+			{
+				textVertexBox.IncludePoint(textStart[a].position);
+			}
+		}
 
+		SetVertexCount(vertexCount);
 		referenceAttribute.SetReference(textFont->GetTextureAttribute());
 	}
 	else
 	{
 		SetVertexCount(0);
 	}
+
+	// Any batch containing this widget has to copy the new vertices.
+
+	InvalidateBatch();
+}
+
+const Attribute *TextWidget::GetBatchAttribute(void) const
+{
+	// Subclasses of TextWidget render additional geometry around the text,
+	// so only plain text widgets can be moved into a batch.
+
+	if (GetWidgetType() == kWidgetText)
+	{
+		return (referenceAttribute.GetReference());
+	}
+
+	return (nullptr);
+}
+
+Box2D TextWidget::GetBatchBoundingBox(void) const
+{
+	return (Transform(textVertexBox, GetWorldTransform()));
+}
+
+void TextWidget::BuildBatch(volatile WidgetBatchVertex *restrict vertex, const Transform4D& transform) const
+{
+	const TextVertex *textVertex = textVertexArray;
+
+	int32 vertexCount = GetVertexCount();
+	for (machine a = 0; a < vertexCount; a++)
+	{
+		const Point2D& p = textVertex[a].position;
+		Point3D q = transform * Point3D(p.x, p.y, 0.0F);
+		vertex[a].position.Set(q.x, q.y);
+		vertex[a].color = textVertex[a].color;
+		vertex[a].texcoord = textVertex[a].texcoord;
+	}
 }
 
 
@@ -10776,6 +11096,14 @@ ListWidget::ListWidget(WidgetType type) :
 	displayItemIndex = 0;
 	selectionVertex = nullptr;
 
+	virtualItemProc = nullptr;
+	virtualFilterProc = nullptr;
+	virtualItemCount = 0;
+	virtualFilterPosition = -1;
+	virtualAnchorPosition = -1;
+	virtualCursorPosition = -1;
+	virtualSelectionCount = 0;
+
 	SetActiveUpdateFlags(GetActiveUpdateFlags() | kUpdateStructure);
 	SetWidgetUsage(kWidgetKeyboardFocus | kWidgetMouseWheel);
 
@@ -10819,6 +11147,14 @@ ListWidget::ListWidget(WidgetType type, const Vector2D& size, float spacing, con
 	displayItemIndex = 0;
 	selectionVertex = nullptr;
 
+	virtualItemProc = nullptr;
+	virtualFilterProc = nullptr;
+	virtualItemCount = 0;
+	virtualFilterPosition = -1;
+	virtualAnchorPosition = -1;
+	virtualCursorPosition = -1;
+	virtualSelectionCount = 0;
+
 	SetWidgetUsage(kWidgetKeyboardFocus | kWidgetMouseWheel);
 	SetActiveUpdateFlags(GetActiveUpdateFlags() | kUpdateStructure);
 
@@ -10858,6 +11194,14 @@ ListWidget::ListWidget(const ListWidget& listWidget) :
 	displayItemIndex = 0;
 	selectionVertex = nullptr;
 
+	virtualItemProc = nullptr;
+	virtualFilterProc = nullptr;
+	virtualItemCount = 0;
+	virtualFilterPosition = -1;
+	virtualAnchorPosition = -1;
+	virtualCursorPosition = -1;
+	virtualSelectionCount = 0;
+
 	SetActiveUpdateFlags(GetActiveUpdateFlags() | kUpdateStructure);
 }
 
@@ -11348,6 +11692,30 @@ void ListWidget::Preprocess(void)
 
 	preprocessFlag = true;
 	listUpdateFlags = kListUpdatePlacement | kListUpdateVisibility | kListUpdateSelection;
+
+	if (virtualFilterPosition >= 0)
+	{
+		RootWidget *root = GetRootWidget();
+		if (root)
+		{
+			root->AddMovingWidget(this);
+		}
+	}
+}
+
+void ListWidget::Move(void)
+{
+	RenderableWidget::Move();
+
+	if (virtualFilterPosition >= 0)
+	{
+		ContinueVirtualFilter();
+	}
+
+	if ((virtualFilterPosition < 0) && (!GetFirstMutator()))
+	{
+		GetRootWidget()->RemoveMovingWidget(this);
+	}
 }
 
 void ListWidget::EnterForeground(void)
@@ -11366,14 +11734,21 @@ void ListWidget::UpdatePlacement(void)
 {
 	listUpdateFlags &= ~kListUpdatePlacement;
 
-	float y = itemOffset.y;
-	Widget *widget = itemGroup.GetFirstSubnode();
-	while (widget)
+	if (!virtualItemProc)
 	{
-		widget->SetWidgetPosition(Point3D(itemOffset.x, y, 0.0F));
+		float y = itemOffset.y;
+		Widget *widget = itemGroup.GetFirstSubnode();
+		while (widget)
+		{
+			widget->SetWidgetPosition(Point3D(itemOffset.x, y, 0.0F));
 
-		y += itemSpacing;
-		widget = widget->Next();
+			y += itemSpacing;
+			widget = widget->Next();
+		}
+	}
+	else
+	{
+		virtualRebindFlag = true;
 	}
 
 	UpdateVisibility();
@@ -11400,28 +11775,41 @@ void ListWidget::UpdateVisibility(void)
 	listVertexBuffer.Establish(sizeof(ListVertex) * (vertexCount + 4));
 	InvalidateVertexData();
 
-	machine index = 0;
-	Widget *widget = itemGroup.GetFirstSubnode();
-	while (widget)
+	if (!virtualItemProc)
 	{
-		if ((unsigned_int32) (index - displayItemIndex) < (unsigned_int32) displayItemCount)
+		machine index = 0;
+		Widget *widget = itemGroup.GetFirstSubnode();
+		while (widget)
 		{
-			widget->Show();
-			if (index == displayItemIndex)
+			if ((unsigned_int32) (index - displayItemIndex) < (unsigned_int32) displayItemCount)
 			{
-				displayItem = widget;
+				widget->Show();
+				if (index == displayItemIndex)
+				{
+					displayItem = widget;
+				}
 			}
-		}
-		else
-		{
-			widget->Hide();
+			else
+			{
+				widget->Hide();
+			}
+
+			index++;
+			widget = widget->Next();
 		}
 
-		index++;
-		widget = widget->Next();
+		itemGroup.SetWidgetPosition(Point3D(0.0F, -itemSpacing * (float) displayItemIndex, 0.0F));
+	}
+	else
+	{
+		// In virtual mode, the item group only contains widgets for the visible rows,
+		// and they are positioned relative to the top of the list.
+
+		UpdateVirtualItems();
+		displayItem = itemGroup.GetFirstSubnode();
+		itemGroup.SetWidgetPosition(Point3D(0.0F, 0.0F, 0.0F));
 	}
 
-	itemGroup.SetWidgetPosition(Point3D(0.0F, -itemSpacing * (float) displayItemIndex, 0.0F));
 	itemGroup.Invalidate();
 
 	UpdateSelection();
@@ -11431,6 +11819,27 @@ void ListWidget::UpdateSelection(void)
 {
 	listUpdateFlags &= ~kListUpdateSelection;
 
+	if (virtualItemProc)
+	{
+		const int32 *rowIndex = virtualRowArray;
+
+		Widget *row = itemGroup.GetFirstSubnode();
+		while (row)
+		{
+			unsigned_int32 state = row->GetWidgetState();
+			if (GetVirtualSelection(*rowIndex++))
+			{
+				row->SetWidgetState(state | kWidgetSelected);
+			}
+			else
+			{
+				row->SetWidgetState(state & ~kWidgetSelected);
+			}
+
+			row = row->Next();
+		}
+	}
+
 	int32 selectCount = 0;
 	const Widget *widget = displayItem;
 
@@ -11571,6 +11980,12 @@ void ListWidget::HandleMouseEvent(const PanelMouseEventData *eventData)
 			bool activate = ((eventData->eventFlags & kMouseDoubleClick) && (index == clickItemIndex));
 			clickItemIndex = index;
 
+			if (virtualItemProc)
+			{
+				HandleVirtualMouseDown(index, activate, eventData);
+				return;
+			}
+
 			Widget *selection = GetListItem(index);
 			if ((selection) && (!(selection->GetWidgetState() & kWidgetInactive)))
 			{
@@ -11815,6 +12230,11 @@ void ListWidget::HandleDownArrow(unsigned_int32 modifierKeys)
 
 bool ListWidget::HandleKeyboardEvent(const KeyboardEventData *eventData)
 {
+	if (virtualItemProc)
+	{
+		return (HandleVirtualKeyboardEvent(eventData));
+	}
+
 	EventType eventType = eventData->eventType;
 	if (eventType == kEventKeyDown)
 	{
@@ -12285,6 +12705,12 @@ bool ListWidget::RemoveListItem(Widget *widget)
 
 void ListWidget::PurgeListItems(void)
 {
+	if (virtualItemProc)
+	{
+		SetVirtualItemCount(0);
+		return;
+	}
+
 	itemGroup.PurgeSubtree();
 	listItemCount = 0;
 
@@ -12311,6 +12737,11 @@ void ListWidget::PurgeSelectedListItems(void)
 
 int32 ListWidget::GetSelectedListItemCount(void) const
 {
+	if (virtualItemProc)
+	{
+		return (virtualSelectionCount);
+	}
+
 	int32 count = 0;
 
 	Widget *widget = itemGroup.GetFirstSubnode();
@@ -12545,7 +12976,29 @@ void ListWidget::SelectAllListItems(bool post)
 	bool change = false;
 	Widget *widget = itemGroup.GetFirstSubnode();
 
-	if (listFlags & kListMultipleSelection)
+	if (virtualItemProc)
+	{
+		const int32 *indexTable = virtualIndexArray;
+
+		if (listFlags & kListMultipleSelection)
+		{
+			for (machine a = 0; a < listItemCount; a++)
+			{
+				change |= SetVirtualSelection(indexTable[a], true);
+			}
+		}
+		else if (listItemCount > 0)
+		{
+			int32 index = indexTable[0];
+			if ((virtualSelectionCount != 1) || (!GetVirtualSelection(index)))
+			{
+				ClearVirtualSelection();
+				SetVirtualSelection(index, true);
+				change = true;
+			}
+		}
+	}
+	else if (listFlags & kListMultipleSelection)
 	{
 		while (widget)
 		{
@@ -12592,7 +13045,8 @@ void ListWidget::SelectAllListItems(bool post)
 
 void ListWidget::UnselectAllListItems(bool post)
 {
-	bool change = false;
+	bool change = (virtualSelectionCount != 0);
+	ClearVirtualSelection();
 
 	Widget *widget = itemGroup.GetFirstSubnode();
 	while (widget)
@@ -12621,6 +13075,535 @@ void ListWidget::SetDisplayIndex(int32 index)
 	SetListUpdateFlags(kListUpdateVisibility);
 }
 
+float ListWidget::GetVirtualItemIndent(int32 index) const
+{
+	return (0.0F);
+}
+
+bool ListWidget::SetVirtualSelection(int32 index, bool selected)
+{
+	unsigned_int32 *bits = &virtualSelectionArray[index >> 5];
+	unsigned_int32 mask = 1 << (index & 31);
+
+	if (((*bits & mask) != 0) != selected)
+	{
+		*bits ^= mask;
+		virtualSelectionCount += (selected) ? 1 : -1;
+		return (true);
+	}
+
+	return (false);
+}
+
+void ListWidget::ClearVirtualSelection(void)
+{
+	if (virtualSelectionCount != 0)
+	{
+		int32 count = virtualSelectionArray.GetElementCount();
+		unsigned_int32 *bits = virtualSelectionArray;
+		for (machine a = 0; a < count; a++)
+		{
+			bits[a] = 0;
+		}
+
+		virtualSelectionCount = 0;
+	}
+}
+
+void ListWidget::SetVirtualItemProc(VirtualItemProc *proc, void *cookie)
+{
+	if ((proc != nullptr) != (virtualItemProc != nullptr))
+	{
+		itemGroup.PurgeSubtree();
+		virtualRowArray.Purge();
+
+		virtualIndexArray.Purge();
+		virtualSelectionArray.Purge();
+		virtualSelectionCount = 0;
+
+		listItemCount = 0;
+		virtualItemCount = 0;
+		virtualFilterPosition = -1;
+
+		displayItemIndex = 0;
+		clickItemIndex = -1;
+		virtualAnchorPosition = -1;
+		virtualCursorPosition = -1;
+	}
+
+	virtualItemProc = proc;
+	virtualItemCookie = cookie;
+
+	InvalidateVirtualItems();
+}
+
+void ListWidget::SetVirtualItemCount(int32 count)
+{
+	virtualItemCount = count;
+	virtualIndexArray.SetElementCount(count);
+
+	unsigned_int32 zero = 0;
+	virtualSelectionArray.Clear();
+	virtualSelectionArray.SetElementCount((count + 31) >> 5, &zero);
+	virtualSelectionCount = 0;
+
+	virtualRebindFlag = true;
+	StartVirtualFilter(false);
+}
+
+void ListWidget::InvalidateVirtualItems(void)
+{
+	virtualRebindFlag = true;
+	SetListUpdateFlags(kListUpdateVisibility);
+}
+
+void ListWidget::SetVirtualFilterProc(VirtualFilterProc *proc, void *cookie, bool refine)
+{
+	virtualFilterProc = proc;
+	virtualFilterCookie = cookie;
+
+	StartVirtualFilter((refine) && (proc) && (virtualFilterPosition < 0));
+}
+
+void ListWidget::StartVirtualFilter(bool refine)
+{
+	if (!virtualItemProc)
+	{
+		return;
+	}
+
+	// When a filter is refined, only the items that passed the previous filter are tested,
+	// and the index array is compacted in place as they are.
+
+	virtualRefineFlag = refine;
+	virtualCandidateCount = listItemCount;
+	virtualFilterPosition = 0;
+	listItemCount = 0;
+
+	clickItemIndex = -1;
+	virtualAnchorPosition = -1;
+	virtualCursorPosition = -1;
+
+	ContinueVirtualFilter();
+
+	if ((virtualFilterPosition >= 0) && (preprocessFlag))
+	{
+		RootWidget *root = GetRootWidget();
+		if (root)
+		{
+			root->AddMovingWidget(this);
+		}
+		else
+		{
+			do
+			{
+				ContinueVirtualFilter();
+			} while (virtualFilterPosition >= 0);
+		}
+	}
+}
+
+void ListWidget::ContinueVirtualFilter(void)
+{
+	int32 *indexTable = virtualIndexArray;
+	int32 position = virtualFilterPosition;
+	int32 count = listItemCount;
+
+	if (!virtualRefineFlag)
+	{
+		int32 itemCount = virtualItemCount;
+		if (virtualFilterProc)
+		{
+			int32 last = Min(position + kVirtualFilterStepCount, itemCount);
+			for (; position < last; position++)
+			{
+				if ((*virtualFilterProc)(position, this, virtualFilterCookie))
+				{
+					indexTable[count++] = position;
+				}
+			}
+		}
+		else
+		{
+			for (; position < itemCount; position++)
+			{
+				indexTable[count++] = position;
+			}
+		}
+
+		virtualFilterPosition = (position < itemCount) ? position : -1;
+	}
+	else
+	{
+		int32 candidateCount = virtualCandidateCount;
+		int32 last = Min(position + kVirtualFilterStepCount, candidateCount);
+		for (; position < last; position++)
+		{
+			int32 index = indexTable[position];
+			if ((*virtualFilterProc)(index, this, virtualFilterCookie))
+			{
+				indexTable[count++] = index;
+			}
+		}
+
+		virtualFilterPosition = (position < candidateCount) ? position : -1;
+	}
+
+	listItemCount = count;
+	SetListUpdateFlags(kListUpdateVisibility);
+}
+
+void ListWidget::UpdateVirtualItems(void)
+{
+	Array<Widget *, 64>		rowWidget;
+	Array<Widget *, 64>		freeWidget;
+
+	int32 rowCount = MaxZero(Min(displayItemCount, listItemCount - displayItemIndex));
+	const int32 *indexTable = virtualIndexArray;
+	indexTable += displayItemIndex;
+
+	Widget *nullWidget = nullptr;
+	rowWidget.SetElementCount(rowCount, &nullWidget);
+
+	// Widgets that are already displaying an item that is still visible are kept, and all other
+	// widgets are recycled. The old rows and the new rows are both sorted by data source index,
+	// so they can be matched in a single pass.
+
+	int32 oldCount = virtualRowArray.GetElementCount();
+	const int32 *oldIndex = virtualRowArray;
+
+	machine row = 0;
+	Widget *widget = itemGroup.GetFirstSubnode();
+	for (machine a = 0; a < oldCount; a++)
+	{
+		bool match = false;
+		if (!virtualRebindFlag)
+		{
+			int32 index = oldIndex[a];
+			while ((row < rowCount) && (indexTable[row] < index))
+			{
+				row++;
+			}
+
+			if ((row < rowCount) && (indexTable[row] == index))
+			{
+				rowWidget[row++] = widget;
+				match = true;
+			}
+		}
+
+		if (!match)
+		{
+			freeWidget.AddElement(widget);
+		}
+
+		widget = widget->Next();
+	}
+
+	virtualRebindFlag = false;
+	virtualRowArray.SetElementCount(rowCount);
+	int32 *rowIndex = virtualRowArray;
+
+	int32 freeCount = freeWidget.GetElementCount();
+	float y = itemOffset.y;
+
+	for (machine a = 0; a < rowCount; a++)
+	{
+		int32 index = indexTable[a];
+		bool created = false;
+
+		widget = rowWidget[a];
+		if (!widget)
+		{
+			Widget *recycled = (freeCount > 0) ? freeWidget[--freeCount] : nullptr;
+			widget = (*virtualItemProc)(index, recycled, this, virtualItemCookie);
+			if (widget != recycled)
+			{
+				delete recycled;
+				created = true;
+
+				if (!(listFlags & kListItemsEnabled))
+				{
+					widget->Disable();
+				}
+			}
+		}
+
+		rowIndex[a] = index;
+		itemGroup.AppendSubnode(widget);
+
+		if ((created) && (preprocessFlag))
+		{
+			widget->Preprocess();
+		}
+
+		widget->SetWidgetPosition(Point3D(itemOffset.x + GetVirtualItemIndent(index), y, 0.0F));
+		widget->Invalidate();
+		widget->Show();
+
+		y += itemSpacing;
+	}
+
+	for (machine a = 0; a < freeCount; a++)
+	{
+		delete freeWidget[a];
+	}
+}
+
+int32 ListWidget::FindVirtualItemPosition(int32 index) const
+{
+	const int32 *indexTable = virtualIndexArray;
+
+	int32 first = 0;
+	int32 last = listItemCount;
+	while (first < last)
+	{
+		int32 middle = (first + last) >> 1;
+		int32 value = indexTable[middle];
+
+		if (value < index)
+		{
+			first = middle + 1;
+		}
+		else if (value > index)
+		{
+			last = middle;
+		}
+		else
+		{
+			return (middle);
+		}
+	}
+
+	return (-1);
+}
+
+void ListWidget::RevealVirtualItem(int32 index)
+{
+	int32 position = FindVirtualItemPosition(index);
+	if (position >= 0)
+	{
+		RevealListItem(position);
+	}
+}
+
+void ListWidget::SelectVirtualItem(int32 index, bool post)
+{
+	if ((unsigned_int32) index < (unsigned_int32) virtualItemCount)
+	{
+		bool change = false;
+
+		if (!(listFlags & kListMultipleSelection))
+		{
+			if ((virtualSelectionCount != 1) || (!GetVirtualSelection(index)))
+			{
+				ClearVirtualSelection();
+				SetVirtualSelection(index, true);
+				change = true;
+			}
+		}
+		else
+		{
+			change = SetVirtualSelection(index, true);
+		}
+
+		SetListUpdateFlags(kListUpdateSelection);
+
+		if (post & change)
+		{
+			PostWidgetEvent(WidgetEventData(kEventWidgetChange));
+		}
+	}
+}
+
+void ListWidget::UnselectVirtualItem(int32 index, bool post)
+{
+	if ((unsigned_int32) index < (unsigned_int32) virtualItemCount)
+	{
+		bool change = SetVirtualSelection(index, false);
+		SetListUpdateFlags(kListUpdateSelection);
+
+		if (post & change)
+		{
+			PostWidgetEvent(WidgetEventData(kEventWidgetChange));
+		}
+	}
+}
+
+int32 ListWidget::GetFirstSelectedVirtualItem(void) const
+{
+	return (GetNextSelectedVirtualItem(-1));
+}
+
+int32 ListWidget::GetNextSelectedVirtualItem(int32 index) const
+{
+	int32 next = index + 1;
+	if ((virtualSelectionCount != 0) && (next < virtualItemCount))
+	{
+		const unsigned_int32 *bits = virtualSelectionArray;
+		int32 wordCount = virtualSelectionArray.GetElementCount();
+
+		int32 word = next >> 5;
+		unsigned_int32 mask = bits[word] & (0xFFFFFFFF << (next & 31));
+		for (;;)
+		{
+			if (mask != 0)
+			{
+				return ((word << 5) + 31 - Cntlz(mask & (0 - mask)));
+			}
+
+			if (++word == wordCount)
+			{
+				break;
+			}
+
+			mask = bits[word];
+		}
+	}
+
+	return (-1);
+}
+
+void ListWidget::SelectVirtualPosition(int32 position, bool extend)
+{
+	const int32 *indexTable = virtualIndexArray;
+
+	ClearVirtualSelection();
+
+	int32 anchor = virtualAnchorPosition;
+	if ((extend) && (anchor >= 0) && (anchor < listItemCount))
+	{
+		int32 first = Min(anchor, position);
+		int32 last = Max(anchor, position);
+		for (machine a = first; a <= last; a++)
+		{
+			SetVirtualSelection(indexTable[a], true);
+		}
+	}
+	else
+	{
+		SetVirtualSelection(indexTable[position], true);
+		virtualAnchorPosition = position;
+	}
+
+	virtualCursorPosition = position;
+	RevealListItem(position);
+
+	SetListUpdateFlags(kListUpdateSelection);
+	PostWidgetEvent(WidgetEventData(kEventWidgetChange));
+}
+
+void ListWidget::HandleVirtualMouseDown(int32 position, bool activate, const PanelMouseEventData *eventData)
+{
+	int32 index = virtualIndexArray[position];
+
+	if (!(listFlags & kListMultipleSelection))
+	{
+		if (!GetVirtualSelection(index))
+		{
+			SelectVirtualPosition(position, false);
+		}
+		else if (activate)
+		{
+			Activate(eventData->initiatorNode);
+		}
+	}
+	else
+	{
+		unsigned_int32 modifiers = InterfaceMgr::GetModifierKeys();
+		if (modifiers & kModifierKeyShift)
+		{
+			SelectVirtualPosition(position, true);
+		}
+		else if (modifiers & kModifierKeyCommand)
+		{
+			SetVirtualSelection(index, !GetVirtualSelection(index));
+			virtualAnchorPosition = position;
+			virtualCursorPosition = position;
+
+			SetListUpdateFlags(kListUpdateSelection);
+			PostWidgetEvent(WidgetEventData(kEventWidgetChange));
+		}
+		else if ((virtualSelectionCount != 1) || (!GetVirtualSelection(index)))
+		{
+			SelectVirtualPosition(position, false);
+		}
+		else if (activate)
+		{
+			Activate(eventData->initiatorNode);
+		}
+	}
+}
+
+bool ListWidget::HandleVirtualKeyboardEvent(const KeyboardEventData *eventData)
+{
+	EventType eventType = eventData->eventType;
+	if (eventType == kEventKeyDown)
+	{
+		int32 position = 0;
+		int32 cursor = virtualCursorPosition;
+		int32 maxIndex = MaxZero(listItemCount - displayItemCount);
+		bool extend = false;
+
+		unsigned_int32 keyCode = eventData->keyCode;
+		if (keyCode == kKeyCodeUpArrow)
+		{
+			position = (cursor >= 0) ? MaxZero(cursor - 1) : 0;
+			extend = ((listFlags & kListMultipleSelection) && (eventData->modifierKeys & kModifierKeyShift));
+		}
+		else if (keyCode == kKeyCodeDownArrow)
+		{
+			position = (cursor >= 0) ? cursor + 1 : listItemCount - 1;
+			extend = ((listFlags & kListMultipleSelection) && (eventData->modifierKeys & kModifierKeyShift));
+		}
+		else if (keyCode == kKeyCodePageUp)
+		{
+			position = MaxZero(displayItemIndex - displayItemCount + 1);
+			displayItemIndex = Min(position, maxIndex);
+		}
+		else if (keyCode == kKeyCodePageDown)
+		{
+			position = displayItemIndex + displayItemCount - 1;
+			displayItemIndex = Min(position, maxIndex);
+		}
+		else if (keyCode == kKeyCodeHome)
+		{
+			position = 0;
+			displayItemIndex = 0;
+		}
+		else if (keyCode == kKeyCodeEnd)
+		{
+			position = listItemCount - 1;
+			displayItemIndex = maxIndex;
+		}
+		else
+		{
+			return (false);
+		}
+
+		if (listItemCount > 0)
+		{
+			SelectVirtualPosition(MaxZero(Min(position, listItemCount - 1)), extend);
+		}
+
+		SetListUpdateFlags(kListUpdateVisibility);
+		return (true);
+	}
+	else if (eventType == kEventKeyCommand)
+	{
+		if (listFlags & kListMultipleSelection)
+		{
+			if (eventData->keyCode == 'A')
+			{
+				SelectAllListItems(true);
+				return (true);
+			}
+		}
+	}
+
+	return (false);
+}
+
 
 TreeItemWidget::TreeItemWidget(Widget *widget) :
 		RenderableWidget(kWidgetTreeItem, kRenderQuads),
@@ -12828,22 +13811,35 @@ void TreeItemWidget::HandleCollapseEvent(Widget *widget, const WidgetEventData *
 
 TreeWidget::TreeWidget() : ListWidget(kWidgetTree)
 {
+	virtualDepthProc = nullptr;
 }
 
 TreeWidget::TreeWidget(const Vector2D& size, float spacing, const char *font) : ListWidget(kWidgetTree, size, spacing, font)
 {
 	indentSpacing = 14.0F;
+	virtualDepthProc = nullptr;
 }
 
 TreeWidget::TreeWidget(const TreeWidget& treeWidget) : ListWidget(treeWidget)
 {
 	indentSpacing = treeWidget.indentSpacing;
+	virtualDepthProc = nullptr;
 }
 
 TreeWidget::~TreeWidget()
 {
 }
 
+float TreeWidget::GetVirtualItemIndent(int32 index) const
+{
+	if (virtualDepthProc)
+	{
+		return ((float) (*virtualDepthProc)(index, this, virtualDepthCookie) * indentSpacing);
+	}
+
+	return (0.0F);
+}
+
 Widget *TreeWidget::Replicate(void) const
 {
 	return (new TreeWidget(*this));
@@ -16602,6 +17598,10 @@ RootWidget::RootWidget(WidgetType type) :
 {
 	SetBaseWidgetType(kWidgetRoot);
 	widgetMoveParity = 0;
+
+	widgetBatchFlag = false;
+	widgetBatchFrame = 0;
+	widgetBatchIndex = 0;
 }
 
 RootWidget::RootWidget(WidgetType type, const Vector2D& size) :
@@ -16610,6 +17610,10 @@ RootWidget::RootWidget(WidgetType type, const Vector2D& size) :
 {
 	SetBaseWidgetType(kWidgetRoot);
 	widgetMoveParity = 0;
+
+	widgetBatchFlag = false;
+	widgetBatchFrame = 0;
+	widgetBatchIndex = 0;
 }
 
 RootWidget::RootWidget(const RootWidget& rootWidget) :
@@ -16617,13 +17621,43 @@ RootWidget::RootWidget(const RootWidget& rootWidget) :
 		widgetHashTable(16, 4)
 {
 	widgetMoveParity = 0;
+
+	widgetBatchFlag = rootWidget.widgetBatchFlag;
+	widgetBatchFrame = 0;
+	widgetBatchIndex = 0;
 }
 
 RootWidget::~RootWidget()
 {
+	int32 count = widgetBatchArray.GetElementCount();
+	for (machine a = 0; a < count; a++)
+	{
+		delete widgetBatchArray[a];
+	}
+
 	widgetHashTable.RemoveAll();
 }
 
+WidgetBatch *RootWidget::GetNextWidgetBatch(unsigned_int32 frame)
+{
+	// The batches are handed out in the same order every frame so that a batch
+	// usually receives the same members that it had in the previous frame.
+
+	if (widgetBatchFrame != frame)
+	{
+		widgetBatchFrame = frame;
+		widgetBatchIndex = 0;
+	}
+
+	int32 index = widgetBatchIndex++;
+	if (index == widgetBatchArray.GetElementCount())
+	{
+		widgetBatchArray.AddElement(new WidgetBatch(this));
+	}
+
+	return (widgetBatchArray[index]);
+}
+
 void RootWidget::Preprocess(void)
 {
 	Widget::Preprocess();
@@ -16795,10 +17829,12 @@ void Panel::Move(void)
 
 Board::Board() : RootWidget(kWidgetBoard)
 {
+	SetWidgetBatchFlag(true);
 }
 
 Board::Board(const Vector2D& size) : RootWidget(kWidgetBoard, size)
 {
+	SetWidgetBatchFlag(true);
 }
 
 Board::~Board()
@@ -16814,6 +17850,7 @@ C4::Window::Window(const char *panelName) :
 {
 	windowFlags = 0;
 	minWindowSize.Set(32.0F, 32.0F);
+	SetWidgetBatchFlag(true);
 
 	Load(panelName);
 
@@ -16835,6 +17872,7 @@ C4::Window::Window(const Vector2D& size, const char *title, unsigned_int32 flags
 {
 	windowFlags = flags;
 	minWindowSize.Set(32.0F, 32.0F);
+	SetWidgetBatchFlag(true);
 
 	if (title)
 	{
@@ -17954,6 +18992,7 @@ void BookWidget::UpdateBoundingBox(void)
 
 void BookWidget::RenderTree(List<Renderable> *renderList)
 {
+	TheInterfaceMgr->FlushWidgetBatches();
 	TheGraphicsMgr->Draw(renderList);
 	renderList->RemoveAll();
 
@@ -17967,6 +19006,7 @@ void BookWidget::RenderTree(List<Renderable> *renderList)
 	TheGraphicsMgr->BeginClip(rect);
 
 	Widget::RenderTree(renderList);
+	TheInterfaceMgr->FlushWidgetBatches();
 	TheGraphicsMgr->Draw(renderList);
 	renderList->RemoveAll();
 
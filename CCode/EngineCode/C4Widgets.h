@@ -88,7 +88,8 @@ namespace C4
 
 	enum
 	{
-		kMaxWidgetKeyLength		= 15
+		kMaxWidgetKeyLength			= 15,
+		kWidgetBatchOcclusionMargin	= 8
 	};
 
 
@@ -430,6 +431,7 @@ namespace C4
 	class BookWidget;
 	class RootWidget;
 	class Window;
+	class WidgetBatch;
 	class ColorPicker;
 	struct PanelResourceHeader;
 	class PanelController;
@@ -2013,6 +2015,14 @@ namespace C4
 	};
 
 
+	struct WidgetBatchVertex
+	{
+		Point2D		position;
+		Color4C		color;
+		Point2D		texcoord;
+	};
+
+
 	//# \class	RenderableWidget	The base class for all renderable widgets.
 	//
 	//# Every renderable user interface widget is a subclass of the $RenderableWidget$ class.
@@ -2038,11 +2048,15 @@ namespace C4
 
 	class RenderableWidget : public Widget, public Renderable
 	{
+		friend class WidgetBatch;
+
 		private:
 
 			Transformable						renderTransformable;
 			WidgetObserver<RenderableWidget>	widgetObserver;
 
+			bool								batchUpdateFlag;
+
 			void HandleWidgetEvent(Widget *widget, const WidgetEventData *eventData);
 
 		protected:
@@ -2068,6 +2082,11 @@ namespace C4
 				return (&renderTransformable);
 			}
 
+			void InvalidateBatch(void)
+			{
+				batchUpdateFlag = true;
+			}
+
 			C4API void HandleTransformUpdate(void) override;
 
 			C4API void InitRenderable(Renderable *renderable);
@@ -2081,6 +2100,94 @@ namespace C4
 
 			C4API void Preprocess(void) override;
 			C4API void Render(List<Renderable> *renderList) override;
+
+			C4API virtual const Attribute *GetBatchAttribute(void) const;
+			C4API virtual Box2D GetBatchBoundingBox(void) const;
+			C4API virtual void BuildBatch(volatile WidgetBatchVertex *restrict vertex, const Transform4D& transform) const;
+	};
+
+
+	// A WidgetBatch object holds the combined geometry of consecutive widgets belonging to the same window or board
+	// that share the same texture and render state. The geometry is transformed into the coordinate space of the root
+	// widget and stored in a single dynamic vertex buffer so that the whole batch is rendered with one draw call. The
+	// vertex buffer is only rewritten when the set of member widgets changes or one of the members has been rebuilt.
+
+	class WidgetBatch : public Renderable
+	{
+		friend class WidgetBatcher;
+
+		private:
+
+			RootWidget					*rootWidget;
+
+			VertexBuffer				vertexBuffer;
+			List<Attribute>				attributeList;
+			ReferenceAttribute			textureAttribute;
+			Transformable				batchTransformable;
+
+			int32						memberCount;
+			int32						batchVertexCount;
+			Array<RenderableWidget *>	memberArray;
+
+			bool						updateFlag;
+			bool						occlusionFlag;
+			Box2D						occlusionBox;
+
+			bool Match(const RenderableWidget *widget, const Attribute *attribute) const;
+
+			void Open(const RenderableWidget *widget, const Attribute *attribute);
+			void AddMember(RenderableWidget *widget);
+			void Occlude(const Box2D& box);
+			void Finish(void);
+
+		public:
+
+			WidgetBatch(RootWidget *root);
+			~WidgetBatch();
+
+			int32 GetMemberCount(void) const
+			{
+				return (memberCount);
+			}
+	};
+
+
+	// The WidgetBatcher class collects batchable widgets into WidgetBatch objects while the Interface Manager
+	// renders the widget trees. A widget may only be added to an existing batch if its geometry doesn't overlap
+	// anything that was submitted after the batch was opened, so the final image is the same as it would be if
+	// every widget were drawn individually. All open batches must be finished by calling the Flush() function
+	// before the render list is drawn.
+
+	class WidgetBatcher
+	{
+		private:
+
+			unsigned_int32				batchFrame;
+			Array<WidgetBatch *, 16>	batchArray;
+
+			const Renderable			*lastRenderable;
+
+			void Occlude(const Box2D& box, int32 count);
+
+		public:
+
+			WidgetBatcher();
+			~WidgetBatcher();
+
+			void BeginFrame(void)
+			{
+				batchFrame++;
+			}
+
+			void BeginWidget(const List<Renderable> *renderList)
+			{
+				lastRenderable = renderList->Last();
+			}
+
+			void EndWidget(const Widget *widget, const List<Renderable> *renderList);
+
+			bool AddWidget(RenderableWidget *widget, List<Renderable> *renderList);
+			void Flush(void);
 	};
 
 
@@ -2704,6 +2811,9 @@ namespace C4
 			List<Attribute>			attributeList;
 			ReferenceAttribute		referenceAttribute;
 
+			Array<TextVertex>		textVertexArray;
+			Box2D					textVertexBox;
+
 			Font					*textFont;
 			ResourceName			fontName;
 
@@ -2867,6 +2977,10 @@ namespace C4
 
 			C4API void Preprocess(void) override;
 			C4API void Build(void) override;
+
+			C4API const Attribute *GetBatchAttribute(void) const override;
+			C4API Box2D GetBatchBoundingBox(void) const override;
+			C4API void BuildBatch(volatile WidgetBatchVertex *restrict vertex, const Transform4D& transform) const override;
 	};
 
 
@@ -4899,10 +5013,141 @@ namespace C4
 	//# \also	$@ListWidget::PrependListItem@$
 
 
+	//# \function	ListWidget::SetVirtualItemProc		Puts a list widget into virtual mode.
+	//
+	//# \proto	void SetVirtualItemProc(VirtualItemProc *proc, void *cookie = nullptr);
+	//
+	//# \param	proc	A pointer to the function that supplies the widgets for visible items, or $nullptr$ to leave virtual mode.
+	//# \param	cookie	A user-defined pointer that is passed to the item function.
+	//
+	//# \desc
+	//# The $SetVirtualItemProc$ function puts a list widget into virtual mode, in which the items are not stored
+	//# as subwidgets of the list but are supplied on demand by a data source. Only the items that are currently
+	//# visible are ever represented by widgets, so a virtual list can hold millions of items at the cost of a few
+	//# screenfuls of widgets. Any items previously added to the list are deleted when virtual mode is entered or left.
+	//#
+	//# The $proc$ parameter should point to a function having the following prototype.
+	//
+	//# \code	typedef Widget *VirtualItemProc(int32, Widget *, ListWidget *, void *);
+	//
+	//# The first parameter passed to the item function is the index of the item in the data source, and the second
+	//# parameter is either $nullptr$ or a widget that previously displayed a different item and can be recycled.
+	//# The item function should return a new widget when the second parameter is $nullptr$ and otherwise update the
+	//# recycled widget to display the new item and return it. The item function may also return a different widget
+	//# in place of a recycled one, in which case the recycled widget is deleted. The item function must never return
+	//# $nullptr$. The third parameter is a pointer to the list widget, and the last parameter receives the pointer
+	//# specified by the $cookie$ parameter.
+	//#
+	//# The number of items in the data source is set with the $@ListWidget::SetVirtualItemCount@$ function.
+	//# While a list is in virtual mode, the $@ListWidget::GetListItemCount@$ function returns the number of items
+	//# that pass the current filter, and the item selection is stored by data source index. It is accessed with the
+	//# $@ListWidget::SelectVirtualItem@$, $@ListWidget::UnselectVirtualItem@$, $@ListWidget::GetFirstSelectedVirtualItem@$,
+	//# and $@ListWidget::GetNextSelectedVirtualItem@$ functions.
+	//
+	//# \also	$@ListWidget::SetVirtualItemCount@$
+	//# \also	$@ListWidget::InvalidateVirtualItems@$
+	//# \also	$@ListWidget::SetVirtualFilterProc@$
+
+
+	//# \function	ListWidget::SetVirtualItemCount		Sets the number of items in the data source of a virtual list.
+	//
+	//# \proto	void SetVirtualItemCount(int32 count);
+	//
+	//# \param	count	The new number of items.
+	//
+	//# \desc
+	//# The $SetVirtualItemCount$ function sets the number of items in the data source of a list widget that has been
+	//# put into virtual mode with the $@ListWidget::SetVirtualItemProc@$ function. The current selection is cleared,
+	//# the current filter is applied to the new items from the beginning, and all visible items are requested from
+	//# the item function again.
+	//
+	//# \also	$@ListWidget::SetVirtualItemProc@$
+	//# \also	$@ListWidget::InvalidateVirtualItems@$
+
+
+	//# \function	ListWidget::InvalidateVirtualItems		Causes the visible items in a virtual list to be requested again.
+	//
+	//# \proto	void InvalidateVirtualItems(void);
+	//
+	//# \desc
+	//# The $InvalidateVirtualItems$ function should be called when the contents of the data source for a virtual list
+	//# have changed without a change in the number of items. All of the visible items are passed to the item function
+	//# again with their current widgets the next time the list is updated.
+	//
+	//# \also	$@ListWidget::SetVirtualItemProc@$
+	//# \also	$@ListWidget::SetVirtualItemCount@$
+
+
+	//# \function	ListWidget::SetVirtualFilterProc		Sets the filter function for a virtual list.
+	//
+	//# \proto	void SetVirtualFilterProc(VirtualFilterProc *proc, void *cookie = nullptr, bool refine = false);
+	//
+	//# \param	proc	A pointer to the filter function, or $nullptr$ to show all items.
+	//# \param	cookie	A user-defined pointer that is passed to the filter function.
+	//# \param	refine	Indicates whether the new filter only accepts a subset of the items accepted by the previous filter.
+	//
+	//# \desc
+	//# The $SetVirtualFilterProc$ function installs a function that determines which items in the data source of a
+	//# virtual list are displayed. The $proc$ parameter should point to a function having the following prototype.
+	//
+	//# \code	typedef bool VirtualFilterProc(int32, const ListWidget *, void *);
+	//
+	//# The first parameter passed to the filter function is the index of the item in the data source, and the second
+	//# parameter is a pointer to the list widget. The last parameter receives the pointer specified by the $cookie$
+	//# parameter. The filter function should return $true$ if the item is displayed and $false$ if it is hidden.
+	//#
+	//# Filtering is incremental. A limited number of items are tested immediately, and the rest are tested over the
+	//# following frames so that a large data source does not cause a stall. The items that have passed the filter so
+	//# far are displayed in the meantime, and the $@ListWidget::VirtualFilterComplete@$ function returns $true$ once
+	//# every item has been tested. If the $refine$ parameter is $true$ and the previous filter has completed, then only
+	//# the items that passed the previous filter are tested again, which is much faster when a search string is
+	//# extended by the user one character at a time.
+	//#
+	//# Filtering does not change which items are selected.
+	//
+	//# \also	$@ListWidget::SetVirtualItemProc@$
+	//# \also	$@ListWidget::FindVirtualItemPosition@$
+
+
+	//# \function	ListWidget::FindVirtualItemPosition		Returns the position of an item in a virtual list.
+	//
+	//# \proto	int32 FindVirtualItemPosition(int32 index) const;
+	//
+	//# \param	index	The index of the item in the data source.
+	//
+	//# \desc
+	//# The $FindVirtualItemPosition$ function returns the position at which the item with data source index $index$
+	//# is displayed in a virtual list after filtering. If the item does not pass the current filter, then the return
+	//# value is &minus;1. The search takes logarithmic time in the number of items that pass the filter. The data
+	//# source index of the item displayed at a particular position is returned by the $@ListWidget::GetVirtualItemIndex@$ function.
+	//
+	//# \also	$@ListWidget::RevealVirtualItem@$
+	//# \also	$@ListWidget::SetVirtualFilterProc@$
+
+
+	//# \function	ListWidget::RevealVirtualItem		Scrolls a virtual list so that a specific item is visible.
+	//
+	//# \proto	void RevealVirtualItem(int32 index);
+	//
+	//# \param	index	The index of the item in the data source.
+	//
+	//# \desc
+	//# The $RevealVirtualItem$ function scrolls a virtual list so that the item with data source index $index$ is visible.
+	//# If the item does not pass the current filter, then the list is not scrolled.
+	//
+	//# \also	$@ListWidget::FindVirtualItemPosition@$
+	//# \also	$@ListWidget::RevealListItem@$
+
+
 	class ListWidget : public RenderableWidget
 	{
 		friend class WidgetReg<ListWidget>;
 
+		public:
+
+			typedef Widget *VirtualItemProc(int32, Widget *, ListWidget *, void *);
+			typedef bool VirtualFilterProc(int32, const ListWidget *, void *);
+
 		private:
 
 			enum
@@ -4912,6 +5157,11 @@ namespace C4
 				kListUpdateSelection	= 1 << 2
 			};
 
+			enum
+			{
+				kVirtualFilterStepCount		= 8192
+			};
+
 			struct ListVertex
 			{
 				Point2D		position;
@@ -4961,12 +5211,40 @@ namespace C4
 			Widget							itemGroup;
 			ScrollWidget					scrollWidget;
 
+			VirtualItemProc					*virtualItemProc;
+			void							*virtualItemCookie;
+
+			VirtualFilterProc				*virtualFilterProc;
+			void							*virtualFilterCookie;
+
+			int32							virtualItemCount;
+			int32							virtualFilterPosition;
+			int32							virtualCandidateCount;
+			bool							virtualRefineFlag;
+			bool							virtualRebindFlag;
+
+			int32							virtualAnchorPosition;
+			int32							virtualCursorPosition;
+			int32							virtualSelectionCount;
+
+			Array<int32>					virtualIndexArray;
+			Array<int32>					virtualRowArray;
+			Array<unsigned_int32>			virtualSelectionArray;
+
 			void SetListUpdateFlags(unsigned_int32 flags)
 			{
 				listUpdateFlags |= flags;
 				Invalidate();
 			}
 
+			bool GetVirtualSelection(int32 index) const
+			{
+				return ((virtualSelectionArray[index >> 5] & (1 << (index & 31))) != 0);
+			}
+
+			bool SetVirtualSelection(int32 index, bool selected);
+			void ClearVirtualSelection(void);
+
 			Widget *Replicate(void) const override;
 
 			void SetDefaultHiliteColor(void);
@@ -4983,12 +5261,22 @@ namespace C4
 			void HandleUpArrow(unsigned_int32 modifierKeys);
 			void HandleDownArrow(unsigned_int32 modifierKeys);
 
+			void StartVirtualFilter(bool refine);
+			void ContinueVirtualFilter(void);
+			void UpdateVirtualItems(void);
+
+			void SelectVirtualPosition(int32 position, bool extend);
+			void HandleVirtualMouseDown(int32 position, bool activate, const PanelMouseEventData *eventData);
+			bool HandleVirtualKeyboardEvent(const KeyboardEventData *eventData);
+
 		protected:
 
 			ListWidget(WidgetType type = kWidgetList);
 			ListWidget(WidgetType type, const Vector2D& size, float spacing, const char *font);
 			ListWidget(const ListWidget& listWidget);
 
+			virtual float GetVirtualItemIndent(int32 index) const;
+
 		public:
 
 			C4API ListWidget(const Vector2D& size, float spacing = 13.0F, const char *font = "font/Gui");
@@ -5054,6 +5342,31 @@ namespace C4
 				return (itemGroup.GetLastSubnode());
 			}
 
+			bool VirtualList(void) const
+			{
+				return (virtualItemProc != nullptr);
+			}
+
+			int32 GetVirtualItemCount(void) const
+			{
+				return (virtualItemCount);
+			}
+
+			int32 GetVirtualItemIndex(int32 position) const
+			{
+				return (virtualIndexArray[position]);
+			}
+
+			bool VirtualFilterComplete(void) const
+			{
+				return (virtualFilterPosition < 0);
+			}
+
+			bool VirtualItemSelected(int32 index) const
+			{
+				return (((unsigned_int32) index < (unsigned_int32) virtualItemCount) && (GetVirtualSelection(index)));
+			}
+
 			void Pack(Packer& data, unsigned_int32 packFlags) const override;
 			void Unpack(Unpacker& data, unsigned_int32 unpackFlags) override;
 			bool UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigned_int32 unpackFlags);
@@ -5072,6 +5385,7 @@ namespace C4
 			void SetWidgetSize(const Vector2D& size) override;
 			WidgetPart TestPosition(const Point3D& position) const override;
 			void Preprocess(void) override;
+			void Move(void) override;
 
 			void EnterForeground(void) override;
 			void EnterBackground(void) override;
@@ -5082,6 +5396,19 @@ namespace C4
 			void HandleMouseEvent(const PanelMouseEventData *eventData) override;
 			bool HandleKeyboardEvent(const KeyboardEventData *eventData) override;
 
+			C4API void SetVirtualItemProc(VirtualItemProc *proc, void *cookie = nullptr);
+			C4API void SetVirtualItemCount(int32 count);
+			C4API void InvalidateVirtualItems(void);
+			C4API void SetVirtualFilterProc(VirtualFilterProc *proc, void *cookie = nullptr, bool refine = false);
+
+			C4API int32 FindVirtualItemPosition(int32 index) const;
+			C4API void RevealVirtualItem(int32 index);
+
+			C4API void SelectVirtualItem(int32 index, bool post = false);
+			C4API void UnselectVirtualItem(int32 index, bool post = false);
+			C4API int32 GetFirstSelectedVirtualItem(void) const;
+			C4API int32 GetNextSelectedVirtualItem(int32 index) const;
+
 			C4API Widget *GetListItem(int32 index) const;
 			C4API void RevealListItem(int32 index);
 
@@ -5282,13 +5609,46 @@ namespace C4
 	//# \also	$@TreeWidget::PrependTreeItem@$
 
 
+	//# \function	TreeWidget::SetVirtualDepthProc		Sets the depth function for a virtual tree.
+	//
+	//# \proto	void SetVirtualDepthProc(VirtualDepthProc *proc, void *cookie = nullptr);
+	//
+	//# \param	proc	A pointer to the depth function.
+	//# \param	cookie	A user-defined pointer that is passed to the depth function.
+	//
+	//# \desc
+	//# A tree widget can be put into virtual mode with the $@ListWidget::SetVirtualItemProc@$ function. In this case,
+	//# the data source supplies the currently expanded rows of the tree as a flat sequence of items, and the
+	//# $SetVirtualDepthProc$ function installs a function that returns the level in the hierarchy at which each
+	//# of those items is displayed. The $proc$ parameter should point to a function having the following prototype.
+	//
+	//# \code	typedef int32 VirtualDepthProc(int32, const TreeWidget *, void *);
+	//
+	//# The first parameter passed to the depth function is the index of the item in the data source, and the second
+	//# parameter is a pointer to the tree widget. The last parameter receives the pointer specified by the $cookie$
+	//# parameter. Each item is indented by the return value multiplied by the indent spacing.
+	//#
+	//# When the data source expands or collapses an item, it should call the $@ListWidget::SetVirtualItemCount@$
+	//# function with the new number of visible rows.
+	//
+	//# \also	$@ListWidget::SetVirtualItemProc@$
+	//# \also	$@TreeWidget::SetIndentSpacing@$
+
+
 	class TreeWidget final : public ListWidget
 	{
 		friend class WidgetReg<TreeWidget>;
 
+		public:
+
+			typedef int32 VirtualDepthProc(int32, const TreeWidget *, void *);
+
 		private:
 
-			float		indentSpacing;
+			float				indentSpacing;
+
+			VirtualDepthProc	*virtualDepthProc;
+			void				*virtualDepthCookie;
 
 			TreeWidget();
 			TreeWidget(const TreeWidget& treeWidget);
@@ -5304,6 +5664,8 @@ namespace C4
 			TreeItemWidget *InsertSubtreeItems(TreeItemWidget *item);
 			bool RemoveSubtreeItems(TreeItemWidget *item);
 
+			float GetVirtualItemIndent(int32 index) const override;
+
 		public:
 
 			C4API TreeWidget(const Vector2D& size, float spacing = 13.0F, const char *font = "font/Gui");
@@ -5319,6 +5681,13 @@ namespace C4
 				indentSpacing = spacing;
 			}
 
+			void SetVirtualDepthProc(VirtualDepthProc *proc, void *cookie = nullptr)
+			{
+				virtualDepthProc = proc;
+				virtualDepthCookie = cookie;
+				InvalidateVirtualItems();
+			}
+
 			void Pack(Packer& data, unsigned_int32 packFlags) const override;
 			void Unpack(Unpacker& data, unsigned_int32 unpackFlags) override;
 			bool UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsigned_int32 unpackFlags);
@@ -6378,6 +6747,11 @@ namespace C4
 
 			Link<Widget>		focusWidget;
 
+			bool						widgetBatchFlag;
+			unsigned_int32				widgetBatchFrame;
+			int32						widgetBatchIndex;
+			Array<WidgetBatch *, 4>		widgetBatchArray;
+
 		protected:
 
 			RootWidget(WidgetType type);
@@ -6389,10 +6763,20 @@ namespace C4
 			C4API Widget *SetNextFocusWidget(void);
 			C4API Widget *SetPreviousFocusWidget(void);
 
+			void SetWidgetBatchFlag(bool flag)
+			{
+				widgetBatchFlag = flag;
+			}
+
 		public:
 
 			~RootWidget();
 
+			bool GetWidgetBatchFlag(void) const
+			{
+				return (widgetBatchFlag);
+			}
+
 			void AddKeyedWidget(Widget *widget)
 			{
 				widgetHashTable.Insert(widget);
@@ -6425,6 +6809,8 @@ namespace C4
 			C4API void UnpackAuxiliaryData(Unpacker& data);
 
 			C4API virtual void SetFocusWidget(Widget *widget);
+
+			WidgetBatch *GetNextWidgetBatch(unsigned_int32 frame);
 	};
 
 
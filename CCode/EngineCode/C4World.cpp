@@ -12,6 +12,8 @@
 #include "C4Terrain.h"
 #include "C4Water.h"
 #include "C4Movies.h"
+#include "C4ShaderCache.h"
+#include "C4Profiler.h"
 
 
 using namespace C4;
@@ -200,6 +202,27 @@ namespace C4
 	};
 
 
+	class DeltaSaveJob : public Job
+	{
+		private:
+
+			ResourcePath			savePath;
+			DeltaPackSnapshot		saveSnapshot;
+
+			static void JobWriteSnapshot(Job *job, void *cookie);
+
+		public:
+
+			DeltaSaveJob(const char *path);
+			~DeltaSaveJob();
+
+			DeltaPackSnapshot *GetSnapshot(void)
+			{
+				return (&saveSnapshot);
+			}
+	};
+
+
 	struct WorldContext
 	{
 		const FrustumCamera			*renderCamera;
@@ -576,6 +599,7 @@ World::World(const char *name, unsigned_int32 flags) :
 	worldName = name;
 	worldFlags = flags;
 	rootNode = nullptr;
+	zoneStreamer = nullptr;
 }
 
 World::World(Node *root, unsigned_int32 flags) :
@@ -585,6 +609,7 @@ World::World(Node *root, unsigned_int32 flags) :
 	worldName[0] = 0;
 	worldFlags = flags;
 	rootNode = root;
+	zoneStreamer = nullptr;
 }
 
 World::~World()
@@ -597,6 +622,7 @@ World::~World()
 	controllerList[0].RemoveAll();
 	controllerList[1].RemoveAll();
 
+	delete zoneStreamer;
 	delete rootNode;
 	SetCamera(nullptr);
 
@@ -642,7 +668,7 @@ WorldResult World::Preprocess(void)
 
 				#endif
 
-				rootNode = Node::UnpackTree(resource->GetData(), 0);
+				rootNode = Node::UnpackTree(resource->GetData(), kUnpackConcurrent);
 				controllerCount = resource->GetControllerCount();
 				resource->Release();
 
@@ -744,10 +770,14 @@ WorldResult World::Preprocess(void)
 	rootNode->Preprocess();
 	rootNode->Update();
 
+	unsigned_int32 shaderTypeMask = (1 << kShaderAmbient) | (1 << kShaderAmbientRadiosity) | (1 << kShaderUnified) | (1 << kShaderUnifiedRadiosity) | (1 << kShaderShadow) | (1 << kShaderStructure);
+	unsigned_int32 shaderVariantMask = 1 << kShaderVariantNormal;
+
 	Node *node = rootNode->GetFirstSubnode();
 	while (node)
 	{
-		if (node->GetNodeType() == kNodeMarker)
+		NodeType type = node->GetNodeType();
+		if (type == kNodeMarker)
 		{
 			Marker *marker = static_cast<Marker *>(node);
 			if (marker->GetMarkerType() == kMarkerShader)
@@ -755,10 +785,54 @@ WorldResult World::Preprocess(void)
 				shaderMarkerList.Append(marker);
 			}
 		}
+		else if (type == kNodeLight)
+		{
+			LightType lightType = static_cast<Light *>(node)->GetLightType();
+			if (lightType == kLightInfinite)
+			{
+				shaderTypeMask |= 1 << kShaderInfiniteLight;
+			}
+			else if (lightType == kLightCube)
+			{
+				shaderTypeMask |= (1 << kShaderPointLight) | (1 << kShaderCubeLight);
+			}
+			else if (lightType == kLightSpot)
+			{
+				shaderTypeMask |= 1 << kShaderSpotLight;
+			}
+			else
+			{
+				shaderTypeMask |= 1 << kShaderPointLight;
+			}
+		}
+		else if ((type == kNodeSpace) && (static_cast<Space *>(node)->GetSpaceType() == kSpaceFog))
+		{
+			shaderVariantMask |= (1 << kShaderVariantConstantFog) | (1 << kShaderVariantLinearFog);
+		}
 
 		node = rootNode->GetNextNode(node);
 	}
 
+	// When the world is going to be warmed up, the shader permutations that its geometry can use
+	// are prepared in parallel ahead of time. The prepared shader data is kept by the render
+	// segments, so the warmup pass only has to create the shader objects from the source code in
+	// the shader cache and link the programs. Segments sharing a material with a segment seen
+	// earlier still build and process their shader graphs, but the source code is then found
+	// in the cache.
+
+	if ((!shaderMarkerList.Empty()) && (ShaderCache::Enabled()) && (!TheGraphicsMgr->NullDevice()))
+	{
+		ShaderCache::GeneratePermutations(rootNode, shaderTypeMask, shaderVariantMask);
+	}
+
+	// Worlds shown in viewports, such as the one being edited in the World Editor, keep the
+	// contents of their streamed zones, so only a world that is being played gets a streamer.
+
+	if ((!(worldFlags & kWorldViewport)) && (ZoneStreamer::StreamedZonePresent(rootNode)))
+	{
+		zoneStreamer = new ZoneStreamer(this);
+	}
+
 	return (kWorldOkay);
 }
 
@@ -1938,6 +2012,12 @@ void World::HandleWaterSubmergence(RigidBodyController *rigidBody)
 
 void World::MoveControllers(unsigned_int32 parity)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("World::MoveControllers");
+
+	#endif
+
 	List<Controller> *currentList = &controllerList[parity];
 	List<Controller> *nextList = &controllerList[parity ^ 1];
 
@@ -1962,6 +2042,12 @@ void World::MoveControllers(unsigned_int32 parity)
 
 void World::MoveEffects(unsigned_int32 parity)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("World::MoveEffects");
+
+	#endif
+
 	List<Effect> *currentList = &movingEffectList[parity];
 	List<Effect> *nextList = &movingEffectList[parity ^ 1];
 
@@ -1980,6 +2066,12 @@ void World::MoveEffects(unsigned_int32 parity)
 
 void World::MoveSources(unsigned_int32 parity)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("World::MoveSources");
+
+	#endif
+
 	List<OmniSource> *currentList = &playingSourceList[parity];
 	List<OmniSource> *nextList = &playingSourceList[parity ^ 1];
 	for (;;)
@@ -2021,8 +2113,39 @@ void World::MoveSources(unsigned_int32 parity)
 	#endif
 }
 
+#if C4STATS
+
+	void World::CollectCellStatistics(Zone *zone)
+	{
+		for (machine a = 0; a < kCellGraphCount; a++)
+		{
+			CellGraph *cellGraph = zone->GetCellGraph(a);
+
+			worldCounter[kWorldCounterCellCount] += cellGraph->GetCellCount();
+			worldCounter[kWorldCounterCellInsert] += cellGraph->GetInsertCount();
+			worldCounter[kWorldCounterCellUpdate] += cellGraph->GetUpdateCount();
+
+			cellGraph->ResetStatistics();
+		}
+
+		Zone *subzone = zone->GetFirstSubzone();
+		while (subzone)
+		{
+			CollectCellStatistics(subzone);
+			subzone = subzone->Next();
+		}
+	}
+
+#endif
+
 void World::Move(void)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("World::Move");
+
+	#endif
+
 	#if C4STATS
 
 		for (machine a = 0; a < kWorldCounterCount; a++)
@@ -2030,6 +2153,11 @@ void World::Move(void)
 			worldCounter[a] = 0;
 		}
 
+		// Sites are inserted into and updated in the cell graphs while the nodes are updated, so the
+		// counts gathered here are those for the previous frame.
+
+		CollectCellStatistics(GetRootNode());
+
 	#endif
 
 	for (;;)
@@ -2075,6 +2203,17 @@ void World::Move(void)
 
 void World::Update(void)
 {
+	#if C4PROFILE
+
+		ProfileScope profileScope("World::Update");
+
+	#endif
+
+	if (zoneStreamer)
+	{
+		zoneStreamer->Update();
+	}
+
 	FrustumCamera *camera = currentCamera;
 	if (camera)
 	{
@@ -2335,6 +2474,26 @@ void World::ProcessGeometry(const WorldContext *worldContext, Geometry *geometry
 		}
 	}
 
+	if (Texture::GetTextureStreamer())
+	{
+		// The texture streamer is given the diameter of the bounding sphere in pixels. A camera
+		// inside the sphere leaves the size infinite so that the finest mipmap levels are requested.
+
+		float size = K::infinity;
+
+		const BoundingSphere *sphere = geometry->GetBoundingSphere();
+		const FrustumCamera *camera = worldContext->renderCamera;
+		float radius = sphere->GetRadius();
+		float d = Magnitude(sphere->GetCenter() - camera->GetWorldPosition());
+		if (d > radius)
+		{
+			float focalLength = static_cast<FrustumCameraObject *>(camera->Node::GetObject())->GetFocalLength();
+			size = radius * focalLength * (float) renderWidth / d;
+		}
+
+		geometry->SetTextureDetailSize(size);
+	}
+
 	Controller *controller = geometry->GetController();
 	if ((controller) && (controller->GetControllerFlags() & kControllerUpdate))
 	{
@@ -2563,10 +2722,22 @@ void World::RenderAmbientNode(WorldContext *worldContext, const CameraRegion *ca
 
 void World::RenderAmbientCell(WorldContext *worldContext, const CameraRegion *cameraRegion, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -2607,10 +2778,22 @@ void World::RenderAmbientEffectNode(const WorldContext *worldContext, const Came
 
 void World::RenderAmbientEffectCell(WorldContext *worldContext, const CameraRegion *cameraRegion, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -2953,10 +3136,22 @@ void World::RenderUnifiedNode(WorldContext *worldContext, const CameraRegion *ca
 
 void World::RenderUnifiedCell(WorldContext *worldContext, const CameraRegion *cameraRegion, const ImmutableArray<LightRegion *>& regionArray, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -2997,10 +3192,22 @@ void World::RenderUnifiedEffectNode(const WorldContext *worldContext, const Came
 
 void World::RenderUnifiedEffectCell(WorldContext *worldContext, const CameraRegion *cameraRegion, const ImmutableArray<LightRegion *>& regionArray, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -3277,10 +3484,22 @@ void World::RenderUnifiedNode(WorldContext *worldContext, const CameraRegion *ca
 
 void World::RenderUnifiedCell(WorldContext *worldContext, const CameraRegion *cameraRegion, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -3321,10 +3540,22 @@ void World::RenderUnifiedEffectNode(const WorldContext *worldContext, const Came
 
 void World::RenderUnifiedEffectCell(WorldContext *worldContext, const CameraRegion *cameraRegion, Site *cell)
 {
+	#if C4STATS
+
+		worldCounter[kWorldCounterCellVisit]++;
+
+	#endif
+
 	if (WorldBoundingBoxVisible(cell->GetWorldBoundingBox(), cameraRegion, &worldContext->occlusionList))
 	{
 		cell->SetSiteStamp(ambientRenderStamp);
 
+		#if C4STATS
+
+			worldCounter[kWorldCounterCellVisible]++;
+
+		#endif
+
 		const Bond *bond = cell->GetFirstOutgoingEdge();
 		while (bond)
 		{
@@ -7312,6 +7543,28 @@ void World::Render(void)
 #endif
 
 
+DeltaSaveJob::DeltaSaveJob(const char *path) : Job(&JobWriteSnapshot, this)
+{
+	savePath = path;
+}
+
+DeltaSaveJob::~DeltaSaveJob()
+{
+}
+
+void DeltaSaveJob::JobWriteSnapshot(Job *job, void *cookie)
+{
+	DeltaSaveJob *saveJob = static_cast<DeltaSaveJob *>(cookie);
+
+	File	file;
+
+	if ((FileMgr::CreateDirectoryPath(saveJob->savePath) == kFileOkay) && (file.Open(saveJob->savePath, kFileCreate) == kFileOkay))
+	{
+		saveJob->saveSnapshot.Write(&file);
+	}
+}
+
+
 WorldMgr::WorldMgr(int) :
 		objectCreator(&CreateObject),
 		controllerStateSender(&SendControllerState, this),
@@ -7329,6 +7582,9 @@ EngineResult WorldMgr::Construct(void)
 	currentWorld = nullptr;
 	warmupWorld = nullptr;
 
+	deltaPackWorld = nullptr;
+	deltaSaveJob = nullptr;
+
 	worldCreatorProc = nullptr;
 	Object::InstallCreator(&objectCreator);
 	TheMessageMgr->InstallStateSender(&controllerStateSender);
@@ -7380,6 +7636,9 @@ EngineResult WorldMgr::Construct(void)
 
 void WorldMgr::Destruct(void)
 {
+	FinishDeltaSave();
+	deltaPackCache.Purge();
+
 	loaderThread->~Thread();
 	loaderSignal->~Signal();
 
@@ -7530,6 +7789,10 @@ void WorldMgr::UnloadWorld(void)
 	{
 		TheMessageMgr->SetControllerMessageProcs(nullptr, nullptr);
 
+		FinishDeltaSave();
+		deltaPackCache.Purge();
+		deltaPackWorld = nullptr;
+
 		delete currentWorld;
 		currentWorld = nullptr;
 
@@ -7546,24 +7809,63 @@ void WorldMgr::RunWorld(World *world)
 	TheTimeMgr->ResetTime();
 }
 
-void WorldMgr::SaveDeltaWorld(const char *name)
+void WorldMgr::SaveDeltaWorld(const char *name, unsigned_int32 flags)
 {
 	const World *world = currentWorld;
 	if (world)
 	{
-		File			file;
 		ResourcePath	path;
 
+		// The cache cannot be changed while the previous incremental save is still writing
+		// the node data that it holds, and two saves must not write the same file at once.
+
+		FinishDeltaSave();
+
 		TheResourceMgr->GetSaveCatalog()->GetResourcePath(SaveResource::GetDescriptor(), name, &path);
-		if ((FileMgr::CreateDirectoryPath(path) == kFileOkay) && (file.Open(path, kFileCreate) == kFileOkay))
+
+		if (flags & kDeltaSaveIncremental)
 		{
-			world->GetRootNode()->PackDeltaTree(&file, world->GetWorldName());
+			if (deltaPackWorld != world)
+			{
+				deltaPackCache.Purge();
+				deltaPackWorld = world;
+			}
+
+			DeltaSaveJob *job = new DeltaSaveJob(path);
+			world->GetRootNode()->PackDeltaSnapshot(world->GetWorldName(), &deltaPackCache, job->GetSnapshot());
+
+			deltaSaveJob = job;
+			TheJobMgr->SubmitJob(job);
+		}
+		else
+		{
+			File	file;
+
+			if ((FileMgr::CreateDirectoryPath(path) == kFileOkay) && (file.Open(path, kFileCreate) == kFileOkay))
+			{
+				world->GetRootNode()->PackDeltaTree(&file, world->GetWorldName());
+			}
 		}
 	}
 }
 
+void WorldMgr::FinishDeltaSave(void)
+{
+	DeltaSaveJob *job = deltaSaveJob;
+	if (job)
+	{
+		JobMgr::FinishJob(job);
+		deltaSaveJob = nullptr;
+		delete job;
+	}
+}
+
 WorldResult WorldMgr::RestoreDeltaWorld(const char *name)
 {
+	FinishDeltaSave();
+	deltaPackCache.Purge();
+	deltaPackWorld = nullptr;
+
 	World *world = (worldCreatorProc) ? (*worldCreatorProc)(name, worldCreatorCookie) : new World(name);
 	world->SetWorldFlags(world->GetWorldFlags() | kWorldRestore);
 	world->previousWorld = currentWorld;
@@ -7608,6 +7910,11 @@ void WorldMgr::RunLoaderTask(void (*proc)(void *), void *cookie)
 
 void WorldMgr::Move(void)
 {
+	if ((deltaSaveJob) && (deltaSaveJob->Complete()))
+	{
+		FinishDeltaSave();
+	}
+
 	World *world = currentWorld;
 	if (world)
 	{
@@ -14,6 +14,7 @@
 #include "C4Graphics.h"
 #include "C4Impostors.h"
 #include "C4Zones.h"
+#include "C4ZoneStreaming.h"
 
 
 namespace C4
@@ -44,6 +45,12 @@ namespace C4
 	};
 
 
+	enum
+	{
+		kDeltaSaveIncremental			= 1 << 0
+	};
+
+
 	enum
 	{
 		kRenderStageAmbientDefault,
@@ -125,6 +132,8 @@ namespace C4
 			kWorldCounterDirectPortal,
 			kWorldCounterRemotePortal,
 			kWorldCounterOcclusionRegion,
+			kWorldCounterCellVisit,
+			kWorldCounterCellVisible,
 			kWorldCounterRenderCount,
 
 			kWorldCounterPlayingSource = kWorldCounterRenderCount,
@@ -132,6 +141,9 @@ namespace C4
 			kWorldCounterRunningScript,
 			kWorldCounterWaterMove,
 			kWorldCounterWaterUpdate,
+			kWorldCounterCellCount,
+			kWorldCounterCellInsert,
+			kWorldCounterCellUpdate,
 			kWorldCounterCount
 		};
 
@@ -162,6 +174,7 @@ namespace C4
 	class PortalData;
 	class CollisionThreadData;
 	class QueryThreadData;
+	class DeltaSaveJob;
 	class InteractionThreadData;
 	struct WorldContext;
 	struct CollisionParams;
@@ -482,6 +495,30 @@ namespace C4
 	//# \also	$@Zone@$
 
 
+	//# \function	World::GetZoneStreamer		Returns the zone streamer for a world.
+	//
+	//# \proto	ZoneStreamer *GetZoneStreamer(void) const;
+	//
+	//# \desc
+	//# The $GetZoneStreamer$ function returns a pointer to the zone streamer that loads the contents of the
+	//# world's streamed zones. A zone streamer is created when the world is preprocessed only if the world
+	//# contains a zone having the $kZoneStreamed$ flag set, and the return value is $nullptr$ otherwise.
+	//
+	//# \also	$@ZoneStreamer@$
+
+
+	//# \function	World::GetNavigationMesh		Returns the navigation mesh for a world.
+	//
+	//# \proto	NavigationMesh *GetNavigationMesh(void);
+	//
+	//# \desc
+	//# The $GetNavigationMesh$ function returns a pointer to the navigation mesh for a world. The navigation mesh contains
+	//# the navigation tiles belonging to all of the zones that are currently preprocessed in the world.
+	//
+	//# \also	$@NavigationMesh@$
+	//# \also	$@Zone::GetNavigationTile@$
+
+
 	//# \function	World::AddNewNode		Adds a new node to the world and preprocesses it.
 	//
 	//# \proto	void AddNewNode(Node *node);
@@ -873,6 +910,7 @@ namespace C4
 			ColorRGBA						finalColorBias;
 
 			Node							*rootNode;
+			ZoneStreamer					*zoneStreamer;
 			Skybox							*worldSkybox;
 			const ColorRGBA					*clearColor;
 			float							farClipDepth;
@@ -919,6 +957,8 @@ namespace C4
 
 			Batch							worldBatch;
 
+			NavigationMesh					navigationMesh;
+
 			WorldObservable					updateObservable;
 
 			HashTable<Controller>			controllerTable;
@@ -952,6 +992,12 @@ namespace C4
 
 			void SetCameraClearParams(CameraObject *object) const;
 
+			#if C4STATS
+
+				void CollectCellStatistics(Zone *zone);
+
+			#endif
+
 			static ControllerMessage *CreateControllerMessage(ControllerMessageType controllerMessageType, int32 controllerIndex, Decompressor& data, void *world);
 			static void ReceiveControllerMessage(const ControllerMessage *message, void *world);
 
@@ -1178,6 +1224,16 @@ namespace C4
 				return (static_cast<Zone *>(rootNode));
 			}
 
+			ZoneStreamer *GetZoneStreamer(void) const
+			{
+				return (zoneStreamer);
+			}
+
+			NavigationMesh *GetNavigationMesh(void)
+			{
+				return (&navigationMesh);
+			}
+
 			void AddNewNode(Node *node)
 			{
 				rootNode->AppendNewSubnode(node);
@@ -1431,18 +1487,43 @@ namespace C4
 
 	//# \function	WorldMgr::SaveDeltaWorld		Saves a delta file for the current world.
 	//
-	//# \proto	void SaveDeltaWorld(const char *name);
+	//# \proto	void SaveDeltaWorld(const char *name, unsigned_int32 flags = 0);
 	//
 	//# \param	name	The name of the file to save.
+	//# \param	flags	Flags that control how the file is saved.
 	//
 	//# \desc
+	//# The $SaveDeltaWorld$ function saves the difference between the current world and the world resource from
+	//# which it was loaded. If the $flags$ parameter is zero, then the whole tree is packed and the file is written
+	//# before the function returns. If the $kDeltaSaveIncremental$ flag is specified, then only nodes that have changed
+	//# since the previous incremental save are packed again, and the file is written by a job on a worker thread after
+	//# the function returns. An incremental save first waits for any previous incremental save to finish.
+	//#
+	//# All packing is done on the calling thread in both cases, so an incremental save is faster only to the extent that
+	//# the data packed for unchanged nodes is reused. Nodes that have controllers or properties, or that are volatile as
+	//# reported by the $@Node::VolatileDeltaPack@$ function, are packed by every save.
 	//
+	//# \also	$@WorldMgr::FinishDeltaSave@$
+	//# \also	$@Node::InvalidateDeltaPack@$
+	//# \also	$@Node::VolatileDeltaPack@$
 	//# \also	$@World@$
 	//# \also	$@WorldMgr::RestoreDeltaWorld@$
 	//# \also	$@WorldMgr::LoadWorld@$
 	//# \also	$@WorldMgr::UnloadWorld@$
 
 
+	//# \function	WorldMgr::FinishDeltaSave		Waits for an incremental save to finish writing its file.
+	//
+	//# \proto	void FinishDeltaSave(void);
+	//
+	//# \desc
+	//# The $FinishDeltaSave$ function waits until the file for the most recent incremental save made with the
+	//# $@WorldMgr::SaveDeltaWorld@$ function has been written. If no incremental save is in progress, then the
+	//# function returns immediately. The $@WorldMgr::RestoreDeltaWorld@$ function calls this function automatically.
+	//
+	//# \also	$@WorldMgr::SaveDeltaWorld@$
+
+
 	//# \function	WorldMgr::RestoreDeltaWorld		Restores a previously saved delta file.
 	//
 	//# \proto	void RestoreDeltaWorld(const char *name);
@@ -1488,6 +1569,10 @@ namespace C4
 			void							(*loaderProc)(void *);
 			void							*loaderCookie;
 
+			DeltaPackCache					deltaPackCache;
+			const World						*deltaPackWorld;
+			DeltaSaveJob					*deltaSaveJob;
+
 			static Object *CreateObject(Unpacker& data, unsigned_int32 unpackFlags);
 			static void SendControllerState(Player *to, void *cookie);
 			static void HandleDisplayEvent(const DisplayEventData *eventData, void *cookie);
@@ -1539,7 +1624,13 @@ namespace C4
 			C4API void UnloadWorld(void);
 			C4API void RunWorld(World *world);
 
-			C4API void SaveDeltaWorld(const char *name);
+			const DeltaPackCache *GetDeltaPackCache(void) const
+			{
+				return (&deltaPackCache);
+			}
+
+			C4API void SaveDeltaWorld(const char *name, unsigned_int32 flags = 0);
+			C4API void FinishDeltaSave(void);
 			C4API WorldResult RestoreDeltaWorld(const char *name);
 
 			C4API void RunLoaderTask(void (*proc)(void *), void *cookie);
@@ -0,0 +1,616 @@
+ 
+
+#include "C4ZoneStreaming.h"
+#include "C4World.h"
+#include "C4Cameras.h"
+
+
+using namespace C4;
+
+
+StreamedZone::StreamedZone(Zone *zone, const char *name)
+{
+	streamedZone = zone;
+	chunkName = name;
+
+	Box3D	box;
+
+	if (zone->CalculateBoundingBox(&box))
+	{
+		zoneCenter = zone->GetWorldTransform() * box.GetCenter();
+		zoneRadius = Magnitude(box.max - box.min) * 0.5F;
+	}
+	else
+	{
+		zoneCenter = zone->GetWorldPosition();
+		zoneRadius = 0.0F;
+	}
+
+	streamingState = kStreamedZoneUnloaded;
+	cancelFlag = false;
+
+	chunkRoot = nullptr;
+	chunkGroup = nullptr;
+	chunkSize = 0;
+	chunkLoadTime = 0;
+}
+
+StreamedZone::~StreamedZone()
+{
+	delete chunkRoot;
+}
+
+
+ZoneStreamer::ZoneStreamer(World *world)
+{
+	streamingWorld = world;
+
+	loadDistance = 128.0F;
+	unloadDistance = 160.0F;
+
+	linkBudget = kZoneStreamingLinkBudget;
+	unlinkBudget = kZoneStreamingUnlinkBudget;
+
+	residentMemory = 0;
+	residentCount = 0;
+	loadCount = 0;
+	unloadCount = 0;
+
+	loadTime = 0;
+	maxLoadTime = 0;
+	linkTime = 0;
+	maxLinkTime = 0;
+
+	// Zones are numbered in the same order that the ExportChunks() function numbers them,
+	// so each streamed zone finds the chunk that was written for it.
+
+	const char *worldName = world->GetWorldName();
+	Node *root = world->GetRootNode();
+
+	int32 index = 0;
+	Node *node = root;
+	do
+	{
+		if ((node->GetNodeType() == kNodeZone) && (!(node->GetNodeFlags() & kNodeNonpersistent)))
+		{
+			Zone *zone = static_cast<Zone *>(node);
+			if (zone->GetObject()->GetZoneFlags() & kZoneStreamed)
+			{
+				ResourceName	name;
+
+				GetChunkName(worldName, index, &name);
+				zoneList.Append(new StreamedZone(zone, name));
+				index++;
+			}
+		}
+
+		node = root->GetNextNode(node);
+	} while (node);
+
+	streamerBusy = false;
+	streamerSignal = new Signal(2);
+	streamerThread = new Thread(&StreamerThread, this, 0, streamerSignal);
+}
+
+ZoneStreamer::~ZoneStreamer()
+{
+	streamerMutex.Acquire();
+	requestArray.Clear();
+	streamerMutex.Release();
+
+	// A chunk that is being unpacked can be waiting for the main thread to create a texture or
+	// buffer, so pending render tasks are serviced here until the streaming thread goes idle.
+
+	while (streamerBusy)
+	{
+		TheGraphicsMgr->ServiceSyncRenderTask();
+		Thread::Yield();
+	}
+
+	delete streamerThread;
+	delete streamerSignal;
+
+	zoneList.Purge();
+}
+
+void ZoneStreamer::StreamerThread(const Thread *thread, void *cookie)
+{
+	Thread::SetThreadName("C4-ZS Streamer");
+
+	ZoneStreamer *streamer = static_cast<ZoneStreamer *>(cookie);
+
+	for (;;)
+	{
+		int32 index = streamer->streamerSignal->Wait();
+		if (index == 0)
+		{
+			break;
+		}
+
+		for (;;)
+		{
+			StreamedZone *streamedZone = nullptr;
+
+			streamer->streamerMutex.Acquire();
+
+			if (streamer->requestArray.GetElementCount() != 0)
+			{
+				streamedZone = streamer->requestArray[0];
+				streamer->requestArray.RemoveElement(0);
+				streamer->streamerBusy = true;
+			}
+
+			streamer->streamerMutex.Release();
+
+			if (!streamedZone)
+			{
+				break;
+			}
+
+			if (!streamedZone->cancelFlag)
+			{
+				unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+
+				WorldResource *resource = WorldResource::Get(streamedZone->chunkName);
+				if (resource)
+				{
+					streamedZone->chunkSize = resource->GetSize();
+					streamedZone->chunkRoot = Node::UnpackTree(resource->GetData(), kUnpackNonpersistent | kUnpackExternal);
+					resource->Release();
+				}
+
+				streamedZone->chunkLoadTime = (unsigned_int32) (TheTimeMgr->GetMicrosecondCount() - time);
+			}
+
+			streamer->streamerMutex.Acquire();
+
+			streamer->completeArray.AddElement(streamedZone);
+			streamer->streamerBusy = false;
+
+			streamer->streamerMutex.Release();
+		}
+	}
+}
+
+bool ZoneStreamer::StreamableNode(const Node *node)
+{
+	// A node can be moved into a chunk only if nothing outside its subtree refers to anything
+	// inside it. Nodes that participate in the zone structure, have controllers, or connect to
+	// other nodes are left in the main world.
+
+	const Node *subnode = node;
+	do
+	{
+		NodeType type = subnode->GetNodeType();
+		if ((type == kNodeZone) || (type == kNodePortal) || (type == kNodeMarker) || (type == kNodeInstance))
+		{
+			return (false);
+		}
+
+		if ((subnode->GetController()) || (subnode->GetNodeFlags() & kNodeNonpersistent))
+		{
+			return (false);
+		}
+
+		const Hub *hub = subnode->GetHub();
+		if (hub)
+		{
+			const Connector *connector = hub->GetFirstOutgoingEdge();
+			while (connector)
+			{
+				const Node *target = connector->GetConnectorTarget();
+				if ((target) && (target != node) && (!node->Successor(target)))
+				{
+					return (false);
+				}
+
+				connector = connector->GetNextOutgoingEdge();
+			}
+
+			connector = hub->GetFirstIncomingEdge();
+			while (connector)
+			{
+				const Node *start = connector->GetStartElement()->GetNode();
+				if ((start != node) && (!node->Successor(start)))
+				{
+					return (false);
+				}
+
+				connector = connector->GetNextIncomingEdge();
+			}
+		}
+
+		subnode = node->GetNextNode(subnode);
+	} while (subnode);
+
+	return (true);
+}
+
+void ZoneStreamer::GetChunkName(const char *worldName, int32 index, ResourceName *name)
+{
+	*name = worldName;
+	*name += "-z";
+	*name += index;
+}
+
+float ZoneStreamer::GetFocusDistance(const StreamedZone *streamedZone) const
+{
+	float distance = K::infinity;
+
+	const FrustumCamera *camera = streamingWorld->GetCamera();
+	if (camera)
+	{
+		distance = Magnitude(camera->GetWorldPosition() - streamedZone->zoneCenter);
+	}
+
+	for (const Link<Node>& link : focusNodeArray)
+	{
+		const Node *node = link;
+		if (node)
+		{
+			distance = Fmin(distance, Magnitude(node->GetWorldPosition() - streamedZone->zoneCenter));
+		}
+	}
+
+	return (Fmax(distance - streamedZone->zoneRadius, 0.0F));
+}
+
+void ZoneStreamer::QueueLoad(StreamedZone *streamedZone)
+{
+	streamedZone->streamingState = kStreamedZoneQueued;
+	streamedZone->cancelFlag = false;
+
+	streamerMutex.Acquire();
+	requestArray.AddElement(streamedZone);
+	streamerMutex.Release();
+}
+
+void ZoneStreamer::ReceiveChunks(void)
+{
+	Array<StreamedZone *, 8>	receiveArray;
+
+	streamerMutex.Acquire();
+
+	for (StreamedZone *streamedZone : completeArray)
+	{
+		receiveArray.AddElement(streamedZone);
+	}
+
+	completeArray.Clear();
+
+	streamerMutex.Release();
+
+	for (StreamedZone *streamedZone : receiveArray)
+	{
+		if (streamedZone->cancelFlag)
+		{
+			delete streamedZone->chunkRoot;
+			streamedZone->chunkRoot = nullptr;
+			streamedZone->streamingState = kStreamedZoneUnloaded;
+		}
+		else if (!streamedZone->chunkRoot)
+		{
+			streamedZone->streamingState = kStreamedZoneMissing;
+		}
+		else
+		{
+			streamedZone->streamingState = kStreamedZoneLinking;
+
+			loadTime = streamedZone->chunkLoadTime;
+			maxLoadTime = Max(maxLoadTime, loadTime);
+
+			residentMemory += streamedZone->chunkSize;
+			residentCount++;
+			loadCount++;
+		}
+	}
+}
+
+void ZoneStreamer::LinkChunks(unsigned_int64 endTime)
+{
+	// The unpacked nodes are added to the zone one top-level node at a time. Adding a node
+	// preprocesses its subtree and places it in the zone's cell graph, and this is what the
+	// budget limits, so a large chunk becomes visible over several frames.
+
+	StreamedZone *streamedZone = zoneList.First();
+	while (streamedZone)
+	{
+		if (streamedZone->streamingState == kStreamedZoneLinking)
+		{
+			Node *group = streamedZone->chunkGroup;
+			if (!group)
+			{
+				group = new Node;
+				group->SetNodeFlags(group->GetNodeFlags() | kNodeNonpersistent);
+				streamedZone->streamedZone->AppendNewSubnode(group);
+				streamedZone->chunkGroup = group;
+			}
+
+			for (;;)
+			{
+				Node *node = streamedZone->chunkRoot->GetFirstSubnode();
+				if (!node)
+				{
+					delete streamedZone->chunkRoot;
+					streamedZone->chunkRoot = nullptr;
+					streamedZone->streamingState = kStreamedZoneResident;
+					break;
+				}
+
+				group->AppendNewSubnode(node);
+
+				if (TheTimeMgr->GetMicrosecondCount() >= endTime)
+				{
+					return;
+				}
+			}
+		}
+
+		streamedZone = streamedZone->Next();
+	}
+}
+
+bool ZoneStreamer::UnlinkChunk(StreamedZone *streamedZone, unsigned_int64 endTime)
+{
+	Node *group = streamedZone->chunkGroup;
+	if (group)
+	{
+		for (;;)
+		{
+			Node *node = group->GetLastSubnode();
+			if (!node)
+			{
+				break;
+			}
+
+			delete node;
+
+			if (TheTimeMgr->GetMicrosecondCount() >= endTime)
+			{
+				return (false);
+			}
+		}
+
+		delete group;
+		streamedZone->chunkGroup = nullptr;
+	}
+
+	delete streamedZone->chunkRoot;
+	streamedZone->chunkRoot = nullptr;
+	streamedZone->streamingState = kStreamedZoneUnloaded;
+
+	residentMemory -= streamedZone->chunkSize;
+	residentCount--;
+	unloadCount++;
+
+	return (true);
+}
+
+void ZoneStreamer::AddFocusNode(Node *node)
+{
+	for (const Link<Node>& link : focusNodeArray)
+	{
+		if (link == node)
+		{
+			return;
+		}
+	}
+
+	focusNodeArray.AddElement(Link<Node>(node));
+}
+
+void ZoneStreamer::RemoveFocusNode(Node *node)
+{
+	int32 count = focusNodeArray.GetElementCount();
+	for (machine a = 0; a < count; a++)
+	{
+		if (focusNodeArray[a] == node)
+		{
+			focusNodeArray.RemoveElement(a);
+			break;
+		}
+	}
+}
+
+void ZoneStreamer::Update(void)
+{
+	unsigned_int64 startTime = TheTimeMgr->GetMicrosecondCount();
+
+	ReceiveChunks();
+
+	bool request = false;
+
+	StreamedZone *streamedZone = zoneList.First();
+	while (streamedZone)
+	{
+		float distance = GetFocusDistance(streamedZone);
+
+		switch (streamedZone->streamingState)
+		{
+			case kStreamedZoneUnloaded:
+
+				if (distance < loadDistance)
+				{
+					QueueLoad(streamedZone);
+					request = true;
+				}
+
+				break;
+
+			case kStreamedZoneQueued:
+
+				// A load that is no longer needed is allowed to finish and is discarded when it
+				// is received, but it is skipped entirely if the streaming thread has not begun it.
+
+				streamedZone->cancelFlag = (distance > unloadDistance);
+				break;
+
+			case kStreamedZoneLinking:
+			case kStreamedZoneResident:
+
+				if (distance > unloadDistance)
+				{
+					streamedZone->streamingState = kStreamedZoneUnlinking;
+				}
+
+				break;
+		}
+
+		streamedZone = streamedZone->Next();
+	}
+
+	if (request)
+	{
+		streamerSignal->Trigger(1);
+	}
+
+	LinkChunks(startTime + linkBudget);
+
+	unsigned_int64 time = TheTimeMgr->GetMicrosecondCount();
+	linkTime = (unsigned_int32) (time - startTime);
+	maxLinkTime = Max(maxLinkTime, linkTime);
+
+	unsigned_int64 endTime = time + unlinkBudget;
+
+	streamedZone = zoneList.First();
+	while (streamedZone)
+	{
+		if (streamedZone->streamingState == kStreamedZoneUnlinking)
+		{
+			if (!UnlinkChunk(streamedZone, endTime))
+			{
+				break;
+			}
+		}
+
+		streamedZone = streamedZone->Next();
+	}
+}
+
+bool ZoneStreamer::StreamedZonePresent(const Node *root)
+{
+	const Node *node = root;
+	do
+	{
+		if ((node->GetNodeType() == kNodeZone) && (!(node->GetNodeFlags() & kNodeNonpersistent)))
+		{
+			if (static_cast<const Zone *>(node)->GetObject()->GetZoneFlags() & kZoneStreamed)
+			{
+				return (true);
+			}
+		}
+
+		node = root->GetNextNode(node);
+	} while (node);
+
+	return (false);
+}
+
+FileResult ZoneStreamer::ExportChunks(Node *root, const char *worldName, ResourceLocation *location, Array<Node *> *exportArray)
+{
+	// For each streamed zone, the exported array holds the zone followed by all of its original
+	// subnodes and then a null pointer, so the RestoreChunks() function can put back the
+	// streamable subnodes in their original order among the ones that stayed in the zone.
+
+	FileResult result = kFileOkay;
+
+	int32 index = 0;
+	Node *node = root;
+	do
+	{
+		if ((node->GetNodeType() == kNodeZone) && (!(node->GetNodeFlags() & kNodeNonpersistent)))
+		{
+			Zone *zone = static_cast<Zone *>(node);
+			if (zone->GetObject()->GetZoneFlags() & kZoneStreamed)
+			{
+				Node *chunkRoot = new Node;
+				exportArray->AddElement(zone);
+
+				Node *subnode = zone->GetFirstSubnode();
+				while (subnode)
+				{
+					Node *next = subnode->Next();
+
+					exportArray->AddElement(subnode);
+					if (StreamableNode(subnode))
+					{
+						chunkRoot->AppendSubnode(subnode);
+					}
+
+					subnode = next;
+				}
+
+				exportArray->AddElement(nullptr);
+
+				ResourceName		name;
+				ResourcePath		path;
+
+				GetChunkName(worldName, index, &name);
+				TheResourceMgr->GetGenericCatalog()->GetResourcePath(WorldResource::GetDescriptor(), name, location, &path);
+
+				if (chunkRoot->GetFirstSubnode())
+				{
+					File	file;
+
+					FileResult fileResult = file.Open(path, kFileCreate);
+					if (fileResult == kFileOkay)
+					{
+						fileResult = chunkRoot->PackTree(&file, kPackInitialize);
+					}
+
+					if (fileResult != kFileOkay)
+					{
+						result = fileResult;
+					}
+
+					for (;;)
+					{
+						subnode = chunkRoot->GetFirstSubnode();
+						if (!subnode)
+						{
+							break;
+						}
+
+						chunkRoot->RemoveSubnode(subnode);
+					}
+				}
+				else
+				{
+					// A chunk file left over from an earlier export of the world would otherwise
+					// be streamed into a zone that no longer has any streamable contents.
+
+					FileMgr::DeleteFile(path);
+				}
+
+				delete chunkRoot;
+				index++;
+			}
+		}
+
+		node = root->GetNextNode(node);
+	} while (node);
+
+	return (result);
+}
+
+void ZoneStreamer::RestoreChunks(const Array<Node *> *exportArray)
+{
+	int32 count = exportArray->GetElementCount();
+	machine a = 0;
+	while (a < count)
+	{
+		Node *zone = (*exportArray)[a++];
+		for (;;)
+		{
+			Node *node = (*exportArray)[a++];
+			if (!node)
+			{
+				break;
+			}
+
+			zone->AppendSubnode(node);
+		}
+	}
+}
+
+// ZYUQURM
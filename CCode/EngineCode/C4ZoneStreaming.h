@@ -0,0 +1,288 @@
+ 
+
+#ifndef C4ZoneStreaming_h
+#define C4ZoneStreaming_h
+
+
+//# \component	World Manager
+//# \prefix		WorldMgr/
+
+
+#include "C4Zones.h"
+
+
+namespace C4
+{
+	enum
+	{
+		kZoneStreamingLinkBudget		= 2000,
+		kZoneStreamingUnlinkBudget		= 1000
+	};
+
+
+	enum
+	{
+		kStreamedZoneUnloaded,
+		kStreamedZoneQueued,
+		kStreamedZoneLinking,
+		kStreamedZoneResident,
+		kStreamedZoneUnlinking,
+		kStreamedZoneMissing
+	};
+
+
+	class World;
+	class ZoneStreamer;
+
+
+	//# \class	StreamedZone		Stores the streaming state of a zone whose contents are streamed.
+	//
+	//# The $StreamedZone$ class stores the streaming state of a zone whose contents are streamed.
+	//
+	//# \def	class StreamedZone : public ListElement<StreamedZone>
+	//
+	//# \desc
+	//# A $StreamedZone$ object is created by the $@ZoneStreamer@$ class for each zone in a world that has the
+	//# $kZoneStreamed$ flag set. The zone itself and its portals always remain in the world, and only the
+	//# contents that were exported to the zone's chunk are loaded and unloaded.
+	//
+	//# \base	Utilities/ListElement<StreamedZone>		Used internally by the zone streamer.
+	//
+	//# \also	$@ZoneStreamer@$
+
+
+	class StreamedZone : public ListElement<StreamedZone>
+	{
+		friend class ZoneStreamer;
+
+		private:
+
+			Zone					*streamedZone;
+			ResourceName			chunkName;
+
+			Point3D					zoneCenter;
+			float					zoneRadius;
+
+			int32					streamingState;
+			volatile bool			cancelFlag;
+
+			Node					*chunkRoot;
+			Node					*chunkGroup;
+			unsigned_int32			chunkSize;
+			unsigned_int32			chunkLoadTime;
+
+			StreamedZone(Zone *zone, const char *name);
+			~StreamedZone();
+
+		public:
+
+			Zone *GetZone(void) const
+			{
+				return (streamedZone);
+			}
+
+			const ResourceName& GetChunkName(void) const
+			{
+				return (chunkName);
+			}
+
+			int32 GetStreamingState(void) const
+			{
+				return (streamingState);
+			}
+
+			unsigned_int32 GetChunkSize(void) const
+			{
+				return (chunkSize);
+			}
+	};
+
+
+	//# \class	ZoneStreamer		Loads and unloads the contents of streamed zones around the camera.
+	//
+	//# The $ZoneStreamer$ class loads and unloads the contents of streamed zones around the camera.
+	//
+	//# \def	class ZoneStreamer
+	//
+	//# \ctor	ZoneStreamer(World *world);
+	//
+	//# \param	world	The world whose streamed zones are managed.
+	//
+	//# \desc
+	//# The $ZoneStreamer$ class manages the zones in a world that have the $kZoneStreamed$ flag set. When such a world
+	//# is exported from the World Editor, the nodes inside each streamed zone are written to a separate world resource,
+	//# called a chunk, and removed from the main world resource. Zones, portals, markers, instances, nodes with
+	//# controllers, and nodes with connectors that cross the boundary of their subtree always stay in the main world.
+	//#
+	//# At run time, a chunk is loaded when the camera, or any focus node, comes within the load distance of the
+	//# bounding sphere of its zone, and it is unloaded when all of them are farther away than the unload distance.
+	//# Chunk resources are read and unpacked on a dedicated streaming thread. The unpacked nodes are then added to
+	//# the zone on the main thread one top-level node at a time, which preprocesses them and inserts them into the
+	//# zone's cell graph, until the time budget for the frame is used up. Unloading is spread over frames in the
+	//# same way. Streamed nodes are nonpersistent, so they are not saved by the $@WorldMgr::SaveDeltaWorld@$ function.
+	//#
+	//# A world creates its own zone streamer when it is preprocessed if it contains at least one streamed zone.
+	//
+	//# \also	$@World::GetZoneStreamer@$
+
+
+	//# \function	ZoneStreamer::Update		Advances zone streaming by one frame.
+	//
+	//# \proto	void Update(void);
+	//
+	//# \desc
+	//# The $Update$ function is called once per frame by the world that owns the zone streamer. It decides which
+	//# chunks should be resident, queues loads, and links or unlinks chunk contents within the frame's time budgets.
+
+
+	//# \function	ZoneStreamer::ExportChunks		Writes the contents of streamed zones to separate chunk resources.
+	//
+	//# \proto	static FileResult ExportChunks(Node *root, const char *worldName, ResourceLocation *location, Array<Node *> *exportArray);
+	//
+	//# \param	root			The root node of the world being exported.
+	//# \param	worldName		The name of the world resource being exported.
+	//# \param	location		The location to which the world resource is being written.
+	//# \param	exportArray		An array that receives the nodes that were removed from the world.
+	//
+	//# \desc
+	//# The $ExportChunks$ function writes the streamable nodes inside each zone having the $kZoneStreamed$ flag set to a
+	//# world resource whose name is formed by appending the index of the zone to the world name. The nodes are removed
+	//# from their zones so that the main world can be packed without them, and the $@ZoneStreamer::RestoreChunks@$
+	//# function must be called afterwards to put them back.
+	//
+	//# \also	$@ZoneStreamer::RestoreChunks@$
+
+
+	class ZoneStreamer
+	{
+		private:
+
+			World						*streamingWorld;
+
+			float						loadDistance;
+			float						unloadDistance;
+
+			unsigned_int32				linkBudget;
+			unsigned_int32				unlinkBudget;
+
+			List<StreamedZone>			zoneList;
+			Array<StreamedZone *, 8>	requestArray;
+			Array<StreamedZone *, 8>	completeArray;
+
+			Array<Link<Node>, 4>		focusNodeArray;
+
+			unsigned_int32				residentMemory;
+			int32						residentCount;
+			int32						loadCount;
+			int32						unloadCount;
+
+			unsigned_int32				loadTime;
+			unsigned_int32				maxLoadTime;
+			unsigned_int32				linkTime;
+			unsigned_int32				maxLinkTime;
+
+			Mutex						streamerMutex;
+			Signal						*streamerSignal;
+			Thread						*streamerThread;
+			volatile bool				streamerBusy;
+
+			static void StreamerThread(const Thread *thread, void *cookie);
+
+			static bool StreamableNode(const Node *node);
+			static void GetChunkName(const char *worldName, int32 index, ResourceName *name);
+
+			float GetFocusDistance(const StreamedZone *streamedZone) const;
+
+			void QueueLoad(StreamedZone *streamedZone);
+			void ReceiveChunks(void);
+			void LinkChunks(unsigned_int64 endTime);
+			bool UnlinkChunk(StreamedZone *streamedZone, unsigned_int64 endTime);
+
+		public:
+
+			C4API ZoneStreamer(World *world);
+			C4API ~ZoneStreamer();
+
+			float GetLoadDistance(void) const
+			{
+				return (loadDistance);
+			}
+
+			float GetUnloadDistance(void) const
+			{
+				return (unloadDistance);
+			}
+
+			void SetStreamingDistances(float load, float unload)
+			{
+				loadDistance = load;
+				unloadDistance = Fmax(unload, load);
+			}
+
+			void SetStreamingBudgets(unsigned_int32 link, unsigned_int32 unlink)
+			{
+				linkBudget = link;
+				unlinkBudget = unlink;
+			}
+
+			StreamedZone *GetFirstStreamedZone(void) const
+			{
+				return (zoneList.First());
+			}
+
+			unsigned_int32 GetResidentMemory(void) const
+			{
+				return (residentMemory);
+			}
+
+			int32 GetResidentCount(void) const
+			{
+				return (residentCount);
+			}
+
+			int32 GetLoadCount(void) const
+			{
+				return (loadCount);
+			}
+
+			int32 GetUnloadCount(void) const
+			{
+				return (unloadCount);
+			}
+
+			unsigned_int32 GetLoadTime(void) const
+			{
+				return (loadTime);
+			}
+
+			unsigned_int32 GetMaxLoadTime(void) const
+			{
+				return (maxLoadTime);
+			}
+
+			unsigned_int32 GetLinkTime(void) const
+			{
+				return (linkTime);
+			}
+
+			unsigned_int32 GetMaxLinkTime(void) const
+			{
+				return (maxLinkTime);
+			}
+
+			C4API void AddFocusNode(Node *node);
+			C4API void RemoveFocusNode(Node *node);
+
+			C4API void Update(void);
+
+			C4API static bool StreamedZonePresent(const Node *root);
+
+			C4API static FileResult ExportChunks(Node *root, const char *worldName, ResourceLocation *location, Array<Node *> *exportArray);
+			C4API static void RestoreChunks(const Array<Node *> *exportArray);
+	};
+}
+
+
+#endif
+
+// ZYUQURM
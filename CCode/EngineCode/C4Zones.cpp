@@ -1,5 +1,6 @@
 #include "C4Zones.h"
 #include "C4Configuration.h"
+#include "C4World.h"
 
 
 using namespace C4;
@@ -149,7 +150,7 @@ int32 ZoneObject::GetCategorySettingCount(Type category) const
 {
 	if (category == kObjectZone)
 	{
-		return (4);
+		return (7);
 	}
 
 	return (0);
@@ -186,6 +187,24 @@ Setting *ZoneObject::GetCategorySetting(Type category, int32 index, unsigned_int
 			const char *picker = table->GetString(StringID(kObjectZone, 'ZONE', 'TPCK'));
 			return (new ResourceSetting('ENVR', environmentName, title, picker, TextureResource::GetDescriptor()));
 		}
+
+		if (index == 4)
+		{
+			const char *title = table->GetString(StringID(kObjectZone, 'ZONE', 'OCTR'));
+			return (new BooleanSetting('OCTR', ((zoneFlags & kZoneLooseOctree) != 0), title));
+		}
+
+		if (index == 5)
+		{
+			const char *title = table->GetString(StringID(kObjectZone, 'ZONE', 'NAVM'));
+			return (new BooleanSetting('NAVM', ((zoneFlags & kZoneNavigationMesh) != 0), title));
+		}
+
+		if (index == 6)
+		{
+			const char *title = table->GetString(StringID(kObjectZone, 'ZONE', 'STRM'));
+			return (new BooleanSetting('STRM', ((zoneFlags & kZoneStreamed) != 0), title));
+		}
 	}
 
 	return (nullptr);
@@ -216,6 +235,39 @@ void ZoneObject::SetCategorySetting(Type category, const Setting *setting)
 		{
 			environmentName = static_cast<const ResourceSetting *>(setting)->GetResourceName();
 		}
+		else if (identifier == 'OCTR')
+		{
+			if (static_cast<const BooleanSetting *>(setting)->GetBooleanValue())
+			{
+				zoneFlags |= kZoneLooseOctree;
+			}
+			else
+			{
+				zoneFlags &= ~kZoneLooseOctree;
+			}
+		}
+		else if (identifier == 'NAVM')
+		{
+			if (static_cast<const BooleanSetting *>(setting)->GetBooleanValue())
+			{
+				zoneFlags |= kZoneNavigationMesh;
+			}
+			else
+			{
+				zoneFlags &= ~kZoneNavigationMesh;
+			}
+		}
+		else if (identifier == 'STRM')
+		{
+			if (static_cast<const BooleanSetting *>(setting)->GetBooleanValue())
+			{
+				zoneFlags |= kZoneStreamed;
+			}
+			else
+			{
+				zoneFlags &= ~kZoneStreamed;
+			}
+		}
 	}
 }
 
@@ -2101,6 +2153,8 @@ C4::Zone::Zone(ZoneType type) : Node(kNodeZone)
 	connectedShadowSpace = nullptr;
 	connectedAcousticsSpace = nullptr;
 	connectedRadiositySpace = nullptr;
+
+	navigationTile = nullptr;
 }
 
 C4::Zone::Zone(const Zone& zone) : Node(zone)
@@ -2113,10 +2167,14 @@ C4::Zone::Zone(const Zone& zone) : Node(zone)
 	connectedShadowSpace = nullptr;
 	connectedAcousticsSpace = nullptr;
 	connectedRadiositySpace = nullptr;
+
+	navigationTile = nullptr;
 }
 
 C4::Zone::~Zone()
 {
+	delete navigationTile;
+
 	subzoneList.RemoveAll();
 	portalList.RemoveAll();
 	occlusionPortalList.RemoveAll();
@@ -2175,6 +2233,13 @@ void C4::Zone::Pack(Packer& data, unsigned_int32 packFlags) const
 		data << physicsNode->GetNodeIndex();
 	}
 
+	if (navigationTile)
+	{
+		PackHandle handle = data.BeginChunk('NAVI');
+		navigationTile->Pack(data);
+		data.EndChunk(handle);
+	}
+
 	data << TerminatorChunk;
 }
 
@@ -2196,6 +2261,14 @@ bool C4::Zone::UnpackChunk(const ChunkHeader *chunkHeader, Unpacker& data, unsig
 			data.AddNodeLink(physicsNodeIndex, &PhysicsNodeLinkProc, this);
 			return (true);
 		}
+
+		case 'NAVI':
+		{
+			NavigationTile *tile = new NavigationTile;
+			tile->Unpack(data);
+			SetNavigationTile(tile);
+			return (true);
+		}
 	}
 
 	return (false);
@@ -2342,6 +2415,21 @@ void C4::Zone::SetConnectedRadiositySpace(RadiositySpace *radiositySpace)
 	SetConnectedNode(kConnectorKeyRadiosity, radiositySpace);
 }
 
+void C4::Zone::SetNavigationTile(NavigationTile *tile)
+{
+	delete navigationTile;
+	navigationTile = tile;
+
+	if (tile)
+	{
+		World *world = GetWorld();
+		if (world)
+		{
+			world->GetNavigationMesh()->AddTile(tile);
+		}
+	}
+}
+
 void C4::Zone::Preprocess(void)
 {
 	Zone *zone = GetOwningZone();
@@ -2355,7 +2443,22 @@ void C4::Zone::Preprocess(void)
 		const Box3D& box = GetWorldBoundingBox();
 		float size = Fmax(box.max.x - box.min.x, box.max.y - box.min.y);
 
-		if (size >= 64.0F)
+		if (GetObject()->GetZoneFlags() & kZoneLooseOctree)
+		{
+			// The loose octree subdivides vertically as well, so it is used for every cell graph
+			// in zones large enough to benefit from it regardless of their horizontal extent.
+
+			size = Fmax(size, box.max.z - box.min.z);
+			if (size >= 16.0F)
+			{
+				float leafSize = (size >= 64.0F) ? 16.0F : ((size >= 32.0F) ? 8.0F : 4.0F);
+				for (machine a = 0; a < kCellGraphCount; a++)
+				{
+					cellGraph[a].Activate(box, leafSize, kCellStructureLooseOctree);
+				}
+			}
+		}
+		else if (size >= 64.0F)
 		{
 			for (machine a = 0; a < kCellGraphCount; a++)
 			{
@@ -2376,6 +2479,16 @@ void C4::Zone::Preprocess(void)
 
 	Node::Preprocess();
 
+	NavigationTile *tile = navigationTile;
+	if ((tile) && (!tile->GetOwningMesh()))
+	{
+		World *world = GetWorld();
+		if (world)
+		{
+			world->GetNavigationMesh()->AddTile(tile);
+		}
+	}
+
 	ZoneObject *object = GetObject();
 	ambientEnvironment.ambientLightColor = &object->GetAmbientLight();
 
@@ -2401,6 +2514,21 @@ void C4::Zone::Preprocess(void)
 	}
 }
 
+void C4::Zone::Neutralize(void)
+{
+	NavigationTile *tile = navigationTile;
+	if (tile)
+	{
+		NavigationMesh *mesh = tile->GetOwningMesh();
+		if (mesh)
+		{
+			mesh->RemoveTile(tile);
+		}
+	}
+
+	Node::Neutralize();
+}
+
 void C4::Zone::InvalidateLightRegions(void) const
 {
 	for (;;)
@@ -2537,6 +2665,23 @@ bool C4::Zone::InsertZoneTreeSite(int32 index, Node *node, int32 maxDepth, int32
 	return (true);
 }
 
+bool C4::Zone::UpdateZoneTreeSite(int32 index, Node *node)
+{
+	// If this zone has no subzones, then a node that belongs to this zone alone will still belong
+	// to it after it moves, and the cell graph may be able to keep the node's existing bond.
+
+	if (subzoneList.Empty())
+	{
+		const Node::ZoneMembershipArray& membershipArray = node->GetZoneMembershipArray();
+		if ((membershipArray.GetElementCount() == 1) && (membershipArray[0] == this))
+		{
+			return (cellGraph[index].UpdateSite(node));
+		}
+	}
+
+	return (false);
+}
+
 void C4::Zone::InsertInfiniteSite(int32 index, Node *node, int32 depth)
 {
 	if (depth > 0)
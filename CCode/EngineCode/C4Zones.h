@@ -15,6 +15,7 @@
 #include "C4Models.h"
 #include "C4Markers.h"
 #include "C4Physics.h"
+#include "C4Navigation.h"
 
 
 namespace C4
@@ -43,7 +44,10 @@ namespace C4
 
 	enum
 	{
-		kZoneRenderSkybox		= 1 << 0		//## The skybox is visible from this zone.
+		kZoneRenderSkybox		= 1 << 0,		//## The skybox is visible from this zone.
+		kZoneLooseOctree		= 1 << 1,		//## Nodes in this zone are organized in a loose octree instead of the default quadtree.
+		kZoneNavigationMesh		= 1 << 2,		//## A navigation tile is built for this zone when the world is saved in the World Editor.
+		kZoneStreamed			= 1 << 3		//## The contents of this zone are exported to a separate chunk and streamed in at run time. See $@ZoneStreamer@$.
 	};
 
 
@@ -562,6 +566,33 @@ namespace C4
 	//# \table	ZoneType
 
 
+	//# \function	Zone::GetNavigationTile		Returns the navigation tile belonging to a zone.
+	//
+	//# \proto	NavigationTile *GetNavigationTile(void) const;
+	//
+	//# \desc
+	//# The $GetNavigationTile$ function returns the navigation tile belonging to a zone. If the zone does not have
+	//# a navigation tile, then the return value is $nullptr$.
+	//
+	//# \also	$@Zone::SetNavigationTile@$
+	//# \also	$@WorldMgr/NavigationTile@$
+
+
+	//# \function	Zone::SetNavigationTile		Sets the navigation tile belonging to a zone.
+	//
+	//# \proto	void SetNavigationTile(NavigationTile *tile);
+	//
+	//# \param	tile	The new navigation tile. This can be $nullptr$.
+	//
+	//# \desc
+	//# The $SetNavigationTile$ function sets the navigation tile belonging to a zone. The zone takes ownership of the
+	//# tile, and any previous tile is deleted. If the zone has already been preprocessed, then the new tile is added
+	//# to the world's navigation mesh immediately. Otherwise, it is added when the zone is preprocessed.
+	//
+	//# \also	$@Zone::GetNavigationTile@$
+	//# \also	$@WorldMgr/NavigationTile::Build@$
+
+
 	class Zone : public Node, public ListElement<Zone>
 	{
 		friend class Node;
@@ -590,6 +621,8 @@ namespace C4
 
 			Link<Node>					physicsNodeLink;
 
+			NavigationTile				*navigationTile;
+
 			List<CameraRegion>			cameraRegionList;
 			List<LightRegion>			lightRegionList;
 			List<SourceRegion>			sourceRegionList;
@@ -672,6 +705,16 @@ namespace C4
 				return (&cellGraph[index]);
 			}
 
+			CellGraph *GetCellGraph(int32 index)
+			{
+				return (&cellGraph[index]);
+			}
+
+			const CellGraph *GetCellGraph(int32 index) const
+			{
+				return (&cellGraph[index]);
+			}
+
 			Zone *GetFirstSubzone(void) const
 			{
 				return (subzoneList.First());
@@ -737,6 +780,11 @@ namespace C4
 				physicsNodeLink = physicsNode;
 			}
 
+			NavigationTile *GetNavigationTile(void) const
+			{
+				return (navigationTile);
+			}
+
 			CameraRegion *GetFirstCameraRegion(void) const
 			{
 				return (cameraRegionList.First());
@@ -783,12 +831,16 @@ namespace C4
 			C4API void SetConnectedAcousticsSpace(AcousticsSpace *acousticsSpace);
 			C4API void SetConnectedRadiositySpace(RadiositySpace *radiositySpace);
 
+			C4API void SetNavigationTile(NavigationTile *tile);
+
 			void Preprocess(void) override;
+			void Neutralize(void) override;
 
 			C4API void InvalidateLightRegions(void) const;
 			C4API void InvalidateSourceRegions(void) const;
 
 			bool InsertZoneTreeSite(int32 index, Node *node, int32 maxDepth, int32 forcedDepth);
+			bool UpdateZoneTreeSite(int32 index, Node *node);
 			void InsertInfiniteSite(int32 index, Node *node, int32 depth);
 	};
 
@@ -461,15 +461,18 @@ bool GoblinController::HandleChasingState(void)
 
 	if (GetEnemyDirection(&direction))
 	{
+		Vector3D	chaseDirection;
+
 		float targetDistance = Magnitude(direction);
-		float azm0 = Atan(direction.y, direction.x);
+		bool detour = GetChaseDirection(direction, &chaseDirection);
+		float azm0 = Atan(chaseDirection.y, chaseDirection.x);
 		float azm = SetMonsterAzimuth(azm0, kGoblinTurnRate);
 
 		if ((targetDistance > kGoblinAttackDistance) || (GetStateTime() < 100))
 		{
 			force += CosSin(azm) * kGoblinRunForce;
 
-			if (goblinFlags & kGoblinLeapAttack)
+			if ((goblinFlags & kGoblinLeapAttack) && (!detour))
 			{
 				if ((targetDistance < leapDistance) && (targetDistance > leapDistance * 0.8F) && (Fabs(azm - azm0) < 0.5F))
 				{
@@ -20,6 +20,18 @@
 using namespace C4;
 
 
+namespace
+{
+	enum
+	{
+		kMonsterRepathTime = 1000
+	};
+
+	const float kMonsterRepathDistance = 2.0F;
+	const float kMonsterWaypointRadius = 0.5F;
+}
+
+
 MonsterController::MonsterController(ControllerType type) : GameCharacterController(kCharacterMonster, type)
 {
 	monsterFlags = 0;
@@ -35,6 +47,11 @@ MonsterController::MonsterController(ControllerType type) : GameCharacterControl
 	repulsionTime = 0;
 
 	sourcePosition.Set(0.0F, 0.0F, 0.0F);
+
+	pathQuery = nullptr;
+	pathPending = false;
+	pathIndex = 0;
+	pathTime = 0;
 }
 
 MonsterController::MonsterController(const MonsterController& monsterController) : GameCharacterController(monsterController)
@@ -52,10 +69,16 @@ MonsterController::MonsterController(const MonsterController& monsterController)
 	repulsionTime = 0;
 
 	sourcePosition = monsterController.sourcePosition;
+
+	pathQuery = nullptr;
+	pathPending = false;
+	pathIndex = 0;
+	pathTime = 0;
 }
 
 MonsterController::~MonsterController()
 {
+	delete pathQuery;
 }
 
 void MonsterController::Pack(Packer& data, unsigned_int32 packFlags) const
@@ -454,6 +477,81 @@ bool MonsterController::GetEnemyDirection(Vector3D *direction)
 	return (false);
 }
 
+bool MonsterController::GetChaseDirection(const Vector3D& enemyDirection, Vector3D *chaseDirection)
+{
+	// If the world has a navigation mesh, then a path to the enemy is found on a worker thread, and
+	// the monster heads for the next point on the path. A new path is requested periodically and
+	// whenever the enemy moves far from the goal of the current path. The return value is true if
+	// the chase direction points somewhere other than straight at the enemy.
+
+	*chaseDirection = enemyDirection;
+
+	NavigationMesh *mesh = GetTargetNode()->GetWorld()->GetNavigationMesh();
+	if (mesh->GetTileCount() == 0)
+	{
+		return (false);
+	}
+
+	const Point3D& position = GetTargetNode()->GetWorldPosition();
+	Point3D goal = position + enemyDirection;
+
+	NavigationQuery *query = pathQuery;
+	if (!query)
+	{
+		query = new NavigationQuery;
+		pathQuery = query;
+	}
+
+	if (pathPending)
+	{
+		if (query->Complete())
+		{
+			pathPending = false;
+			pathArray.Clear();
+			pathIndex = 1;
+
+			if (query->GetQueryResult() != kNavigationPathNone)
+			{
+				const ImmutableArray<Point3D>& array = query->GetPathArray();
+				int32 count = array.GetElementCount();
+				for (machine a = 0; a < count; a++)
+				{
+					pathArray.AddElement(array[a]);
+				}
+			}
+		}
+	}
+	else
+	{
+		pathTime -= TheTimeMgr->GetDeltaTime();
+		if ((pathTime <= 0) || (SquaredMag((goal - pathGoal).GetVector2D()) > kMonsterRepathDistance * kMonsterRepathDistance))
+		{
+			query->Submit(mesh, position, goal);
+			pathPending = true;
+			pathTime = kMonsterRepathTime;
+			pathGoal = goal;
+		}
+	}
+
+	// The last point on the path is the old goal position, so the monster heads straight for
+	// the enemy once it reaches the final segment.
+
+	int32 count = pathArray.GetElementCount() - 1;
+	while (pathIndex < count)
+	{
+		Vector3D delta = pathArray[pathIndex] - position;
+		if (SquaredMag(delta.GetVector2D()) > kMonsterWaypointRadius * kMonsterWaypointRadius)
+		{
+			*chaseDirection = delta;
+			return (true);
+		}
+
+		pathIndex++;
+	}
+
+	return (false);
+}
+
 void MonsterController::DamageEnemy(Fixed damage, float range)
 {
 	GameCharacterController *enemy = enemyController;
@@ -20,6 +20,7 @@
 #include "C4Models.h"
 #include "C4Sources.h"
 #include "C4Scripts.h"
+#include "C4Navigation.h"
 #include "MGCharacter.h"
 
 
@@ -60,6 +61,13 @@ namespace C4
 
 			Link<GameCharacterController>	enemyController;
 
+			NavigationQuery					*pathQuery;
+			bool							pathPending;
+			int32							pathIndex;
+			int32							pathTime;
+			Point3D							pathGoal;
+			Array<Point3D>					pathArray;
+
 			AnimationBlender				animationBlender;
 
 			static void EnemyLinkProc(Node *node, void *cookie);
@@ -138,6 +146,7 @@ namespace C4
 			float SetMonsterAzimuth(float azimuth, float maxRotationRate, float *deriv);
 
 			bool GetEnemyDirection(Vector3D *direction);
+			bool GetChaseDirection(const Vector3D& enemyDirection, Vector3D *chaseDirection);
 			void DamageEnemy(Fixed damage, float range);
 
 			OmniSource *PlaySource(const char *name, float range);
@@ -906,8 +906,11 @@ bool SkeletonController::HandleChasingState(void)
 
 	if (GetEnemyDirection(&direction))
 	{
+		Vector3D	chaseDirection;
+
 		float targetDistance = Magnitude(direction);
-		float azm0 = Atan(direction.y, direction.x);
+		GetChaseDirection(direction, &chaseDirection);
+		float azm0 = Atan(chaseDirection.y, chaseDirection.x);
 		float azm = SetMonsterAzimuth(azm0, kSkeletonTurnRate);
 
 		if ((targetDistance > kSkeletonAttackDistance) || (GetStateTime() < 100))
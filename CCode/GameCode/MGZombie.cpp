@@ -630,8 +630,11 @@ bool ZombieController::HandleChasingState(void)
 
 	if (GetEnemyDirection(&direction))
 	{
+		Vector3D	chaseDirection;
+
 		float targetDistance = Magnitude(direction);
-		float azm = SetMonsterAzimuth(Atan(direction.y, direction.x), zombieTurnRate);
+		GetChaseDirection(direction, &chaseDirection);
+		float azm = SetMonsterAzimuth(Atan(chaseDirection.y, chaseDirection.x), zombieTurnRate);
 
 		if ((targetDistance > kZombieAttackDistance) || (GetStateTime() < 250))
 		{
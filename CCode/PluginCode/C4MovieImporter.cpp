@@ -46,7 +46,7 @@ MovieImporter::~MovieImporter()
 
 int32 MovieImporter::GetSettingCount(void) const
 {
-	return (10);
+	return (11);
 }
 
 Setting *MovieImporter::GetSetting(int32 index) const
@@ -102,12 +102,18 @@ Setting *MovieImporter::GetSetting(int32 index) const
 	}
 
 	if (index == 8)
+	{
+		const char *title = table->GetString(StringID('IMOV', 'VDEO', 'SLCE'));
+		return (new BooleanSetting('SLCE', ((videoTrackFlags & kVideoSliced) != 0), title));
+	}
+
+	if (index == 9)
 	{
 		const char *title = table->GetString(StringID('IMOV', 'ADIO'));
 		return (new HeadingSetting('ADIO', title));
 	}
 
-	if (index == 9)
+	if (index == 10)
 	{
 		const char *title = table->GetString(StringID('IMOV', 'ADIO', 'NAME'));
 		const char *picker = table->GetString(StringID('IMOV', 'ADIO', 'PICK'));
@@ -154,6 +160,17 @@ void MovieImporter::SetSetting(const Setting *setting)
 			videoTrackFlags &= ~kVideoAlphaChannel;
 		}
 	}
+	else if (identifier == 'SLCE')
+	{
+		if (static_cast<const BooleanSetting *>(setting)->GetBooleanValue())
+		{
+			videoTrackFlags |= kVideoSliced;
+		}
+		else
+		{
+			videoTrackFlags &= ~kVideoSliced;
+		}
+	}
 	else if (identifier == 'ANAM')
 	{
 		inputAudioName = static_cast<const ResourceSetting *>(setting)->GetResourceName();
@@ -404,11 +421,21 @@ EngineResult MovieImporter::ImportMovie(const List<MovieFileName> *fileList)
 				videoFrameDataOffset += videoFrameDataSize;
 
 				maxFrameCodeSize = Max(maxFrameCodeSize, videoFrameDataSize);
-				maxFrameDataSize = Max(maxFrameDataSize, videoFrameHeader[delta].luminanceData.flatDataSize + videoFrameHeader[delta].luminanceData.wlenDataSize + videoFrameHeader[delta].luminanceData.wavyDataSize);
-				maxFrameDataSize = Max(maxFrameDataSize, videoFrameHeader[delta].chrominanceData.flatDataSize + videoFrameHeader[delta].chrominanceData.wlenDataSize + videoFrameHeader[delta].chrominanceData.wavyDataSize);
-				if (videoTrackFlags & kVideoAlphaChannel)
+
+				unsigned_int32 luminanceDataSize = videoFrameHeader[delta].luminanceData.GetDataSize();
+				unsigned_int32 chrominanceDataSize = videoFrameHeader[delta].chrominanceData.GetDataSize();
+				unsigned_int32 alphaDataSize = (videoTrackFlags & kVideoAlphaChannel) ? videoFrameHeader[delta].alphaData.GetDataSize() : 0;
+
+				if (videoTrackFlags & kVideoSliced)
+				{
+					// The slices of all channels are decoded at the same time, so
+					// the decompressed data for every channel must fit at once.
+
+					maxFrameDataSize = Max(maxFrameDataSize, luminanceDataSize + chrominanceDataSize + alphaDataSize);
+				}
+				else
 				{
-					maxFrameDataSize = Max(maxFrameDataSize, videoFrameHeader[delta].alphaData.flatDataSize + videoFrameHeader[delta].alphaData.wlenDataSize + videoFrameHeader[delta].alphaData.wavyDataSize);
+					maxFrameDataSize = Max(maxFrameDataSize, Max(Max(luminanceDataSize, chrominanceDataSize), alphaDataSize));
 				}
 
 				movieFile.Write(&videoFrameHeader[delta], (videoTrackFlags & kVideoAlphaChannel) ? sizeof(VideoAlphaFrameHeader) : sizeof(VideoFrameHeader));
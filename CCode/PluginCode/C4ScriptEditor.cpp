@@ -1891,7 +1891,7 @@ void ScriptVariablesPage::BuildVariableList(void)
 	Value *value = GetScriptEditor()->GetValueMap()->First();
 	while (value)
 	{
-		listWidget->AppendListItem(new VariableWidget(size, value));
+		listWidget->InsertSortedListItem(new VariableWidget(size, value), &Text::CompareTextLessThan);
 		value = value->Next();
 	}
 }
@@ -0,0 +1,105 @@
+//=============================================================
+//
+// C4 Engine version 4.5
+// Copyright 1999-2015, by Terathon Software LLC
+//
+// This file is part of the C4 Engine and is provided under the
+// terms of the license agreement entered by the registed user.
+//
+// Unauthorized redistribution of source code is strictly
+// prohibited. Violators will be prosecuted.
+//
+//=============================================================
+
+
+#include "C4ShaderCacheBuilder.h"
+#include "C4World.h"
+
+
+using namespace C4;
+
+
+ShaderCacheBuilder *C4::TheShaderCacheBuilder = nullptr;
+
+
+C4::Plugin *CreatePlugin(void)
+{
+	return (new ShaderCacheBuilder);
+}
+
+
+ShaderCacheBuilder::ShaderCacheBuilder() :
+		Singleton<ShaderCacheBuilder>(TheShaderCacheBuilder),
+		buildCommandObserver(this, &ShaderCacheBuilder::HandleBuildCommand),
+		buildCommand("shcache", &buildCommandObserver)
+{
+	TheEngine->AddCommand(&buildCommand);
+}
+
+ShaderCacheBuilder::~ShaderCacheBuilder()
+{
+}
+
+bool ShaderCacheBuilder::BuildCache(World *world, const char *path)
+{
+	bool enabled = ShaderCache::Enabled();
+	ShaderCache::SetEnabled(true);
+
+	int32 permutationCount = ShaderCache::GetPermutationCount();
+	int32 failCount = ShaderCache::GetPermutationFailCount();
+	unsigned_int64 permutationTime = ShaderCache::GetPermutationTime();
+
+	int32 vertexCount = ShaderCache::GetSourceCount(kShaderStageVertex);
+	int32 fragmentCount = ShaderCache::GetSourceCount(kShaderStageFragment);
+
+	ShaderCache::GeneratePermutations(world->GetRootNode(), (1 << kShaderTypeCount) - 1, (1 << kShaderVariantCount) - 1, false);
+
+	bool result = ShaderCache::Save(path);
+	ShaderCache::SetEnabled(enabled);
+
+	String<>		report;
+
+	report = "Shader permutations: ";
+	report += ShaderCache::GetPermutationCount() - permutationCount;
+	report += " (";
+	report += ShaderCache::GetPermutationFailCount() - failCount;
+	report += " failed) in ";
+	report += (int32) ((ShaderCache::GetPermutationTime() - permutationTime) / 1000);
+	report += " ms, new vertex sources: ";
+	report += ShaderCache::GetSourceCount(kShaderStageVertex) - vertexCount;
+	report += ", new fragment sources: ";
+	report += ShaderCache::GetSourceCount(kShaderStageFragment) - fragmentCount;
+	Engine::Report(report);
+
+	return (result);
+}
+
+void ShaderCacheBuilder::HandleBuildCommand(Command *command, const char *text)
+{
+	if (*text != 0)
+	{
+		ResourceName	name;
+
+		Text::ReadString(text, name, kMaxResourceNameLength);
+
+		World *world = new World(name, kWorldViewport | kWorldListenerInhibit);
+		if (world->Preprocess() == kWorldOkay)
+		{
+			ResourcePath	path;
+
+			ShaderCache::GetDefaultCachePath(&path);
+			if (!BuildCache(world, path))
+			{
+				Engine::Report("Unable to write the shader cache", kReportError);
+			}
+		}
+		else
+		{
+			Engine::Report("Unable to load the world", kReportError);
+		}
+
+		delete world;
+	}
+}
+
+// ZYUQURM
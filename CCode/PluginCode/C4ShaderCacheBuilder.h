@@ -0,0 +1,64 @@
+//=============================================================
+//
+// C4 Engine version 4.5
+// Copyright 1999-2015, by Terathon Software LLC
+//
+// This file is part of the C4 Engine and is provided under the
+// terms of the license agreement entered by the registed user.
+//
+// Unauthorized redistribution of source code is strictly
+// prohibited. Violators will be prosecuted.
+//
+//=============================================================
+
+
+#ifndef C4ShaderCacheBuilder_h
+#define C4ShaderCacheBuilder_h
+
+
+#include "C4Plugins.h"
+#include "C4ShaderCache.h"
+
+
+extern "C"
+{
+	C4MODULEEXPORT C4::Plugin *CreatePlugin(void);
+}
+
+
+namespace C4
+{
+	class World;
+
+
+	// The ShaderCacheBuilder plugin loads a world, generates the source code for every shader
+	// permutation that its geometry can use, and writes the result into the shader cache file.
+	// Source generation does not create any GPU objects and is spread over the Job Manager's
+	// worker threads, so the tool only needs the engine to be running; it does not need to
+	// render the world.
+
+	class ShaderCacheBuilder : public Plugin, public Singleton<ShaderCacheBuilder>
+	{
+		private:
+
+			CommandObserver<ShaderCacheBuilder>		buildCommandObserver;
+			Command									buildCommand;
+
+			void HandleBuildCommand(Command *command, const char *text);
+
+		public:
+
+			ShaderCacheBuilder();
+			~ShaderCacheBuilder();
+
+			C4API static bool BuildCache(World *world, const char *path);
+	};
+
+
+	extern ShaderCacheBuilder *TheShaderCacheBuilder;
+}
+
+
+#endif
+
+// ZYUQURM
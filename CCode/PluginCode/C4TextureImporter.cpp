@@ -60,133 +60,6 @@ namespace
 List<ImportTextureWindow> ImportTextureWindow::windowList;
 
 
-CompressionBC1Job::CompressionBC1Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output) : BatchJob(&JobCompress)
-{
-	imageWidth = width;
-	blockRect = rect;
-	sourceImage = source;
-	outputCode = output;
-}
-
-CompressionBC1Job::~CompressionBC1Job()
-{
-}
-
-void CompressionBC1Job::JobCompress(Job *job, void *cookie)
-{
-	const CompressionBC1Job *compJob = static_cast<CompressionBC1Job *>(job);
-
-	int32 width = compJob->imageWidth;
-	const Color4C *image = compJob->sourceImage + compJob->blockRect.top * width * 4;
-	unsigned_int8 *code = compJob->outputCode + compJob->blockRect.top * width * 2;
-
-	for (machine j = compJob->blockRect.top; j < compJob->blockRect.bottom; j++)
-	{
-		for (machine i = compJob->blockRect.left; i < compJob->blockRect.right; i++)
-		{
-			Image::CompressColorBlock(4, 4, width, false, image + i * 4, code + i * 8);
-		}
-
-		image += width * 4;
-		code += width * 2;
-	}
-}
-
-
-CompressionBC3Job::CompressionBC3Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output) : BatchJob(&JobCompress)
-{
-	imageWidth = width;
-	blockRect = rect;
-	sourceImage = source;
-	outputCode = output;
-}
-
-CompressionBC3Job::~CompressionBC3Job()
-{
-}
-
-void CompressionBC3Job::JobCompress(Job *job, void *cookie)
-{
-	const CompressionBC3Job *compJob = static_cast<CompressionBC3Job *>(job);
-
-	int32 width = compJob->imageWidth;
-	const Color4C *image = compJob->sourceImage + compJob->blockRect.top * width * 4;
-	unsigned_int8 *code = compJob->outputCode + compJob->blockRect.top * width * 4;
- 
-	for (machine j = compJob->blockRect.top; j < compJob->blockRect.bottom; j++)
-	{
-		for (machine i = compJob->blockRect.left; i < compJob->blockRect.right; i++) 
-		{
-			unsigned_int8	gray[16]; 
-
-			const Color4C *input = image + i * 4;
-			unsigned_int8 *output = code + i * 16; 
-
-			for (machine n = 0; n < 4; n++) 
-			{ 
-				for (machine m = 0; m < 4; m++)
-				{
-					gray[n * 4 + m] = (unsigned_int8) input[n * width + m].GetAlpha();
-				} 
-			}
-
-			Image::CompressGrayBlock(4, 4, 4, gray, output);
-			Image::CompressColorBlock(4, 4, width, true, input, output + 8);
-		}
-
-		image += width * 4;
-		code += width * 4;
-	}
-}
-
-
-CompressionNormalBC3Job::CompressionNormalBC3Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output) : BatchJob(&JobCompress)
-{
-	imageWidth = width;
-	blockRect = rect;
-	sourceImage = source;
-	outputCode = output;
-}
-
-CompressionNormalBC3Job::~CompressionNormalBC3Job()
-{
-}
-
-void CompressionNormalBC3Job::JobCompress(Job *job, void *cookie)
-{
-	const CompressionNormalBC3Job *compJob = static_cast<CompressionNormalBC3Job *>(job);
-
-	int32 width = compJob->imageWidth;
-	const Color4C *image = compJob->sourceImage + compJob->blockRect.top * width * 4;
-	unsigned_int8 *code = compJob->outputCode + compJob->blockRect.top * width * 4;
-
-	for (machine j = compJob->blockRect.top; j < compJob->blockRect.bottom; j++)
-	{
-		for (machine i = compJob->blockRect.left; i < compJob->blockRect.right; i++)
-		{
-			unsigned_int8	gray[16];
-
-			const Color4C *input = image + i * 4;
-			unsigned_int8 *output = code + i * 16;
-
-			for (machine n = 0; n < 4; n++)
-			{
-				for (machine m = 0; m < 4; m++)
-				{
-					gray[n * 4 + m] = (unsigned_int8) input[n * width + m].GetAlpha();
-				}
-			}
-
-			Image::CompressGrayBlock(4, 4, 4, gray, output);
-			Image::CompressGreenBlock(4, 4, width, input, output + 8);
-		}
-
-		image += width * 4;
-		code += width * 4;
-	}
-}
-
-
 AmbientJob::AmbientJob(int32 width, int32 height, const Rect& rect, const Color4C *source, Color4C *destin, float scale, bool swrap, bool twrap) : BatchJob(&JobCompute)
 {
 	textureWidth = width;
@@ -1853,196 +1726,6 @@ void TextureImporter::WriteAuxiliaryData(File& file) const
 	}
 }
 
-int32 TextureImporter::BlockCompressImageBC1(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data)
-{
-	int32 blockCountX = (width + 3) >> 2;
-	int32 blockCountY = (height + 3) >> 2;
-	int32 blockWidth = Min(width, 4);
-	int32 blockHeight = Min(height, 4);
-
-	if (Min(blockCountX, blockCountY) > 1)
-	{
-		Batch	batch;
-
-		int32 xcount = (blockCountX + 15) >> 4;
-		int32 ycount = (blockCountY + 15) >> 4;
-
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < ycount; j++)
-			{
-				int32 y = j << 4;
-				for (machine i = 0; i < xcount; i++)
-				{
-					int32 x = i << 4;
-					CompressionBC1Job *job = new CompressionBC1Job(width, Rect(x, y, Min(x + 16, blockCountX), Min(y + 16, blockCountY)), image, data);
-					job->SetJobFlags(kJobNonpersistent);
-					TheJobMgr->SubmitJob(job, &batch);
-				}
-			}
-
-			image += width * height;
-			data += blockCountX * blockCountY * 8;
-		}
-
-		TheJobMgr->FinishBatch(&batch);
-	}
-	else
-	{
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < blockCountY; j++)
-			{
-				for (machine i = 0; i < blockCountX; i++)
-				{
-					Image::CompressColorBlock(blockWidth, blockHeight, width, false, image + i * 4, data + i * 8);
-				}
-
-				image += width * blockHeight;
-				data += blockCountX * 8;
-			}
-		}
-	}
-
-	return (blockCountX * blockCountY * count);
-}
-
-int32 TextureImporter::BlockCompressImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data)
-{
-	int32 blockCountX = (width + 3) >> 2;
-	int32 blockCountY = (height + 3) >> 2;
-	int32 blockWidth = Min(width, 4);
-	int32 blockHeight = Min(height, 4);
-
-	if (Min(blockCountX, blockCountY) > 1)
-	{
-		Batch	batch;
-
-		int32 xcount = (blockCountX + 15) >> 4;
-		int32 ycount = (blockCountY + 15) >> 4;
-
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < ycount; j++)
-			{
-				int32 y = j << 4;
-				for (machine i = 0; i < xcount; i++)
-				{
-					int32 x = i << 4;
-					CompressionBC3Job *job = new CompressionBC3Job(width, Rect(x, y, Min(x + 16, blockCountX), Min(y + 16, blockCountY)), image, data);
-					job->SetJobFlags(kJobNonpersistent);
-					TheJobMgr->SubmitJob(job, &batch);
-				}
-			}
-
-			image += width * height;
-			data += blockCountX * blockCountY * 16;
-		}
-
-		TheJobMgr->FinishBatch(&batch);
-	}
-	else
-	{
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < blockCountY; j++)
-			{
-				for (machine i = 0; i < blockCountX; i++)
-				{
-					unsigned_int8	gray[16];
-
-					const Color4C *input = image + i * 4;
-					unsigned_int8 *output = data + i * 16;
-
-					for (machine n = 0; n < 4; n++)
-					{
-						for (machine m = 0; m < 4; m++)
-						{
-							gray[n * 4 + m] = (unsigned_int8) input[n * width + m].GetAlpha();
-						}
-					}
-
-					Image::CompressGrayBlock(blockWidth, blockHeight, 4, gray, output);
-					Image::CompressColorBlock(blockWidth, blockHeight, width, true, input, output + 8);
-				}
-
-				image += width * blockHeight;
-				data += blockCountX * 16;
-			}
-		}
-	}
-
-	return (blockCountX * blockCountY * count);
-}
-
-int32 TextureImporter::BlockCompressNormalImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data)
-{
-	int32 blockCountX = (width + 3) >> 2;
-	int32 blockCountY = (height + 3) >> 2;
-	int32 blockWidth = Min(width, 4);
-	int32 blockHeight = Min(height, 4);
-
-	if (Min(blockCountX, blockCountY) > 1)
-	{
-		Batch	batch;
-
-		int32 xcount = (blockCountX + 15) >> 4;
-		int32 ycount = (blockCountY + 15) >> 4;
-
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < ycount; j++)
-			{
-				int32 y = j << 4;
-				for (machine i = 0; i < xcount; i++)
-				{
-					int32 x = i << 4;
-					CompressionNormalBC3Job *job = new CompressionNormalBC3Job(width, Rect(x, y, Min(x + 16, blockCountX), Min(y + 16, blockCountY)), image, data);
-					job->SetJobFlags(kJobNonpersistent);
-					TheJobMgr->SubmitJob(job, &batch);
-				}
-			}
-
-			image += width * height;
-			data += blockCountX * blockCountY * 16;
-		}
-
-		TheJobMgr->FinishBatch(&batch);
-	}
-	else
-	{
-		for (machine a = 0; a < count; a++)
-		{
-			for (machine j = 0; j < blockCountY; j++)
-			{
-				for (machine i = 0; i < blockCountX; i++)
-				{
-					unsigned_int8	gray[16];
-
-					const Color4C *input = image + i * 4;
-					unsigned_int8 *output = data + i * 16;
-
-					for (machine n = 0; n < 4; n++)
-					{
-						for (machine m = 0; m < 4; m++)
-						{
-							gray[n * 4 + m] = (unsigned_int8) input[n * width + m].GetAlpha();
-						}
-					}
-
-					Image::CompressGrayBlock(blockWidth, blockHeight, 4, gray, output);
-					Image::CompressGreenBlock(blockWidth, blockHeight, width, input, output + 8);
-				}
-
-				image += width * blockHeight;
-				data += blockCountX * 16;
-			}
-		}
-	}
-
-	return (blockCountX * blockCountY * count);
-}
-
 void TextureImporter::GetInputConfigPath(ResourcePath *path) const
 {
 	ThePluginMgr->GetImportCatalog()->GetResourcePath(ConfigResource::GetDescriptor(), inputTextureName, path);
@@ -2228,6 +1911,8 @@ EngineResult TextureImporter::ImportTextureImage(void)
 		unsigned_int8 *blockStorage = compressedStorage + maxCompressedSize;
 		const unsigned_int8 *uncompressedStorage = chainStorage;
 
+		unsigned_int32 compressionFlags = (textureImportFlags & kTextureImportHighQualityCompression) ? kBlockCompressHighQuality : 0;
+
 		for (machine level = 0; level < mipmapCount; level++)
 		{
 			int32 pixelCount = mipmapWidth * mipmapHeight * depth;
@@ -2245,7 +1930,7 @@ EngineResult TextureImporter::ImportTextureImage(void)
 					TextureSemantic semantic = textureHeader[textureIndex].alphaSemantic;
 					if (semantic == kTextureSemanticNone)
 					{
-						unsigned_int32 blockCount = BlockCompressImageBC1(depth, mipmapWidth, mipmapHeight, reinterpret_cast<const Color4C *>(uncompressedStorage), blockStorage);
+						unsigned_int32 blockCount = Image::CompressImageBC1(depth, mipmapWidth, mipmapHeight, reinterpret_cast<const Color4C *>(uncompressedStorage), blockStorage, compressionFlags);
 						unsigned_int32 blockImageSize = blockCount * sizeof(BC1Block);
 
 						unsigned_int32 compressedSize = Comp::CompressData(blockStorage, blockImageSize, compressedStorage);
@@ -2264,7 +1949,7 @@ EngineResult TextureImporter::ImportTextureImage(void)
 					else
 					{
 						const Color4C *image = reinterpret_cast<const Color4C *>(uncompressedStorage);
-						unsigned_int32 blockCount = (semantic != kTextureSemanticNormal) ? BlockCompressImageBC3(depth, mipmapWidth, mipmapHeight, image, blockStorage) : BlockCompressNormalImageBC3(depth, mipmapWidth, mipmapHeight, image, blockStorage);
+						unsigned_int32 blockCount = (semantic != kTextureSemanticNormal) ? Image::CompressImageBC3(depth, mipmapWidth, mipmapHeight, image, blockStorage, compressionFlags) : Image::CompressNormalImageBC3(depth, mipmapWidth, mipmapHeight, image, blockStorage, compressionFlags);
 						unsigned_int32 blockImageSize = blockCount * sizeof(BC3Block);
 
 						unsigned_int32 compressedSize = Comp::CompressData(blockStorage, blockImageSize, compressedStorage);
@@ -2492,6 +2177,10 @@ void TextureImporter::ProcessCommandLine(const char *text)
 		{
 			textureImportFlags |= kTextureImportCompressionBC13;
 		}
+		else if (param == "-hqcompress")
+		{
+			textureImportFlags |= kTextureImportCompressionBC13 | kTextureImportHighQualityCompression;
+		}
 		else if (param == "-normal")
 		{
 			textureImportFlags |= kTextureImportNormalMap;
@@ -2620,7 +2309,7 @@ void TextureImporter::WriteCommandLine(File& file)
 
 	if (textureImportFlags & kTextureImportCompressionBC13)
 	{
-		file << " -compress";
+		file << ((textureImportFlags & kTextureImportHighQualityCompression) ? " -hqcompress" : " -compress");
 	}
 
 	if (textureImportFlags & kTextureImportBleedAlphaTest)
@@ -43,61 +43,8 @@ namespace C4
 		kTextureImportHorizonHalfScale		= 1 << 10,
 		kTextureImportAmbientOcclusion		= 1 << 11,
 		kTextureImportApplyHaze				= 1 << 12,
-		kTextureImportRemember				= 1 << 13
-	};
-
-
-	class CompressionBC1Job : public BatchJob
-	{
-		private:
-
-			int32			imageWidth;
-			Rect			blockRect;
-			const Color4C	*sourceImage;
-			unsigned_int8	*outputCode;
-
-			static void JobCompress(Job *job, void *cookie);
-
-		public:
-
-			CompressionBC1Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output);
-			~CompressionBC1Job();
-	};
-
-
-	class CompressionBC3Job : public BatchJob
-	{
-		private:
-
-			int32			imageWidth;
-			Rect			blockRect;
-			const Color4C	*sourceImage;
-			unsigned_int8	*outputCode;
-
-			static void JobCompress(Job *job, void *cookie);
-
-		public:
-
-			CompressionBC3Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output);
-			~CompressionBC3Job();
-	};
-
-
-	class CompressionNormalBC3Job : public BatchJob
-	{
-		private:
-
-			int32			imageWidth;
-			Rect			blockRect;
-			const Color4C	*sourceImage;
-			unsigned_int8	*outputCode;
-
-			static void JobCompress(Job *job, void *cookie);
-
-		public:
-
-			CompressionNormalBC3Job(int32 width, const Rect& rect, const Color4C *source, unsigned_int8 *output);
-			~CompressionNormalBC3Job();
+		kTextureImportRemember				= 1 << 13,
+		kTextureImportHighQualityCompression	= 1 << 14
 	};
 
 
@@ -255,10 +202,6 @@ namespace C4
 			unsigned_int32 GetAuxiliaryDataSize(void) const;
 			void WriteAuxiliaryData(File& file) const;
 
-			static int32 BlockCompressImageBC1(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data);
-			static int32 BlockCompressImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data);
-			static int32 BlockCompressNormalImageBC3(int32 count, int32 width, int32 height, const Color4C *image, unsigned_int8 *data);
-
 			void GetInputConfigPath(ResourcePath *path) const;
 			void WriteCommandLine(File& file);
 
@@ -1126,11 +1126,40 @@ bool Editor::EntireGroupSelected(const Node *root)
 	return (true);
 }
 
+void Editor::BuildNavigationTiles(void)
+{
+	NavigationBuildParams	params;
+
+	// A navigation tile is rebuilt for each zone that has the navigation mesh flag set, and the
+	// tiles are removed from all other zones so that stale navigation data is never saved.
+
+	Node *node = rootNode;
+	do
+	{
+		if (node->GetNodeType() == kNodeZone)
+		{
+			Zone *zone = static_cast<Zone *>(node);
+			if (zone->GetObject()->GetZoneFlags() & kZoneNavigationMesh)
+			{
+				zone->SetNavigationTile(NavigationTile::Build(zone, &params));
+			}
+			else if (zone->GetNavigationTile())
+			{
+				zone->SetNavigationTile(nullptr);
+			}
+		}
+
+		node = rootNode->GetNextNode(node);
+	} while (node);
+}
+
 bool Editor::SaveWorld(bool strip)
 {
 	File			file;
 	ResourcePath	path;
 
+	BuildNavigationTiles();
+
 	TheResourceMgr->GetGenericCatalog()->GetResourcePath(WorldResource::GetDescriptor(), resourceName, &resourceLocation, &path);
 	TheResourceMgr->CreateDirectoryPath(path);
 
@@ -1139,12 +1168,20 @@ bool Editor::SaveWorld(bool strip)
 	{
 		if (strip)
 		{
+			Array<Node *>	exportArray;
+
 			InfiniteZone *zone = static_cast<InfiniteZone *>(rootNode);
 
 			editorObject->Retain();
 			zone->SetAuxiliaryObject(nullptr);
 
-			result = rootNode->PackTree(&file, kPackInitialize);
+			result = ZoneStreamer::ExportChunks(rootNode, resourceName, &resourceLocation, &exportArray);
+			if (result == kFileOkay)
+			{
+				result = rootNode->PackTree(&file, kPackInitialize);
+			}
+
+			ZoneStreamer::RestoreChunks(&exportArray);
 
 			zone->SetAuxiliaryObject(editorObject);
 			editorObject->Release();
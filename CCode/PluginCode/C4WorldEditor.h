@@ -315,6 +315,7 @@ namespace C4
 			void HandleFrameAllMenuItem(Widget *menuItem, const WidgetEventData *eventData);
 			void HandleFrameSelectionMenuItem(Widget *menuItem, const WidgetEventData *eventData);
 
+			void BuildNavigationTiles(void);
 			bool SaveWorld(bool strip = false);
 			static void SavePickerProc(FilePicker *picker, void *cookie);
 			static void CloseDialogComplete(Dialog *dialog, void *cookie);
@@ -9,6 +9,172 @@ App::~App() { delete world; delete window; }
 Vec3 camerarotation;
 Entity* spectator;
 
+//Reference query that transforms the model bounds of every instance in range
+static int ScanInstancesInAABB(VegetationLayerSample* layer, const AABB& aabb, std::vector<Mat4>& instances, const float padding = 0.1)
+{
+	int count = 0;
+	Mat4 mat, identity;
+	AABB instanceaabb;
+	Model* model = layer->model;
+	float r = Vec2(model->recursiveaabb.size.x, model->recursiveaabb.size.z).Length() + Vec2(model->recursiveaabb.center.x, model->recursiveaabb.center.z).Length();
+	int gridminx = floor((aabb.min.x - layer->scalerange[1] * r) / layer->density - 0.5);
+	int gridminz = floor((aabb.min.z - layer->scalerange[1] * r) / layer->density - 0.5);
+	int gridmaxx = ceil((aabb.max.x + layer->scalerange[1] * r) / layer->density + 0.5);
+	int gridmaxz = ceil((aabb.max.z + layer->scalerange[1] * r) / layer->density + 0.5);
+	for (int x = gridminx; x <= gridmaxx; x++)
+	{
+		for (int z = gridminz; z <= gridmaxz; z++)
+		{
+			mat = layer->GetInstanceMatrix(x, z);
+			instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, true);
+			if (instanceaabb.IntersectsAABB(aabb, padding))
+			{
+				instances.push_back(mat);
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+//Intersects the segment with the collision triangles of one instance, keeping the closest hit in t
+static bool RayInstanceTriangles(VegetationLayerSample* layer, const Mat4& mat, const Vec3& p0, const Vec3& d, float& t)
+{
+	Vec3 v[3], pos, e1, e2, p, q, s;
+	int tris_count = layer->indices.size() / 9;
+	bool hit = false;
+	for (int n = 0; n < tris_count; n++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			int offset = layer->indices[n * 9 + i] * 3;
+			pos = Vec3(layer->vertexpositions[offset + 0], layer->vertexpositions[offset + 1], layer->vertexpositions[offset + 2]);
+			FastMath::Mat4MultiplyVec3(mat, pos, v[i]);
+		}
+		e1 = v[1] - v[0];
+		e2 = v[2] - v[0];
+		p = d.Cross(e2);
+		float det = e1.Dot(p);
+		if (fabs(det) < 1.0e-12) continue;
+		s = p0 - v[0];
+		float u = s.Dot(p) / det;
+		if (u < 0.0 || u > 1.0) continue;
+		q = s.Cross(e1);
+		float w = d.Dot(q) / det;
+		if (w < 0.0 || u + w > 1.0) continue;
+		float ht = e2.Dot(q) / det;
+		if (ht < 0.0 || ht >= t) continue;
+		t = ht;
+		hit = true;
+	}
+	return hit;
+}
+
+//Reference ray query that transforms the bounds of every instance near the segment and tests the triangles of those it crosses
+static bool ScanInstancesOnLine(VegetationLayerSample* layer, Vec3 p0, Vec3 p1)
+{
+	bool hit = false;
+	float t = 1.0;
+	Vec3 d = Vec3(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
+	Mat4 mat, identity;
+	AABB instanceaabb;
+	Model* model = layer->model;
+	float r = Vec2(model->recursiveaabb.size.x, model->recursiveaabb.size.z).Length() + Vec2(model->recursiveaabb.center.x, model->recursiveaabb.center.z).Length();
+	int gridminx = floor((min(p0.x, p1.x) - layer->scalerange[1] * r) / layer->density - 0.5);
+	int gridminz = floor((min(p0.z, p1.z) - layer->scalerange[1] * r) / layer->density - 0.5);
+	int gridmaxx = ceil((max(p0.x, p1.x) + layer->scalerange[1] * r) / layer->density + 0.5);
+	int gridmaxz = ceil((max(p0.z, p1.z) + layer->scalerange[1] * r) / layer->density + 0.5);
+	for (int x = gridminx; x <= gridmaxx; x++)
+	{
+		for (int z = gridminz; z <= gridmaxz; z++)
+		{
+			mat = layer->GetInstanceMatrix(x, z);
+			instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, true);
+			if (!instanceaabb.IntersectsLine(p0, p1)) continue;
+
+			//Without a collision shape the layer also reports the instance bounds as the hit
+			if (layer->instanceshape == NULL || layer->indices.size() == 0)
+			{
+				hit = true;
+			}
+			else if (RayInstanceTriangles(layer, mat, p0, d, t))
+			{
+				hit = true;
+			}
+		}
+	}
+	return hit;
+}
+
+//Times ray and box queries against a layer of one million instances spread over the terrain
+static void BenchmarkVegetation(Terrain* terrain)
+{
+	const int querycount = 10000;
+	const float raylength = 100.0;
+	const float boxsize = 2.0;
+
+	float terrainsize = terrain->scale.x * terrain->resolution;
+	VegetationLayerSample* layer = new VegetationLayerSample(terrain);
+	layer->SetModel("Models/Pine-9m-Fresh/vegetation_pines_fresh_pine9m.mdl");
+	layer->SetDensity(terrainsize / 1000.0);
+	System::Print("Vegetation benchmark: 1000000 instances, density " + String(layer->density));
+
+	//Bullet-like rays at eye height and small boxes standing on the ground
+	std::vector<Vec3> rayorigin(querycount), raytarget(querycount);
+	std::vector<AABB> boxes(querycount);
+	srand(1);
+	for (int n = 0; n < querycount; n++)
+	{
+		float x = Math::Random(-terrainsize * 0.5, terrainsize * 0.5);
+		float z = Math::Random(-terrainsize * 0.5, terrainsize * 0.5);
+		float y = terrain->GetElevation(x, z);
+		float angle = Math::Random(0.0, 360.0);
+		rayorigin[n] = Vec3(x, y + 1.7, z);
+		raytarget[n] = Vec3(x + Math::Sin(angle) * raylength, y + Math::Random(-10.0, 10.0), z + Math::Cos(angle) * raylength);
+		boxes[n] = AABB(x - boxsize, y, z - boxsize, x + boxsize, y + boxsize * 2.0, z + boxsize);
+	}
+
+	float t;
+	Vec3 normal;
+	iVec2 instance;
+	std::vector<Mat4> instances;
+	int hits = 0, count = 0;
+
+	long time = Time::Millisecs();
+	for (int n = 0; n < querycount; n++)
+	{
+		if (ScanInstancesOnLine(layer, rayorigin[n], raytarget[n])) hits++;
+	}
+	System::Print("Ray scan: " + String(Time::Millisecs() - time) + " ms, " + String(hits) + " rays hitting instances");
+
+	hits = 0;
+	time = Time::Millisecs();
+	for (int n = 0; n < querycount; n++)
+	{
+		if (layer->RayCast(rayorigin[n], raytarget[n], t, normal, instance)) hits++;
+	}
+	System::Print("Ray grid traversal: " + String(Time::Millisecs() - time) + " ms, " + String(hits) + " rays hitting instances");
+
+	time = Time::Millisecs();
+	for (int n = 0; n < querycount; n++)
+	{
+		instances.resize(0);
+		count += ScanInstancesInAABB(layer, boxes[n], instances);
+	}
+	System::Print("AABB scan: " + String(Time::Millisecs() - time) + " ms, " + String(count) + " instances");
+
+	count = 0;
+	time = Time::Millisecs();
+	for (int n = 0; n < querycount; n++)
+	{
+		instances.resize(0);
+		count += layer->GetInstancesInAABB(boxes[n], instances);
+	}
+	System::Print("AABB query: " + String(Time::Millisecs() - time) + " ms, " + String(count) + " instances");
+
+	layer->Release();
+}
+
 bool App::Start()
 {
 	//Create a window
@@ -38,6 +204,13 @@ bool App::Start()
 	//Load a terrain
 	Map::Load("Maps/terrain.map");
 
+	//Run with -benchmark vegetation to time the layer queries instead of starting the sample
+	if (System::GetProperty("benchmark") == "vegetation")
+	{
+		BenchmarkVegetation(world->terrain);
+		return false;
+	}
+
 	//Create the vegetation layers
 	VegetationLayer* layer;
 	
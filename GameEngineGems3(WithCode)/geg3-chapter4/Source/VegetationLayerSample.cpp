@@ -11,6 +11,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include "VegetationLayerSample.h"
+#include <float.h>
+#include <algorithm>
+
+//SSE2 is used whenever the compiler targets it, which is always the case for x64 builds
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define VEGETATION_SSE
+#endif
 
 namespace Leadwerks
 {
@@ -18,6 +26,38 @@ namespace Leadwerks
 	#define BILLBOARDCELLSPACES 16
 	#define BILLBOARDSIZE BILLBOARDCELLSIZE*BILLBOARDCELLSPACES
 	#define BILLBOARDCELLS 16
+	#define VARIATIONBOUNDSSTRIDE 8
+	#define RAYMISS 1.2
+
+	//Instance bounds are tested four at a time, stored as min x, y, z and max x, y, z rows
+	struct InstanceBounds4
+	{
+		float bounds[6][4];
+		int x[4];
+		int z[4];
+		int count;
+	};
+
+	struct InstanceRay
+	{
+		Vec3 p0;
+		Vec3 d;
+		float invd[3];
+		float t;
+		Vec3 normal;
+		iVec2 instance;
+		bool closest;
+		bool hit;
+	};
+
+	static int VariationIndex(const int x, const int z, const int resolution)
+	{
+		int ix = x % resolution;
+		int iz = (z + resolution / 2) % resolution;
+		if (ix < 0) ix += resolution;
+		if (iz < 0) iz += resolution;
+		return iz * resolution + ix;
+	}
 
 	World* VegetationLayerSample::billboardworld = NULL;
 	Camera* VegetationLayerSample::billboardcamera = NULL;
@@ -48,6 +88,8 @@ namespace Leadwerks
 		collisiontype = 0;
 		density = 4.0;
 		model = NULL;
+		variationboundsmargin = 0.0;
+		variationboundsheight = Vec2(0.0);
 		shader_copybillboard = Shader::Load("Shaders/Vegetation/copybillboard.shader");
 		shader_frustumcull = Shader::Load("Shaders/Vegetation/FrustumCull.shader");
 		shader = Shader::Load("Shaders/Vegetation/diffuse.shader");
@@ -92,10 +134,20 @@ namespace Leadwerks
 		instancesurface->AddVertex(0, 0, 0);
 		instancesurface->positionarray->data->Resize(batchsize*sizeof(float) * 3);
 		instancesurface->mode = SURFACE_POINTS;
+
+		//Build the variations and their bounds up front so physics threads never have to
+		BuildVariationMatrices();
 	}
 
 	VegetationLayerSample::~VegetationLayerSample()
 	{
+		std::vector<VegetationLayer*>::iterator it = std::find(terrain->vegetationlayers.begin(), terrain->vegetationlayers.end(), this);
+		if (it != terrain->vegetationlayers.end()) terrain->vegetationlayers.erase(it);
+		if (instanceshape)
+		{
+			instanceshape->Release();
+			instanceshape = NULL;
+		}
 		if (shader_frustumcull)
 		{
 			shader_frustumcull->Release();
@@ -241,36 +293,368 @@ namespace Leadwerks
 		collideDescData->m_vertex = &layer->collisionsurfacevertices[threadNumber][0];
 	}
 
-	int VegetationLayerSample::GetInstancesInAABB(const AABB& aabb, std::vector<Mat4>& instances, const float padding)
+	void VegetationLayerSample::BuildVariationBounds()
+	{
+		int n, axis;
+		float c, e;
+		float* b;
+		const float* m;
+
+		if (variationmatrices.size() == 0) BuildVariationMatrices();
+
+		int count = variationmapresolution * variationmapresolution;
+		variationbounds.resize(count * VARIATIONBOUNDSSTRIDE);
+		variationboundsmargin = 0.0;
+		variationboundsheight = Vec2(0.0);
+		if (model == NULL) return;
+
+		//Center and half extents of the model
+		float center[3], extent[3];
+		for (axis = 0; axis < 3; axis++)
+		{
+			center[axis] = (model->recursiveaabb.min[axis] + model->recursiveaabb.max[axis]) * 0.5;
+			extent[axis] = (model->recursiveaabb.max[axis] - model->recursiveaabb.min[axis]) * 0.5;
+		}
+
+		variationboundsheight = Vec2(FLT_MAX, -FLT_MAX);
+		for (n = 0; n < count; n++)
+		{
+			m = &variationmatrices[n * 16];
+			b = &variationbounds[n * VARIATIONBOUNDSSTRIDE];
+			float scale = scalerange.x + m[15] * (scalerange.y - scalerange.x);
+
+			//Instance offset from the grid point
+			b[0] = m[12];
+			b[1] = m[14];
+
+			//Same result as transforming the eight corners of the model AABB by GetInstanceMatrix()
+			for (axis = 0; axis < 3; axis++)
+			{
+				c = (m[axis] * center[0] + m[4 + axis] * center[1] + m[8 + axis] * center[2]) * scale;
+				e = (fabs(m[axis]) * extent[0] + fabs(m[4 + axis]) * extent[1] + fabs(m[8 + axis]) * extent[2]) * scale;
+				if (axis != 1) c += m[12 + axis];
+				b[2 + axis] = c - e;
+				b[5 + axis] = c + e;
+			}
+
+			variationboundsmargin = max(variationboundsmargin, max(max(-b[2], b[5]), max(-b[4], b[7])));
+			variationboundsheight.x = min(variationboundsheight.x, b[3]);
+			variationboundsheight.y = max(variationboundsheight.y, b[6]);
+		}
+	}
+
+	//Adds the world bounds of instance (x, z) to the next free lane
+	static void AddInstanceBounds(VegetationLayerSample* layer, const int x, const int z, InstanceBounds4& block)
+	{
+		const float* b = &layer->variationbounds[VariationIndex(x, z, layer->variationmapresolution) * VARIATIONBOUNDSSTRIDE];
+		float px = x * layer->density;
+		float pz = z * layer->density;
+		float py = layer->terrain->GetElevation(px + b[0], pz + b[1]);
+		int lane = block.count++;
+		block.bounds[0][lane] = px + b[2];
+		block.bounds[1][lane] = py + b[3];
+		block.bounds[2][lane] = pz + b[4];
+		block.bounds[3][lane] = px + b[5];
+		block.bounds[4][lane] = py + b[6];
+		block.bounds[5][lane] = pz + b[7];
+		block.x[lane] = x;
+		block.z[lane] = z;
+	}
+
+	//Returns a bit mask of the lanes that overlap the given box
+	static int OverlapInstanceBounds4(const InstanceBounds4& block, const float* boxmin, const float* boxmax)
+	{
+#ifdef VEGETATION_SSE
+		__m128 result = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int axis = 0; axis < 3; axis++)
+		{
+			result = _mm_and_ps(result, _mm_cmple_ps(_mm_loadu_ps(block.bounds[axis]), _mm_set1_ps(boxmax[axis])));
+			result = _mm_and_ps(result, _mm_cmpge_ps(_mm_loadu_ps(block.bounds[axis + 3]), _mm_set1_ps(boxmin[axis])));
+		}
+		return _mm_movemask_ps(result) & ((1 << block.count) - 1);
+#else
+		int mask = 0;
+		for (int lane = 0; lane < block.count; lane++)
+		{
+			if (block.bounds[0][lane] > boxmax[0] || block.bounds[3][lane] < boxmin[0]) continue;
+			if (block.bounds[1][lane] > boxmax[1] || block.bounds[4][lane] < boxmin[1]) continue;
+			if (block.bounds[2][lane] > boxmax[2] || block.bounds[5][lane] < boxmin[2]) continue;
+			mask |= 1 << lane;
+		}
+		return mask;
+#endif
+	}
+
+	//Returns a bit mask of the lanes the ray enters before the current hit, with the entry parameter of each lane
+	static int RayInstanceBounds4(const InstanceBounds4& block, const InstanceRay& ray, float* tenter)
 	{
+#ifdef VEGETATION_SSE
+		__m128 t0 = _mm_setzero_ps();
+		__m128 t1 = _mm_set1_ps(ray.t);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			__m128 origin = _mm_set1_ps(axis == 0 ? ray.p0.x : (axis == 1 ? ray.p0.y : ray.p0.z));
+			__m128 invd = _mm_set1_ps(ray.invd[axis]);
+			__m128 a = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.bounds[axis]), origin), invd);
+			__m128 b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.bounds[axis + 3]), origin), invd);
+			t0 = _mm_max_ps(t0, _mm_min_ps(a, b));
+			t1 = _mm_min_ps(t1, _mm_max_ps(a, b));
+		}
+		_mm_storeu_ps(tenter, t0);
+		return _mm_movemask_ps(_mm_cmple_ps(t0, t1)) & ((1 << block.count) - 1);
+#else
+		float origin[3] = { ray.p0.x, ray.p0.y, ray.p0.z };
+		int mask = 0;
+		for (int lane = 0; lane < block.count; lane++)
+		{
+			float t0 = 0.0, t1 = ray.t;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float a = (block.bounds[axis][lane] - origin[axis]) * ray.invd[axis];
+				float b = (block.bounds[axis + 3][lane] - origin[axis]) * ray.invd[axis];
+				t0 = max(t0, min(a, b));
+				t1 = min(t1, max(a, b));
+			}
+			tenter[lane] = t0;
+			if (t0 <= t1) mask |= 1 << lane;
+		}
+		return mask;
+#endif
+	}
+
+	//Intersects the ray with the collision triangles of one instance
+	static bool RayInstance(VegetationLayerSample* layer, const int x, const int z, InstanceRay& ray)
+	{
+		Vec3 v[3], pos, e1, e2, p, q, s, normal;
+		int tris_count = layer->indices.size() / 9;
+		bool hit = false;
+		int n, i;
+		float det, u, w, t;
+
+		Mat4 mat = layer->GetInstanceMatrix(x, z);
+		for (n = 0; n < tris_count; n++)
+		{
+			for (i = 0; i < 3; i++)
+			{
+				int offset = layer->indices[n * 9 + i] * 3;
+				pos.x = layer->vertexpositions[offset + 0];
+				pos.y = layer->vertexpositions[offset + 1];
+				pos.z = layer->vertexpositions[offset + 2];
+				FastMath::Mat4MultiplyVec3(mat, pos, v[i]);
+			}
+
+			e1 = v[1] - v[0];
+			e2 = v[2] - v[0];
+			p = ray.d.Cross(e2);
+			det = e1.Dot(p);
+			if (fabs(det) < 1.0e-12) continue;
+			s = ray.p0 - v[0];
+			u = s.Dot(p) / det;
+			if (u < 0.0 || u > 1.0) continue;
+			q = s.Cross(e1);
+			w = ray.d.Dot(q) / det;
+			if (w < 0.0 || u + w > 1.0) continue;
+			t = e2.Dot(q) / det;
+			if (t < 0.0 || t >= ray.t) continue;
+
+			//Foliage is double-sided, so the normal always faces the ray origin
+			normal = e1.Cross(e2).Normalize();
+			if (normal.Dot(ray.d) > 0.0) normal = -normal;
+			ray.t = t;
+			ray.normal = normal;
+			hit = true;
+			if (!ray.closest) break;
+		}
+		return hit;
+	}
+
+	static void RayInstanceBlock(VegetationLayerSample* layer, InstanceBounds4& block, InstanceRay& ray)
+	{
+		float tenter[4];
+		int mask = RayInstanceBounds4(block, ray, tenter);
+		for (int lane = 0; lane < block.count && mask != 0; lane++)
+		{
+			if ((mask & (1 << lane)) == 0 || tenter[lane] > ray.t) continue;
+			if (layer->instanceshape && layer->indices.size() > 0)
+			{
+				if (!RayInstance(layer, block.x[lane], block.z[lane], ray)) continue;
+			}
+			else
+			{
+				//Without a collision shape the instance bounds are the best available hit
+				float origin[3] = { ray.p0.x, ray.p0.y, ray.p0.z };
+				float d[3] = { ray.d.x, ray.d.y, ray.d.z };
+				float normal[3] = { 0.0, 0.0, 0.0 };
+				for (int axis = 0; axis < 3; axis++)
+				{
+					if (d[axis] == 0.0) continue;
+					float plane = d[axis] > 0.0 ? block.bounds[axis][lane] : block.bounds[axis + 3][lane];
+					if ((plane - origin[axis]) * ray.invd[axis] >= tenter[lane])
+					{
+						normal[axis] = d[axis] > 0.0 ? -1.0 : 1.0;
+						break;
+					}
+				}
+				ray.t = tenter[lane];
+				ray.normal = Vec3(normal[0], normal[1], normal[2]);
+			}
+			ray.instance = iVec2(block.x[lane], block.z[lane]);
+			ray.hit = true;
+			if (!ray.closest) break;
+		}
+		block.count = 0;
+	}
+
+	//Tests count instances starting at (x, z) and stepping by (dx, dz)
+	static void RayInstanceStrip(VegetationLayerSample* layer, int x, int z, const int dx, const int dz, const int count, InstanceRay& ray)
+	{
+		InstanceBounds4 block;
+		block.count = 0;
+		for (int n = 0; n < count; n++)
+		{
+			AddInstanceBounds(layer, x, z, block);
+			if (block.count == 4) RayInstanceBlock(layer, block, ray);
+			if (ray.hit && !ray.closest) return;
+			x += dx;
+			z += dz;
+		}
+		if (block.count > 0) RayInstanceBlock(layer, block, ray);
+	}
+
+	bool VegetationLayerSample::RayCast(const Vec3& p0, const Vec3& p1, float& t, Vec3& normal, iVec2& instance, const bool closest)
+	{
+		InstanceRay ray;
+		float origin[3], d[3], boxmin[3], boxmax[3];
+		float tmin = 0.0, tmax = 1.0;
+		int axis;
+
+		if (model == NULL) return false;
+
+		ray.p0 = p0;
+		ray.d = Vec3(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
+		ray.t = 1.0;
+		ray.closest = closest;
+		ray.hit = false;
+
+		//Clip the ray to the volume that can contain instances, the same volume BuildShape() gives the collision
+		float halfsize = terrain->scale.x * terrain->resolution * 0.5 + variationboundsmargin;
+		boxmin[0] = -halfsize;
+		boxmin[1] = variationboundsheight.x;
+		boxmin[2] = -halfsize;
+		boxmax[0] = halfsize;
+		boxmax[1] = terrain->scale.y + variationboundsheight.y;
+		boxmax[2] = halfsize;
+		origin[0] = p0.x; origin[1] = p0.y; origin[2] = p0.z;
+		d[0] = ray.d.x; d[1] = ray.d.y; d[2] = ray.d.z;
+		for (axis = 0; axis < 3; axis++)
+		{
+			//A tiny direction keeps the slab test free of NaNs for axis-aligned rays
+			if (d[axis] == 0.0) d[axis] = 1.0e-20;
+			ray.invd[axis] = 1.0 / d[axis];
+			float a = (boxmin[axis] - origin[axis]) * ray.invd[axis];
+			float b = (boxmax[axis] - origin[axis]) * ray.invd[axis];
+			tmin = max(tmin, min(a, b));
+			tmax = min(tmax, max(a, b));
+		}
+		if (tmin > tmax) return false;
+
+		//Any point within half a cell of grid point c can only be inside instances up to k cells from c
+		int k = ceil(variationboundsmargin / density + 0.5);
+		int strip = k * 2 + 1;
+
+		//Walk the grid cells along the horizontal projection of the ray
+		float px = p0.x + ray.d.x * tmin;
+		float pz = p0.z + ray.d.z * tmin;
+		int cx = floor(px / density + 0.5);
+		int cz = floor(pz / density + 0.5);
+		int stepx = ray.d.x >= 0.0 ? 1 : -1;
+		int stepz = ray.d.z >= 0.0 ? 1 : -1;
+		float tnextx = FLT_MAX, tnextz = FLT_MAX;
+		float tdeltax = FLT_MAX, tdeltaz = FLT_MAX;
+		if (ray.d.x != 0.0)
+		{
+			tnextx = ((cx + 0.5 * stepx) * density - p0.x) / ray.d.x;
+			tdeltax = density / fabs(ray.d.x);
+		}
+		if (ray.d.z != 0.0)
+		{
+			tnextz = ((cz + 0.5 * stepz) * density - p0.z) / ray.d.z;
+			tdeltaz = density / fabs(ray.d.z);
+		}
+
+		//The first cell tests its whole neighborhood. Because the walk is monotonic, every later
+		//cell adds exactly one new row or column of the neighborhood, so no instance is tested twice.
+		for (int n = 0; n < strip; n++)
+		{
+			RayInstanceStrip(this, cx - k, cz - k + n, 1, 0, strip, ray);
+		}
+
+		while (!(ray.hit && !closest))
+		{
+			//Every instance hit before ray.t has been tested once the walk passes the cell containing it
+			float tnext = min(tnextx, tnextz);
+			if (tnext > tmax || tnext > ray.t) break;
+			if (tnextx < tnextz)
+			{
+				cx += stepx;
+				tnextx += tdeltax;
+				RayInstanceStrip(this, cx + stepx * k, cz - k, 0, 1, strip, ray);
+			}
+			else
+			{
+				cz += stepz;
+				tnextz += tdeltaz;
+				RayInstanceStrip(this, cx - k, cz + stepz * k, 1, 0, strip, ray);
+			}
+		}
+
+		if (!ray.hit) return false;
+		t = ray.t;
+		normal = ray.normal;
+		instance = ray.instance;
+		return true;
+	}
+
+	//Scans the grid cells that can contain instances overlapping the box, four instances at a time
+	static int QueryInstancesInAABB(VegetationLayerSample* layer, const AABB& aabb, const float padding, std::vector<Mat4>* instances)
+	{
+		InstanceBounds4 block;
+		float boxmin[3], boxmax[3];
 		int count = 0;
-		iVec2 gridmin;
-		iVec2 gridmax;
-		float r = 0.0;
-		Mat4 mat, identity;
-		Vec3 scale;
-		Vec3 center;
-		AABB instanceaabb;
-		
-		if (model) r = Vec2(model->recursiveaabb.size.x, model->recursiveaabb.size.z).Length() + Vec2(model->recursiveaabb.center.x, model->recursiveaabb.center.z).Length();
-		gridmin.x = floor((aabb.min.x - scalerange[1] * r) / density - 0.5);
-		gridmin.y = floor((aabb.min.z - scalerange[1] * r) / density - 0.5);
-		gridmax.x = ceil((aabb.max.x + scalerange[1] * r) / density + 0.5);
-		gridmax.y = ceil((aabb.max.z + scalerange[1] * r) / density + 0.5);
-		int x, y;
-		for (x = gridmin.x; x <= gridmax.x; x++)
+		int x, z, lane, mask;
+
+		if (layer->model == NULL) return 0;
+
+		boxmin[0] = aabb.min.x - padding;
+		boxmin[1] = aabb.min.y - padding;
+		boxmin[2] = aabb.min.z - padding;
+		boxmax[0] = aabb.max.x + padding;
+		boxmax[1] = aabb.max.y + padding;
+		boxmax[2] = aabb.max.z + padding;
+
+		int gridminx = floor((boxmin[0] - layer->variationboundsmargin) / layer->density);
+		int gridminz = floor((boxmin[2] - layer->variationboundsmargin) / layer->density);
+		int gridmaxx = ceil((boxmax[0] + layer->variationboundsmargin) / layer->density);
+		int gridmaxz = ceil((boxmax[2] + layer->variationboundsmargin) / layer->density);
+
+		for (z = gridminz; z <= gridmaxz; z++)
 		{
-			for (y = gridmin.y; y <= gridmax.y; y++)
+			for (x = gridminx; x <= gridmaxx; x += 4)
 			{
-				mat = GetInstanceMatrix(x, y);
-				instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, false);
-				if (instanceaabb.IntersectsAABB(aabb, padding))
+				block.count = 0;
+				for (lane = 0; lane < 4 && x + lane <= gridmaxx; lane++)
+				{
+					AddInstanceBounds(layer, x + lane, z, block);
+				}
+				mask = OverlapInstanceBounds4(block, boxmin, boxmax);
+				if (mask == 0) continue;
+				if (instances == NULL) return 1;
+				for (lane = 0; lane < block.count; lane++)
 				{
-					instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, true);
-					if (instanceaabb.IntersectsAABB(aabb, padding))
+					if (mask & (1 << lane))
 					{
+						instances->push_back(layer->GetInstanceMatrix(block.x[lane], block.z[lane]));
 						count++;
-						instances.push_back(mat);
 					}
 				}
 			}
@@ -278,10 +662,31 @@ namespace Leadwerks
 		return count;
 	}
 
-	//Not implemented
+	int VegetationLayerSample::GetInstancesInAABB(const AABB& aabb, std::vector<Mat4>& instances, const float padding)
+	{
+		return QueryInstancesInAABB(this, aabb, padding, &instances);
+	}
+
 	dFloat VegetationLayerSample::RayHitCallback(NewtonUserMeshCollisionRayHitDesc* const lineDescData)
 	{
-		return 0.0;
+		//Get the vegetation layer object
+		VegetationLayerSample* layer = (VegetationLayerSample*)lineDescData->m_userData;
+
+		float t;
+		Vec3 normal;
+		iVec2 instance;
+		Vec3 p0 = Vec3(lineDescData->m_p0[0], lineDescData->m_p0[1], lineDescData->m_p0[2]);
+		Vec3 p1 = Vec3(lineDescData->m_p1[0], lineDescData->m_p1[1], lineDescData->m_p1[2]);
+		if (!layer->RayCast(p0, p1, t, normal, instance)) return RAYMISS;
+
+		lineDescData->m_normalOut[0] = normal.x;
+		lineDescData->m_normalOut[1] = normal.y;
+		lineDescData->m_normalOut[2] = normal.z;
+		lineDescData->m_normalOut[3] = 0.0;
+
+		//Pack the instance grid coordinates so the hit can be traced back to an instance
+		lineDescData->m_userIdOut = ((dLong)instance.x << 32) | (unsigned int)instance.y;
+		return t;
 	}
 
 	int VegetationLayerSample::AABBTest(void* const userData, const dFloat* const boxP0, const dFloat* const boxP1)
@@ -299,37 +704,7 @@ namespace Leadwerks
 
 	bool VegetationLayerSample::IntersectsAABB(const AABB& aabb, const float padding)
 	{
-		iVec2 gridmin;
-		iVec2 gridmax;
-		float r = 0.0;
-		Mat4 mat, identity;
-		Vec3 scale;
-		Vec3 center;
-		AABB instanceaabb;
-
-		if (model) r = Vec2(model->recursiveaabb.size.x, model->recursiveaabb.size.z).Length() + Vec2(model->recursiveaabb.center.x, model->recursiveaabb.center.z).Length();
-		gridmin.x = floor((aabb.min.x - scalerange[1] * r) / density - 0.5);
-		gridmin.y = floor((aabb.min.z - scalerange[1] * r) / density - 0.5);
-		gridmax.x = ceil((aabb.max.x + scalerange[1] * r) / density + 0.5);
-		gridmax.y = ceil((aabb.max.z + scalerange[1] * r) / density + 0.5);
-		int x, y;
-		for (x = gridmin.x; x <= gridmax.x; x++)
-		{
-			for (y = gridmin.y; y <= gridmax.y; y++)
-			{
-				mat = GetInstanceMatrix(x, y);
-				instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, false);
-				if (instanceaabb.IntersectsAABB(aabb, padding))
-				{
-					instanceaabb = Transform::AABB(model->recursiveaabb, mat, identity, true);
-					if (instanceaabb.IntersectsAABB(aabb, padding))
-					{
-						return true;
-					}
-				}
-			}
-		}
-		return false;
+		return QueryInstancesInAABB(this, aabb, padding, NULL) != 0;
 	}
 
 	//Not implemented
@@ -364,6 +739,7 @@ namespace Leadwerks
 		maxBox[0] = (terrain->scale.x * terrain->resolution) * 0.5 + model->recursiveaabb.radius * scalerange.y;
 		maxBox[1] = terrain->scale.y + model->recursiveaabb.size.y;
 		maxBox[2] = (terrain->scale.z * terrain->resolution) * 0.5 + model->recursiveaabb.radius * scalerange.y;
+		BuildVariationBounds();
 		NewtonDynamicsShape* shape = new NewtonDynamicsShape;
 		shape->driver = driver;
 		shape->position = Vec3(0);
@@ -492,7 +868,7 @@ namespace Leadwerks
 	void VegetationLayerSample::SetDensity(const float density)
 	{
 		this->density = density;
-		variationmatrices.resize(0);
+		BuildVariationMatrices();
 	}
 
 	bool VegetationLayerSample::SetModel(const std::string& path)
@@ -674,6 +1050,7 @@ namespace Leadwerks
 			variationmap->SetFilter(Texture::Pixel);
 		}
 		variationmap->SetPixels((const char*)&variationmatrices[0]);
+		BuildVariationBounds();
 	}
 
 	void VegetationLayerSample::PrePass(Camera* camera)
@@ -105,6 +105,15 @@ namespace Leadwerks
 		static dFloat RayHitCallback(NewtonUserMeshCollisionRayHitDesc* const lineDescData);
 		static int AABBTest(void* const userData, const dFloat* const boxP0, const dFloat* const boxP1);
 		static int GetFacesInAABB(void* const userData, const dFloat* const p0, const dFloat* const p1, const dFloat** const vertexArray, int* const vertexCount, int* const vertexStrideInBytes, const int* const indexList, int maxIndexCount, const int* const userDataLis);
+
+		//Queries
+		//Each variation stores the horizontal offset of its instance and the bounds of the transformed model relative to the grid point and terrain elevation
+		//The bounds are rebuilt whenever the variations, model or scale change, so queries from physics threads only read them
+		std::vector<float> variationbounds;
+		float variationboundsmargin;
+		Vec2 variationboundsheight;
+		virtual void BuildVariationBounds();
+		virtual bool RayCast(const Vec3& p0, const Vec3& p1, float& t, Vec3& normal, iVec2& instance, const bool closest = true);
 		
 		//Global
 		static World* billboardworld;